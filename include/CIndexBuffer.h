@@ -174,6 +174,14 @@ namespace scene
 			++ChangedID;
 		}
 
+		virtual void setDirty(u32 first, u32 count)
+		{
+			if (HardwareBuffer)
+				HardwareBuffer->requestUpdate(first * getIndexSize(), count * getIndexSize());
+
+			++ChangedID;
+		}
+
 		virtual u32 getChangedID() const
 		{
 			return ChangedID;
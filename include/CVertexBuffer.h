@@ -151,6 +151,14 @@ namespace scene
 			++ChangedID;
 		}
 
+		virtual void setDirty(u32 first, u32 count)
+		{
+			if (HardwareBuffer)
+				HardwareBuffer->requestUpdate(first * sizeof(T), count * sizeof(T));
+
+			++ChangedID;
+		}
+
 		virtual u32 getChangedID() const
 		{
 			return ChangedID;
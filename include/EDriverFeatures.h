@@ -163,6 +163,9 @@ namespace video
 		//! Supports texture multisampling
 		EVDF_TEXTURE_MULTISAMPLING,
 
+		//! Supports vertex buffers with per instance data, see E_INSTANCE_DATA_STEP_RATE
+		EVDF_INSTANCING,
+
 		//! Only used for counting the elements of this enum
 		EVDF_COUNT
 	};
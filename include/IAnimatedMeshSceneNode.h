@@ -213,6 +213,23 @@ namespace scene
 		/** Culling is unaffected. */
 		virtual void setRenderFromIdentity( bool On )=0;
 
+		//! Returns true if the mesh of the node has to be skinned for the current frame.
+		/** Nodes which skin a mesh of their own instead of the mesh shared with other
+		nodes return true here after OnAnimate. The scene manager then calls updateSkinning()
+		for all of them at once, spread over the threads of the engine, before the nodes
+		are registered for rendering. Otherwise the node is skinned when it is rendered.
+		Until then the bounding box of the node is a box around its animated joints,
+		which can be bigger than the skinned mesh. */
+		virtual bool needsSkinningUpdate() const { return false; }
+
+		//! Animates the joints and skins the mesh of the node for the current frame.
+		/** Called by the scene manager for the nodes which returned true in
+		needsSkinningUpdate(), several nodes are updated at the same time on different
+		threads, so this must not change anything shared with other nodes.
+		\param useThreads True if the node may spread the work over the threads of the
+		engine itself, false if it is called from one of these threads. */
+		virtual void updateSkinning(bool useThreads) {}
+
 		//! Creates a clone of this scene node and its children.
 		/** \param newParent An optional new parent.
 		\param newManager An optional new scene manager.
@@ -0,0 +1,80 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_ASSET_REQUEST_H_INCLUDED__
+#define __I_ASSET_REQUEST_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "path.h"
+
+namespace irr
+{
+namespace video
+{
+	class ITexture;
+} // end namespace video
+namespace scene
+{
+	class IAnimatedMesh;
+} // end namespace scene
+
+namespace io
+{
+
+//! States of an IAssetRequest
+enum E_ASSET_REQUEST_STATE
+{
+	//! The asset is still being loaded.
+	EARS_PENDING = 0,
+
+	//! The asset was loaded and can be used.
+	EARS_READY,
+
+	//! The asset could not be loaded.
+	EARS_FAILED
+};
+
+//! Handle of an asset which is loaded in the background.
+/** Requests are created by IVideoDriver::requestTexture() and
+ISceneManager::requestMesh(). The file is read and decoded by the worker
+threads of the engine (see SIrrlichtCreationParameters::WorkerThreads), only
+files in archives which are not in memory (see IReadFile::hasOwnHandle) are
+read on the main thread when they are requested. The remaining work which
+has to be done on the main thread, like creating the texture, is done once
+per frame within a time budget. The request changes its
+state during IVideoDriver::beginScene() or ISceneManager::drawAll(). Messages
+which are logged on the worker threads are passed to the logger and the event
+receiver of the device then as well, so they are only called on the main
+thread. */
+class IAssetRequest : public virtual IReferenceCounted
+{
+public:
+
+	//! Get the state of the request.
+	virtual E_ASSET_REQUEST_STATE getState() const = 0;
+
+	//! Get the name of the requested file.
+	virtual const io::path& getName() const = 0;
+
+	//! Get the texture of a texture request.
+	/** \return The texture if the request is ready, otherwise 0. The
+	texture is also in the texture cache of the driver. */
+	virtual video::ITexture* getTexture() const = 0;
+
+	//! Get the mesh of a mesh request.
+	/** \return The mesh if the request is ready, otherwise 0. The mesh is
+	also in the mesh cache of the scene manager. */
+	virtual scene::IAnimatedMesh* getMesh() const = 0;
+
+	//! Check if the request doesn't wait for anything anymore.
+	bool isFinished() const
+	{
+		return getState() != EARS_PENDING;
+	}
+};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
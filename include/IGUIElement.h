@@ -31,7 +31,7 @@ public:
 		s32 id, const core::rect<s32>& rectangle)
 		: Parent(0), RelativeRect(rectangle), AbsoluteRect(rectangle),
 		AbsoluteClippingRect(rectangle), DesiredRect(rectangle),
-		MaxSize(0,0), MinSize(1,1), IsVisible(true), IsEnabled(true),
+		MaxSize(0,0), MinSize(1,1), ChangedID(1), IsVisible(true), IsEnabled(true),
 		IsSubElement(false), NoClip(false), ID(id), IsTabStop(false), TabOrder(-1), IsTabGroup(false),
 		AlignLeft(EGUIA_UPPERLEFT), AlignRight(EGUIA_UPPERLEFT), AlignTop(EGUIA_UPPERLEFT), AlignBottom(EGUIA_UPPERLEFT),
 		Environment(environment), Type(type)
@@ -45,6 +45,7 @@ public:
 		{
 			parent->addChildToEnd(this);
 			recalculateAbsolutePosition(true);
+			invalidate();
 		}
 	}
 
@@ -98,6 +99,7 @@ public:
 
 		DesiredRect = r;
 		updateAbsolutePosition();
+		invalidate();
 	}
 
 	//! Sets the relative rectangle of this element, maintaining its current width and height
@@ -132,6 +134,7 @@ public:
 		ScaleRect = r;
 
 		updateAbsolutePosition();
+		invalidate();
 	}
 
 
@@ -155,6 +158,7 @@ public:
 	{
 		NoClip = noClip;
 		updateAbsolutePosition();
+		invalidate();
 	}
 
 
@@ -172,6 +176,7 @@ public:
 	{
 		MaxSize = size;
 		updateAbsolutePosition();
+		invalidate();
 	}
 
 
@@ -184,6 +189,7 @@ public:
 		if (MinSize.Height < 1)
 			MinSize.Height = 1;
 		updateAbsolutePosition();
+		invalidate();
 	}
 
 
@@ -210,6 +216,30 @@ public:
 			if (AlignBottom == EGUIA_SCALE)
 				ScaleRect.LowerRightCorner.Y = (f32)DesiredRect.LowerRightCorner.Y / d.Height;
 		}
+
+		invalidate();
+	}
+
+
+	//! Marks the element as changed.
+	/** The GUI environment only draws top level elements again in retained
+	mode when they or one of their children changed, see
+	IGUIEnvironment::setRetainedMode(). The setters of the elements call
+	this, call it when an element looks different for another reason. */
+	void invalidate()
+	{
+		++ChangedID;
+
+		// the root element is only changed when it is invalidated itself
+		for (IGUIElement* e = Parent; e && e->Parent; e = e->Parent)
+			++e->ChangedID;
+	}
+
+
+	//! Returns a number which changes whenever the element or one of its children changed.
+	u32 getChangedID() const
+	{
+		return ChangedID;
 	}
 
 
@@ -282,6 +312,8 @@ public:
 		{
 			addChildToEnd(child);
 			child->updateAbsolutePosition();
+			if (Parent)
+				invalidate();
 		}
 	}
 
@@ -295,6 +327,8 @@ public:
 				(*it)->Parent = 0;
 				(*it)->drop();
 				Children.erase(it);
+				if (Parent)
+					invalidate();
 				return;
 			}
 	}
@@ -365,6 +399,7 @@ public:
 	virtual void setVisible(bool visible)
 	{
 		IsVisible = visible;
+		invalidate();
 	}
 
 
@@ -487,6 +522,7 @@ public:
 	virtual void setEnabled(bool enabled)
 	{
 		IsEnabled = enabled;
+		invalidate();
 	}
 
 
@@ -494,6 +530,7 @@ public:
 	virtual void setText(const wchar_t* text)
 	{
 		Text = text;
+		invalidate();
 	}
 
 
@@ -550,6 +587,8 @@ public:
 			{
 				Children.erase(it);
 				Children.push_back(element);
+				if (Parent)
+					invalidate();
 				return true;
 			}
 		}
@@ -572,6 +611,8 @@ public:
 			{
 				Children.erase(it);
 				Children.push_front(child);
+				if (Parent)
+					invalidate();
 				return true;
 			}
 		}
@@ -1006,6 +1047,9 @@ protected:
 	//! maximum and minimum size of the element
 	core::dimension2du MaxSize, MinSize;
 
+	//! changes whenever the element or one of its children changed
+	u32 ChangedID;
+
 	//! is visible?
 	bool IsVisible;
 
@@ -639,6 +639,24 @@ public:
 	//! Get the way the gui does handle focus changes
 	/** \returns A bitmask which is a combination of ::EFOCUS_FLAG flags.*/
 	virtual u32 getFocusBehavior() const = 0;
+
+	//! Enables or disables retained mode.
+	/** In retained mode, each visible top level element is drawn into a
+	render target texture, and only drawn again when it or one of its
+	children changed, see IGUIElement::invalidate(). Otherwise only the
+	texture is drawn. Events, focus and hover changes invalidate the
+	elements involved, a new skin or changes of the skin, see
+	IGUISkin::getChangedID(), invalidate all elements. The textures hold
+	premultiplied colors, which the blend factors of the 2d override
+	material, see IVideoDriver::getMaterial2D(), take care of while the
+	elements are drawn. Drivers without render target textures or separate
+	alpha blending, see video::EVDF_BLEND_SEPARATE, always draw all
+	elements. The default is false.
+	\param retained True to cache the top level elements. */
+	virtual void setRetainedMode(bool retained) = 0;
+
+	//! Returns whether top level elements are cached in retained mode.
+	virtual bool getRetainedMode() const = 0;
 };
 
 
@@ -570,6 +570,11 @@ namespace gui
 
 		//! get the type of this skin
 		virtual EGUI_SKIN_TYPE getType() const { return EGST_UNKNOWN; }
+
+		//! Get an id which changes each time colors, sizes, fonts, icons or texts of the skin are changed
+		/** The retained mode of the gui environment draws all elements again when it changed.
+		Skins which never change can return always the same id. */
+		virtual u32 getChangedID() const { return 0; }
 	};
 
 
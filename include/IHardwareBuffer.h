@@ -8,6 +8,7 @@
 #include "IReferenceCounted.h"
 #include "EDriverTypes.h"
 #include "EHardwareBufferFlags.h"
+#include "irrMath.h"
 
 namespace irr
 {
@@ -60,7 +61,8 @@ class IHardwareBuffer : public virtual IReferenceCounted
 {
 public:
 	IHardwareBuffer(const scene::E_HARDWARE_MAPPING mapping, const u32 flags, const u32 size, const E_HARDWARE_BUFFER_TYPE type, const E_DRIVER_TYPE driverType) :
-		Mapping(mapping), Flags(flags), Size(size), Type(type), DriverType(driverType), RequiredUpdate(true)
+		Mapping(mapping), Flags(flags), Size(size), Type(type), DriverType(driverType), RequiredUpdate(true),
+		UpdateBegin(0), UpdateEnd(0xFFFFFFFF)
 	{
 	}
 
@@ -81,6 +83,34 @@ public:
 	inline void requestUpdate()
 	{
 		RequiredUpdate = true;
+		UpdateBegin = 0;
+		UpdateEnd = 0xFFFFFFFF;
+	}
+
+	// Request update of a range of bytes.
+	/** Ranges requested before the next update are merged. Drivers only upload the range if
+	the buffer doesn't have to grow. */
+	inline void requestUpdate(u32 offset, u32 size)
+	{
+		if (!RequiredUpdate)
+		{
+			UpdateBegin = offset;
+			UpdateEnd = offset + size;
+		}
+		else
+		{
+			UpdateBegin = core::min_(UpdateBegin, offset);
+			UpdateEnd = core::max_(UpdateEnd, offset + size);
+		}
+
+		RequiredUpdate = true;
+	}
+
+	// Get the range of bytes to update, limited to size.
+	inline void getUpdateRange(u32 size, u32& begin, u32& end) const
+	{
+		begin = core::min_(UpdateBegin, size);
+		end = core::min_(UpdateEnd, size);
 	}
 
 	//! Get mapping for buffer.
@@ -121,6 +151,10 @@ protected:
 	E_DRIVER_TYPE DriverType;
 
 	bool RequiredUpdate;
+
+	//! byte range requested by requestUpdate
+	u32 UpdateBegin;
+	u32 UpdateEnd;
 };
 
 }
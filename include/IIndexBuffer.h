@@ -68,6 +68,12 @@ namespace scene
 
 		virtual void setDirty() = 0;
 
+		//! Flags a range of indices as changed, only this range is uploaded to the hardware buffer.
+		virtual void setDirty(u32 first, u32 count)
+		{
+			setDirty();
+		}
+
 		virtual u32 getChangedID() const = 0;
 
 		video::IHardwareBuffer* getHardwareBuffer() const
@@ -106,6 +106,31 @@ namespace scene
 		*/
 		virtual void setStatic(bool staticInstances = true) = 0;
 
+		//! Returns the number of instances drawn in the last frame.
+		/** Instances outside of the view frustum aren't written to the
+		instance buffers, unless automatic culling is turned off. The
+		visible instances are stored contiguously, so this is also the
+		number of instances the driver draws, summed over all levels of
+		detail. */
+		virtual u32 getVisibleInstanceCount() const = 0;
+
+		//! Adds a mesh to draw the instances far away from the camera with.
+		/** Each instance is drawn with the mesh of the level with the
+		largest distance that is still smaller than its distance to the
+		camera, the mesh set with setMesh() is used below all distances.
+		Only the first mesh buffer of the mesh is used, it gets an
+		instance buffer like the main mesh.
+		\param mesh: Mesh with less detail, grabbed by the node.
+		\param distance: Distance to the camera from which on it is used.
+		\return True if the mesh was added. */
+		virtual bool addLODMesh(IMesh* mesh, f32 distance) = 0;
+
+		//! Removes all meshes added with addLODMesh().
+		virtual void removeLODMeshes() = 0;
+
+		//! Returns the number of meshes added with addLODMesh().
+		virtual u32 getLODMeshCount() const = 0;
+
 	protected:
 	};
 
@@ -52,6 +52,19 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IAnimatedMesh* createMesh(io::IReadFile* file) = 0;
 
+	//! Returns true if createMesh can run on a worker thread.
+	/** Used by ISceneManager::requestMesh. Such loaders must not use the
+	video driver, file system or scene manager in createMesh except for
+	getting vertex descriptors. Textures have to be loaded through the mesh
+	texture loader, which only returns placeholders on the worker thread. The
+	placeholders are replaced in all materials of IMesh::getMeshBuffer once the
+	textures are loaded. Calls of createMesh are never run at the same time.
+	\return False by default, the mesh is loaded on the main thread then. */
+	virtual bool isWorkerThreadSafe() const
+	{
+		return false;
+	}
+
 	//! Set a new texture loader which this meshloader can use when searching for textures.
 	/** NOTE: Not all meshloaders do support this interface. Meshloaders which
 	support it will return a non-null value in getMeshTextureLoader from the start. Setting a
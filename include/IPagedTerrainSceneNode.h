@@ -0,0 +1,140 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_PAGED_TERRAIN_SCENE_NODE_H_INCLUDED__
+#define __I_PAGED_TERRAIN_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "path.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Parameters of a paged terrain, see ISceneManager::addPagedTerrainSceneNode()
+	struct SPagedTerrainParameters
+	{
+		//! Constructs the default parameters
+		SPagedTerrainParameters() :
+			TileCountX(1), TileCountZ(1), TileSize(257),
+			BitsPerSample(16), SignedData(true), FloatValues(false),
+			Scale(1.0f, 1.0f, 1.0f), SkirtDepth(10.0f),
+			PatchSize(32), MaxLOD(4), LODDistance(256.0f),
+			LoadDistance(2048.0f), MemoryBudget(256*1024*1024),
+			VertexColor(255, 255, 255, 255)
+		{
+		}
+
+		//! Name of the heightmap tiles
+		/** The name holds two %u or %d, which are replaced by the x and the z
+		index of the tile, like "terrain/height_%u_%u.raw". %% stands for a
+		percent sign, names with other conversions are invalid. The tiles are
+		opened with the file system, so they can also be in archives. Tiles
+		which don't exist are holes of the terrain. */
+		io::path TileNames;
+
+		//! Number of tiles along the x and z axis
+		u32 TileCountX;
+		u32 TileCountZ;
+
+		//! Number of heights along each edge of a tile.
+		/** Must be a multiple of PatchSize plus one, like 257. Neighbouring
+		tiles share the heights of their common edge. */
+		u32 TileSize;
+
+		//! Format of the heights in the files, like ITerrainSceneNode::loadHeightMapRAW()
+		/** The heights are stored row by row along z, the rows one after another
+		along x. 16 bit values are divided by 256, 32 bit integers by 2^24. */
+		u32 BitsPerSample;
+		bool SignedData;
+		bool FloatValues;
+
+		//! Distance between the heights along x and z, and scale of the heights in y.
+		core::vector3df Scale;
+
+		//! Depth of the skirts below the edges of the patches which hide the
+		//! gaps between patches of different level of detail.
+		f32 SkirtDepth;
+
+		//! Number of quads along the edge of a patch, must be a power of two.
+		u32 PatchSize;
+
+		//! Number of levels of detail, each level uses every second height of the previous one.
+		u32 MaxLOD;
+
+		//! Distance from the camera at which the first level of detail switches to
+		//! the second one, the distance doubles for each further level.
+		f32 LODDistance;
+
+		//! Tiles within this distance from the camera are loaded.
+		f32 LoadDistance;
+
+		//! Memory in bytes the tiles may use.
+		/** When a new tile doesn't fit, the tile which is the farthest from
+		the camera is removed, as long as it is farther away than the new
+		tile. */
+		u32 MemoryBudget;
+
+		//! Color of all vertices.
+		video::SColor VertexColor;
+	};
+
+
+	//! A scene node for displaying huge terrains which are loaded in tiles.
+	/** Only the tiles close to the camera are loaded, which is done by the
+	worker threads of the engine (see SIrrlichtCreationParameters::WorkerThreads)
+	in the background. Tiles which aren't loaded yet are simply not drawn.
+	Each tile is split into patches whose level of detail is chosen by their
+	distance from the camera. All distances are in the coordinate system of
+	the node. */
+	class IPagedTerrainSceneNode : public ISceneNode
+	{
+	public:
+
+		//! Constructor
+		IPagedTerrainSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0.0f, 0.0f, 0.0f),
+			const core::vector3df& rotation = core::vector3df(0.0f, 0.0f, 0.0f),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f))
+			: ISceneNode (parent, mgr, id, position, rotation, scale) {}
+
+		//! Get the parameters of the terrain.
+		virtual const SPagedTerrainParameters& getParameters() const = 0;
+
+		//! Get the height of the terrain at a position in world coordinates.
+		/** \return The height in world coordinates, or -FLT_MAX if the tile at
+		this position isn't loaded. */
+		virtual f32 getHeight(f32 x, f32 z) const = 0;
+
+		//! Check if a tile is loaded.
+		virtual bool isTileLoaded(u32 x, u32 z) const = 0;
+
+		//! Get the number of loaded tiles.
+		virtual u32 getLoadedTileCount() const = 0;
+
+		//! Get the number of tiles which are being loaded.
+		virtual u32 getPendingTileCount() const = 0;
+
+		//! Get the memory in bytes used by the loaded and pending tiles.
+		virtual u32 getMemoryUsage() const = 0;
+
+		//! Set the distance from the camera within which tiles are loaded.
+		virtual void setLoadDistance(f32 distance) = 0;
+
+		//! Set the memory in bytes the tiles may use.
+		/** Tiles are removed in the next frame if they use more. */
+		virtual void setMemoryBudget(u32 bytes) = 0;
+
+		//! Loads the tiles around a position in node coordinates right away.
+		/** Useful before the first frame at a new place. Waits for the tiles
+		which are loaded already. */
+		virtual void loadTiles(const core::vector3df& position) = 0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
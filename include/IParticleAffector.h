@@ -6,7 +6,7 @@
 #define __I_PARTICLE_AFFECTOR_H_INCLUDED__
 
 #include "IAttributeExchangingObject.h"
-#include "SParticle.h"
+#include "SParticlePool.h"
 
 namespace irr
 {
@@ -51,6 +51,24 @@ public:
 	\param count Amount of particles in array. */
 	virtual void affect(u32 now, SParticle* particlearray, u32 count) = 0;
 
+	//! Prepares affecting the particles of a particle system in ranges.
+	/** Called once per frame by the particle system scene node before
+	affectRange() is called with ranges of its particles. The default
+	implementation returns false, then the scene node calls affect() with
+	an array of SParticle instead.
+	\param now Current time. (Same as ITimer::getTime() would return)
+	\return True if affectRange() is implemented and may be called for
+	different ranges from several threads at once. */
+	virtual bool prepareAffect(u32 now) { return false; }
+
+	//! Affects a range of particles stored as structure of arrays.
+	/** Only called after prepareAffect() returned true for the same time.
+	\param now Current time, the same as passed to prepareAffect().
+	\param pool Particles of the particle system.
+	\param first Index of the first particle to affect.
+	\param count Amount of particles to affect. */
+	virtual void affectRange(u32 now, SParticlePool& pool, u32 first, u32 count) {}
+
 	//! Sets whether or not the affector is currently enabled.
 	virtual void setEnabled(bool enabled) { Enabled = enabled; }
 
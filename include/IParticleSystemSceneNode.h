@@ -113,6 +113,42 @@ public:
 	//! Remove all currently visible particles
 	virtual void clearParticles() = 0;
 
+	//! Get the number of particles which are alive.
+	virtual u32 getParticleCount() const = 0;
+
+	//! Sets the maximum number of particles which are alive at the same time.
+	/** Emitted particles beyond this number are dropped. The default of
+	16250 particles fits into 16 bit indices, larger systems are drawn with
+	32 bit indices. Large systems are animated by the worker threads of the
+	engine, see SIrrlichtCreationParameters::WorkerThreads. */
+	virtual void setMaxParticleCount(u32 count) = 0;
+
+	//! Gets the maximum number of particles which are alive at the same time.
+	virtual u32 getMaxParticleCount() const = 0;
+
+	//! Sets if the particles are drawn as instances of a single quad.
+	/** Instead of four camera facing vertices per particle, only one
+	SParticleInstance per particle is written and uploaded. The quad has
+	its corners at -0.5 and 0.5 in X and Y of the vertex positions, the
+	vertex descriptor "ParticleInstance" adds the position of the particle
+	as TEXCOORD1 (3 floats), its size as TEXCOORD2 (2 floats) and its color
+	as TEXCOORD3 from the instance buffer. The color is made of the 4 bytes
+	of SColor in memory order, which is blue, green, red and alpha, so the
+	shader has to swizzle it (.zyxw). Direct3D 9 passes the bytes as values
+	from 0 to 255, Direct3D 11 as values from 0 to 1. The material type of
+	the node has to be a shader material whose vertex shader expands the
+	quad to a billboard, for example with
+	\code
+	worldPos = particlePos + (cameraRight * corner.x * size.x + cameraUp * corner.y * size.y);
+	\endcode
+	There is no built-in material for this. Drivers without
+	video::EVDF_INSTANCING and nodes with a built-in material type draw the
+	usual billboards instead. Default is false. */
+	virtual void setInstancedBillboards(bool instanced) = 0;
+
+	//! Gets if the particles are drawn as instances of a single quad.
+	virtual bool getInstancedBillboards() const = 0;
+
 	//! Do manually update the particles.
 	/** This should only be called when you want to render the node outside
 	the scenegraph, as the node will care about this otherwise
@@ -24,6 +24,7 @@ struct SProfileData
     SProfileData()
 	{
 		GroupIndex = 0;
+		IsCounter = false;
 		reset();
 	}
 
@@ -68,7 +69,7 @@ struct SProfileData
 private:
 
 	// just to be used for searching as it does no initialization besides id
-	SProfileData(u32 id) : Id(id) {}
+	SProfileData(u32 id) : Id(id), IsCounter(false) {}
 
 	void reset()
 	{
@@ -77,6 +78,7 @@ private:
 		TimeSum = 0;
 		LastTimeStarted = 0;
 		StartStopCounter = 0;
+		FrameCounter = 0;
 	}
 
 	s32 Id;
@@ -89,6 +91,61 @@ private:
     u32 TimeSum;
 
     u32 LastTimeStarted;
+
+	bool IsCounter;	// set once IProfiler::count was used for the id
+	u32 FrameCounter;	// sum of IProfiler::count calls in the current frame
+};
+
+//! Types of the events in the timeline of the profiler
+enum E_PROFILE_EVENT_TYPE
+{
+	//! Profiling for an id started.
+	EPET_BEGIN = 0,
+
+	//! Profiling for an id stopped.
+	EPET_END,
+
+	//! Value of a counter for the frame which ended.
+	EPET_COUNTER,
+
+	//! A frame ended, the value is the number of the frame.
+	EPET_FRAME
+};
+
+//! One entry of the timeline of the profiler
+struct SProfileEvent
+{
+	SProfileEvent()
+		: Id(-1), Type(EPET_BEGIN), Thread(0), Frame(0), Time(0), Value(0)
+	{}
+
+	//! Id used with IProfiler::start/stop/count, unused for frames.
+	s32 Id;
+
+	//! Type of the event.
+	E_PROFILE_EVENT_TYPE Type;
+
+	//! Index of the thread, threads are numbered in the order they recorded their first event.
+	u32 Thread;
+
+	//! Number of the frame the event belongs to, see IProfiler::markFrame.
+	u32 Frame;
+
+	//! Time in microseconds since the timeline was enabled.
+	u64 Time;
+
+	//! Counter value or frame number.
+	u32 Value;
+};
+
+//! Formats for IProfiler::printTimeline
+enum E_PROFILE_TIMELINE_FORMAT
+{
+	//! JSON which can be loaded in the trace viewer of Chrome (chrome://tracing).
+	EPTF_CHROME_TRACE = 0,
+
+	//! Comma separated values, one line per scope, counter and frame.
+	EPTF_CSV
 };
 
 //! Code-profiler. Please check the example in the Irrlicht examples folder about how to use it.
@@ -102,7 +159,7 @@ class IProfiler
 {
 public:
 	//! Constructor. You could use this to create a new profiler, but usually getProfiler() is used to access the global instance.
-    IProfiler()	: Timer(0), NextAutoId(INT_MAX)
+    IProfiler()	: Timer(0), TimelineEnabled(false), FrameNumber(0), NextAutoId(INT_MAX)
 	{}
 
 	virtual ~IProfiler()
@@ -205,16 +262,82 @@ public:
 	\param groupIndex_	*/
     virtual void printGroup(core::stringw &result, u32 groupIndex, bool suppressUncalled) const = 0;
 
+	//! Enable or disable recording a timeline of profile events
+	/** While enabled every start and stop call is recorded with its time and
+	thread, so single frames can be looked at instead of the accumulated totals.
+	The timeline is a ring buffer which keeps the latest events. Enabling the
+	timeline again clears it.
+	\param maxEvents Number of events kept, 0 disables the timeline. */
+	virtual void setTimelineSize(u32 maxEvents) = 0;
+
+	//! Check if the timeline is recorded
+	/** Like getFrameNumber only for the thread which calls markFrame. */
+	bool isTimelineEnabled() const
+	{
+		return TimelineEnabled;
+	}
+
+	//! Mark the end of a frame
+	/** Records a frame event and the counters of the frame in the timeline.
+	The engine calls this in IVideoDriver::endScene when compiled with
+	_IRR_COMPILE_WITH_PROFILING_. */
+	inline void markFrame();
+
+	//! Get the number of frames marked so far
+	u32 getFrameNumber() const
+	{
+		return FrameNumber;
+	}
+
+	//! Add to a counter of the current frame, like draw calls or uploaded bytes
+	/** The sum per frame is recorded in the timeline by markFrame. Counters
+	are only collected while the timeline is enabled.
+	NOTE: you have to add the id first with one of the ::add functions, like for start/stop.
+	\param id Id of the counter
+	\param amount Value added to the counter */
+	inline void count(s32 id, u32 amount=1);
+
+	//! Record an event in the timeline without changing the profile data
+	/** Unlike start/stop this can be called by any thread, as long as the
+	id was added before. Does nothing when the timeline isn't enabled. */
+	virtual void addTimelineEvent(s32 id, E_PROFILE_EVENT_TYPE type, u32 value=0) = 0;
+
+	//! Get the number of events in the timeline
+	virtual u32 getTimelineEventCount() const = 0;
+
+	//! Get an event of the timeline
+	/** \param index A value between 0 and getTimelineEventCount()-1, oldest events first.
+	\return The event, or an event with Id -1 if index is out of range. */
+	virtual SProfileEvent getTimelineEvent(u32 index) const = 0;
+
+	//! Write the timeline into a string
+	/** Nested start/stop events are written as scopes with a duration. Scopes
+	which began before the oldest event in the ring buffer or which didn't end
+	yet are left out. The result can be written to a file with IWriteFile, for
+	example to look at frame spikes of a program without user interface.
+	\param result Receives the result string.
+	\param format Format of the result. */
+	virtual void printTimeline(core::stringc &result, E_PROFILE_TIMELINE_FORMAT format=EPTF_CHROME_TRACE) const = 0;
+
 protected:
 
     inline u32 addGroup(const core::stringw &name);
 
+	// Clears the counters of the current frame
+	inline void resetFrameCounters();
+
+	// Data for the id or 0, unlike getProfileDataById usable in const functions
+	inline const SProfileData* findProfileData(s32 id) const;
+
 	// I would prefer using os::Timer, but os.h is not in the public interface so far.
 	// Timer must be initialized by the implementation.
     ITimer * Timer;
 	core::array<SProfileData> ProfileDatas;
     core::array<SProfileData> ProfileGroups;
 
+	bool TimelineEnabled;
+	u32 FrameNumber;
+
 private:
     s32 NextAutoId;	// for giving out id's automatically
 };
@@ -286,6 +409,8 @@ void IProfiler::start(s32 id)
 		++ProfileDatas[idx].StartStopCounter;
 		if (ProfileDatas[idx].StartStopCounter == 1 )
 			ProfileDatas[idx].LastTimeStarted = Timer->getRealTime();
+		if ( TimelineEnabled )
+			addTimelineEvent(id, EPET_BEGIN);
 	}
 }
 
@@ -299,6 +424,8 @@ void IProfiler::stop(s32 id)
 		{
 			SProfileData &data = ProfileDatas[idx];
 			--ProfileDatas[idx].StartStopCounter;
+			if ( TimelineEnabled && ProfileDatas[idx].StartStopCounter >= 0 )
+				addTimelineEvent(id, EPET_END);
 			if ( data.LastTimeStarted != 0 && ProfileDatas[idx].StartStopCounter == 0)
 			{
 				// update data for this id
@@ -326,6 +453,37 @@ void IProfiler::stop(s32 id)
 	}
 }
 
+void IProfiler::markFrame()
+{
+	if ( TimelineEnabled )
+	{
+		for ( u32 i=0; i < ProfileDatas.size(); ++i )
+		{
+			SProfileData &data = ProfileDatas[i];
+			if ( data.IsCounter )
+			{
+				addTimelineEvent(data.Id, EPET_COUNTER, data.FrameCounter);
+				data.FrameCounter = 0;
+			}
+		}
+		addTimelineEvent(0, EPET_FRAME, FrameNumber);
+	}
+	++FrameNumber;
+}
+
+void IProfiler::count(s32 id, u32 amount)
+{
+	if ( !TimelineEnabled )
+		return;
+
+	s32 idx = ProfileDatas.binary_search(SProfileData(id));
+	if ( idx >= 0 )
+	{
+		ProfileDatas[idx].IsCounter = true;
+		ProfileDatas[idx].FrameCounter += amount;
+	}
+}
+
 s32 IProfiler::add(const core::stringw &name, const core::stringw &groupName)
 {
 	u32 index;
@@ -406,6 +564,20 @@ const SProfileData* IProfiler::getProfileDataById(u32 id)
 	return NULL;
 }
 
+void IProfiler::resetFrameCounters()
+{
+	for ( u32 i=0; i < ProfileDatas.size(); ++i )
+		ProfileDatas[i].FrameCounter = 0;
+}
+
+const SProfileData* IProfiler::findProfileData(s32 id) const
+{
+	s32 idx = ProfileDatas.binary_search(SProfileData(id));
+	if ( idx >= 0 )
+		return &ProfileDatas[idx];
+	return NULL;
+}
+
 bool IProfiler::findGroupIndex(u32 & result, const core::stringw &name) const
 {
 	for ( u32 i=0; i < ProfileGroups.size(); ++i )
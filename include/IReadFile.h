@@ -42,6 +42,24 @@ namespace io
 		//! Get name of file.
 		/** \return File name as zero terminated character string. */
 		virtual const io::path& getFileName() const = 0;
+
+		//! Get the content of the file if it is available in memory.
+		/** Files mapped into memory, memory files and files stored uncompressed
+		in such files give direct access to their content, loaders can use it
+		instead of reading the file into a buffer of their own.
+		The content of a mapped file is read from disk when it is accessed,
+		so the file must not be truncated while it is open, see
+		_IRR_COMPILE_WITH_MAPPED_FILES_ in IrrCompileConfig.h.
+		\return Pointer to getSize() bytes, valid as long as the file is not
+		dropped, or 0 if the file has to be read with read(). */
+		virtual const void* getData() const { return 0; }
+
+		//! Check if the file can be read by another thread than the one which opened it.
+		/** This is the case for files with a handle of their own. Files in
+		archives share the handle of the archive file, so they must only be
+		read by the thread which uses the archive.
+		\return True if the file may be read by one other thread at a time. */
+		virtual bool hasOwnHandle() const { return false; }
 	};
 
 	//! Internal function, please do not use.
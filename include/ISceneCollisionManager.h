@@ -10,6 +10,7 @@
 #include "triangle3d.h"
 #include "position2d.h"
 #include "line3d.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -20,6 +21,64 @@ namespace scene
 	class ICameraSceneNode;
 	class ITriangleSelector;
 
+	//! Result of one line of ISceneCollisionManager::getCollisionPoints()
+	struct SCollisionHit
+	{
+		SCollisionHit() : Node(0), Hit(false) {}
+
+		//! Nearest collision point with the line, if there was a hit.
+		core::vector3df Point;
+
+		//! Triangle which was hit.
+		core::triangle3df Triangle;
+
+		//! Scene node of the triangle which was hit.
+		ISceneNode* Node;
+
+		//! True if the line hit a triangle.
+		bool Hit;
+	};
+
+	//! A moving ellipsoid for ISceneCollisionManager::getCollisionResultPositions()
+	/** The members before ResultPosition are the parameters of
+	ISceneCollisionManager::getCollisionResultPosition(), the others are
+	set to its results. */
+	struct SCollisionEllipsoid
+	{
+		SCollisionEllipsoid() : Radius(1.f, 1.f, 1.f), SlidingSpeed(0.0005f),
+			Node(0), Falling(false) {}
+
+		//! Position of the ellipsoid.
+		core::vector3df Position;
+
+		//! Radius of the ellipsoid.
+		core::vector3df Radius;
+
+		//! Direction and speed of the movement of the ellipsoid.
+		core::vector3df DirectionAndSpeed;
+
+		//! Direction and force of gravity.
+		core::vector3df Gravity;
+
+		//! Sliding speed, see getCollisionResultPosition().
+		f32 SlidingSpeed;
+
+		//! New position of the ellipsoid.
+		core::vector3df ResultPosition;
+
+		//! Position of the last collision.
+		core::vector3df HitPosition;
+
+		//! Last triangle causing a collision.
+		core::triangle3df Triangle;
+
+		//! Node of the last triangle causing a collision, 0 if there was none.
+		ISceneNode* Node;
+
+		//! True if the ellipsoid is falling down, caused by gravity.
+		bool Falling;
+	};
+
 	//! The Scene Collision Manager provides methods for performing collision tests and picking on scene nodes.
 	class ISceneCollisionManager : public virtual IReferenceCounted
 	{
@@ -78,6 +137,38 @@ namespace scene
 			const core::vector3df& gravityDirectionAndSpeed
 			= core::vector3df(0.0f, 0.0f, 0.0f)) = 0;
 
+		//! Finds the nearest collision points of many lines at once.
+		/** Like calling getCollisionPoint() for each line, but the lines
+		are split up between the worker threads of the engine (see
+		SIrrlichtCreationParameters::WorkerThreads). Each call uses its own
+		triangle buffers, so unlike the other functions this one may be
+		called from several threads at the same time. Such calls are
+		executed one after another though, because selectors of animated
+		meshes and bounding boxes update their triangles before the lines
+		are tested. The selector must not be changed by another thread
+		meanwhile, which includes the other collision functions of this
+		interface as they update the selectors as well.
+		\param rays: Lines with which collisions are tested.
+		\param count: Number of lines.
+		\param selector: TriangleSelector containing the triangles.
+		\param outHits: Array of count results, one for each line. */
+		virtual void getCollisionPoints(const core::line3d<f32>* rays, u32 count,
+			ITriangleSelector* selector, SCollisionHit* outHits) = 0;
+
+		//! Collides many moving ellipsoids with a 3d world at once.
+		/** Like calling getCollisionResultPosition() for each ellipsoid,
+		but the ellipsoids are split up between the worker threads of the
+		engine. The ellipsoids don't collide with each other. Like
+		getCollisionPoints() this may be called from several threads at
+		the same time, the calls are executed one after another.
+		\param ellipsoids: Ellipsoids to move, the results are written
+		back into them.
+		\param count: Number of ellipsoids.
+		\param selector: TriangleSelector containing the triangles of
+		the world. */
+		virtual void getCollisionResultPositions(SCollisionEllipsoid* ellipsoids, u32 count,
+			ITriangleSelector* selector) = 0;
+
 		//! Returns a 3d ray which would go through the 2d screen coodinates.
 		/** \param pos: Screen coordinates in pixels.
 		\param camera: Camera from which the ray starts. If null, the
@@ -195,6 +286,24 @@ namespace scene
 								s32 idBitMask = 0,
 								ISceneNode * collisionRootNode = 0,
 								bool noDebugObjects = false) = 0;
+
+		//! Get all scene nodes whose transformed bounding boxes intersect with a sphere.
+		/** Like the other methods testing bounding boxes, only visible nodes below
+		root are checked. When the scene manager keeps a spatial index (see
+		ISceneManager::setSpatialIndexEnabled()), only the nodes near the sphere
+		are tested instead of all nodes.
+		\param center: Center of the sphere in world space.
+		\param radius: Radius of the sphere.
+		\param outNodes: The nodes found are added to this array, in no particular order.
+		\param idBitMask: Only scene nodes with an id which matches at least one of the
+		bits contained in this mask will be tested. However, if this parameter is 0, then
+		all nodes are checked.
+		\param noDebugObjects: Doesn't take debug objects into account when true.
+		\param root: If different from 0, only the children of this node are checked,
+		otherwise the whole scene. */
+		virtual void getSceneNodesFromSphereBB(const core::vector3df& center, f32 radius,
+			core::array<ISceneNode*>& outNodes, s32 idBitMask=0, bool noDebugObjects=false,
+			ISceneNode* root=0) = 0;
 	};
 
 
@@ -18,6 +18,7 @@
 #include "EMeshWriterEnums.h"
 #include "SceneParameters.h"
 #include "IGeometryCreator.h"
+#include "IAssetRequest.h"
 #include "ISkinnedMesh.h"
 #include "CMeshBuffer.h"
 
@@ -121,6 +122,8 @@ namespace scene
 	class ISceneNodeFactory;
 	class ISceneUserDataSerializer;
 	class ITerrainSceneNode;
+	class IPagedTerrainSceneNode;
+	struct SPagedTerrainParameters;
 	class ITextSceneNode;
 	class ITriangleSelector;
 	class IVolumeLightSceneNode;
@@ -394,6 +397,26 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) = 0;
 
+		//! Loads a mesh in the background.
+		/** The file is read in the background. Mesh loaders which allow it
+		(see IMeshLoader::isWorkerThreadSafe) parse it on a worker thread as
+		well, the textures of the mesh are requested with
+		IVideoDriver::requestTexture afterwards. Other loaders parse the file
+		during one of the next calls to drawAll(), see setMeshLoadBudget().
+		The mesh ends up in the mesh cache just like with getMesh(). Meshes
+		which are in the cache already are ready right away. Vertex
+		descriptors must not be added while meshes are requested, and
+		getMesh() may wait for a worker thread using the same loader.
+		\param filename Filename of the mesh to load.
+		\return The request, never 0. Drop it when it isn't needed
+		anymore. See IReferenceCounted::drop() for more information. */
+		virtual io::IAssetRequest* requestMesh(const io::path& filename) = 0;
+
+		//! Set the time drawAll() may spend creating requested meshes.
+		/** At least one loaded mesh is created per frame.
+		\param milliseconds Time per frame, default is 4. */
+		virtual void setMeshLoadBudget(u32 milliseconds) = 0;
+
 		//! Get interface to the mesh cache which is shared beween all existing scene managers.
 		/** With this interface, it is possible to manually add new loaded
 		meshes (if ISceneManager::getMesh() is not sufficient), to remove them and to iterate
@@ -933,6 +956,29 @@ namespace scene
 			s32 maxLOD=5, E_TERRAIN_PATCH_SIZE patchSize=ETPS_17, s32 smoothFactor=0,
 			bool addAlsoIfHeightmapEmpty = false) = 0;
 
+		//! Adds a paged terrain scene node to the scene graph.
+		/** Unlike the terrain scene node, the heightmap is split into tiles
+		which are loaded in the background when the camera comes close, and
+		removed again when they use more memory than allowed. This allows
+		terrains with far more heights than fit into memory. See
+		SPagedTerrainParameters for the format of the tiles.
+		\param parameters: Files, size and level of detail of the terrain.
+		\param parent: Parent of the scene node. Can be 0 if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the first height of the first tile.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node, the distances of the
+		parameters are not scaled.
+		\return Pointer to the created scene node, or 0 if the parameters
+		are invalid. This pointer should not be dropped. See
+		IReferenceCounted::drop() for more information. */
+		virtual IPagedTerrainSceneNode* addPagedTerrainSceneNode(
+			const SPagedTerrainParameters& parameters,
+			ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0.0f,0.0f,0.0f),
+			const core::vector3df& rotation = core::vector3df(0.0f,0.0f,0.0f),
+			const core::vector3df& scale = core::vector3df(1.0f,1.0f,1.0f)) = 0;
+
 		//! Adds a quake3 scene node to the scene graph.
 		/** A Quake3 Scene renders multiple meshes for a specific HighLanguage Shader (Quake3 Style )
 		\return Pointer to the quake3 scene node if successful, otherwise NULL.
@@ -1365,6 +1411,34 @@ namespace scene
 			return createOctreeTriangleSelector(mesh, node, minimalPolysPerNode);
 		}
 
+		//! Creates a Triangle Selector with a bounding volume hierarchy, optimized for line queries.
+		/** Like createOctreeTriangleSelector(), but the triangles are organized in
+		a hierarchy of bounding boxes which is built with the surface area heuristic.
+		ISceneCollisionManager::getCollisionPoint() finds the nearest triangle hit by a
+		line by walking the hierarchy, without copying triangles. Use it for meshes
+		with many triangles which are tested against many rays, like for picking or
+		line of sight checks. The selector uses more memory than the octree selector
+		and is slower to create.
+		\param mesh: Mesh of which the triangles are taken.
+		\param node: Scene node of which visibility and transformation is used.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh, ISceneNode* node) = 0;
+
+		//! Creates a Triangle Selector with a bounding volume hierarchy, based on an animated mesh scene node.
+		/** The hierarchy is built once for the current frame of the node. When the
+		frame changes, the triangles keep their place in the hierarchy and only the
+		bounding boxes are refitted, instead of rebuilding it. This is done on the first
+		query after the change, selectors which aren't queried don't cost anything.
+		All frames of the mesh must have the same triangles, like those of morphing
+		and skinned meshes.
+		\param node The animated mesh scene node from which to build the selector
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IAnimatedMeshSceneNode* node) = 0;
+
 		//! Creates a meta triangle selector.
 		/** A meta triangle selector is nothing more than a
 		collection of one or more triangle selectors providing together
@@ -1678,6 +1752,33 @@ namespace scene
 
 		virtual bool isCulled(core::aabbox3d<f32> tbox, scene::E_CULLING_TYPE type, const core::matrix4& absoluteTransformation) const = 0;
 
+		//! Enables or disables a spatial index over the scene nodes.
+		/** The index keeps the world space bounding boxes of all visible scene nodes
+		in a loose grid. It is brought up to date in drawAll() after the nodes were
+		animated, then only nodes which moved or changed their bounding box cost time.
+		ISceneCollisionManager uses it for picking with bounding boxes and triangle
+		selectors and for ISceneCollisionManager::getSceneNodesFromSphereBB(), drawAll()
+		uses it to cull the nodes of whole cells outside of the view frustum at once.
+		The queries bring it up to date first, so they find the nodes at their current
+		absolute transformations and never return nodes which were removed from the
+		scene. They only look at the nodes again when the changed id of the root node
+		moved since the last update, see ISceneNode::invalidate(). The index only pays
+		off for scenes with many nodes.
+		\param enable True to create the index, false to delete it.
+		\param cellSize Size of the smallest cells. Nodes are put into cells which are
+		at least as big as they are, the index works best when many nodes have about
+		this size. */
+		virtual void setSpatialIndexEnabled(bool enable, f32 cellSize=100.f) = 0;
+
+		//! Returns if a spatial index over the scene nodes is kept.
+		virtual bool isSpatialIndexEnabled() const = 0;
+
+		//! Brings the spatial index up to date with the current absolute transformations of the nodes.
+		/** drawAll() does this after animating the nodes and the queries of
+		ISceneCollisionManager before they use the index. Calling it after moving
+		nodes only moves the work to an earlier point. */
+		virtual void updateSpatialIndex() = 0;
+
 	protected:
 
 		virtual IMeshSceneNode* addOctreeSceneNode(const core::array<scene::IMeshBuffer*>& meshes, IMesh* origMesh, ISceneNode* parent=0,
@@ -49,7 +49,7 @@ namespace scene
 			: RelativeTranslation(position), RelativeRotation(rotation), RelativeScale(scale),
 				Parent(0), SceneManager(mgr), TriangleSelector(0), ID(id),
 				AutomaticCullingState(EAC_BOX), DebugDataVisible(EDS_OFF),
-				IsVisible(true), IsDebugObject(false)
+				ChangedID(1), IsVisible(true), IsDebugObject(false)
 		{
 			if (parent)
 				parent->addChild(this);
@@ -268,6 +268,8 @@ namespace scene
 		\param isVisible If the node shall be visible. */
 		virtual void setVisible(bool isVisible)
 		{
+			if (IsVisible != isVisible)
+				invalidate();
 			IsVisible = isVisible;
 		}
 
@@ -306,6 +308,7 @@ namespace scene
 				child->remove(); // remove from old parent
 				Children.push_back(child);
 				child->Parent = this;
+				invalidate();
 			}
 		}
 
@@ -325,6 +328,7 @@ namespace scene
 					(*it)->Parent = 0;
 					(*it)->drop();
 					Children.erase(it);
+					invalidate();
 					return true;
 				}
 
@@ -346,6 +350,8 @@ namespace scene
 				(*it)->drop();
 			}
 
+			if (!Children.empty())
+				invalidate();
 			Children.clear();
 		}
 
@@ -668,13 +674,36 @@ namespace scene
 			hierarchy you might want to update the parents first.*/
 		virtual void updateAbsolutePosition()
 		{
-			if (Parent)
+			const core::matrix4 transformation = Parent ?
+				Parent->getAbsoluteTransformation() * getRelativeTransformation() :
+				getRelativeTransformation();
+
+			if (transformation != AbsoluteTransformation)
 			{
-				AbsoluteTransformation =
-					Parent->getAbsoluteTransformation() * getRelativeTransformation();
+				AbsoluteTransformation = transformation;
+				invalidate();
 			}
-			else
-				AbsoluteTransformation = getRelativeTransformation();
+		}
+
+
+		//! Marks the node as changed.
+		/** Increases the changed id of the node and of all its parents, see
+		getChangedID(). Adding and removing children, changing the visibility
+		and a new absolute transformation call this. Call it when the bounding
+		box of a node changes outside of OnAnimate(). */
+		void invalidate()
+		{
+			for (ISceneNode* node = this; node; node = node->Parent)
+				++node->ChangedID;
+		}
+
+
+		//! Returns a number which changes whenever the node or one of its children changed.
+		/** The spatial index of the scene manager is only updated when the id of
+		the root node changed, see ISceneManager::setSpatialIndexEnabled(). */
+		u32 getChangedID() const
+		{
+			return ChangedID;
 		}
 
 
@@ -751,6 +780,7 @@ namespace scene
 			DebugDataVisible = in->getAttributeAsInt("DebugDataVisible", DebugDataVisible);
 			IsDebugObject = in->getAttributeAsBool("IsDebugObject", IsDebugObject);
 
+			invalidate();
 			updateAbsolutePosition();
 		}
 
@@ -863,6 +893,9 @@ namespace scene
 		//! Flag if debug data should be drawn, such as Bounding Boxes.
 		u32 DebugDataVisible;
 
+		//! Increased by invalidate()
+		u32 ChangedID;
+
 		//! Is the node visible?
 		bool IsVisible;
 
@@ -29,6 +29,16 @@ namespace scene
 
 		//! Updates the shadow volumes for current light positions.
 		virtual void updateShadowVolumes() = 0;
+
+		//! Sets how far a light has to move before its shadow volume is rebuilt.
+		/** As long as the shadow mesh does not change, the shadow volume of
+		a light is reused until the light moved further than this distance,
+		in the coordinate system of the shadowed node. Default is 0, which
+		only reuses the shadow volume while the light stands still. */
+		virtual void setLightMoveThreshold(f32 distance) = 0;
+
+		//! Gets how far a light has to move before its shadow volume is rebuilt.
+		virtual f32 getLightMoveThreshold() const = 0;
 	};
 
 } // end namespace scene
@@ -134,6 +134,19 @@ namespace scene
 		size. */
 		virtual bool overrideLODDistance(s32 LOD, f64 newDistance) =0;
 
+		//! Enables or disables geomorphing.
+		/** With geomorphing, the vertices which a patch drops at the next
+		lower level of detail are moved smoothly onto the lower detail surface
+		in the second half of the distance range of a level, so patches don't
+		pop when they change their level of detail. This costs updating the
+		vertices of the patches whose distance changed. Triangle selectors
+		created while geomorphing is enabled see the moved vertices.
+		Disabled by default. */
+		virtual void setGeomorphing(bool enable) =0;
+
+		//! Check if geomorphing is enabled.
+		virtual bool isGeomorphing() const =0;
+
 		//! Scales the base texture, similar to makePlanarTextureMapping.
 		/** \param scale The scaling amount. Values above 1.0
 		increase the number of time the texture is drawn on the
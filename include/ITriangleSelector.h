@@ -98,6 +98,33 @@ public:
 		s32& outTriangleCount, const core::line3d<f32>& line,
 		const core::matrix4* transform=0) const = 0;
 
+	//! Check if the selector can find the nearest triangle hit by a 3d line by itself.
+	/** Selectors which return true implement getIntersectionWithLine(), which
+	is then used by ISceneCollisionManager::getCollisionPoint() instead of
+	checking all triangles returned by getTriangles().
+	\return True if getIntersectionWithLine() is supported. */
+	virtual bool hasIntersectionWithLine() const
+	{
+		return false;
+	}
+
+	//! Get the nearest intersection of a 3d line with the triangles of the selector.
+	/** Only supported by selectors for which hasIntersectionWithLine() returns
+	true, like the one created by ISceneManager::createBVHTriangleSelector().
+	No triangles are copied to find the intersection.
+	\param line The line, in world space.
+	\param outIntersection Receives the intersection nearest to the start of the line.
+	\param outTriangle Receives the triangle which was hit, in world space.
+	\param outNode Receives the scene node of the triangle.
+	\return True if the line hits a triangle, false if not or if the
+	selector doesn't support this. */
+	virtual bool getIntersectionWithLine(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		ISceneNode*& outNode) const
+	{
+		return false;
+	}
+
 	//! Get scene node associated with a given triangle.
 	/**
 	This allows to find which scene node (potentially of several) is
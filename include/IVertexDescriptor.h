@@ -222,7 +222,37 @@ namespace video
 			return AttributePointer.size();
 		}
 
+		//! Grabs the descriptor.
+		/** Descriptors are shared by all mesh buffers, which may also be created
+		by meshes parsed on worker threads. So the reference counter is locked. */
+		void grab() const
+		{
+			lockReferenceCount(true);
+			IReferenceCounted::grab();
+			lockReferenceCount(false);
+		}
+
+		//! Drops the descriptor.
+		/** eturn True, if the descriptor was deleted. */
+		bool drop() const
+		{
+			lockReferenceCount(true);
+			// nobody else can grab the last reference, so it's deleted unlocked
+			const bool last = getReferenceCount() == 1;
+			if (!last)
+				IReferenceCounted::drop();
+			lockReferenceCount(false);
+
+			if (last)
+				IReferenceCounted::drop();
+
+			return last;
+		}
+
 	protected:
+		//! Locks or unlocks the reference counter for grab() and drop().
+		virtual void lockReferenceCount(bool lock) const = 0;
+
 		u32 ID;
 
 		core::stringc Name;
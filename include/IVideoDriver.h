@@ -21,6 +21,7 @@
 #include "SExposedVideoData.h"
 
 #include "IHardwareBuffer.h"
+#include "IAssetRequest.h"
 
 namespace irr
 {
@@ -486,6 +487,22 @@ namespace video
 		IReferenceCounted::drop() for more information. */
 		virtual ITexture* getTexture(io::IReadFile* file) =0;
 
+		//! Loads a texture in the background.
+		/** The file is decoded by the worker threads of the engine and
+		the texture is created during one of the next calls to
+		beginScene(), see setTextureLoadBudget(). The texture ends up in
+		the texture cache just like with getTexture(). Textures which are
+		in the cache already are ready right away.
+		\param filename Filename of the texture to be loaded.
+		\return The request, never 0. Drop it when it isn't needed
+		anymore. See IReferenceCounted::drop() for more information. */
+		virtual io::IAssetRequest* requestTexture(const io::path& filename) =0;
+
+		//! Set the time beginScene() may spend creating requested textures.
+		/** At least one loaded texture is created per frame.
+		\param milliseconds Time per frame, default is 4. */
+		virtual void setTextureLoadBudget(u32 milliseconds) =0;
+
 		//! Returns a texture by index
 		/** \param index: Index of the texture, must be smaller than
 		getTextureCount() Please note that this index might change when
@@ -1027,6 +1044,17 @@ namespace video
 		/** \param mb Buffer to draw */
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) =0;
 
+		//! Draws a range of the indices of a mesh buffer
+		/** Uses the vertices and indices of the mesh buffer just like
+		drawMeshBuffer, but only draws the primitives of the given part of
+		the index buffer. The buffers are not changed, so their hardware
+		buffers can stay static while different parts are drawn.
+		\param mb Buffer to draw
+		\param firstIndex Position of the first index to draw in the
+		index buffer
+		\param indexCount Number of indices to draw */
+		virtual void drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount) =0;
+
 		//! Draws normals of a mesh buffer
 		/** \param mb Buffer to draw the normals of
 		\param length length scale factor of the normals
@@ -1441,6 +1469,40 @@ namespace video
 		enabled or disabled. */
 		virtual void enableMaterial2D(bool enable=true) =0;
 
+		//! Check if the 2d override material is enabled
+		/** \return True if the 2d override material is used. */
+		virtual bool isMaterial2DEnabled() const =0;
+
+		//! Enable collecting 2d images and rectangles into batches
+		/** When enabled, draw2DImage, draw2DImageBatch and
+		draw2DRectangle don't draw immediately. Following images with
+		the same texture and rectangles are collected and drawn with one
+		call, clipping is done on the CPU. The batch is drawn when the
+		texture changes, before anything else is drawn and at the end
+		of the scene. Only the OpenGL and Direct3D 9 drivers batch, the
+		others ignore this and always draw immediately. Enabled by
+		default.
+		\param enable Flag which tells whether 2d batching shall be
+		enabled or disabled. */
+		virtual void enable2DBatching(bool enable=true) =0;
+
+		//! Check if 2d images and rectangles are collected into batches
+		/** \return False if batching was disabled or the driver can't
+		batch. */
+		virtual bool is2DBatchingEnabled() const =0;
+
+		//! Draw the collected 2d images and rectangles
+		/** The driver does this itself when needed, this is only
+		necessary before drawing with the underlying graphics API
+		directly. */
+		virtual void flush2DBatch() =0;
+
+		//! Get the number of 2d batches drawn since the last beginScene()
+		/** Each batch is drawn with one call of the graphics API, its
+		triangles are counted by getPrimitiveCountDrawn(). Drivers
+		which don't batch return 0. */
+		virtual u32 get2DBatchCount() const =0;
+
 		//! Get the graphics card vendor name.
 		virtual core::stringc getVendorInfo() =0;
 
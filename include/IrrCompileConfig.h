@@ -144,6 +144,39 @@ while it runs and enabling it will slow down the engine. */
 #undef _IRR_COMPILE_WITH_PROFILING_
 #endif
 
+//! Define _IRR_COMPILE_WITH_THREADS_ to let the engine spread work over several worker threads
+/** This uses pthreads, or the Windows API on Windows Vista and newer. When disabled all
+work is done on the calling thread. The number of threads is selected with
+SIrrlichtCreationParameters::WorkerThreads. */
+#define _IRR_COMPILE_WITH_THREADS_
+#ifdef NO_IRR_COMPILE_WITH_THREADS_
+#undef _IRR_COMPILE_WITH_THREADS_
+#endif
+
+//! Define _IRR_COMPILE_WITH_SSE2_ to use SSE2 code paths in performance critical parts of the engine
+/** Enabled when the compiler can generate SSE2 instructions. With 32bit Visual Studio builds
+the processor is checked at runtime and the plain C++ code is used if it has no SSE2. */
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_MSC_VER) && (_MSC_VER >= 1400) && defined(_M_IX86))
+#define _IRR_COMPILE_WITH_SSE2_
+#endif
+#ifdef NO_IRR_COMPILE_WITH_SSE2_
+#undef _IRR_COMPILE_WITH_SSE2_
+#endif
+
+//! Define _IRR_COMPILE_WITH_MAPPED_FILES_ to map files into memory instead of reading them with stdio
+/** Files on disk are mapped with mmap or MapViewOfFile, IReadFile::getData() then gives direct
+access to their content and also to files stored uncompressed in archives. Files which can't be
+mapped, for example because the address space is too small, are read with stdio. A mapped file
+must not be truncated by another process while it is open, reading the pages beyond the new end
+raises SIGBUS on POSIX systems and an access violation on Windows. Define
+NO_IRR_COMPILE_WITH_MAPPED_FILES_ if the files an application reads may change that way. */
+#if defined(_IRR_POSIX_API_) || defined(_IRR_WINDOWS_API_)
+#define _IRR_COMPILE_WITH_MAPPED_FILES_
+#endif
+#ifdef NO_IRR_COMPILE_WITH_MAPPED_FILES_
+#undef _IRR_COMPILE_WITH_MAPPED_FILES_
+#endif
+
 //! Define _IRR_COMPILE_WITH_DIRECT3D_8_ and _IRR_COMPILE_WITH_DIRECT3D_9_ to
 //! compile the Irrlicht engine with Direct3D8 and/or DIRECT3D9.
 /** If you only want to use the software device or opengl you can disable those defines.
@@ -46,6 +46,7 @@ namespace irr
 #endif
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
+			WorkerThreads(0),
 			UsePerformanceTimer(true),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION)
 		{
@@ -77,6 +78,7 @@ namespace irr
 			WindowId = other.WindowId;
 			LoggingLevel = other.LoggingLevel;
 			DriverMultithreaded = other.DriverMultithreaded;
+			WorkerThreads = other.WorkerThreads;
 			DisplayAdapter = other.DisplayAdapter;
 			UsePerformanceTimer = other.UsePerformanceTimer;
 			return *this;
@@ -279,9 +281,18 @@ namespace irr
 		//! Create the driver multithreaded.
 		/** Default is false. Enabling this can slow down your application.
 			Note that this does _not_ make Irrlicht threadsafe, but only the underlying driver-API for the graphiccard.
-			So far only supported on D3D. */
+			On D3D this creates the device multithreaded. On Burning's Video it enables the
+			tile-binned rasterizer, which rasterizes horizontal bands of the render target on
+			all worker threads (see WorkerThreads) and renders the same pixels as the single
+			threaded path. Transformation and clipping stay on the calling thread. */
 		bool DriverMultithreaded;
 
+		//! Number of threads the engine uses for parallel work.
+		/** This includes the calling thread, so 1 disables worker threads. 0 selects one
+		thread per CPU core. Default: 0. Ignored when the engine is compiled without
+		_IRR_COMPILE_WITH_THREADS_. */
+		u32 WorkerThreads;
+
 		//! Enables use of high performance timers on Windows platform.
 		/** When performance timers are not used, standard GetTickCount()
 		is used instead which usually has worse resolution, but also less
@@ -48,6 +48,25 @@ namespace scene
 		core::dimension2df startSize;
 	};
 
+	//! Per instance data of a particle drawn as instanced billboard.
+	/** See IParticleSystemSceneNode::setInstancedBillboards(). */
+	struct SParticleInstance
+	{
+		//! Position of the particle
+		core::vector3df Pos;
+
+		//! Width and height of the particle
+		core::dimension2df Size;
+
+		//! Current color of the particle, its bytes are blue, green, red and alpha
+		video::SColor Color;
+
+		bool operator==(const SParticleInstance& other) const
+		{
+			return Pos == other.Pos && Size == other.Size && Color == other.Color;
+		}
+	};
+
 
 } // end namespace scene
 } // end namespace irr
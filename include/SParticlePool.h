@@ -0,0 +1,151 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_PARTICLE_POOL_H_INCLUDED__
+#define __S_PARTICLE_POOL_H_INCLUDED__
+
+#include "SParticle.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace scene
+{
+	//! Particles stored as structure of arrays.
+	/** Each member of SParticle is split into arrays of its components, so
+	affectors only touch the data they need and can work on several particles
+	at once with SIMD instructions. All arrays always have the same size. */
+	struct SParticlePool
+	{
+		//! Position of the particles
+		core::array<f32> PosX, PosY, PosZ;
+		//! Direction and speed of the particles
+		core::array<f32> VectorX, VectorY, VectorZ;
+		//! Original direction and speed of the particles
+		core::array<f32> StartVectorX, StartVectorY, StartVectorZ;
+		//! Start life time of the particles
+		core::array<u32> StartTime;
+		//! End life time of the particles
+		core::array<u32> EndTime;
+		//! Current color of the particles
+		core::array<video::SColor> Color;
+		//! Original color of the particles
+		core::array<video::SColor> StartColor;
+		//! Current scale of the particles
+		core::array<f32> Width, Height;
+		//! Original scale of the particles
+		core::array<f32> StartWidth, StartHeight;
+
+		//! Returns the number of particles.
+		u32 size() const
+		{
+			return StartTime.size();
+		}
+
+		//! Removes all particles.
+		void clear()
+		{
+			resize(0);
+		}
+
+		//! Reserves memory for a number of particles.
+		void reallocate(u32 count)
+		{
+			if (count <= StartTime.allocated_size())
+				return;
+
+			PosX.reallocate(count); PosY.reallocate(count); PosZ.reallocate(count);
+			VectorX.reallocate(count); VectorY.reallocate(count); VectorZ.reallocate(count);
+			StartVectorX.reallocate(count); StartVectorY.reallocate(count); StartVectorZ.reallocate(count);
+			StartTime.reallocate(count);
+			EndTime.reallocate(count);
+			Color.reallocate(count);
+			StartColor.reallocate(count);
+			Width.reallocate(count); Height.reallocate(count);
+			StartWidth.reallocate(count); StartHeight.reallocate(count);
+		}
+
+		//! Adds a particle at the end.
+		void push_back(const SParticle& particle)
+		{
+			const u32 i = size();
+			if (i == StartTime.allocated_size())
+				reallocate(i < 16 ? 16 : i * 2);
+
+			resize(i + 1);
+			set(i, particle);
+		}
+
+		//! Returns a particle.
+		SParticle get(u32 i) const
+		{
+			SParticle particle;
+			particle.pos.set(PosX[i], PosY[i], PosZ[i]);
+			particle.vector.set(VectorX[i], VectorY[i], VectorZ[i]);
+			particle.startVector.set(StartVectorX[i], StartVectorY[i], StartVectorZ[i]);
+			particle.startTime = StartTime[i];
+			particle.endTime = EndTime[i];
+			particle.color = Color[i];
+			particle.startColor = StartColor[i];
+			particle.size.set(Width[i], Height[i]);
+			particle.startSize.set(StartWidth[i], StartHeight[i]);
+			return particle;
+		}
+
+		//! Replaces a particle.
+		void set(u32 i, const SParticle& particle)
+		{
+			PosX[i] = particle.pos.X; PosY[i] = particle.pos.Y; PosZ[i] = particle.pos.Z;
+			VectorX[i] = particle.vector.X; VectorY[i] = particle.vector.Y; VectorZ[i] = particle.vector.Z;
+			StartVectorX[i] = particle.startVector.X; StartVectorY[i] = particle.startVector.Y; StartVectorZ[i] = particle.startVector.Z;
+			StartTime[i] = particle.startTime;
+			EndTime[i] = particle.endTime;
+			Color[i] = particle.color;
+			StartColor[i] = particle.startColor;
+			Width[i] = particle.size.Width; Height[i] = particle.size.Height;
+			StartWidth[i] = particle.startSize.Width; StartHeight[i] = particle.startSize.Height;
+		}
+
+		//! Removes a particle by moving the last particle into its place.
+		void swapRemove(u32 i)
+		{
+			const u32 last = size() - 1;
+			if (i != last)
+			{
+				PosX[i] = PosX[last]; PosY[i] = PosY[last]; PosZ[i] = PosZ[last];
+				VectorX[i] = VectorX[last]; VectorY[i] = VectorY[last]; VectorZ[i] = VectorZ[last];
+				StartVectorX[i] = StartVectorX[last]; StartVectorY[i] = StartVectorY[last]; StartVectorZ[i] = StartVectorZ[last];
+				StartTime[i] = StartTime[last];
+				EndTime[i] = EndTime[last];
+				Color[i] = Color[last];
+				StartColor[i] = StartColor[last];
+				Width[i] = Width[last]; Height[i] = Height[last];
+				StartWidth[i] = StartWidth[last]; StartHeight[i] = StartHeight[last];
+			}
+
+			resize(last);
+		}
+
+	private:
+
+		// new elements are only valid after set()
+		void resize(u32 count)
+		{
+			PosX.set_used(count); PosY.set_used(count); PosZ.set_used(count);
+			VectorX.set_used(count); VectorY.set_used(count); VectorZ.set_used(count);
+			StartVectorX.set_used(count); StartVectorY.set_used(count); StartVectorZ.set_used(count);
+			StartTime.set_used(count);
+			EndTime.set_used(count);
+			Color.set_used(count);
+			StartColor.set_used(count);
+			Width.set_used(count); Height.set_used(count);
+			StartWidth.set_used(count); StartHeight.set_used(count);
+		}
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
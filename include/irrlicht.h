@@ -59,6 +59,7 @@
 #include "IAnimatedMeshMD2.h"
 #include "IAnimatedMeshMD3.h"
 #include "IAnimatedMeshSceneNode.h"
+#include "IAssetRequest.h"
 #include "IAttributeExchangingObject.h"
 #include "IAttributes.h"
 #include "IBillboardSceneNode.h"
@@ -118,6 +119,7 @@
 #include "IColladaMeshWriter.h"
 #include "IMetaTriangleSelector.h"
 #include "IOSOperator.h"
+#include "IPagedTerrainSceneNode.h"
 #include "IParticleSystemSceneNode.h" // also includes all emitters and attractors
 #include "IQ3LevelMesh.h"
 #include "IQ3Shader.h"
@@ -180,6 +182,7 @@
 #include "SMaterial.h"
 #include "SMesh.h"
 #include "SParticle.h"
+#include "SParticlePool.h"
 #include "SViewFrustum.h"
 #include "triangle3d.h"
 #include "vector2d.h"
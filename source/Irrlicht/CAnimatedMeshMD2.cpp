@@ -9,6 +9,11 @@
 #include "SColor.h"
 #include "irrMath.h"
 #include "IVideoDriver.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
 
 namespace irr
 {
@@ -18,6 +23,9 @@ namespace scene
 const s32 MD2_FRAME_SHIFT	= 2;
 const f32 MD2_FRAME_SHIFT_RECIPROCAL = 1.f / (1 << MD2_FRAME_SHIFT);
 
+//! maximum number of interpolated frames kept per mesh
+const u32 MD2_MORPH_CACHE_SIZE = 32;
+
 const s32 Q2_VERTEX_NORMAL_TABLE_SIZE = 162;
 
 static const f32 Q2_VERTEX_NORMAL_TABLE[Q2_VERTEX_NORMAL_TABLE_SIZE][3] = {
@@ -220,7 +228,8 @@ static const SMD2AnimationType MD2AnimationTypeList[21] =
 
 //! constructor
 CAnimatedMeshMD2::CAnimatedMeshMD2(video::IVideoDriver* pDriver)
-	: InterpolationBuffer(0), FrameList(0), FrameCount(0), FramesPerSecond((f32)(MD2AnimationTypeList[0].fps << MD2_FRAME_SHIFT))
+	: InterpolationBuffer(0), FrameList(0), FrameCount(0), MorphUseCounter(0), CurrentBuffer(0),
+	FramesPerSecond((f32)(MD2AnimationTypeList[0].fps << MD2_FRAME_SHIFT)), UseSSE2(os::Cpu::hasSSE2())
 {
 	#ifdef _DEBUG
 	IAnimatedMesh::setDebugName("CAnimatedMeshMD2 IAnimatedMesh");
@@ -233,6 +242,12 @@ CAnimatedMeshMD2::CAnimatedMeshMD2(video::IVideoDriver* pDriver)
 //! destructor
 CAnimatedMeshMD2::~CAnimatedMeshMD2()
 {
+	for (u32 i=0; i<MorphTargets.size(); ++i)
+		MorphTargets[i].Mesh->drop();
+
+	if (CurrentBuffer)
+		CurrentBuffer->drop();
+
 	delete [] FrameList;
 	if (InterpolationBuffer)
 		InterpolationBuffer->drop();
@@ -247,8 +262,13 @@ u32 CAnimatedMeshMD2::getFrameCount() const
 
 
 //! returns the animated mesh based on a detail level. 0 is the lowest, 255 the highest detail. Note, that some Meshes will ignore the detail level.
+/** All nodes showing the same frame share one mesh, so hundreds of nodes
+with the same animation only interpolate each frame once. */
 IMesh* CAnimatedMeshMD2::getMesh(s32 frame, s32 detailLevel, s32 startFrameLoop, s32 endFrameLoop)
 {
+	if (!FrameCount)
+		return this;
+
 	if ((u32)frame > getFrameCount())
 		frame = (frame % getFrameCount());
 
@@ -258,8 +278,26 @@ IMesh* CAnimatedMeshMD2::getMesh(s32 frame, s32 detailLevel, s32 startFrameLoop,
 		endFrameLoop = getFrameCount();
 	}
 
-	updateInterpolationBuffer(frame, startFrameLoop, endFrameLoop);
-	return this;
+	u32 firstFrame, secondFrame, blend;
+	getKeyFrames(frame, startFrameLoop, endFrameLoop, firstFrame, secondFrame, blend);
+
+	SMorphTarget& target = getMorphTarget(firstFrame, secondFrame, blend);
+
+	if (target.Buffer != CurrentBuffer)
+	{
+		// the material may have been changed on the buffer returned before
+		InterpolationBuffer->getMaterial() = getMeshBuffer(0)->getMaterial();
+		target.Buffer->getMaterial() = InterpolationBuffer->getMaterial();
+
+		// the mesh itself shows the last frame, e.g. for shadow volumes
+		target.Buffer->grab();
+		if (CurrentBuffer)
+			CurrentBuffer->drop();
+		CurrentBuffer = target.Buffer;
+	}
+	InterpolationBuffer->getBoundingBox() = target.Buffer->getBoundingBox();
+
+	return target.Mesh;
 }
 
 
@@ -274,7 +312,7 @@ u32 CAnimatedMeshMD2::getMeshBufferCount() const
 IMeshBuffer* CAnimatedMeshMD2::getMeshBuffer(u32 nr) const
 {
 	if (nr == 0)
-		return InterpolationBuffer;
+		return CurrentBuffer ? CurrentBuffer : InterpolationBuffer;
 	else
 		return 0;
 }
@@ -283,26 +321,24 @@ IMeshBuffer* CAnimatedMeshMD2::getMeshBuffer(u32 nr) const
 //! Returns pointer to a mesh buffer which fits a material
 IMeshBuffer* CAnimatedMeshMD2::getMeshBuffer(const video::SMaterial &material) const
 {
-	if (InterpolationBuffer->getMaterial() == material)
-		return InterpolationBuffer;
+	if (getMeshBuffer(0)->getMaterial() == material)
+		return getMeshBuffer(0);
 	else
 		return 0;
 }
 
 
-// updates the interpolation buffer
-void CAnimatedMeshMD2::updateInterpolationBuffer(s32 frame, s32 startFrameLoop, s32 endFrameLoop)
+// finds the keyframes and the blend step between them
+void CAnimatedMeshMD2::getKeyFrames(s32 frame, s32 startFrameLoop, s32 endFrameLoop,
+		u32& firstFrame, u32& secondFrame, u32& blend) const
 {
-	u32 firstFrame, secondFrame;
-	f32 div;
-
 	// TA: resolve missing ipol in loop between end-start
 
 	if (endFrameLoop - startFrameLoop == 0)
 	{
 		firstFrame = frame>>MD2_FRAME_SHIFT;
 		secondFrame = frame>>MD2_FRAME_SHIFT;
-		div = 1.0f;
+		blend = 0;
 	}
 	else
 	{
@@ -316,39 +352,146 @@ void CAnimatedMeshMD2::updateInterpolationBuffer(s32 frame, s32 startFrameLoop,
 		firstFrame = core::s32_min(FrameCount - 1, firstFrame);
 		secondFrame = core::s32_min(FrameCount - 1, secondFrame);
 
-		//div = (frame % (1<<MD2_FRAME_SHIFT)) / (f32)(1<<MD2_FRAME_SHIFT);
-		frame &= (1<<MD2_FRAME_SHIFT) - 1;
-		div = frame * MD2_FRAME_SHIFT_RECIPROCAL;
+		blend = frame & ((1<<MD2_FRAME_SHIFT) - 1);
+	}
+
+	// all blend steps between the same frames give the same result
+	if (firstFrame == secondFrame)
+		blend = 0;
+}
+
+
+// returns a cached morph target or interpolates a new one
+CAnimatedMeshMD2::SMorphTarget& CAnimatedMeshMD2::getMorphTarget(u32 firstFrame, u32 secondFrame, u32 blend)
+{
+	++MorphUseCounter;
+
+	u32 oldest = 0;
+	for (u32 i=0; i<MorphTargets.size(); ++i)
+	{
+		SMorphTarget& target = MorphTargets[i];
+		if (target.FirstFrame == firstFrame && target.SecondFrame == secondFrame && target.Blend == blend)
+		{
+			target.LastUse = MorphUseCounter;
+			return target;
+		}
+
+		if (target.LastUse < MorphTargets[oldest].LastUse)
+			oldest = i;
+	}
+
+	if (MorphTargets.size() < MD2_MORPH_CACHE_SIZE)
+	{
+		oldest = MorphTargets.size();
+		MorphTargets.push_back(SMorphTarget());
+	}
+
+	SMorphTarget& target = MorphTargets[oldest];
+
+	// a mesh which is still grabbed by someone else is left as it is
+	if (target.Mesh && target.Mesh->getReferenceCount() > 1)
+	{
+		target.Mesh->drop();
+		target.Mesh = 0;
+	}
+
+	if (!target.Mesh)
+	{
+		// texture coordinates and colors are copied once, the indices are shared
+		target.Buffer = new CMeshBuffer<video::S3DVertex>(InterpolationBuffer->getVertexDescriptor());
+		target.Buffer->getVertexBuffer()->set_used(InterpolationBuffer->getVertexBuffer()->getVertexCount());
+		memcpy(target.Buffer->getVertexBuffer()->getVertices(), InterpolationBuffer->getVertexBuffer()->getVertices(),
+			InterpolationBuffer->getVertexBuffer()->getVertexCount() * sizeof(video::S3DVertex));
+		target.Buffer->setIndexBuffer(InterpolationBuffer->getIndexBuffer());
+		target.Buffer->setHardwareMappingHint(InterpolationBuffer->getVertexBuffer()->getHardwareMappingHint(), EBT_VERTEX);
+		target.Buffer->setHardwareMappingHint(InterpolationBuffer->getIndexBuffer()->getHardwareMappingHint(), EBT_INDEX);
+
+		target.Mesh = new SMesh();
+		target.Mesh->addMeshBuffer(target.Buffer);
+		target.Buffer->drop();
 	}
 
-	video::S3DVertex* target = static_cast<video::S3DVertex*>(InterpolationBuffer->getVertexBuffer()->getVertices());
-	SMD2Vert* first = FrameList[firstFrame].pointer();
-	SMD2Vert* second = FrameList[secondFrame].pointer();
+	target.FirstFrame = firstFrame;
+	target.SecondFrame = secondFrame;
+	target.Blend = blend;
+	target.LastUse = MorphUseCounter;
+
+	const f32 div = blend * MD2_FRAME_SHIFT_RECIPROCAL;
+	interpolate(static_cast<video::S3DVertex*>(target.Buffer->getVertexBuffer()->getVertices()), firstFrame, secondFrame, div);
+
+	target.Buffer->getBoundingBox() = BoxList[secondFrame].getInterpolated(BoxList[firstFrame], div);
+	target.Mesh->BoundingBox = target.Buffer->getBoundingBox();
+	target.Buffer->setDirty(EBT_VERTEX);
+
+	return target;
+}
 
-	// interpolate both frames
+
+// interpolates two keyframes into a vertex array
+void CAnimatedMeshMD2::interpolate(video::S3DVertex* target, u32 firstFrame, u32 secondFrame, f32 div) const
+{
+	const SMD2Vert* first = FrameList[firstFrame].const_pointer();
+	const SMD2Vert* second = FrameList[secondFrame].const_pointer();
 	const u32 count = FrameList[firstFrame].size();
-	for (u32 i=0; i<count; ++i)
+
+	// the transformation of both keyframes and the blend are folded into
+	// one scale per keyframe and one translation
+	const f32 inv = 1.f - div;
+	const core::vector3df scale1 = FrameTransforms[firstFrame].scale * inv;
+	const core::vector3df scale2 = FrameTransforms[secondFrame].scale * div;
+	const core::vector3df translate = FrameTransforms[firstFrame].translate * inv + FrameTransforms[secondFrame].translate * div;
+
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		// the normal index in the fourth byte is multiplied by 0
+		const __m128 s1 = _mm_setr_ps(scale1.X, scale1.Y, scale1.Z, 0.f);
+		const __m128 s2 = _mm_setr_ps(scale2.X, scale2.Y, scale2.Z, 0.f);
+		const __m128 t = _mm_setr_ps(translate.X, translate.Y, translate.Z, 0.f);
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; i < count; ++i)
+		{
+			s32 packed1, packed2;
+			memcpy(&packed1, first + i, sizeof(s32));
+			memcpy(&packed2, second + i, sizeof(s32));
+
+			const __m128 p1 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed1), zero), zero));
+			const __m128 p2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed2), zero), zero));
+
+			// also writes the first component of the normal, which is set below
+			_mm_storeu_ps(&target[i].Pos.X, _mm_add_ps(_mm_add_ps(_mm_mul_ps(p1, s1), _mm_mul_ps(p2, s2)), t));
+
+			const f32* n1 = Q2_VERTEX_NORMAL_TABLE[first[i].NormalIdx];
+			const f32* n2 = Q2_VERTEX_NORMAL_TABLE[second[i].NormalIdx];
+			target[i].Normal.set(n1[0] * inv + n2[0] * div, n1[2] * inv + n2[2] * div, n1[1] * inv + n2[1] * div);
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
 	{
-		const core::vector3df one = core::vector3df(f32(first->Pos.X) * FrameTransforms[firstFrame].scale.X + FrameTransforms[firstFrame].translate.X,
-				f32(first->Pos.Y) * FrameTransforms[firstFrame].scale.Y + FrameTransforms[firstFrame].translate.Y,
-				f32(first->Pos.Z) * FrameTransforms[firstFrame].scale.Z + FrameTransforms[firstFrame].translate.Z);
-		const core::vector3df two = core::vector3df(f32(second->Pos.X) * FrameTransforms[secondFrame].scale.X + FrameTransforms[secondFrame].translate.X,
-				f32(second->Pos.Y) * FrameTransforms[secondFrame].scale.Y + FrameTransforms[secondFrame].translate.Y,
-				f32(second->Pos.Z) * FrameTransforms[secondFrame].scale.Z + FrameTransforms[secondFrame].translate.Z);
-		target->Pos = two.getInterpolated(one, div);
-		const core::vector3df n1(
-				Q2_VERTEX_NORMAL_TABLE[first->NormalIdx][0],
-				Q2_VERTEX_NORMAL_TABLE[first->NormalIdx][2],
-				Q2_VERTEX_NORMAL_TABLE[first->NormalIdx][1]);
-		const core::vector3df n2(
-				Q2_VERTEX_NORMAL_TABLE[second->NormalIdx][0],
-				Q2_VERTEX_NORMAL_TABLE[second->NormalIdx][2],
-				Q2_VERTEX_NORMAL_TABLE[second->NormalIdx][1]);
-		target->Normal = n2.getInterpolated(n1, div);
-		++target;
-		++first;
-		++second;
+		target[i].Pos.set(first[i].Pos.X * scale1.X + second[i].Pos.X * scale2.X + translate.X,
+			first[i].Pos.Y * scale1.Y + second[i].Pos.Y * scale2.Y + translate.Y,
+			first[i].Pos.Z * scale1.Z + second[i].Pos.Z * scale2.Z + translate.Z);
+
+		const f32* n1 = Q2_VERTEX_NORMAL_TABLE[first[i].NormalIdx];
+		const f32* n2 = Q2_VERTEX_NORMAL_TABLE[second[i].NormalIdx];
+		target[i].Normal.set(n1[0] * inv + n2[0] * div, n1[2] * inv + n2[2] * div, n1[1] * inv + n2[1] * div);
 	}
+}
+
+
+// updates the interpolation buffer
+void CAnimatedMeshMD2::updateInterpolationBuffer(s32 frame, s32 startFrameLoop, s32 endFrameLoop)
+{
+	u32 firstFrame, secondFrame, blend;
+	getKeyFrames(frame, startFrameLoop, endFrameLoop, firstFrame, secondFrame, blend);
+
+	const f32 div = blend * MD2_FRAME_SHIFT_RECIPROCAL;
+	interpolate(static_cast<video::S3DVertex*>(InterpolationBuffer->getVertexBuffer()->getVertices()), firstFrame, secondFrame, div);
 
 	//update bounding box
 	InterpolationBuffer->getBoundingBox() = BoxList[secondFrame].getInterpolated(BoxList[firstFrame], div);
@@ -360,6 +503,10 @@ void CAnimatedMeshMD2::updateInterpolationBuffer(s32 frame, s32 startFrameLoop,
 void CAnimatedMeshMD2::setMaterialFlag(video::E_MATERIAL_FLAG flag, bool newvalue)
 {
 	InterpolationBuffer->getMaterial().setFlag(flag, newvalue);
+	if (CurrentBuffer)
+		CurrentBuffer->getMaterial().setFlag(flag, newvalue);
+	for (u32 i=0; i<MorphTargets.size(); ++i)
+		MorphTargets[i].Buffer->getMaterial().setFlag(flag, newvalue);
 }
 
 
@@ -368,6 +515,10 @@ void CAnimatedMeshMD2::setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint,
 		E_BUFFER_TYPE buffer)
 {
 	InterpolationBuffer->setHardwareMappingHint(newMappingHint, buffer);
+	if (CurrentBuffer)
+		CurrentBuffer->setHardwareMappingHint(newMappingHint, buffer);
+	for (u32 i=0; i<MorphTargets.size(); ++i)
+		MorphTargets[i].Buffer->setHardwareMappingHint(newMappingHint, buffer);
 }
 
 
@@ -375,6 +526,10 @@ void CAnimatedMeshMD2::setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint,
 void CAnimatedMeshMD2::setDirty(E_BUFFER_TYPE buffer)
 {
 	InterpolationBuffer->setDirty(buffer);
+	if (CurrentBuffer)
+		CurrentBuffer->setDirty(buffer);
+	for (u32 i=0; i<MorphTargets.size(); ++i)
+		MorphTargets[i].Buffer->setDirty(buffer);
 }
 
 
@@ -8,6 +8,7 @@
 #include "IAnimatedMeshMD2.h"
 #include "IMesh.h"
 #include "CMeshBuffer.h"
+#include "SMesh.h"
 #include "IReadFile.h"
 #include "S3DVertex.h"
 #include "irrArray.h"
@@ -103,7 +104,7 @@ namespace scene
 		// exposed for loader
 		//
 
-		//! the buffer that contains the most recent animation
+		//! the buffer with texture coordinates and indices for all frames, contains the start frame
 		CMeshBuffer<video::S3DVertex>* InterpolationBuffer;
 
 		//! named animations
@@ -143,12 +144,43 @@ namespace scene
 
 		u32 FrameCount;
 
-	private:
-
 		//! updates the interpolation buffer
 		void updateInterpolationBuffer(s32 frame, s32 startFrame, s32 endFrame);
 
+	private:
+
+		//! interpolated frame, shared by all nodes showing the same frame
+		struct SMorphTarget
+		{
+			SMorphTarget() : FirstFrame(0), SecondFrame(0), Blend(0), LastUse(0), Mesh(0), Buffer(0) {}
+
+			u32 FirstFrame;
+			u32 SecondFrame;
+			u32 Blend;
+			u32 LastUse;
+			SMesh* Mesh;
+			CMeshBuffer<video::S3DVertex>* Buffer;
+		};
+
+		//! finds the keyframes and the blend step between them
+		void getKeyFrames(s32 frame, s32 startFrameLoop, s32 endFrameLoop,
+			u32& firstFrame, u32& secondFrame, u32& blend) const;
+
+		//! returns a cached morph target or interpolates a new one
+		SMorphTarget& getMorphTarget(u32 firstFrame, u32 secondFrame, u32 blend);
+
+		//! interpolates two keyframes into a vertex array
+		void interpolate(video::S3DVertex* target, u32 firstFrame, u32 secondFrame, f32 div) const;
+
+		core::array<SMorphTarget> MorphTargets;
+		u32 MorphUseCounter;
+
+		//! buffer of the frame returned last, used when the mesh itself is drawn
+		CMeshBuffer<video::S3DVertex>* CurrentBuffer;
+
 		f32 FramesPerSecond;
+
+		bool UseSSE2;
 	};
 
 } // end namespace scene
@@ -37,7 +37,7 @@ CAnimatedMeshSceneNode::CAnimatedMeshSceneNode(IAnimatedMesh* mesh,
 	TransitionTime(0), Transiting(0.f), TransitingBlend(0.f),
 	JointMode(EJUOR_NONE), JointsUsed(false),
 	Looping(true), ReadOnlyMaterials(false), RenderFromIdentity(false),
-	LoopCallBack(0), PassCount(0), Shadow(0), MD3Special(0)
+	LoopCallBack(0), PassCount(0), Shadow(0), SkinningState(0), MD3Special(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CAnimatedMeshSceneNode");
@@ -61,6 +61,8 @@ CAnimatedMeshSceneNode::~CAnimatedMeshSceneNode()
 
 	if (LoopCallBack)
 		LoopCallBack->drop();
+
+	delete SkinningState;
 }
 
 
@@ -185,6 +187,45 @@ void CAnimatedMeshSceneNode::OnRegisterSceneNode()
 	}
 }
 
+bool CAnimatedMeshSceneNode::prepareSkinningState()
+{
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	if (Mesh && Mesh->getMeshType() == EAMT_SKINNED && JointMode == EJUOR_NONE && !Shadow)
+	{
+		if (!SkinningState)
+			SkinningState = new CSkinnedMesh::SAnimationState();
+
+		if (static_cast<CSkinnedMesh*>(Mesh)->prepareAnimationState(*SkinningState))
+			return true;
+	}
+
+	delete SkinningState;
+	SkinningState = 0;
+#endif
+	return false;
+}
+
+
+//! Returns true if the node's own copy of the mesh has to be skinned for the current frame
+bool CAnimatedMeshSceneNode::needsSkinningUpdate() const
+{
+	return SkinningState && SkinningState->Frame != getFrameNr();
+}
+
+
+//! Skins the node's own copy of the mesh for the current frame
+void CAnimatedMeshSceneNode::updateSkinning(bool useThreads)
+{
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	if (!SkinningState)
+		return;
+
+	static_cast<CSkinnedMesh*>(Mesh)->animateState(*SkinningState, getFrameNr(), useThreads);
+	Box = SkinningState->Mesh->getBoundingBox();
+#endif
+}
+
+
 IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 {
 	if(Mesh->getMeshType() != EAMT_SKINNED)
@@ -247,14 +288,25 @@ void CAnimatedMeshSceneNode::OnAnimate(u32 timeMs)
 	// set CurrentFrameNr
 	buildFrameNr(timeMs-LastTimeMs);
 
-	// update bbox
-	if (Mesh)
+	// update bbox, nodes with a mesh of their own update it in updateSkinning,
+	// which is called by the scene manager for all nodes in view at once or in render.
+	// Until then a box around the animated joints decides if they are in view.
+	if (Mesh && !prepareSkinningState())
 	{
 		scene::IMesh * mesh = getMeshForCurrentFrame();
 
 		if (mesh)
 			Box = mesh->getBoundingBox();
 	}
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	else if (SkinningState)
+	{
+		if (needsSkinningUpdate())
+			static_cast<CSkinnedMesh*>(Mesh)->getStateBoundingBox(*SkinningState, getFrameNr(), Box);
+		else
+			Box = SkinningState->Mesh->getBoundingBox();
+	}
+#endif
 	LastTimeMs = timeMs;
 
 	IAnimatedMeshSceneNode::OnAnimate(timeMs);
@@ -275,7 +327,26 @@ void CAnimatedMeshSceneNode::render()
 
 	++PassCount;
 
-	scene::IMesh* m = getMeshForCurrentFrame();
+	scene::IMesh* m;
+
+	// materials of read only nodes are taken from the shared mesh
+	scene::IMesh* materialMesh;
+
+	// the state is checked by the first pass and skinned once per frame,
+	// by the scene manager or the first pass which renders the node
+	const bool ownMesh = (PassCount == 1) ? prepareSkinningState() : (SkinningState != 0);
+	if (ownMesh)
+	{
+		if (needsSkinningUpdate())
+			updateSkinning(true);
+		m = SkinningState->Mesh;
+		materialMesh = static_cast<CSkinnedMesh*>(Mesh);
+	}
+	else
+	{
+		m = getMeshForCurrentFrame();
+		materialMesh = m;
+	}
 
 	if(m)
 	{
@@ -306,7 +377,7 @@ void CAnimatedMeshSceneNode::render()
 			for (u32 i=0; i<m->getMeshBufferCount(); ++i)
 			{
 				scene::IMeshBuffer* mb = m->getMeshBuffer(i);
-				mat = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+				mat = ReadOnlyMaterials ? materialMesh->getMeshBuffer(i)->getMaterial() : Materials[i];
 				mat.MaterialType = video::EMT_TRANSPARENT_ADD_COLOR;
 				if (RenderFromIdentity)
 					driver->setTransform(video::ETS_WORLD, core::IdentityMatrix );
@@ -333,7 +404,7 @@ void CAnimatedMeshSceneNode::render()
 			if (transparent == isTransparentPass)
 			{
 				scene::IMeshBuffer* mb = m->getMeshBuffer(i);
-				const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+				const video::SMaterial& material = ReadOnlyMaterials ? materialMesh->getMeshBuffer(i)->getMaterial() : Materials[i];
 				if (RenderFromIdentity)
 					driver->setTransform(video::ETS_WORLD, core::IdentityMatrix );
 				else if (Mesh->getMeshType() == EAMT_SKINNED)
@@ -391,7 +462,19 @@ void CAnimatedMeshSceneNode::render()
 		// show skeleton
 		if (DebugDataVisible & scene::EDS_SKELETON)
 		{
-			if (Mesh->getMeshType() == EAMT_SKINNED)
+			if (SkinningState)
+			{
+				// draw the skeleton of this node
+				for (u32 g=0; g < SkinningState->Parent.size(); ++g)
+				{
+					const s32 parent = SkinningState->Parent[g];
+					if (parent >= 0)
+						driver->draw3DLine(SkinningState->Global[parent].getTranslation(),
+								SkinningState->Global[g].getTranslation(),
+								video::SColor(255,51,66,255));
+				}
+			}
+			else if (Mesh->getMeshType() == EAMT_SKINNED)
 			{
 				// draw skeleton
 
@@ -820,10 +903,14 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh* mesh)
 
 		// grab the mesh (it's non-null!)
 		Mesh->grab();
+
+		delete SkinningState;
+		SkinningState = 0;
 	}
 
 	// get materials and bounding box
 	Box = Mesh->getBoundingBox();
+	invalidate();
 
 	IMesh* m = Mesh->getMesh(0,0);
 	if (m)
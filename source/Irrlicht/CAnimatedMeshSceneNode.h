@@ -7,6 +7,7 @@
 
 #include "IAnimatedMeshSceneNode.h"
 #include "IAnimatedMesh.h"
+#include "CSkinnedMesh.h"
 
 #include "matrix4.h"
 
@@ -153,6 +154,12 @@ namespace scene
 		//! render mesh ignoring its transformation. Used with ragdolls. (culling is unaffected)
 		virtual void setRenderFromIdentity( bool On ) _IRR_OVERRIDE_;
 
+		//! Returns true if the node's own copy of the mesh has to be skinned for the current frame
+		virtual bool needsSkinningUpdate() const _IRR_OVERRIDE_;
+
+		//! Skins the node's own copy of the mesh for the current frame
+		virtual void updateSkinning(bool useThreads) _IRR_OVERRIDE_;
+
 		//! Creates a clone of this scene node and its children.
 		/** \param newParent An optional new parent.
 		\param newManager An optional new scene manager.
@@ -164,6 +171,11 @@ namespace scene
 		//! Get a static mesh for the current frame of this animated mesh
 		IMesh* getMeshForCurrentFrame();
 
+		//! Sets up SkinningState if the node can skin a copy of the mesh of its own
+		/** This is possible for skinned meshes if the joints aren't read or controlled
+		by joint nodes and no shadow volume uses the shared mesh. */
+		bool prepareSkinningState();
+
 		void buildFrameNr(u32 timeMs);
 		void checkJoints();
 		void beginTransition();
@@ -198,6 +210,9 @@ namespace scene
 		core::array<IBoneSceneNode* > JointChildSceneNodes;
 		core::array<core::matrix4> PretransitingSave;
 
+		//! joints and skinned buffers of this node, so nodes sharing a mesh can be animated at the same time
+		CSkinnedMesh::SAnimationState* SkinningState;
+
 		// Quake3 Model
 		struct SMD3Special : public virtual IReferenceCounted
 		{
@@ -0,0 +1,63 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CAnimationStage.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+void CAnimationStage::update(ISceneManager* smgr)
+{
+	Nodes.set_used(0);
+
+	if (!smgr)
+		return;
+
+	collect(smgr, smgr->getRootSceneNode());
+
+	// a single node can split its own skinning over the threads instead
+	if (Nodes.size() == 1)
+		Nodes[0]->updateSkinning(true);
+	else if (Nodes.size())
+		CThreadPool::getSharedPool()->run(this, Nodes.size());
+
+	Nodes.set_used(0);
+}
+
+
+void CAnimationStage::run(u32 index, u32 thread)
+{
+	Nodes[index]->updateSkinning(false);
+}
+
+
+//! collects the nodes ISceneNode::OnRegisterSceneNode would visit
+void CAnimationStage::collect(ISceneManager* smgr, ISceneNode* node)
+{
+	const ISceneNodeList& children = node->getChildren();
+	ISceneNodeList::ConstIterator it = children.begin();
+	for (; it != children.end(); ++it)
+	{
+		ISceneNode* child = *it;
+		if (!child->isVisible())
+			continue;
+
+		if (child->getType() == ESNT_ANIMATED_MESH)
+		{
+			IAnimatedMeshSceneNode* animated = static_cast<IAnimatedMeshSceneNode*>(child);
+			if (animated->needsSkinningUpdate() && !smgr->isCulled(animated))
+				Nodes.push_back(animated);
+		}
+
+		collect(smgr, child);
+	}
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
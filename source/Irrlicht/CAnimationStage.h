@@ -0,0 +1,46 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_ANIMATION_STAGE_H_INCLUDED__
+#define __C_ANIMATION_STAGE_H_INCLUDED__
+
+#include "IAnimatedMeshSceneNode.h"
+#include "ISceneManager.h"
+#include "CThreadPool.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Skins the animated mesh scene nodes of a scene at once after they were animated.
+	/** Collects the visible nodes of a scene which skin a mesh of their own, see
+	IAnimatedMeshSceneNode::needsSkinningUpdate(), and updates them on the shared
+	CThreadPool, one node per part of the job. Their bounding boxes are up to date
+	when the scene is culled and registered afterwards. Nodes which the active
+	camera culls with the box around their animated joints, which they calculate
+	in OnAnimate, are skipped, they are skinned when they are rendered. */
+	class CAnimationStage : public IThreadJob
+	{
+	public:
+
+		//! Skins the nodes of the scene which need it.
+		/** The active camera has to be rendered before, so its frustum is up to date. */
+		void update(ISceneManager* smgr);
+
+		//! Skins one node, called by CThreadPool.
+		virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_;
+
+	private:
+
+		void collect(ISceneManager* smgr, ISceneNode* node);
+
+		core::array<IAnimatedMeshSceneNode*> Nodes;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
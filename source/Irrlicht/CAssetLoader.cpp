@@ -0,0 +1,260 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CAssetLoader.h"
+#include "CMemoryFile.h"
+#include "ITexture.h"
+#include "IAnimatedMesh.h"
+#include "os.h"
+
+namespace irr
+{
+namespace io
+{
+
+//! Constructor
+CAssetRequest::CAssetRequest(const io::path& name, IReadFile* file)
+: Name(name), File(0), Texture(0), Mesh(0), State(EARS_PENDING)
+{
+	#ifdef _DEBUG
+	setDebugName("CAssetRequest");
+	#endif
+
+	if (!file)
+		return;
+
+	File = file;
+	File->grab();
+
+	// files in archives can't be read safely from another thread
+	if (!File->getData() && !File->hasOwnHandle())
+		readFile();
+}
+
+
+//! Destructor
+CAssetRequest::~CAssetRequest()
+{
+	if (File)
+		File->drop();
+	if (Texture)
+		Texture->drop();
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+E_ASSET_REQUEST_STATE CAssetRequest::getState() const
+{
+	return State;
+}
+
+
+const io::path& CAssetRequest::getName() const
+{
+	return Name;
+}
+
+
+video::ITexture* CAssetRequest::getTexture() const
+{
+	return Texture;
+}
+
+
+scene::IAnimatedMesh* CAssetRequest::getMesh() const
+{
+	return Mesh;
+}
+
+
+//! Reads a file which isn't in memory yet into memory.
+void CAssetRequest::readFile()
+{
+	if (!File || File->getData())
+		return;
+
+	const long size = File->getSize();
+	c8* data = new c8[size > 0 ? size : 1];
+	File->seek(0);
+	const s32 read = File->read(data, size > 0 ? size : 0);
+
+	IReadFile* memoryFile = new CMemoryReadFile(data, read > 0 ? read : 0, File->getFileName(), true);
+	File->drop();
+	File = memoryFile;
+}
+
+
+void CAssetRequest::setTexture(video::ITexture* texture)
+{
+	if (texture)
+		texture->grab();
+	if (Texture)
+		Texture->drop();
+	Texture = texture;
+	State = texture ? EARS_READY : EARS_FAILED;
+}
+
+
+void CAssetRequest::setMesh(scene::IAnimatedMesh* mesh)
+{
+	if (mesh)
+		mesh->grab();
+	if (Mesh)
+		Mesh->drop();
+	Mesh = mesh;
+	State = mesh ? EARS_READY : EARS_FAILED;
+}
+
+
+void CAssetRequest::setFailed()
+{
+	State = EARS_FAILED;
+}
+
+
+//! Constructor
+CAssetLoader::CAssetLoader()
+: Pool(CThreadPool::getSharedPool()), Budget(4)
+{
+	// the pool has to outlive the queued jobs
+	Pool->grab();
+}
+
+
+//! Destructor
+CAssetLoader::~CAssetLoader()
+{
+	Mutex.lock();
+	core::array<CAssetRequest*> queued = Queued;
+	Queued.clear();
+	Mutex.unlock();
+
+	// the queued parts find nothing left to do
+	Pool->finish(this);
+
+	for (u32 i=0; i<queued.size(); ++i)
+	{
+		queued[i]->setFailed();
+		queued[i]->drop();
+	}
+	for (u32 i=0; i<Loaded.size(); ++i)
+	{
+		Loaded[i]->setFailed();
+		Loaded[i]->drop();
+	}
+
+	Pool->drop();
+}
+
+
+//! Starts loading a request.
+void CAssetLoader::add(CAssetRequest* request)
+{
+	request->grab();
+
+	Mutex.lock();
+	Queued.push_back(request);
+	Mutex.unlock();
+
+	if (Pool->getThreadCount() > 1)
+		Pool->enqueue(this, 1);
+}
+
+
+//! Completes loaded requests until the time budget is used up.
+void CAssetLoader::update()
+{
+	const u32 start = os::Timer::getRealTime();
+	core::array<CAssetRequest*> waiting;
+
+	for (;;)
+	{
+		CAssetRequest* request = 0;
+		bool queued = false;
+
+		Mutex.lock();
+		if (!Loaded.empty())
+		{
+			request = Loaded[0];
+			Loaded.erase(0);
+		}
+		else
+			queued = !Queued.empty();
+		Mutex.unlock();
+
+		if (!request)
+		{
+			// without worker threads the loading is done here as well
+			if (!queued || Pool->getThreadCount() > 1)
+				break;
+
+			run(0, 0);
+			continue;
+		}
+
+		if (!request->finish())
+		{
+			waiting.push_back(request);
+			continue;
+		}
+		request->drop();
+
+		if (os::Timer::getRealTime() - start >= Budget)
+			break;
+	}
+
+	// keep the order, the waiting requests are tried first next time
+	if (!waiting.empty())
+	{
+		Mutex.lock();
+		for (u32 i=0; i<waiting.size(); ++i)
+			Loaded.insert(waiting[i], i);
+		Mutex.unlock();
+	}
+
+	// pass on what the requests logged while they were loaded
+	os::Printer::flush();
+}
+
+
+//! Loads and completes all requests right away.
+void CAssetLoader::flush()
+{
+	Pool->finish(this);
+
+	const u32 budget = Budget;
+	Budget = 0xFFFFFFFF;
+	update();
+	Budget = budget;
+}
+
+
+//! Loads the next queued request.
+void CAssetLoader::run(u32 index, u32 thread)
+{
+	CAssetRequest* request = 0;
+
+	Mutex.lock();
+	if (!Queued.empty())
+	{
+		request = Queued[0];
+		Queued.erase(0);
+	}
+	Mutex.unlock();
+
+	if (!request)
+		return;
+
+	request->readFile();
+	request->load();
+
+	Mutex.lock();
+	Loaded.push_back(request);
+	Mutex.unlock();
+}
+
+
+} // end namespace io
+} // end namespace irr
@@ -0,0 +1,118 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_ASSET_LOADER_H_INCLUDED__
+#define __C_ASSET_LOADER_H_INCLUDED__
+
+#include "IAssetRequest.h"
+#include "IReadFile.h"
+#include "CThreadPool.h"
+
+namespace irr
+{
+namespace io
+{
+
+	//! Base class of the requests handled by CAssetLoader.
+	class CAssetRequest : public IAssetRequest
+	{
+	public:
+
+		//! Constructor
+		/** Files which aren't in memory already (see IReadFile::getData) are read
+		into memory by the worker thread, see readFile(). Only files in archives,
+		which share the handle of the archive, are read here on the main thread.
+		\param file The file to load from, or 0 for requests which are finished
+		right away. */
+		CAssetRequest(const io::path& name, IReadFile* file);
+
+		//! Destructor
+		virtual ~CAssetRequest();
+
+		virtual E_ASSET_REQUEST_STATE getState() const _IRR_OVERRIDE_;
+		virtual const io::path& getName() const _IRR_OVERRIDE_;
+		virtual video::ITexture* getTexture() const _IRR_OVERRIDE_;
+		virtual scene::IAnimatedMesh* getMesh() const _IRR_OVERRIDE_;
+
+		//! Reads a file which isn't in memory yet into memory, on the worker thread.
+		/** Called by CAssetLoader before load(), so the loaders and finish()
+		never wait for the disk. */
+		void readFile();
+
+		//! Does the work which can be done on a worker thread.
+		/** Must not use anything but the file of the request, messages which
+		are logged with os::Printer are passed on by CAssetLoader::update. By
+		default nothing is done, mapped files are read ahead by the system. */
+		virtual void load() {}
+
+		//! Completes the request on the main thread.
+		/** Has to call setTexture, setMesh or setFailed.
+		\return False if the request waits for other requests, finish() is
+		called again by the next update() then. */
+		virtual bool finish() = 0;
+
+		//! Marks the request as ready with the loaded texture.
+		void setTexture(video::ITexture* texture);
+
+		//! Marks the request as ready with the loaded mesh.
+		void setMesh(scene::IAnimatedMesh* mesh);
+
+		//! Marks the request as failed.
+		void setFailed();
+
+	protected:
+
+		io::path Name;
+		IReadFile* File;
+		video::ITexture* Texture;
+		scene::IAnimatedMesh* Mesh;
+		E_ASSET_REQUEST_STATE State;
+	};
+
+
+	//! Loads CAssetRequests on the worker threads of the shared CThreadPool.
+	/** Requests are loaded in the order they were added, one request per part of
+	a queued job. Loaded requests are completed by update() on the main thread.
+	Without worker threads update() loads the requests as well. */
+	class CAssetLoader : public IThreadJob
+	{
+	public:
+
+		//! Constructor, uses the current shared thread pool.
+		CAssetLoader();
+
+		//! Destructor, waits for running requests and fails the others.
+		~CAssetLoader();
+
+		//! Starts loading a request.
+		void add(CAssetRequest* request);
+
+		//! Completes loaded requests until the time budget is used up.
+		/** At least one request is completed per call if one is loaded.
+		Requests which wait for others are tried once per call. */
+		void update();
+
+		//! Loads and completes all requests right away.
+		/** Except for requests which wait for requests of another loader. */
+		void flush();
+
+		//! Sets the time update() may spend, in milliseconds.
+		void setBudget(u32 milliseconds) { Budget = milliseconds; }
+
+		//! Loads the next queued request, called by CThreadPool.
+		virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_;
+
+	private:
+
+		core::array<CAssetRequest*> Queued;
+		core::array<CAssetRequest*> Loaded;
+		CMutex Mutex;
+		CThreadPool* Pool;
+		u32 Budget;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -0,0 +1,758 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBVHTriangleSelector.h"
+#include "ISceneNode.h"
+#include "IMeshBuffer.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	// number of bins per axis for the surface area heuristic
+	const u32 BIN_COUNT = 12;
+
+	// size of the traversal stacks, the build switches to median splits long before
+	const u32 STACK_SIZE = 128;
+	const u32 MEDIAN_DEPTH = 64;
+
+	// tests the line start + t * vector for 0 <= t <= maxT against a box
+	inline bool intersectBox(const core::vector3df& minEdge, const core::vector3df& maxEdge,
+		const core::vector3df& start, const core::vector3df& invVector, f32 maxT, f32& outNear)
+	{
+		f32 t1 = (minEdge.X - start.X) * invVector.X;
+		f32 t2 = (maxEdge.X - start.X) * invVector.X;
+		f32 tNear = core::min_(t1, t2);
+		f32 tFar = core::max_(t1, t2);
+
+		t1 = (minEdge.Y - start.Y) * invVector.Y;
+		t2 = (maxEdge.Y - start.Y) * invVector.Y;
+		tNear = core::max_(tNear, core::min_(t1, t2));
+		tFar = core::min_(tFar, core::max_(t1, t2));
+
+		t1 = (minEdge.Z - start.Z) * invVector.Z;
+		t2 = (maxEdge.Z - start.Z) * invVector.Z;
+		tNear = core::max_(tNear, core::min_(t1, t2));
+		tFar = core::min_(tFar, core::max_(t1, t2));
+
+		outNear = tNear;
+		return tFar >= core::max_(tNear, 0.f) && tNear <= maxT;
+	}
+
+	// 1/x, lines parallel to an axis get a big finite value so 0*x stays 0
+	inline f32 inverse(f32 x)
+	{
+		if (x != 0.f)
+			return 1.f / x;
+		return x < 0.f ? -1e30f : 1e30f;
+	}
+
+	struct SBuildTask
+	{
+		u32 Node;
+		u32 First;
+		u32 Count;
+		u32 Depth;
+	};
+}
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node)
+	: CTriangleSelector(mesh, node), UseSSE2(os::Cpu::hasSSE2())
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	if (!Triangles.empty())
+	{
+		const u32 start = os::Timer::getRealTime();
+
+		build();
+
+		c8 tmp[256];
+		sprintf(tmp, "Needed %ums to create BVHTriangleSelector.(%u nodes, %u polys)",
+			os::Timer::getRealTime() - start, Nodes.size(), Triangles.size());
+		os::Printer::log(tmp, ELL_INFORMATION);
+	}
+}
+
+
+//! constructor for animated mesh scene nodes
+CBVHTriangleSelector::CBVHTriangleSelector(IAnimatedMeshSceneNode* node)
+	: CTriangleSelector(node), UseSSE2(os::Cpu::hasSSE2())
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	if (!Triangles.empty())
+	{
+		const u32 start = os::Timer::getRealTime();
+
+		Slots.set_used(Triangles.size());
+		build();
+
+		c8 tmp[256];
+		sprintf(tmp, "Needed %ums to create refittable BVHTriangleSelector.(%u nodes, %u polys)",
+			os::Timer::getRealTime() - start, Nodes.size(), Triangles.size());
+		os::Printer::log(tmp, ELL_INFORMATION);
+	}
+}
+
+
+void CBVHTriangleSelector::build()
+{
+	const u32 count = Triangles.size();
+
+	TriangleBoxes.set_used(count);
+	Centers.set_used(count);
+	Order.set_used(count);
+	for (u32 i=0; i<count; ++i)
+	{
+		const core::triangle3df& triangle = Triangles[i];
+		TriangleBoxes[i].reset(triangle.pointA);
+		TriangleBoxes[i].addInternalPoint(triangle.pointB);
+		TriangleBoxes[i].addInternalPoint(triangle.pointC);
+		Centers[i] = TriangleBoxes[i].getCenter();
+		Order[i] = i;
+	}
+
+	// leaves have 1 to 4 triangles, usually about 2
+	Nodes.clear();
+	Nodes.reallocate(count);
+	Packets.clear();
+	Packets.reallocate(count / 2 + 1);
+
+	core::array<core::triangle3df> sorted;
+	sorted.reallocate(count);
+
+	core::array<SBuildTask> tasks;
+	SBuildTask task;
+	task.Node = 0;
+	task.First = 0;
+	task.Count = count;
+	task.Depth = 0;
+	tasks.push_back(task);
+	Nodes.push_back(SNode());
+
+	while (!tasks.empty())
+	{
+		task = tasks.getLast();
+		tasks.erase(tasks.size()-1);
+
+		core::aabbox3df box(TriangleBoxes[Order[task.First]]);
+		for (u32 i=1; i<task.Count; ++i)
+			box.addInternalBox(TriangleBoxes[Order[task.First+i]]);
+		Nodes[task.Node].MinEdge = box.MinEdge;
+		Nodes[task.Node].MaxEdge = box.MaxEdge;
+
+		u32 middle;
+		if (!split(task.First, task.Count, task.Depth >= MEDIAN_DEPTH, middle))
+		{
+			makeLeaf(task.Node, task.First, task.Count, sorted);
+			continue;
+		}
+
+		const u32 left = Nodes.size();
+		Nodes[task.Node].Start = left;
+		Nodes[task.Node].Count = 0;
+		Nodes.push_back(SNode());
+		Nodes.push_back(SNode());
+
+		SBuildTask child;
+		child.Depth = task.Depth + 1;
+		child.Node = left + 1;
+		child.First = middle;
+		child.Count = task.First + task.Count - middle;
+		tasks.push_back(child);
+		child.Node = left;
+		child.First = task.First;
+		child.Count = middle - task.First;
+		tasks.push_back(child);
+	}
+
+	Triangles.swap(sorted);
+
+	TriangleBoxes.clear();
+	Centers.clear();
+	Order.clear();
+}
+
+
+bool CBVHTriangleSelector::split(u32 first, u32 count, bool median, u32& outMiddle)
+{
+	// one packet is tested at once, splitting it up only adds work
+	if (count <= 4)
+		return false;
+
+	core::aabbox3df centerBox(Centers[Order[first]]);
+	for (u32 i=1; i<count; ++i)
+		centerBox.addInternalPoint(Centers[Order[first+i]]);
+
+	const core::vector3df extent = centerBox.getExtent();
+	s32 bestAxis = -1;
+	u32 bestBin = 0;
+
+	if (!median)
+	{
+		f32 bestCost = FLT_MAX;
+
+		for (u32 axis=0; axis<3; ++axis)
+		{
+			const f32 minimum = axis == 0 ? centerBox.MinEdge.X : axis == 1 ? centerBox.MinEdge.Y : centerBox.MinEdge.Z;
+			const f32 size = axis == 0 ? extent.X : axis == 1 ? extent.Y : extent.Z;
+			if (size <= 0.f)
+				continue;
+
+			core::aabbox3df binBoxes[BIN_COUNT];
+			u32 binCounts[BIN_COUNT];
+			for (u32 b=0; b<BIN_COUNT; ++b)
+			{
+				binBoxes[b].MinEdge.set(FLT_MAX, FLT_MAX, FLT_MAX);
+				binBoxes[b].MaxEdge.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+				binCounts[b] = 0;
+			}
+
+			const f32 scale = BIN_COUNT / size;
+			for (u32 i=0; i<count; ++i)
+			{
+				const u32 index = Order[first+i];
+				const f32 center = axis == 0 ? Centers[index].X : axis == 1 ? Centers[index].Y : Centers[index].Z;
+				const u32 b = core::min_((u32)((center - minimum) * scale), BIN_COUNT-1);
+				++binCounts[b];
+				binBoxes[b].addInternalBox(TriangleBoxes[index]);
+			}
+
+			// areas and counts left of each split plane, empty bins have inverted boxes
+			f32 leftAreas[BIN_COUNT-1];
+			u32 leftCounts[BIN_COUNT-1];
+			core::aabbox3df box(binBoxes[0]);
+			u32 sum = 0;
+			for (u32 b=0; b<BIN_COUNT-1; ++b)
+			{
+				if (b)
+					box.addInternalBox(binBoxes[b]);
+				sum += binCounts[b];
+				leftAreas[b] = sum ? box.getArea() : 0.f;
+				leftCounts[b] = sum;
+			}
+
+			box = binBoxes[BIN_COUNT-1];
+			sum = 0;
+			for (u32 b=BIN_COUNT-1; b>0; --b)
+			{
+				if (b < BIN_COUNT-1)
+					box.addInternalBox(binBoxes[b]);
+				sum += binCounts[b];
+				if (!sum || !leftCounts[b-1])
+					continue;
+
+				const f32 cost = leftAreas[b-1] * leftCounts[b-1] + box.getArea() * sum;
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b;
+				}
+			}
+		}
+	}
+
+	if (bestAxis >= 0)
+	{
+		const f32 minimum = bestAxis == 0 ? centerBox.MinEdge.X : bestAxis == 1 ? centerBox.MinEdge.Y : centerBox.MinEdge.Z;
+		const f32 scale = BIN_COUNT / (bestAxis == 0 ? extent.X : bestAxis == 1 ? extent.Y : extent.Z);
+
+		u32 left = first;
+		u32 right = first + count;
+		while (left < right)
+		{
+			const core::vector3df& center = Centers[Order[left]];
+			const f32 c = bestAxis == 0 ? center.X : bestAxis == 1 ? center.Y : center.Z;
+			if (core::min_((u32)((c - minimum) * scale), BIN_COUNT-1) < bestBin)
+				++left;
+			else
+				core::swap(Order[left], Order[--right]);
+		}
+
+		if (left > first && left < first + count)
+		{
+			outMiddle = left;
+			return true;
+		}
+	}
+
+	// all centers at the same place or too deep, just cut the triangles in half
+	outMiddle = first + count / 2;
+	return true;
+}
+
+
+void CBVHTriangleSelector::makeLeaf(u32 node, u32 first, u32 count,
+		core::array<core::triangle3df>& sorted)
+{
+	Nodes[node].Start = Packets.size();
+	Nodes[node].Count = count;
+
+	STrianglePacket packet;
+	packet.First = sorted.size();
+	for (u32 i=0; i<count; ++i)
+	{
+		if (!Slots.empty())
+			Slots[Order[first+i]] = sorted.size();
+		sorted.push_back(Triangles[Order[first+i]]);
+	}
+
+	setPacket(packet, sorted.const_pointer() + packet.First, count);
+	Packets.push_back(packet);
+}
+
+
+void CBVHTriangleSelector::updateFromMesh(const IMesh* mesh) const
+{
+	if (!mesh || Slots.empty())
+		return;
+
+	// all frames have the same triangles, so only the positions change
+	u32 triangleCount = 0;
+	const u32 meshBuffers = mesh->getMeshBufferCount();
+	for (u32 i = 0; i < meshBuffers; ++i)
+	{
+		IMeshBuffer* buf = mesh->getMeshBuffer(i);
+		const u32 idxCnt = buf->getIndexBuffer()->getIndexCount();
+
+		video::IVertexAttribute* attribute = buf->getVertexDescriptor()->getAttributeBySemantic(video::EVAS_POSITION);
+
+		if (!attribute)
+			continue;
+
+		const u8* offset = static_cast<const u8*>(buf->getVertexBuffer()->getVertices()) + attribute->getOffset();
+		const u32 vertexSize = buf->getVertexBuffer()->getVertexSize();
+		const IIndexBuffer* indices = buf->getIndexBuffer();
+
+		for (u32 index = 0; index + 2 < idxCnt && triangleCount < Slots.size(); index += 3)
+		{
+			core::triangle3df& tri = Triangles[Slots[triangleCount++]];
+			tri.pointA = *(const core::vector3df*)(offset + vertexSize * indices->getIndex(index+0));
+			tri.pointB = *(const core::vector3df*)(offset + vertexSize * indices->getIndex(index+1));
+			tri.pointC = *(const core::vector3df*)(offset + vertexSize * indices->getIndex(index+2));
+		}
+	}
+
+	refit();
+}
+
+
+void CBVHTriangleSelector::refit() const
+{
+	// children are always behind their parent
+	for (s32 i=(s32)Nodes.size()-1; i>=0; --i)
+	{
+		SNode& node = Nodes[i];
+		core::aabbox3df box;
+
+		if (node.Count)
+		{
+			STrianglePacket& packet = Packets[node.Start];
+			const core::triangle3df* triangles = Triangles.const_pointer() + packet.First;
+			box.reset(triangles[0].pointA);
+			for (u32 j=0; j<node.Count; ++j)
+			{
+				box.addInternalPoint(triangles[j].pointA);
+				box.addInternalPoint(triangles[j].pointB);
+				box.addInternalPoint(triangles[j].pointC);
+			}
+			setPacket(packet, triangles, node.Count);
+		}
+		else
+		{
+			box.reset(Nodes[node.Start].MinEdge);
+			box.addInternalPoint(Nodes[node.Start].MaxEdge);
+			box.addInternalBox(core::aabbox3df(Nodes[node.Start+1].MinEdge, Nodes[node.Start+1].MaxEdge));
+		}
+
+		node.MinEdge = box.MinEdge;
+		node.MaxEdge = box.MaxEdge;
+	}
+
+	if (!Nodes.empty())
+	{
+		BoundingBox.MinEdge = Nodes[0].MinEdge;
+		BoundingBox.MaxEdge = Nodes[0].MaxEdge;
+	}
+}
+
+
+void CBVHTriangleSelector::setPacket(STrianglePacket& packet,
+		const core::triangle3df* triangles, u32 count)
+{
+	for (u32 i=0; i<4; ++i)
+	{
+		core::vector3df a, e1, e2;
+		if (i < count)
+		{
+			a = triangles[i].pointA;
+			e1 = triangles[i].pointB - a;
+			e2 = triangles[i].pointC - a;
+		}
+
+		packet.AX[i] = a.X;
+		packet.AY[i] = a.Y;
+		packet.AZ[i] = a.Z;
+		packet.E1X[i] = e1.X;
+		packet.E1Y[i] = e1.Y;
+		packet.E1Z[i] = e1.Z;
+		packet.E2X[i] = e2.X;
+		packet.E2Y[i] = e2.Y;
+		packet.E2Z[i] = e2.Z;
+	}
+}
+
+
+s32 CBVHTriangleSelector::intersectPacket(const STrianglePacket& packet, u32 count,
+		const core::vector3df& start, const core::vector3df& vector, f32& outT) const
+{
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 dx = _mm_set1_ps(vector.X);
+		const __m128 dy = _mm_set1_ps(vector.Y);
+		const __m128 dz = _mm_set1_ps(vector.Z);
+		const __m128 e1x = _mm_loadu_ps(packet.E1X);
+		const __m128 e1y = _mm_loadu_ps(packet.E1Y);
+		const __m128 e1z = _mm_loadu_ps(packet.E1Z);
+		const __m128 e2x = _mm_loadu_ps(packet.E2X);
+		const __m128 e2y = _mm_loadu_ps(packet.E2Y);
+		const __m128 e2z = _mm_loadu_ps(packet.E2Z);
+
+		// Moeller-Trumbore for the 4 triangles
+		const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+		const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		const __m128 invDet = _mm_div_ps(one, det);
+
+		const __m128 tx = _mm_sub_ps(_mm_set1_ps(start.X), _mm_loadu_ps(packet.AX));
+		const __m128 ty = _mm_sub_ps(_mm_set1_ps(start.Y), _mm_loadu_ps(packet.AY));
+		const __m128 tz = _mm_sub_ps(_mm_set1_ps(start.Z), _mm_loadu_ps(packet.AZ));
+		const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), invDet);
+
+		const __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+		const __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+		const __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+		const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+		const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+		// comparisons with NaN from a zero det are false
+		__m128 hit = _mm_cmpneq_ps(det, zero);
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+		hit = _mm_and_ps(hit, _mm_cmplt_ps(t, _mm_set1_ps(outT)));
+
+		const s32 mask = _mm_movemask_ps(hit) & ((1 << count) - 1);
+		if (!mask)
+			return -1;
+
+		f32 ts[4];
+		_mm_storeu_ps(ts, t);
+
+		s32 result = -1;
+		for (u32 i=0; i<count; ++i)
+		{
+			if ((mask & (1 << i)) && ts[i] < outT)
+			{
+				outT = ts[i];
+				result = i;
+			}
+		}
+		return result;
+	}
+#endif
+
+	s32 result = -1;
+	for (u32 i=0; i<count; ++i)
+	{
+		const core::vector3df e1(packet.E1X[i], packet.E1Y[i], packet.E1Z[i]);
+		const core::vector3df e2(packet.E2X[i], packet.E2Y[i], packet.E2Z[i]);
+
+		const core::vector3df p = vector.crossProduct(e2);
+		const f32 det = e1.dotProduct(p);
+		if (det == 0.f)
+			continue;
+		const f32 invDet = 1.f / det;
+
+		const core::vector3df s = start - core::vector3df(packet.AX[i], packet.AY[i], packet.AZ[i]);
+		const f32 u = s.dotProduct(p) * invDet;
+		if (u < 0.f || u > 1.f)
+			continue;
+
+		const core::vector3df q = s.crossProduct(e1);
+		const f32 v = vector.dotProduct(q) * invDet;
+		if (v < 0.f || u + v > 1.f)
+			continue;
+
+		const f32 t = e2.dotProduct(q) * invDet;
+		if (t >= 0.f && t < outT)
+		{
+			outT = t;
+			result = i;
+		}
+	}
+	return result;
+}
+
+
+s32 CBVHTriangleSelector::getNearestTriangle(const core::vector3df& start,
+		const core::vector3df& vector, f32& outT) const
+{
+	if (Nodes.empty())
+		return -1;
+
+	const core::vector3df invVector(inverse(vector.X), inverse(vector.Y), inverse(vector.Z));
+
+	// the line ends at 1, hits beyond that don't count
+	outT = 1.f;
+	s32 result = -1;
+
+	f32 tNear;
+	if (!intersectBox(Nodes[0].MinEdge, Nodes[0].MaxEdge, start, invVector, outT, tNear))
+		return -1;
+
+	u32 stack[STACK_SIZE];
+	f32 stackNear[STACK_SIZE];
+	u32 stackSize = 0;
+	u32 current = 0;
+
+	for (;;)
+	{
+		const SNode& node = Nodes[current];
+		bool next = true;
+
+		if (node.Count)
+		{
+			const STrianglePacket& packet = Packets[node.Start];
+			const s32 hit = intersectPacket(packet, node.Count, start, vector, outT);
+			if (hit >= 0)
+				result = packet.First + hit;
+		}
+		else
+		{
+			// visit the nearer child first, so the farther one can often be skipped
+			const SNode& left = Nodes[node.Start];
+			const SNode& right = Nodes[node.Start+1];
+			f32 tLeft, tRight;
+			const bool hitLeft = intersectBox(left.MinEdge, left.MaxEdge, start, invVector, outT, tLeft);
+			const bool hitRight = intersectBox(right.MinEdge, right.MaxEdge, start, invVector, outT, tRight);
+
+			if (hitLeft && hitRight)
+			{
+				const bool leftFirst = tLeft <= tRight;
+				stack[stackSize] = leftFirst ? node.Start + 1 : node.Start;
+				stackNear[stackSize] = leftFirst ? tRight : tLeft;
+				++stackSize;
+				current = leftFirst ? node.Start : node.Start + 1;
+				next = false;
+			}
+			else if (hitLeft || hitRight)
+			{
+				current = hitLeft ? node.Start : node.Start + 1;
+				next = false;
+			}
+		}
+
+		if (next)
+		{
+			// skip nodes which are behind the nearest hit found since they were pushed
+			while (stackSize && stackNear[stackSize-1] >= outT)
+				--stackSize;
+			if (!stackSize)
+				break;
+			current = stack[--stackSize];
+		}
+	}
+
+	return result;
+}
+
+
+//! Get the nearest intersection of a 3d line with the triangles of the selector.
+bool CBVHTriangleSelector::getIntersectionWithLine(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		ISceneNode*& outNode) const
+{
+	update();
+
+	core::vector3df start(line.start);
+	core::vector3df end(line.end);
+	if (SceneNode)
+	{
+		core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+		if (!SceneNode->getAbsoluteTransformation().getInverse(mat))
+			return false;
+		mat.transformVect(start);
+		mat.transformVect(end);
+	}
+
+	f32 t;
+	const s32 index = getNearestTriangle(start, end - start, t);
+	if (index < 0)
+		return false;
+
+	outIntersection = line.start + (line.end - line.start) * t;
+	outTriangle = Triangles[index];
+	if (SceneNode)
+	{
+		const core::matrix4& mat = SceneNode->getAbsoluteTransformation();
+		mat.transformVect(outTriangle.pointA);
+		mat.transformVect(outTriangle.pointB);
+		mat.transformVect(outTriangle.pointC);
+	}
+	outNode = SceneNode;
+
+	return true;
+}
+
+
+void CBVHTriangleSelector::addLeafTriangles(const SNode& leaf, const core::aabbox3d<f32>* box,
+		const core::matrix4& transform, core::triangle3df* triangles,
+		s32 arraySize, s32& trianglesWritten) const
+{
+	const u32 first = Packets[leaf.Start].First;
+	for (u32 i=0; i<leaf.Count && trianglesWritten < arraySize; ++i)
+	{
+		const core::triangle3df& triangle = Triangles[first+i];
+		// This isn't an accurate test, but it's fast, and the
+		// API contract doesn't guarantee complete accuracy.
+		if (box && triangle.isTotalOutsideBox(*box))
+			continue;
+
+		core::triangle3df& dst = triangles[trianglesWritten];
+		transform.transformVect(dst.pointA, triangle.pointA);
+		transform.transformVect(dst.pointB, triangle.pointB);
+		transform.transformVect(dst.pointC, triangle.pointC);
+		++trianglesWritten;
+	}
+}
+
+
+//! Gets all triangles which lie within a specific bounding box.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+					s32 arraySize, s32& outTriangleCount,
+					const core::aabbox3d<f32>& box,
+					const core::matrix4* transform) const
+{
+	update();
+
+	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+	core::aabbox3df tBox(box);
+
+	if (SceneNode)
+	{
+		SceneNode->getAbsoluteTransformation().getInverse(mat);
+		mat.transformBoxEx(tBox);
+	}
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+	if (SceneNode)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	outTriangleCount = 0;
+	if (Nodes.empty())
+		return;
+
+	u32 stack[STACK_SIZE];
+	u32 stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize && outTriangleCount < arraySize)
+	{
+		const SNode& node = Nodes[stack[--stackSize]];
+		if (!tBox.intersectsWithBox(core::aabbox3df(node.MinEdge, node.MaxEdge)))
+			continue;
+
+		if (node.Count)
+			addLeafTriangles(node, &tBox, mat, triangles, arraySize, outTriangleCount);
+		else
+		{
+			stack[stackSize++] = node.Start + 1;
+			stack[stackSize++] = node.Start;
+		}
+	}
+}
+
+
+//! Gets all triangles which have or may have contact with a 3d line.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+					s32 arraySize, s32& outTriangleCount,
+					const core::line3d<f32>& line,
+					const core::matrix4* transform) const
+{
+	update();
+
+	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+	core::vector3df start(line.start);
+	core::vector3df end(line.end);
+
+	if (SceneNode)
+	{
+		SceneNode->getAbsoluteTransformation().getInverse(mat);
+		mat.transformVect(start);
+		mat.transformVect(end);
+	}
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+	if (SceneNode)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	outTriangleCount = 0;
+	if (Nodes.empty())
+		return;
+
+	core::aabbox3df lineBox(start);
+	lineBox.addInternalPoint(end);
+	const core::vector3df vector = end - start;
+	const core::vector3df invVector(inverse(vector.X), inverse(vector.Y), inverse(vector.Z));
+
+	u32 stack[STACK_SIZE];
+	u32 stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize && outTriangleCount < arraySize)
+	{
+		const SNode& node = Nodes[stack[--stackSize]];
+		f32 tNear;
+		if (!intersectBox(node.MinEdge, node.MaxEdge, start, invVector, 1.f, tNear))
+			continue;
+
+		if (node.Count)
+			addLeafTriangles(node, &lineBox, mat, triangles, arraySize, outTriangleCount);
+		else
+		{
+			stack[stackSize++] = node.Start + 1;
+			stack[stackSize++] = node.Start;
+		}
+	}
+}
+
+
+} // end namespace scene
+} // end namespace irr
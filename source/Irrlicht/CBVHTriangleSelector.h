@@ -0,0 +1,128 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+#define __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+
+#include "CTriangleSelector.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class ISceneNode;
+
+//! Triangle selector with a bounding volume hierarchy, for many line queries on big meshes
+/** The hierarchy is built with the surface area heuristic and stored as a flat
+array of nodes, the children of a node are next to each other. Each leaf has up
+to four triangles, which are stored a second time in a packet with precomputed
+edges, so a line is tested against all of them at once.
+When built from an animated mesh scene node, the hierarchy is kept when the
+frame changes: the triangles are moved to their leaves and the boxes are
+refitted, which happens on the first query after the change only. */
+class CBVHTriangleSelector : public CTriangleSelector
+{
+public:
+
+	//! Constructs a selector based on a mesh
+	CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node);
+
+	//! Constructs a selector based on an animated mesh scene node
+	//!\param node An animated mesh scene node, which must have a valid mesh
+	CBVHTriangleSelector(IAnimatedMeshSceneNode* node);
+
+	//! Gets all triangles which lie within a specific bounding box.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize, s32& outTriangleCount,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform=0) const _IRR_OVERRIDE_;
+
+	//! Gets all triangles which have or may have contact with a 3d line.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const core::line3d<f32>& line,
+		const core::matrix4* transform=0) const _IRR_OVERRIDE_;
+
+	//! The nearest intersection with a line is found with the hierarchy.
+	virtual bool hasIntersectionWithLine() const _IRR_OVERRIDE_ { return true; }
+
+	//! Get the nearest intersection of a 3d line with the triangles of the selector.
+	virtual bool getIntersectionWithLine(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		ISceneNode*& outNode) const _IRR_OVERRIDE_;
+
+protected:
+
+	//! Node of the hierarchy, 32 bytes
+	struct SNode
+	{
+		core::vector3df MinEdge;
+		//! First child for inner nodes, packet for leaves
+		u32 Start;
+		core::vector3df MaxEdge;
+		//! Number of triangles of a leaf, 0 for inner nodes
+		u32 Count;
+	};
+
+	//! Up to four triangles of a leaf, unused ones have no area
+	struct STrianglePacket
+	{
+		f32 AX[4], AY[4], AZ[4];
+		f32 E1X[4], E1Y[4], E1Z[4];
+		f32 E2X[4], E2Y[4], E2Z[4];
+		//! Index of the first triangle in Triangles
+		u32 First;
+	};
+
+	//! Builds the hierarchy for the triangles, which are sorted into the order of the leaves
+	void build();
+
+	//! Moves the triangles of a new frame to their leaves and refits the hierarchy
+	virtual void updateFromMesh(const IMesh* mesh) const _IRR_OVERRIDE_;
+
+	//! Recalculates the boxes and packets of all nodes from the triangles
+	void refit() const;
+
+	//! Splits the triangles of a node, returns false if it should be a leaf
+	bool split(u32 first, u32 count, bool median, u32& outMiddle);
+
+	//! Makes a leaf from the triangles
+	void makeLeaf(u32 node, u32 first, u32 count, core::array<core::triangle3df>& sorted);
+
+	//! Sets the triangles of a packet
+	static void setPacket(STrianglePacket& packet, const core::triangle3df* triangles, u32 count);
+
+	//! Finds the nearest triangle hit by a line in the space of the mesh
+	/** \param start Start of the line
+	\param vector Vector from the start to the end
+	\param outT Receives the position on the line, between 0 and 1
+	\return Index of the triangle, or -1 if there is no hit */
+	s32 getNearestTriangle(const core::vector3df& start, const core::vector3df& vector, f32& outT) const;
+
+	//! Tests a line against the triangles of a packet, outT is only changed for a nearer hit
+	s32 intersectPacket(const STrianglePacket& packet, u32 count,
+		const core::vector3df& start, const core::vector3df& vector, f32& outT) const;
+
+	//! Appends the triangles of a leaf which aren't outside of the box
+	void addLeafTriangles(const SNode& leaf, const core::aabbox3d<f32>* box,
+		const core::matrix4& transform, core::triangle3df* triangles,
+		s32 arraySize, s32& trianglesWritten) const;
+
+	mutable core::array<SNode> Nodes; // (mutable for refitting)
+	mutable core::array<STrianglePacket> Packets;
+
+	//! Position in Triangles of each triangle of the mesh, only for animated nodes
+	core::array<u32> Slots;
+
+	// only used while building
+	core::array<core::aabbox3df> TriangleBoxes;
+	core::array<core::vector3df> Centers;
+	core::array<u32> Order;
+
+	bool UseSSE2;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
@@ -852,6 +852,13 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 	sScanConvertData scan;
 	u32 i;
 
+	// interpolators stepped by skipToBand
+	u32 interpolators = SCAN_IPOL_W;
+	for ( i = 0; i != ShaderParam.ColorUnits; ++i )
+		interpolators |= SCAN_IPOL_C0 << i;
+	for ( i = 0; i != ShaderParam.TextureUnits; ++i )
+		interpolators |= SCAN_IPOL_T0 << i;
+
 	// sort on height, y
 	if ( F32_A_GREATER_B ( a->Pos.y , b->Pos.y ) ) swapVertexPointer(&a, &b);
 	if ( F32_A_GREATER_B ( b->Pos.y , c->Pos.y ) ) swapVertexPointer(&b, &c);
@@ -931,6 +938,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 		subPixel = ( (f32) yStart ) - a->Pos.y;
 
@@ -953,6 +962,9 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			scan.t[i][1] += scan.slopeT[i][1] * subPixel;
 		}
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, interpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -1045,6 +1057,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 
 		subPixel = ( (f32) yStart ) - b->Pos.y;
@@ -1068,6 +1082,9 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			scan.t[i][1] += scan.slopeT[i][1] * subPixel;
 		}
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, interpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -0,0 +1,331 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+#include "CBurningSpanFill.h"
+
+#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
+#include "os.h"
+
+#ifdef SOFTWARE_DRIVER_2_SIMD
+	#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+#ifdef SOFTWARE_DRIVER_2_SIMD
+
+namespace
+{
+
+// ------------------ SSE2 helper ----------------------------------
+
+// low 32 bit of a 32 bit multiply, SSE2 has no pmulld
+inline __m128i mullo_epi32 ( const __m128i a, const __m128i b )
+{
+	const __m128i even = _mm_mul_epu32 ( a, b );
+	const __m128i odd = _mm_mul_epu32 ( _mm_srli_epi64 ( a, 32 ), _mm_srli_epi64 ( b, 32 ) );
+	return _mm_unpacklo_epi32 ( _mm_shuffle_epi32 ( even, _MM_SHUFFLE ( 0, 0, 2, 0 ) ),
+								_mm_shuffle_epi32 ( odd, _MM_SHUFFLE ( 0, 0, 2, 0 ) ) );
+}
+
+// mask ? a : b
+inline __m128i select_epi32 ( const __m128i mask, const __m128i a, const __m128i b )
+{
+	return _mm_or_si128 ( _mm_and_si128 ( mask, a ), _mm_andnot_si128 ( mask, b ) );
+}
+
+// mask ? a : b
+inline __m128 select_ps ( const __m128 mask, const __m128 a, const __m128 b )
+{
+	return _mm_or_ps ( _mm_and_ps ( mask, a ), _mm_andnot_ps ( mask, b ) );
+}
+
+// clampfix_maxcolor
+inline __m128i clampfix_maxcolor4 ( const __m128i a )
+{
+	const __m128i max = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	return select_epi32 ( _mm_cmplt_epi32 ( a, max ), a, max );
+}
+
+// fix_to_color
+inline __m128i fix_to_color4 ( const __m128i r, const __m128i g, const __m128i b )
+{
+	const __m128i mask = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+
+	__m128i c = _mm_set1_epi32 ( ( FIXPOINT_COLOR_MAX & FIXPOINT_COLOR_MAX ) << ( SHIFT_A - FIX_POINT_PRE ) );
+	c = _mm_or_si128 ( c, _mm_slli_epi32 ( _mm_and_si128 ( r, mask ), SHIFT_R - FIX_POINT_PRE ) );
+	c = _mm_or_si128 ( c, _mm_srli_epi32 ( _mm_and_si128 ( g, mask ), FIX_POINT_PRE - SHIFT_G ) );
+	c = _mm_or_si128 ( c, _mm_srli_epi32 ( _mm_and_si128 ( b, mask ), FIX_POINT_PRE - SHIFT_B ) );
+	return c;
+}
+
+// gathers four texels
+inline __m128i fetch4 ( const sInternalTexture* t, const __m128i ofs )
+{
+	u32 o[4];
+	_mm_storeu_si128 ( (__m128i*) o, ofs );
+
+	const u8* data = (const u8*) t->data;
+	return _mm_setr_epi32 ( *(const tVideoSample*) ( data + o[0] ),
+							*(const tVideoSample*) ( data + o[1] ),
+							*(const tVideoSample*) ( data + o[2] ),
+							*(const tVideoSample*) ( data + o[3] ) );
+}
+
+// getTexel_fix for four pixels
+inline void getTexel_fix4 ( __m128i& r, __m128i& g, __m128i& b,
+							const sInternalTexture* t, const __m128i tx, const __m128i ty )
+{
+	const __m128i pitch = _mm_cvtsi32_si128 ( t->pitchlog2 );
+
+	__m128i ofs = _mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( ty, _mm_set1_epi32 ( t->textureYMask ) ), FIX_POINT_PRE ), pitch );
+	ofs = _mm_or_si128 ( ofs, _mm_srli_epi32 ( _mm_and_si128 ( tx, _mm_set1_epi32 ( t->textureXMask ) ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY ) );
+
+	const __m128i t00 = fetch4 ( t, ofs );
+
+	r = _mm_srli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_R ) ), SHIFT_R - FIX_POINT_PRE );
+	g = _mm_slli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_G ) ), FIX_POINT_PRE - SHIFT_G );
+	b = _mm_slli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_B ) ), FIX_POINT_PRE - SHIFT_B );
+}
+
+// weights and texels are below 2^15, so pmaddwd on zero extended values is a 32 bit multiply
+inline __m128i mul16_epi32 ( const __m128i a, const __m128i b )
+{
+	return _mm_madd_epi16 ( a, b );
+}
+
+// bilinear getSample_texture for four pixels
+inline void getSample_texture4 ( __m128i& r, __m128i& g, __m128i& b,
+								const sInternalTexture* t, const __m128i tx, const __m128i ty )
+{
+	const __m128i one = _mm_set1_epi32 ( FIX_POINT_ONE );
+	const __m128i xMask = _mm_set1_epi32 ( t->textureXMask );
+	const __m128i yMask = _mm_set1_epi32 ( t->textureYMask );
+	const __m128i pitch = _mm_cvtsi32_si128 ( t->pitchlog2 );
+
+	const __m128i o0 = _mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( ty, yMask ), FIX_POINT_PRE ), pitch );
+	const __m128i o1 = _mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( _mm_add_epi32 ( ty, one ), yMask ), FIX_POINT_PRE ), pitch );
+	const __m128i o2 = _mm_srli_epi32 ( _mm_and_si128 ( tx, xMask ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	const __m128i o3 = _mm_srli_epi32 ( _mm_and_si128 ( _mm_add_epi32 ( tx, one ), xMask ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+
+	const __m128i t00 = fetch4 ( t, _mm_or_si128 ( o0, o2 ) );
+	const __m128i t10 = fetch4 ( t, _mm_or_si128 ( o0, o3 ) );
+	const __m128i t01 = fetch4 ( t, _mm_or_si128 ( o1, o2 ) );
+	const __m128i t11 = fetch4 ( t, _mm_or_si128 ( o1, o3 ) );
+
+	const __m128i fractMask = _mm_set1_epi32 ( FIX_POINT_FRACT_MASK );
+	const __m128i txFract = _mm_and_si128 ( tx, fractMask );
+	const __m128i txFractInv = _mm_sub_epi32 ( one, txFract );
+	const __m128i tyFract = _mm_and_si128 ( ty, fractMask );
+	const __m128i tyFractInv = _mm_sub_epi32 ( one, tyFract );
+
+	const __m128i w00 = _mm_srli_epi32 ( mul16_epi32 ( txFractInv, tyFractInv ), FIX_POINT_PRE );
+	const __m128i w10 = _mm_srli_epi32 ( mul16_epi32 ( txFract, tyFractInv ), FIX_POINT_PRE );
+	const __m128i w01 = _mm_srli_epi32 ( mul16_epi32 ( txFractInv, tyFract ), FIX_POINT_PRE );
+	const __m128i w11 = _mm_srli_epi32 ( mul16_epi32 ( txFract, tyFract ), FIX_POINT_PRE );
+
+	const __m128i byteMask = _mm_set1_epi32 ( 0xFF );
+
+#define BILINEAR_CHANNEL(shift) \
+	_mm_add_epi32 ( \
+		_mm_add_epi32 ( mul16_epi32 ( _mm_and_si128 ( _mm_srli_epi32 ( t00, shift ), byteMask ), w00 ), \
+						mul16_epi32 ( _mm_and_si128 ( _mm_srli_epi32 ( t01, shift ), byteMask ), w01 ) ), \
+		_mm_add_epi32 ( mul16_epi32 ( _mm_and_si128 ( _mm_srli_epi32 ( t10, shift ), byteMask ), w10 ), \
+						mul16_epi32 ( _mm_and_si128 ( _mm_srli_epi32 ( t11, shift ), byteMask ), w11 ) ) )
+
+	r = BILINEAR_CHANNEL ( SHIFT_R );
+	g = BILINEAR_CHANNEL ( SHIFT_G );
+	b = BILINEAR_CHANNEL ( SHIFT_B );
+
+#undef BILINEAR_CHANNEL
+}
+
+
+// ------------------ span filler ----------------------------------
+
+s32 spanFillTextureGouraud_SSE2 ( tVideoSample* dst, fp24* z, s32 i, const s32 dx,
+	f32& w, const f32 slopeW, sVec2& t, const sVec2& slopeT, sVec4& c, const sVec4& slopeC,
+	const sInternalTexture* texture )
+{
+	__m128 a = _mm_setr_ps ( w, t.x, t.y, 0.f );
+	const __m128 slopeA = _mm_setr_ps ( slopeW, slopeT.x, slopeT.y, 0.f );
+	__m128 col = _mm_setr_ps ( c.x, c.y, c.z, c.w );
+	const __m128 slopeCol = _mm_setr_ps ( slopeC.x, slopeC.y, slopeC.z, slopeC.w );
+
+	const __m128 fixOne = _mm_set1_ps ( FIX_POINT_F32_MUL );
+
+	for ( ; i + 3 <= dx; i += 4 )
+	{
+		// step one pixel after the other, then transpose to one register per value
+		__m128 w4 = a;			a = _mm_add_ps ( a, slopeA );
+		__m128 tx4 = a;			a = _mm_add_ps ( a, slopeA );
+		__m128 ty4 = a;			a = _mm_add_ps ( a, slopeA );
+		__m128 a3 = a;			a = _mm_add_ps ( a, slopeA );
+		_MM_TRANSPOSE4_PS ( w4, tx4, ty4, a3 );
+
+		__m128 c0 = col;		col = _mm_add_ps ( col, slopeCol );
+		__m128 r4 = col;		col = _mm_add_ps ( col, slopeCol );
+		__m128 g4 = col;		col = _mm_add_ps ( col, slopeCol );
+		__m128 b4 = col;		col = _mm_add_ps ( col, slopeCol );
+		_MM_TRANSPOSE4_PS ( c0, r4, g4, b4 );
+
+		const __m128 zOld = _mm_loadu_ps ( z + i );
+		const __m128 pass = _mm_cmpge_ps ( w4, zOld );
+		if ( 0 == _mm_movemask_ps ( pass ) )
+			continue;
+
+		_mm_storeu_ps ( z + i, select_ps ( pass, w4, zOld ) );
+
+		const __m128 inversew = _mm_div_ps ( fixOne, w4 );
+
+		__m128i r0, g0, b0;
+		getSample_texture4 ( r0, g0, b0, texture,
+							_mm_cvttps_epi32 ( _mm_mul_ps ( tx4, inversew ) ),
+							_mm_cvttps_epi32 ( _mm_mul_ps ( ty4, inversew ) ) );
+
+		const __m128i r1 = _mm_cvttps_epi32 ( _mm_mul_ps ( r4, inversew ) );
+		const __m128i g1 = _mm_cvttps_epi32 ( _mm_mul_ps ( g4, inversew ) );
+		const __m128i b1 = _mm_cvttps_epi32 ( _mm_mul_ps ( b4, inversew ) );
+
+		const __m128i color = fix_to_color4 ( _mm_srai_epi32 ( mullo_epi32 ( r0, r1 ), FIX_POINT_PRE ),
+											_mm_srai_epi32 ( mullo_epi32 ( g0, g1 ), FIX_POINT_PRE ),
+											_mm_srai_epi32 ( mullo_epi32 ( b0, b1 ), FIX_POINT_PRE ) );
+
+		__m128i* d = (__m128i*) ( dst + i );
+		_mm_storeu_si128 ( d, select_epi32 ( _mm_castps_si128 ( pass ), color, _mm_loadu_si128 ( d ) ) );
+	}
+
+	f32 v[4];
+	_mm_storeu_ps ( v, a );
+	w = v[0];
+	t.x = v[1];
+	t.y = v[2];
+
+	_mm_storeu_ps ( v, col );
+	c.x = v[0];
+	c.y = v[1];
+	c.z = v[2];
+	c.w = v[3];
+
+	return i;
+}
+
+
+s32 spanFillLightMap_SSE2 ( tVideoSample* dst, fp24* z, s32 i, const s32 dx,
+	f32& w, const f32 slopeW, sVec2& t0, const sVec2& slopeT0, sVec2& t1, const sVec2& slopeT1,
+	const sInternalTexture* texture, const u32 scale, const bool bilinear )
+{
+	__m128 a = _mm_setr_ps ( w, t0.x, t0.y, 0.f );
+	const __m128 slopeA = _mm_setr_ps ( slopeW, slopeT0.x, slopeT0.y, 0.f );
+	__m128 b = _mm_setr_ps ( t1.x, t1.y, 0.f, 0.f );
+	const __m128 slopeB = _mm_setr_ps ( slopeT1.x, slopeT1.y, 0.f, 0.f );
+
+	const __m128 fixOne = _mm_set1_ps ( FIX_POINT_F32_MUL );
+
+	// imulFix_tex1, imulFix_tex2 and imulFix_tex4
+	const __m128i shift = _mm_cvtsi32_si128 ( FIX_POINT_PRE + 4 - scale );
+
+	for ( ; i + 3 <= dx; i += 4 )
+	{
+		// step one pixel after the other, then transpose to one register per value
+		__m128 w4 = a;			a = _mm_add_ps ( a, slopeA );
+		__m128 tx0 = a;			a = _mm_add_ps ( a, slopeA );
+		__m128 ty0 = a;			a = _mm_add_ps ( a, slopeA );
+		__m128 a3 = a;			a = _mm_add_ps ( a, slopeA );
+		_MM_TRANSPOSE4_PS ( w4, tx0, ty0, a3 );
+
+		__m128 tx1 = b;			b = _mm_add_ps ( b, slopeB );
+		__m128 ty1 = b;			b = _mm_add_ps ( b, slopeB );
+		__m128 b2 = b;			b = _mm_add_ps ( b, slopeB );
+		__m128 b3 = b;			b = _mm_add_ps ( b, slopeB );
+		_MM_TRANSPOSE4_PS ( tx1, ty1, b2, b3 );
+
+		const __m128 zOld = _mm_loadu_ps ( z + i );
+		const __m128 pass = _mm_cmpge_ps ( w4, zOld );
+		if ( 0 == _mm_movemask_ps ( pass ) )
+			continue;
+
+		_mm_storeu_ps ( z + i, select_ps ( pass, w4, zOld ) );
+
+		const __m128 inversew = _mm_div_ps ( fixOne, w4 );
+
+		const __m128i s0 = _mm_cvttps_epi32 ( _mm_mul_ps ( tx0, inversew ) );
+		const __m128i u0 = _mm_cvttps_epi32 ( _mm_mul_ps ( ty0, inversew ) );
+		const __m128i s1 = _mm_cvttps_epi32 ( _mm_mul_ps ( tx1, inversew ) );
+		const __m128i u1 = _mm_cvttps_epi32 ( _mm_mul_ps ( ty1, inversew ) );
+
+		__m128i r0, g0, b0;
+		__m128i r1, g1, b1;
+		if ( bilinear )
+		{
+			getSample_texture4 ( r0, g0, b0, texture + 0, s0, u0 );
+			getSample_texture4 ( r1, g1, b1, texture + 1, s1, u1 );
+		}
+		else
+		{
+			getTexel_fix4 ( r0, g0, b0, texture + 0, s0, u0 );
+			getTexel_fix4 ( r1, g1, b1, texture + 1, s1, u1 );
+		}
+
+		// the products of the scaled down values fit into 32 bit, the clamp is a no-op for scale 0
+		const __m128i color = fix_to_color4 (
+			clampfix_maxcolor4 ( _mm_srl_epi32 ( mullo_epi32 ( _mm_srli_epi32 ( r0, 2 ), _mm_srli_epi32 ( r1, 2 ) ), shift ) ),
+			clampfix_maxcolor4 ( _mm_srl_epi32 ( mullo_epi32 ( _mm_srli_epi32 ( g0, 2 ), _mm_srli_epi32 ( g1, 2 ) ), shift ) ),
+			clampfix_maxcolor4 ( _mm_srl_epi32 ( mullo_epi32 ( _mm_srli_epi32 ( b0, 2 ), _mm_srli_epi32 ( b1, 2 ) ), shift ) ) );
+
+		__m128i* d = (__m128i*) ( dst + i );
+		_mm_storeu_si128 ( d, select_epi32 ( _mm_castps_si128 ( pass ), color, _mm_loadu_si128 ( d ) ) );
+	}
+
+	f32 v[4];
+	_mm_storeu_ps ( v, a );
+	w = v[0];
+	t0.x = v[1];
+	t0.y = v[2];
+
+	_mm_storeu_ps ( v, b );
+	t1.x = v[0];
+	t1.y = v[1];
+
+	return i;
+}
+
+} // end anonymous namespace
+
+#endif // SOFTWARE_DRIVER_2_SIMD
+
+
+const sBurningSpanFill& getBurningSpanFill()
+{
+	static sBurningSpanFill fill;
+	static bool initialized = false;
+
+	if ( !initialized )
+	{
+		fill.TextureGouraud = 0;
+		fill.LightMap = 0;
+
+#ifdef SOFTWARE_DRIVER_2_SIMD
+		if ( os::Cpu::hasSSE2() )
+		{
+			fill.TextureGouraud = spanFillTextureGouraud_SSE2;
+			fill.LightMap = spanFillLightMap_SSE2;
+		}
+#endif
+		initialized = true;
+	}
+
+	return fill;
+}
+
+
+} // end namespace video
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_BURNINGSVIDEO_
@@ -0,0 +1,46 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BURNING_SPAN_FILL_H_INCLUDED__
+#define __C_BURNING_SPAN_FILL_H_INCLUDED__
+
+#include "SoftwareDriver2_compile_config.h"
+#include "S4DVertex.h"
+
+namespace irr
+{
+namespace video
+{
+
+	//! texture 0 modulated by the vertex color, w-buffer test and write. See CTRTextureGouraud2
+	typedef s32 (*tSpanFillTextureGouraud) ( tVideoSample* dst, fp24* z, s32 i, s32 dx,
+		f32& w, f32 slopeW, sVec2& t, const sVec2& slopeT, sVec4& c, const sVec4& slopeC,
+		const sInternalTexture* texture );
+
+	//! texture 0 modulated by texture 1 and scaled by 1 << scale, w-buffer test and write.
+	/** See CTRTextureLightMap2_M1, _M2 and _M4. bilinear selects bilinear filtering or
+	plain texel fetches for both textures. */
+	typedef s32 (*tSpanFillLightMap) ( tVideoSample* dst, fp24* z, s32 i, s32 dx,
+		f32& w, f32 slopeW, sVec2& t0, const sVec2& slopeT0, sVec2& t1, const sVec2& slopeT1,
+		const sInternalTexture* texture, u32 scale, bool bilinear );
+
+	//! Vectorized span fillers for the perspective correct, w-buffered triangle renderers.
+	/** A span filler draws the pixels i..dx of a scanline in groups of four and returns the
+	index of the first pixel it didn't draw, the shader finishes the scanline with its scalar
+	loop. The interpolators are advanced one pixel after the other like in the scalar loops,
+	so both paths write the same values. Entries are 0 if the processor isn't supported. */
+	struct sBurningSpanFill
+	{
+		tSpanFillTextureGouraud TextureGouraud;
+		tSpanFillLightMap LightMap;
+	};
+
+	//! returns the span fillers for the processor the engine runs on
+	const sBurningSpanFill& getBurningSpanFill();
+
+} // end namespace video
+} // end namespace irr
+
+#endif
+
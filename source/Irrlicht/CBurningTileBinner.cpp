@@ -0,0 +1,251 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "IrrCompileConfig.h"
+#include "CBurningTileBinner.h"
+
+#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
+#include "CSoftwareDriver2.h"
+#include "CSoftwareTexture2.h"
+
+namespace irr
+{
+namespace video
+{
+
+// height of a band in scanlines
+static const s32 BAND_HEIGHT = 32;
+
+// pending triangles are rasterized when this many are collected
+static const u32 MAX_PENDING_TRIANGLES = 16384;
+
+
+//! constructor
+CBurningTileBinner::CBurningTileBinner(CBurningVideoDriver* driver, CThreadPool* pool)
+: Driver(driver), Pool(pool), Target(0),
+	StateShader(ETR_INVALID), StateMaterial(0), StateDirty(true)
+{
+	Pool->grab();
+
+	for (u32 i = 0; i != BURNING_MATERIAL_MAX_TEXTURES; ++i)
+		LastTexture[i] = 0;
+}
+
+
+//! destructor
+CBurningTileBinner::~CBurningTileBinner()
+{
+	clear();
+
+	for (u32 i = 0; i != Shaders.size(); ++i)
+	{
+		if (Shaders[i])
+			Shaders[i]->drop();
+	}
+
+	if (Target)
+		Target->drop();
+
+	Pool->drop();
+}
+
+
+void CBurningTileBinner::applyState(IBurningShader* shader, EBurningFFShader type, const SBurningShaderMaterial& material)
+{
+	shader->setZCompareFunc ( material.org.ZBuffer );
+	shader->setMaterial ( material );
+
+	switch ( type )
+	{
+		case ETR_TEXTURE_GOURAUD_ALPHA:
+		case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
+		case ETR_TEXTURE_BLEND:
+			shader->setParam ( 0, material.org.MaterialTypeParam );
+			break;
+		default:
+		break;
+	}
+}
+
+
+void CBurningTileBinner::setState(EBurningFFShader shader, const SBurningShaderMaterial* material)
+{
+	StateShader = shader;
+	StateMaterial = material;
+	StateDirty = true;
+}
+
+
+void CBurningTileBinner::addTriangle(const IBurningShader* shader,
+	const s4DVertex* a, const s4DVertex* b, const s4DVertex* c)
+{
+	if ( StateDirty )
+	{
+		States.push_back(SState());
+		States.getLast().Material = *StateMaterial;
+		States.getLast().Shader = StateShader;
+		StateDirty = false;
+	}
+
+	Triangles.push_back(STriangle());
+	STriangle& t = Triangles.getLast();
+
+	t.Vertex[0] = *a;
+	t.Vertex[1] = *b;
+	t.Vertex[2] = *c;
+	t.State = States.size() - 1;
+
+	// scanlines the shader will touch, see top-left fill convention in the shaders
+	const f32 yMin = core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y );
+	const f32 yMax = core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y );
+	t.YStart = core::ceil32 ( yMin );
+	t.YEnd = core::ceil32 ( yMax ) - 1;
+
+	// keep the textures alive until the triangle is drawn
+	for (u32 i = 0; i != BURNING_MATERIAL_MAX_TEXTURES; ++i)
+	{
+		t.Texture[i] = shader->getTextureParam(i);
+
+		ITexture* tex = t.Texture[i].Texture;
+		if ( tex && tex != LastTexture[i] )
+		{
+			tex->grab();
+			Textures.push_back(tex);
+			LastTexture[i] = tex;
+		}
+	}
+
+	if ( Triangles.size() >= MAX_PENDING_TRIANGLES )
+		flush();
+}
+
+
+void CBurningTileBinner::setRenderTarget(video::IImage* target)
+{
+	if ( target == Target )
+		return;
+
+	flush();
+
+	// reference counting isn't thread safe, so the shaders of all threads
+	// are switched here
+	if (target)
+		target->grab();
+	if (Target)
+		Target->drop();
+	Target = target;
+
+	for (u32 i = 0; i != Shaders.size(); ++i)
+	{
+		if (Shaders[i])
+			Shaders[i]->setRenderTarget(Target, core::rect<s32>());
+	}
+}
+
+
+void CBurningTileBinner::flush()
+{
+	if ( Triangles.empty() || !Target )
+	{
+		clear();
+		return;
+	}
+
+	// one set of shaders per thread, created on first use
+	const u32 threadCount = Pool->getThreadCount();
+	while ( Shaders.size() < threadCount * ETR2_COUNT )
+	{
+		const u32 first = Shaders.size();
+		Shaders.set_used(first + ETR2_COUNT);
+		Driver->createShaders(&Shaders[first]);
+		for (u32 i = first; i != Shaders.size(); ++i)
+		{
+			if (Shaders[i])
+				Shaders[i]->setRenderTarget(Target, core::rect<s32>());
+		}
+	}
+
+	// sort into bands
+	const s32 height = (s32) Target->getDimension().Height;
+	const u32 bandCount = core::max_ ( (height + BAND_HEIGHT - 1) / BAND_HEIGHT, 1 );
+	if ( Bands.size() < bandCount )
+		Bands.reallocate(bandCount);
+	while ( Bands.size() < bandCount )
+		Bands.push_back(core::array<u32>());
+
+	for (u32 i = 0; i != bandCount; ++i)
+		Bands[i].set_used(0);
+
+	for (u32 i = 0; i != Triangles.size(); ++i)
+	{
+		const STriangle& t = Triangles[i];
+		if ( t.YEnd < t.YStart )
+			continue;
+
+		const s32 first = core::s32_max ( t.YStart / BAND_HEIGHT, 0 );
+		const s32 last = core::s32_min ( t.YEnd / BAND_HEIGHT, (s32) bandCount - 1 );
+		for (s32 b = first; b <= last; ++b)
+			Bands[b].push_back(i);
+	}
+
+	Pool->run(this, bandCount);
+
+	clear();
+}
+
+
+void CBurningTileBinner::run(u32 index, u32 thread)
+{
+	const core::array<u32>& band = Bands[index];
+	if ( band.empty() )
+		return;
+
+	IBurningShader** shaders = &Shaders[thread * ETR2_COUNT];
+	const s32 start = (s32) index * BAND_HEIGHT;
+	const s32 end = start + BAND_HEIGHT;
+
+	u32 state = 0xFFFFFFFF;
+	IBurningShader* shader = 0;
+
+	for (u32 i = 0; i != band.size(); ++i)
+	{
+		const STriangle& t = Triangles[band[i]];
+
+		if ( t.State != state )
+		{
+			state = t.State;
+			const SState& s = States[state];
+			shader = shaders[s.Shader];
+			applyState(shader, s.Shader, s.Material);
+			shader->setScanlineBand(start, end);
+		}
+
+		for (u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m)
+			shader->setTextureParamUnsafe(m, t.Texture[m]);
+
+		shader->drawTriangle(t.Vertex + 0, t.Vertex + 1, t.Vertex + 2);
+	}
+}
+
+
+void CBurningTileBinner::clear()
+{
+	Triangles.set_used(0);
+	States.clear();
+	StateDirty = true;
+
+	for (u32 i = 0; i != Textures.size(); ++i)
+		Textures[i]->drop();
+	Textures.set_used(0);
+
+	for (u32 i = 0; i != BURNING_MATERIAL_MAX_TEXTURES; ++i)
+		LastTexture[i] = 0;
+}
+
+
+} // end namespace video
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_BURNINGSVIDEO_
@@ -0,0 +1,103 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BURNING_TILE_BINNER_H_INCLUDED__
+#define __C_BURNING_TILE_BINNER_H_INCLUDED__
+
+#include "SoftwareDriver2_compile_config.h"
+#include "IBurningShader.h"
+#include "CThreadPool.h"
+
+namespace irr
+{
+namespace video
+{
+
+	/*!
+		Tile binned rasterizer for Burning's Video.
+
+		Collects the projected triangles of several draw calls together with the
+		shader state they were drawn with, sorts them into horizontal bands of the
+		render target and rasterizes the bands in parallel. Every thread uses its
+		own set of shaders, which only write the scanlines of their band, so the
+		result is identical to drawing the triangles one after another.
+	*/
+	class CBurningTileBinner : public IThreadJob
+	{
+	public:
+
+		//! constructor
+		CBurningTileBinner(CBurningVideoDriver* driver, CThreadPool* pool);
+
+		//! destructor, drops pending triangles
+		virtual ~CBurningTileBinner();
+
+		//! sets the shader type and material of the following triangles
+		/** The material is copied when the next triangle is added, so it has
+		to stay valid until then. */
+		void setState(EBurningFFShader shader, const SBurningShaderMaterial* material);
+
+		//! adds a projected triangle, using the texture state of shader
+		void addTriangle(const IBurningShader* shader,
+			const s4DVertex* a, const s4DVertex* b, const s4DVertex* c);
+
+		//! sets the render target of the following triangles
+		/** Pending triangles are rasterized into the previous target first. */
+		void setRenderTarget(video::IImage* target);
+
+		//! rasterizes all pending triangles
+		void flush();
+
+		//! returns true if no triangles are pending
+		bool empty() const { return Triangles.empty(); }
+
+		//! applies the render states of a material to a shader of the given type
+		static void applyState(IBurningShader* shader, EBurningFFShader type, const SBurningShaderMaterial& material);
+
+		//! rasterizes one band, called by the thread pool
+		virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_;
+
+	private:
+
+		struct SState
+		{
+			SBurningShaderMaterial Material;
+			EBurningFFShader Shader;
+		};
+
+		struct STriangle
+		{
+			s4DVertex Vertex[3];
+			sInternalTexture Texture[BURNING_MATERIAL_MAX_TEXTURES];
+			u32 State;
+			s32 YStart;
+			s32 YEnd;
+		};
+
+		void clear();
+
+		CBurningVideoDriver* Driver;
+		CThreadPool* Pool;
+
+		// ETR2_COUNT shaders per thread
+		core::array<IBurningShader*> Shaders;
+		video::IImage* Target;
+
+		core::array<SState> States;
+		core::array<STriangle> Triangles;
+		core::array< core::array<u32> > Bands;
+
+		// textures referenced by pending triangles
+		core::array<ITexture*> Textures;
+		const ITexture* LastTexture[BURNING_MATERIAL_MAX_TEXTURES];
+
+		EBurningFFShader StateShader;
+		const SBurningShaderMaterial* StateMaterial;
+		bool StateDirty;
+	};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
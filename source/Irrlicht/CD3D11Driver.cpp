@@ -720,6 +720,7 @@ bool CD3D11Driver::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
 	case EVDF_MIP_MAP:
 	case EVDF_MIP_MAP_AUTO_UPDATE:
 	case EVDF_TEXTURE_MULTISAMPLING:
+	case EVDF_INSTANCING:
 	case EVDF_VERTEX_SHADER_1_1:
 	case EVDF_VERTEX_SHADER_2_0:
 	case EVDF_VERTEX_SHADER_3_0:
@@ -808,6 +809,26 @@ void CD3D11Driver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	if (!mb)
 		return;
 
+	renderMeshBuffer(mb, 0, mb->getPrimitiveCount());
+}
+
+//! Draws a range of the indices of a mesh buffer
+void CD3D11Driver::drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount)
+{
+	if (!mb || !mb->isVertexBufferCompatible())
+		return;
+
+	const u32 primitiveCount = getPrimitiveCount(mb->getPrimitiveType(), indexCount);
+	if (!primitiveCount || firstIndex + indexCount > mb->getIndexBuffer()->getIndexCount())
+		return;
+
+	CNullDriver::drawMeshBufferRange(mb, firstIndex, indexCount);
+
+	renderMeshBuffer(mb, firstIndex, primitiveCount);
+}
+
+void CD3D11Driver::renderMeshBuffer(const scene::IMeshBuffer* mb, u32 firstIndex, u32 primitiveCount)
+{
 	//we lie to the user we are always using hardware buffers in dx11 it's much faster and avoid stalling the pipeline when writting to a buffer that needs to be used for rendering
 	for (u32 i = 0; i < mb->getVertexBufferCount(); ++i)
 	{
@@ -879,8 +900,8 @@ void CD3D11Driver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	if (ib->getHardwareBuffer())
 		Context->IASetIndexBuffer(((CD3D11HardwareBuffer*)ib->getHardwareBuffer())->getBuffer(), mb->getIndexBuffer()->getType() == video::EIT_16BIT ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
 
-	// draw
-	draw2D3DVertexPrimitiveList(NULL, drawVertexCount, mb->getVertexDescriptor()->getVertexSize(0), NULL, mb->getPrimitiveCount(), ((E_VERTEX_TYPE)((CD3D11VertexDescriptor*)mb->getVertexDescriptor())->getID()), mb->getPrimitiveType(), ib->getType(), true, instanceVertexCount);
+	// draw, a range starts at an index of the bound index buffer
+	draw2D3DVertexPrimitiveList(NULL, drawVertexCount, mb->getVertexDescriptor()->getVertexSize(0), NULL, primitiveCount, ((E_VERTEX_TYPE)((CD3D11VertexDescriptor*)mb->getVertexDescriptor())->getID()), mb->getPrimitiveType(), ib->getType(), true, instanceVertexCount, firstIndex);
 
 	for (u32 i = 0; i < mb->getVertexBufferCount(); ++i)
 	{
@@ -1290,7 +1311,7 @@ void CD3D11Driver::drawHardwareBuffer(IHardwareBuffer* vertices,
 
 void CD3D11Driver::draw2D3DVertexPrimitiveList(const void* vertices, u32 vertexCount, u32 pVertexSize,
 											   const void* indices, u32 primitiveCount, E_VERTEX_TYPE vType,
-											   scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType, bool is3D, u32 numInstances)
+											   scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType, bool is3D, u32 numInstances, u32 startIndex)
 {
 	if (is3D)
 	{
@@ -1340,7 +1361,7 @@ void CD3D11Driver::draw2D3DVertexPrimitiveList(const void* vertices, u32 vertexC
 		else if (vertexCount == 0)
 			Context->DrawAuto();
 		else			{
-			Context->DrawIndexed(indexCount, 0, 0);
+			Context->DrawIndexed(indexCount, startIndex, 0);
 		}
 	}
 	else
@@ -1350,7 +1371,7 @@ void CD3D11Driver::draw2D3DVertexPrimitiveList(const void* vertices, u32 vertexC
 		else if (vertexCount == 0)
 			Context->DrawAuto();
 		else
-			Context->DrawIndexedInstanced(indexCount, numInstances, 0, 0, 0);
+			Context->DrawIndexedInstanced(indexCount, numInstances, startIndex, 0, 0);
 	}
 }
 
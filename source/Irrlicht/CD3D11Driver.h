@@ -81,6 +81,9 @@ namespace video
 
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
 
+		//! Draws a range of the indices of a mesh buffer
+		virtual void drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount) _IRR_OVERRIDE_;
+
 		virtual void draw2DVertexPrimitiveList(const void* vertices, u32 vertexCount, const void* indices,
 			u32 primitiveCount, E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType) _IRR_OVERRIDE_;
 
@@ -161,6 +164,9 @@ namespace video
 			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 			const core::rect<s32>* clip);
 
+		//! 2d images and rectangles are always drawn immediately
+		virtual bool is2DBatchingEnabled() const { return false; }
+
 		//! Draws a 2d line.
 		virtual void draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
@@ -471,7 +477,9 @@ namespace video
 
 		void draw2D3DVertexPrimitiveList(const void* vertices, u32 vertexCount, u32 pVertexSize, 
 			const void* indices, u32 primitiveCount, E_VERTEX_TYPE vType, 
-			scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType, bool is3D, u32 numInstances = 0);
+			scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType, bool is3D, u32 numInstances = 0, u32 startIndex = 0);
+
+		void renderMeshBuffer(const scene::IMeshBuffer* mb, u32 firstIndex, u32 primitiveCount);
 
 		D3D11_TEXTURE_ADDRESS_MODE getTextureWrapMode(const u8 clamp);
 
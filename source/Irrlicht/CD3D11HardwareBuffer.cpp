@@ -172,16 +172,23 @@ bool CD3D11HardwareBuffer::update(const scene::E_HARDWARE_MAPPING mapping, const
 		if (!Buffer)
 			return false;
 	}
-	else // just update 
+	else // just update the requested range
 	{
-		D3D11_BOX box;
-		box.left = 0;
-		box.top = 0;
-		box.front = 0;
-		box.right = size;
-		box.bottom = 1;
-		box.back = 1;
-		Context->UpdateSubresource(Buffer, 0, &box, data, 0, 0);
+		u32 begin = 0;
+		u32 end = 0;
+		getUpdateRange(size, begin, end);
+
+		if (begin < end)
+		{
+			D3D11_BOX box;
+			box.left = begin;
+			box.top = 0;
+			box.front = 0;
+			box.right = end;
+			box.bottom = 1;
+			box.back = 1;
+			Context->UpdateSubresource(Buffer, 0, &box, (const c8*)data + begin, 0, 0);
+		}
 	}
 
 	RequiredUpdate = false;
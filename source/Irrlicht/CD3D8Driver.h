@@ -100,6 +100,9 @@ namespace video
 			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 			const core::rect<s32>* clip = 0) _IRR_OVERRIDE_;
 
+		//! 2d images and rectangles are always drawn immediately
+		virtual bool is2DBatchingEnabled() const _IRR_OVERRIDE_ { return false; }
+
 		//! Draws a 2d line.
 		virtual void draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
@@ -8,6 +8,8 @@
 #ifdef _IRR_COMPILE_WITH_DIRECT3D_9_
 
 #include "os.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 #include "S3DVertex.h"
 #include "CD3D9Texture.h"
 #include "CD3D9MaterialRenderer.h"
@@ -355,16 +357,17 @@ bool CD3D9HardwareBuffer::updateIndexBuffer(const scene::E_HARDWARE_MAPPING mapp
 
 bool CD3D9HardwareBuffer::updateVertexBuffer(const scene::E_HARDWARE_MAPPING mapping, const u32 size, const void* data)
 {
-	u32 oldSize = Size;
-
 	Mapping = mapping;
-	Size = size;
 
-	if (Mapping == scene::EHM_NEVER || Size == 0 || !data || !Driver)
+	if (Mapping == scene::EHM_NEVER || size == 0 || !data || !Driver)
 		return false;
 
-	if (!VertexBuffer || (Size > oldSize))
+	// the buffer keeps its size when less data is used, so it doesn't have to be
+	// recreated when it grows again
+	if (!VertexBuffer || (size > Size))
 	{
+		Size = size;
+
 		if (VertexBuffer)
 		{
 			VertexBuffer->Release();
@@ -391,12 +394,29 @@ bool CD3D9HardwareBuffer::updateVertexBuffer(const scene::E_HARDWARE_MAPPING map
 	}
 	else
 	{
-		void* lockedBuffer = 0;
-		VertexBuffer->Lock(0, Size, (void**)&lockedBuffer, D3DLOCK_DISCARD);
-		memcpy(lockedBuffer, data, Size);
-		VertexBuffer->Unlock();
+		u32 begin = 0;
+		u32 end = 0;
+		getUpdateRange(size, begin, end);
+
+		// a discarded buffer has to be filled completely
+		if (begin == 0 && end == size)
+		{
+			void* lockedBuffer = 0;
+			VertexBuffer->Lock(0, size, (void**)&lockedBuffer, D3DLOCK_DISCARD);
+			memcpy(lockedBuffer, data, size);
+			VertexBuffer->Unlock();
+		}
+		else if (begin < end)
+		{
+			void* lockedBuffer = 0;
+			VertexBuffer->Lock(begin, end - begin, (void**)&lockedBuffer, 0);
+			memcpy(lockedBuffer, (const c8*)data + begin, end - begin);
+			VertexBuffer->Unlock();
+		}
 	}
 
+	RequiredUpdate = false;
+
 	return true;
 }
 
@@ -1096,6 +1116,8 @@ bool CD3D9Driver::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
 		return true;
 	case EVDF_TEXTURE_COMPRESSED_DXT:
 		return true;
+	case EVDF_INSTANCING:
+		return Caps.VertexShaderVersion >= D3DVS_VERSION(3,0);
 	default:
 		return false;
 	};
@@ -1143,6 +1165,9 @@ void CD3D9Driver::setTransform(E_TRANSFORMATION_STATE state,
 //! sets the current Texture
 bool CD3D9Driver::setActiveTexture(u32 stage, const video::ITexture* texture)
 {
+	// the batched 2d quads use the textures which are set now
+	flush2DBatch();
+
 	if (CurrentTexture[stage] == texture)
 		return true;
 
@@ -1207,6 +1232,8 @@ void CD3D9Driver::setTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag,
 bool CD3D9Driver::setRenderTarget(video::ITexture* texture, bool clearBackBuffer,
 	bool clearZBuffer, SColor color, video::ITexture* depthStencil)
 {
+	flush2DBatch();
+
 	// check for right driver type
 
 	if (texture && texture->getDriverType() != EDT_DIRECT3D9)
@@ -1305,6 +1332,8 @@ bool CD3D9Driver::setRenderTarget(video::ITexture* texture, bool clearBackBuffer
 bool CD3D9Driver::setRenderTarget(const core::array<video::IRenderTarget>& targets,
 	bool clearBackBuffer, bool clearZBuffer, SColor color, video::ITexture* depthStencil)
 {
+	flush2DBatch();
+
 	if (targets.size()==0)
 		return setRenderTarget(0, clearBackBuffer, clearZBuffer, color, depthStencil);
 
@@ -1424,6 +1453,8 @@ bool CD3D9Driver::setRenderTarget(const core::array<video::IRenderTarget>& targe
 //! sets a viewport
 void CD3D9Driver::setViewPort(const core::rect<s32>& area)
 {
+	flush2DBatch();
+
 	core::rect<s32> vp = area;
 	core::rect<s32> rendert(0,0, getCurrentRenderTargetSize().Width, getCurrentRenderTargetSize().Height);
 	vp.clipAgainst(rendert);
@@ -1622,6 +1653,31 @@ void CD3D9Driver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 
 	CNullDriver::drawMeshBuffer(mb);
 
+	renderMeshBuffer(mb, 0, mb->getPrimitiveCount());
+}
+
+
+//! Draws a range of the indices of a mesh buffer
+void CD3D9Driver::drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount)
+{
+	if (!mb || !mb->isVertexBufferCompatible())
+		return;
+
+	const u32 primitiveCount = getPrimitiveCount(mb->getPrimitiveType(), indexCount);
+	if (!primitiveCount || firstIndex + indexCount > mb->getIndexBuffer()->getIndexCount())
+		return;
+
+	if (!checkPrimitiveCount(primitiveCount))
+		return;
+
+	CNullDriver::drawMeshBufferRange(mb, firstIndex, indexCount);
+
+	renderMeshBuffer(mb, firstIndex, primitiveCount);
+}
+
+
+void CD3D9Driver::renderMeshBuffer(const scene::IMeshBuffer* mb, u32 firstIndex, u32 primitiveCount)
+{
 	// draw everything
 	setRenderStates3DMode();
 
@@ -1644,7 +1700,6 @@ void CD3D9Driver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	u8* vertexData = 0;
 	const u32 vertexBufferCount = mb->getVertexBufferCount();
 
-	const u32 primitiveCount = mb->getPrimitiveCount();
 	const scene::E_PRIMITIVE_TYPE primitiveType = mb->getPrimitiveType();
 
 	const bool hwRecommended = (isHardwareBufferRecommend(mb) || vertexBufferCount > 1);
@@ -1673,6 +1728,10 @@ void CD3D9Driver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 			drawVertexCount = vertexBuffer->getVertexCount();
 	}
 
+	// a frequency of 0 instances is invalid
+	if (perInstanceBufferPresent && !instanceVertexCount)
+		return;
+
 	for (u32 i = 0; i < vertexBufferCount; ++i)
 	{
 		vertexBuffer = mb->getVertexBuffer(i);
@@ -1762,7 +1821,10 @@ void CD3D9Driver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	if (hwIndexBuffer)
 		pID3DDevice->SetIndices(hwIndexBuffer);
 
-	renderArray(streamCount > 0 ? 0 : vertexData, vertexSize, drawVertexCount, hwIndexBuffer ? 0 : indexData, indexType, primitiveCount, primitiveType);
+	// a range starts at an index of the hardware buffer or at an offset into the indices in memory
+	renderArray(streamCount > 0 ? 0 : vertexData, vertexSize, drawVertexCount,
+		hwIndexBuffer ? 0 : static_cast<const u8*>(indexData) + firstIndex * indexSize, indexType,
+		firstIndex, primitiveCount, primitiveType);
 
 	if (hwIndexBuffer)
 		pID3DDevice->SetIndices(0);
@@ -1777,7 +1839,7 @@ void CD3D9Driver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
-void CD3D9Driver::renderArray(const void* vertices, u32 vertexSize, u32 vertexCount, const void* indices, D3DFORMAT indexType, u32 primitiveCount, scene::E_PRIMITIVE_TYPE primitiveType)
+void CD3D9Driver::renderArray(const void* vertices, u32 vertexSize, u32 vertexCount, const void* indices, D3DFORMAT indexType, u32 startIndex, u32 primitiveCount, scene::E_PRIMITIVE_TYPE primitiveType)
 {
 	switch (primitiveType)
 	{
@@ -1798,7 +1860,7 @@ void CD3D9Driver::renderArray(const void* vertices, u32 vertexSize, u32 vertexCo
 			pID3DDevice->SetRenderState(D3DRS_POINTSCALE_C, F2DW(tmp));
 
 			if (!vertices)
-				pID3DDevice->DrawIndexedPrimitive(D3DPT_POINTLIST, 0, 0, vertexCount, 0, primitiveCount);
+				pID3DDevice->DrawIndexedPrimitive(D3DPT_POINTLIST, 0, 0, vertexCount, startIndex, primitiveCount);
 			else
 				pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_POINTLIST, 0, vertexCount, primitiveCount, indices, indexType, vertices, vertexSize);
 
@@ -1810,13 +1872,13 @@ void CD3D9Driver::renderArray(const void* vertices, u32 vertexSize, u32 vertexCo
 		break;
 	case scene::EPT_LINE_STRIP:
 		if (!vertices)
-			pID3DDevice->DrawIndexedPrimitive(D3DPT_LINESTRIP, 0, 0, vertexCount, 0, primitiveCount);
+			pID3DDevice->DrawIndexedPrimitive(D3DPT_LINESTRIP, 0, 0, vertexCount, startIndex, primitiveCount);
 		else
 			pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_LINESTRIP, 0, vertexCount, primitiveCount, indices, indexType, vertices, vertexSize);
 		break;
 	case scene::EPT_LINE_LOOP:
 		if (!vertices)
-			pID3DDevice->DrawIndexedPrimitive(D3DPT_LINELIST, 0, 0, vertexCount, 0, primitiveCount);
+			pID3DDevice->DrawIndexedPrimitive(D3DPT_LINELIST, 0, 0, vertexCount, startIndex, primitiveCount);
 		else
 		{
 			pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_LINESTRIP, 0, vertexCount, primitiveCount - 1, indices, indexType, vertices, vertexSize);
@@ -1828,25 +1890,25 @@ void CD3D9Driver::renderArray(const void* vertices, u32 vertexSize, u32 vertexCo
 		break;
 	case scene::EPT_LINES:
 		if (!vertices)
-			pID3DDevice->DrawIndexedPrimitive(D3DPT_LINELIST, 0, 0, vertexCount, 0, primitiveCount);
+			pID3DDevice->DrawIndexedPrimitive(D3DPT_LINELIST, 0, 0, vertexCount, startIndex, primitiveCount);
 		else
 			pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_LINELIST, 0, vertexCount, primitiveCount, indices, indexType, vertices, vertexSize);
 		break;
 	case scene::EPT_TRIANGLE_STRIP:
 		if (!vertices)
-			pID3DDevice->DrawIndexedPrimitive(D3DPT_TRIANGLESTRIP, 0, 0, vertexCount, 0, primitiveCount);
+			pID3DDevice->DrawIndexedPrimitive(D3DPT_TRIANGLESTRIP, 0, 0, vertexCount, startIndex, primitiveCount);
 		else
 			pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLESTRIP, 0, vertexCount, primitiveCount, indices, indexType, vertices, vertexSize);
 		break;
 	case scene::EPT_TRIANGLE_FAN:
 		if (!vertices)
-			pID3DDevice->DrawIndexedPrimitive(D3DPT_TRIANGLEFAN, 0, 0, vertexCount, 0, primitiveCount);
+			pID3DDevice->DrawIndexedPrimitive(D3DPT_TRIANGLEFAN, 0, 0, vertexCount, startIndex, primitiveCount);
 		else
 			pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLEFAN, 0, vertexCount, primitiveCount, indices, indexType, vertices, vertexSize);
 		break;
 	case scene::EPT_TRIANGLES:
 		if (!vertices)
-			pID3DDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, vertexCount, 0, primitiveCount);
+			pID3DDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, vertexCount, startIndex, primitiveCount);
 		else
 			pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST, 0, vertexCount, primitiveCount, indices, indexType, vertices, vertexSize);
 		break;
@@ -1920,7 +1982,7 @@ void CD3D9Driver::draw2D3DVertexPrimitiveList(const void* pVertices, u32 pVertex
 			setRenderStates2DMode(Material.MaterialType==EMT_TRANSPARENT_VERTEX_ALPHA, (Material.getTexture(0) != 0), Material.MaterialType==EMT_TRANSPARENT_ALPHA_CHANNEL);
 	}
 
-	renderArray(pVertices, pVertexSize, pVertexCount, pIndices, pIndexType, primitiveCount, pType);
+	renderArray(pVertices, pVertexSize, pVertexCount, pIndices, pIndexType, 0, primitiveCount, pType);
 }
 
 
@@ -2006,139 +2068,10 @@ void CD3D9Driver::draw2DImageBatch(const video::ITexture* texture,
 	if (!texture)
 		return;
 
-	if (!setActiveTexture(0, const_cast<video::ITexture*>(texture)))
-		return;
-
-	setRenderStates2DMode(color.getAlpha()<255, true, useAlphaChannelOfTexture);
-
 	const irr::u32 drawCount = core::min_<u32>(positions.size(), sourceRects.size());
 
-	core::array<S3DVertex> vtx(drawCount * 4);
-	core::array<u16> indices(drawCount * 6);
-
-	for(u32 i = 0;i < drawCount;i++)
-	{
-		core::position2d<s32> targetPos = positions[i];
-		core::position2d<s32> sourcePos = sourceRects[i].UpperLeftCorner;
-		// This needs to be signed as it may go negative.
-		core::dimension2d<s32> sourceSize(sourceRects[i].getSize());
-
-		if (clipRect)
-		{
-			if (targetPos.X < clipRect->UpperLeftCorner.X)
-			{
-				sourceSize.Width += targetPos.X - clipRect->UpperLeftCorner.X;
-				if (sourceSize.Width <= 0)
-					continue;
-
-				sourcePos.X -= targetPos.X - clipRect->UpperLeftCorner.X;
-				targetPos.X = clipRect->UpperLeftCorner.X;
-			}
-
-			if (targetPos.X + (s32)sourceSize.Width > clipRect->LowerRightCorner.X)
-			{
-				sourceSize.Width -= (targetPos.X + sourceSize.Width) - clipRect->LowerRightCorner.X;
-				if (sourceSize.Width <= 0)
-					continue;
-			}
-
-			if (targetPos.Y < clipRect->UpperLeftCorner.Y)
-			{
-				sourceSize.Height += targetPos.Y - clipRect->UpperLeftCorner.Y;
-				if (sourceSize.Height <= 0)
-					continue;
-
-				sourcePos.Y -= targetPos.Y - clipRect->UpperLeftCorner.Y;
-				targetPos.Y = clipRect->UpperLeftCorner.Y;
-			}
-
-			if (targetPos.Y + (s32)sourceSize.Height > clipRect->LowerRightCorner.Y)
-			{
-				sourceSize.Height -= (targetPos.Y + sourceSize.Height) - clipRect->LowerRightCorner.Y;
-				if (sourceSize.Height <= 0)
-					continue;
-			}
-		}
-
-		// clip these coordinates
-
-		if (targetPos.X<0)
-		{
-			sourceSize.Width += targetPos.X;
-			if (sourceSize.Width <= 0)
-				continue;
-
-			sourcePos.X -= targetPos.X;
-			targetPos.X = 0;
-		}
-
-		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
-
-		if (targetPos.X + sourceSize.Width > (s32)renderTargetSize.Width)
-		{
-			sourceSize.Width -= (targetPos.X + sourceSize.Width) - renderTargetSize.Width;
-			if (sourceSize.Width <= 0)
-				continue;
-		}
-
-		if (targetPos.Y<0)
-		{
-			sourceSize.Height += targetPos.Y;
-			if (sourceSize.Height <= 0)
-				continue;
-
-			sourcePos.Y -= targetPos.Y;
-			targetPos.Y = 0;
-		}
-
-		if (targetPos.Y + sourceSize.Height > (s32)renderTargetSize.Height)
-		{
-			sourceSize.Height -= (targetPos.Y + sourceSize.Height) - renderTargetSize.Height;
-			if (sourceSize.Height <= 0)
-				continue;
-		}
-
-		// ok, we've clipped everything.
-		// now draw it.
-
-		core::rect<f32> tcoords;
-		tcoords.UpperLeftCorner.X = (((f32)sourcePos.X)) / texture->getOriginalSize().Width ;
-		tcoords.UpperLeftCorner.Y = (((f32)sourcePos.Y)) / texture->getOriginalSize().Height;
-		tcoords.LowerRightCorner.X = tcoords.UpperLeftCorner.X + ((f32)(sourceSize.Width) / texture->getOriginalSize().Width);
-		tcoords.LowerRightCorner.Y = tcoords.UpperLeftCorner.Y + ((f32)(sourceSize.Height) / texture->getOriginalSize().Height);
-
-		const core::rect<s32> poss(targetPos, sourceSize);
-
-		vtx.push_back(S3DVertex((f32)poss.UpperLeftCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f,
-				0.0f, 0.0f, 0.0f, color,
-				tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y));
-		vtx.push_back(S3DVertex((f32)poss.LowerRightCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f,
-				0.0f, 0.0f, 0.0f, color,
-				tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y));
-		vtx.push_back(S3DVertex((f32)poss.LowerRightCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f,
-				0.0f, 0.0f, 0.0f, color,
-				tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y));
-		vtx.push_back(S3DVertex((f32)poss.UpperLeftCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f,
-				0.0f, 0.0f, 0.0f, color,
-				tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y));
-
-		const u32 curPos = vtx.size()-4;
-		indices.push_back(0+curPos);
-		indices.push_back(1+curPos);
-		indices.push_back(2+curPos);
-
-		indices.push_back(0+curPos);
-		indices.push_back(2+curPos);
-		indices.push_back(3+curPos);
-	}
-
-	if (vtx.size())
-	{
-		setVertexDescriptor(VertexDescriptor[0]);
-
-		pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST, 0, vtx.size(), indices.size() / 3, indices.pointer(),
-			D3DFMT_INDEX16,vtx.pointer(), sizeof(S3DVertex));
-	}
+	for (u32 i=0; i<drawCount; ++i)
+		add2DImageQuad(texture, positions[i], sourceRects[i], clipRect, color, useAlphaChannelOfTexture);
 }
 
 
@@ -2153,125 +2086,7 @@ void CD3D9Driver::draw2DImage(const video::ITexture* texture,
 	if (!texture)
 		return;
 
-	if (!sourceRect.isValid())
-		return;
-
-	if (!setActiveTexture(0, const_cast<video::ITexture*>(texture)))
-		return;
-
-	core::position2d<s32> targetPos = pos;
-	core::position2d<s32> sourcePos = sourceRect.UpperLeftCorner;
-	// This needs to be signed as it may go negative.
-	core::dimension2d<s32> sourceSize(sourceRect.getSize());
-
-	if (clipRect)
-	{
-		if (targetPos.X < clipRect->UpperLeftCorner.X)
-		{
-			sourceSize.Width += targetPos.X - clipRect->UpperLeftCorner.X;
-			if (sourceSize.Width <= 0)
-				return;
-
-			sourcePos.X -= targetPos.X - clipRect->UpperLeftCorner.X;
-			targetPos.X = clipRect->UpperLeftCorner.X;
-		}
-
-		if (targetPos.X + (s32)sourceSize.Width > clipRect->LowerRightCorner.X)
-		{
-			sourceSize.Width -= (targetPos.X + sourceSize.Width) - clipRect->LowerRightCorner.X;
-			if (sourceSize.Width <= 0)
-				return;
-		}
-
-		if (targetPos.Y < clipRect->UpperLeftCorner.Y)
-		{
-			sourceSize.Height += targetPos.Y - clipRect->UpperLeftCorner.Y;
-			if (sourceSize.Height <= 0)
-				return;
-
-			sourcePos.Y -= targetPos.Y - clipRect->UpperLeftCorner.Y;
-			targetPos.Y = clipRect->UpperLeftCorner.Y;
-		}
-
-		if (targetPos.Y + (s32)sourceSize.Height > clipRect->LowerRightCorner.Y)
-		{
-			sourceSize.Height -= (targetPos.Y + sourceSize.Height) - clipRect->LowerRightCorner.Y;
-			if (sourceSize.Height <= 0)
-				return;
-		}
-	}
-
-	// clip these coordinates
-
-	if (targetPos.X<0)
-	{
-		sourceSize.Width += targetPos.X;
-		if (sourceSize.Width <= 0)
-			return;
-
-		sourcePos.X -= targetPos.X;
-		targetPos.X = 0;
-	}
-
-	const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
-
-	if (targetPos.X + sourceSize.Width > (s32)renderTargetSize.Width)
-	{
-		sourceSize.Width -= (targetPos.X + sourceSize.Width) - renderTargetSize.Width;
-		if (sourceSize.Width <= 0)
-			return;
-	}
-
-	if (targetPos.Y<0)
-	{
-		sourceSize.Height += targetPos.Y;
-		if (sourceSize.Height <= 0)
-			return;
-
-		sourcePos.Y -= targetPos.Y;
-		targetPos.Y = 0;
-	}
-
-	if (targetPos.Y + sourceSize.Height > (s32)renderTargetSize.Height)
-	{
-		sourceSize.Height -= (targetPos.Y + sourceSize.Height) - renderTargetSize.Height;
-		if (sourceSize.Height <= 0)
-			return;
-	}
-
-	// ok, we've clipped everything.
-	// now draw it.
-
-	core::rect<f32> tcoords;
-	tcoords.UpperLeftCorner.X = (((f32)sourcePos.X)) / texture->getOriginalSize().Width ;
-	tcoords.UpperLeftCorner.Y = (((f32)sourcePos.Y)) / texture->getOriginalSize().Height;
-	tcoords.LowerRightCorner.X = tcoords.UpperLeftCorner.X + ((f32)(sourceSize.Width) / texture->getOriginalSize().Width);
-	tcoords.LowerRightCorner.Y = tcoords.UpperLeftCorner.Y + ((f32)(sourceSize.Height) / texture->getOriginalSize().Height);
-
-	const core::rect<s32> poss(targetPos, sourceSize);
-
-	setRenderStates2DMode(color.getAlpha()<255, true, useAlphaChannelOfTexture);
-
-	S3DVertex vtx[4];
-	vtx[0] = S3DVertex((f32)poss.UpperLeftCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f,
-			0.0f, 0.0f, 0.0f, color,
-			tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
-	vtx[1] = S3DVertex((f32)poss.LowerRightCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f,
-			0.0f, 0.0f, 0.0f, color,
-			tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
-	vtx[2] = S3DVertex((f32)poss.LowerRightCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f,
-			0.0f, 0.0f, 0.0f, color,
-			tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
-	vtx[3] = S3DVertex((f32)poss.UpperLeftCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f,
-			0.0f, 0.0f, 0.0f, color,
-			tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
-
-	s16 indices[6] = {0,1,2,0,2,3};
-
-	setVertexDescriptor(VertexDescriptor[0]);
-
-	pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST, 0, 4, 2, &indices[0],
-		D3DFMT_INDEX16,&vtx[0],	sizeof(S3DVertex));
+	add2DImageQuad(texture, pos, sourceRect, clipRect, color, useAlphaChannelOfTexture);
 }
 
 
@@ -2280,38 +2095,23 @@ void CD3D9Driver::draw2DRectangle(const core::rect<s32>& position,
 	SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 	const core::rect<s32>* clip)
 {
-	core::rect<s32> pos(position);
+	add2DRectangleQuad(position, colorLeftUp, colorRightUp, colorLeftDown, colorRightDown, clip);
+}
 
-	if (clip)
-		pos.clipAgainst(*clip);
 
-	if (!pos.isValid())
+//! draws quads of the 2d batch
+void CD3D9Driver::draw2DBatch(const video::ITexture* texture, bool alpha, bool alphaChannel,
+		const S3DVertex* vertices, u32 quadCount)
+{
+	if (!setActiveTexture(0, texture))
 		return;
 
-	S3DVertex vtx[4];
-	vtx[0] = S3DVertex((f32)pos.UpperLeftCorner.X, (f32)pos.UpperLeftCorner.Y, 0.0f,
-			0.0f, 0.0f, 0.0f, colorLeftUp, 0.0f, 0.0f);
-	vtx[1] = S3DVertex((f32)pos.LowerRightCorner.X, (f32)pos.UpperLeftCorner.Y, 0.0f,
-			0.0f, 0.0f, 0.0f, colorRightUp, 0.0f, 1.0f);
-	vtx[2] = S3DVertex((f32)pos.LowerRightCorner.X, (f32)pos.LowerRightCorner.Y, 0.0f,
-			0.0f, 0.0f, 0.0f, colorRightDown, 1.0f, 0.0f);
-	vtx[3] = S3DVertex((f32)pos.UpperLeftCorner.X, (f32)pos.LowerRightCorner.Y, 0.0f,
-			0.0f, 0.0f, 0.0f, colorLeftDown, 1.0f, 1.0f);
-
-	s16 indices[6] = {0,1,2,0,2,3};
-
-	setRenderStates2DMode(
-		colorLeftUp.getAlpha() < 255 ||
-		colorRightUp.getAlpha() < 255 ||
-		colorLeftDown.getAlpha() < 255 ||
-		colorRightDown.getAlpha() < 255, false, false);
-
-	setActiveTexture(0,0);
+	setRenderStates2DMode(alpha, texture != 0, alphaChannel);
 
 	setVertexDescriptor(VertexDescriptor[0]);
 
-	pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST, 0, 4, 2, &indices[0],
-		D3DFMT_INDEX16, &vtx[0], sizeof(S3DVertex));
+	pID3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST, 0, quadCount * 4, quadCount * 2, Batch2DIndices.const_pointer(),
+		D3DFMT_INDEX16, vertices, sizeof(S3DVertex));
 }
 
 
@@ -2403,6 +2203,8 @@ void CD3D9Driver::setVertexDescriptor(IVertexDescriptor* vertexDescriptor)
 //! sets the needed renderstates
 bool CD3D9Driver::setRenderStates3DMode()
 {
+	flush2DBatch();
+
 	if (!pID3DDevice)
 		return false;
 
@@ -2421,6 +2223,8 @@ bool CD3D9Driver::setRenderStates3DMode()
 
 	if (ResetRenderStates || LastMaterial != Material)
 	{
+		IRR_PROFILE(getProfiler().count(EPID_VD_STATE_CHANGES);)
+
 		// unset old material
 
 		if (CurrentRenderMode == ERM_3D &&
@@ -2964,6 +2768,8 @@ void CD3D9Driver::enableMaterial2D(bool enable)
 //! sets the needed renderstates
 void CD3D9Driver::setRenderStates2DMode(bool alpha, bool texture, bool alphaChannel)
 {
+	flush2DBatch();
+
 	if (!pID3DDevice)
 		return;
 
@@ -3020,7 +2826,9 @@ void CD3D9Driver::setRenderStates2DMode(bool alpha, bool texture, bool alphaChan
 	if (alpha || alphaChannel)
 	{
 		BridgeCalls->setBlend(true);
-		BridgeCalls->setBlendFunc(D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA);
+		// the override material may blend with its own factors
+		if (!OverrideMaterial2DEnabled || !IR(OverrideMaterial2D.BlendFactor))
+			BridgeCalls->setBlendFunc(D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA);
 	}
 	else
 		BridgeCalls->setBlend(false);
@@ -3654,6 +3462,8 @@ ITexture* CD3D9Driver::addRenderTargetTexture(const core::dimension2d<u32>& size
 //! Clears the ZBuffer.
 void CD3D9Driver::clearZBuffer()
 {
+	flush2DBatch();
+
 	HRESULT hr = pID3DDevice->Clear( 0, NULL, D3DCLEAR_ZBUFFER, 0, 1.0, 0);
 
 	if (FAILED(hr))
@@ -3664,6 +3474,8 @@ void CD3D9Driver::clearZBuffer()
 //! Returns an image created from the last rendered frame.
 IImage* CD3D9Driver::createScreenShot(video::ECOLOR_FORMAT format, video::E_RENDER_TARGET target)
 {
+	flush2DBatch();
+
 	if (target != video::ERT_FRAME_BUFFER)
 		return 0;
 
@@ -178,6 +178,9 @@ namespace video
 
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
 
+		//! Draws a range of the indices of a mesh buffer
+		virtual void drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount) _IRR_OVERRIDE_;
+
 		//! draws a vertex primitive list in 2d
 		virtual void draw2DVertexPrimitiveList(const void* vertices, u32 vertexCount,
 				const void* indexList, u32 primitiveCount,
@@ -394,6 +397,10 @@ namespace video
 		//! sets the needed renderstates
 		void setRenderStates2DMode(bool alpha, bool texture, bool alphaChannel);
 
+		//! draws quads of the 2d batch
+		virtual void draw2DBatch(const video::ITexture* texture, bool alpha, bool alphaChannel,
+			const S3DVertex* vertices, u32 quadCount) _IRR_OVERRIDE_;
+
 		//! sets the needed renderstates
 		void setRenderStatesStencilFillMode(bool alpha);
 
@@ -446,7 +453,9 @@ namespace video
 
 		void draw2D3DVertexPrimitiveList(const void* pVertices, u32 pVertexCount, u32 pVertexSize, const void* pIndices, D3DFORMAT pIndexType, u32 primitiveCount, scene::E_PRIMITIVE_TYPE pType, bool is3D);
 
-		void renderArray(const void* vertices, u32 vertexSize, u32 vertexCount, const void* indices, D3DFORMAT indexType, u32 primitiveCount, scene::E_PRIMITIVE_TYPE primitiveType);
+		void renderMeshBuffer(const scene::IMeshBuffer* mb, u32 firstIndex, u32 primitiveCount);
+
+		void renderArray(const void* vertices, u32 vertexSize, u32 vertexCount, const void* indices, D3DFORMAT indexType, u32 startIndex, u32 primitiveCount, scene::E_PRIMITIVE_TYPE primitiveType);
 
 		D3DTEXTUREADDRESS getTextureWrapMode(const u8 clamp);
 
@@ -334,6 +334,11 @@ void CGUIButton::drawSprite(EGUI_BUTTON_STATE state, u32 startTime, const core::
 
 	if (ButtonSprites[stateIdx].Index != -1)
 	{
+		// animated sprites have to be drawn again in the next frame
+		const core::array<SGUISprite>& sprites = SpriteBank->getSprites();
+		if ((u32)ButtonSprites[stateIdx].Index < sprites.size() && sprites[ButtonSprites[stateIdx].Index].Frames.size() > 1)
+			invalidate();
+
 		if ( ButtonSprites[stateIdx].Scale )
 		{
 			const video::SColor colors[] = {ButtonSprites[stateIdx].Color,ButtonSprites[stateIdx].Color,ButtonSprites[stateIdx].Color,ButtonSprites[stateIdx].Color};
@@ -462,6 +467,7 @@ void CGUIButton::setImage(EGUI_BUTTON_IMAGE_STATE state, video::ITexture* image,
 
 	ButtonImages[stateIdx].Texture = image;
 	ButtonImages[stateIdx].SourceRect = sourceRect;
+	invalidate();
 }
 
 //! Sets if the button should behave like a push button. Which means it
@@ -489,6 +495,8 @@ void CGUIButton::setPressed(bool pressed)
 		ClickTime = os::Timer::getTime();
 		Pressed = pressed;
 	}
+
+	invalidate();
 }
 
 
@@ -191,6 +191,7 @@ void CGUICheckBox::draw()
 void CGUICheckBox::setChecked(bool checked)
 {
 	Checked = checked;
+	invalidate();
 }
 
 
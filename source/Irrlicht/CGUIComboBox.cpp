@@ -148,6 +148,7 @@ void CGUIComboBox::removeItem(u32 idx)
 		setSelected(-1);
 
 	Items.erase(idx);
+	invalidate();
 }
 
 
@@ -166,6 +167,7 @@ u32 CGUIComboBox::addItem(const wchar_t* text, u32 data)
 	if (Selected == -1)
 		setSelected(0);
 
+	invalidate();
 	return Items.size() - 1;
 }
 
@@ -196,6 +198,7 @@ void CGUIComboBox::setSelected(s32 idx)
 		SelectedText->setText(L"");
 	else
 		SelectedText->setText(Items[Selected].Name.c_str());
+	invalidate();
 }
 
 
@@ -958,6 +958,10 @@ void CGUIEditBox::draw()
 			charcursorpos = font->getDimension(s.c_str()).Width +
 				font->getKerningWidth(CursorChar.c_str(), CursorPos-startPos > 0 ? &((*txtLine)[CursorPos-startPos-1]) : 0);
 
+			// the blinking cursor has to be drawn again in the next frame
+			if (focus && CursorBlinkTime)
+				invalidate();
+
 			if (focus && (CursorBlinkTime == 0 || (os::Timer::getTime() - BlinkStartTime) % (2*CursorBlinkTime) < CursorBlinkTime))
 			{
 				setTextRect(cursorLine);
@@ -999,6 +1003,7 @@ void CGUIEditBox::setText(const wchar_t* text)
 		CursorPos = Text.size();
 	HScrollPos = 0;
 	breakText();
+	invalidate();
 }
 
 
@@ -55,11 +55,38 @@ const wchar_t IRR_XML_FORMAT_GUI_ELEMENT_ATTR_TYPE[]	= L"type";
 
 const io::path CGUIEnvironment::DefaultFontName = "#DefaultFont";
 
+namespace
+{
+	// adds the area of the element and of all children which are not clipped by it
+	void addDrawnArea(const IGUIElement* element, core::rect<s32>& area)
+	{
+		if (!element->isVisible())
+			return;
+
+		const core::rect<s32> clip = element->getAbsoluteClippingRect();
+		if (clip.getWidth() > 0 && clip.getHeight() > 0)
+		{
+			if (area.getWidth() > 0 && area.getHeight() > 0)
+			{
+				area.addInternalPoint(clip.UpperLeftCorner);
+				area.addInternalPoint(clip.LowerRightCorner);
+			}
+			else
+				area = clip;
+		}
+
+		core::list<IGUIElement*>::ConstIterator it = element->getChildren().begin();
+		for (; it != element->getChildren().end(); ++it)
+			addDrawnArea(*it, area);
+	}
+}
+
 //! constructor
 CGUIEnvironment::CGUIEnvironment(io::IFileSystem* fs, video::IVideoDriver* driver, IOSOperator* op)
 : IGUIElement(EGUIET_ROOT, 0, 0, 0, core::rect<s32>(core::position2d<s32>(0,0), driver ? core::dimension2d<s32>(driver->getScreenSize()) : core::dimension2d<s32>(0,0))),
 	Driver(driver), Hovered(0), HoveredNoSubelement(0), Focus(0), LastHoveredMousePos(0,0), CurrentSkin(0),
-	FileSystem(fs), UserReceiver(0), Operator(op), FocusFlags(EFF_SET_ON_LMOUSE_DOWN|EFF_SET_ON_TAB)
+	FileSystem(fs), UserReceiver(0), Operator(op), FocusFlags(EFF_SET_ON_LMOUSE_DOWN|EFF_SET_ON_TAB),
+	RetainedChangedID(0), RetainedSkinChangedID(0), RetainedTextureCount(0), RetainedMode(false)
 {
 	if (Driver)
 		Driver->grab();
@@ -101,6 +128,8 @@ CGUIEnvironment::CGUIEnvironment(io::IFileSystem* fs, video::IVideoDriver* drive
 //! destructor
 CGUIEnvironment::~CGUIEnvironment()
 {
+	clearRetained();
+
 	if ( HoveredNoSubelement && HoveredNoSubelement != this )
 	{
 		HoveredNoSubelement->drop();
@@ -211,11 +240,178 @@ void CGUIEnvironment::drawAll()
 	if (ToolTip.Element)
 		bringToFront(ToolTip.Element);
 
-	draw();
+	if (RetainedMode && Driver && Driver->queryFeature(video::EVDF_RENDER_TO_TARGET) &&
+		Driver->queryFeature(video::EVDF_BLEND_SEPARATE))
+		drawRetained();
+	else
+	{
+		clearRetained();
+		draw();
+	}
 	OnPostRender ( os::Timer::getTime () );
 }
 
 
+//! draws the top level elements from their cached textures
+void CGUIEnvironment::drawRetained()
+{
+	// invalidating the root, e.g. by a new skin, or changing the skin draws all elements again
+	const u32 skinChangedID = CurrentSkin ? CurrentSkin->getChangedID() : 0;
+	const bool drawAll = RetainedChangedID != ChangedID || RetainedSkinChangedID != skinChangedID;
+	RetainedChangedID = ChangedID;
+	RetainedSkinChangedID = skinChangedID;
+
+	// forget the elements which were removed
+	for (u32 i=0; i<RetainedElements.size();)
+	{
+		if (RetainedElements[i].Element->getParent() != this)
+		{
+			if (RetainedElements[i].Texture)
+				Driver->removeTexture(RetainedElements[i].Texture);
+			RetainedElements[i].Element->drop();
+			RetainedElements.erase(i);
+		}
+		else
+			++i;
+	}
+
+	// the textures hold premultiplied colors: the color is blended into them
+	// as usual, but the alpha is added up, then they are drawn with ONE,
+	// ONE_MINUS_SRC_ALPHA. This looks like drawing the elements directly.
+	const video::SMaterial& material2D = Driver->getMaterial2D();
+	const video::E_BLEND_OPERATION blendOperation = material2D.BlendOperation;
+	const f32 blendFactor = material2D.BlendFactor;
+	const bool material2DEnabled = Driver->isMaterial2DEnabled();
+
+	core::list<IGUIElement*>::Iterator it = Children.begin();
+	for (; it != Children.end(); ++it)
+	{
+		IGUIElement* element = *it;
+
+		core::rect<s32> area(0,0,0,0);
+		addDrawnArea(element, area);
+		if (area.getWidth() <= 0 || area.getHeight() <= 0)
+			continue;
+
+		u32 i=0;
+		while (i<RetainedElements.size() && RetainedElements[i].Element != element)
+			++i;
+
+		if (i == RetainedElements.size())
+		{
+			SRetainedElement retained;
+			retained.Element = element;
+			retained.Texture = 0;
+			retained.ChangedID = 0;
+			element->grab();
+			RetainedElements.push_back(retained);
+		}
+
+		if (drawAll || !RetainedElements[i].Texture || RetainedElements[i].Rect != area ||
+			RetainedElements[i].ChangedID != element->getChangedID())
+		{
+			setRetainedBlending(video::EBO_ADD, video::pack_textureBlendFuncSeparate(
+				video::EBF_SRC_ALPHA, video::EBF_ONE_MINUS_SRC_ALPHA,
+				video::EBF_ONE, video::EBF_ONE_MINUS_SRC_ALPHA), true);
+			drawRetainedElement(i, area);
+		}
+
+		const SRetainedElement& retained = RetainedElements[i];
+		if (retained.Texture)
+		{
+			setRetainedBlending(video::EBO_ADD, video::pack_textureBlendFunc(
+				video::EBF_ONE, video::EBF_ONE_MINUS_SRC_ALPHA), true);
+			Driver->draw2DImage(retained.Texture, area.UpperLeftCorner,
+				core::rect<s32>(core::position2d<s32>(0,0), area.getSize()), 0,
+				video::SColor(255,255,255,255), true);
+		}
+		else
+		{
+			setRetainedBlending(blendOperation, blendFactor, material2DEnabled);
+			element->draw();
+		}
+	}
+
+	setRetainedBlending(blendOperation, blendFactor, material2DEnabled);
+}
+
+
+//! draws a top level element into its cached texture
+void CGUIEnvironment::drawRetainedElement(u32 index, const core::rect<s32>& area)
+{
+	SRetainedElement& retained = RetainedElements[index];
+
+	if (retained.Texture && retained.Rect.getSize() != area.getSize())
+	{
+		Driver->removeTexture(retained.Texture);
+		retained.Texture = 0;
+	}
+
+	if (!retained.Texture)
+	{
+		core::stringc name("GUIRetainedElement");
+		name += RetainedTextureCount++;
+		retained.Texture = Driver->addRenderTargetTexture(
+			core::dimension2d<u32>(area.getWidth(), area.getHeight()), name, video::ECF_A8R8G8B8);
+	}
+
+	const core::rect<s32> viewPort = Driver->getViewPort();
+	if (!retained.Texture || !Driver->setRenderTarget(retained.Texture, true, true, video::SColor(0,0,0,0)))
+	{
+		if (retained.Texture)
+			Driver->removeTexture(retained.Texture);
+		retained.Texture = 0;
+		return;
+	}
+
+	retained.Rect = area;
+
+	// move the element to the upper left corner of the texture
+	const core::rect<s32> absoluteRect = AbsoluteRect;
+	const core::rect<s32> absoluteClippingRect = AbsoluteClippingRect;
+	AbsoluteRect -= area.UpperLeftCorner;
+	AbsoluteClippingRect -= area.UpperLeftCorner;
+	retained.Element->updateAbsolutePosition();
+
+	// elements which change while they are drawn, like animations, are drawn again next time
+	retained.ChangedID = retained.Element->getChangedID();
+	retained.Element->draw();
+
+	AbsoluteRect = absoluteRect;
+	AbsoluteClippingRect = absoluteClippingRect;
+	retained.Element->updateAbsolutePosition();
+
+	Driver->setRenderTarget(0, false, false);
+	Driver->setViewPort(viewPort);
+}
+
+
+//! sets the blending of the 2d override material for the following 2d drawing
+void CGUIEnvironment::setRetainedBlending(video::E_BLEND_OPERATION operation, f32 factor, bool enable)
+{
+	// this draws the pending 2d batch with the previous blending
+	Driver->enableMaterial2D(enable);
+
+	video::SMaterial& material2D = Driver->getMaterial2D();
+	material2D.BlendOperation = operation;
+	material2D.BlendFactor = factor;
+}
+
+
+//! drops the cached textures of all top level elements
+void CGUIEnvironment::clearRetained()
+{
+	for (u32 i=0; i<RetainedElements.size(); ++i)
+	{
+		if (RetainedElements[i].Texture)
+			Driver->removeTexture(RetainedElements[i].Texture);
+		RetainedElements[i].Element->drop();
+	}
+
+	RetainedElements.clear();
+}
+
+
 //! sets the focus to an element
 bool CGUIEnvironment::setFocus(IGUIElement* element)
 {
@@ -283,7 +479,13 @@ bool CGUIEnvironment::setFocus(IGUIElement* element)
 		currentFocus->drop();
 
 	if (Focus)
+	{
+		Focus->invalidate();
 		Focus->drop();
+	}
+
+	if (element)
+		element->invalidate();
 
 	// element is the new focus so it doesn't have to be dropped
 	Focus = element;
@@ -323,6 +525,7 @@ bool CGUIEnvironment::removeFocus(IGUIElement* element)
 	}
 	if (Focus)
 	{
+		Focus->invalidate();
 		Focus->drop();
 		Focus = 0;
 	}
@@ -512,6 +715,11 @@ void CGUIEnvironment::updateHoveredElement(core::position2d<s32> mousePos)
 
 	if (Hovered != lastHovered)
 	{
+		if (lastHovered && lastHovered != this)
+			lastHovered->invalidate();
+		if (Hovered && Hovered != this)
+			Hovered->invalidate();
+
 		SEvent event;
 		event.EventType = EET_GUI_EVENT;
 
@@ -601,22 +809,33 @@ bool CGUIEnvironment::postEventFromUser(const SEvent& event)
 			}
 		}
 
-		// sending input to focus
+		// sending input to focus, elements which absorb the input have changed
 		if (Focus && Focus->OnEvent(event))
+		{
+			if (Focus)
+				Focus->invalidate();
 			return true;
+		}
 
 		// focus could have died in last call
 		if (!Focus && Hovered)
 		{
 			_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
-			return Hovered->OnEvent(event);
+			const bool absorbed = Hovered->OnEvent(event);
+			if (absorbed && Hovered && Hovered != this)
+				Hovered->invalidate();
+			return absorbed;
 		}
 
 		break;
 	case EET_KEY_INPUT_EVENT:
 		{
 			if (Focus && Focus->OnEvent(event))
+			{
+				if (Focus)
+					Focus->invalidate();
 				return true;
+			}
 
 			// For keys we handle the event before changing focus to give elements the chance for catching the TAB
 			// Send focus changing event
@@ -663,6 +882,8 @@ void CGUIEnvironment::setSkin(IGUISkin* skin)
 
 	if (CurrentSkin)
 		CurrentSkin->grab();
+
+	invalidate();
 }
 
 
@@ -1690,6 +1911,20 @@ u32 CGUIEnvironment::getFocusBehavior() const
 	return FocusFlags;
 }
 
+//! Enables or disables retained mode.
+void CGUIEnvironment::setRetainedMode(bool retained)
+{
+	RetainedMode = retained;
+	if (!RetainedMode)
+		clearRetained();
+}
+
+//! Returns whether top level elements are cached in retained mode.
+bool CGUIEnvironment::getRetainedMode() const
+{
+	return RetainedMode;
+}
+
 //! creates an GUI Environment
 IGUIEnvironment* createGUIEnvironment(io::IFileSystem* fs,
 					video::IVideoDriver* Driver,
@@ -13,6 +13,7 @@
 #include "irrArray.h"
 #include "IFileSystem.h"
 #include "IOSOperator.h"
+#include "SMaterial.h"
 
 namespace irr
 {
@@ -272,10 +273,28 @@ public:
 	//! Get the way the gui does handle focus changes
 	virtual u32 getFocusBehavior() const _IRR_OVERRIDE_;
 
+	//! Enables or disables retained mode.
+	virtual void setRetainedMode(bool retained) _IRR_OVERRIDE_;
+
+	//! Returns whether top level elements are cached in retained mode.
+	virtual bool getRetainedMode() const _IRR_OVERRIDE_;
+
 private:
 
 	void updateHoveredElement(core::position2d<s32> mousePos);
 
+	//! draws the top level elements from their cached textures
+	void drawRetained();
+
+	//! draws a top level element into its cached texture
+	void drawRetainedElement(u32 index, const core::rect<s32>& area);
+
+	//! sets the blending of the 2d override material for the following 2d drawing
+	void setRetainedBlending(video::E_BLEND_OPERATION operation, f32 factor, bool enable);
+
+	//! drops the cached textures of all top level elements
+	void clearRetained();
+
 	void loadBuiltInFont();
 
 	struct SFont
@@ -325,6 +344,22 @@ private:
 	IEventReceiver* UserReceiver;
 	IOSOperator* Operator;
 	u32 FocusFlags;
+
+	//! cached drawing of a top level element
+	struct SRetainedElement
+	{
+		IGUIElement* Element;
+		video::ITexture* Texture;
+		core::rect<s32> Rect;
+		u32 ChangedID;
+	};
+
+	core::array<SRetainedElement> RetainedElements;
+	u32 RetainedChangedID;
+	u32 RetainedSkinChangedID;
+	u32 RetainedTextureCount;
+	bool RetainedMode;
+
 	static const io::path DefaultFontName;
 };
 
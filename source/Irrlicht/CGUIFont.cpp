@@ -18,9 +18,14 @@ namespace irr
 namespace gui
 {
 
+// number of laid out texts which are kept
+const u32 GUI_FONT_GLYPH_RUN_CACHE_SIZE = 32;
+// longer texts, e.g. of large edit boxes, are laid out each time
+const u32 GUI_FONT_GLYPH_RUN_MAX_LENGTH = 1024;
+
 //! constructor
 CGUIFont::CGUIFont(IGUIEnvironment *env, const io::path& filename)
-: Driver(0), SpriteBank(0), Environment(env), WrongCharacter(0),
+: GlyphRunUseCounter(0), Driver(0), SpriteBank(0), Environment(env), WrongCharacter(0),
 	MaxHeight(0), GlobalKerningWidth(0), GlobalKerningHeight(0)
 {
 	#ifdef _DEBUG
@@ -195,6 +200,7 @@ bool CGUIFont::load(io::IXMLReader* xml, const io::path& directory)
 	WrongCharacter = getAreaFromCharacter(L' ');
 
 	setMaxHeight();
+	updateGlyphTable();
 
 	return true;
 }
@@ -303,6 +309,7 @@ bool CGUIFont::loadTexture(video::IImage* image, const io::path& name)
 	image->drop();
 
 	setMaxHeight();
+	updateGlyphTable();
 
 	return ret;
 }
@@ -382,6 +389,7 @@ void CGUIFont::readPositions(video::IImage* image, s32& lowerRightPositions)
 void CGUIFont::setKerningWidth(s32 kerning)
 {
 	GlobalKerningWidth = kerning;
+	GlyphRuns.clear();
 }
 
 
@@ -427,6 +435,9 @@ u32 CGUIFont::getSpriteNoFromChar(const wchar_t *c) const
 
 s32 CGUIFont::getAreaFromCharacter(const wchar_t c) const
 {
+	if ((u32)c < GlyphTable.size())
+		return GlyphTable[c].area;
+
 	core::map<wchar_t, s32>::Node* n = CharacterMap.find(c);
 	if (n)
 		return n->getValue();
@@ -434,9 +445,51 @@ s32 CGUIFont::getAreaFromCharacter(const wchar_t c) const
 		return WrongCharacter;
 }
 
+
+bool CGUIFont::isVisible(const wchar_t c) const
+{
+	if ((u32)c < GlyphTable.size())
+		return GlyphTable[c].visible;
+
+	return Invisible.findFirst(c) < 0;
+}
+
+
+void CGUIFont::updateGlyphTable()
+{
+	GlyphRuns.clear();
+
+	// covers all mapped and invisible characters of the basic multilingual plane
+	u32 size = 0;
+	for (core::map<wchar_t, s32>::Iterator it = CharacterMap.getIterator(); !it.atEnd(); it++)
+	{
+		if ((u32)it->getKey() < 0x10000 && (u32)it->getKey() >= size)
+			size = (u32)it->getKey() + 1;
+	}
+	for (u32 i=0; i<Invisible.size(); ++i)
+	{
+		if ((u32)Invisible[i] < 0x10000 && (u32)Invisible[i] >= size)
+			size = (u32)Invisible[i] + 1;
+	}
+
+	GlyphTable.set_used(0);
+	GlyphTable.reallocate(size);
+
+	for (u32 i=0; i<size; ++i)
+	{
+		SGlyph glyph;
+		core::map<wchar_t, s32>::Node* n = CharacterMap.find((wchar_t)i);
+		glyph.area = n ? n->getValue() : WrongCharacter;
+		glyph.visible = Invisible.findFirst((wchar_t)i) < 0;
+		GlyphTable.push_back(glyph);
+	}
+}
+
+
 void CGUIFont::setInvisibleCharacters( const wchar_t *s )
 {
 	Invisible = s;
+	updateGlyphTable();
 }
 
 
@@ -490,28 +543,87 @@ void CGUIFont::draw(const core::stringw& text, const core::rect<s32>& position,
 	if (!Driver || !SpriteBank)
 		return;
 
-	core::dimension2d<s32> textDimension;	// NOTE: don't make this u32 or the >> later on can fail when the dimension width is < position width
-	core::position2d<s32> offset = position.UpperLeftCorner;
+	const SGlyphRun& run = getGlyphRun(text);
 
-	if (hcenter || vcenter || clip)
-		textDimension = getDimension(text.c_str());
+	// NOTE: the dimension is signed or the >> can fail when the dimension width is < position width
+	core::position2d<s32> offset = position.UpperLeftCorner;
 
+	// all lines are moved by the same amount
 	if (hcenter)
-		offset.X += (position.getWidth() - textDimension.Width) >> 1;
+		offset.X += (position.getWidth() - run.Dimension.Width) >> 1;
 
 	if (vcenter)
-		offset.Y += (position.getHeight() - textDimension.Height) >> 1;
+		offset.Y += (position.getHeight() - run.Dimension.Height) >> 1;
 
 	if (clip)
 	{
-		core::rect<s32> clippedRect(offset, textDimension);
+		core::rect<s32> clippedRect(offset, run.Dimension);
 		clippedRect.clipAgainst(*clip);
 		if (!clippedRect.isValid())
 			return;
 	}
 
-	core::array<u32> indices(text.size());
-	core::array<core::position2di> offsets(text.size());
+	DrawOffsets.set_used(run.Offsets.size());
+	for (u32 i=0; i<run.Offsets.size(); ++i)
+		DrawOffsets[i] = run.Offsets[i] + offset;
+
+	SpriteBank->draw2DSpriteBatch(run.Indices, DrawOffsets, clip, color);
+}
+
+
+//! returns the cached layout of a text, lays it out if needed
+const CGUIFont::SGlyphRun& CGUIFont::getGlyphRun(const core::stringw& text)
+{
+	u32 hash = 2166136261u;
+	for (u32 i=0; i<text.size(); ++i)
+		hash = (hash ^ (u32)text[i]) * 16777619u;
+
+	u32 lru = 0;
+	for (u32 i=0; i<GlyphRuns.size(); ++i)
+	{
+		SGlyphRun& run = GlyphRuns[i];
+		if (run.Hash == hash && run.Text == text)
+		{
+			run.LastUse = ++GlyphRunUseCounter;
+			return run;
+		}
+
+		if (run.LastUse < GlyphRuns[lru].LastUse)
+			lru = i;
+	}
+
+	SGlyphRun* run = &LongGlyphRun;
+	if (text.size() <= GUI_FONT_GLYPH_RUN_MAX_LENGTH)
+	{
+		if (GlyphRuns.size() < GUI_FONT_GLYPH_RUN_CACHE_SIZE)
+		{
+			GlyphRuns.push_back(SGlyphRun());
+			lru = GlyphRuns.size() - 1;
+		}
+		run = &GlyphRuns[lru];
+	}
+
+	run->Text = text;
+	run->Hash = hash;
+	run->LastUse = ++GlyphRunUseCounter;
+	layoutGlyphRun(*run);
+
+	return *run;
+}
+
+
+//! places the sprites of a text, starting at 0,0
+void CGUIFont::layoutGlyphRun(SGlyphRun& run) const
+{
+	const core::stringw& text = run.Text;
+
+	run.Indices.set_used(0);
+	run.Offsets.set_used(0);
+	run.Indices.reallocate(text.size());
+	run.Offsets.reallocate(text.size());
+
+	core::position2d<s32> offset(0, 0);
+	s32 width = 0;
 
 	for(u32 i = 0;i < text.size();i++)
 	{
@@ -531,29 +643,30 @@ void CGUIFont::draw(const core::stringw& text, const core::rect<s32>& position,
 
 		if (lineBreak)
 		{
+			if (width < offset.X)
+				width = offset.X;
 			offset.Y += MaxHeight;
-			offset.X = position.UpperLeftCorner.X;
-
-			if ( hcenter )
-			{
-				offset.X += (position.getWidth() - textDimension.Width) >> 1;
-			}
+			offset.X = 0;
 			continue;
 		}
 
-		SFontArea& area = Areas[getAreaFromCharacter(c)];
+		const SFontArea& area = Areas[getAreaFromCharacter(c)];
 
 		offset.X += area.underhang;
-		if ( Invisible.findFirst ( c ) < 0 )
+		if ( isVisible ( c ) )
 		{
-			indices.push_back(area.spriteno);
-			offsets.push_back(offset);
+			run.Indices.push_back(area.spriteno);
+			run.Offsets.push_back(offset);
 		}
 
 		offset.X += area.width + area.overhang + GlobalKerningWidth;
 	}
 
-	SpriteBank->draw2DSpriteBatch(indices, offsets, clip, color);
+	if (width < offset.X)
+		width = offset.X;
+
+	run.Dimension.Width = width;
+	run.Dimension.Height = offset.Y + MaxHeight;
 }
 
 
@@ -90,16 +90,51 @@ private:
 		u32				spriteno;
 	};
 
+	//! area and visibility of a character in the lookup table
+	struct SGlyph
+	{
+		s32				area;
+		bool				visible;
+	};
+
+	//! sprites and positions of a laid out text
+	struct SGlyphRun
+	{
+		core::stringw			Text;
+		u32				Hash;
+		u32				LastUse;
+		core::array<u32>		Indices;
+		// relative to the upper left corner of the text
+		core::array<core::position2di>	Offsets;
+		core::dimension2d<s32>		Dimension;
+	};
+
 	//! load & prepare font from ITexture
 	bool loadTexture(video::IImage * image, const io::path& name);
 
 	void readPositions(video::IImage* texture, s32& lowerRightPositions);
 
 	s32 getAreaFromCharacter (const wchar_t c) const;
+	bool isVisible(const wchar_t c) const;
 	void setMaxHeight();
 
+	//! fills the lookup table of the characters and clears the glyph runs
+	void updateGlyphTable();
+
+	//! returns the cached layout of a text, lays it out if needed
+	const SGlyphRun& getGlyphRun(const core::stringw& text);
+	void layoutGlyphRun(SGlyphRun& run) const;
+
 	core::array<SFontArea>		Areas;
 	core::map<wchar_t, s32>		CharacterMap;
+	// dense lookup of CharacterMap and Invisible for the lower characters
+	core::array<SGlyph>		GlyphTable;
+	// least recently used texts are replaced
+	core::array<SGlyphRun>		GlyphRuns;
+	u32				GlyphRunUseCounter;
+	// for texts which are too long to be cached
+	SGlyphRun			LongGlyphRun;
+	core::array<core::position2di>	DrawOffsets;
 	video::IVideoDriver*		Driver;
 	IGUISpriteBank*			SpriteBank;
 	IGUIEnvironment*		Environment;
@@ -47,6 +47,7 @@ void CGUIImage::setImage(video::ITexture* image)
 
 	if (Texture)
 		Texture->grab();
+	invalidate();
 }
 
 //! Gets the image texture
@@ -59,6 +60,7 @@ video::ITexture* CGUIImage::getImage() const
 void CGUIImage::setColor(video::SColor color)
 {
 	Color = color;
+	invalidate();
 }
 
 //! Gets the color of the image
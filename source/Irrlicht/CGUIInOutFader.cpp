@@ -57,6 +57,9 @@ void CGUIInOutFader::draw()
 
 		video::SColor newCol = FullColor.getInterpolated(TransColor, d);
 		driver->draw2DRectangle(newCol, AbsoluteRect, &AbsoluteClippingRect);
+
+		if (now <= EndTime)
+			invalidate();
 	}
 
 	IGUIElement::draw();
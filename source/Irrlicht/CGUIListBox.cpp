@@ -122,6 +122,7 @@ void CGUIListBox::removeItem(u32 id)
 	Items.erase(id);
 
 	recalculateItemHeight();
+	invalidate();
 }
 
 
@@ -153,6 +154,7 @@ void CGUIListBox::clear()
 		ScrollBar->setPos(0);
 
 	recalculateItemHeight();
+	invalidate();
 }
 
 
@@ -209,6 +211,7 @@ void CGUIListBox::setSelected(s32 id)
 	selectTime = os::Timer::getTime();
 
 	recalculateScrollPos();
+	invalidate();
 }
 
 //! sets the selected item. Set this to -1 if no item should be selected
@@ -605,6 +608,7 @@ u32 CGUIListBox::addItem(const wchar_t* text, s32 icon)
 	recalculateItemHeight();
 	recalculateItemWidth(icon);
 
+	invalidate();
 	return Items.size() - 1;
 }
 
@@ -785,6 +789,7 @@ void CGUIListBox::setItem(u32 index, const wchar_t* text, s32 icon)
 
 	recalculateItemHeight();
 	recalculateItemWidth(icon);
+	invalidate();
 }
 
 
@@ -800,6 +805,7 @@ s32 CGUIListBox::insertItem(u32 index, const wchar_t* text, s32 icon)
 	recalculateItemHeight();
 	recalculateItemWidth(icon);
 
+	invalidate();
 	return index;
 }
 
@@ -812,6 +818,7 @@ void CGUIListBox::swapItems(u32 index1, u32 index2)
 	ListItem dummmy = Items[index1];
 	Items[index1] = Items[index2];
 	Items[index2] = dummmy;
+	invalidate();
 }
 
 
@@ -822,6 +829,8 @@ void CGUIListBox::setItemOverrideColor(u32 index, video::SColor color)
 		Items[index].OverrideColors[c].Use = true;
 		Items[index].OverrideColors[c].Color = color;
 	}
+
+	invalidate();
 }
 
 
@@ -832,6 +841,7 @@ void CGUIListBox::setItemOverrideColor(u32 index, EGUI_LISTBOX_COLOR colorType,
 
 	Items[index].OverrideColors[colorType].Use = true;
 	Items[index].OverrideColors[colorType].Color = color;
+	invalidate();
 }
 
 
@@ -841,6 +851,8 @@ void CGUIListBox::clearItemOverrideColor(u32 index)
 	{
 		Items[index].OverrideColors[c].Use = false;
 	}
+
+	invalidate();
 }
 
 
@@ -850,6 +862,7 @@ void CGUIListBox::clearItemOverrideColor(u32 index, EGUI_LISTBOX_COLOR colorType
 		return;
 
 	Items[index].OverrideColors[colorType].Use = false;
+	invalidate();
 }
 
 
@@ -147,6 +147,10 @@ void CGUIMeshViewer::draw()
 		u32 frame = 0;
 		if(Mesh->getFrameCount())
 			frame = (os::Timer::getTime()/20)%Mesh->getFrameCount();
+
+		// animated meshes have to be drawn again in the next frame
+		if (Mesh->getFrameCount() > 1)
+			invalidate();
 		const scene::IMesh* const m = Mesh->getMesh(frame);
 
 		for (u32 i=0; i<m->getMeshBufferCount(); ++i)
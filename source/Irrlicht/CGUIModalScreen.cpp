@@ -153,6 +153,9 @@ void CGUIModalScreen::draw()
 		return;
 
 	u32 now = os::Timer::getTime();
+	if (now - MouseDownTime < 300)
+		invalidate();
+
 	if (now - MouseDownTime < 300 && (now / 70)%2)
 	{
 		core::list<IGUIElement*>::Iterator it = Children.begin();
@@ -362,6 +362,7 @@ void CGUIScrollBar::setPos(s32 pos)
 		DrawHeight = RelativeRect.getWidth();
 	}
 
+	invalidate();
 }
 
 
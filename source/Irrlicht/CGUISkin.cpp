@@ -17,7 +17,7 @@ namespace gui
 {
 
 CGUISkin::CGUISkin(EGUI_SKIN_TYPE type, video::IVideoDriver* driver)
-: SpriteBank(0), Driver(driver), Type(type)
+: SpriteBank(0), Driver(driver), ChangedID(1), Type(type)
 {
 	#ifdef _DEBUG
 	setDebugName("CGUISkin");
@@ -194,8 +194,11 @@ video::SColor CGUISkin::getColor(EGUI_DEFAULT_COLOR color) const
 //! sets a default color
 void CGUISkin::setColor(EGUI_DEFAULT_COLOR which, video::SColor newColor)
 {
-	if ((u32)which < EGDC_COUNT)
+	if ((u32)which < EGDC_COUNT && Colors[which] != newColor)
+	{
 		Colors[which] = newColor;
+		++ChangedID;
+	}
 }
 
 
@@ -212,8 +215,11 @@ s32 CGUISkin::getSize(EGUI_DEFAULT_SIZE size) const
 //! sets a default size
 void CGUISkin::setSize(EGUI_DEFAULT_SIZE which, s32 size)
 {
-	if ((u32)which < EGDS_COUNT)
+	if ((u32)which < EGDS_COUNT && Sizes[which] != size)
+	{
 		Sizes[which] = size;
+		++ChangedID;
+	}
 }
 
 
@@ -240,6 +246,7 @@ void CGUISkin::setFont(IGUIFont* font, EGUI_DEFAULT_FONT which)
 			Fonts[which]->drop();
 
 		Fonts[which] = font;
+		++ChangedID;
 	}
 }
 
@@ -261,6 +268,7 @@ void CGUISkin::setSpriteBank(IGUISpriteBank* bank)
 		SpriteBank->drop();
 
 	SpriteBank = bank;
+	++ChangedID;
 }
 
 
@@ -277,8 +285,11 @@ u32 CGUISkin::getIcon(EGUI_DEFAULT_ICON icon) const
 //! Sets a default icon
 void CGUISkin::setIcon(EGUI_DEFAULT_ICON icon, u32 index)
 {
-	if ((u32)icon < EGDI_COUNT)
+	if ((u32)icon < EGDI_COUNT && Icons[icon] != index)
+	{
 		Icons[icon] = index;
+		++ChangedID;
+	}
 }
 
 
@@ -298,7 +309,10 @@ const wchar_t* CGUISkin::getDefaultText(EGUI_DEFAULT_TEXT text) const
 void CGUISkin::setDefaultText(EGUI_DEFAULT_TEXT which, const wchar_t* newText)
 {
 	if ((u32)which < EGDT_COUNT)
+	{
 		Texts[which] = newText;
+		++ChangedID;
+	}
 }
 
 
@@ -963,6 +977,13 @@ EGUI_SKIN_TYPE CGUISkin::getType() const
 }
 
 
+//! Get an id which changes each time the skin is changed
+u32 CGUISkin::getChangedID() const
+{
+	return ChangedID;
+}
+
+
 //! draws a 2d rectangle.
 void CGUISkin::draw2DRectangle(IGUIElement* element,
 		const video::SColor &color, const core::rect<s32>& pos,
@@ -1005,6 +1026,8 @@ void CGUISkin::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWrit
 
 	for (i=0; i<EGDI_COUNT; ++i)
 		Icons[i] = in->getAttributeAsInt(GUISkinIconNames[i], Icons[i]);
+
+	++ChangedID;
 }
 
 
@@ -216,6 +216,9 @@ namespace gui
 		//! get the type of this skin
 		virtual EGUI_SKIN_TYPE getType() const _IRR_OVERRIDE_;
 
+		//! Get an id which changes each time the skin is changed
+		virtual u32 getChangedID() const _IRR_OVERRIDE_;
+
 		//! Writes attributes of the skin
 		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const _IRR_OVERRIDE_;
 
@@ -232,6 +235,7 @@ namespace gui
 		core::stringw Texts[EGDT_COUNT];
 		video::IVideoDriver* Driver;
 		bool UseGradient;
+		u32 ChangedID;
 
 		EGUI_SKIN_TYPE Type;
 	};
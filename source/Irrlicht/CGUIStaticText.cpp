@@ -182,6 +182,7 @@ void CGUIStaticText::setOverrideColor(video::SColor color)
 {
 	OverrideColor = color;
 	OverrideColorEnabled = true;
+	invalidate();
 }
 
 
@@ -191,6 +192,7 @@ void CGUIStaticText::setBackgroundColor(video::SColor color)
 	BGColor = color;
 	OverrideBGColorEnabled = true;
 	Background = true;
+	invalidate();
 }
 
 
@@ -142,6 +142,8 @@ bool CGUITable::setActiveColumn(s32 idx, bool doOrder )
 
 	bool changed = (ActiveTab != idx);
 	ActiveTab = idx;
+	invalidate();
+
 	if ( ActiveTab < 0 )
 		return false;
 
@@ -301,6 +303,8 @@ void CGUITable::setCellText(u32 rowIndex, u32 columnIndex, const core::stringw&
 		if ( skin )
 			Rows[rowIndex].Items[columnIndex].Color = skin->getColor(EGDC_BUTTON_TEXT);
 	}
+
+	invalidate();
 }
 
 void CGUITable::setCellText(u32 rowIndex, u32 columnIndex, const core::stringw& text, video::SColor color)
@@ -312,6 +316,8 @@ void CGUITable::setCellText(u32 rowIndex, u32 columnIndex, const core::stringw&
 		Rows[rowIndex].Items[columnIndex].Color = color;
 		Rows[rowIndex].Items[columnIndex].IsOverrideColor = true;
 	}
+
+	invalidate();
 }
 
 
@@ -322,6 +328,8 @@ void CGUITable::setCellColor(u32 rowIndex, u32 columnIndex, video::SColor color)
 		Rows[rowIndex].Items[columnIndex].Color = color;
 		Rows[rowIndex].Items[columnIndex].IsOverrideColor = true;
 	}
+
+	invalidate();
 }
 
 
@@ -398,6 +406,7 @@ void CGUITable::setSelected( s32 index )
 	Selected = -1;
 	if ( index >= 0 && index < (s32) Rows.size() )
 		Selected = index;
+	invalidate();
 }
 
 
@@ -409,6 +418,7 @@ void CGUITable::recalculateWidths()
 		TotalItemWidth += Columns[i].Width;
 	}
 	checkScrollbars();
+	invalidate();
 }
 
 
@@ -426,6 +436,7 @@ void CGUITable::recalculateHeights()
 		TotalItemHeight = 0;
 	}
 	checkScrollbars();
+	invalidate();
 }
 
 
@@ -659,6 +670,7 @@ void CGUITable::setColumnOrdering(u32 columnIndex, EGUI_COLUMN_ORDERING mode)
 {
 	if ( columnIndex < Columns.size() )
 		Columns[columnIndex].OrderingMode = mode;
+	invalidate();
 }
 
 
@@ -679,6 +691,7 @@ void CGUITable::swapRows(u32 rowIndexA, u32 rowIndexB)
 	else if( Selected == s32(rowIndexB) )
 		Selected = rowIndexA;
 
+	invalidate();
 }
 
 
@@ -812,6 +825,8 @@ void CGUITable::orderRows(s32 columnIndex, EGUI_ORDERING_MODE mode)
 			}
 		}
 	}
+
+	invalidate();
 }
 
 
@@ -1056,6 +1071,7 @@ void CGUITable::breakText(const core::stringw& text, core::stringw& brokenText,
 void CGUITable::setDrawFlags(s32 flags)
 {
 	DrawFlags = flags;
+	invalidate();
 }
 
 
@@ -1121,6 +1137,7 @@ IGUIScrollBar* CGUITable::getHorizontalScrollBar() const
 void CGUITable::setDrawBackground(bool draw)
 {
 	DrawBack = draw;
+	invalidate();
 }
 
 //! Checks if background drawing is enabled
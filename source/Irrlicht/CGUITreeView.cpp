@@ -57,11 +57,13 @@ IGUITreeViewNode* CGUITreeViewNode::getParent() const
 void CGUITreeViewNode::setText( const wchar_t* text )
 {
 	Text = text;
+	Owner->invalidate();
 }
 
 void CGUITreeViewNode::setIcon( const wchar_t* icon )
 {
 	Icon = icon;
+	Owner->invalidate();
 }
 
 void CGUITreeViewNode::clearChildren()
@@ -73,6 +75,7 @@ void CGUITreeViewNode::clearChildren()
 		( *it )->drop();
 	}
 	Children.clear();
+	Owner->invalidate();
 }
 
 IGUITreeViewNode* CGUITreeViewNode::addChildBack(
@@ -96,6 +99,7 @@ IGUITreeViewNode* CGUITreeViewNode::addChildBack(
 	{
 		data2->grab();
 	}
+	Owner->invalidate();
 	return newChild;
 }
 
@@ -120,6 +124,7 @@ IGUITreeViewNode* CGUITreeViewNode::addChildFront(
 	{
 		data2->grab();
 	}
+	Owner->invalidate();
 	return newChild;
 }
 
@@ -154,6 +159,7 @@ IGUITreeViewNode* CGUITreeViewNode::insertChildAfter(
 			break;
 		}
 	}
+	Owner->invalidate();
 	return newChild;
 }
 
@@ -188,6 +194,7 @@ IGUITreeViewNode* CGUITreeViewNode::insertChildBefore(
 			break;
 		}
 	}
+	Owner->invalidate();
 	return newChild;
 }
 
@@ -303,6 +310,7 @@ bool CGUITreeViewNode::deleteChild( IGUITreeViewNode* child )
 			break;
 		}
 	}
+	Owner->invalidate();
 	return deleted;
 }
 
@@ -328,6 +336,7 @@ bool CGUITreeViewNode::moveChildUp( IGUITreeViewNode* child )
 		}
 		itOther = itChild;
 	}
+	Owner->invalidate();
 	return moved;
 }
 
@@ -354,12 +363,14 @@ bool CGUITreeViewNode::moveChildDown( IGUITreeViewNode* child )
 			break;
 		}
 	}
+	Owner->invalidate();
 	return moved;
 }
 
 void CGUITreeViewNode::setExpanded( bool expanded )
 {
 	Expanded = expanded;
+	Owner->invalidate();
 }
 
 void CGUITreeViewNode::setSelected( bool selected )
@@ -377,6 +388,8 @@ void CGUITreeViewNode::setSelected( bool selected )
 				Owner->Selected = 0;
 			}
 		}
+
+		Owner->invalidate();
 	}
 }
 
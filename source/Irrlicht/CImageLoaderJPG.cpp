@@ -16,9 +16,6 @@ namespace irr
 namespace video
 {
 
-// Static members
-io::path CImageLoaderJPG::Filename;
-
 //! constructor
 CImageLoaderJPG::CImageLoaderJPG()
 {
@@ -54,6 +51,9 @@ bool CImageLoaderJPG::isALoadableFileExtension(const io::path& filename) const
 
         // for longjmp, to return to caller on a fatal error
         jmp_buf setjmp_buffer;
+
+        // name of the file for error-messages, images may be loaded on several threads
+        const io::path* filename;
     };
 
 void CImageLoaderJPG::init_source (j_decompress_ptr cinfo)
@@ -111,7 +111,7 @@ void CImageLoaderJPG::output_message(j_common_ptr cinfo)
 	c8 temp1[JMSG_LENGTH_MAX];
 	(*cinfo->err->format_message)(cinfo, temp1);
 	core::stringc errMsg("JPEG FATAL ERROR in ");
-	errMsg += core::stringc(Filename);
+	errMsg += core::stringc(*((irr_jpeg_error_mgr*) cinfo->err)->filename);
 	os::Printer::log(errMsg.c_str(),temp1, ELL_ERROR);
 }
 #endif // _IRR_COMPILE_WITH_LIBJPEG_
@@ -145,11 +145,16 @@ IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
 	if (!file)
 		return 0;
 
-	Filename = file->getFileName();
-
 	u8 **rowPtr=0;
-	u8* input = new u8[file->getSize()];
-	file->read(input, file->getSize());
+	// decode directly from the file if it is already in memory
+	u8* input = 0;
+	const u8* data = (const u8*)file->getData();
+	if (!data)
+	{
+		input = new u8[file->getSize()];
+		file->read(input, file->getSize());
+		data = input;
+	}
 
 	// allocate and initialize JPEG decompression object
 	struct jpeg_decompress_struct cinfo;
@@ -160,6 +165,7 @@ IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
 	//This routine fills in the contents of struct jerr, and returns jerr's
 	//address which we place into the link field in cinfo.
 
+	jerr.filename = &file->getFileName();
 	cinfo.err = jpeg_std_error(&jerr.pub);
 	cinfo.err->error_exit = error_exit;
 	cinfo.err->output_message = output_message;
@@ -191,7 +197,7 @@ IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
 
 	// Set up data pointer
 	jsrc.bytes_in_buffer = file->getSize();
-	jsrc.next_input_byte = (JOCTET*)input;
+	jsrc.next_input_byte = (const JOCTET*)data;
 	cinfo.src = &jsrc;
 
 	jsrc.init_source = init_source;
@@ -6,18 +6,27 @@
 #include "IVideoDriver.h"
 #include "ISceneManager.h"
 #include "IVertexDescriptor.h"
+#include "ICameraSceneNode.h"
 #include "os.h"
 
 namespace irr
 {
 	namespace scene
 	{
+		//! instances classified per job of the thread pool
+		static const u32 CLASSIFY_PART_SIZE = 4096;
+
+		//! level of an instance outside of the view frustum
+		static const u8 CULLED_LEVEL = 0xFF;
+
+		//! maximum number of levels of detail, including the base mesh
+		static const u32 MAX_LEVELS = 16;
 
 		//! constructor
 		CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
 			const core::vector3df& position, const core::vector3df& rotation, const core::vector3df& scale)
 			: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale),
-			baseMesh(NULL), readOnlyMaterial(false), staticInstances(false)
+			baseMesh(NULL), readOnlyMaterial(false), staticInstances(false), cullInstances(false)
 		{
 #ifdef _DEBUG
 			setDebugName("CInstancedMeshSceneNode");
@@ -30,6 +39,8 @@ namespace irr
 		{
 			instanceNodeArray.clear();
 
+			removeLODMeshes();
+
 			if (baseMesh)
 				baseMesh->drop();
 		}
@@ -39,6 +50,15 @@ namespace irr
 		{
 			if (IsVisible)
 			{
+				// the camera has its view frustum of this frame by now
+				if (!SceneManager->isCulled(this))
+					compactInstances();
+				else
+				{
+					for (u32 i = 0; i < levels.size(); ++i)
+						levels[i].count = 0;
+				}
+
 				SceneManager->registerNodeForRendering(this);
 
 				ISceneNode::OnRegisterSceneNode();
@@ -68,19 +88,27 @@ namespace irr
 			empty->updateAbsolutePosition();
 
 			instanceNodeArray.push_back(empty);
+			instanceBoxArray.push_back(core::aabbox3df());
+			updateInstanceBox(instanceNodeArray.size() - 1);
+			box.addInternalBox(instanceBoxArray.getLast());
+
 			return empty;
 		}
 
 		bool CInstancedMeshSceneNode::removeInstance(u32 index)
 		{
-			if (index > instanceNodeArray.size())
+			if (index >= instanceNodeArray.size())
 				return false;
 
+			const u32 last = instanceNodeArray.size() - 1;
+
 			removeChild(instanceNodeArray[index]);
 
-			instanceNodeArray[index]->drop();
-			instanceNodeArray[index] = instanceNodeArray[instanceNodeArray.size() - 1];
-			instanceNodeArray.erase(instanceNodeArray.size() - 1);
+			instanceNodeArray[index] = instanceNodeArray[last];
+			instanceNodeArray.erase(last);
+
+			instanceBoxArray[index] = instanceBoxArray[last];
+			instanceBoxArray.erase(last);
 
 			return true;
 		}
@@ -92,15 +120,7 @@ namespace irr
 			for (u32 i = 0; i < size; ++i)
 			{
 				if (instanceNodeArray[i] == instance)
-				{
-					removeChild(instanceNodeArray[i]);
-
-					instanceNodeArray[i]->drop();
-					instanceNodeArray[i] = instanceNodeArray[instanceNodeArray.size() - 1];
-					instanceNodeArray.erase(instanceNodeArray.size() - 1);
-
-					return true;
-				}
+					return removeInstance(i);
 			}
 
 			return false;
@@ -113,15 +133,7 @@ namespace irr
 			for (u32 i = 0; i < size; ++i)
 			{
 				if (instanceNodeArray[i]->getID() == id)
-				{
-					removeChild(instanceNodeArray[i]);
-
-					instanceNodeArray[i]->drop();
-					instanceNodeArray[i] = instanceNodeArray[instanceNodeArray.size() - 1];
-					instanceNodeArray.erase(instanceNodeArray.size() - 1);
-
-					return true;
-				}
+					return removeInstance(i);
 			}
 
 			return false;
@@ -129,7 +141,7 @@ namespace irr
 
 		ISceneNode* CInstancedMeshSceneNode::getInstance(u32 index) const
 		{
-			if (index > instanceNodeArray.size())
+			if (index >= instanceNodeArray.size())
 				return NULL;
 
 			return instanceNodeArray[index];
@@ -161,16 +173,26 @@ namespace irr
 			if (!IsVisible || !SceneManager->getActiveCamera())
 				return;
 
-			if (!baseMesh || baseMesh->getMeshBuffer(0)->getVertexBuffer(1)->getVertexCount() == 0)
+			if (!baseMesh || baseMesh->getMeshBuffer(0)->getVertexBufferCount() != 2)
 				return;
 
 			IMeshBuffer* renderBuffer = baseMesh->getMeshBuffer(0);
 
 			video::IVideoDriver* driver = SceneManager->getVideoDriver();
 			driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
-			driver->setMaterial(readOnlyMaterial ? material : renderBuffer->getMaterial());
 
-			driver->drawMeshBuffer(renderBuffer);
+			// the instance buffer of each level only holds its visible instances,
+			// the drivers draw as many instances as it has vertices
+			for (u32 i = 0; i < levels.size(); ++i)
+			{
+				if (getInstanceBuffer(i)->getVertexCount() == 0)
+					continue;
+
+				IMeshBuffer* levelBuffer = levels[i].mesh->getMeshBuffer(0);
+
+				driver->setMaterial(readOnlyMaterial ? material : levelBuffer->getMaterial());
+				driver->drawMeshBuffer(levelBuffer);
+			}
 
 			// for debug purposes only:
 			if (DebugDataVisible)
@@ -188,6 +210,9 @@ namespace irr
 
 					for (u32 i = 0; i < size; ++i)
 					{
+						if (i < instanceLevelArray.size() && instanceLevelArray[i] == CULLED_LEVEL)
+							continue;
+
 						core::aabbox3df box = renderBuffer->getBoundingBox();
 						driver->setTransform(video::ETS_WORLD, instanceNodeArray[i]->getAbsoluteTransformation());
 						driver->draw3DBox(box, video::SColor(255, 255, 255, 255));
@@ -210,33 +235,229 @@ namespace irr
 			return box;
 		}
 
+		//! Updates the bounding boxes of the instances, the instance buffers are written
+		//! when the node is registered for rendering.
 		void CInstancedMeshSceneNode::updateInstances()
 		{
 			if (!baseMesh || baseMesh->getMeshBuffer(0)->getVertexBufferCount() != 2)
 				return;
 
-			IMeshBuffer* renderBuffer = baseMesh->getMeshBuffer(0);
-
 			box.reset(0, 0, 0);
 
 			const u32 size = instanceNodeArray.size();
 
-			renderBuffer->getVertexBuffer(1)->clear();
-			renderBuffer->getVertexBuffer(1)->setDirty();
-			renderBuffer->getVertexBuffer(1)->set_used(size);
+			for (u32 i = 0; i < size; ++i)
+			{
+				updateInstanceBox(i);
+				box.addInternalBox(instanceBoxArray[i]);
+			}
+		}
+
+		void CInstancedMeshSceneNode::updateInstanceBox(u32 index)
+		{
+			if (!baseMesh)
+				return;
+
+			// all levels are culled with the box of the base mesh
+			core::aabbox3df& instanceBox = instanceBoxArray[index];
+			instanceBox = baseMesh->getMeshBuffer(0)->getBoundingBox();
+			instanceNodeArray[index]->getAbsoluteTransformation().transformBoxEx(instanceBox);
+		}
+
+		void CInstancedMeshSceneNode::compactInstances()
+		{
+			if (!baseMesh || baseMesh->getMeshBuffer(0)->getVertexBufferCount() != 2)
+				return;
+
+			const u32 size = instanceNodeArray.size();
+
+			// instances removed from the scene graph directly
+			if (instanceBoxArray.size() != size)
+			{
+				instanceBoxArray.set_used(size);
+				updateInstances();
+			}
+
+			const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+
+			cullInstances = camera && AutomaticCullingState != EAC_OFF;
+			if (camera)
+			{
+				cullFrustum = *camera->getViewFrustum();
+				cullCamera = camera->getAbsolutePosition();
+			}
+			else
+				cullCamera = core::vector3df(0.f, 0.f, 0.f);
+
+			// pick the level of each instance, split into parts for the thread pool
+			instanceLevelArray.set_used(size);
+
+			const u32 parts = (size + CLASSIFY_PART_SIZE - 1) / CLASSIFY_PART_SIZE;
+			if (parts > 1)
+			{
+				CClassifyJob job(this);
+				CThreadPool::getSharedPool()->run(&job, parts);
+			}
+			else
+				classifyInstances(0, size);
+
+			// write the visible instances of each level to the front of its instance buffer,
+			// only the slots whose matrix changed since the last frame are uploaded
+			core::matrix4* slots[MAX_LEVELS];
+			u32 oldCount[MAX_LEVELS];
+			u32 dirtyBegin[MAX_LEVELS];
+			u32 dirtyEnd[MAX_LEVELS];
+
+			const u32 levelCount = levels.size();
+
+			for (u32 l = 0; l < levelCount; ++l)
+			{
+				IVertexBuffer* instanceBuffer = getInstanceBuffer(l);
+
+				oldCount[l] = instanceBuffer->getVertexCount();
+				instanceBuffer->set_used(size);
+				slots[l] = (core::matrix4*)instanceBuffer->getVertices();
+
+				levels[l].count = 0;
+				dirtyBegin[l] = size;
+				dirtyEnd[l] = 0;
+			}
 
 			for (u32 i = 0; i < size; ++i)
 			{
-				core::aabbox3df instanceBox = renderBuffer->getBoundingBox();
-				instanceNodeArray[i]->getAbsoluteTransformation().transformBoxEx(instanceBox);
+				const u32 l = instanceLevelArray[i];
+				if (l == CULLED_LEVEL)
+					continue;
+
+				const u32 k = levels[l].count++;
+				const core::matrix4& m = instanceNodeArray[i]->getAbsoluteTransformation();
+
+				if (k >= oldCount[l] || slots[l][k] != m)
+				{
+					slots[l][k] = m;
+
+					if (k < dirtyBegin[l])
+						dirtyBegin[l] = k;
+					dirtyEnd[l] = k + 1;
+				}
+			}
+
+			for (u32 l = 0; l < levelCount; ++l)
+			{
+				IVertexBuffer* instanceBuffer = getInstanceBuffer(l);
+				instanceBuffer->set_used(levels[l].count);
+
+				if (dirtyBegin[l] < dirtyEnd[l])
+					instanceBuffer->setDirty(dirtyBegin[l], dirtyEnd[l] - dirtyBegin[l]);
+			}
+		}
+
+		void CInstancedMeshSceneNode::CClassifyJob::run(u32 index, u32 thread)
+		{
+			const u32 begin = index * CLASSIFY_PART_SIZE;
+			const u32 end = core::min_(begin + CLASSIFY_PART_SIZE, Node->instanceNodeArray.size());
+
+			Node->classifyInstances(begin, end);
+		}
+
+		void CInstancedMeshSceneNode::classifyInstances(u32 begin, u32 end)
+		{
+			const u32 levelCount = levels.size();
+
+			for (u32 i = begin; i < end; ++i)
+			{
+				const core::aabbox3df& instanceBox = instanceBoxArray[i];
+
+				bool culled = false;
+
+				// the instance is outside if the corner closest to the inside of
+				// a plane is in front of it
+				if (cullInstances)
+				{
+					for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p)
+					{
+						const core::plane3df& plane = cullFrustum.planes[p];
+
+						const core::vector3df corner(
+							plane.Normal.X >= 0.f ? instanceBox.MinEdge.X : instanceBox.MaxEdge.X,
+							plane.Normal.Y >= 0.f ? instanceBox.MinEdge.Y : instanceBox.MaxEdge.Y,
+							plane.Normal.Z >= 0.f ? instanceBox.MinEdge.Z : instanceBox.MaxEdge.Z);
+
+						if (plane.Normal.dotProduct(corner) + plane.D > core::ROUNDING_ERROR_f32)
+						{
+							culled = true;
+							break;
+						}
+					}
+				}
+
+				if (culled)
+				{
+					instanceLevelArray[i] = CULLED_LEVEL;
+					continue;
+				}
+
+				const f32 distanceSQ = instanceBox.getCenter().getDistanceFromSQ(cullCamera);
 
-				if (!SceneManager->isCulled(instanceNodeArray[i]))
-					renderBuffer->getVertexBuffer(1)->setVertex(i, &instanceNodeArray[i]->getAbsoluteTransformation());
+				u32 l = levelCount - 1;
+				while (l > 0 && levels[l].distanceSQ > distanceSQ)
+					--l;
 
-				box.addInternalPoint(instanceNodeArray[i]->getAbsolutePosition());
+				instanceLevelArray[i] = (u8)l;
 			}
+		}
+
+		u32 CInstancedMeshSceneNode::getVisibleInstanceCount() const
+		{
+			u32 count = 0;
+
+			for (u32 i = 0; i < levels.size(); ++i)
+				count += levels[i].count;
+
+			return count;
+		}
+
+		bool CInstancedMeshSceneNode::addLODMesh(IMesh* mesh, f32 distance)
+		{
+			if (!mesh || !baseMesh || mesh == baseMesh || levels.size() >= MAX_LEVELS ||
+				mesh->getMeshBufferCount() == 0 || distance <= 0.f)
+				return false;
+
+			mesh->grab();
+			setupInstanceBuffer(mesh);
+
+			SLevel level;
+			level.mesh = mesh;
+			level.distanceSQ = distance * distance;
+			level.count = 0;
+
+			// keep the levels sorted by distance
+			u32 i = levels.size();
+			while (i > 1 && levels[i - 1].distanceSQ > level.distanceSQ)
+				--i;
+
+			levels.insert(level, i);
+
+			return true;
+		}
 
-			renderBuffer->getVertexBuffer(1)->setDirty();
+		void CInstancedMeshSceneNode::removeLODMeshes()
+		{
+			for (u32 i = 1; i < levels.size(); ++i)
+				levels[i].mesh->drop();
+
+			if (levels.size() > 1)
+				levels.erase(1, levels.size() - 1);
+		}
+
+		u32 CInstancedMeshSceneNode::getLODMeshCount() const
+		{
+			return levels.size() > 1 ? levels.size() - 1 : 0;
+		}
+
+		IVertexBuffer* CInstancedMeshSceneNode::getInstanceBuffer(u32 level) const
+		{
+			return levels[level].mesh->getMeshBuffer(0)->getVertexBuffer(1);
 		}
 
 		bool CInstancedMeshSceneNode::isStatic() const
@@ -273,60 +494,80 @@ namespace irr
 		//! Sets a new mesh
 		void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
 		{
-			video::IVideoDriver* driver = SceneManager->getVideoDriver();
+			if (mesh)
+				mesh->grab();
+
 			if (baseMesh)
 			{
 				baseMesh->drop();
 				baseMesh = NULL;
 			}
 
+			removeLODMeshes();
+			levels.clear();
+
 			if (mesh)
 			{
-				mesh->grab();
-
 				baseMesh = mesh;
 
-				IMeshBuffer* renderBuffer = baseMesh->getMeshBuffer(0);
+				setupInstanceBuffer(baseMesh);
 
-				while (renderBuffer->getVertexBufferCount() > 1)
-					renderBuffer->removeVertexBuffer(1);
+				SLevel level;
+				level.mesh = baseMesh;
+				level.distanceSQ = 0.f;
+				level.count = 0;
+				levels.push_back(level);
 
-				// TODO add getter and so that the smaller value isnt erased
-				// maybe the func isnt longer needed so delete it
-				driver->setMinHardwareBufferVertexCount(renderBuffer->getVertexBuffer()->getVertexCount());
+				// the boxes depend on the mesh
+				instanceBoxArray.set_used(instanceNodeArray.size());
+				updateInstances();
+			}
+		}
 
-				renderBuffer->setHardwareMappingHint(scene::EHM_STATIC);
+		void CInstancedMeshSceneNode::setupInstanceBuffer(IMesh* mesh)
+		{
+			video::IVideoDriver* driver = SceneManager->getVideoDriver();
 
-				video::IVertexDescriptor* index = SceneManager->getVideoDriver()->getVertexDescriptor("BaseInstanceIndex");
+			IMeshBuffer* renderBuffer = mesh->getMeshBuffer(0);
 
-				if (!index)
-				{
-					video::IVertexDescriptor* stdv = SceneManager->getVideoDriver()->getVertexDescriptor(0);
-					index = SceneManager->getVideoDriver()->addVertexDescriptor("BaseInstanceIndex");
+			while (renderBuffer->getVertexBufferCount() > 1)
+				renderBuffer->removeVertexBuffer(1);
 
-					for (u32 i = 0; i < stdv->getAttributeCount(); ++i)
-					{
-						index->addAttribute(stdv->getAttribute(i)->getName(), stdv->getAttribute(i)->getElementCount(), stdv->getAttribute(i)->getSemantic(), stdv->getAttribute(i)->getType(), stdv->getAttribute(i)->getBufferID());
-					}
+			// TODO add getter and so that the smaller value isnt erased
+			// maybe the func isnt longer needed so delete it
+			driver->setMinHardwareBufferVertexCount(renderBuffer->getVertexBuffer()->getVertexCount());
 
-					index->addAttribute("InstancingMatrix1", 4, video::EVAS_TEXCOORD1, video::EVAT_FLOAT, 1);
-					index->addAttribute("InstancingMatrix2", 4, video::EVAS_TEXCOORD2, video::EVAT_FLOAT, 1);
-					index->addAttribute("InstancingMatrix3", 4, video::EVAS_TEXCOORD3, video::EVAT_FLOAT, 1);
-					index->addAttribute("InstancingMatrix4", 4, video::EVAS_TEXCOORD4, video::EVAT_FLOAT, 1);
+			renderBuffer->setHardwareMappingHint(scene::EHM_STATIC);
 
-					index->setInstanceDataStepRate(video::EIDSR_PER_INSTANCE, 1);
-				}
+			video::IVertexDescriptor* index = SceneManager->getVideoDriver()->getVertexDescriptor("BaseInstanceIndex");
 
-				IVertexBuffer* instanceBuffer = new CVertexBuffer<core::matrix4>();
+			if (!index)
+			{
+				video::IVertexDescriptor* stdv = SceneManager->getVideoDriver()->getVertexDescriptor(0);
+				index = SceneManager->getVideoDriver()->addVertexDescriptor("BaseInstanceIndex");
+
+				for (u32 i = 0; i < stdv->getAttributeCount(); ++i)
+				{
+					index->addAttribute(stdv->getAttribute(i)->getName(), stdv->getAttribute(i)->getElementCount(), stdv->getAttribute(i)->getSemantic(), stdv->getAttribute(i)->getType(), stdv->getAttribute(i)->getBufferID());
+				}
 
-				renderBuffer->setVertexDescriptor(index);
-				renderBuffer->addVertexBuffer(instanceBuffer);
+				index->addAttribute("InstancingMatrix1", 4, video::EVAS_TEXCOORD1, video::EVAT_FLOAT, 1);
+				index->addAttribute("InstancingMatrix2", 4, video::EVAS_TEXCOORD2, video::EVAT_FLOAT, 1);
+				index->addAttribute("InstancingMatrix3", 4, video::EVAS_TEXCOORD3, video::EVAT_FLOAT, 1);
+				index->addAttribute("InstancingMatrix4", 4, video::EVAS_TEXCOORD4, video::EVAT_FLOAT, 1);
 
-				renderBuffer->getVertexBuffer(0)->setHardwareMappingHint(scene::EHM_STATIC);
-				renderBuffer->getVertexBuffer(1)->setHardwareMappingHint(scene::EHM_STATIC);
-				renderBuffer->getIndexBuffer()->setHardwareMappingHint(scene::EHM_STATIC);
-				instanceBuffer->drop();
+				index->setInstanceDataStepRate(video::EIDSR_PER_INSTANCE, 1);
 			}
+
+			IVertexBuffer* instanceBuffer = new CVertexBuffer<core::matrix4>();
+
+			renderBuffer->setVertexDescriptor(index);
+			renderBuffer->addVertexBuffer(instanceBuffer);
+
+			renderBuffer->getVertexBuffer(0)->setHardwareMappingHint(scene::EHM_STATIC);
+			renderBuffer->getVertexBuffer(1)->setHardwareMappingHint(scene::EHM_STATIC);
+			renderBuffer->getIndexBuffer()->setHardwareMappingHint(scene::EHM_STATIC);
+			instanceBuffer->drop();
 		}
 
 		//! Creates a clone of this scene node and its children.
@@ -344,6 +585,10 @@ namespace irr
 
 			nb->readOnlyMaterial = readOnlyMaterial;
 			nb->instanceNodeArray = instanceNodeArray;
+			nb->instanceBoxArray = instanceBoxArray;
+
+			for (u32 i = 1; i < levels.size(); ++i)
+				nb->addLODMesh(levels[i].mesh, sqrtf(levels[i].distanceSQ));
 			nb->baseMesh = baseMesh;
 
 			if (baseMesh)
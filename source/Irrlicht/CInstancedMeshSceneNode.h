@@ -6,6 +6,8 @@
 #define __C_INSTANCE_SCENE_NODE_H_INCLUDED__
 
 #include "IInstancedMeshSceneNode.h"
+#include "SViewFrustum.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -13,6 +15,7 @@ namespace irr
 	{
 		class IMesh;
 		class IMeshBuffer;
+		class IVertexBuffer;
 
 		class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
 		{
@@ -117,7 +120,50 @@ namespace irr
 
 			virtual void setStatic(bool staticInstances = true);
 
+			virtual u32 getVisibleInstanceCount() const;
+
+			virtual bool addLODMesh(IMesh* mesh, f32 distance);
+
+			virtual void removeLODMeshes();
+
+			virtual u32 getLODMeshCount() const;
+
 		protected:
+			//! culls the instances and picks their level of detail, called by CThreadPool
+			class CClassifyJob : public IThreadJob
+			{
+			public:
+				CClassifyJob(CInstancedMeshSceneNode* node) : Node(node) {}
+
+				virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_;
+
+				CInstancedMeshSceneNode* Node;
+			};
+
+			//! a mesh the instances are drawn with
+			struct SLevel
+			{
+				IMesh* mesh;
+				f32 distanceSQ;
+
+				//! instances written to the instance buffer in the last frame
+				u32 count;
+			};
+
+			//! adds the instance buffer to the first mesh buffer of a mesh
+			void setupInstanceBuffer(IMesh* mesh);
+
+			//! returns the instance buffer of a level
+			IVertexBuffer* getInstanceBuffer(u32 level) const;
+
+			//! updates the bounding box of a single instance
+			void updateInstanceBox(u32 index);
+
+			//! culls the instances against the active camera and writes the visible ones contiguously
+			void compactInstances();
+
+			void classifyInstances(u32 begin, u32 end);
+
 			core::aabbox3d<f32> box;
 
 			//IMeshBuffer* renderBuffer;
@@ -127,6 +173,20 @@ namespace irr
 
 			core::array<ISceneNode*> instanceNodeArray;
 
+			//! world space bounding boxes of the instances, updated by updateInstances
+			core::array<core::aabbox3d<f32> > instanceBoxArray;
+
+			//! level of detail of each instance in the current frame, CULLED_LEVEL if not visible
+			core::array<u8> instanceLevelArray;
+
+			//! levels of detail sorted by distance, level 0 is baseMesh
+			core::array<SLevel> levels;
+
+			//! state of the classification, read by the thread pool
+			SViewFrustum cullFrustum;
+			core::vector3df cullCamera;
+			bool cullInstances;
+
 			bool readOnlyMaterial;
 			video::SMaterial material;
 
@@ -13,6 +13,7 @@
 #include "CLogger.h"
 #include "irrString.h"
 #include "IRandomizer.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -21,7 +22,7 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 : IrrlichtDevice(), VideoDriver(0), GUIEnvironment(0), SceneManager(0),
 	Timer(0), CursorControl(0), UserReceiver(params.EventReceiver),
 	Logger(0), Operator(0), Randomizer(0), FileSystem(0),
-	InputReceivingSceneManager(0), VideoModeList(0),
+	InputReceivingSceneManager(0), ThreadPool(0), VideoModeList(0),
 	CreationParams(params), Close(false)
 {
 	Timer = new CTimer(params.UsePerformanceTimer);
@@ -39,8 +40,13 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 	Logger->setLogLevel(CreationParams.LoggingLevel);
 
 	os::Printer::Logger = Logger;
+	os::Printer::LoggerThread = CThreadPool::getCurrentThreadId();
 	Randomizer = createDefaultRandomizer();
 
+	// the driver and scene manager pick up the shared pool, so create it first
+	ThreadPool = new CThreadPool(params.WorkerThreads);
+	CThreadPool::setSharedPool(ThreadPool);
+
 	FileSystem = io::createFileSystem();
 	VideoModeList = new video::CVideoModeList();
 
@@ -85,8 +91,21 @@ CIrrDeviceStub::~CIrrDeviceStub()
 	if (Timer)
 		Timer->drop();
 
+	if (ThreadPool)
+	{
+		if (CThreadPool::getSharedPool() == ThreadPool)
+			CThreadPool::setSharedPool(0);
+		ThreadPool->drop();
+	}
+
+	// messages of the worker threads which are done now
+	os::Printer::flush();
+
 	if (Logger->drop())
+	{
 		os::Printer::Logger = 0;
+		os::Printer::LoggerThread = 0;
+	}
 }
 
 
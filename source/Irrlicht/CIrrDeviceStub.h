@@ -16,6 +16,7 @@ namespace irr
 	class ILogger;
 	class CLogger;
 	class IRandomizer;
+	class CThreadPool;
 
 	namespace gui
 	{
@@ -165,6 +166,7 @@ namespace irr
 		IRandomizer* Randomizer;
 		io::IFileSystem* FileSystem;
 		scene::ISceneManager* InputReceivingSceneManager;
+		CThreadPool* ThreadPool;
 
 		struct SMouseMultiClicks
 		{
@@ -44,9 +44,23 @@ s32 CLimitReadFile::read(void* buffer, u32 sizeToRead)
 		return 0;
 
 	s32 r = AreaStart + Pos;
-	s32 toRead = core::s32_min(AreaEnd, r + sizeToRead) - core::s32_max(AreaStart, r);
-	if (toRead < 0)
+	if (r >= AreaEnd)
 		return 0;
+
+	// the rest of the area limits sizeToRead, so it fits into an s32
+	s32 toRead = AreaEnd - core::s32_max(AreaStart, r);
+	if ((u32)toRead > sizeToRead)
+		toRead = (s32)sizeToRead;
+
+	// copy directly from a mapped file instead of moving its position
+	const c8* data = (const c8*)File->getData();
+	if (data && r + toRead <= File->getSize())
+	{
+		memcpy(buffer, data + r, toRead);
+		Pos += toRead;
+		return toRead;
+	}
+
 	File->seek(r);
 	r = File->read(buffer, toRead);
 	Pos += r;
@@ -116,6 +130,17 @@ const io::path& CLimitReadFile::getFileName() const
 }
 
 
+//! returns the area of the content of the file if it is in memory
+const void* CLimitReadFile::getData() const
+{
+	const c8* data = File ? (const c8*)File->getData() : 0;
+	if (!data || AreaEnd > File->getSize())
+		return 0;
+
+	return data + AreaStart;
+}
+
+
 IReadFile* createLimitReadFile(const io::path& fileName, IReadFile* alreadyOpenedFile, long pos, long areaSize)
 {
 	return new CLimitReadFile(alreadyOpenedFile, pos, areaSize, fileName);
@@ -356,7 +356,7 @@ bool CMD2MeshFileLoader::loadFile(io::IReadFile* file, CAnimatedMeshMD2* mesh)
 	delete [] textureCoords;
 
 	// init buffer with start frame.
-	mesh->getMesh(0);
+	mesh->updateInterpolationBuffer(0, 0, mesh->getFrameCount());
 	return true;
 }
 
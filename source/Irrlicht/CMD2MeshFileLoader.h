@@ -36,6 +36,9 @@ public:
 	//! See IReferenceCounted::drop() for more information.
 	virtual IAnimatedMesh* createMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+	//! the mesh only uses the vertex descriptors of the driver
+	virtual bool isWorkerThreadSafe() const _IRR_OVERRIDE_ { return true; }
+
 private:
 	//! Loads the file data into the mesh
 	bool loadFile(io::IReadFile* file, CAnimatedMeshMD2* mesh);
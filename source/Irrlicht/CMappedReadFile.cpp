@@ -0,0 +1,206 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMappedReadFile.h"
+
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+
+CMappedReadFile::CMappedReadFile(const io::path& fileName)
+: Data(0), Size(0), Pos(0), Filename(fileName)
+#ifdef _IRR_WINDOWS_API_
+	, Mapping(0)
+#endif
+{
+	#ifdef _DEBUG
+	setDebugName("CMappedReadFile");
+	#endif
+
+	mapFile();
+}
+
+
+CMappedReadFile::~CMappedReadFile()
+{
+	if (!Data)
+		return;
+
+#if defined(_IRR_WINDOWS_API_)
+	UnmapViewOfFile(Data);
+	CloseHandle((HANDLE)Mapping);
+#else
+	munmap((void*)Data, Size);
+#endif
+}
+
+
+//! returns how much was read
+s32 CMappedReadFile::read(void* buffer, u32 sizeToRead)
+{
+	long amount = Size - Pos;
+	if (amount <= 0)
+		return 0;
+
+	// no more than the returned s32 can count
+	const u32 maxAmount = core::min_(sizeToRead, (u32)0x7FFFFFFF);
+	if ((unsigned long)amount > maxAmount)
+		amount = (long)maxAmount;
+
+	memcpy(buffer, Data + Pos, amount);
+
+	Pos += amount;
+
+	return (s32)amount;
+}
+
+
+//! changes position in file, returns true if successful
+//! if relativeMovement==true, the pos is changed relative to current pos,
+//! otherwise from begin of file
+bool CMappedReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+	{
+		if (Pos + finalPos > Size || Pos + finalPos < 0)
+			return false;
+
+		Pos += finalPos;
+	}
+	else
+	{
+		if (finalPos > Size || finalPos < 0)
+			return false;
+
+		Pos = finalPos;
+	}
+
+	return true;
+}
+
+
+//! returns size of file
+long CMappedReadFile::getSize() const
+{
+	return Size;
+}
+
+
+//! returns where in the file we are.
+long CMappedReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CMappedReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+//! returns the mapped content of the file
+const void* CMappedReadFile::getData() const
+{
+	return Data;
+}
+
+
+//! maps the file
+void CMappedReadFile::mapFile()
+{
+	if (Filename.size() == 0)
+		return;
+
+#if defined(_IRR_WINDOWS_API_)
+#if defined ( _IRR_WCHAR_FILESYSTEM )
+	HANDLE file = CreateFileW(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+#else
+	HANDLE file = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+#endif
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || size.QuadPart > 0x7FFFFFFF)
+	{
+		CloseHandle(file);
+		return;
+	}
+
+	// the mapping keeps the file open
+	HANDLE mapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+	CloseHandle(file);
+	if (!mapping)
+		return;
+
+	Data = (const c8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!Data)
+	{
+		CloseHandle(mapping);
+		return;
+	}
+
+	Mapping = mapping;
+	Size = (long)size.QuadPart;
+#else
+	const int file = open(Filename.c_str(), O_RDONLY);
+	if (file < 0)
+		return;
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0 ||
+		(unsigned long long)info.st_size > (unsigned long long)(((unsigned long)-1) >> 1))
+	{
+		close(file);
+		return;
+	}
+
+	// the mapping stays valid after closing the file
+	void* data = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+		return;
+
+	// the loaders read the whole file, so let the system read it ahead
+	posix_madvise(data, (size_t)info.st_size, POSIX_MADV_WILLNEED);
+
+	Data = (const c8*)data;
+	Size = (long)info.st_size;
+#endif
+}
+
+
+IReadFile* CMappedReadFile::createMappedReadFile(const io::path& fileName)
+{
+	CMappedReadFile* file = new CMappedReadFile(fileName);
+	if (file->Data)
+		return file;
+
+	file->drop();
+	return 0;
+}
+
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_MAPPED_FILES_
+
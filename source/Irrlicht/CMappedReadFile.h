@@ -0,0 +1,76 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MAPPED_READ_FILE_H_INCLUDED__
+#define __C_MAPPED_READ_FILE_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+
+#include "IReadFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace io
+{
+
+	/*!
+		Class for reading a real file from disk, which is mapped into memory.
+		Truncating the file on disk while it is mapped makes accesses beyond
+		the new end fail with SIGBUS.
+	*/
+	class CMappedReadFile : public IReadFile
+	{
+	public:
+
+		virtual ~CMappedReadFile();
+
+		//! returns how much was read
+		virtual s32 read(void* buffer, u32 sizeToRead) _IRR_OVERRIDE_;
+
+		//! changes position in file, returns true if successful
+		virtual bool seek(long finalPos, bool relativeMovement = false) _IRR_OVERRIDE_;
+
+		//! returns size of file
+		virtual long getSize() const _IRR_OVERRIDE_;
+
+		//! returns where in the file we are.
+		virtual long getPos() const _IRR_OVERRIDE_;
+
+		//! returns name of file
+		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
+
+		//! returns the mapped content of the file
+		virtual const void* getData() const _IRR_OVERRIDE_;
+
+		//! maps a file on disk, returns 0 if it can't be mapped
+		/** Empty files and files too large for the address space aren't mapped. */
+		static IReadFile* createMappedReadFile(const io::path& fileName);
+
+	private:
+
+		CMappedReadFile(const io::path& fileName);
+
+		//! maps the file
+		void mapFile();
+
+		const c8* Data;
+		long Size;
+		long Pos;
+		io::path Filename;
+#ifdef _IRR_WINDOWS_API_
+		void* Mapping;
+#endif
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_MAPPED_FILES_
+
+#endif
+
@@ -43,6 +43,9 @@ namespace io
 		//! returns name of file
 		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
 
+		//! returns the memory the file reads from
+		virtual const void* getData() const _IRR_OVERRIDE_;
+
 	private:
 
 		const void *Buffer;
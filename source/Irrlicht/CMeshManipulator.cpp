@@ -969,6 +969,104 @@ bool CMeshManipulator::createUniquePrimitives(IMeshBuffer* srcBuffer, IMeshBuffe
 	return true;
 }
 
+namespace
+{
+
+//! An attribute compared by createWelded
+struct SWeldAttribute
+{
+	u32 Offset;
+	u32 ElementCount;
+	video::E_VERTEX_ATTRIBUTE_TYPE Type;
+};
+
+//! A source vertex in the grid of createWelded
+struct SWeldVertex
+{
+	s32 X, Y, Z;
+	//! previous vertex in the same cell, or -1
+	s32 Next;
+};
+
+template <class T, class V, class Tol>
+inline bool weldComponentsEqual(const u8* a, const u8* b, u32 count, Tol tolerance)
+{
+	const T* valueA = (const T*)a;
+	const T* valueB = (const T*)b;
+
+	for (u32 k = 0; k < count; ++k)
+	{
+		if (!core::equals((V)(valueA[k]), (V)(valueB[k]), tolerance))
+			return false;
+	}
+
+	return true;
+}
+
+bool weldVerticesEqual(const u8* a, const u8* b, const core::array<SWeldAttribute>& attributes, f32 tolerance)
+{
+	for (u32 l = 0; l < attributes.size(); ++l)
+	{
+		const SWeldAttribute& attribute = attributes[l];
+		const u8* valueA = a + attribute.Offset;
+		const u8* valueB = b + attribute.Offset;
+		bool equal = true;
+
+		switch (attribute.Type)
+		{
+		case video::EVAT_BYTE:
+			equal = weldComponentsEqual<s8, s32>(valueA, valueB, attribute.ElementCount, (s32)tolerance);
+			break;
+		case video::EVAT_UBYTE:
+			equal = weldComponentsEqual<u8, u32>(valueA, valueB, attribute.ElementCount, (s32)tolerance);
+			break;
+		case video::EVAT_SHORT:
+			equal = weldComponentsEqual<s16, s32>(valueA, valueB, attribute.ElementCount, (s32)tolerance);
+			break;
+		case video::EVAT_USHORT:
+			equal = weldComponentsEqual<u16, u32>(valueA, valueB, attribute.ElementCount, (s32)tolerance);
+			break;
+		case video::EVAT_INT:
+			equal = weldComponentsEqual<s32, s32>(valueA, valueB, attribute.ElementCount, (s32)tolerance);
+			break;
+		case video::EVAT_UINT:
+			equal = weldComponentsEqual<u32, u32>(valueA, valueB, attribute.ElementCount, (s32)tolerance);
+			break;
+		case video::EVAT_FLOAT:
+			equal = weldComponentsEqual<f32, f32>(valueA, valueB, attribute.ElementCount, (f32)tolerance);
+			break;
+		case video::EVAT_DOUBLE:
+			equal = weldComponentsEqual<f64, f64>(valueA, valueB, attribute.ElementCount, (f64)tolerance);
+			break;
+		default:
+			break;
+		}
+
+		if (!equal)
+			return false;
+	}
+
+	return true;
+}
+
+inline u32 hashWeldCell(s32 x, s32 y, s32 z)
+{
+	return ((u32)x * 73856093u) ^ ((u32)y * 19349663u) ^ ((u32)z * 83492791u);
+}
+
+inline s32 getWeldCell(f32 value, f64 cellSize)
+{
+	// monotonic clamping keeps neighbouring cells neighbours, NaN never welds anyway
+	const f64 cell = floor((f64)value / cellSize);
+	if (!(cell > -2000000000.0))
+		return -2000000000;
+	if (cell > 2000000000.0)
+		return 2000000000;
+	return (s32)cell;
+}
+
+} // end anonymous namespace
+
 // TO-DO: support mesh buffers with more than 1 vertex buffer
 bool CMeshManipulator::createWelded(IMeshBuffer* srcBuffer, IMeshBuffer* dstBuffer, f32 tolerance,
 	bool check4Component, bool check3Component, bool check2Component, bool check1Component) const
@@ -994,8 +1092,6 @@ bool CMeshManipulator::createWelded(IMeshBuffer* srcBuffer, IMeshBuffer* dstBuff
 
 	u8* Vertices = static_cast<u8*>(srcVertexBuffer->getVertices());
 
-	// Create indices.
-
 	bool checkComponents[4] =
 	{
 		check1Component,
@@ -1008,182 +1104,144 @@ bool CMeshManipulator::createWelded(IMeshBuffer* srcBuffer, IMeshBuffer* dstBuff
 
 	const u32 vertexSize = srcVertexBuffer->getVertexSize();
 
-	for (u32 i = 0; i < srcVertexCount; ++i)
-	{
-		bool found = false;
+	// Collect the compared attributes once. The checked float position is
+	// used to put the vertices into a grid, vertices within the tolerance
+	// are in the same or neighbouring cells.
 
-		for (u32 j = 0; j < i; ++j)
-		{
-			bool Equal = true;
-			bool Compare = false;
+	core::array<SWeldAttribute> attributes;
+	s32 positionOffset = -1;
+	u32 positionCount = 0;
 
-			for (u32 l = 0; l < vd->getAttributeCount() && Equal; ++l)
-			{
-				video::IVertexAttribute* attribute = vd->getAttribute(l);
-
-				u32 ElementCount = attribute->getElementCount();
+	for (u32 l = 0; l < vd->getAttributeCount(); ++l)
+	{
+		video::IVertexAttribute* attribute = vd->getAttribute(l);
 
-				if (ElementCount > 4)
-					continue;
+		const u32 ElementCount = attribute->getElementCount();
 
-				const u32 AttributeOffset = attribute->getOffset();
+		if (ElementCount == 0 || ElementCount > 4 || !checkComponents[ElementCount - 1] || attribute->getType() > video::EVAT_DOUBLE)
+			continue;
 
-				switch (attribute->getType())
-				{
-				case video::EVAT_BYTE:
-					{
-						s8* valueA = (s8*)(Vertices + AttributeOffset + vertexSize * i);
-						s8* valueB = (s8*)(Vertices + AttributeOffset + vertexSize * j);
+		SWeldAttribute weld;
+		weld.Offset = attribute->getOffset();
+		weld.ElementCount = ElementCount;
+		weld.Type = attribute->getType();
+		attributes.push_back(weld);
 
-						if (checkComponents[ElementCount - 1])
-						{
-							for (u32 k = 0; k < ElementCount; ++k)
-							{
-								if (!core::equals((s32)(valueA[k]), (s32)(valueB[k]), (s32)tolerance))
-									Equal = false;
-							}
+		if (positionOffset < 0 && attribute->getSemantic() == video::EVAS_POSITION && weld.Type == video::EVAT_FLOAT)
+		{
+			positionOffset = (s32)weld.Offset;
+			positionCount = core::min_(ElementCount, 3u);
+		}
+	}
 
-							Compare = true;
-						}
-					}
-					break;
-				case video::EVAT_UBYTE:
-					{
-						u8* valueA = (u8*)(Vertices + AttributeOffset + vertexSize * i);
-						u8* valueB = (u8*)(Vertices + AttributeOffset + vertexSize * j);
+	// without compared attributes nothing is welded
+	const bool compare = !attributes.empty();
 
-						if (checkComponents[ElementCount - 1])
-						{
-							for (u32 k = 0; k < ElementCount; ++k)
-							{
-								if (!core::equals((u32)(valueA[k]), (u32)(valueB[k]), (s32)tolerance))
-									Equal = false;
-							}
+	core::array<SWeldVertex> grid;
+	grid.set_used(srcVertexCount);
 
-							Compare = true;
-						}
-					}
-					break;
-				case video::EVAT_SHORT:
-					{
-						s16* valueA = (s16*)(Vertices + AttributeOffset + vertexSize * i);
-						s16* valueB = (s16*)(Vertices + AttributeOffset + vertexSize * j);
+	f64 cellSize = 1.0;
 
-						if (checkComponents[ElementCount - 1])
-						{
-							for (u32 k = 0; k < ElementCount; ++k)
-							{
-								if (!core::equals((s32)(valueA[k]), (s32)(valueB[k]), (s32)tolerance))
-									Equal = false;
-							}
+	if (positionOffset >= 0)
+	{
+		// floats compare equal up to the tolerance plus the rounding of their sum
+		f32 maxValue = 0.f;
+		for (u32 i = 0; i < srcVertexCount; ++i)
+		{
+			const f32* pos = (const f32*)(Vertices + vertexSize * i + positionOffset);
+			for (u32 k = 0; k < positionCount; ++k)
+				maxValue = core::max_(maxValue, fabsf(pos[k]));
+		}
 
-							Compare = true;
-						}
-					}
-					break;
-				case video::EVAT_USHORT:
-					{
-						u16* valueA = (u16*)(Vertices + AttributeOffset + vertexSize * i);
-						u16* valueB = (u16*)(Vertices + AttributeOffset + vertexSize * j);
+		cellSize = 2.0 * core::max_(tolerance, 0.f) + 2.0 * maxValue * FLT_EPSILON;
+		if (cellSize <= 0.0)
+			cellSize = 1.0;
+	}
 
-						if (checkComponents[ElementCount - 1])
-						{
-							for (u32 k = 0; k < ElementCount; ++k)
-							{
-								if (!core::equals((u32)(valueA[k]), (u32)(valueB[k]), (s32)tolerance))
-									Equal = false;
-							}
+	for (u32 i = 0; i < srcVertexCount; ++i)
+	{
+		SWeldVertex& v = grid[i];
+		v.X = v.Y = v.Z = 0;
 
-							Compare = true;
-						}
-					}
-					break;
-				case video::EVAT_INT:
-					{
-						s32* valueA = (s32*)(Vertices + AttributeOffset + vertexSize * i);
-						s32* valueB = (s32*)(Vertices + AttributeOffset + vertexSize * j);
+		if (positionOffset >= 0)
+		{
+			const f32* pos = (const f32*)(Vertices + vertexSize * i + positionOffset);
+			v.X = getWeldCell(pos[0], cellSize);
+			if (positionCount > 1)
+				v.Y = getWeldCell(pos[1], cellSize);
+			if (positionCount > 2)
+				v.Z = getWeldCell(pos[2], cellSize);
+		}
+	}
 
-						if (checkComponents[ElementCount - 1])
-						{
-							for (u32 k = 0; k < ElementCount; ++k)
-							{
-								if (!core::equals((s32)(valueA[k]), (s32)(valueB[k]), (s32)tolerance))
-									Equal = false;
-							}
+	// open addressing hash of the cells to the last vertex added to them, plus one
+	u32 slotCount = 16;
+	while (slotCount < srcVertexCount * 2)
+		slotCount <<= 1;
+	const u32 mask = slotCount - 1;
 
-							Compare = true;
-						}
-					}
-					break;
-				case video::EVAT_UINT:
-					{
-						u32* valueA = (u32*)(Vertices + AttributeOffset + vertexSize * i);
-						u32* valueB = (u32*)(Vertices + AttributeOffset + vertexSize * j);
+	core::array<u32> slots;
+	slots.set_used(slotCount);
+	memset(slots.pointer(), 0, slotCount * sizeof(u32));
 
-						if (checkComponents[ElementCount - 1])
-						{
-							for (u32 k = 0; k < ElementCount; ++k)
-							{
-								if (!core::equals((u32)(valueA[k]), (u32)(valueB[k]), (s32)tolerance))
-									Equal = false;
-							}
+	// Create indices.
 
-							Compare = true;
-						}
-					}
-					break;
-				case video::EVAT_FLOAT:
-					{
-						f32* valueA = (f32*)(Vertices + AttributeOffset + vertexSize * i);
-						f32* valueB = (f32*)(Vertices + AttributeOffset + vertexSize * j);
+	for (u32 i = 0; i < srcVertexCount; ++i)
+	{
+		SWeldVertex& v = grid[i];
+		const u8* vertex = Vertices + vertexSize * i;
 
-						if (checkComponents[ElementCount - 1])
-						{
-							for (u32 k = 0; k < ElementCount; ++k)
-							{
-								if (!core::equals((f32)(valueA[k]), (f32)(valueB[k]), (f32)tolerance))
-									Equal = false;
-							}
+		// the first equal vertex before this one, like comparing against all of them
+		u32 match = i;
 
-							Compare = true;
-						}
-					}
-					break;
-				case video::EVAT_DOUBLE:
-					{
-						f64* valueA = (f64*)(Vertices + AttributeOffset + vertexSize * i);
-						f64* valueB = (f64*)(Vertices + AttributeOffset + vertexSize * j);
+		if (compare)
+		{
+			for (s32 z = v.Z - 1; z <= v.Z + 1; ++z)
+			for (s32 y = v.Y - 1; y <= v.Y + 1; ++y)
+			for (s32 x = v.X - 1; x <= v.X + 1; ++x)
+			{
+				if ((positionCount < 3 && z != v.Z) || (positionCount < 2 && y != v.Y) || (positionOffset < 0 && x != v.X))
+					continue;
 
-						if (checkComponents[ElementCount - 1])
-						{
-							for (u32 k = 0; k < ElementCount; ++k)
-							{
-								if (!core::equals((f64)(valueA[k]), (f64)(valueB[k]), (f64)tolerance))
-									Equal = false;
-							}
+				u32 slot = hashWeldCell(x, y, z) & mask;
+				while (slots[slot])
+				{
+					const SWeldVertex& head = grid[slots[slot] - 1];
+					if (head.X == x && head.Y == y && head.Z == z)
+						break;
+					slot = (slot + 1) & mask;
+				}
 
-							Compare = true;
-						}
-					}
-					break;
-				default:
-					break;
+				for (s32 j = (s32)slots[slot] - 1; j >= 0; j = grid[j].Next)
+				{
+					if ((u32)j < match && weldVerticesEqual(vertex, Vertices + vertexSize * j, attributes, tolerance))
+						match = (u32)j;
 				}
 			}
+		}
 
-			if (Equal && Compare)
-			{
-				Redirects[i] = Redirects[j];
-				found = true;
-				break;
-			}
+		if (match < i)
+		{
+			Redirects[i] = Redirects[match];
+		}
+		else
+		{
+			Redirects[i] = dstVertexBuffer->getVertexCount();
+			dstVertexBuffer->addVertex(vertex);
 		}
 
-		if (!found)
+		// add the vertex to its cell
+		u32 slot = hashWeldCell(v.X, v.Y, v.Z) & mask;
+		while (slots[slot])
 		{
-			Redirects[i] = srcVertexCount;
-			dstVertexBuffer->addVertex(Vertices + vertexSize * i);
+			const SWeldVertex& head = grid[slots[slot] - 1];
+			if (head.X == v.X && head.Y == v.Y && head.Z == v.Z)
+				break;
+			slot = (slot + 1) & mask;
 		}
+
+		v.Next = (s32)slots[slot] - 1;
+		slots[slot] = i + 1;
 	}
 
 	for (u32 i = 0; i < srcIndexCount; ++i)
@@ -290,6 +290,7 @@ void CMeshSceneNode::setMesh(IMesh* mesh)
 
 		Mesh = mesh;
 		copyMaterials();
+		invalidate();
 	}
 }
 
@@ -1,6 +1,9 @@
 #include "CMeshTextureLoader.h"
 #include "IFileSystem.h"
 #include "IVideoDriver.h"
+#include "IAssetRequest.h"
+#include "IMesh.h"
+#include "IMeshBuffer.h"
 
 namespace irr
 {
@@ -45,6 +48,15 @@ irr::video::ITexture* CMeshTextureLoader::getTexture(const irr::io::path& textur
 	if ( textureName.empty() || !FileSystem || !VideoDriver)
 		return NULL;
 
+	if ( findTextureName(textureName) )
+		return VideoDriver->getTexture(TextureName);
+
+	return NULL;
+}
+
+bool CMeshTextureLoader::findTextureName(const irr::io::path& textureName)
+{
+
 	// Pre-process texture filename.
 	irr::io::path simplifiedTexName(textureName);
 	simplifiedTexName.replace(_IRR_TEXT('\\'),_IRR_TEXT('/'));
@@ -53,15 +65,15 @@ irr::video::ITexture* CMeshTextureLoader::getTexture(const irr::io::path& textur
 	if ( !TexturePath.empty() )
 	{
 		if ( checkTextureName(TexturePath + simplifiedTexName) )
-			return VideoDriver->getTexture(TextureName);
+			return true;
 
 		if ( checkTextureName(TexturePath + FileSystem->getFileBasename(simplifiedTexName)) )
-			return VideoDriver->getTexture(TextureName);
+			return true;
 	}
 
 	// just the name itself
 	if ( checkTextureName(simplifiedTexName) )
-		return VideoDriver->getTexture(TextureName);
+		return true;
 
 	// look in files relative to the folder of the meshfile
 	if ( MeshFile )
@@ -74,10 +86,10 @@ irr::video::ITexture* CMeshTextureLoader::getTexture(const irr::io::path& textur
 		if ( !MeshPath.empty() )
 		{
 			if ( checkTextureName(MeshPath + simplifiedTexName) )
-				return VideoDriver->getTexture(TextureName);
+				return true;
 
 			if ( checkTextureName(MeshPath + FileSystem->getFileBasename(simplifiedTexName)) )
-				return VideoDriver->getTexture(TextureName);
+				return true;
 		}
 	}
 
@@ -92,19 +104,19 @@ irr::video::ITexture* CMeshTextureLoader::getTexture(const irr::io::path& textur
 		if ( !MaterialPath.empty() )
 		{
 			if ( checkTextureName(MaterialPath + simplifiedTexName) )
-				return VideoDriver->getTexture(TextureName);
+				return true;
 
 			if ( checkTextureName(MaterialPath + FileSystem->getFileBasename(simplifiedTexName)) )
-				return VideoDriver->getTexture(TextureName);
+				return true;
 		}
 	}
 
 	// check current working directory
 	if ( checkTextureName(FileSystem->getFileBasename(simplifiedTexName)) )
-		return VideoDriver->getTexture(TextureName);
+		return true;
 
 	TextureName = _IRR_TEXT("");
-	return NULL;
+	return false;
 }
 
 //! Meshloaders will search paths relative to the meshFile.
@@ -123,5 +135,89 @@ void CMeshTextureLoader::setMaterialFile(const irr::io::IReadFile* materialFile)
 	MaterialPath = _IRR_TEXT("");	// do a lazy evaluation later
 }
 
+
+CDeferredMeshTextureLoader::CDeferredMeshTextureLoader(irr::io::IFileSystem* fs, irr::video::IVideoDriver* driver)
+: CMeshTextureLoader(fs, driver)
+, Requested(false)
+{
+}
+
+CDeferredMeshTextureLoader::~CDeferredMeshTextureLoader()
+{
+	for (u32 i=0; i<Textures.size(); ++i)
+	{
+		Textures[i].Placeholder->drop();
+		if ( Textures[i].Request )
+			Textures[i].Request->drop();
+	}
+}
+
+//! Returns a placeholder for the texture.
+irr::video::ITexture* CDeferredMeshTextureLoader::getTexture(const irr::io::path& textureName)
+{
+	if ( textureName.empty() )
+		return NULL;
+
+	for (u32 i=0; i<Textures.size(); ++i)
+	{
+		if ( Textures[i].Placeholder->getName().getPath() == textureName )
+			return Textures[i].Placeholder;
+	}
+
+	STexture texture;
+	texture.Placeholder = new SPlaceholder(textureName);
+	texture.Request = 0;
+	Textures.push_back(texture);
+
+	return texture.Placeholder;
+}
+
+//! Requests the recorded textures from the video driver on the first call.
+bool CDeferredMeshTextureLoader::requestTextures()
+{
+	if ( !Requested )
+	{
+		// the search uses the file system, so it's done on the main thread as well
+		for (u32 i=0; i<Textures.size(); ++i)
+		{
+			if ( FileSystem && VideoDriver && findTextureName(Textures[i].Placeholder->getName().getPath()) )
+				Textures[i].Request = VideoDriver->requestTexture(TextureName);
+		}
+		Requested = true;
+	}
+
+	for (u32 i=0; i<Textures.size(); ++i)
+	{
+		if ( Textures[i].Request && !Textures[i].Request->isFinished() )
+			return false;
+	}
+
+	return true;
+}
+
+//! Replaces the placeholders in the materials of the mesh with the requested textures.
+void CDeferredMeshTextureLoader::replaceTextures(IMesh* mesh) const
+{
+	if ( Textures.empty() )
+		return;
+
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		video::SMaterial& material = mesh->getMeshBuffer(i)->getMaterial();
+
+		for (u32 layer=0; layer<video::MATERIAL_MAX_TEXTURES; ++layer)
+		{
+			for (u32 t=0; t<Textures.size(); ++t)
+			{
+				if ( material.getTexture(layer) == Textures[t].Placeholder )
+				{
+					material.setTexture(layer, Textures[t].Request ? Textures[t].Request->getTexture() : 0);
+					break;
+				}
+			}
+		}
+	}
+}
+
 } // end namespace scnene
 } // end namespace irr
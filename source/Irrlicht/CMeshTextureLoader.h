@@ -2,12 +2,15 @@
 #define IRR_C_MESH_TEXTURE_LOADER_H_INCLUDED
 
 #include "IMeshTextureLoader.h"
+#include "ITexture.h"
+#include "irrArray.h"
 
 namespace irr
 {
 namespace io
 {
 	class IFileSystem;
+	class IAssetRequest;
 } // end namespace io
 namespace video
 {
@@ -16,6 +19,7 @@ namespace video
 
 namespace scene
 {
+	class IMesh;
 
 class CMeshTextureLoader : public IMeshTextureLoader
 {
@@ -63,7 +67,9 @@ protected:
 	// Save the texturename when it's a an existing file
 	bool checkTextureName( const irr::io::path& filename);
 
-private:
+	// Search all paths for the texture, the file found is in TextureName
+	bool findTextureName( const irr::io::path& textureName);
+
 	irr::io::IFileSystem * FileSystem;
 	irr::video::IVideoDriver* VideoDriver;
 	irr::io::path TexturePath;
@@ -74,6 +80,48 @@ private:
 	irr::io::path TextureName;
 };
 
+//! Records the textures of a mesh which is created on a worker thread.
+/** getTexture only returns placeholders, so the mesh loader doesn't touch the
+video driver. The textures are searched and requested later on the main thread
+with requestTextures, replaceTextures puts them into the materials of the mesh. */
+class CDeferredMeshTextureLoader : public CMeshTextureLoader
+{
+public:
+	CDeferredMeshTextureLoader(irr::io::IFileSystem* fs, irr::video::IVideoDriver* driver);
+
+	virtual ~CDeferredMeshTextureLoader();
+
+	//! Returns a placeholder for the texture.
+	virtual irr::video::ITexture* getTexture(const irr::io::path& textureName)  _IRR_OVERRIDE_;
+
+	//! Requests the recorded textures from the video driver on the first call.
+	/** \return True when all requests are finished. */
+	bool requestTextures();
+
+	//! Replaces the placeholders in the materials of the mesh with the requested textures.
+	/** Placeholders of textures which couldn't be loaded are replaced by 0. */
+	void replaceTextures(IMesh* mesh) const;
+
+private:
+	struct SPlaceholder : public video::ITexture
+	{
+		SPlaceholder(const io::path& name) : ITexture(name) {};
+
+		virtual void* lock(video::E_TEXTURE_LOCK_MODE mode=video::ETLM_READ_WRITE, u32 mipmapLevel=0) _IRR_OVERRIDE_ { return 0; }
+		virtual void unlock()_IRR_OVERRIDE_ {}
+		virtual void regenerateMipMapLevels(void* mipmapData=0) _IRR_OVERRIDE_ {}
+	};
+
+	struct STexture
+	{
+		SPlaceholder* Placeholder;
+		io::IAssetRequest* Request;
+	};
+
+	core::array<STexture> Textures;
+	bool Requested;
+};
+
 } // end namespace scene
 } // end namespace irr
 
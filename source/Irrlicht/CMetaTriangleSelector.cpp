@@ -95,6 +95,52 @@ void CMetaTriangleSelector::getTriangles(core::triangle3df* triangles, s32 array
 }
 
 
+//! Check if all selectors in the collection find intersections with lines by themselves.
+bool CMetaTriangleSelector::hasIntersectionWithLine() const
+{
+	if (TriangleSelectors.empty())
+		return false;
+
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+		if (!TriangleSelectors[i]->hasIntersectionWithLine())
+			return false;
+
+	return true;
+}
+
+
+//! Get the nearest intersection of a 3d line with the triangles of all selectors.
+bool CMetaTriangleSelector::getIntersectionWithLine(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		ISceneNode*& outNode) const
+{
+	f32 nearest = FLT_MAX;
+	bool found = false;
+
+	core::vector3df intersection;
+	core::triangle3df triangle;
+	ISceneNode* node = 0;
+
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (!TriangleSelectors[i]->getIntersectionWithLine(line, intersection, triangle, node))
+			continue;
+
+		const f32 distance = intersection.getDistanceFromSQ(line.start);
+		if (distance < nearest)
+		{
+			nearest = distance;
+			outIntersection = intersection;
+			outTriangle = triangle;
+			outNode = node;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+
 //! Adds a triangle selector to the collection of triangle selectors
 //! in this metaTriangleSelector.
 void CMetaTriangleSelector::addTriangleSelector(ITriangleSelector* toAdd)
@@ -41,6 +41,14 @@ public:
 		s32& outTriangleCount, const core::line3d<f32>& line,
 		const core::matrix4* transform=0) const _IRR_OVERRIDE_;
 
+	//! Check if all selectors in the collection find intersections with lines by themselves.
+	virtual bool hasIntersectionWithLine() const _IRR_OVERRIDE_;
+
+	//! Get the nearest intersection of a 3d line with the triangles of all selectors.
+	virtual bool getIntersectionWithLine(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		ISceneNode*& outNode) const _IRR_OVERRIDE_;
+
 	//! Adds a triangle selector to the collection of triangle selectors
 	//! in this metaTriangleSelector.
 	virtual void addTriangleSelector(ITriangleSelector* toAdd) _IRR_OVERRIDE_;
@@ -16,6 +16,8 @@
 #include "CColorConverter.h"
 #include "IAttributeExchangingObject.h"
 #include "CVertexDescriptor.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 
 namespace irr
@@ -81,16 +83,89 @@ IImageWriter* createImageWriterPNG();
 //! creates a writer which is able to save ppm images
 IImageWriter* createImageWriterPPM();
 
+namespace
+{
+	//! Decodes the image on a worker thread and creates the texture on the main thread.
+	class CTextureRequest : public io::CAssetRequest
+	{
+	public:
+
+		CTextureRequest(IVideoDriver* driver, const io::path& name, io::IReadFile* file)
+			: io::CAssetRequest(name, file), Driver(driver), Image(0)
+		{
+		}
+
+		virtual ~CTextureRequest()
+		{
+			if (Image)
+				Image->drop();
+		}
+
+		virtual void load() _IRR_OVERRIDE_
+		{
+			Image = Driver->createImageFromFile(File);
+		}
+
+		virtual bool finish() _IRR_OVERRIDE_
+		{
+			// the texture might have been loaded by getTexture in the meantime
+			ITexture* texture = Driver->findTexture(File->getFileName());
+			if (texture)
+				texture->updateSource(ETS_FROM_CACHE);
+			else if (Image)
+			{
+				texture = Driver->addTexture(File->getFileName(), Image);
+				if (texture)
+				{
+					texture->updateSource(ETS_FROM_FILE);
+					os::Printer::log("Loaded texture", File->getFileName());
+				}
+			}
+
+			if (Image)
+			{
+				Image->drop();
+				Image = 0;
+			}
+
+			if (!texture)
+				os::Printer::log("Could not load texture", Name, ELL_ERROR);
+			setTexture(texture);
+			return true;
+		}
+
+	private:
+
+		IVideoDriver* Driver;
+		IImage* Image;
+	};
+} // end anonymous namespace
+
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
 : FileSystem(io), MeshManipulator(0), ViewPort(0,0,0,0), ScreenSize(screenSize),
 	PrimitivesDrawn(0), MinVertexCountForVBO(500), TextureCreationFlags(0),
-	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
+	OverrideMaterial2DEnabled(false), Batch2DTexture(0), Batch2DAlpha(false),
+	Batch2DAlphaChannel(false), Batch2DEnabled(true), Batch2DDrawing(false), Batch2DCount(0),
+	AllowZWriteOnTransparent(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CNullDriver");
 	#endif
 
+	TextureLoader = new io::CAssetLoader();
+
+	IRR_PROFILE(
+		static bool initProfile = false;
+		if (!initProfile )
+		{
+			initProfile = true;
+			getProfiler().add(EPID_VD_DRAW_CALLS, L"draw calls", L"Irrlicht video");
+			getProfiler().add(EPID_VD_STATE_CHANGES, L"state changes", L"Irrlicht video");
+			getProfiler().add(EPID_VD_UPLOADED_BYTES, L"uploaded bytes", L"Irrlicht video");
+		}
+	)
+
 	DriverAttributes = new io::CAttributes();
 	DriverAttributes->addInt("MaxTextures", _IRR_MATERIAL_MAX_TEXTURES_);
 	DriverAttributes->addInt("MaxSupportedTextures", _IRR_MATERIAL_MAX_TEXTURES_);
@@ -206,6 +281,9 @@ CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& scre
 //! destructor
 CNullDriver::~CNullDriver()
 {
+	// wait for the image loaders used by the requests
+	delete TextureLoader;
+
 	if (DriverAttributes)
 		DriverAttributes->drop();
 
@@ -214,6 +292,7 @@ CNullDriver::~CNullDriver()
 
 	if (MeshManipulator)
 		MeshManipulator->drop();
+
 	deleteAllTextures();
 
 	u32 i;
@@ -328,6 +407,9 @@ void CNullDriver::deleteAllTextures()
 	// last set material member. Could be optimized to reduce state changes.
 	setMaterial(SMaterial());
 
+	// the batched quads can't be drawn anymore
+	Batch2DVertices.set_used(0);
+
 	for (u32 i=0; i<Textures.size(); ++i)
 		Textures[i].Surface->drop();
 
@@ -341,7 +423,10 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 		const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
 {
 	core::clearFPUException();
+	flush2DBatch();
 	PrimitivesDrawn = 0;
+	Batch2DCount = 0;
+	TextureLoader->update();
 	return true;
 }
 
@@ -349,8 +434,10 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 //! applications must call this method after performing any rendering. returns false if failed.
 bool CNullDriver::endScene()
 {
+	flush2DBatch();
 	FPSCounter.registerFrame(os::Timer::getRealTime(), PrimitivesDrawn);
 	updateAllOcclusionQueries();
+	IRR_PROFILE(getProfiler().markFrame();)
 	return true;
 }
 
@@ -402,6 +489,9 @@ void CNullDriver::removeTexture(ITexture* texture)
 	if (!texture)
 		return;
 
+	if (texture == Batch2DTexture)
+		flush2DBatch();
+
 	for (u32 i=0; i<Textures.size(); ++i)
 	{
 		if (Textures[i].Surface == texture)
@@ -417,6 +507,7 @@ void CNullDriver::removeTexture(ITexture* texture)
 //! memory.
 void CNullDriver::removeAllTextures()
 {
+	flush2DBatch();
 	setMaterial ( SMaterial() );
 	deleteAllTextures();
 }
@@ -547,6 +638,55 @@ ITexture* CNullDriver::getTexture(io::IReadFile* file)
 }
 
 
+//! loads a Texture in the background
+io::IAssetRequest* CNullDriver::requestTexture(const io::path& filename)
+{
+	// same lookup as getTexture
+	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
+
+	ITexture* texture = findTexture(absolutePath);
+	if (!texture)
+		texture = findTexture(filename);
+
+	io::IReadFile* file = 0;
+	if (!texture)
+	{
+		file = FileSystem->createAndOpenFile(absolutePath);
+		if (!file)
+			file = FileSystem->createAndOpenFile(filename);
+		if (file)
+			texture = findTexture(file->getFileName());
+	}
+
+	io::CAssetRequest* request = new CTextureRequest(this, filename, texture ? 0 : file);
+
+	if (texture)
+	{
+		texture->updateSource(ETS_FROM_CACHE);
+		request->setTexture(texture);
+	}
+	else if (file)
+		TextureLoader->add(request);
+	else
+	{
+		os::Printer::log("Could not open file of texture", filename, ELL_WARNING);
+		request->setFailed();
+	}
+
+	if (file)
+		file->drop();
+
+	return request;
+}
+
+
+//! Set the time beginScene() may spend creating requested textures
+void CNullDriver::setTextureLoadBudget(u32 milliseconds)
+{
+	TextureLoader->setBudget(milliseconds);
+}
+
+
 //! opens the file and loads it into the surface
 video::ITexture* CNullDriver::loadTextureFromFile(io::IReadFile* file, const io::path& hashName )
 {
@@ -878,6 +1018,10 @@ void CNullDriver::draw2DImage(const video::ITexture* texture, const core::positi
 				const core::rect<s32>* clipRect, SColor color,
 				bool useAlphaChannelOfTexture)
 {
+	if (!texture)
+		return;
+
+	add2DImageQuad(texture, destPos, sourceRect, clipRect, color, useAlphaChannelOfTexture);
 }
 
 
@@ -920,6 +1064,195 @@ void CNullDriver::draw2DRectangle(const core::rect<s32>& pos,
 	SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 	const core::rect<s32>* clip)
 {
+	add2DRectangleQuad(pos, colorLeftUp, colorRightUp, colorLeftDown, colorRightDown, clip);
+}
+
+
+//! adds a part of a texture to the 2d batch, clipped against clipRect and the render target
+void CNullDriver::add2DImageQuad(const video::ITexture* texture, const core::position2d<s32>& pos,
+	const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+	SColor color, bool useAlphaChannelOfTexture)
+{
+	if (!sourceRect.isValid())
+		return;
+
+	core::position2d<s32> targetPos(pos);
+	core::position2d<s32> sourcePos(sourceRect.UpperLeftCorner);
+	// This needs to be signed as it may go negative.
+	core::dimension2d<s32> sourceSize(sourceRect.getSize());
+
+	core::rect<s32> clip(core::position2d<s32>(0,0), core::dimension2di(getCurrentRenderTargetSize()));
+	if (clipRect)
+		clip.clipAgainst(*clipRect);
+
+	if (targetPos.X < clip.UpperLeftCorner.X)
+	{
+		sourceSize.Width += targetPos.X - clip.UpperLeftCorner.X;
+		sourcePos.X -= targetPos.X - clip.UpperLeftCorner.X;
+		targetPos.X = clip.UpperLeftCorner.X;
+	}
+
+	if (targetPos.X + sourceSize.Width > clip.LowerRightCorner.X)
+		sourceSize.Width = clip.LowerRightCorner.X - targetPos.X;
+
+	if (targetPos.Y < clip.UpperLeftCorner.Y)
+	{
+		sourceSize.Height += targetPos.Y - clip.UpperLeftCorner.Y;
+		sourcePos.Y -= targetPos.Y - clip.UpperLeftCorner.Y;
+		targetPos.Y = clip.UpperLeftCorner.Y;
+	}
+
+	if (targetPos.Y + sourceSize.Height > clip.LowerRightCorner.Y)
+		sourceSize.Height = clip.LowerRightCorner.Y - targetPos.Y;
+
+	if (sourceSize.Width <= 0 || sourceSize.Height <= 0)
+		return;
+
+	const core::dimension2d<u32>& ss = texture->getOriginalSize();
+	const f32 invW = 1.f / static_cast<f32>(ss.Width);
+	const f32 invH = 1.f / static_cast<f32>(ss.Height);
+	const core::rect<f32> tcoords(
+			sourcePos.X * invW,
+			sourcePos.Y * invH,
+			(sourcePos.X + sourceSize.Width) * invW,
+			(sourcePos.Y + sourceSize.Height) * invH);
+
+	const core::rect<s32> poss(targetPos, sourceSize);
+
+	S3DVertex vertices[4];
+	vertices[0] = S3DVertex((f32)poss.UpperLeftCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f,
+		0.0f, 0.0f, 0.0f, color, tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
+	vertices[1] = S3DVertex((f32)poss.LowerRightCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f,
+		0.0f, 0.0f, 0.0f, color, tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
+	vertices[2] = S3DVertex((f32)poss.LowerRightCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f,
+		0.0f, 0.0f, 0.0f, color, tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
+	vertices[3] = S3DVertex((f32)poss.UpperLeftCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f,
+		0.0f, 0.0f, 0.0f, color, tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
+
+	add2DQuad(texture, color.getAlpha() < 255, useAlphaChannelOfTexture, vertices);
+}
+
+
+//! adds a rectangle to the 2d batch, clipped against clip and the render target
+void CNullDriver::add2DRectangleQuad(const core::rect<s32>& position,
+	SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
+	const core::rect<s32>* clip)
+{
+	core::rect<s32> pos = position;
+
+	if (clip)
+		pos.clipAgainst(*clip);
+
+	pos.clipAgainst(core::rect<s32>(core::position2d<s32>(0,0), core::dimension2di(getCurrentRenderTargetSize())));
+
+	if (!pos.isValid() || pos.getArea() == 0)
+		return;
+
+	S3DVertex vertices[4];
+	vertices[0] = S3DVertex((f32)pos.UpperLeftCorner.X, (f32)pos.UpperLeftCorner.Y, 0.0f,
+		0.0f, 0.0f, 0.0f, colorLeftUp, 0.0f, 0.0f);
+	vertices[1] = S3DVertex((f32)pos.LowerRightCorner.X, (f32)pos.UpperLeftCorner.Y, 0.0f,
+		0.0f, 0.0f, 0.0f, colorRightUp, 0.0f, 0.0f);
+	vertices[2] = S3DVertex((f32)pos.LowerRightCorner.X, (f32)pos.LowerRightCorner.Y, 0.0f,
+		0.0f, 0.0f, 0.0f, colorRightDown, 0.0f, 0.0f);
+	vertices[3] = S3DVertex((f32)pos.UpperLeftCorner.X, (f32)pos.LowerRightCorner.Y, 0.0f,
+		0.0f, 0.0f, 0.0f, colorLeftDown, 0.0f, 0.0f);
+
+	add2DQuad(0, colorLeftUp.getAlpha() < 255 || colorRightUp.getAlpha() < 255 ||
+		colorLeftDown.getAlpha() < 255 || colorRightDown.getAlpha() < 255, false, vertices);
+}
+
+
+//! adds 4 vertices in clockwise order to the 2d batch, draws the batch first if the texture changed
+void CNullDriver::add2DQuad(const video::ITexture* texture, bool alpha, bool alphaChannel, const S3DVertex* vertices)
+{
+	// no alphaChannel without texture
+	alphaChannel &= texture != 0;
+
+	// 16 bit indices
+	if (Batch2DVertices.size() + 4 > 65536 ||
+		(!Batch2DVertices.empty() && (texture != Batch2DTexture || alphaChannel != Batch2DAlphaChannel)))
+		flush2DBatch();
+
+	if (Batch2DVertices.empty())
+	{
+		Batch2DTexture = texture;
+		Batch2DAlpha = false;
+		Batch2DAlphaChannel = alphaChannel;
+	}
+
+	// quads which are not transparent look the same with blending
+	Batch2DAlpha |= alpha;
+
+	for (u32 i=0; i<4; ++i)
+		Batch2DVertices.push_back(vertices[i]);
+
+	const u32 quadCount = Batch2DVertices.size() / 4;
+	while (Batch2DIndices.size() < quadCount * 6)
+	{
+		const u16 first = (u16)(Batch2DIndices.size() / 6 * 4);
+		Batch2DIndices.push_back(first);
+		Batch2DIndices.push_back(first + 1);
+		Batch2DIndices.push_back(first + 2);
+		Batch2DIndices.push_back(first);
+		Batch2DIndices.push_back(first + 2);
+		Batch2DIndices.push_back(first + 3);
+	}
+
+	if (!Batch2DEnabled)
+		flush2DBatch();
+}
+
+
+//! draws quads of the 2d batch
+void CNullDriver::draw2DBatch(const video::ITexture* texture, bool alpha, bool alphaChannel,
+	const S3DVertex* vertices, u32 quadCount)
+{
+}
+
+
+//! Enable collecting 2d images and rectangles into batches
+void CNullDriver::enable2DBatching(bool enable)
+{
+	if (!enable)
+		flush2DBatch();
+
+	Batch2DEnabled = enable;
+}
+
+
+//! Check if 2d images and rectangles are collected into batches
+bool CNullDriver::is2DBatchingEnabled() const
+{
+	return Batch2DEnabled;
+}
+
+
+//! Draw the collected 2d images and rectangles
+void CNullDriver::flush2DBatch()
+{
+	// the driver may flush again while drawing, e.g. when it changes the texture
+	if (Batch2DVertices.empty() || Batch2DDrawing)
+		return;
+
+	const u32 quadCount = Batch2DVertices.size() / 4;
+
+	Batch2DDrawing = true;
+	draw2DBatch(Batch2DTexture, Batch2DAlpha, Batch2DAlphaChannel, Batch2DVertices.const_pointer(), quadCount);
+	Batch2DDrawing = false;
+
+	Batch2DVertices.set_used(0);
+
+	PrimitivesDrawn += quadCount * 2;
+	++Batch2DCount;
+	IRR_PROFILE(getProfiler().count(EPID_VD_DRAW_CALLS);)
+}
+
+
+//! Get the number of 2d batches drawn since the scene began
+u32 CNullDriver::get2DBatchCount() const
+{
+	return Batch2DCount;
 }
 
 
@@ -1401,6 +1734,26 @@ bool CNullDriver::checkPrimitiveCount(u32 prmCount) const
 	return true;
 }
 
+
+//! returns the number of primitives made of some indices
+u32 CNullDriver::getPrimitiveCount(scene::E_PRIMITIVE_TYPE primitiveType, u32 indexCount)
+{
+	switch (primitiveType)
+	{
+	case scene::EPT_LINE_STRIP:
+		return indexCount > 1 ? indexCount - 1 : 0;
+	case scene::EPT_LINES:
+		return indexCount / 2;
+	case scene::EPT_TRIANGLE_STRIP:
+	case scene::EPT_TRIANGLE_FAN:
+		return indexCount > 2 ? indexCount - 2 : 0;
+	case scene::EPT_TRIANGLES:
+		return indexCount / 3;
+	default:
+		return indexCount;
+	}
+}
+
 //! Enables or disables a texture creation flag.
 void CNullDriver::setTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag, bool enabled)
 {
@@ -1651,6 +2004,7 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
 
 	PrimitivesDrawn += mb->getPrimitiveCount();
+	IRR_PROFILE(getProfiler().count(EPID_VD_DRAW_CALLS);)
 
 
 	/*
@@ -1663,6 +2017,21 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws a range of the indices of a mesh buffer
+void CNullDriver::drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount)
+{
+	if (!mb || !mb->isVertexBufferCompatible())
+		return;
+
+	const u32 primitiveCount = getPrimitiveCount(mb->getPrimitiveType(), indexCount);
+	if (!primitiveCount || firstIndex + indexCount > mb->getIndexBuffer()->getIndexCount())
+		return;
+
+	PrimitivesDrawn += primitiveCount;
+	IRR_PROFILE(getProfiler().count(EPID_VD_DRAW_CALLS);)
+}
+
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length, SColor color)
 {
@@ -2572,6 +2941,9 @@ IVideoDriver* createNullDriver(io::IFileSystem* io, const core::dimension2d<u32>
 		imr->drop();
 	}
 
+	// mesh buffers need the standard vertex descriptors
+	nullDriver->createVertexDescriptors();
+
 	return nullDriver;
 }
 
@@ -2626,10 +2998,18 @@ SMaterial& CNullDriver::getMaterial2D()
 //! Enable the 2d override material
 void CNullDriver::enableMaterial2D(bool enable)
 {
+	flush2DBatch();
 	OverrideMaterial2DEnabled=enable;
 }
 
 
+//! Check if the 2d override material is enabled
+bool CNullDriver::isMaterial2DEnabled() const
+{
+	return OverrideMaterial2DEnabled;
+}
+
+
 core::dimension2du CNullDriver::getMaxTextureSize() const
 {
 	return core::dimension2du(0x10000,0x10000); // maybe large enough
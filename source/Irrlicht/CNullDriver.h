@@ -21,6 +21,7 @@
 #include "S3DVertex.h"
 #include "SLight.h"
 #include "SExposedVideoData.h"
+#include "CAssetLoader.h"
 
 #ifdef _MSC_VER
 #pragma warning( disable: 4996)
@@ -90,6 +91,12 @@ namespace video
 		//! loads a Texture
 		virtual ITexture* getTexture(io::IReadFile* file) _IRR_OVERRIDE_;
 
+		//! loads a Texture in the background
+		virtual io::IAssetRequest* requestTexture(const io::path& filename) _IRR_OVERRIDE_;
+
+		//! Set the time beginScene() may spend creating requested textures
+		virtual void setTextureLoadBudget(u32 milliseconds) _IRR_OVERRIDE_;
+
 		//! Returns a texture by index
 		virtual ITexture* getTextureByIndex(u32 index) _IRR_OVERRIDE_;
 
@@ -372,6 +379,9 @@ namespace video
 		//! Draws a mesh buffer
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
 
+		//! Draws a range of the indices of a mesh buffer
+		virtual void drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount) _IRR_OVERRIDE_;
+
 		//! Draws the normals of a mesh buffer
 		virtual void drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length=10.f,
 			SColor color=0xffffffff) _IRR_OVERRIDE_;
@@ -597,6 +607,21 @@ namespace video
 		//! Enable the 2d override material
 		virtual void enableMaterial2D(bool enable=true) _IRR_OVERRIDE_;
 
+		//! Check if the 2d override material is enabled
+		virtual bool isMaterial2DEnabled() const _IRR_OVERRIDE_;
+
+		//! Enable collecting 2d images and rectangles into batches
+		virtual void enable2DBatching(bool enable=true) _IRR_OVERRIDE_;
+
+		//! Check if 2d images and rectangles are collected into batches
+		virtual bool is2DBatchingEnabled() const _IRR_OVERRIDE_;
+
+		//! Draw the collected 2d images and rectangles
+		virtual void flush2DBatch() _IRR_OVERRIDE_;
+
+		//! Get the number of 2d batches drawn since the scene began
+		virtual u32 get2DBatchCount() const _IRR_OVERRIDE_;
+
 		//! Only used by the engine internally.
 		virtual void setAllowZWriteOnTransparent(bool flag) _IRR_OVERRIDE_
 		{ AllowZWriteOnTransparent=flag; }
@@ -643,6 +668,28 @@ namespace video
 		//! checks triangle count and print warning if wrong
 		bool checkPrimitiveCount(u32 prmcnt) const;
 
+		//! adds a part of a texture to the 2d batch, clipped against clipRect and the render target
+		void add2DImageQuad(const video::ITexture* texture, const core::position2d<s32>& pos,
+			const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+			SColor color, bool useAlphaChannelOfTexture);
+
+		//! adds a rectangle to the 2d batch, clipped against clip
+		void add2DRectangleQuad(const core::rect<s32>& pos,
+			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
+			const core::rect<s32>* clip);
+
+		//! adds 4 vertices in clockwise order to the 2d batch, draws the batch first if the texture changed
+		/** Without batching the quad is drawn immediately. */
+		void add2DQuad(const video::ITexture* texture, bool alpha, bool alphaChannel, const S3DVertex* vertices);
+
+		//! draws quads of the 2d batch, the indices are in Batch2DIndices
+		//! HAS TO BE OVERRIDDEN BY DERIVED DRIVERS WHICH USE THE 2D BATCH
+		virtual void draw2DBatch(const video::ITexture* texture, bool alpha, bool alphaChannel,
+			const S3DVertex* vertices, u32 quadCount);
+
+		//! returns the number of primitives made of some indices
+		static u32 getPrimitiveCount(scene::E_PRIMITIVE_TYPE primitiveType, u32 indexCount);
+
 		// adds a material renderer and drops it afterwards. To be used for internal creation
 		s32 addAndDropMaterialRenderer(IMaterialRenderer* m);
 
@@ -698,6 +745,8 @@ namespace video
 		};
 		core::array<SSurface> Textures;
 
+		io::CAssetLoader* TextureLoader;
+
 		struct SOccQuery
 		{
 			SOccQuery(scene::ISceneNode* node, const scene::IMesh* mesh=0) : Node(node), Mesh(mesh), PID(0), Result(0xffffffff), Run(0xffffffff)
@@ -773,6 +822,7 @@ namespace video
 		CFPSCounter FPSCounter;
 
 		u32 PrimitivesDrawn;
+
 		u32 MinVertexCountForVBO;
 
 		u32 TextureCreationFlags;
@@ -790,6 +840,18 @@ namespace video
 		SMaterial InitMaterial2D;
 		bool OverrideMaterial2DEnabled;
 
+		//! 2d quads which are drawn with one call
+		core::array<S3DVertex> Batch2DVertices;
+		//! two triangles per quad, for as many quads as were batched so far
+		core::array<u16> Batch2DIndices;
+		const video::ITexture* Batch2DTexture;
+		bool Batch2DAlpha;
+		bool Batch2DAlphaChannel;
+		bool Batch2DEnabled;
+		//! set while draw2DBatch draws Batch2DVertices
+		bool Batch2DDrawing;
+		u32 Batch2DCount;
+
 		E_FOG_TYPE FogType;
 		bool PixelFog;
 		bool RangeFog;
@@ -89,9 +89,16 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	const io::path fullName = file->getFileName();
 	const io::path relPath = FileSystem->getFileDir(fullName)+"/";
 
-	c8* buf = new c8[filesize];
-	memset(buf, 0, filesize);
-	file->read((void*)buf, filesize);
+	// parse the file in place if it is already in memory
+	c8* fileBuf = 0;
+	const c8* buf = (const c8*)file->getData();
+	if (!buf)
+	{
+		fileBuf = new c8[filesize];
+		memset(fileBuf, 0, filesize);
+		file->read((void*)fileBuf, filesize);
+		buf = fileBuf;
+	}
 	const c8* const bufEnd = buf+filesize;
 
 	// Process obj information
@@ -236,7 +243,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 				else
 				{
 					os::Printer::log("Invalid vertex index in this line:", wordBuffer.c_str(), ELL_ERROR);
-					delete [] buf;
+					delete [] fileBuf;
 					return 0;
 				}
 				if ( -1 != Idx[1] && Idx[1] < (irr::s32)textureCoordBuffer.size() )
@@ -331,7 +338,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	}
 
 	// Clean up the allocate obj file contents
-	delete [] buf;
+	delete [] fileBuf;
 	// more cleaning up
 	cleanUp();
 	mesh->drop();
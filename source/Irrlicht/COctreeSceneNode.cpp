@@ -27,7 +27,7 @@ COctreeSceneNode::COctreeSceneNode(const core::array<scene::IMeshBuffer*>& meshe
 					ISceneManager* mgr, s32 id, s32 minimalPolysPerNode)
 	: IMeshSceneNode(parent, mgr, id), StdOctree(0), MinimalPolysPerNode(minimalPolysPerNode), Mesh(0), Shadow(0),
 	UseVBOs(OCTREE_USE_HARDWARE), UseVisibilityAndVBOs(OCTREE_USE_VISIBILITY),
-	BoxBased(OCTREE_BOX_BASED)
+	BoxBased(OCTREE_BOX_BASED), UseIndexRanges(OCTREE_USE_INDEX_RANGES), IndexRangesSorted(false)
 {
 #ifdef _DEBUG
 	setDebugName("COctreeSceneNode");
@@ -139,7 +139,14 @@ void COctreeSceneNode::render()
 
 	IRR_PROFILE(getProfiler().start(EPID_OC_CALCPOLYS));
 	
-	if (BoxBased)
+	if (IndexRangesSorted)
+	{
+		if (BoxBased)
+			StdOctree->calculateRanges(box);
+		else
+			StdOctree->calculateRanges(frust);
+	}
+	else if (BoxBased)
 		StdOctree->calculatePolys(box);
 	else
 		StdOctree->calculatePolys(frust);
@@ -147,10 +154,11 @@ void COctreeSceneNode::render()
 	IRR_PROFILE(getProfiler().stop(EPID_OC_CALCPOLYS));
 
 	const Octree::SIndexData* d = StdOctree->getIndexData();
+	const core::array<Octree::SIndexRange>* ranges = StdOctree->getIndexRanges();
 
 	for (u32 i=0; i<Materials.size(); ++i)
 	{
-		if ( 0 == d[i].CurrentSize )
+		if (IndexRangesSorted ? ranges[i].empty() : 0 == d[i].CurrentSize)
 			continue;
 
 		const video::IMaterialRenderer* const rnd = driver->getMaterialRenderer(Materials[i].MaterialType);
@@ -162,7 +170,12 @@ void COctreeSceneNode::render()
 		{
 			driver->setMaterial(Materials[i]);
 
-			if (!UseVBOs || (UseVBOs && UseVisibilityAndVBOs))
+			if (IndexRangesSorted)
+			{
+				for (u32 r=0; r<ranges[i].size(); ++r)
+					driver->drawMeshBufferRange(StdMeshes[i], ranges[i][r].First, ranges[i][r].Count);
+			}
+			else if (!UseVBOs || (UseVBOs && UseVisibilityAndVBOs))
 			{
 				scene::IIndexBuffer* oldBuffer = StdMeshes[i]->getIndexBuffer();
 				oldBuffer->grab();
@@ -326,6 +339,14 @@ bool COctreeSceneNode::createTree(IMesh* mesh)
 
 		StdOctree = new Octree(StdMeshes, StdMeshesMatID, MinimalPolysPerNode);
 		nodeCount = StdOctree->getNodeCount();
+
+		// visible parts are drawn from the whole buffers, which never change
+		IndexRangesSorted = UseIndexRanges && StdOctree->sortIndices(StdMeshes);
+		if (IndexRangesSorted)
+		{
+			for (i=0; i<StdMeshes.size(); ++i)
+				StdMeshes[i]->setHardwareMappingHint(scene::EHM_STATIC);
+		}
 	}
 
 	const u32 endTime = os::Timer::getRealTime();
@@ -403,6 +424,7 @@ void COctreeSceneNode::deleteTree()
 		delete StdOctree;
 
 	StdOctree = 0;
+	IndexRangesSorted = false;
 	StdMeshesMatID.clear();
 
 	Materials.clear();
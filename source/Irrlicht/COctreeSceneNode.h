@@ -100,6 +100,10 @@ namespace scene
 		bool UseVisibilityAndVBOs;
 		//! use bounding box or frustum for calculate polys
 		bool BoxBased;
+		//! sort the indices by octree node and draw ranges of them
+		bool UseIndexRanges;
+		//! the indices of the buffers are sorted, they are static now
+		bool IndexRangesSorted;
 	};
 
 } // end namespace scene
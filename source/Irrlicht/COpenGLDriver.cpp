@@ -16,6 +16,8 @@
 #include "COpenGLNormalMapRenderer.h"
 #include "COpenGLParallaxMapRenderer.h"
 #include "os.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 #ifdef _IRR_COMPILE_WITH_OSX_DEVICE_
 #include "MacOSX/CIrrDeviceMacOSX.h"
@@ -113,6 +115,14 @@ void COpenGLVertexDescriptor::setID(u32 id)
 	ID = id;
 }
 
+void COpenGLVertexDescriptor::lockReferenceCount(bool lock) const
+{
+	if (lock)
+		ReferenceMutex.lock();
+	else
+		ReferenceMutex.unlock();
+}
+
 IVertexAttribute* COpenGLVertexDescriptor::addAttribute(const core::stringc& name, u32 elementCount, E_VERTEX_ATTRIBUTE_SEMANTIC semantic, E_VERTEX_ATTRIBUTE_TYPE type, u32 bufferID)
 {
 	for (u32 i = 0; i < Attribute.size(); ++i)
@@ -244,12 +254,9 @@ COpenGLHardwareBuffer::~COpenGLHardwareBuffer()
 
 bool COpenGLHardwareBuffer::update(const scene::E_HARDWARE_MAPPING mapping, const u32 size, const void* data)
 {
-	u32 oldSize = Size;
-
 	Mapping = mapping;
-	Size = size;
 
-	if (Mapping == scene::EHM_NEVER || Size == 0 || !data || !Driver || !Driver->FeatureAvailable[COpenGLDriver::IRR_ARB_vertex_buffer_object])
+	if (Mapping == scene::EHM_NEVER || size == 0 || !data || !Driver || !Driver->FeatureAvailable[COpenGLDriver::IRR_ARB_vertex_buffer_object])
 		return false;
 
 #if defined(GL_ARB_vertex_buffer_object)
@@ -278,15 +285,28 @@ bool COpenGLHardwareBuffer::update(const scene::E_HARDWARE_MAPPING mapping, cons
 
 		createBuffer = true;
 	}
-	else if (oldSize < Size)
+	else if (Size < size)
 		createBuffer = true;
 
 	Driver->extGlBindBuffer(target, BufferID);
 
+	// the buffer keeps its size when less data is used, so it doesn't have to be
+	// recreated when it grows again
 	if (!createBuffer)
-		Driver->extGlBufferSubData(target, 0, Size, data);
+	{
+		u32 begin = 0;
+		u32 end = 0;
+		getUpdateRange(size, begin, end);
+
+		if (begin < end)
+			Driver->extGlBufferSubData(target, begin, end - begin, (const c8*)data + begin);
+		IRR_PROFILE(getProfiler().count(EPID_VD_UPLOADED_BYTES, end - begin);)
+	}
 	else
 	{
+		Size = size;
+		IRR_PROFILE(getProfiler().count(EPID_VD_UPLOADED_BYTES, Size);)
+
 		if (Mapping == scene::EHM_STATIC)
 			Driver->extGlBufferData(target, Size, data, GL_STATIC_DRAW);
 		else if (Mapping == scene::EHM_DYNAMIC)
@@ -1185,6 +1205,9 @@ bool COpenGLDriver::endScene()
 //! clears the zbuffer and color buffer
 void COpenGLDriver::clearBuffers(bool backBuffer, bool zBuffer, bool stencilBuffer, SColor color)
 {
+	// the batched 2d quads were drawn before
+	flush2DBatch();
+
 	GLbitfield mask = 0;
 	if (backBuffer)
 	{
@@ -1493,6 +1516,31 @@ void COpenGLDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 
 	CNullDriver::drawMeshBuffer(mb);
 
+	renderMeshBuffer(mb, 0, mb->getPrimitiveCount());
+}
+
+
+//! Draws a range of the indices of a mesh buffer
+void COpenGLDriver::drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount)
+{
+	if (!mb || !mb->isVertexBufferCompatible())
+		return;
+
+	const u32 primitiveCount = getPrimitiveCount(mb->getPrimitiveType(), indexCount);
+	if (!primitiveCount || firstIndex + indexCount > mb->getIndexBuffer()->getIndexCount())
+		return;
+
+	if (!checkPrimitiveCount(primitiveCount))
+		return;
+
+	CNullDriver::drawMeshBufferRange(mb, firstIndex, indexCount);
+
+	renderMeshBuffer(mb, firstIndex, primitiveCount);
+}
+
+
+void COpenGLDriver::renderMeshBuffer(const scene::IMeshBuffer* mb, u32 firstIndex, u32 primitiveCount)
+{
 	COpenGLVertexDescriptor* descriptor = (COpenGLVertexDescriptor*)mb->getVertexDescriptor();
 
 	scene::IIndexBuffer* indexBuffer = mb->getIndexBuffer();
@@ -1503,7 +1551,6 @@ void COpenGLDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	const scene::E_HARDWARE_MAPPING indexMapping = indexBuffer->getHardwareMappingHint();
 	const void* indexData = indexBuffer->getIndices();
 
-	const u32 primitiveCount = mb->getPrimitiveCount();
 	const scene::E_PRIMITIVE_TYPE primitiveType = mb->getPrimitiveType();
 
 	const bool hwRecommended = isHardwareBufferRecommend(mb);
@@ -1827,7 +1874,9 @@ void COpenGLDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 
 	// Draw.
 
-	renderArray(hwIndexBuffer ? 0 : indexData, indexType, primitiveCount, primitiveType);
+	const u32 firstIndexOffset = firstIndex * indexSize;
+	renderArray(hwIndexBuffer ? buffer_offset(firstIndexOffset) : static_cast<const u8*>(indexData) + firstIndexOffset,
+		indexType, primitiveCount, primitiveType);
 
 	// Disable semantics and attributes.
 
@@ -2169,154 +2218,8 @@ void COpenGLDriver::draw2DImageBatch(const video::ITexture* texture,
 
 	const u32 drawCount = core::min_<u32>(positions.size(), sourceRects.size());
 
-	const core::dimension2d<u32>& ss = texture->getOriginalSize();
-	const f32 invW = 1.f / static_cast<f32>(ss.Width);
-	const f32 invH = 1.f / static_cast<f32>(ss.Height);
-	const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
-
-	disableTextures(1);
-	if (!setActiveTexture(0, texture))
-		return;
-	setRenderStates2DMode(color.getAlpha()<255, true, useAlphaChannelOfTexture);
-
-	Quad2DVertices[0].Color = color;
-	Quad2DVertices[1].Color = color;
-	Quad2DVertices[2].Color = color;
-	Quad2DVertices[3].Color = color;
-
-	if (!FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
-		getColorBuffer(Quad2DVertices, 4, EVT_STANDARD);
-
-	BridgeCalls->setClientState(true, false, true);
-
-	if (MultiTextureExtension)
-		BridgeCalls->setClientActiveTexture(GL_TEXTURE0_ARB);
-
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-
-	glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].TCoords);
-	glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].Pos);
-
-#ifdef GL_BGRA
-	const GLint colorSize=(FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])?GL_BGRA:4;
-#else
-	const GLint colorSize=4;
-#endif
-	if (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
-		glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].Color);
-	else
-	{
-		_IRR_DEBUG_BREAK_IF(ColorBuffer.size()==0);
-		glColorPointer(colorSize, GL_UNSIGNED_BYTE, 0, &ColorBuffer[0]);
-	}
-
 	for (u32 i=0; i<drawCount; ++i)
-	{
-		if (!sourceRects[i].isValid())
-			continue;
-
-		core::position2d<s32> targetPos(positions[i]);
-		core::position2d<s32> sourcePos(sourceRects[i].UpperLeftCorner);
-		// This needs to be signed as it may go negative.
-		core::dimension2d<s32> sourceSize(sourceRects[i].getSize());
-		if (clipRect)
-		{
-			if (targetPos.X < clipRect->UpperLeftCorner.X)
-			{
-				sourceSize.Width += targetPos.X - clipRect->UpperLeftCorner.X;
-				if (sourceSize.Width <= 0)
-					continue;
-
-				sourcePos.X -= targetPos.X - clipRect->UpperLeftCorner.X;
-				targetPos.X = clipRect->UpperLeftCorner.X;
-			}
-
-			if (targetPos.X + sourceSize.Width > clipRect->LowerRightCorner.X)
-			{
-				sourceSize.Width -= (targetPos.X + sourceSize.Width) - clipRect->LowerRightCorner.X;
-				if (sourceSize.Width <= 0)
-					continue;
-			}
-
-			if (targetPos.Y < clipRect->UpperLeftCorner.Y)
-			{
-				sourceSize.Height += targetPos.Y - clipRect->UpperLeftCorner.Y;
-				if (sourceSize.Height <= 0)
-					continue;
-
-				sourcePos.Y -= targetPos.Y - clipRect->UpperLeftCorner.Y;
-				targetPos.Y = clipRect->UpperLeftCorner.Y;
-			}
-
-			if (targetPos.Y + sourceSize.Height > clipRect->LowerRightCorner.Y)
-			{
-				sourceSize.Height -= (targetPos.Y + sourceSize.Height) - clipRect->LowerRightCorner.Y;
-				if (sourceSize.Height <= 0)
-					continue;
-			}
-		}
-
-		// clip these coordinates
-
-		if (targetPos.X<0)
-		{
-			sourceSize.Width += targetPos.X;
-			if (sourceSize.Width <= 0)
-				continue;
-
-			sourcePos.X -= targetPos.X;
-			targetPos.X = 0;
-		}
-
-		if (targetPos.X + sourceSize.Width > (s32)renderTargetSize.Width)
-		{
-			sourceSize.Width -= (targetPos.X + sourceSize.Width) - renderTargetSize.Width;
-			if (sourceSize.Width <= 0)
-				continue;
-		}
-
-		if (targetPos.Y<0)
-		{
-			sourceSize.Height += targetPos.Y;
-			if (sourceSize.Height <= 0)
-				continue;
-
-			sourcePos.Y -= targetPos.Y;
-			targetPos.Y = 0;
-		}
-
-		if (targetPos.Y + sourceSize.Height > (s32)renderTargetSize.Height)
-		{
-			sourceSize.Height -= (targetPos.Y + sourceSize.Height) - renderTargetSize.Height;
-			if (sourceSize.Height <= 0)
-				continue;
-		}
-
-		// ok, we've clipped everything.
-		// now draw it.
-
-		const core::rect<f32> tcoords(
-				sourcePos.X * invW,
-				sourcePos.Y * invH,
-				(sourcePos.X + sourceSize.Width) * invW,
-				(sourcePos.Y + sourceSize.Height) * invH);
-
-		const core::rect<s32> poss(targetPos, sourceSize);
-
-		Quad2DVertices[0].Pos = core::vector3df((f32)poss.UpperLeftCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f);
-		Quad2DVertices[1].Pos = core::vector3df((f32)poss.LowerRightCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f);
-		Quad2DVertices[2].Pos = core::vector3df((f32)poss.LowerRightCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f);
-		Quad2DVertices[3].Pos = core::vector3df((f32)poss.UpperLeftCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f);
-
-		Quad2DVertices[0].TCoords = core::vector2df(tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
-		Quad2DVertices[1].TCoords = core::vector2df(tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
-		Quad2DVertices[2].TCoords = core::vector2df(tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
-		Quad2DVertices[3].TCoords = core::vector2df(tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
-
-		glDrawElements(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_SHORT, Quad2DIndices);
-	}
-
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		add2DImageQuad(texture, positions[i], sourceRects[i], clipRect, color, useAlphaChannelOfTexture);
 }
 
 
@@ -2332,151 +2235,7 @@ void COpenGLDriver::draw2DImage(const video::ITexture* texture,
 	if (!texture)
 		return;
 
-	if (!sourceRect.isValid())
-		return;
-
-	core::position2d<s32> targetPos(pos);
-	core::position2d<s32> sourcePos(sourceRect.UpperLeftCorner);
-	// This needs to be signed as it may go negative.
-	core::dimension2d<s32> sourceSize(sourceRect.getSize());
-	if (clipRect)
-	{
-		if (targetPos.X < clipRect->UpperLeftCorner.X)
-		{
-			sourceSize.Width += targetPos.X - clipRect->UpperLeftCorner.X;
-			if (sourceSize.Width <= 0)
-				return;
-
-			sourcePos.X -= targetPos.X - clipRect->UpperLeftCorner.X;
-			targetPos.X = clipRect->UpperLeftCorner.X;
-		}
-
-		if (targetPos.X + sourceSize.Width > clipRect->LowerRightCorner.X)
-		{
-			sourceSize.Width -= (targetPos.X + sourceSize.Width) - clipRect->LowerRightCorner.X;
-			if (sourceSize.Width <= 0)
-				return;
-		}
-
-		if (targetPos.Y < clipRect->UpperLeftCorner.Y)
-		{
-			sourceSize.Height += targetPos.Y - clipRect->UpperLeftCorner.Y;
-			if (sourceSize.Height <= 0)
-				return;
-
-			sourcePos.Y -= targetPos.Y - clipRect->UpperLeftCorner.Y;
-			targetPos.Y = clipRect->UpperLeftCorner.Y;
-		}
-
-		if (targetPos.Y + sourceSize.Height > clipRect->LowerRightCorner.Y)
-		{
-			sourceSize.Height -= (targetPos.Y + sourceSize.Height) - clipRect->LowerRightCorner.Y;
-			if (sourceSize.Height <= 0)
-				return;
-		}
-	}
-
-	// clip these coordinates
-
-	if (targetPos.X<0)
-	{
-		sourceSize.Width += targetPos.X;
-		if (sourceSize.Width <= 0)
-			return;
-
-		sourcePos.X -= targetPos.X;
-		targetPos.X = 0;
-	}
-
-	const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
-
-	if (targetPos.X + sourceSize.Width > (s32)renderTargetSize.Width)
-	{
-		sourceSize.Width -= (targetPos.X + sourceSize.Width) - renderTargetSize.Width;
-		if (sourceSize.Width <= 0)
-			return;
-	}
-
-	if (targetPos.Y<0)
-	{
-		sourceSize.Height += targetPos.Y;
-		if (sourceSize.Height <= 0)
-			return;
-
-		sourcePos.Y -= targetPos.Y;
-		targetPos.Y = 0;
-	}
-
-	if (targetPos.Y + sourceSize.Height > (s32)renderTargetSize.Height)
-	{
-		sourceSize.Height -= (targetPos.Y + sourceSize.Height) - renderTargetSize.Height;
-		if (sourceSize.Height <= 0)
-			return;
-	}
-
-	// ok, we've clipped everything.
-	// now draw it.
-
-	const core::dimension2d<u32>& ss = texture->getOriginalSize();
-	const f32 invW = 1.f / static_cast<f32>(ss.Width);
-	const f32 invH = 1.f / static_cast<f32>(ss.Height);
-	const core::rect<f32> tcoords(
-			sourcePos.X * invW,
-			sourcePos.Y * invH,
-			(sourcePos.X + sourceSize.Width) * invW,
-			(sourcePos.Y + sourceSize.Height) * invH);
-
-	const core::rect<s32> poss(targetPos, sourceSize);
-
-	disableTextures(1);
-	if (!setActiveTexture(0, texture))
-		return;
-	setRenderStates2DMode(color.getAlpha()<255, true, useAlphaChannelOfTexture);
-
-	Quad2DVertices[0].Color = color;
-	Quad2DVertices[1].Color = color;
-	Quad2DVertices[2].Color = color;
-	Quad2DVertices[3].Color = color;
-
-	Quad2DVertices[0].Pos = core::vector3df((f32)poss.UpperLeftCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f);
-	Quad2DVertices[1].Pos = core::vector3df((f32)poss.LowerRightCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f);
-	Quad2DVertices[2].Pos = core::vector3df((f32)poss.LowerRightCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f);
-	Quad2DVertices[3].Pos = core::vector3df((f32)poss.UpperLeftCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f);
-
-	Quad2DVertices[0].TCoords = core::vector2df(tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
-	Quad2DVertices[1].TCoords = core::vector2df(tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
-	Quad2DVertices[2].TCoords = core::vector2df(tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
-	Quad2DVertices[3].TCoords = core::vector2df(tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
-
-	if (!FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
-		getColorBuffer(Quad2DVertices, 4, EVT_STANDARD);
-
-	BridgeCalls->setClientState(true, false, true);
-
-	if (MultiTextureExtension)
-		BridgeCalls->setClientActiveTexture(GL_TEXTURE0_ARB);
-
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-
-	glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].TCoords);
-	glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].Pos);
-
-#ifdef GL_BGRA
-	const GLint colorSize=(FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])?GL_BGRA:4;
-#else
-	const GLint colorSize=4;
-#endif
-	if (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
-		glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].Color);
-	else
-	{
-		_IRR_DEBUG_BREAK_IF(ColorBuffer.size()==0);
-		glColorPointer(colorSize, GL_UNSIGNED_BYTE, 0, &ColorBuffer[0]);
-	}
-
-	glDrawElements(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_SHORT, Quad2DIndices);
-
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	add2DImageQuad(texture, pos, sourceRect, clipRect, color, useAlphaChannelOfTexture);
 }
 
 
@@ -2507,12 +2266,34 @@ void COpenGLDriver::draw2DImage(const video::ITexture* texture, const core::rect
 
 	const video::SColor* const useColor = colors ? colors : temp;
 
+	const bool alpha = useColor[0].getAlpha()<255 || useColor[1].getAlpha()<255 ||
+			useColor[2].getAlpha()<255 || useColor[3].getAlpha()<255;
+
+	// images which are not clipped are batched, the others use the scissor test
+	core::rect<s32> clippedRect(destRect);
+	if (clipRect)
+		clippedRect.clipAgainst(*clipRect);
+
+	if (clippedRect == destRect)
+	{
+		S3DVertex vertices[4];
+		vertices[0] = S3DVertex((f32)destRect.UpperLeftCorner.X, (f32)destRect.UpperLeftCorner.Y, 0.0f,
+			0.0f, 0.0f, 0.0f, useColor[0], tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
+		vertices[1] = S3DVertex((f32)destRect.LowerRightCorner.X, (f32)destRect.UpperLeftCorner.Y, 0.0f,
+			0.0f, 0.0f, 0.0f, useColor[3], tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
+		vertices[2] = S3DVertex((f32)destRect.LowerRightCorner.X, (f32)destRect.LowerRightCorner.Y, 0.0f,
+			0.0f, 0.0f, 0.0f, useColor[2], tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
+		vertices[3] = S3DVertex((f32)destRect.UpperLeftCorner.X, (f32)destRect.LowerRightCorner.Y, 0.0f,
+			0.0f, 0.0f, 0.0f, useColor[1], tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
+
+		add2DQuad(texture, alpha, useAlphaChannelOfTexture, vertices);
+		return;
+	}
+
 	disableTextures(1);
 	if (!setActiveTexture(0, texture))
 		return;
-	setRenderStates2DMode(useColor[0].getAlpha()<255 || useColor[1].getAlpha()<255 ||
-			useColor[2].getAlpha()<255 || useColor[3].getAlpha()<255,
-			true, useAlphaChannelOfTexture);
+	setRenderStates2DMode(alpha, true, useAlphaChannelOfTexture);
 
 	if (clipRect)
 	{
@@ -2591,57 +2372,7 @@ void COpenGLDriver::draw2DImageBatch(const video::ITexture* texture,
 	if (!texture)
 		return;
 
-	disableTextures(1);
-	if (!setActiveTexture(0, texture))
-		return;
-	setRenderStates2DMode(color.getAlpha()<255, true, useAlphaChannelOfTexture);
-
-	if (clipRect)
-	{
-		if (!clipRect->isValid())
-			return;
-
-		glEnable(GL_SCISSOR_TEST);
-		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
-		glScissor(clipRect->UpperLeftCorner.X, renderTargetSize.Height-clipRect->LowerRightCorner.Y,
-			clipRect->getWidth(),clipRect->getHeight());
-	}
-
-	const core::dimension2d<u32>& ss = texture->getOriginalSize();
 	core::position2d<s32> targetPos(pos);
-	const f32 invW = 1.f / static_cast<f32>(ss.Width);
-	const f32 invH = 1.f / static_cast<f32>(ss.Height);
-
-	Quad2DVertices[0].Color = color;
-	Quad2DVertices[1].Color = color;
-	Quad2DVertices[2].Color = color;
-	Quad2DVertices[3].Color = color;
-
-	if (!FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
-		getColorBuffer(Quad2DVertices, 4, EVT_STANDARD);
-
-	BridgeCalls->setClientState(true, false, true);
-
-	if (MultiTextureExtension)
-		BridgeCalls->setClientActiveTexture(GL_TEXTURE0_ARB);
-
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-
-	glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].TCoords);
-	glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].Pos);
-
-#ifdef GL_BGRA
-	const GLint colorSize=(FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])?GL_BGRA:4;
-#else
-	const GLint colorSize=4;
-#endif
-	if (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
-		glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].Color);
-	else
-	{
-		_IRR_DEBUG_BREAK_IF(ColorBuffer.size()==0);
-		glColorPointer(colorSize, GL_UNSIGNED_BYTE, 0, &ColorBuffer[0]);
-	}
 
 	for (u32 i=0; i<indices.size(); ++i)
 	{
@@ -2649,33 +2380,10 @@ void COpenGLDriver::draw2DImageBatch(const video::ITexture* texture,
 		if (!sourceRects[currentIndex].isValid())
 			break;
 
-		const core::rect<f32> tcoords(
-				sourceRects[currentIndex].UpperLeftCorner.X * invW,
-				sourceRects[currentIndex].UpperLeftCorner.Y * invH,
-				sourceRects[currentIndex].LowerRightCorner.X * invW,
-				sourceRects[currentIndex].LowerRightCorner.Y * invH);
-
-		const core::rect<s32> poss(targetPos, sourceRects[currentIndex].getSize());
-
-		Quad2DVertices[0].Pos = core::vector3df((f32)poss.UpperLeftCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f);
-		Quad2DVertices[1].Pos = core::vector3df((f32)poss.LowerRightCorner.X, (f32)poss.UpperLeftCorner.Y, 0.0f);
-		Quad2DVertices[2].Pos = core::vector3df((f32)poss.LowerRightCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f);
-		Quad2DVertices[3].Pos = core::vector3df((f32)poss.UpperLeftCorner.X, (f32)poss.LowerRightCorner.Y, 0.0f);
-
-		Quad2DVertices[0].TCoords = core::vector2df(tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
-		Quad2DVertices[1].TCoords = core::vector2df(tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
-		Quad2DVertices[2].TCoords = core::vector2df(tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
-		Quad2DVertices[3].TCoords = core::vector2df(tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
-
-		glDrawElements(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_SHORT, Quad2DIndices);
+		add2DImageQuad(texture, targetPos, sourceRects[currentIndex], clipRect, color, useAlphaChannelOfTexture);
 
 		targetPos.X += sourceRects[currentIndex].getWidth();
 	}
-
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-
-	if (clipRect)
-		glDisable(GL_SCISSOR_TEST);
 }
 
 
@@ -2683,20 +2391,7 @@ void COpenGLDriver::draw2DImageBatch(const video::ITexture* texture,
 void COpenGLDriver::draw2DRectangle(SColor color, const core::rect<s32>& position,
 		const core::rect<s32>* clip)
 {
-	disableTextures();
-	setRenderStates2DMode(color.getAlpha() < 255, false, false);
-
-	core::rect<s32> pos = position;
-
-	if (clip)
-		pos.clipAgainst(*clip);
-
-	if (!pos.isValid())
-		return;
-
-	glColor4ub(color.getRed(), color.getGreen(), color.getBlue(), color.getAlpha());
-	glRectf(GLfloat(pos.UpperLeftCorner.X), GLfloat(pos.UpperLeftCorner.Y),
-		GLfloat(pos.LowerRightCorner.X), GLfloat(pos.LowerRightCorner.Y));
+	add2DRectangleQuad(position, color, color, color, color, clip);
 }
 
 
@@ -2705,37 +2400,40 @@ void COpenGLDriver::draw2DRectangle(const core::rect<s32>& position,
 			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 			const core::rect<s32>* clip)
 {
-	core::rect<s32> pos = position;
-
-	if (clip)
-		pos.clipAgainst(*clip);
-
-	if (!pos.isValid())
-		return;
-
-	disableTextures();
+	add2DRectangleQuad(position, colorLeftUp, colorRightUp, colorLeftDown, colorRightDown, clip);
+}
 
-	setRenderStates2DMode(colorLeftUp.getAlpha() < 255 ||
-		colorRightUp.getAlpha() < 255 ||
-		colorLeftDown.getAlpha() < 255 ||
-		colorRightDown.getAlpha() < 255, false, false);
 
-	Quad2DVertices[0].Color = colorLeftUp;
-	Quad2DVertices[1].Color = colorRightUp;
-	Quad2DVertices[2].Color = colorRightDown;
-	Quad2DVertices[3].Color = colorLeftDown;
+//! draws quads of the 2d batch
+void COpenGLDriver::draw2DBatch(const video::ITexture* texture, bool alpha, bool alphaChannel,
+		const S3DVertex* vertices, u32 quadCount)
+{
+	if (texture)
+	{
+		disableTextures(1);
+		if (!setActiveTexture(0, texture))
+			return;
+	}
+	else
+		disableTextures();
 
-	Quad2DVertices[0].Pos = core::vector3df((f32)pos.UpperLeftCorner.X, (f32)pos.UpperLeftCorner.Y, 0.0f);
-	Quad2DVertices[1].Pos = core::vector3df((f32)pos.LowerRightCorner.X, (f32)pos.UpperLeftCorner.Y, 0.0f);
-	Quad2DVertices[2].Pos = core::vector3df((f32)pos.LowerRightCorner.X, (f32)pos.LowerRightCorner.Y, 0.0f);
-	Quad2DVertices[3].Pos = core::vector3df((f32)pos.UpperLeftCorner.X, (f32)pos.LowerRightCorner.Y, 0.0f);
+	setRenderStates2DMode(alpha, texture != 0, alphaChannel);
 
 	if (!FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
-		getColorBuffer(Quad2DVertices, 4, EVT_STANDARD);
+		getColorBuffer(vertices, quadCount * 4, EVT_STANDARD);
 
 	BridgeCalls->setClientState(true, false, true);
 
-	glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].Pos);
+	if (texture)
+	{
+		if (MultiTextureExtension)
+			BridgeCalls->setClientActiveTexture(GL_TEXTURE0_ARB);
+
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), &vertices[0].TCoords);
+	}
+
+	glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex), &vertices[0].Pos);
 
 #ifdef GL_BGRA
 	const GLint colorSize=(FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])?GL_BGRA:4;
@@ -2743,14 +2441,17 @@ void COpenGLDriver::draw2DRectangle(const core::rect<s32>& position,
 	const GLint colorSize=4;
 #endif
 	if (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
-		glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(Quad2DVertices))[0].Color);
+		glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), &vertices[0].Color);
 	else
 	{
 		_IRR_DEBUG_BREAK_IF(ColorBuffer.size()==0);
 		glColorPointer(colorSize, GL_UNSIGNED_BYTE, 0, &ColorBuffer[0]);
 	}
 
-	glDrawElements(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_SHORT, Quad2DIndices);
+	glDrawElements(GL_TRIANGLES, quadCount * 6, GL_UNSIGNED_SHORT, Batch2DIndices.const_pointer());
+
+	if (texture)
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 }
 
 
@@ -2834,6 +2535,9 @@ void COpenGLDriver::drawPixel(u32 x, u32 y, const SColor &color)
 
 bool COpenGLDriver::setActiveTexture(u32 stage, const video::ITexture* texture)
 {
+	// the batched 2d quads use the textures which are set now
+	flush2DBatch();
+
 	if (stage >= MaxSupportedTextures)
 		return false;
 
@@ -2961,6 +2665,8 @@ bool COpenGLDriver::testGLError()
 //! sets the needed renderstates
 void COpenGLDriver::setRenderStates3DMode()
 {
+	flush2DBatch();
+
 	if (CurrentRenderMode != ERM_3D)
 	{
 		// Reset Texture Stages
@@ -2984,6 +2690,8 @@ void COpenGLDriver::setRenderStates3DMode()
 
 	if (ResetRenderStates || LastMaterial != Material)
 	{
+		IRR_PROFILE(getProfiler().count(EPID_VD_STATE_CHANGES);)
+
 		// unset old material
 
 		if (LastMaterial.MaterialType != Material.MaterialType &&
@@ -3729,6 +3437,8 @@ void COpenGLDriver::enableMaterial2D(bool enable)
 //! sets the needed renderstates
 void COpenGLDriver::setRenderStates2DMode(bool alpha, bool texture, bool alphaChannel)
 {
+	flush2DBatch();
+
 	// 2d methods uses fixed pipeline
 	if (FixedPipelineState == COpenGLDriver::EOFPS_DISABLE)
 		FixedPipelineState = COpenGLDriver::EOFPS_DISABLE_TO_ENABLE;
@@ -3767,7 +3477,6 @@ void COpenGLDriver::setRenderStates2DMode(bool alpha, bool texture, bool alphaCh
 			setBasicRenderStates(InitMaterial2D, LastMaterial, true);
 			LastMaterial = InitMaterial2D;
 		}
-		BridgeCalls->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 #ifdef GL_EXT_clip_volume_hint
 		if (FeatureAvailable[IRR_EXT_clip_volume_hint])
 			glHint(GL_CLIP_VOLUME_CLIPPING_HINT_EXT, GL_FASTEST);
@@ -3780,6 +3489,9 @@ void COpenGLDriver::setRenderStates2DMode(bool alpha, bool texture, bool alphaCh
 		setBasicRenderStates(OverrideMaterial2D, LastMaterial, false);
 		LastMaterial = OverrideMaterial2D;
 	}
+	// the override material may blend with its own factors
+	if (!OverrideMaterial2DEnabled || !IR(OverrideMaterial2D.BlendFactor))
+		BridgeCalls->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// no alphaChannel without texture
 	alphaChannel &= texture;
@@ -4076,6 +3788,8 @@ void COpenGLDriver::setAmbientLight(const SColorf& color)
 // method just a bit.
 void COpenGLDriver::setViewPort(const core::rect<s32>& area)
 {
+	flush2DBatch();
+
 	core::rect<s32> vp = area;
 	core::rect<s32> rendert(0, 0, getCurrentRenderTargetSize().Width, getCurrentRenderTargetSize().Height);
 	vp.clipAgainst(rendert);
@@ -4621,6 +4335,8 @@ u32 COpenGLDriver::getMaximalPrimitiveCount() const
 bool COpenGLDriver::setRenderTarget(video::ITexture* texture, bool clearBackBuffer,
 					bool clearZBuffer, SColor color, video::ITexture* depthStencil)
 {
+	flush2DBatch();
+
 	// check for right driver type
 
 	if (texture && texture->getDriverType() != EDT_OPENGL)
@@ -4703,6 +4419,8 @@ bool COpenGLDriver::setRenderTarget(video::ITexture* texture, bool clearBackBuff
 bool COpenGLDriver::setRenderTarget(const core::array<video::IRenderTarget>& targets,
 				bool clearBackBuffer, bool clearZBuffer, SColor color, video::ITexture* depthStencil)
 {
+	flush2DBatch();
+
 	// if simply disabling the MRT via array call
 	if (targets.size()==0)
 		return setRenderTarget(0, clearBackBuffer, clearZBuffer, color, depthStencil);
@@ -4966,6 +4684,8 @@ void COpenGLDriver::clearZBuffer()
 //! Returns an image created from the last rendered frame.
 IImage* COpenGLDriver::createScreenShot(video::ECOLOR_FORMAT format, video::E_RENDER_TARGET target)
 {
+	flush2DBatch();
+
 	if (target != video::ERT_FRAME_BUFFER)
 		return 0;
 
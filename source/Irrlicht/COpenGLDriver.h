@@ -20,6 +20,7 @@ namespace irr
 #ifdef _IRR_COMPILE_WITH_OPENGL_
 
 #include "CNullDriver.h"
+#include "CThreadPool.h"
 #include "IMaterialRendererServices.h"
 // also includes the OpenGL stuff
 #include "COpenGLExtensionHandler.h"
@@ -75,9 +76,13 @@ namespace video
 		void addLocationLayer();
 
 	protected:
+		virtual void lockReferenceCount(bool lock) const _IRR_OVERRIDE_;
+
 		core::array<COpenGLVertexAttribute> Attribute;
 
 		u32 LayerCount;
+
+		mutable CMutex ReferenceMutex;
 	};
 
 	class COpenGLHardwareBuffer : public IHardwareBuffer
@@ -188,6 +193,9 @@ namespace video
 
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
 
+		//! Draws a range of the indices of a mesh buffer
+		virtual void drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount) _IRR_OVERRIDE_;
+
 		//! draws a vertex primitive list in 2d
 		virtual void draw2DVertexPrimitiveList(const void* vertices, u32 vertexCount,
 				const void* indexList, u32 primitiveCount,
@@ -521,6 +529,10 @@ namespace video
 		//! sets the needed renderstates
 		void setRenderStates2DMode(bool alpha, bool texture, bool alphaChannel);
 
+		//! draws quads of the 2d batch
+		virtual void draw2DBatch(const video::ITexture* texture, bool alpha, bool alphaChannel,
+			const S3DVertex* vertices, u32 quadCount) _IRR_OVERRIDE_;
+
 		// returns the current size of the screen or rendertarget
 		virtual const core::dimension2d<u32>& getCurrentRenderTargetSize() const _IRR_OVERRIDE_;
 
@@ -534,6 +546,9 @@ namespace video
 		//! helper function for render setup.
 		void getColorBuffer(const void* vertices, u32 vertexCount, E_VERTEX_TYPE vType);
 
+		//! sets up the buffers of a mesh buffer and draws primitives starting at an index
+		void renderMeshBuffer(const scene::IMeshBuffer* mb, u32 firstIndex, u32 primitiveCount);
+
 		void renderArray(const void* indices, GLenum indexType, u32 primitiveCount, scene::E_PRIMITIVE_TYPE primitiveType);
 
 		// Bridge calls.
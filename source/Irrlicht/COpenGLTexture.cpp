@@ -11,6 +11,8 @@
 #include "COpenGLDriver.h"
 #include "os.h"
 #include "CColorConverter.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 #include "irrString.h"
 
@@ -533,6 +535,7 @@ void COpenGLTexture::uploadTexture(bool newTexture, void* mipmapData, u32 level)
 				image->getDimension().Height, PixelFormat, PixelType, source);
 	}
 	image->unlock();
+	IRR_PROFILE(getProfiler().count(EPID_VD_UPLOADED_BYTES, IsCompressed ? compressedDataSize : image->getImageDataSizeInBytes());)
 
 	if (!level && newTexture)
 	{
@@ -0,0 +1,800 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CPagedTerrainSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IFileSystem.h"
+#include "SViewFrustum.h"
+#include "CMeshBuffer.h"
+#include "CIndexBuffer.h"
+#include "os.h"
+#include <string.h>
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Loads a tile and builds its vertices on a worker thread.
+	class CTerrainTileRequest : public io::CAssetRequest
+	{
+	public:
+
+		CTerrainTileRequest(CPagedTerrainSceneNode* node, u32 tile, u32 tileX, u32 tileZ,
+			const io::path& name, io::IReadFile* file, IMeshBuffer* buffer, u32 patchCount)
+			: io::CAssetRequest(name, file), Tile(tile), Success(false), Node(node),
+			Buffer(buffer), TileX(tileX), TileZ(tileZ), PatchCount(patchCount)
+		{
+			#ifdef _DEBUG
+			setDebugName("CTerrainTileRequest");
+			#endif
+
+			Buffer->grab();
+		}
+
+		virtual ~CTerrainTileRequest()
+		{
+			Buffer->drop();
+		}
+
+		virtual void load() _IRR_OVERRIDE_
+		{
+			Success = File && build();
+		}
+
+		virtual bool finish() _IRR_OVERRIDE_
+		{
+			State = Success ? io::EARS_READY : io::EARS_FAILED;
+			Node->tileLoaded(this);
+			return true;
+		}
+
+		u32 Tile;
+		bool Success;
+		core::aabbox3d<f32> Box;
+		core::array<core::aabbox3d<f32> > PatchBoxes;
+
+	private:
+
+		//! Reads the heights and creates the vertices, normals, skirts and patch boxes.
+		bool build()
+		{
+			const SPagedTerrainParameters& p = Node->getParameters();
+			const u32 size = p.TileSize;
+			const u32 bytes = p.BitsPerSample / 8;
+
+			if ((u32)File->getSize() < size * size * bytes)
+				return false;
+
+			const u8* data = static_cast<const u8*>(File->getData());
+
+			IVertexBuffer* vertexBuffer = Buffer->getVertexBuffer();
+			vertexBuffer->set_used(size * size + 2 * (PatchCount + 1) * size);
+			video::S3DVertex2TCoords* vertices = static_cast<video::S3DVertex2TCoords*>(vertexBuffer->getVertices());
+
+			const f32 terrainSizeX = (f32)(p.TileCountX * (size - 1));
+			const f32 terrainSizeZ = (f32)(p.TileCountZ * (size - 1));
+			const f32 tileSize = (f32)(size - 1);
+
+			for (u32 x = 0; x < size; ++x)
+			{
+				for (u32 z = 0; z < size; ++z)
+				{
+					const u32 i = x * size + z;
+					const f32 gx = (f32)(TileX * (size - 1) + x);
+					const f32 gz = (f32)(TileZ * (size - 1) + z);
+
+					video::S3DVertex2TCoords& v = vertices[i];
+					v.Pos.set(gx * p.Scale.X, readHeight(data + i * bytes, p) * p.Scale.Y, gz * p.Scale.Z);
+					v.Color = p.VertexColor;
+					v.TCoords.set(1.f - gx / terrainSizeX, gz / terrainSizeZ);
+					v.TCoords2.set(1.f - x / tileSize, z / tileSize);
+				}
+			}
+
+			// smooth normals from the neighbouring heights, at the edges only of this tile
+			for (u32 x = 0; x < size; ++x)
+			{
+				for (u32 z = 0; z < size; ++z)
+				{
+					const u32 x0 = x > 0 ? x - 1 : x;
+					const u32 x1 = x < size - 1 ? x + 1 : x;
+					const u32 z0 = z > 0 ? z - 1 : z;
+					const u32 z1 = z < size - 1 ? z + 1 : z;
+
+					const core::vector3df alongX = vertices[x1 * size + z].Pos - vertices[x0 * size + z].Pos;
+					const core::vector3df alongZ = vertices[x * size + z1].Pos - vertices[x * size + z0].Pos;
+					vertices[x * size + z].Normal = alongZ.crossProduct(alongX).normalize();
+				}
+			}
+
+			// skirts hanging down from the lines between the patches, first those along z
+			const u32 patchSize = p.PatchSize;
+			video::S3DVertex2TCoords* skirt = vertices + size * size;
+			for (u32 line = 0; line <= PatchCount; ++line)
+			{
+				for (u32 z = 0; z < size; ++z, ++skirt)
+				{
+					*skirt = vertices[line * patchSize * size + z];
+					skirt->Pos.Y -= p.SkirtDepth;
+				}
+			}
+			for (u32 line = 0; line <= PatchCount; ++line)
+			{
+				for (u32 x = 0; x < size; ++x, ++skirt)
+				{
+					*skirt = vertices[x * size + line * patchSize];
+					skirt->Pos.Y -= p.SkirtDepth;
+				}
+			}
+
+			PatchBoxes.set_used(PatchCount * PatchCount);
+			for (u32 px = 0; px < PatchCount; ++px)
+			{
+				for (u32 pz = 0; pz < PatchCount; ++pz)
+				{
+					core::aabbox3d<f32>& box = PatchBoxes[px * PatchCount + pz];
+					box.reset(vertices[px * patchSize * size + pz * patchSize].Pos);
+					for (u32 x = px * patchSize; x <= (px + 1) * patchSize; ++x)
+						for (u32 z = pz * patchSize; z <= (pz + 1) * patchSize; ++z)
+							box.addInternalPoint(vertices[x * size + z].Pos);
+					box.MinEdge.Y -= p.SkirtDepth;
+
+					if (px == 0 && pz == 0)
+						Box = box;
+					else
+						Box.addInternalBox(box);
+				}
+			}
+
+			return true;
+		}
+
+		//! Converts a height like CTerrainSceneNode::loadHeightMapRAW
+		static f32 readHeight(const u8* data, const SPagedTerrainParameters& p)
+		{
+			if (p.FloatValues)
+			{
+				f32 val;
+				memcpy(&val, data, 4);
+				return val;
+			}
+
+			switch (p.BitsPerSample)
+			{
+			case 8:
+				return p.SignedData ? (f32)*(const s8*)data : (f32)*data;
+			case 16:
+			{
+				u16 val;
+				memcpy(&val, data, 2);
+				return (p.SignedData ? (f32)(s16)val : (f32)val) / 256.f;
+			}
+			default:
+			{
+				u32 val;
+				memcpy(&val, data, 4);
+				return (p.SignedData ? (f32)(s32)val : (f32)val) / 16777216.f;
+			}
+			}
+		}
+
+		CPagedTerrainSceneNode* Node;
+		IMeshBuffer* Buffer;
+		u32 TileX;
+		u32 TileZ;
+		u32 PatchCount;
+	};
+
+
+	namespace
+	{
+		struct STileDistance
+		{
+			f32 Distance;
+			u32 Tile;
+
+			bool operator<(const STileDistance& other) const
+			{
+				return Distance < other.Distance;
+			}
+		};
+
+		//! Adds the triangles of a skirt quad, visible from both sides
+		void addSkirt(IIndexBuffer* indices, u32 a, u32 b, u32 skirtA, u32 skirtB)
+		{
+			const u32 quad[12] = { a, b, skirtA, b, skirtB, skirtA,
+				a, skirtA, b, b, skirtA, skirtB };
+
+			for (u32 i = 0; i < 12; ++i)
+				indices->addIndex(quad[i]);
+		}
+
+		bool isBoxInFrustum(const SViewFrustum& frustum, const core::aabbox3d<f32>& box)
+		{
+			for (u32 i = 0; i != SViewFrustum::VF_PLANE_COUNT; ++i)
+			{
+				if (box.classifyPlaneRelation(frustum.planes[i]) == core::ISREL3D_FRONT)
+					return false;
+			}
+
+			return true;
+		}
+
+		f32 getBoxDistance(const core::aabbox3d<f32>& box, const core::vector3df& position)
+		{
+			const core::vector3df closest(
+				core::clamp(position.X, box.MinEdge.X, box.MaxEdge.X),
+				core::clamp(position.Y, box.MinEdge.Y, box.MaxEdge.Y),
+				core::clamp(position.Z, box.MinEdge.Z, box.MaxEdge.Z));
+
+			return closest.getDistanceFrom(position);
+		}
+	}
+
+
+	//! constructor
+	CPagedTerrainSceneNode::CPagedTerrainSceneNode(const SPagedTerrainParameters& parameters,
+			ISceneNode* parent, ISceneManager* mgr, io::IFileSystem* fs, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+	: IPagedTerrainSceneNode(parent, mgr, id, position, rotation, scale),
+	Parameters(parameters), FileSystem(fs), Loader(0), PendingTiles(0), MaxPendingTiles(2),
+	TileMemory(0), Indices(0), PatchCount(1)
+	{
+		#ifdef _DEBUG
+		setDebugName("CPagedTerrainSceneNode");
+		#endif
+
+		if (FileSystem)
+			FileSystem->grab();
+
+		PatchCount = (Parameters.TileSize - 1) / Parameters.PatchSize;
+		Parameters.MaxLOD = core::max_(Parameters.MaxLOD, 1u);
+		while ((1u << (Parameters.MaxLOD - 1)) > Parameters.PatchSize)
+			--Parameters.MaxLOD;
+
+		Tiles.reallocate(Parameters.TileCountX * Parameters.TileCountZ);
+		for (u32 i = 0; i < Parameters.TileCountX * Parameters.TileCountZ; ++i)
+			Tiles.push_back(STile());
+
+		Box.reset(0.f, 0.f, 0.f);
+		Box.addInternalPoint(Parameters.TileCountX * (Parameters.TileSize - 1) * Parameters.Scale.X, 0.f,
+			Parameters.TileCountZ * (Parameters.TileSize - 1) * Parameters.Scale.Z);
+
+		TileMemory = getTileVertexCount() * sizeof(video::S3DVertex2TCoords) +
+			PatchCount * PatchCount * sizeof(core::aabbox3d<f32>);
+
+		Loader = new io::CAssetLoader();
+		MaxPendingTiles = core::max_(CThreadPool::getSharedPool()->getThreadCount(), 1u) * 2;
+
+		createIndices();
+
+		setAutomaticCulling(scene::EAC_OFF);
+	}
+
+
+	//! destructor
+	CPagedTerrainSceneNode::~CPagedTerrainSceneNode()
+	{
+		// fails the requests without calling back
+		delete Loader;
+
+		for (u32 i = 0; i < Tiles.size(); ++i)
+		{
+			if (Tiles[i].Buffer)
+				Tiles[i].Buffer->drop();
+			if (Tiles[i].Request)
+				Tiles[i].Request->drop();
+		}
+
+		if (Indices)
+			Indices->drop();
+
+		if (FileSystem)
+			FileSystem->drop();
+	}
+
+
+	//! Builds the shared index buffer and the ranges of the patches.
+	void CPagedTerrainSceneNode::createIndices()
+	{
+		const u32 size = Parameters.TileSize;
+		const u32 patchSize = Parameters.PatchSize;
+		// first skirt vertex of the lines along z and along x
+		const u32 skirtAlongZ = size * size;
+		const u32 skirtAlongX = skirtAlongZ + (PatchCount + 1) * size;
+
+		Indices = new CIndexBuffer(getTileVertexCount() > 65536 ? video::EIT_32BIT : video::EIT_16BIT);
+		Indices->setHardwareMappingHint(scene::EHM_STATIC);
+
+		for (u32 lod = 0; lod < Parameters.MaxLOD; ++lod)
+		{
+			const u32 step = 1 << lod;
+
+			for (u32 px = 0; px < PatchCount; ++px)
+			{
+				for (u32 pz = 0; pz < PatchCount; ++pz)
+				{
+					SIndexRange range;
+					range.First = Indices->getIndexCount();
+
+					const u32 x0 = px * patchSize;
+					const u32 z0 = pz * patchSize;
+
+					for (u32 x = x0; x < x0 + patchSize; x += step)
+					{
+						for (u32 z = z0; z < z0 + patchSize; z += step)
+						{
+							const u32 index11 = x * size + z;
+							const u32 index21 = (x + step) * size + z;
+							const u32 index12 = x * size + z + step;
+							const u32 index22 = (x + step) * size + z + step;
+
+							Indices->addIndex(index12);
+							Indices->addIndex(index11);
+							Indices->addIndex(index22);
+							Indices->addIndex(index22);
+							Indices->addIndex(index11);
+							Indices->addIndex(index21);
+						}
+					}
+
+					// skirts along the four edges of the patch
+					for (u32 i = 0; i < patchSize; i += step)
+					{
+						for (u32 line = px; line <= px + 1; ++line)
+						{
+							const u32 x = line * patchSize;
+							addSkirt(Indices, x * size + z0 + i, x * size + z0 + i + step,
+								skirtAlongZ + line * size + z0 + i, skirtAlongZ + line * size + z0 + i + step);
+						}
+						for (u32 line = pz; line <= pz + 1; ++line)
+						{
+							const u32 z = line * patchSize;
+							addSkirt(Indices, (x0 + i) * size + z, (x0 + i + step) * size + z,
+								skirtAlongX + line * size + x0 + i, skirtAlongX + line * size + x0 + i + step);
+						}
+					}
+
+					range.Count = Indices->getIndexCount() - range.First;
+					PatchRanges.push_back(range);
+				}
+			}
+		}
+	}
+
+
+	//! Number of vertices in each tile, with the skirts.
+	u32 CPagedTerrainSceneNode::getTileVertexCount() const
+	{
+		return Parameters.TileSize * Parameters.TileSize + 2 * (PatchCount + 1) * Parameters.TileSize;
+	}
+
+
+	void CPagedTerrainSceneNode::OnRegisterSceneNode()
+	{
+		if (IsVisible)
+		{
+			ICameraSceneNode* camera = SceneManager->getActiveCamera();
+			if (camera)
+			{
+				core::vector3df position = camera->getAbsolutePosition();
+				core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+				invTrans.transformVect(position);
+
+				updateTiles(position);
+			}
+
+			if (!LoadedTiles.empty())
+				SceneManager->registerNodeForRendering(this);
+		}
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+
+	//! Requests the missing tiles around a position and removes far away tiles.
+	void CPagedTerrainSceneNode::updateTiles(const core::vector3df& position)
+	{
+		Loader->update();
+
+		// the budget might have been lowered
+		while (getMemoryUsage() > Parameters.MemoryBudget && !LoadedTiles.empty())
+		{
+			u32 farthest = 0;
+			for (u32 i = 1; i < LoadedTiles.size(); ++i)
+			{
+				if (getTileDistance(LoadedTiles[i], position) > getTileDistance(LoadedTiles[farthest], position))
+					farthest = i;
+			}
+			removeTile(LoadedTiles[farthest]);
+		}
+
+		const f32 tileSizeX = (Parameters.TileSize - 1) * Parameters.Scale.X;
+		const f32 tileSizeZ = (Parameters.TileSize - 1) * Parameters.Scale.Z;
+		const f32 distance = Parameters.LoadDistance;
+
+		const s32 x0 = core::max_(core::floor32((position.X - distance) / tileSizeX), 0);
+		const s32 x1 = core::min_(core::floor32((position.X + distance) / tileSizeX), (s32)Parameters.TileCountX - 1);
+		const s32 z0 = core::max_(core::floor32((position.Z - distance) / tileSizeZ), 0);
+		const s32 z1 = core::min_(core::floor32((position.Z + distance) / tileSizeZ), (s32)Parameters.TileCountZ - 1);
+
+		// missing tiles within the load distance, closest first
+		core::array<STileDistance> wanted;
+		for (s32 x = x0; x <= x1; ++x)
+		{
+			for (s32 z = z0; z <= z1; ++z)
+			{
+				const u32 tile = z * Parameters.TileCountX + x;
+				if (Tiles[tile].State != ETS_EMPTY)
+					continue;
+
+				STileDistance entry;
+				entry.Distance = getTileDistance(tile, position);
+				entry.Tile = tile;
+				if (entry.Distance <= distance)
+					wanted.push_back(entry);
+			}
+		}
+		wanted.sort();
+
+		for (u32 i = 0; i < wanted.size() && PendingTiles < MaxPendingTiles; ++i)
+		{
+			const u32 tile = wanted[i].Tile;
+
+			// make room by removing tiles farther away than the new one
+			while (getMemoryUsage() + TileMemory > Parameters.MemoryBudget && !LoadedTiles.empty())
+			{
+				u32 farthest = 0;
+				f32 farthestDistance = getTileDistance(LoadedTiles[0], position);
+				for (u32 j = 1; j < LoadedTiles.size(); ++j)
+				{
+					const f32 d = getTileDistance(LoadedTiles[j], position);
+					if (d > farthestDistance)
+					{
+						farthest = j;
+						farthestDistance = d;
+					}
+				}
+
+				if (farthestDistance <= wanted[i].Distance)
+					break;
+
+				removeTile(LoadedTiles[farthest]);
+			}
+
+			if (getMemoryUsage() + TileMemory > Parameters.MemoryBudget)
+				break;
+
+			const u32 tileX = tile % Parameters.TileCountX;
+			const u32 tileZ = tile / Parameters.TileCountX;
+
+			io::path name;
+			getTileName(name, Parameters.TileNames, tileX, tileZ);
+
+			io::IReadFile* file = FileSystem->createAndOpenFile(name);
+			if (!file)
+			{
+				Tiles[tile].State = ETS_MISSING;
+				continue;
+			}
+
+			CMeshBuffer<video::S3DVertex2TCoords>* buffer = new CMeshBuffer<video::S3DVertex2TCoords>(
+				SceneManager->getVideoDriver()->getVertexDescriptor(1), Indices->getType());
+			buffer->setIndexBuffer(Indices);
+			buffer->setHardwareMappingHint(scene::EHM_STATIC, scene::EBT_VERTEX);
+
+			CTerrainTileRequest* request = new CTerrainTileRequest(this, tile, tileX, tileZ,
+				name, file, buffer, PatchCount);
+			file->drop();
+
+			Tiles[tile].State = ETS_PENDING;
+			Tiles[tile].Buffer = buffer;
+			Tiles[tile].Request = request;
+			++PendingTiles;
+
+			Loader->add(request);
+		}
+	}
+
+
+	//! Called by the request of a tile on the main thread when it is loaded.
+	void CPagedTerrainSceneNode::tileLoaded(CTerrainTileRequest* request)
+	{
+		STile& tile = Tiles[request->Tile];
+		--PendingTiles;
+
+		if (request->Success)
+		{
+			tile.State = ETS_LOADED;
+			tile.Box = request->Box;
+			tile.PatchBoxes.swap(request->PatchBoxes);
+			tile.Buffer->setDirty(scene::EBT_VERTEX);
+			LoadedTiles.push_back(request->Tile);
+
+			Box.MinEdge.Y = core::min_(Box.MinEdge.Y, tile.Box.MinEdge.Y);
+			Box.MaxEdge.Y = core::max_(Box.MaxEdge.Y, tile.Box.MaxEdge.Y);
+		}
+		else
+		{
+			os::Printer::log("Could not load terrain tile", request->getName(), ELL_WARNING);
+			tile.State = ETS_MISSING;
+			tile.Buffer->drop();
+			tile.Buffer = 0;
+		}
+
+		tile.Request = 0;
+		request->drop();
+	}
+
+
+	//! Builds the name of a tile from the TileNames of the parameters.
+	bool CPagedTerrainSceneNode::getTileName(io::path& name, const io::path& format, u32 x, u32 z)
+	{
+		// the names are not given to snprintf, they come from the user
+		name = "";
+		u32 conversions = 0;
+
+		for (u32 i = 0; i < format.size(); ++i)
+		{
+			if (format[i] != '%')
+			{
+				name.append(format[i]);
+				continue;
+			}
+
+			++i;
+			if (i < format.size() && format[i] == '%')
+				name.append('%');
+			else if (i < format.size() && (format[i] == 'd' || format[i] == 'u') && conversions < 2)
+				name += io::path(conversions++ ? z : x);
+			else
+				return false;
+		}
+
+		return conversions == 2;
+	}
+
+
+	//! Removes a loaded tile.
+	void CPagedTerrainSceneNode::removeTile(u32 tile)
+	{
+		Tiles[tile].State = ETS_EMPTY;
+		Tiles[tile].Buffer->drop();
+		Tiles[tile].Buffer = 0;
+		Tiles[tile].PatchBoxes.clear();
+
+		const s32 i = LoadedTiles.linear_search(tile);
+		LoadedTiles[i] = LoadedTiles.getLast();
+		LoadedTiles.erase(LoadedTiles.size() - 1);
+	}
+
+
+	//! Distance of a position to a tile in the xz plane.
+	f32 CPagedTerrainSceneNode::getTileDistance(u32 tile, const core::vector3df& position) const
+	{
+		const f32 tileSizeX = (Parameters.TileSize - 1) * Parameters.Scale.X;
+		const f32 tileSizeZ = (Parameters.TileSize - 1) * Parameters.Scale.Z;
+		const f32 minX = (tile % Parameters.TileCountX) * tileSizeX;
+		const f32 minZ = (tile / Parameters.TileCountX) * tileSizeZ;
+
+		const f32 dx = core::max_(minX - position.X, position.X - minX - tileSizeX, 0.f);
+		const f32 dz = core::max_(minZ - position.Z, position.Z - minZ - tileSizeZ, 0.f);
+
+		return sqrtf(dx * dx + dz * dz);
+	}
+
+
+	//! Draws the visible patches of the loaded tiles.
+	void CPagedTerrainSceneNode::render()
+	{
+		ICameraSceneNode* camera = SceneManager->getActiveCamera();
+		if (!IsVisible || !camera || LoadedTiles.empty())
+			return;
+
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+		driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+		driver->setMaterial(Material);
+
+		SViewFrustum frust = *camera->getViewFrustum();
+		core::vector3df position = camera->getAbsolutePosition();
+		if (!AbsoluteTransformation.isIdentity())
+		{
+			core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+			frust.transform(invTrans);
+			invTrans.transformVect(position);
+		}
+
+		const u32 patches = PatchCount * PatchCount;
+		PatchLODs.set_used(patches);
+
+		for (u32 t = 0; t < LoadedTiles.size(); ++t)
+		{
+			const STile& tile = Tiles[LoadedTiles[t]];
+			if (!isBoxInFrustum(frust, tile.Box))
+				continue;
+
+			for (u32 p = 0; p < patches; ++p)
+			{
+				if (!isBoxInFrustum(frust, tile.PatchBoxes[p]))
+				{
+					PatchLODs[p] = Parameters.MaxLOD;
+					continue;
+				}
+
+				const f32 distance = getBoxDistance(tile.PatchBoxes[p], position);
+				u32 lod = 0;
+				for (f32 d = Parameters.LODDistance; lod + 1 < Parameters.MaxLOD && distance > d; d *= 2.f)
+					++lod;
+				PatchLODs[p] = lod;
+			}
+
+			// the patches of a level of detail are next to each other in the index buffer
+			for (u32 lod = 0; lod < Parameters.MaxLOD; ++lod)
+			{
+				SIndexRange draw = { 0, 0 };
+				for (u32 p = 0; p < patches; ++p)
+				{
+					if (PatchLODs[p] != lod)
+						continue;
+
+					const SIndexRange& range = PatchRanges[lod * patches + p];
+					if (draw.Count && draw.First + draw.Count == range.First)
+					{
+						draw.Count += range.Count;
+						continue;
+					}
+
+					if (draw.Count)
+						driver->drawMeshBufferRange(tile.Buffer, draw.First, draw.Count);
+					draw = range;
+				}
+
+				if (draw.Count)
+					driver->drawMeshBufferRange(tile.Buffer, draw.First, draw.Count);
+			}
+		}
+
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			video::SMaterial m;
+			m.Lighting = false;
+			driver->setMaterial(m);
+
+			for (u32 t = 0; t < LoadedTiles.size(); ++t)
+				driver->draw3DBox(Tiles[LoadedTiles[t]].Box, video::SColor(255, 255, 0, 0));
+		}
+	}
+
+
+	//! Returns the bounding box of the whole terrain.
+	const core::aabbox3d<f32>& CPagedTerrainSceneNode::getBoundingBox() const
+	{
+		return Box;
+	}
+
+
+	video::SMaterial& CPagedTerrainSceneNode::getMaterial(u32 i)
+	{
+		return Material;
+	}
+
+
+	u32 CPagedTerrainSceneNode::getMaterialCount() const
+	{
+		return 1;
+	}
+
+
+	const SPagedTerrainParameters& CPagedTerrainSceneNode::getParameters() const
+	{
+		return Parameters;
+	}
+
+
+	//! Get the height of the terrain at a position in world coordinates.
+	f32 CPagedTerrainSceneNode::getHeight(f32 x, f32 z) const
+	{
+		core::vector3df pos(x, 0.f, z);
+		core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+		invTrans.transformVect(pos);
+
+		const s32 size = (s32)Parameters.TileSize;
+		const f32 gx = pos.X / Parameters.Scale.X;
+		const f32 gz = pos.Z / Parameters.Scale.Z;
+
+		// the far edge of the terrain belongs to the last tile
+		const s32 tileX = core::min_(core::floor32(gx / (size - 1)), (s32)Parameters.TileCountX - 1);
+		const s32 tileZ = core::min_(core::floor32(gz / (size - 1)), (s32)Parameters.TileCountZ - 1);
+		if (gx < 0.f || gz < 0.f || gx > Parameters.TileCountX * (size - 1) || gz > Parameters.TileCountZ * (size - 1))
+			return -FLT_MAX;
+
+		const STile& tile = Tiles[tileZ * Parameters.TileCountX + tileX];
+		if (tile.State != ETS_LOADED)
+			return -FLT_MAX;
+
+		const f32 lx = gx - tileX * (size - 1);
+		const f32 lz = gz - tileZ * (size - 1);
+		const s32 X = core::min_(core::floor32(lx), size - 2);
+		const s32 Z = core::min_(core::floor32(lz), size - 2);
+
+		const video::S3DVertex2TCoords* vertices = static_cast<const video::S3DVertex2TCoords*>(
+			tile.Buffer->getVertexBuffer()->getVertices());
+		const f32 a = vertices[X * size + Z].Pos.Y;
+		const f32 b = vertices[(X + 1) * size + Z].Pos.Y;
+		const f32 c = vertices[X * size + Z + 1].Pos.Y;
+		const f32 d = vertices[(X + 1) * size + Z + 1].Pos.Y;
+
+		// offset from integer position
+		const f32 dx = lx - X;
+		const f32 dz = lz - Z;
+
+		if (dx > dz)
+			pos.Y = a + (d - b) * dz + (b - a) * dx;
+		else
+			pos.Y = a + (d - c) * dx + (c - a) * dz;
+
+		AbsoluteTransformation.transformVect(pos);
+		return pos.Y;
+	}
+
+
+	bool CPagedTerrainSceneNode::isTileLoaded(u32 x, u32 z) const
+	{
+		if (x >= Parameters.TileCountX || z >= Parameters.TileCountZ)
+			return false;
+
+		return Tiles[z * Parameters.TileCountX + x].State == ETS_LOADED;
+	}
+
+
+	u32 CPagedTerrainSceneNode::getLoadedTileCount() const
+	{
+		return LoadedTiles.size();
+	}
+
+
+	u32 CPagedTerrainSceneNode::getPendingTileCount() const
+	{
+		return PendingTiles;
+	}
+
+
+	u32 CPagedTerrainSceneNode::getMemoryUsage() const
+	{
+		return (LoadedTiles.size() + PendingTiles) * TileMemory;
+	}
+
+
+	void CPagedTerrainSceneNode::setLoadDistance(f32 distance)
+	{
+		Parameters.LoadDistance = distance;
+	}
+
+
+	void CPagedTerrainSceneNode::setMemoryBudget(u32 bytes)
+	{
+		Parameters.MemoryBudget = bytes;
+	}
+
+
+	//! Loads the tiles around a position in node coordinates right away.
+	void CPagedTerrainSceneNode::loadTiles(const core::vector3df& position)
+	{
+		for (;;)
+		{
+			updateTiles(position);
+			if (!PendingTiles)
+				break;
+
+			Loader->flush();
+		}
+	}
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,149 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_PAGED_TERRAIN_SCENE_NODE_H_INCLUDED__
+#define __C_PAGED_TERRAIN_SCENE_NODE_H_INCLUDED__
+
+#include "IPagedTerrainSceneNode.h"
+#include "IMeshBuffer.h"
+#include "CAssetLoader.h"
+
+namespace irr
+{
+namespace io
+{
+	class IFileSystem;
+} // end namespace io
+namespace scene
+{
+	class CTerrainTileRequest;
+
+	//! Terrain which loads its tiles around the camera in the background.
+	/** All tiles have the same layout of vertices, so they share one static
+	index buffer which contains the triangles of each patch at each level of
+	detail. Patches are drawn as ranges of it. */
+	class CPagedTerrainSceneNode : public IPagedTerrainSceneNode
+	{
+	public:
+
+		//! constructor
+		CPagedTerrainSceneNode(const SPagedTerrainParameters& parameters,
+			ISceneNode* parent, ISceneManager* mgr, io::IFileSystem* fs, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale);
+
+		//! destructor
+		virtual ~CPagedTerrainSceneNode();
+
+		//! Loads and removes tiles, and registers the node for rendering.
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! Draws the visible patches of the loaded tiles.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! Returns the bounding box of the whole terrain.
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_PAGED_TERRAIN; }
+
+		virtual const SPagedTerrainParameters& getParameters() const _IRR_OVERRIDE_;
+
+		virtual f32 getHeight(f32 x, f32 z) const _IRR_OVERRIDE_;
+
+		virtual bool isTileLoaded(u32 x, u32 z) const _IRR_OVERRIDE_;
+
+		virtual u32 getLoadedTileCount() const _IRR_OVERRIDE_;
+
+		virtual u32 getPendingTileCount() const _IRR_OVERRIDE_;
+
+		virtual u32 getMemoryUsage() const _IRR_OVERRIDE_;
+
+		virtual void setLoadDistance(f32 distance) _IRR_OVERRIDE_;
+
+		virtual void setMemoryBudget(u32 bytes) _IRR_OVERRIDE_;
+
+		virtual void loadTiles(const core::vector3df& position) _IRR_OVERRIDE_;
+
+		//! Called by the request of a tile on the main thread when it is loaded.
+		void tileLoaded(CTerrainTileRequest* request);
+
+		//! Builds the name of a tile from the TileNames of the parameters.
+		/** \return False if the names don't hold exactly two %d or %u. */
+		static bool getTileName(io::path& name, const io::path& format, u32 x, u32 z);
+
+	private:
+
+		enum E_TILE_STATE
+		{
+			ETS_EMPTY = 0,
+			ETS_PENDING,
+			ETS_LOADED,
+			ETS_MISSING
+		};
+
+		struct STile
+		{
+			STile() : State(ETS_EMPTY), Buffer(0), Request(0) {}
+
+			E_TILE_STATE State;
+			IMeshBuffer* Buffer;
+			CTerrainTileRequest* Request;
+			core::aabbox3d<f32> Box;
+			core::array<core::aabbox3d<f32> > PatchBoxes;
+		};
+
+		//! Range of the shared index buffer
+		struct SIndexRange
+		{
+			u32 First;
+			u32 Count;
+		};
+
+		//! Builds the shared index buffer and the ranges of the patches.
+		void createIndices();
+
+		//! Requests the missing tiles around a position and removes far away tiles.
+		void updateTiles(const core::vector3df& position);
+
+		//! Removes a loaded tile.
+		void removeTile(u32 tile);
+
+		//! Distance of a position to a tile in the xz plane.
+		f32 getTileDistance(u32 tile, const core::vector3df& position) const;
+
+		//! Number of vertices in each tile, with the skirts.
+		u32 getTileVertexCount() const;
+
+		SPagedTerrainParameters Parameters;
+		io::IFileSystem* FileSystem;
+		io::CAssetLoader* Loader;
+
+		core::array<STile> Tiles;
+		//! indices of the loaded tiles
+		core::array<u32> LoadedTiles;
+		u32 PendingTiles;
+		u32 MaxPendingTiles;
+		u32 TileMemory;
+
+		IIndexBuffer* Indices;
+		//! ranges of the patches, all patches of a level of detail after each other
+		core::array<SIndexRange> PatchRanges;
+		//! number of patches along the edge of a tile
+		u32 PatchCount;
+		//! level of detail of each patch of the tile being drawn
+		core::array<u32> PatchLODs;
+
+		video::SMaterial Material;
+		core::aabbox3d<f32> Box;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
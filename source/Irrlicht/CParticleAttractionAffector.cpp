@@ -4,6 +4,11 @@
 
 #include "CParticleAttractionAffector.h"
 #include "IAttributes.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
 
 namespace irr
 {
@@ -15,7 +20,8 @@ CParticleAttractionAffector::CParticleAttractionAffector(
 		const core::vector3df& point, f32 speed, bool attract,
 		bool affectX, bool affectY, bool affectZ )
 	: Point(point), Speed(speed), AffectX(affectX), AffectY(affectY),
-		AffectZ(affectZ), Attract(attract), LastTime(0)
+		AffectZ(affectZ), Attract(attract), LastTime(0), TimeDelta(0.f),
+		UseSSE2(os::Cpu::hasSSE2())
 {
 	#ifdef _DEBUG
 	setDebugName("CParticleAttractionAffector");
@@ -57,6 +63,77 @@ void CParticleAttractionAffector::affect(u32 now, SParticle* particlearray, u32
 	}
 }
 
+
+//! Prepares affecting ranges of particles.
+bool CParticleAttractionAffector::prepareAffect(u32 now)
+{
+	TimeDelta = LastTime ? (now - LastTime) / 1000.0f : 0.f;
+	LastTime = now;
+
+	return true;
+}
+
+
+//! Affects a range of particles.
+void CParticleAttractionAffector::affectRange(u32 now, SParticlePool& pool, u32 first, u32 count)
+{
+	if( !Enabled || TimeDelta == 0.f )
+		return;
+
+	f32* x = pool.PosX.pointer() + first;
+	f32* y = pool.PosY.pointer() + first;
+	f32* z = pool.PosZ.pointer() + first;
+
+	// distance moved along each axis, towards or away from the point
+	const f32 step = Attract ? Speed * TimeDelta : -Speed * TimeDelta;
+	const f32 stepX = AffectX ? step : 0.f;
+	const f32 stepY = AffectY ? step : 0.f;
+	const f32 stepZ = AffectZ ? step : 0.f;
+
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		const __m128 pointX = _mm_set1_ps(Point.X);
+		const __m128 pointY = _mm_set1_ps(Point.Y);
+		const __m128 pointZ = _mm_set1_ps(Point.Z);
+		const __m128 stepX4 = _mm_set1_ps(stepX);
+		const __m128 stepY4 = _mm_set1_ps(stepY);
+		const __m128 stepZ4 = _mm_set1_ps(stepZ);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 x4 = _mm_loadu_ps(x + i);
+			const __m128 y4 = _mm_loadu_ps(y + i);
+			const __m128 z4 = _mm_loadu_ps(z + i);
+			const __m128 dx = _mm_sub_ps(pointX, x4);
+			const __m128 dy = _mm_sub_ps(pointY, y4);
+			const __m128 dz = _mm_sub_ps(pointZ, z4);
+
+			// particles at the point don't move
+			const __m128 lengthSQ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			const __m128 invLength = _mm_and_ps(_mm_div_ps(one, _mm_sqrt_ps(lengthSQ)), _mm_cmpneq_ps(lengthSQ, zero));
+
+			_mm_storeu_ps(x + i, _mm_add_ps(x4, _mm_mul_ps(_mm_mul_ps(dx, invLength), stepX4)));
+			_mm_storeu_ps(y + i, _mm_add_ps(y4, _mm_mul_ps(_mm_mul_ps(dy, invLength), stepY4)));
+			_mm_storeu_ps(z + i, _mm_add_ps(z4, _mm_mul_ps(_mm_mul_ps(dz, invLength), stepZ4)));
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		const core::vector3df direction = core::vector3df(Point.X - x[i], Point.Y - y[i], Point.Z - z[i]).normalize();
+
+		x[i] += direction.X * stepX;
+		y[i] += direction.Y * stepY;
+		z[i] += direction.Z * stepZ;
+	}
+}
+
 //! Writes attributes of the object.
 void CParticleAttractionAffector::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
 {
@@ -6,6 +6,10 @@
 #include "IAttributes.h"
 #include "os.h"
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
+
 namespace irr
 {
 namespace scene
@@ -14,7 +18,7 @@ namespace scene
 //! constructor
 CParticleFadeOutAffector::CParticleFadeOutAffector(
 	const video::SColor& targetColor, u32 fadeOutTime)
-	: IParticleFadeOutAffector(), TargetColor(targetColor)
+	: IParticleFadeOutAffector(), TargetColor(targetColor), UseSSE2(os::Cpu::hasSSE2())
 {
 
 	#ifdef _DEBUG
@@ -44,6 +48,91 @@ void CParticleFadeOutAffector::affect(u32 now, SParticle* particlearray, u32 cou
 }
 
 
+//! Prepares affecting ranges of particles.
+bool CParticleFadeOutAffector::prepareAffect(u32 now)
+{
+	return true;
+}
+
+
+//! Affects a range of particles.
+void CParticleFadeOutAffector::affectRange(u32 now, SParticlePool& pool, u32 first, u32 count)
+{
+	if (!Enabled)
+		return;
+
+	const u32* endTime = pool.EndTime.const_pointer() + first;
+	const video::SColor* startColor = pool.StartColor.const_pointer() + first;
+	video::SColor* color = pool.Color.pointer() + first;
+
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i now4 = _mm_set1_epi32((s32)now);
+		const __m128 fadeOutTime = _mm_set1_ps(FadeOutTime);
+		const __m128 invFadeOutTime = _mm_set1_ps(1.f / FadeOutTime);
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 target = _mm_cvtepi32_ps(_mm_unpacklo_epi16(
+			_mm_unpacklo_epi8(_mm_cvtsi32_si128((s32)TargetColor.color), zero), zero));
+
+		for (; i + 4 <= count; i += 4)
+		{
+			// particles which are alive and within the fade out time
+			const __m128i remaining = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(endTime + i)), now4);
+			const __m128 remainingf = _mm_cvtepi32_ps(remaining);
+			const __m128i fading = _mm_andnot_si128(_mm_cmplt_epi32(remaining, zero),
+				_mm_castps_si128(_mm_cmplt_ps(remainingf, fadeOutTime)));
+
+			if (_mm_movemask_epi8(fading) == 0)
+				continue;
+
+			const __m128 d = _mm_mul_ps(remainingf, invFadeOutTime);
+
+			// the channels of each particle in one register
+			const __m128i start = _mm_loadu_si128((const __m128i*)(startColor + i));
+			const __m128i start01 = _mm_unpacklo_epi8(start, zero);
+			const __m128i start23 = _mm_unpackhi_epi8(start, zero);
+			__m128i channels[4];
+			channels[0] = _mm_unpacklo_epi16(start01, zero);
+			channels[1] = _mm_unpackhi_epi16(start01, zero);
+			channels[2] = _mm_unpacklo_epi16(start23, zero);
+			channels[3] = _mm_unpackhi_epi16(start23, zero);
+
+			__m128 dj[4];
+			dj[0] = _mm_shuffle_ps(d, d, _MM_SHUFFLE(0,0,0,0));
+			dj[1] = _mm_shuffle_ps(d, d, _MM_SHUFFLE(1,1,1,1));
+			dj[2] = _mm_shuffle_ps(d, d, _MM_SHUFFLE(2,2,2,2));
+			dj[3] = _mm_shuffle_ps(d, d, _MM_SHUFFLE(3,3,3,3));
+
+			for (u32 j = 0; j < 4; ++j)
+			{
+				const __m128 c = _mm_add_ps(_mm_mul_ps(target, _mm_sub_ps(one, dj[j])),
+					_mm_mul_ps(_mm_cvtepi32_ps(channels[j]), dj[j]));
+				channels[j] = _mm_cvttps_epi32(_mm_add_ps(c, half));
+			}
+
+			const __m128i faded = _mm_packus_epi16(_mm_packs_epi32(channels[0], channels[1]),
+				_mm_packs_epi32(channels[2], channels[3]));
+			const __m128i current = _mm_loadu_si128((const __m128i*)(color + i));
+
+			_mm_storeu_si128((__m128i*)(color + i), _mm_or_si128(_mm_and_si128(fading, faded),
+				_mm_andnot_si128(fading, current)));
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		if (endTime[i] - now < FadeOutTime)
+			color[i] = startColor[i].getInterpolated(TargetColor, (endTime[i] - now) / FadeOutTime);
+	}
+}
+
+
 //! Writes attributes of the object.
 //! Implement this to expose the attributes of your scene node animator for
 //! scripting languages, editors, debuggers or xml serialization purposes.
@@ -23,6 +23,12 @@ public:
 	//! Affects a particle.
 	virtual void affect(u32 now, SParticle* particlearray, u32 count) _IRR_OVERRIDE_;
 
+	//! Prepares affecting ranges of particles.
+	virtual bool prepareAffect(u32 now) _IRR_OVERRIDE_;
+
+	//! Affects a range of particles.
+	virtual void affectRange(u32 now, SParticlePool& pool, u32 first, u32 count) _IRR_OVERRIDE_;
+
 	//! Sets the targetColor, i.e. the color the particles will interpolate
 	//! to over time.
 	virtual void setTargetColor( const video::SColor& targetColor ) _IRR_OVERRIDE_ { TargetColor = targetColor; }
@@ -53,6 +59,7 @@ private:
 
 	video::SColor TargetColor;
 	f32 FadeOutTime;
+	bool UseSSE2;
 };
 
 } // end namespace scene
@@ -6,6 +6,21 @@
 #include "os.h"
 #include "IAttributes.h"
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+
+namespace
+{
+	// converts unsigned integers, like the u32 to f32 conversion of the C++ code
+	inline __m128 convertUnsigned(__m128i v)
+	{
+		const __m128 high = _mm_cvtepi32_ps(_mm_srli_epi32(v, 1));
+		const __m128 low = _mm_cvtepi32_ps(_mm_and_si128(v, _mm_set1_epi32(1)));
+		return _mm_add_ps(_mm_add_ps(high, high), low);
+	}
+}
+#endif
+
 namespace irr
 {
 namespace scene
@@ -14,7 +29,8 @@ namespace scene
 //! constructor
 CParticleGravityAffector::CParticleGravityAffector(
 	const core::vector3df& gravity, u32 timeForceLost)
-	: IParticleGravityAffector(), TimeForceLost(static_cast<f32>(timeForceLost)), Gravity(gravity)
+	: IParticleGravityAffector(), TimeForceLost(static_cast<f32>(timeForceLost)), Gravity(gravity),
+	UseSSE2(os::Cpu::hasSSE2())
 {
 	#ifdef _DEBUG
 	setDebugName("CParticleGravityAffector");
@@ -42,6 +58,66 @@ void CParticleGravityAffector::affect(u32 now, SParticle* particlearray, u32 cou
 	}
 }
 
+//! Prepares affecting ranges of particles.
+bool CParticleGravityAffector::prepareAffect(u32 now)
+{
+	return true;
+}
+
+
+//! Affects a range of particles.
+void CParticleGravityAffector::affectRange(u32 now, SParticlePool& pool, u32 first, u32 count)
+{
+	if (!Enabled)
+		return;
+
+	const u32* startTime = pool.StartTime.const_pointer() + first;
+	const f32* startX = pool.StartVectorX.const_pointer() + first;
+	const f32* startY = pool.StartVectorY.const_pointer() + first;
+	const f32* startZ = pool.StartVectorZ.const_pointer() + first;
+	f32* vectorX = pool.VectorX.pointer() + first;
+	f32* vectorY = pool.VectorY.pointer() + first;
+	f32* vectorZ = pool.VectorZ.pointer() + first;
+
+	const f32 invTime = 1.f / TimeForceLost;
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		const __m128i now4 = _mm_set1_epi32((s32)now);
+		const __m128 invTime4 = _mm_set1_ps(invTime);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 gravityX = _mm_set1_ps(Gravity.X);
+		const __m128 gravityY = _mm_set1_ps(Gravity.Y);
+		const __m128 gravityZ = _mm_set1_ps(Gravity.Z);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i age = _mm_sub_epi32(now4, _mm_loadu_si128((const __m128i*)(startTime + i)));
+			__m128 d = _mm_mul_ps(convertUnsigned(age), invTime4);
+			d = _mm_min_ps(_mm_max_ps(d, zero), one);
+
+			// d is the weight of the gravity, 1-d the weight of the start vector
+			_mm_storeu_ps(vectorX + i, _mm_add_ps(_mm_mul_ps(gravityX, d), _mm_mul_ps(_mm_loadu_ps(startX + i), _mm_sub_ps(one, d))));
+			_mm_storeu_ps(vectorY + i, _mm_add_ps(_mm_mul_ps(gravityY, d), _mm_mul_ps(_mm_loadu_ps(startY + i), _mm_sub_ps(one, d))));
+			_mm_storeu_ps(vectorZ + i, _mm_add_ps(_mm_mul_ps(gravityZ, d), _mm_mul_ps(_mm_loadu_ps(startZ + i), _mm_sub_ps(one, d))));
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		const f32 d = core::clamp((now - startTime[i]) * invTime, 0.f, 1.f);
+
+		vectorX[i] = Gravity.X * d + startX[i] * (1.f - d);
+		vectorY[i] = Gravity.Y * d + startY[i] * (1.f - d);
+		vectorZ[i] = Gravity.Z * d + startZ[i] * (1.f - d);
+	}
+}
+
+
 //! Writes attributes of the object.
 void CParticleGravityAffector::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
 {
@@ -25,6 +25,12 @@ public:
 	//! Affects a particle.
 	virtual void affect(u32 now, SParticle* particlearray, u32 count) _IRR_OVERRIDE_;
 
+	//! Prepares affecting ranges of particles.
+	virtual bool prepareAffect(u32 now) _IRR_OVERRIDE_;
+
+	//! Affects a range of particles.
+	virtual void affectRange(u32 now, SParticlePool& pool, u32 first, u32 count) _IRR_OVERRIDE_;
+
 	//! Set the time in milliseconds when the gravity force is totally
 	//! lost and the particle does not move any more.
 	virtual void setTimeForceLost( f32 timeForceLost ) _IRR_OVERRIDE_ { TimeForceLost = timeForceLost; }
@@ -54,6 +60,7 @@ public:
 private:
 	f32 TimeForceLost;
 	core::vector3df Gravity;
+	bool UseSSE2;
 };
 
 } // end namespace scene
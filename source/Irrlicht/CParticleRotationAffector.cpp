@@ -4,15 +4,62 @@
 
 #include "CParticleRotationAffector.h"
 #include "IAttributes.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
 
 namespace irr
 {
 namespace scene
 {
 
+namespace
+{
+	// rotates the coordinates a and b of a range of particles around the pivot, in the same way as vector3df::rotateXYBy
+	void rotateRange(f32* a, f32* b, u32 count, f32 degrees, f32 pivotA, f32 pivotB, bool useSSE2)
+	{
+		const f32 cs = (f32)cos(degrees * core::DEGTORAD64);
+		const f32 sn = (f32)sin(degrees * core::DEGTORAD64);
+
+		u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		if (useSSE2)
+		{
+			const __m128 cs4 = _mm_set1_ps(cs);
+			const __m128 sn4 = _mm_set1_ps(sn);
+			const __m128 pivotA4 = _mm_set1_ps(pivotA);
+			const __m128 pivotB4 = _mm_set1_ps(pivotB);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 a4 = _mm_sub_ps(_mm_loadu_ps(a + i), pivotA4);
+				const __m128 b4 = _mm_sub_ps(_mm_loadu_ps(b + i), pivotB4);
+
+				_mm_storeu_ps(a + i, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(a4, cs4), _mm_mul_ps(b4, sn4)), pivotA4));
+				_mm_storeu_ps(b + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(a4, sn4), _mm_mul_ps(b4, cs4)), pivotB4));
+			}
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			const f32 ai = a[i] - pivotA;
+			const f32 bi = b[i] - pivotB;
+
+			a[i] = ai * cs - bi * sn + pivotA;
+			b[i] = ai * sn + bi * cs + pivotB;
+		}
+	}
+}
+
+
 //! constructor
 CParticleRotationAffector::CParticleRotationAffector( const core::vector3df& speed, const core::vector3df& pivotPoint )
-		: PivotPoint(pivotPoint), Speed(speed), LastTime(0)
+		: PivotPoint(pivotPoint), Speed(speed), LastTime(0), TimeDelta(0.f),
+		UseSSE2(os::Cpu::hasSSE2())
 {
 	#ifdef _DEBUG
 	setDebugName("CParticleRotationAffector");
@@ -48,6 +95,37 @@ void CParticleRotationAffector::affect(u32 now, SParticle* particlearray, u32 co
 	}
 }
 
+
+//! Prepares affecting ranges of particles.
+bool CParticleRotationAffector::prepareAffect(u32 now)
+{
+	TimeDelta = LastTime ? (now - LastTime) / 1000.0f : 0.f;
+	LastTime = now;
+
+	return true;
+}
+
+
+//! Affects a range of particles.
+void CParticleRotationAffector::affectRange(u32 now, SParticlePool& pool, u32 first, u32 count)
+{
+	if( !Enabled || TimeDelta == 0.f )
+		return;
+
+	f32* x = pool.PosX.pointer() + first;
+	f32* y = pool.PosY.pointer() + first;
+	f32* z = pool.PosZ.pointer() + first;
+
+	if( Speed.X != 0.0f )
+		rotateRange(y, z, count, TimeDelta * Speed.X, PivotPoint.Y, PivotPoint.Z, UseSSE2);
+
+	if( Speed.Y != 0.0f )
+		rotateRange(x, z, count, TimeDelta * Speed.Y, PivotPoint.X, PivotPoint.Z, UseSSE2);
+
+	if( Speed.Z != 0.0f )
+		rotateRange(x, y, count, TimeDelta * Speed.Z, PivotPoint.X, PivotPoint.Y, UseSSE2);
+}
+
 //! Writes attributes of the object.
 void CParticleRotationAffector::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
 {
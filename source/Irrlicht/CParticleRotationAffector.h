@@ -23,6 +23,12 @@ public:
 	//! Affects a particle.
 	virtual void affect(u32 now, SParticle* particlearray, u32 count) _IRR_OVERRIDE_;
 
+	//! Prepares affecting ranges of particles.
+	virtual bool prepareAffect(u32 now) _IRR_OVERRIDE_;
+
+	//! Affects a range of particles.
+	virtual void affectRange(u32 now, SParticlePool& pool, u32 first, u32 count) _IRR_OVERRIDE_;
+
 	//! Set the point that particles will attract to
 	virtual void setPivotPoint( const core::vector3df& point ) _IRR_OVERRIDE_ { PivotPoint = point; }
 
@@ -46,6 +52,9 @@ private:
 	core::vector3df PivotPoint;
 	core::vector3df Speed;
 	u32 LastTime;
+	//! time since the last frame in seconds, set by prepareAffect()
+	f32 TimeDelta;
+	bool UseSSE2;
 };
 
 } // end namespace scene
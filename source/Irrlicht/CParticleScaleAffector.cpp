@@ -4,13 +4,29 @@
 
 #include "CParticleScaleAffector.h"
 #include "IAttributes.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+
+namespace
+{
+	// converts unsigned integers, like the u32 to f32 conversion of the C++ code
+	inline __m128 convertUnsigned(__m128i v)
+	{
+		const __m128 high = _mm_cvtepi32_ps(_mm_srli_epi32(v, 1));
+		const __m128 low = _mm_cvtepi32_ps(_mm_and_si128(v, _mm_set1_epi32(1)));
+		return _mm_add_ps(_mm_add_ps(high, high), low);
+	}
+}
+#endif
 
 namespace irr
 {
 	namespace scene
 	{
 		CParticleScaleAffector::CParticleScaleAffector(const core::dimension2df& scaleTo)
-			: ScaleTo(scaleTo)
+			: ScaleTo(scaleTo), UseSSE2(os::Cpu::hasSSE2())
 		{
 			#ifdef _DEBUG
 			setDebugName("CParticleScaleAffector");
@@ -30,6 +46,52 @@ namespace irr
 		}
 
 
+		bool CParticleScaleAffector::prepareAffect(u32 now)
+		{
+			return true;
+		}
+
+
+		void CParticleScaleAffector::affectRange(u32 now, SParticlePool& pool, u32 first, u32 count)
+		{
+			const u32* startTime = pool.StartTime.const_pointer() + first;
+			const u32* endTime = pool.EndTime.const_pointer() + first;
+			const f32* startWidth = pool.StartWidth.const_pointer() + first;
+			const f32* startHeight = pool.StartHeight.const_pointer() + first;
+			f32* width = pool.Width.pointer() + first;
+			f32* height = pool.Height.pointer() + first;
+
+			u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if (UseSSE2)
+			{
+				const __m128i now4 = _mm_set1_epi32((s32)now);
+				const __m128 scaleWidth = _mm_set1_ps(ScaleTo.Width);
+				const __m128 scaleHeight = _mm_set1_ps(ScaleTo.Height);
+
+				for (; i + 4 <= count; i += 4)
+				{
+					const __m128i start = _mm_loadu_si128((const __m128i*)(startTime + i));
+					const __m128i end = _mm_loadu_si128((const __m128i*)(endTime + i));
+					const __m128 scale = _mm_div_ps(convertUnsigned(_mm_sub_epi32(now4, start)),
+						convertUnsigned(_mm_sub_epi32(end, start)));
+
+					_mm_storeu_ps(width + i, _mm_add_ps(_mm_loadu_ps(startWidth + i), _mm_mul_ps(scaleWidth, scale)));
+					_mm_storeu_ps(height + i, _mm_add_ps(_mm_loadu_ps(startHeight + i), _mm_mul_ps(scaleHeight, scale)));
+				}
+			}
+#endif
+
+			for (; i < count; ++i)
+			{
+				const f32 scale = (f32)(now - startTime[i]) / (endTime[i] - startTime[i]);
+				width[i] = startWidth[i] + ScaleTo.Width * scale;
+				height[i] = startHeight[i] + ScaleTo.Height * scale;
+			}
+		}
+
+
 		void CParticleScaleAffector::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
 		{
 			out->addFloat("ScaleToWidth", ScaleTo.Width);
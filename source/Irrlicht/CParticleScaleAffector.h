@@ -18,6 +18,12 @@ namespace irr
 
 			virtual void affect(u32 now, SParticle *particlearray, u32 count) _IRR_OVERRIDE_;
 
+			//! Prepares affecting ranges of particles.
+			virtual bool prepareAffect(u32 now) _IRR_OVERRIDE_;
+
+			//! Affects a range of particles.
+			virtual void affectRange(u32 now, SParticlePool& pool, u32 first, u32 count) _IRR_OVERRIDE_;
+
 			//! Writes attributes of the object.
 			//! Implement this to expose the attributes of your scene node animator for
 			//! scripting languages, editors, debuggers or xml serialization purposes.
@@ -35,6 +41,7 @@ namespace irr
 
 		protected:
 			core::dimension2df ScaleTo;
+			bool UseSSE2;
 		};
 	}
 }
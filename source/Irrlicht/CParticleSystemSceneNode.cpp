@@ -7,6 +7,7 @@
 #include "ISceneManager.h"
 #include "ICameraSceneNode.h"
 #include "IVideoDriver.h"
+#include "IVertexDescriptor.h"
 
 #include "CParticleAnimatedMeshSceneNodeEmitter.h"
 #include "CParticleBoxEmitter.h"
@@ -22,19 +23,29 @@
 #include "CParticleScaleAffector.h"
 #include "SViewFrustum.h"
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
+
 namespace irr
 {
 namespace scene
 {
 
+//! number of particles in each part the thread pool works on
+static const u32 PARTICLE_PART_SIZE = 4096;
+
 //! constructor
 CParticleSystemSceneNode::CParticleSystemSceneNode(bool createDefaultEmitter,
 	ISceneNode* parent, ISceneManager* mgr, s32 id,
 	const core::vector3df& position, const core::vector3df& rotation,
 	const core::vector3df& scale)
 	: IParticleSystemSceneNode(parent, mgr, id, position, rotation, scale),
-	Emitter(0), ParticleSize(core::dimension2d<f32>(5.0f, 5.0f)), LastEmitTime(0),
-	MeshBuffer(0), VertexBuffer(0), IndexBuffer(0), ParticlesAreGlobal(true)
+	Emitter(0), MaxParticleCount(16250), UseSSE2(os::Cpu::hasSSE2()),
+	SimulationTime(0), TimeScale(0.f), Animate(false),
+	ParticleSize(core::dimension2d<f32>(5.0f, 5.0f)), LastEmitTime(0),
+	MeshBuffer(0), VertexBuffer(0), IndexBuffer(0), InstancedBuffer(0), InstanceBuffer(0),
+	InstancedBillboards(false), ParticlesAreGlobal(true)
 {
 	#ifdef _DEBUG
 	setDebugName("CParticleSystemSceneNode");
@@ -63,6 +74,9 @@ CParticleSystemSceneNode::~CParticleSystemSceneNode()
 	if (MeshBuffer)
 		MeshBuffer->drop();
 
+	if (InstancedBuffer)
+		InstancedBuffer->drop();
+
 	removeAllAffectors();
 }
 
@@ -314,76 +328,56 @@ void CParticleSystemSceneNode::render()
 	video::IVideoDriver* driver = SceneManager->getVideoDriver();
 	ICameraSceneNode* camera = SceneManager->getActiveCamera();
 
-	if (!camera || !driver)
+	// drawing no instances is an error on some drivers
+	if (!camera || !driver || !Particles.size())
 		return;
 
-
-#if 0
-	// calculate vectors for letting particles look to camera
-	core::vector3df view(camera->getTarget() - camera->getAbsolutePosition());
-	view.normalize();
-
-	view *= -1.0f;
-
-#else
-
+	// let the particles look to the camera
 	const core::matrix4 &m = camera->getViewFrustum()->getTransform( video::ETS_VIEW );
 
-	const core::vector3df view ( -m[2], -m[6] , -m[10] );
+	CameraRight.set(m[0], m[4], m[8]);
+	CameraUp.set(m[1], m[5], m[9]);
+	CameraView.set(-m[2], -m[6], -m[10]);
 
-#endif
-
-	// reallocate arrays, if they are too small
-	reallocateBuffers();
+	const u32 parts = (Particles.size() + PARTICLE_PART_SIZE - 1) / PARTICLE_PART_SIZE;
 
-	// create particle vertex data
-	video::S3DVertex* vertices = static_cast<video::S3DVertex*>(VertexBuffer->getVertices());
+	// without instancing, or with a built-in material which has no vertex
+	// shader to expand the quad, the particles are drawn as usual billboards
+	const bool instanced = InstancedBillboards && driver->queryFeature(video::EVDF_INSTANCING) &&
+		MeshBuffer->getMaterial().MaterialType > video::EMT_ONETEXTURE_BLEND;
 
-	s32 idx = 0;
-	for (u32 i=0; i<Particles.size(); ++i)
+	if (instanced)
 	{
-		const SParticle& particle = Particles[i];
-
-		#if 0
-			core::vector3df horizontal = camera->getUpVector().crossProduct(view);
-			horizontal.normalize();
-			horizontal *= 0.5f * particle.size.Width;
-
-			core::vector3df vertical = horizontal.crossProduct(view);
-			vertical.normalize();
-			vertical *= 0.5f * particle.size.Height;
-
-		#else
-			f32 f;
+		// one record per particle, the vertex shader expands the quad
+		InstanceBuffer->set_used(Particles.size());
 
-			f = 0.5f * particle.size.Width;
-			const core::vector3df horizontal ( m[0] * f, m[4] * f, m[8] * f );
-
-			f = -0.5f * particle.size.Height;
-			const core::vector3df vertical ( m[1] * f, m[5] * f, m[9] * f );
-		#endif
-
-		vertices[0+idx].Pos = particle.pos + horizontal + vertical;
-		vertices[0+idx].Color = particle.color;
-		vertices[0+idx].Normal = view;
-
-		vertices[1+idx].Pos = particle.pos + horizontal - vertical;
-		vertices[1+idx].Color = particle.color;
-		vertices[1+idx].Normal = view;
+		if (parts > 1)
+		{
+			CParticleJob job(this, CParticleJob::ET_INSTANCES);
+			CThreadPool::getSharedPool()->run(&job, parts);
+		}
+		else if (parts)
+			writeInstances(0);
 
-		vertices[2+idx].Pos = particle.pos - horizontal - vertical;
-		vertices[2+idx].Color = particle.color;
-		vertices[2+idx].Normal = view;
+		InstanceBuffer->setDirty();
+	}
+	else
+	{
+		// reallocate arrays, if they are too small
+		reallocateBuffers();
 
-		vertices[3+idx].Pos = particle.pos - horizontal + vertical;
-		vertices[3+idx].Color = particle.color;
-		vertices[3+idx].Normal = view;
+		// create particle vertex data
+		if (parts > 1)
+		{
+			CParticleJob job(this, CParticleJob::ET_VERTICES);
+			CThreadPool::getSharedPool()->run(&job, parts);
+		}
+		else if (parts)
+			writeVertices(0);
 
-		idx +=4;
+		VertexBuffer->setDirty();
 	}
 
-	VertexBuffer->setDirty();
-
 	// render all
 	core::matrix4 mat;
 	if (!ParticlesAreGlobal)
@@ -391,7 +385,7 @@ void CParticleSystemSceneNode::render()
 	driver->setTransform(video::ETS_WORLD, mat);
 
 	driver->setMaterial(MeshBuffer->getMaterial());
-	driver->drawMeshBuffer(MeshBuffer);
+	driver->drawMeshBuffer(instanced ? InstancedBuffer : MeshBuffer);
 
 
 	// for debug purposes only:
@@ -436,67 +430,94 @@ void CParticleSystemSceneNode::doParticleSystem(u32 time)
 		SParticle* array = 0;
 		s32 newParticles = Emitter->emitt(now, timediff, array);
 
-		if (newParticles && array)
+		if (newParticles > 0 && array)
 		{
-			s32 j=Particles.size();
-			if (newParticles > 16250-j)	// avoid having more than 64k vertices in the scenenode
-				newParticles=16250-j;
-			Particles.set_used(j+newParticles);
-			for (s32 i=j; i<j+newParticles; ++i)
+			const u32 j = Particles.size();
+			if ((u32)newParticles > MaxParticleCount - core::min_(j, MaxParticleCount))
+				newParticles = MaxParticleCount - core::min_(j, MaxParticleCount);
+			Particles.reallocate(j+newParticles);
+			for (s32 i=0; i<newParticles; ++i)
 			{
-				Particles[i]=array[i-j];
+				SParticle particle = array[i];
 
 				if ( ParticlesAreGlobal && behavior & EPB_EMITTER_FRAME_INTERPOLATION )
 				{
 					// Interpolate between current node transformations and last ones.
 					// (Lazy solution - calculating twice and interpolating results)
 					f32 randInterpolate = (f32)(os::Randomizer::rand() % 101) / 100.f;	// 0 to 1
-					core::vector3df posNow(Particles[i].pos);
-					core::vector3df posLast(Particles[i].pos);
+					core::vector3df posNow(particle.pos);
+					core::vector3df posLast(particle.pos);
 
 					AbsoluteTransformation.transformVect(posNow);
 					LastAbsoluteTransformation.transformVect(posLast);
-					Particles[i].pos = posNow.getInterpolated(posLast, randInterpolate);
+					particle.pos = posNow.getInterpolated(posLast, randInterpolate);
 
 					if ( !(behavior & EPB_EMITTER_VECTOR_IGNORE_ROTATION) )
 					{
-						core::vector3df vecNow(Particles[i].startVector);
-						core::vector3df vecOld(Particles[i].startVector);
+						core::vector3df vecNow(particle.startVector);
+						core::vector3df vecOld(particle.startVector);
 						AbsoluteTransformation.rotateVect(vecNow);
 						LastAbsoluteTransformation.rotateVect(vecOld);
-						Particles[i].startVector = vecNow.getInterpolated(vecOld, randInterpolate);
+						particle.startVector = vecNow.getInterpolated(vecOld, randInterpolate);
 
-						vecNow = Particles[i].vector;
-						vecOld = Particles[i].vector;
+						vecNow = particle.vector;
+						vecOld = particle.vector;
 						AbsoluteTransformation.rotateVect(vecNow);
 						LastAbsoluteTransformation.rotateVect(vecOld);
-						Particles[i].vector = vecNow.getInterpolated(vecOld, randInterpolate);
+						particle.vector = vecNow.getInterpolated(vecOld, randInterpolate);
 					}
 				}
 				else
 				{
 					if (ParticlesAreGlobal)
-						AbsoluteTransformation.transformVect(Particles[i].pos);
+						AbsoluteTransformation.transformVect(particle.pos);
 
 					if ( !(behavior & EPB_EMITTER_VECTOR_IGNORE_ROTATION) )
 					{
 						if (!ParticlesAreGlobal)
-							AbsoluteTransformation.rotateVect(Particles[i].pos);
+							AbsoluteTransformation.rotateVect(particle.pos);
 
-						AbsoluteTransformation.rotateVect(Particles[i].startVector);
-						AbsoluteTransformation.rotateVect(Particles[i].vector);
+						AbsoluteTransformation.rotateVect(particle.startVector);
+						AbsoluteTransformation.rotateVect(particle.vector);
 					}
 				}
+
+				Particles.push_back(particle);
 			}
 		}
 	}
 
-	// run affectors
+	SimulationTime = now;
+	TimeScale = (f32)timediff;
+	Animate = visible || behavior & EPB_INVISIBLE_ANIMATING;
+	RangeAffectors.set_used(0);
+
+	// run affectors, the ones with a range implementation are run together
+	// on parts of the particles, in the same pass which moves the particles
 	if ( visible || behavior & EPB_INVISIBLE_AFFECTING )
 	{
 		core::list<IParticleAffector*>::Iterator ait = AffectorList.begin();
 		for (; ait != AffectorList.end(); ++ait)
-			(*ait)->affect(now, Particles.pointer(), Particles.size());
+		{
+			if ((*ait)->prepareAffect(now))
+			{
+				RangeAffectors.push_back(*ait);
+			}
+			else
+			{
+				// keep the order of the affectors
+				if (RangeAffectors.size())
+				{
+					const bool animate = Animate;
+					Animate = false;
+					simulateParticles();
+					Animate = animate;
+					RangeAffectors.set_used(0);
+				}
+
+				affectCopy(*ait);
+			}
+		}
 	}
 
 	core::aabbox3d<f32>& boundingBox = MeshBuffer->getBoundingBox();
@@ -506,29 +527,33 @@ void CParticleSystemSceneNode::doParticleSystem(u32 time)
 	else
 		boundingBox.reset(core::vector3df(0, 0, 0));
 
+	simulateParticles();
+	RangeAffectors.set_used(0);
+
 	// animate all particles
-	if ( visible || behavior & EPB_INVISIBLE_ANIMATING )
+	if (Animate)
 	{
-		f32 scale = (f32)timediff;
-
-		for (u32 i=0; i<Particles.size();)
+		for (u32 i=0; i<PartMinEdges.size(); ++i)
 		{
-			// erase is pretty expensive!
-			if (now > Particles[i].endTime)
+			if (PartMinEdges[i].X <= PartMaxEdges[i].X)
 			{
-				// Particle order does not seem to matter.
-				// So we can delete by switching with last particle and deleting that one.
-				// This is a lot faster and speed is very important here as the erase otherwise
-				// can cause noticable freezes.
-				Particles[i] = Particles[Particles.size()-1];
-				Particles.erase( Particles.size()-1 );
+				boundingBox.addInternalPoint(PartMinEdges[i]);
+				boundingBox.addInternalPoint(PartMaxEdges[i]);
 			}
+		}
+
+		// erase is pretty expensive!
+		// Particle order does not seem to matter.
+		// So we can delete by switching with last particle and deleting that one.
+		// This is a lot faster and speed is very important here as the erase otherwise
+		// can cause noticable freezes.
+		const u32* endTime = Particles.EndTime.const_pointer();
+		for (u32 i=0; i<Particles.size();)
+		{
+			if (now > endTime[i])
+				Particles.swapRemove(i);
 			else
-			{
-				Particles[i].pos += (Particles[i].vector * scale);
-				boundingBox.addInternalPoint(Particles[i].pos);
 				++i;
-			}
 		}
 	}
 
@@ -562,7 +587,40 @@ void CParticleSystemSceneNode::setParticlesAreGlobal(bool global)
 //! Remove all currently visible particles
 void CParticleSystemSceneNode::clearParticles()
 {
-	Particles.set_used(0);
+	Particles.clear();
+}
+
+//! Get the number of particles which are alive.
+u32 CParticleSystemSceneNode::getParticleCount() const
+{
+	return Particles.size();
+}
+
+//! Sets the maximum number of particles which are alive at the same time.
+void CParticleSystemSceneNode::setMaxParticleCount(u32 count)
+{
+	MaxParticleCount = count;
+}
+
+//! Gets the maximum number of particles which are alive at the same time.
+u32 CParticleSystemSceneNode::getMaxParticleCount() const
+{
+	return MaxParticleCount;
+}
+
+//! Sets if the particles are drawn as instances of a single quad.
+void CParticleSystemSceneNode::setInstancedBillboards(bool instanced)
+{
+	if (instanced && !InstancedBuffer)
+		createInstancedBuffer();
+
+	InstancedBillboards = instanced;
+}
+
+//! Gets if the particles are drawn as instances of a single quad.
+bool CParticleSystemSceneNode::getInstancedBillboards() const
+{
+	return InstancedBillboards;
 }
 
 //! Sets if the node should be visible or not.
@@ -600,6 +658,10 @@ void CParticleSystemSceneNode::reallocateBuffers()
 
 	if (particleVertexCount != vertexCount || particleIndexCount != indexCount)
 	{
+		// more than 16384 particles need 32 bit indices
+		if (particleVertexCount > 65536 && IndexBuffer->getType() == video::EIT_16BIT)
+			IndexBuffer->setType(video::EIT_32BIT);
+
 		VertexBuffer->set_used(particleVertexCount);
 
 		video::S3DVertex* vertices = static_cast<video::S3DVertex*>(VertexBuffer->getVertices());
@@ -635,6 +697,264 @@ void CParticleSystemSceneNode::reallocateBuffers()
 }
 
 
+void CParticleSystemSceneNode::simulateParticles()
+{
+	const u32 parts = (Particles.size() + PARTICLE_PART_SIZE - 1) / PARTICLE_PART_SIZE;
+
+	PartMinEdges.set_used(parts);
+	PartMaxEdges.set_used(parts);
+
+	if (!RangeAffectors.size() && !Animate)
+		return;
+
+	if (parts > 1)
+	{
+		CParticleJob job(this, CParticleJob::ET_SIMULATE);
+		CThreadPool::getSharedPool()->run(&job, parts);
+	}
+	else if (parts)
+		simulatePart(0);
+}
+
+
+void CParticleSystemSceneNode::simulatePart(u32 part)
+{
+	const u32 first = part * PARTICLE_PART_SIZE;
+	const u32 count = core::min_(PARTICLE_PART_SIZE, Particles.size() - first);
+
+	for (u32 a=0; a<RangeAffectors.size(); ++a)
+		RangeAffectors[a]->affectRange(SimulationTime, Particles, first, count);
+
+	if (!Animate)
+		return;
+
+	// move the particles and find the box of the ones which stay alive
+	f32* posX = Particles.PosX.pointer() + first;
+	f32* posY = Particles.PosY.pointer() + first;
+	f32* posZ = Particles.PosZ.pointer() + first;
+	const f32* vectorX = Particles.VectorX.const_pointer() + first;
+	const f32* vectorY = Particles.VectorY.const_pointer() + first;
+	const f32* vectorZ = Particles.VectorZ.const_pointer() + first;
+	const u32* endTime = Particles.EndTime.const_pointer() + first;
+
+	core::vector3df minEdge(FLT_MAX, FLT_MAX, FLT_MAX);
+	core::vector3df maxEdge(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		const __m128 scale = _mm_set1_ps(TimeScale);
+		const __m128i now = _mm_set1_epi32((s32)SimulationTime);
+		const __m128 huge = _mm_set1_ps(FLT_MAX);
+		__m128 minX = huge, minY = huge, minZ = huge;
+		__m128 maxX = _mm_sub_ps(_mm_setzero_ps(), huge), maxY = maxX, maxZ = maxX;
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 x = _mm_add_ps(_mm_loadu_ps(posX + i), _mm_mul_ps(_mm_loadu_ps(vectorX + i), scale));
+			const __m128 y = _mm_add_ps(_mm_loadu_ps(posY + i), _mm_mul_ps(_mm_loadu_ps(vectorY + i), scale));
+			const __m128 z = _mm_add_ps(_mm_loadu_ps(posZ + i), _mm_mul_ps(_mm_loadu_ps(vectorZ + i), scale));
+			_mm_storeu_ps(posX + i, x);
+			_mm_storeu_ps(posY + i, y);
+			_mm_storeu_ps(posZ + i, z);
+
+			// particles whose end time passed are removed afterwards, life times fit into signed integers
+			const __m128 alive = _mm_castsi128_ps(_mm_cmpgt_epi32(
+				_mm_sub_epi32(_mm_loadu_si128((const __m128i*)(endTime + i)), now), _mm_set1_epi32(-1)));
+
+			minX = _mm_min_ps(minX, _mm_or_ps(_mm_and_ps(alive, x), _mm_andnot_ps(alive, huge)));
+			minY = _mm_min_ps(minY, _mm_or_ps(_mm_and_ps(alive, y), _mm_andnot_ps(alive, huge)));
+			minZ = _mm_min_ps(minZ, _mm_or_ps(_mm_and_ps(alive, z), _mm_andnot_ps(alive, huge)));
+			maxX = _mm_max_ps(maxX, _mm_or_ps(_mm_and_ps(alive, x), _mm_andnot_ps(alive, _mm_sub_ps(_mm_setzero_ps(), huge))));
+			maxY = _mm_max_ps(maxY, _mm_or_ps(_mm_and_ps(alive, y), _mm_andnot_ps(alive, _mm_sub_ps(_mm_setzero_ps(), huge))));
+			maxZ = _mm_max_ps(maxZ, _mm_or_ps(_mm_and_ps(alive, z), _mm_andnot_ps(alive, _mm_sub_ps(_mm_setzero_ps(), huge))));
+		}
+
+		f32 edges[6][4];
+		_mm_storeu_ps(edges[0], minX);
+		_mm_storeu_ps(edges[1], minY);
+		_mm_storeu_ps(edges[2], minZ);
+		_mm_storeu_ps(edges[3], maxX);
+		_mm_storeu_ps(edges[4], maxY);
+		_mm_storeu_ps(edges[5], maxZ);
+		for (u32 k=0; k<4; ++k)
+		{
+			minEdge.X = core::min_(minEdge.X, edges[0][k]);
+			minEdge.Y = core::min_(minEdge.Y, edges[1][k]);
+			minEdge.Z = core::min_(minEdge.Z, edges[2][k]);
+			maxEdge.X = core::max_(maxEdge.X, edges[3][k]);
+			maxEdge.Y = core::max_(maxEdge.Y, edges[4][k]);
+			maxEdge.Z = core::max_(maxEdge.Z, edges[5][k]);
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		posX[i] += vectorX[i] * TimeScale;
+		posY[i] += vectorY[i] * TimeScale;
+		posZ[i] += vectorZ[i] * TimeScale;
+
+		if (SimulationTime <= endTime[i])
+		{
+			minEdge.X = core::min_(minEdge.X, posX[i]);
+			minEdge.Y = core::min_(minEdge.Y, posY[i]);
+			minEdge.Z = core::min_(minEdge.Z, posZ[i]);
+			maxEdge.X = core::max_(maxEdge.X, posX[i]);
+			maxEdge.Y = core::max_(maxEdge.Y, posY[i]);
+			maxEdge.Z = core::max_(maxEdge.Z, posZ[i]);
+		}
+	}
+
+	PartMinEdges[part] = minEdge;
+	PartMaxEdges[part] = maxEdge;
+}
+
+
+void CParticleSystemSceneNode::writeVertices(u32 part)
+{
+	const u32 first = part * PARTICLE_PART_SIZE;
+	const u32 end = core::min_(first + PARTICLE_PART_SIZE, Particles.size());
+
+	video::S3DVertex* vertices = static_cast<video::S3DVertex*>(VertexBuffer->getVertices()) + first * 4;
+
+	for (u32 i=first; i<end; ++i)
+	{
+		const core::vector3df pos(Particles.PosX[i], Particles.PosY[i], Particles.PosZ[i]);
+		const core::vector3df horizontal(CameraRight * (0.5f * Particles.Width[i]));
+		const core::vector3df vertical(CameraUp * (-0.5f * Particles.Height[i]));
+		const video::SColor color = Particles.Color[i];
+
+		vertices[0].Pos = pos + horizontal + vertical;
+		vertices[0].Color = color;
+		vertices[0].Normal = CameraView;
+
+		vertices[1].Pos = pos + horizontal - vertical;
+		vertices[1].Color = color;
+		vertices[1].Normal = CameraView;
+
+		vertices[2].Pos = pos - horizontal - vertical;
+		vertices[2].Color = color;
+		vertices[2].Normal = CameraView;
+
+		vertices[3].Pos = pos - horizontal + vertical;
+		vertices[3].Color = color;
+		vertices[3].Normal = CameraView;
+
+		vertices += 4;
+	}
+}
+
+
+void CParticleSystemSceneNode::writeInstances(u32 part)
+{
+	const u32 first = part * PARTICLE_PART_SIZE;
+	const u32 end = core::min_(first + PARTICLE_PART_SIZE, Particles.size());
+
+	SParticleInstance* instances = static_cast<SParticleInstance*>(InstanceBuffer->getVertices()) + first;
+
+	for (u32 i=first; i<end; ++i)
+	{
+		instances->Pos.set(Particles.PosX[i], Particles.PosY[i], Particles.PosZ[i]);
+		instances->Size.set(Particles.Width[i], Particles.Height[i]);
+		instances->Color = Particles.Color[i];
+
+		++instances;
+	}
+}
+
+
+void CParticleSystemSceneNode::createInstancedBuffer()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	video::IVertexDescriptor* descriptor = driver->getVertexDescriptor("ParticleInstance");
+
+	if (!descriptor)
+	{
+		video::IVertexDescriptor* stdv = driver->getVertexDescriptor(0);
+		descriptor = driver->addVertexDescriptor("ParticleInstance");
+
+		for (u32 i = 0; i < stdv->getAttributeCount(); ++i)
+		{
+			descriptor->addAttribute(stdv->getAttribute(i)->getName(), stdv->getAttribute(i)->getElementCount(), stdv->getAttribute(i)->getSemantic(), stdv->getAttribute(i)->getType(), stdv->getAttribute(i)->getBufferID());
+		}
+
+		descriptor->addAttribute("ParticlePosition", 3, video::EVAS_TEXCOORD1, video::EVAT_FLOAT, 1);
+		descriptor->addAttribute("ParticleSize", 2, video::EVAS_TEXCOORD2, video::EVAT_FLOAT, 1);
+		descriptor->addAttribute("ParticleColor", 4, video::EVAS_TEXCOORD3, video::EVAT_UBYTE, 1);
+
+		descriptor->setInstanceDataStepRate(video::EIDSR_PER_INSTANCE, 1);
+	}
+
+	InstancedBuffer = new CMeshBuffer<video::S3DVertex>(descriptor);
+
+	// the corners of the quad, in the same order as the vertices of the other particles
+	IVertexBuffer* quad = InstancedBuffer->getVertexBuffer(0);
+	video::S3DVertex corner(0.5f, 0.5f, 0.f, 0.f, 0.f, -1.f, video::SColor(255,255,255,255), 0.f, 0.f);
+	quad->addVertex(&corner);
+	corner.Pos.Y = -0.5f;
+	corner.TCoords.Y = 1.f;
+	quad->addVertex(&corner);
+	corner.Pos.X = -0.5f;
+	corner.TCoords.X = 1.f;
+	quad->addVertex(&corner);
+	corner.Pos.Y = 0.5f;
+	corner.TCoords.Y = 0.f;
+	quad->addVertex(&corner);
+
+	IIndexBuffer* indices = InstancedBuffer->getIndexBuffer();
+	indices->addIndex(0);
+	indices->addIndex(2);
+	indices->addIndex(1);
+	indices->addIndex(0);
+	indices->addIndex(3);
+	indices->addIndex(2);
+
+	InstanceBuffer = new CVertexBuffer<SParticleInstance>();
+	InstancedBuffer->addVertexBuffer(InstanceBuffer);
+	InstanceBuffer->drop();
+
+	quad->setHardwareMappingHint(scene::EHM_STATIC);
+	indices->setHardwareMappingHint(scene::EHM_STATIC);
+	InstanceBuffer->setHardwareMappingHint(scene::EHM_STREAM);
+}
+
+
+void CParticleSystemSceneNode::affectCopy(IParticleAffector* affector)
+{
+	const u32 count = Particles.size();
+
+	CopiedParticles.set_used(count);
+	for (u32 i=0; i<count; ++i)
+		CopiedParticles[i] = Particles.get(i);
+
+	affector->affect(SimulationTime, CopiedParticles.pointer(), count);
+
+	for (u32 i=0; i<count; ++i)
+		Particles.set(i, CopiedParticles[i]);
+}
+
+
+void CParticleSystemSceneNode::CParticleJob::run(u32 index, u32 thread)
+{
+	switch (Task)
+	{
+	case ET_SIMULATE:
+		Node->simulatePart(index);
+		break;
+	case ET_VERTICES:
+		Node->writeVertices(index);
+		break;
+	case ET_INSTANCES:
+		Node->writeInstances(index);
+		break;
+	}
+}
+
+
 //! Writes attributes of the scene node.
 void CParticleSystemSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
 {
@@ -643,6 +963,8 @@ void CParticleSystemSceneNode::serializeAttributes(io::IAttributes* out, io::SAt
 	out->addBool("GlobalParticles", ParticlesAreGlobal);
 	out->addFloat("ParticleWidth", ParticleSize.Width);
 	out->addFloat("ParticleHeight", ParticleSize.Height);
+	out->addInt("MaxParticles", MaxParticleCount);
+	out->addBool("InstancedBillboards", InstancedBillboards);
 
 	// write emitter
 
@@ -684,6 +1006,10 @@ void CParticleSystemSceneNode::deserializeAttributes(io::IAttributes* in, io::SA
 	ParticlesAreGlobal = in->getAttributeAsBool("GlobalParticles");
 	ParticleSize.Width = in->getAttributeAsFloat("ParticleWidth");
 	ParticleSize.Height = in->getAttributeAsFloat("ParticleHeight");
+	if (in->existsAttribute("MaxParticles"))
+		MaxParticleCount = in->getAttributeAsInt("MaxParticles");
+	if (in->existsAttribute("InstancedBillboards"))
+		setInstancedBillboards(in->getAttributeAsBool("InstancedBillboards"));
 
 	// read emitter
 
@@ -9,6 +9,7 @@
 #include "irrArray.h"
 #include "irrList.h"
 #include "CMeshBuffer.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -194,6 +195,21 @@ public:
 	//! Remove all currently visible particles
 	virtual void clearParticles() _IRR_OVERRIDE_;
 
+	//! Get the number of particles which are alive.
+	virtual u32 getParticleCount() const _IRR_OVERRIDE_;
+
+	//! Sets the maximum number of particles which are alive at the same time.
+	virtual void setMaxParticleCount(u32 count) _IRR_OVERRIDE_;
+
+	//! Gets the maximum number of particles which are alive at the same time.
+	virtual u32 getMaxParticleCount() const _IRR_OVERRIDE_;
+
+	//! Sets if the particles are drawn as instances of a single quad.
+	virtual void setInstancedBillboards(bool instanced) _IRR_OVERRIDE_;
+
+	//! Gets if the particles are drawn as instances of a single quad.
+	virtual bool getInstancedBillboards() const _IRR_OVERRIDE_;
+
 	//! Sets if the node should be visible or not.
 	virtual void setVisible(bool isVisible) _IRR_OVERRIDE_;
 
@@ -213,11 +229,64 @@ public:
 
 private:
 
+	//! works on parts of the particles, called by CThreadPool
+	class CParticleJob : public IThreadJob
+	{
+	public:
+		enum E_TASK
+		{
+			ET_SIMULATE,
+			ET_VERTICES,
+			ET_INSTANCES
+		};
+
+		CParticleJob(CParticleSystemSceneNode* node, E_TASK task) : Node(node), Task(task) {}
+
+		virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_;
+
+		CParticleSystemSceneNode* Node;
+		E_TASK Task;
+	};
+
 	void reallocateBuffers();
 
+	//! Creates the quad and the instance buffer for instanced billboards.
+	void createInstancedBuffer();
+
+	//! Runs the affectors in RangeAffectors on all particles, and moves the
+	//! particles if Animate is set. Large systems are split into parts for
+	//! the thread pool.
+	void simulateParticles();
+
+	//! Runs the range affectors on a part of the particles and moves them.
+	void simulatePart(u32 part);
+
+	//! Writes the vertices of a part of the particles.
+	void writeVertices(u32 part);
+
+	//! Writes the instance data of a part of the particles.
+	void writeInstances(u32 part);
+
+	//! Runs an affector which has no range implementation with a copy of the particles.
+	void affectCopy(IParticleAffector* affector);
+
 	core::list<IParticleAffector*> AffectorList;
 	IParticleEmitter* Emitter;
-	core::array<SParticle> Particles;
+	SParticlePool Particles;
+	u32 MaxParticleCount;
+	bool UseSSE2;
+
+	// state of the current frame, used by the jobs
+	core::array<IParticleAffector*> RangeAffectors;
+	core::array<SParticle> CopiedParticles;
+	core::array<core::vector3df> PartMinEdges;
+	core::array<core::vector3df> PartMaxEdges;
+	u32 SimulationTime;
+	f32 TimeScale;
+	bool Animate;
+	core::vector3df CameraRight;
+	core::vector3df CameraUp;
+	core::vector3df CameraView;
 	core::dimension2d<f32> ParticleSize;
 	u32 LastEmitTime;
 	core::matrix4 LastAbsoluteTransformation;
@@ -225,6 +294,11 @@ private:
 	CMeshBuffer<video::S3DVertex>* MeshBuffer;
 	IVertexBuffer* VertexBuffer;
 	IIndexBuffer* IndexBuffer;
+
+	// quad drawn once per particle, with the instance data in its second vertex buffer
+	CMeshBuffer<video::S3DVertex>* InstancedBuffer;
+	IVertexBuffer* InstanceBuffer;
+	bool InstancedBillboards;
 	
 
 // TODO: That was obviously planned by someone at some point and sounds like a good idea.
@@ -5,8 +5,54 @@
 #include "CProfiler.h"
 #include "CTimer.h"
 
+#if defined(_IRR_WINDOWS_API_)
+	#ifdef _IRR_XBOX_PLATFORM_
+		#include <xtl.h>
+	#else
+		#define WIN32_LEAN_AND_MEAN
+		#include <windows.h>
+	#endif
+#else
+	#include <sys/time.h>
+#endif
+
 namespace irr
 {
+
+namespace
+{
+	//! Microseconds of a clock with a fixed start
+	u64 getMicroseconds()
+	{
+#if defined(_IRR_WINDOWS_API_)
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER counter;
+		if (QueryPerformanceFrequency(&frequency) && QueryPerformanceCounter(&counter))
+			return (u64)(counter.QuadPart / frequency.QuadPart) * 1000000 +
+				(u64)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+		return (u64)GetTickCount() * 1000;
+#else
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return (u64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+	}
+
+	//! Appends a string as the content of a JSON or CSV string
+	void appendQuoted(core::stringc &result, const core::stringc &str, bool json)
+	{
+		for ( u32 i=0; i < str.size(); ++i )
+		{
+			if ( str[i] == '"' )
+				result += json ? "\\\"" : "\"\"";
+			else if ( str[i] == '\\' && json )
+				result += "\\\\";
+			else if ( (u8)str[i] >= 32 )
+				result += str[i];
+		}
+	}
+}
+
 IRRLICHT_API IProfiler& IRRCALLCONV getProfiler()
 {
 	static CProfiler profiler;
@@ -14,6 +60,7 @@ IRRLICHT_API IProfiler& IRRCALLCONV getProfiler()
 }
 
 CProfiler::CProfiler()
+: TimelineNext(0), TimelineCount(0), TimelineStart(0), TimelineFrame(0)
 {
 	Timer = new CTimer(true);
 
@@ -95,6 +142,214 @@ core::stringw CProfiler::getAsString(const SProfileData& data) const
 	}
 }
 
+//! Enable or disable recording a timeline of profile events
+void CProfiler::setTimelineSize(u32 maxEvents)
+{
+	CMutexLock lock(TimelineMutex);
+
+	Timeline.clear();
+	Timeline.reallocate(maxEvents);
+	Timeline.set_used(maxEvents);
+	TimelineNext = 0;
+	TimelineCount = 0;
+	TimelineStart = getMicroseconds();
+	TimelineFrame = FrameNumber;
+	TimelineThreads.clear();
+
+	resetFrameCounters();
+
+	TimelineEnabled = maxEvents > 0;
+}
+
+//! Record an event in the timeline
+void CProfiler::addTimelineEvent(s32 id, E_PROFILE_EVENT_TYPE type, u32 value)
+{
+	const u64 now = getMicroseconds();
+	const u64 thread = CThreadPool::getCurrentThreadId();
+
+	// other threads can't check TimelineEnabled, an empty ring buffer means disabled
+	CMutexLock lock(TimelineMutex);
+
+	if ( Timeline.empty() )
+		return;
+
+	SProfileEvent &event = Timeline[TimelineNext];
+	event.Id = id;
+	event.Type = type;
+	event.Frame = TimelineFrame;
+	event.Time = now > TimelineStart ? now - TimelineStart : 0;
+	event.Value = value;
+
+	event.Thread = TimelineThreads.size();
+	for ( u32 i=0; i<TimelineThreads.size(); ++i )
+	{
+		if ( TimelineThreads[i] == thread )
+		{
+			event.Thread = i;
+			break;
+		}
+	}
+	if ( event.Thread == TimelineThreads.size() )
+		TimelineThreads.push_back(thread);
+
+	if ( ++TimelineNext == Timeline.size() )
+		TimelineNext = 0;
+	if ( TimelineCount < Timeline.size() )
+		++TimelineCount;
+
+	// markFrame records the end of a frame before it counts the next one
+	if ( type == EPET_FRAME )
+		TimelineFrame = value + 1;
+}
+
+//! Get the number of events in the timeline
+u32 CProfiler::getTimelineEventCount() const
+{
+	CMutexLock lock(TimelineMutex);
+	return TimelineCount;
+}
+
+//! Get an event of the timeline, oldest first
+SProfileEvent CProfiler::getTimelineEvent(u32 index) const
+{
+	CMutexLock lock(TimelineMutex);
+	if (index >= TimelineCount)
+		return SProfileEvent();
+
+	const u32 oldest = TimelineCount < Timeline.size() ? 0 : TimelineNext;
+	return Timeline[(oldest + index) % Timeline.size()];
+}
+
+//! Write the timeline into a string
+void CProfiler::printTimeline(core::stringc &result, E_PROFILE_TIMELINE_FORMAT format) const
+{
+	core::array<SProfileEvent> events;
+	{
+		CMutexLock lock(TimelineMutex);
+		const u32 oldest = TimelineCount < Timeline.size() ? 0 : TimelineNext;
+		events.reallocate(TimelineCount);
+		for ( u32 i=0; i<TimelineCount; ++i )
+			events.push_back(Timeline[(oldest + i) % Timeline.size()]);
+	}
+
+	if ( format == EPTF_CHROME_TRACE )
+		result += "{\"traceEvents\":[\n";
+	else
+		result += "type,name,group,thread,frame,time_us,duration_us,value\n";
+
+	// indices of the begin events still open, per thread
+	core::array<core::array<u32> > open;
+	bool first = true;
+
+	for ( u32 i=0; i<events.size(); ++i )
+	{
+		const SProfileEvent &event = events[i];
+
+		if ( event.Type == EPET_BEGIN )
+		{
+			while ( open.size() <= event.Thread )
+				open.push_back(core::array<u32>());
+			open[event.Thread].push_back(i);
+		}
+		else if ( event.Type == EPET_END )
+		{
+			if ( open.size() <= event.Thread )
+				continue;
+
+			// the begin might have been overwritten already, then the end is dropped
+			core::array<u32> &stack = open[event.Thread];
+			for ( s32 j=(s32)stack.size()-1; j >= 0; --j )
+			{
+				const SProfileEvent &begin = events[stack[j]];
+				if ( begin.Id == event.Id )
+				{
+					printTimelineEntry(result, format, begin, event.Time - begin.Time, first);
+					first = false;
+					stack.set_used(j);
+					break;
+				}
+			}
+		}
+		else
+		{
+			printTimelineEntry(result, format, event, 0, first);
+			first = false;
+		}
+	}
+
+	if ( format == EPTF_CHROME_TRACE )
+		result += "\n]}\n";
+}
+
+//! Appends a scope, counter or frame to the printed timeline
+void CProfiler::printTimelineEntry(core::stringc &result, E_PROFILE_TIMELINE_FORMAT format,
+	const SProfileEvent& event, u64 duration, bool first) const
+{
+	core::stringc name;
+	core::stringc group;
+	if ( event.Type == EPET_FRAME )
+		name = "frame";
+	else
+	{
+		const SProfileData* data = findProfileData(event.Id);
+		if ( data )
+		{
+			name = data->getName();
+			group = ProfileGroups[data->getGroupIndex()].getName();
+		}
+	}
+
+#ifdef _MSC_VER
+#pragma warning(disable:4996)	// 'sprintf' was declared deprecated
+#endif
+	char dummy[256];
+	const bool json = format == EPTF_CHROME_TRACE;
+
+	if ( json )
+	{
+		if ( !first )
+			result += ",\n";
+		result += "{\"name\":\"";
+		appendQuoted(result, name, true);
+		result += "\",\"cat\":\"";
+		appendQuoted(result, group, true);
+		result += "\",";
+
+		if ( event.Type == EPET_BEGIN )
+			sprintf(dummy, "\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.0f,\"dur\":%.0f,\"args\":{\"frame\":%u}}",
+				event.Thread, (f64)event.Time, (f64)duration, event.Frame);
+		else if ( event.Type == EPET_COUNTER )
+			sprintf(dummy, "\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.0f,\"args\":{\"value\":%u}}",
+				event.Thread, (f64)event.Time, event.Value);
+		else
+			sprintf(dummy, "\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%u,\"ts\":%.0f,\"args\":{\"frame\":%u}}",
+				event.Thread, (f64)event.Time, event.Value);
+	}
+	else
+	{
+		if ( event.Type == EPET_BEGIN )
+			result += "scope,\"";
+		else if ( event.Type == EPET_COUNTER )
+			result += "counter,\"";
+		else
+			result += "frame,\"";
+		appendQuoted(result, name, false);
+		result += "\",\"";
+		appendQuoted(result, group, false);
+		result += "\",";
+
+		if ( event.Type == EPET_BEGIN )
+			sprintf(dummy, "%u,%u,%.0f,%.0f,\n", event.Thread, event.Frame, (f64)event.Time, (f64)duration);
+		else
+			sprintf(dummy, "%u,%u,%.0f,,%u\n", event.Thread, event.Frame, (f64)event.Time, event.Value);
+	}
+#ifdef _MSC_VER
+#pragma warning(default :4996)	// 'sprintf' was declared deprecated
+#endif
+
+	result += dummy;
+}
+
 //! Return a string which describes the columns returned by getAsString
 core::stringw CProfiler::makeTitleString() const
 {
@@ -7,6 +7,7 @@
 
 #include "IrrCompileConfig.h"
 #include "IProfiler.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -23,9 +24,44 @@ public:
 	//! Write the profile data of one group into a string
     virtual void printGroup(core::stringw &result, u32 groupIndex, bool suppressUncalled) const  _IRR_OVERRIDE_;
 
+	//! Enable or disable recording a timeline of profile events
+	virtual void setTimelineSize(u32 maxEvents) _IRR_OVERRIDE_;
+
+	//! Record an event in the timeline, can be called by any thread
+	virtual void addTimelineEvent(s32 id, E_PROFILE_EVENT_TYPE type, u32 value=0) _IRR_OVERRIDE_;
+
+	//! Get the number of events in the timeline
+	virtual u32 getTimelineEventCount() const _IRR_OVERRIDE_;
+
+	//! Get an event of the timeline
+	virtual SProfileEvent getTimelineEvent(u32 index) const _IRR_OVERRIDE_;
+
+	//! Write the timeline into a string
+	virtual void printTimeline(core::stringc &result, E_PROFILE_TIMELINE_FORMAT format=EPTF_CHROME_TRACE) const _IRR_OVERRIDE_;
+
 protected:
 	core::stringw makeTitleString() const;
 	core::stringw getAsString(const SProfileData& data) const;
+
+	//! Appends a scope, counter or frame to the printed timeline
+	void printTimelineEntry(core::stringc &result, E_PROFILE_TIMELINE_FORMAT format,
+		const SProfileEvent& event, u64 duration, bool first) const;
+
+	//! Ring buffer of the timeline, Timeline[TimelineNext] is the oldest event once it is full
+	core::array<SProfileEvent> Timeline;
+	u32 TimelineNext;
+	u32 TimelineCount;
+	u64 TimelineStart;
+
+	//! Frame of the recorded events. Unlike FrameNumber and TimelineEnabled,
+	//! which only the main thread may read, guarded by TimelineMutex.
+	u32 TimelineFrame;
+
+	//! Thread ids in the order of their first event
+	core::array<u64> TimelineThreads;
+
+	//! Events are recorded by several threads
+	mutable CMutex TimelineMutex;
 };
 } // namespace irr
 
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
 
 namespace irr
 {
@@ -99,6 +100,12 @@ const io::path& CReadFile::getFileName() const
 
 IReadFile* CReadFile::createReadFile(const io::path& fileName)
 {
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+	IReadFile* mapped = CMappedReadFile::createMappedReadFile(fileName);
+	if (mapped)
+		return mapped;
+#endif
+
 	CReadFile* file = new CReadFile(fileName);
 	if (file->isOpen())
 		return file;
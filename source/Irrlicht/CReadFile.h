@@ -47,7 +47,14 @@ namespace io
 		//! returns name of file
 		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
 
+		//! the file is read through its own FILE handle
+		virtual bool hasOwnHandle() const _IRR_OVERRIDE_
+		{
+			return true;
+		}
+
 		//! create read file on disk.
+		/** The file is mapped into memory if possible, see _IRR_COMPILE_WITH_MAPPED_FILES_. */
 		static IReadFile* createReadFile(const io::path& fileName);
 
 	private:
@@ -0,0 +1,197 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CRenderQueue.h"
+#include "IVideoDriver.h"
+#include "IMaterialRenderer.h"
+#include "IMeshSceneNode.h"
+#include "IAnimatedMeshSceneNode.h"
+#include "IAnimatedMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+// Key layout, from the highest bits to the lowest
+// solid:       pass 2 | renderer 10 | vertex descriptor 6 | textures 22 | depth 24
+// transparent: pass 2 | inverted depth 32 | renderer 10 | vertex descriptor 6 | textures 14
+
+static const u32 PASS_COUNT = 3;
+
+static inline u32 passIndex(E_SCENE_NODE_RENDER_PASS pass)
+{
+	switch (pass)
+	{
+	case ESNRP_TRANSPARENT:
+		return 1;
+	case ESNRP_TRANSPARENT_EFFECT:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+
+//! Constructor
+CRenderQueue::CRenderQueue(video::IVideoDriver* driver)
+: Driver(driver)
+{
+	for (u32 i=0; i<PASS_COUNT; ++i)
+		PassCount[i] = 0;
+}
+
+
+void CRenderQueue::add(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass, const core::vector3df& camera)
+{
+	const u32 p = passIndex(pass);
+
+	SEntry e;
+	e.Key = makeKey(node, p, camera);
+	e.Node = node;
+	Entries.push_back(e);
+	++PassCount[p];
+}
+
+
+u64 CRenderQueue::makeKey(ISceneNode* node, u32 pass, const core::vector3df& camera) const
+{
+	// the material the node draws in this pass, nodes with solid and transparent
+	// materials are registered for both passes
+	const u32 materialCount = node->getMaterialCount();
+	u32 material = 0;
+	for (u32 i=0; i<materialCount; ++i)
+	{
+		const video::SMaterial& m = node->getMaterial(i);
+		const video::IMaterialRenderer* rnd = Driver ? Driver->getMaterialRenderer(m.MaterialType) : 0;
+		const bool transparent = (rnd && rnd->isTransparent()) || m.isTransparent();
+		if (transparent == (pass != 0))
+		{
+			material = i;
+			break;
+		}
+	}
+
+	u32 renderer = 0;
+	u32 textures = 0;
+	if (materialCount)
+	{
+		const video::SMaterial& m = node->getMaterial(material);
+		renderer = core::min_((u32)m.MaterialType, 1023u);
+
+		for (u32 i=0; i<video::MATERIAL_MAX_TEXTURES; ++i)
+			textures = textures * 31 + (u32)((size_t)m.getTexture(i) >> 4);
+	}
+
+	// mesh buffer i is drawn with material i
+	IMesh* mesh = 0;
+	const ESCENE_NODE_TYPE type = node->getType();
+	if (type == ESNT_MESH || type == ESNT_OCTREE || type == ESNT_CUBE || type == ESNT_SPHERE)
+		mesh = static_cast<IMeshSceneNode*>(node)->getMesh();
+	else if (type == ESNT_ANIMATED_MESH)
+		mesh = static_cast<IAnimatedMeshSceneNode*>(node)->getMesh();
+
+	u32 descriptor = 0;
+	if (mesh && material < mesh->getMeshBufferCount())
+	{
+		const video::IVertexDescriptor* vd = mesh->getMeshBuffer(material)->getVertexDescriptor();
+		if (vd)
+			descriptor = (vd->getID() + 1) & 63;
+	}
+
+	// a positive float compares like its bit pattern
+	f32 distance = node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
+	const u32 depth = IR(distance);
+
+	u64 key = (u64)pass << 62;
+	if (pass == 0)
+	{
+		key |= (u64)renderer << 52;
+		key |= (u64)descriptor << 46;
+		key |= (u64)((textures ^ (textures >> 22)) & 0x3FFFFF) << 24;
+		key |= depth >> 8;
+	}
+	else
+	{
+		key |= (u64)(~depth) << 30;
+		key |= (u64)renderer << 20;
+		key |= (u64)descriptor << 14;
+		key |= (textures ^ (textures >> 14) ^ (textures >> 28)) & 0x3FFF;
+	}
+	return key;
+}
+
+
+//! LSD radix sort over the bytes of the keys, stable
+void CRenderQueue::sort()
+{
+	const u32 count = Entries.size();
+	if (count < 2)
+		return;
+
+	u32 histogram[8][256];
+	memset(histogram, 0, sizeof(histogram));
+
+	for (u32 i=0; i<count; ++i)
+	{
+		const u64 key = Entries[i].Key;
+		for (u32 b=0; b<8; ++b)
+			++histogram[b][(key >> (b*8)) & 0xFF];
+	}
+
+	Temp.set_used(count);
+	SEntry* src = Entries.pointer();
+	SEntry* dst = Temp.pointer();
+
+	for (u32 b=0; b<8; ++b)
+	{
+		u32* h = histogram[b];
+
+		// all keys have the same byte here, nothing to do
+		if (h[(src[0].Key >> (b*8)) & 0xFF] == count)
+			continue;
+
+		u32 offset = 0;
+		for (u32 i=0; i<256; ++i)
+		{
+			const u32 c = h[i];
+			h[i] = offset;
+			offset += c;
+		}
+
+		for (u32 i=0; i<count; ++i)
+			dst[h[(src[i].Key >> (b*8)) & 0xFF]++] = src[i];
+
+		SEntry* t = src;
+		src = dst;
+		dst = t;
+	}
+
+	if (src != Entries.pointer())
+		memcpy(Entries.pointer(), src, count * sizeof(SEntry));
+}
+
+
+void CRenderQueue::getPassRange(E_SCENE_NODE_RENDER_PASS pass, u32& begin, u32& end) const
+{
+	const u32 p = passIndex(pass);
+
+	begin = 0;
+	for (u32 i=0; i<p; ++i)
+		begin += PassCount[i];
+	end = begin + PassCount[p];
+}
+
+
+void CRenderQueue::clear()
+{
+	Entries.set_used(0);
+	for (u32 i=0; i<PASS_COUNT; ++i)
+		PassCount[i] = 0;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,77 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_RENDER_QUEUE_H_INCLUDED__
+#define __C_RENDER_QUEUE_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "ISceneManager.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+	struct SMaterial;
+}
+namespace scene
+{
+
+	//! The nodes registered for the solid and transparent render passes, sorted by 64 bit keys.
+	/** A key packs the render pass, the material renderer, the vertex descriptor, the textures
+	and the distance to the camera of the material a node draws in that pass. Solid nodes are
+	sorted by state and then front to back, transparent nodes back to front and then by state.
+	The keys are sorted with a radix sort, nodes with equal keys keep the order in which they
+	were registered. */
+	class CRenderQueue
+	{
+	public:
+
+		//! Constructor
+		/** The driver isn't grabbed, it has to live as long as the queue. */
+		CRenderQueue(video::IVideoDriver* driver);
+
+		//! Adds a node for ESNRP_SOLID, ESNRP_TRANSPARENT or ESNRP_TRANSPARENT_EFFECT.
+		void add(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass, const core::vector3df& camera);
+
+		//! Sorts the nodes of all passes.
+		/** All nodes have to be added before, the passes are rendered from one sorted queue. */
+		void sort();
+
+		//! Returns the range [begin,end) of the sorted nodes of a pass.
+		void getPassRange(E_SCENE_NODE_RENDER_PASS pass, u32& begin, u32& end) const;
+
+		//! Returns a node, valid after sort().
+		ISceneNode* getNode(u32 index) const
+		{
+			return Entries[index].Node;
+		}
+
+		//! Removes all nodes.
+		void clear();
+
+	private:
+
+		struct SEntry
+		{
+			u64 Key;
+			ISceneNode* Node;
+		};
+
+		u64 makeKey(ISceneNode* node, u32 pass, const core::vector3df& camera) const;
+
+		video::IVideoDriver* Driver;
+
+		core::array<SEntry> Entries;
+		core::array<SEntry> Temp;
+
+		//! number of nodes per pass
+		u32 PassCount[3];
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
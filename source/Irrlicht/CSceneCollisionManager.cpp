@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CSceneCollisionManager.h"
+#include "CSceneNodeGrid.h"
 #include "ISceneNode.h"
 #include "ICameraSceneNode.h"
 #include "ITriangleSelector.h"
@@ -16,9 +17,54 @@ namespace irr
 namespace scene
 {
 
+namespace
+{
+	// queries done by one part of a batch
+	const u32 QUERY_PART_SIZE = 32;
+
+	// queries the selectors without triangle buffer, which updates the ones built from animated nodes
+	void updateSelector(ITriangleSelector* selector)
+	{
+		const u32 count = selector->getSelectorCount();
+		if (count == 1 && selector->getSelector(0) == selector)
+		{
+			core::triangle3df triangle;
+			s32 written = 0;
+			selector->getTriangles(&triangle, 0, written);
+			return;
+		}
+
+		for (u32 i=0; i<count; ++i)
+		{
+			ITriangleSelector* child = selector->getSelector(i);
+			if (child)
+				updateSelector(child);
+		}
+	}
+
+	// checks if a node is below root and visible like the recursive picking methods want it
+	bool isVisibleBelow(const ISceneNode* node, const ISceneNode* root)
+	{
+		for (; node != root; node = node->getParent())
+		{
+			if (!node || !node->isVisible())
+				return false;
+		}
+		return true;
+	}
+
+	bool intersectsWithSphere(const core::aabbox3df& box, const core::vector3df& center, f32 radius)
+	{
+		const core::vector3df closest(core::clamp(center.X, box.MinEdge.X, box.MaxEdge.X),
+			core::clamp(center.Y, box.MinEdge.Y, box.MaxEdge.Y),
+			core::clamp(center.Z, box.MinEdge.Z, box.MaxEdge.Z));
+		return closest.getDistanceFromSQ(center) <= radius * radius;
+	}
+}
+
 //! constructor
 CSceneCollisionManager::CSceneCollisionManager(ISceneManager* smanager, video::IVideoDriver* driver)
-: SceneManager(smanager), Driver(driver)
+: SceneManager(smanager), Driver(driver), Grid(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CSceneCollisionManager");
@@ -62,13 +108,94 @@ ISceneNode* CSceneCollisionManager::getSceneNodeFromRayBB(
 
 	core::line3d<f32> truncatableRay(ray);
 
-	getPickedNodeBB((root==0)?SceneManager->getRootSceneNode():root, truncatableRay,
-		idBitMask, noDebugObjects, dist, best);
+	if (!root)
+		root = SceneManager->getRootSceneNode();
+
+	if (updateGrid(root))
+		getPickedNodeBBFromGrid(root, truncatableRay, idBitMask, noDebugObjects, dist, best);
+	else
+		getPickedNodeBB(root, truncatableRay, idBitMask, noDebugObjects, dist, best);
 
 	return best;
 }
 
 
+//! Collects the scene nodes whose transformed bounding boxes intersect with a sphere.
+void CSceneCollisionManager::getSceneNodesFromSphereBB(const core::vector3df& center, f32 radius,
+		core::array<ISceneNode*>& outNodes, s32 idBitMask, bool noDebugObjects, ISceneNode* root)
+{
+	if (!root)
+		root = SceneManager->getRootSceneNode();
+
+	if (!updateGrid(root))
+	{
+		getNodesFromSphereBB(root, center, radius, idBitMask, noDebugObjects, outNodes);
+		return;
+	}
+
+	const core::vector3df extent(radius, radius, radius);
+	core::array<u32> cells;
+	Grid->getCells(core::aabbox3df(center - extent, center + extent), cells);
+
+	for (u32 c=0; c<cells.size(); ++c)
+	{
+		const CSceneNodeGrid::SCell& cell = Grid->getCell(cells[c]);
+		const bool bounded = cell.Level < CSceneNodeGrid::LEVEL_COUNT;
+
+		for (s32 e=cell.First; e>=0; e=Grid->getEntry(e).Next)
+		{
+			const CSceneNodeGrid::SEntry& entry = Grid->getEntry(e);
+			ISceneNode* current = entry.Node;
+
+			if ((bounded && !intersectsWithSphere(entry.WorldBox, center, radius)) ||
+				(noDebugObjects && current->isDebugObject()) ||
+				(idBitMask != 0 && !(current->getID() & idBitMask)) ||
+				!isVisibleBelow(current, root))
+				continue;
+
+			if (intersectsWithSphere(current->getTransformedBoundingBox(), center, radius))
+				outNodes.push_back(current);
+		}
+	}
+}
+
+
+//! recursive method for going through all scene nodes
+void CSceneCollisionManager::getNodesFromSphereBB(ISceneNode* root,
+		const core::vector3df& center, f32 radius, s32 bits, bool noDebugObjects,
+		core::array<ISceneNode*>& outNodes)
+{
+	const ISceneNodeList& children = root->getChildren();
+
+	ISceneNodeList::ConstIterator it = children.begin();
+	for (; it != children.end(); ++it)
+	{
+		ISceneNode* current = *it;
+		if (!current->isVisible())
+			continue;
+
+		if ((noDebugObjects ? !current->isDebugObject() : true) &&
+			(bits==0 || (current->getID() & bits)) &&
+			intersectsWithSphere(current->getTransformedBoundingBox(), center, radius))
+			outNodes.push_back(current);
+
+		getNodesFromSphereBB(current, center, radius, bits, noDebugObjects, outNodes);
+	}
+}
+
+
+//! brings the grid up to date, checks if it knows all nodes the recursive methods would visit below root
+bool CSceneCollisionManager::updateGrid(const ISceneNode* root)
+{
+	if (!Grid || !isVisibleBelow(root, SceneManager->getRootSceneNode()))
+		return false;
+
+	// nodes might have been added, moved or removed since drawAll, only those cost time
+	Grid->update(SceneManager->getRootSceneNode());
+	return true;
+}
+
+
 //! recursive method for going through all scene nodes
 void CSceneCollisionManager::getPickedNodeBB(ISceneNode* root,
 		core::line3df& ray, s32 bits, bool noDebugObjects,
@@ -87,135 +214,180 @@ void CSceneCollisionManager::getPickedNodeBB(ISceneNode* root,
 			if((noDebugObjects ? !current->isDebugObject() : true) &&
 				(bits==0 || (bits != 0 && (current->getID() & bits))))
 			{
-				// get world to object space transform
-				core::matrix4 worldToObject;
-				if (!current->getAbsoluteTransformation().getInverse(worldToObject))
-					continue;
+				testNodeBB(current, ray, rayVector, outbestdistance, outbestnode);
+			}
+
+			// Only check the children if this node is visible.
+			getPickedNodeBB(current, ray, bits, noDebugObjects, outbestdistance, outbestnode);
+		}
+	}
+}
 
-				// transform vector from world space to object space
-				core::line3df objectRay(ray);
-				worldToObject.transformVect(objectRay.start);
-				worldToObject.transformVect(objectRay.end);
 
-				const core::aabbox3df & objectBox = current->getBoundingBox();
+//! goes through the nodes of the grid whose boxes can be hit by the ray
+void CSceneCollisionManager::getPickedNodeBBFromGrid(ISceneNode* root,
+		core::line3df& ray, s32 bits, bool noDebugObjects,
+		f32& outbestdistance, ISceneNode*& outbestnode)
+{
+	const core::vector3df rayVector = ray.getVector().normalize();
 
-				// Do the initial intersection test in object space, since the
-				// object space box test is more accurate.
-				if(objectBox.isPointInside(objectRay.start))
-				{
-					// use fast bbox intersection to find distance to hitpoint
-					// algorithm from Kay et al., code from gamedev.net
-					const core::vector3df dir = (objectRay.end-objectRay.start).normalize();
-					const core::vector3df minDist = (objectBox.MinEdge - objectRay.start)/dir;
-					const core::vector3df maxDist = (objectBox.MaxEdge - objectRay.start)/dir;
-					const core::vector3df realMin(core::min_(minDist.X, maxDist.X),core::min_(minDist.Y, maxDist.Y),core::min_(minDist.Z, maxDist.Z));
-					const core::vector3df realMax(core::max_(minDist.X, maxDist.X),core::max_(minDist.Y, maxDist.Y),core::max_(minDist.Z, maxDist.Z));
-
-					const f32 minmax = core::min_(realMax.X, realMax.Y, realMax.Z);
-					// nearest distance to intersection
-					const f32 maxmin = core::max_(realMin.X, realMin.Y, realMin.Z);
-
-					const f32 toIntersectionSq = (maxmin>0?maxmin*maxmin:minmax*minmax);
-					if (toIntersectionSq < outbestdistance)
-					{
-						outbestdistance = toIntersectionSq;
-						outbestnode = current;
-
-						// And we can truncate the ray to stop us hitting further nodes.
-						ray.end = ray.start + (rayVector * sqrtf(toIntersectionSq));
-					}
-				}
-				else
-				if (objectBox.intersectsWithLine(objectRay))
+	core::aabbox3df rayBox(ray.start);
+	rayBox.addInternalPoint(ray.end);
+	core::array<u32> cells;
+	Grid->getCells(rayBox, cells);
+
+	for (u32 c=0; c<cells.size(); ++c)
+	{
+		const CSceneNodeGrid::SCell& cell = Grid->getCell(cells[c]);
+		const bool bounded = cell.Level < CSceneNodeGrid::LEVEL_COUNT;
+		if (bounded && !cell.Bounds.intersectsWithLine(ray))
+			continue;
+
+		for (s32 e=cell.First; e>=0; e=Grid->getEntry(e).Next)
+		{
+			const CSceneNodeGrid::SEntry& entry = Grid->getEntry(e);
+			ISceneNode* current = entry.Node;
+
+			// the ray is truncated by each hit
+			if ((bounded && !entry.WorldBox.intersectsWithLine(ray)) ||
+				(noDebugObjects && current->isDebugObject()) ||
+				(bits != 0 && !(current->getID() & bits)) ||
+				!isVisibleBelow(current, root))
+				continue;
+
+			testNodeBB(current, ray, rayVector, outbestdistance, outbestnode);
+		}
+	}
+}
+
+
+//! tests a node's bounding box against the ray and truncates the ray if it's nearer than the best one so far
+void CSceneCollisionManager::testNodeBB(ISceneNode* current, core::line3df& ray,
+		const core::vector3df& rayVector, f32& outbestdistance, ISceneNode*& outbestnode)
+{
+	// get world to object space transform
+	core::matrix4 worldToObject;
+	if (!current->getAbsoluteTransformation().getInverse(worldToObject))
+		return;
+
+	// transform vector from world space to object space
+	core::line3df objectRay(ray);
+	worldToObject.transformVect(objectRay.start);
+	worldToObject.transformVect(objectRay.end);
+
+	const core::aabbox3df & objectBox = current->getBoundingBox();
+
+	// Do the initial intersection test in object space, since the
+	// object space box test is more accurate.
+	if(objectBox.isPointInside(objectRay.start))
+	{
+		// use fast bbox intersection to find distance to hitpoint
+		// algorithm from Kay et al., code from gamedev.net
+		const core::vector3df dir = (objectRay.end-objectRay.start).normalize();
+		const core::vector3df minDist = (objectBox.MinEdge - objectRay.start)/dir;
+		const core::vector3df maxDist = (objectBox.MaxEdge - objectRay.start)/dir;
+		const core::vector3df realMin(core::min_(minDist.X, maxDist.X),core::min_(minDist.Y, maxDist.Y),core::min_(minDist.Z, maxDist.Z));
+		const core::vector3df realMax(core::max_(minDist.X, maxDist.X),core::max_(minDist.Y, maxDist.Y),core::max_(minDist.Z, maxDist.Z));
+
+		const f32 minmax = core::min_(realMax.X, realMax.Y, realMax.Z);
+		// nearest distance to intersection
+		const f32 maxmin = core::max_(realMin.X, realMin.Y, realMin.Z);
+
+		const f32 toIntersectionSq = (maxmin>0?maxmin*maxmin:minmax*minmax);
+		if (toIntersectionSq < outbestdistance)
+		{
+			outbestdistance = toIntersectionSq;
+			outbestnode = current;
+
+			// And we can truncate the ray to stop us hitting further nodes.
+			ray.end = ray.start + (rayVector * sqrtf(toIntersectionSq));
+		}
+	}
+	else
+	if (objectBox.intersectsWithLine(objectRay))
+	{
+		// Now transform into world space, since we need to use world space
+		// scales and distances.
+		core::aabbox3df worldBox(objectBox);
+		current->getAbsoluteTransformation().transformBox(worldBox);
+
+		core::vector3df edges[8];
+		worldBox.getEdges(edges);
+
+		/* We need to check against each of 6 faces, composed of these corners:
+			  /3--------/7
+			 /  |      / |
+			/   |     /  |
+			1---------5  |
+			|   2- - -| -6
+			|  /      |  /
+			|/        | /
+			0---------4/
+
+			Note that we define them as opposite pairs of faces.
+		*/
+		static const s32 faceEdges[6][3] =
+		{
+			{ 0, 1, 5 }, // Front
+			{ 6, 7, 3 }, // Back
+			{ 2, 3, 1 }, // Left
+			{ 4, 5, 7 }, // Right
+			{ 1, 3, 7 }, // Top
+			{ 2, 0, 4 }  // Bottom
+		};
+
+		core::vector3df intersection;
+		core::plane3df facePlane;
+		f32 bestDistToBoxBorder = FLT_MAX;
+		f32 bestToIntersectionSq = FLT_MAX;
+
+        for(s32 face = 0; face < 6; ++face)
+		{
+			facePlane.setPlane(edges[faceEdges[face][0]],
+								edges[faceEdges[face][1]],
+								edges[faceEdges[face][2]]);
+
+			// Only consider lines that might be entering through this face, since we
+			// already know that the start point is outside the box.
+			if(facePlane.classifyPointRelation(ray.start) != core::ISREL3D_FRONT)
+				continue;
+
+			// Don't bother using a limited ray, since we already know that it should be long
+			// enough to intersect with the box.
+			if(facePlane.getIntersectionWithLine(ray.start, rayVector, intersection))
+			{
+				const f32 toIntersectionSq = ray.start.getDistanceFromSQ(intersection);
+				if(toIntersectionSq < outbestdistance)
 				{
-					// Now transform into world space, since we need to use world space
-					// scales and distances.
-					core::aabbox3df worldBox(objectBox);
-					current->getAbsoluteTransformation().transformBox(worldBox);
-
-					core::vector3df edges[8];
-					worldBox.getEdges(edges);
-
-					/* We need to check against each of 6 faces, composed of these corners:
-						  /3--------/7
-						 /  |      / |
-						/   |     /  |
-						1---------5  |
-						|   2- - -| -6
-						|  /      |  /
-						|/        | /
-						0---------4/
-
-						Note that we define them as opposite pairs of faces.
-					*/
-					static const s32 faceEdges[6][3] =
-					{
-						{ 0, 1, 5 }, // Front
-						{ 6, 7, 3 }, // Back
-						{ 2, 3, 1 }, // Left
-						{ 4, 5, 7 }, // Right
-						{ 1, 3, 7 }, // Top
-						{ 2, 0, 4 }  // Bottom
-					};
-
-					core::vector3df intersection;
-					core::plane3df facePlane;
-					f32 bestDistToBoxBorder = FLT_MAX;
-					f32 bestToIntersectionSq = FLT_MAX;
-
-                    for(s32 face = 0; face < 6; ++face)
-					{
-						facePlane.setPlane(edges[faceEdges[face][0]],
-											edges[faceEdges[face][1]],
-											edges[faceEdges[face][2]]);
-
-						// Only consider lines that might be entering through this face, since we
-						// already know that the start point is outside the box.
-						if(facePlane.classifyPointRelation(ray.start) != core::ISREL3D_FRONT)
-							continue;
-
-						// Don't bother using a limited ray, since we already know that it should be long
-						// enough to intersect with the box.
-						if(facePlane.getIntersectionWithLine(ray.start, rayVector, intersection))
-						{
-							const f32 toIntersectionSq = ray.start.getDistanceFromSQ(intersection);
-							if(toIntersectionSq < outbestdistance)
-							{
-								// We have to check that the intersection with this plane is actually
-								// on the box, so need to go back to object space again.
-								worldToObject.transformVect(intersection);
-
-                                // find the closest point on the box borders. Have to do this as exact checks will fail due to floating point problems.
-								f32 distToBorder = core::max_ ( core::min_ (core::abs_(objectBox.MinEdge.X-intersection.X), core::abs_(objectBox.MaxEdge.X-intersection.X)),
-                                                                core::min_ (core::abs_(objectBox.MinEdge.Y-intersection.Y), core::abs_(objectBox.MaxEdge.Y-intersection.Y)),
-                                                                core::min_ (core::abs_(objectBox.MinEdge.Z-intersection.Z), core::abs_(objectBox.MaxEdge.Z-intersection.Z)) );
-                                if ( distToBorder < bestDistToBoxBorder )
-                                {
-                                    bestDistToBoxBorder = distToBorder;
-                                    bestToIntersectionSq = toIntersectionSq;
-                                }
-							}
-						}
-
-						// If the ray could be entering through the first face of a pair, then it can't
-						// also be entering through the opposite face, and so we can skip that face.
-						if (!(face & 0x01))
-							++face;
-					}
-
-					if ( bestDistToBoxBorder < FLT_MAX )
-					{
-                        outbestdistance = bestToIntersectionSq;
-						outbestnode = current;
-
-                        // If we got a hit, we can now truncate the ray to stop us hitting further nodes.
-                        ray.end = ray.start + (rayVector * sqrtf(outbestdistance));
-					}
+					// We have to check that the intersection with this plane is actually
+					// on the box, so need to go back to object space again.
+					worldToObject.transformVect(intersection);
+
+                    // find the closest point on the box borders. Have to do this as exact checks will fail due to floating point problems.
+					f32 distToBorder = core::max_ ( core::min_ (core::abs_(objectBox.MinEdge.X-intersection.X), core::abs_(objectBox.MaxEdge.X-intersection.X)),
+                                                    core::min_ (core::abs_(objectBox.MinEdge.Y-intersection.Y), core::abs_(objectBox.MaxEdge.Y-intersection.Y)),
+                                                    core::min_ (core::abs_(objectBox.MinEdge.Z-intersection.Z), core::abs_(objectBox.MaxEdge.Z-intersection.Z)) );
+                    if ( distToBorder < bestDistToBoxBorder )
+                    {
+                        bestDistToBoxBorder = distToBorder;
+                        bestToIntersectionSq = toIntersectionSq;
+                    }
 				}
 			}
 
-			// Only check the children if this node is visible.
-			getPickedNodeBB(current, ray, bits, noDebugObjects, outbestdistance, outbestnode);
+			// If the ray could be entering through the first face of a pair, then it can't
+			// also be entering through the opposite face, and so we can skip that face.
+			if (!(face & 0x01))
+				++face;
+		}
+
+		if ( bestDistToBoxBorder < FLT_MAX )
+		{
+            outbestdistance = bestToIntersectionSq;
+			outbestnode = current;
+
+            // If we got a hit, we can now truncate the ray to stop us hitting further nodes.
+            ray.end = ray.start + (rayVector * sqrtf(outbestdistance));
 		}
 	}
 }
@@ -259,9 +431,14 @@ ISceneNode* CSceneCollisionManager::getSceneNodeAndCollisionPointFromRay(
 	// bounding box would be pointless.
 
 	core::line3df rayRest(ray);
-	getPickedNodeFromBBAndSelector(collisionRootNode, rayRest, idBitMask,
-					noDebugObjects, bestDistanceSquared, bestNode,
-					outCollisionPoint, outTriangle);
+	if (updateGrid(collisionRootNode))
+		getPickedNodeFromBBAndSelectorFromGrid(collisionRootNode, rayRest, idBitMask,
+						noDebugObjects, bestDistanceSquared, bestNode,
+						outCollisionPoint, outTriangle);
+	else
+		getPickedNodeFromBBAndSelector(collisionRootNode, rayRest, idBitMask,
+						noDebugObjects, bestDistanceSquared, bestNode,
+						outCollisionPoint, outTriangle);
 	return bestNode;
 }
 
@@ -288,43 +465,99 @@ void CSceneCollisionManager::getPickedNodeFromBBAndSelector(
 			(noDebugObjects ? !current->isDebugObject() : true) &&
 			(bits==0 || (bits != 0 && (current->getID() & bits))))
 		{
-			// get world to object space transform
-			core::matrix4 mat;
-			if (!current->getAbsoluteTransformation().getInverse(mat))
-			continue;
+			testNodeSelector(current, selector, ray, outBestDistanceSquared, outBestNode,
+				outBestCollisionPoint, outBestTriangle);
+		}
 
-			// transform vector from world space to object space
-			core::line3df line(ray);
-			mat.transformVect(line.start);
-			mat.transformVect(line.end);
+		getPickedNodeFromBBAndSelector(current, ray, bits, noDebugObjects,
+						outBestDistanceSquared, outBestNode,
+						outBestCollisionPoint, outBestTriangle);
+	}
+}
 
-			const core::aabbox3df& box = current->getBoundingBox();
 
-			core::vector3df candidateCollisionPoint;
-			core::triangle3df candidateTriangle;
+//! goes through the nodes of the grid with triangle selectors whose boxes can be hit by the ray
+void CSceneCollisionManager::getPickedNodeFromBBAndSelectorFromGrid(ISceneNode* root,
+		core::line3df& ray, s32 bits, bool noDebugObjects,
+		f32& outBestDistanceSquared, ISceneNode*& outBestNode,
+		core::vector3df& outBestCollisionPoint, core::triangle3df& outBestTriangle)
+{
+	core::aabbox3df rayBox(ray.start);
+	rayBox.addInternalPoint(ray.end);
+	core::array<u32> cells;
+	Grid->getCells(rayBox, cells);
 
-			// do intersection test in object space
-			ISceneNode * hitNode = 0;
-			if (box.intersectsWithLine(line) &&
-				getCollisionPoint(ray, selector, candidateCollisionPoint, candidateTriangle, hitNode))
-			{
-				const f32 distanceSquared = (candidateCollisionPoint - ray.start).getLengthSQ();
+	for (u32 c=0; c<cells.size(); ++c)
+	{
+		const CSceneNodeGrid::SCell& cell = Grid->getCell(cells[c]);
+		const bool bounded = cell.Level < CSceneNodeGrid::LEVEL_COUNT;
+		if (bounded && !cell.Bounds.intersectsWithLine(ray))
+			continue;
 
-				if(distanceSquared < outBestDistanceSquared)
-				{
-					outBestDistanceSquared = distanceSquared;
-					outBestNode = current;
-					outBestCollisionPoint = candidateCollisionPoint;
-					outBestTriangle = candidateTriangle;
-					const core::vector3df rayVector = ray.getVector().normalize();
-					ray.end = ray.start + (rayVector * sqrtf(distanceSquared));
-				}
-			}
+		for (s32 e=cell.First; e>=0; e=Grid->getEntry(e).Next)
+		{
+			const CSceneNodeGrid::SEntry& entry = Grid->getEntry(e);
+			ISceneNode* current = entry.Node;
+			ITriangleSelector* selector = current->getTriangleSelector();
+
+			if (!selector || (bounded && !entry.WorldBox.intersectsWithLine(ray)) ||
+				(noDebugObjects && current->isDebugObject()) ||
+				(bits != 0 && !(current->getID() & bits)) ||
+				!isVisibleBelow(current, root))
+				continue;
+
+			testNodeSelector(current, selector, ray, outBestDistanceSquared, outBestNode,
+				outBestCollisionPoint, outBestTriangle);
 		}
+	}
 
-		getPickedNodeFromBBAndSelector(current, ray, bits, noDebugObjects,
-						outBestDistanceSquared, outBestNode,
-						outBestCollisionPoint, outBestTriangle);
+	// the recursive method also looks at visible nodes below invisible ones
+	for (u32 i=0; i<Grid->getHiddenNodeCount(); ++i)
+	{
+		ISceneNode* hidden = Grid->getHiddenNode(i);
+		if (isVisibleBelow(hidden->getParent(), root))
+			getPickedNodeFromBBAndSelector(hidden, ray, bits, noDebugObjects,
+				outBestDistanceSquared, outBestNode, outBestCollisionPoint, outBestTriangle);
+	}
+}
+
+
+//! tests a node's triangle selector against the ray and truncates the ray if it's nearer than the best one so far
+void CSceneCollisionManager::testNodeSelector(ISceneNode* current, ITriangleSelector* selector,
+		core::line3df& ray, f32& outBestDistanceSquared, ISceneNode*& outBestNode,
+		core::vector3df& outBestCollisionPoint, core::triangle3df& outBestTriangle)
+{
+	// get world to object space transform
+	core::matrix4 mat;
+	if (!current->getAbsoluteTransformation().getInverse(mat))
+		return;
+
+	// transform vector from world space to object space
+	core::line3df line(ray);
+	mat.transformVect(line.start);
+	mat.transformVect(line.end);
+
+	const core::aabbox3df& box = current->getBoundingBox();
+
+	core::vector3df candidateCollisionPoint;
+	core::triangle3df candidateTriangle;
+
+	// do intersection test in object space
+	ISceneNode * hitNode = 0;
+	if (box.intersectsWithLine(line) &&
+		getCollisionPoint(ray, selector, candidateCollisionPoint, candidateTriangle, hitNode))
+	{
+		const f32 distanceSquared = (candidateCollisionPoint - ray.start).getLengthSQ();
+
+		if(distanceSquared < outBestDistanceSquared)
+		{
+			outBestDistanceSquared = distanceSquared;
+			outBestNode = current;
+			outBestCollisionPoint = candidateCollisionPoint;
+			outBestTriangle = candidateTriangle;
+			const core::vector3df rayVector = ray.getVector().normalize();
+			ray.end = ray.start + (rayVector * sqrtf(distanceSquared));
+		}
 	}
 }
 
@@ -346,26 +579,81 @@ ISceneNode* CSceneCollisionManager::getSceneNodeFromCameraBB(
 }
 
 
+//! Checks if a collection of selectors contains one which finds intersections with lines by itself.
+bool CSceneCollisionManager::hasIntersectionWithLineInside(const ITriangleSelector* selector) const
+{
+	for (u32 i=0; i<selector->getSelectorCount(); ++i)
+	{
+		const ITriangleSelector* child = selector->getSelector(i);
+		if (child && child != selector &&
+			(child->hasIntersectionWithLine() || hasIntersectionWithLineInside(child)))
+			return true;
+	}
+
+	return false;
+}
+
+
 //! Finds the collision point of a line and lots of triangles, if there is one.
 bool CSceneCollisionManager::getCollisionPoint(const core::line3d<f32>& ray,
 		ITriangleSelector* selector, core::vector3df& outIntersection,
 		core::triangle3df& outTriangle,
 		ISceneNode*& outNode)
+{
+	const bool found = findCollisionPoint(ray, selector, outIntersection, outTriangle, outNode, Triangles);
+	_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
+	return found;
+}
+
+
+//! Finds the collision point of a line and lots of triangles with the given triangle buffer.
+bool CSceneCollisionManager::findCollisionPoint(const core::line3d<f32>& ray,
+		ITriangleSelector* selector, core::vector3df& outIntersection,
+		core::triangle3df& outTriangle, ISceneNode*& outNode,
+		core::array<core::triangle3df>& triangles) const
 {
 	if (!selector)
-	{
-		_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
 		return false;
+
+	if (selector->hasIntersectionWithLine())
+		return selector->getIntersectionWithLine(ray, outIntersection, outTriangle, outNode);
+
+	// collections are split up when some of their selectors find intersections by themselves
+	if (hasIntersectionWithLineInside(selector))
+	{
+		f32 nearest = FLT_MAX;
+		bool found = false;
+		core::vector3df intersection;
+		core::triangle3df triangle;
+		ISceneNode* node = 0;
+
+		for (u32 i=0; i<selector->getSelectorCount(); ++i)
+		{
+			if (!findCollisionPoint(ray, selector->getSelector(i), intersection, triangle, node, triangles))
+				continue;
+
+			const f32 distance = intersection.getDistanceFromSQ(ray.start);
+			if (distance < nearest)
+			{
+				nearest = distance;
+				outIntersection = intersection;
+				outTriangle = triangle;
+				outNode = node;
+				found = true;
+			}
+		}
+
+		return found;
 	}
 
 	s32 totalcnt = selector->getTriangleCount();
 	if ( totalcnt <= 0 )
 		return false;
 
-	Triangles.set_used(totalcnt);
+	triangles.set_used(totalcnt);
 
 	s32 cnt = 0;
-	selector->getTriangles(Triangles.pointer(), totalcnt, cnt, ray);
+	selector->getTriangles(triangles.pointer(), totalcnt, cnt, ray);
 
 	const core::vector3df linevect = ray.getVector().normalize();
 	core::vector3df intersection;
@@ -382,7 +670,7 @@ bool CSceneCollisionManager::getCollisionPoint(const core::line3d<f32>& ray,
 
 	for (s32 i=0; i<cnt; ++i)
 	{
-		const core::triangle3df & triangle = Triangles[i];
+		const core::triangle3df & triangle = triangles[i];
 
 		if(minX > triangle.pointA.X && minX > triangle.pointB.X && minX > triangle.pointC.X)
 			continue;
@@ -413,7 +701,6 @@ bool CSceneCollisionManager::getCollisionPoint(const core::line3d<f32>& ray,
 		}
 	}
 
-	_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
 	return found;
 }
 
@@ -432,12 +719,98 @@ core::vector3df CSceneCollisionManager::getCollisionResultPosition(
 		const core::vector3df& gravity)
 {
 	return collideEllipsoidWithWorld(selector, position,
-		radius, direction, slidingSpeed, gravity, triout, hitPosition, outFalling, outNode);
+		radius, direction, slidingSpeed, gravity, triout, hitPosition, outFalling, outNode, Triangles);
+}
+
+
+//! Finds the nearest collision points of many lines at once.
+void CSceneCollisionManager::getCollisionPoints(const core::line3d<f32>* rays, u32 count,
+		ITriangleSelector* selector, SCollisionHit* outHits)
+{
+	CQueryJob job(this, selector, CThreadPool::getSharedPool()->getThreadCount());
+	job.Rays = rays;
+	job.Hits = outHits;
+	job.Count = count;
+	runQueryJob(job);
+}
+
+
+//! Collides many moving ellipsoids with a 3d world at once.
+void CSceneCollisionManager::getCollisionResultPositions(SCollisionEllipsoid* ellipsoids, u32 count,
+		ITriangleSelector* selector)
+{
+	CQueryJob job(this, selector, CThreadPool::getSharedPool()->getThreadCount());
+	job.Ellipsoids = ellipsoids;
+	job.Count = count;
+	runQueryJob(job);
+}
+
+
+void CSceneCollisionManager::runQueryJob(CQueryJob& job)
+{
+	if (!job.Count)
+		return;
+
+	// batches of other threads wait, so they don't update the selector while it is read
+	CMutexLock lock(QueryMutex);
+
+	// selectors of animated meshes update their triangles when they are
+	// queried, this has to be done before the threads read them
+	if (job.Selector)
+		updateSelector(job.Selector);
+
+	const u32 parts = (job.Count + QUERY_PART_SIZE - 1) / QUERY_PART_SIZE;
+	CThreadPool* pool = CThreadPool::getSharedPool();
+	if (parts > 1 && pool->getThreadCount() > 1)
+		pool->run(&job, parts);
+	else
+	{
+		for (u32 i=0; i<parts; ++i)
+			job.run(i, 0);
+	}
+}
+
+
+CSceneCollisionManager::CQueryJob::CQueryJob(const CSceneCollisionManager* manager,
+		ITriangleSelector* selector, u32 threadCount)
+	: Manager(manager), Selector(selector), Rays(0), Hits(0), Ellipsoids(0), Count(0)
+{
+	const core::array<core::triangle3df> empty;
+	for (u32 i=0; i<threadCount; ++i)
+		Triangles.push_back(empty);
+}
+
+
+void CSceneCollisionManager::CQueryJob::run(u32 index, u32 thread)
+{
+	const u32 begin = index * QUERY_PART_SIZE;
+	const u32 end = core::min_(begin + QUERY_PART_SIZE, Count);
+	core::array<core::triangle3df>& triangles = Triangles[thread];
+
+	for (u32 i=begin; i<end; ++i)
+	{
+		if (Rays)
+		{
+			SCollisionHit& hit = Hits[i];
+			hit.Node = 0;
+			hit.Hit = Manager->findCollisionPoint(Rays[i], Selector,
+				hit.Point, hit.Triangle, hit.Node, triangles);
+		}
+		else
+		{
+			SCollisionEllipsoid& ellipsoid = Ellipsoids[i];
+			ellipsoid.Node = 0;
+			ellipsoid.ResultPosition = Manager->collideEllipsoidWithWorld(Selector,
+				ellipsoid.Position, ellipsoid.Radius, ellipsoid.DirectionAndSpeed,
+				ellipsoid.SlidingSpeed, ellipsoid.Gravity, ellipsoid.Triangle,
+				ellipsoid.HitPosition, ellipsoid.Falling, ellipsoid.Node, triangles);
+		}
+	}
 }
 
 
 bool CSceneCollisionManager::testTriangleIntersection(SCollisionData* colData,
-			const core::triangle3df& triangle)
+			const core::triangle3df& triangle) const
 {
 	const core::plane3d<f32> trianglePlane = triangle.getPlane();
 
@@ -695,7 +1068,8 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 		core::triangle3df& triout,
 		core::vector3df& hitPosition,
 		bool& outFalling,
-		ISceneNode*& outNode)
+		ISceneNode*& outNode,
+		core::array<core::triangle3df>& triangles) const
 {
 	if (!selector || radius.X == 0.0f || radius.Y == 0.0f || radius.Z == 0.0f)
 		return position;
@@ -719,7 +1093,7 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 	// iterate until we have our final position
 
 	core::vector3df finalPos = collideWithWorld(
-		0, colData, eSpacePosition, eSpaceVelocity);
+		0, colData, eSpacePosition, eSpaceVelocity, triangles);
 
 	outFalling = false;
 
@@ -734,7 +1108,7 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 		eSpaceVelocity = gravity/colData.eRadius;
 
 		finalPos = collideWithWorld(0, colData,
-			finalPos, eSpaceVelocity);
+			finalPos, eSpaceVelocity, triangles);
 
 		outFalling = (colData.triangleHits == 0);
 	}
@@ -755,7 +1129,8 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 
 
 core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
-	SCollisionData &colData, const core::vector3df& pos, const core::vector3df& vel)
+	SCollisionData &colData, const core::vector3df& pos, const core::vector3df& vel,
+	core::array<core::triangle3df>& triangles) const
 {
 	f32 veryCloseDistance = colData.slidingSpeed;
 
@@ -778,7 +1153,7 @@ core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
 	box.MaxEdge += colData.eRadius;
 
 	s32 totalTriangleCnt = colData.selector->getTriangleCount();
-	Triangles.set_used(totalTriangleCnt);
+	triangles.set_used(totalTriangleCnt);
 
 	core::matrix4 scaleMatrix;
 	scaleMatrix.setScale(
@@ -787,10 +1162,10 @@ core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
 					1.0f / colData.eRadius.Z));
 
 	s32 triangleCnt = 0;
-	colData.selector->getTriangles(Triangles.pointer(), totalTriangleCnt, triangleCnt, box, &scaleMatrix);
+	colData.selector->getTriangles(triangles.pointer(), totalTriangleCnt, triangleCnt, box, &scaleMatrix);
 
 	for (s32 i=0; i<triangleCnt; ++i)
-		if(testTriangleIntersection(&colData, Triangles[i]))
+		if(testTriangleIntersection(&colData, triangles[i]))
 			colData.triangleIndex = i;
 
 	//---------------- end collide with world
@@ -834,7 +1209,7 @@ core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
 		return newBasePoint;
 
 	return collideWithWorld(recursionDepth+1, colData,
-		newBasePoint, newVelocityVector);
+		newBasePoint, newVelocityVector, triangles);
 }
 
 
@@ -917,7 +1292,7 @@ core::position2d<s32> CSceneCollisionManager::getScreenCoordinatesFrom3DPosition
 }
 
 
-inline bool CSceneCollisionManager::getLowestRoot(f32 a, f32 b, f32 c, f32 maxR, f32* root)
+inline bool CSceneCollisionManager::getLowestRoot(f32 a, f32 b, f32 c, f32 maxR, f32* root) const
 {
 	// check if solution exists
 	const f32 determinant = b*b - 4.0f*a*c;
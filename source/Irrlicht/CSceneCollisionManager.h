@@ -8,11 +8,13 @@
 #include "ISceneCollisionManager.h"
 #include "ISceneManager.h"
 #include "IVideoDriver.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
 namespace scene
 {
+	class CSceneNodeGrid;
 
 	//! The Scene Collision Manager provides methods for performing collision tests and picking on scene nodes.
 	class CSceneCollisionManager : public ISceneCollisionManager
@@ -61,6 +63,14 @@ namespace scene
 			f32 slidingSpeed,
 			const core::vector3df& gravityDirectionAndSpeed) _IRR_OVERRIDE_;
 
+		//! Finds the nearest collision points of many lines at once.
+		virtual void getCollisionPoints(const core::line3d<f32>* rays, u32 count,
+			ITriangleSelector* selector, SCollisionHit* outHits) _IRR_OVERRIDE_;
+
+		//! Collides many moving ellipsoids with a 3d world at once.
+		virtual void getCollisionResultPositions(SCollisionEllipsoid* ellipsoids, u32 count,
+			ITriangleSelector* selector) _IRR_OVERRIDE_;
+
 		//! Returns a 3d ray which would go through the 2d screen coodinates.
 		virtual core::line3d<f32> getRayFromScreenCoordinates(
 			const core::position2d<s32> & pos, ICameraSceneNode* camera = 0) _IRR_OVERRIDE_;
@@ -79,14 +89,59 @@ namespace scene
 								ISceneNode * collisionRootNode = 0,
 								bool noDebugObjects = false) _IRR_OVERRIDE_;
 
+		//! Collects the scene nodes whose transformed bounding boxes intersect with a sphere.
+		virtual void getSceneNodesFromSphereBB(const core::vector3df& center, f32 radius,
+			core::array<ISceneNode*>& outNodes, s32 idBitMask=0, bool noDebugObjects=false,
+			ISceneNode* root=0) _IRR_OVERRIDE_;
+
+		//! Sets the spatial index of the scene manager, 0 if it has none
+		void setNodeGrid(CSceneNodeGrid* grid) { Grid = grid; }
 
 	private:
 
+		//! executes the batched queries, called by CThreadPool
+		class CQueryJob : public IThreadJob
+		{
+		public:
+			CQueryJob(const CSceneCollisionManager* manager, ITriangleSelector* selector, u32 threadCount);
+
+			virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_;
+
+			const CSceneCollisionManager* Manager;
+			ITriangleSelector* Selector;
+
+			const core::line3d<f32>* Rays;
+			SCollisionHit* Hits;
+			SCollisionEllipsoid* Ellipsoids;
+			u32 Count;
+
+			//! triangle buffer of each thread
+			core::array<core::array<core::triangle3df> > Triangles;
+		};
+
+		//! runs the queries of a job on the shared thread pool
+		void runQueryJob(CQueryJob& job);
+
+		//! finds the collision point of a line using the given triangle buffer
+		bool findCollisionPoint(const core::line3d<f32>& ray,
+			ITriangleSelector* selector, core::vector3df& outCollisionPoint,
+			core::triangle3df& outTriangle, ISceneNode*& outNode,
+			core::array<core::triangle3df>& triangles) const;
+
 		//! recursive method for going through all scene nodes
 		void getPickedNodeBB(ISceneNode* root, core::line3df& ray, s32 bits,
 					bool bNoDebugObjects,
 					f32& outbestdistance, ISceneNode*& outbestnode);
 
+		//! goes through the nodes of the grid whose boxes can be hit by the ray
+		void getPickedNodeBBFromGrid(ISceneNode* root, core::line3df& ray, s32 bits,
+					bool noDebugObjects,
+					f32& outbestdistance, ISceneNode*& outbestnode);
+
+		//! tests a node's bounding box against the ray
+		void testNodeBB(ISceneNode* current, core::line3df& ray, const core::vector3df& rayVector,
+					f32& outbestdistance, ISceneNode*& outbestnode);
+
 		//! recursive method for going through all scene nodes
 		void getPickedNodeFromBBAndSelector(ISceneNode * root,
 						core::line3df & ray,
@@ -97,6 +152,29 @@ namespace scene
 						core::vector3df & outBestCollisionPoint,
 						core::triangle3df & outBestTriangle);
 
+		//! goes through the nodes of the grid with triangle selectors whose boxes can be hit by the ray
+		void getPickedNodeFromBBAndSelectorFromGrid(ISceneNode* root, core::line3df& ray,
+						s32 bits, bool noDebugObjects,
+						f32& outBestDistanceSquared, ISceneNode*& outBestNode,
+						core::vector3df& outBestCollisionPoint,
+						core::triangle3df& outBestTriangle);
+
+		//! tests a node's triangle selector against the ray
+		void testNodeSelector(ISceneNode* current, ITriangleSelector* selector, core::line3df& ray,
+						f32& outBestDistanceSquared, ISceneNode*& outBestNode,
+						core::vector3df& outBestCollisionPoint,
+						core::triangle3df& outBestTriangle);
+
+		//! recursive method for going through all scene nodes
+		void getNodesFromSphereBB(ISceneNode* root, const core::vector3df& center, f32 radius,
+						s32 bits, bool noDebugObjects, core::array<ISceneNode*>& outNodes);
+
+		//! brings the grid up to date, checks if it knows all nodes the recursive methods would visit below root
+		bool updateGrid(const ISceneNode* root);
+
+		//! checks if a collection of selectors contains one with its own line intersection
+		bool hasIntersectionWithLineInside(const ITriangleSelector* selector) const;
+
 
 		struct SCollisionData
 		{
@@ -128,7 +206,7 @@ namespace scene
 		\param triangle: the triangle to test against.
 		\return true if the triangle is hit (and is the closest hit), false otherwise */
 		bool testTriangleIntersection(SCollisionData* colData,
-			const core::triangle3df& triangle);
+			const core::triangle3df& triangle) const;
 
 		//! recursive method for doing collision response
 		core::vector3df collideEllipsoidWithWorld(ITriangleSelector* selector,
@@ -138,16 +216,21 @@ namespace scene
 			const core::vector3df& gravity, core::triangle3df& triout,
 			core::vector3df& hitPosition,
 			bool& outFalling,
-			ISceneNode*& outNode);
+			ISceneNode*& outNode,
+			core::array<core::triangle3df>& triangles) const;
 
 		core::vector3df collideWithWorld(s32 recursionDepth, SCollisionData &colData,
-			const core::vector3df& pos, const core::vector3df& vel);
+			const core::vector3df& pos, const core::vector3df& vel,
+			core::array<core::triangle3df>& triangles) const;
 
-		inline bool getLowestRoot(f32 a, f32 b, f32 c, f32 maxR, f32* root);
+		inline bool getLowestRoot(f32 a, f32 b, f32 c, f32 maxR, f32* root) const;
 
 		ISceneManager* SceneManager;
 		video::IVideoDriver* Driver;
 		core::array<core::triangle3df> Triangles; // triangle buffer
+		CSceneNodeGrid* Grid;
+		// held by a batch while it updates and reads the selector
+		CMutex QueryMutex;
 	};
 
 
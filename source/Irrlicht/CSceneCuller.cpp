@@ -0,0 +1,439 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneCuller.h"
+#include "CSceneNodeGrid.h"
+#include "ICameraSceneNode.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+// nodes tested by one part of the job, a multiple of 4
+static const u32 PART_SIZE = 512;
+
+// the world space test only decides if the box is farther away from a plane than this
+// fraction of the magnitude of the terms, CSceneManager::isCulled works in the node's
+// space and has different rounding errors
+static const f32 PLANE_EPSILON_RELATIVE = 0.001f;
+static const f32 PLANE_EPSILON_ABSOLUTE = 0.0001f;
+
+
+// isCulled transforms the frustum with the inverse matrix, the world space
+// plane test only gives the same results for well behaved matrices
+static bool isWellBehaved(const core::matrix4& transformation)
+{
+	const f32* m = transformation.pointer();
+	const core::vector3df x(m[0], m[1], m[2]);
+	const core::vector3df y(m[4], m[5], m[6]);
+	const core::vector3df z(m[8], m[9], m[10]);
+	const f32 det = x.dotProduct(y.crossProduct(z));
+	const f32 bound = x.getLength() * y.getLength() * z.getLength();
+
+	return m[3] == 0.f && m[7] == 0.f && m[11] == 0.f && m[15] == 1.f &&
+		core::abs_(det) > bound * 0.000001f;
+}
+
+
+//! Constructor
+CSceneCuller::CSceneCuller()
+: Camera(0), HasWorldBoxes(false), UseSSE2(os::Cpu::hasSSE2())
+{
+}
+
+
+void CSceneCuller::cull(ISceneNode* root, const ICameraSceneNode* camera, const CSceneNodeGrid* grid)
+{
+	clear();
+
+	if (!root || !camera)
+		return;
+
+	Camera = camera;
+	Frustum = *camera->getViewFrustum();
+
+	HasWorldBoxes = grid != 0;
+	if (grid)
+		collect(grid);
+	else
+		collect(root);
+
+	const u32 count = Nodes.size();
+	if (!count)
+		return;
+
+	const u32 padded = (count + 3) & ~3;
+	CenterX.set_used(padded);
+	CenterY.set_used(padded);
+	CenterZ.set_used(padded);
+	ExtentX.set_used(padded);
+	ExtentY.set_used(padded);
+	ExtentZ.set_used(padded);
+	Results.set_used(padded);
+	for (u32 i=0; i<count; ++i)
+		Results[i] = Nodes[i].CellCulled ? ECR_CULLED : ECR_VISIBLE;
+	for (u32 i=count; i<padded; ++i)
+	{
+		CenterX[i] = CenterY[i] = CenterZ[i] = 0.f;
+		ExtentX[i] = ExtentY[i] = ExtentZ[i] = 0.f;
+		Results[i] = ECR_UNKNOWN;
+	}
+
+	// hash with a load of at most one half
+	u32 slotCount = 16;
+	while (slotCount < count * 2)
+		slotCount <<= 1;
+	Slots.set_used(slotCount);
+	memset(Slots.pointer(), 0, slotCount * sizeof(u32));
+	for (u32 i=0; i<count; ++i)
+		insert(i);
+
+	CThreadPool::getSharedPool()->run(this, (count + PART_SIZE - 1) / PART_SIZE);
+}
+
+
+void CSceneCuller::clear()
+{
+	Nodes.set_used(0);
+	Slots.set_used(0);
+	Camera = 0;
+}
+
+
+//! collects the nodes ISceneNode::OnRegisterSceneNode would visit
+void CSceneCuller::collect(ISceneNode* node)
+{
+	const ISceneNodeList& children = node->getChildren();
+	ISceneNodeList::ConstIterator it = children.begin();
+	for (; it != children.end(); ++it)
+	{
+		ISceneNode* child = *it;
+		if (!child->isVisible())
+			continue;
+
+		const u32 culling = child->getAutomaticCulling() &
+			(EAC_BOX | EAC_FRUSTUM_BOX | EAC_FRUSTUM_SPHERE);
+		if (culling)
+		{
+			Nodes.push_back(SNode());
+			SNode& n = Nodes.getLast();
+			n.Node = child;
+			n.Transformation = child->getAbsoluteTransformation();
+			n.Box = child->getBoundingBox();
+			n.Culling = culling;
+			n.CellCulled = false;
+		}
+
+		collect(child);
+	}
+}
+
+
+//! takes the nodes from a grid and culls the cells outside of the frustum
+void CSceneCuller::collect(const CSceneNodeGrid* grid)
+{
+	const core::aabbox3d<f32>& frustumBox = Frustum.getBoundingBox();
+
+	for (u32 c=0; c<grid->getCellCount(); ++c)
+	{
+		const CSceneNodeGrid::SCell& cell = grid->getCell(c);
+		if (!cell.Count)
+			continue;
+
+		// the boxes of all nodes of the cell are inside its bounds
+		const bool outsideBox = !cell.Bounds.intersectsWithBox(frustumBox);
+		bool outsidePlanes = false;
+		if (cell.Level < CSceneNodeGrid::LEVEL_COUNT)
+		{
+			const core::vector3df center = cell.Bounds.getCenter();
+			const core::vector3df extent = cell.Bounds.getExtent() * 0.5f;
+			for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT && !outsidePlanes; ++p)
+			{
+				const core::plane3df& plane = Frustum.planes[p];
+				const f32 tx = plane.Normal.X * center.X;
+				const f32 ty = plane.Normal.Y * center.Y;
+				const f32 tz = plane.Normal.Z * center.Z;
+				const f32 dist = tx + ty + tz + plane.D;
+				const f32 radius = core::abs_(plane.Normal.X) * extent.X +
+					core::abs_(plane.Normal.Y) * extent.Y +
+					core::abs_(plane.Normal.Z) * extent.Z;
+				const f32 magnitude = core::abs_(tx) + core::abs_(ty) + core::abs_(tz) +
+					core::abs_(plane.D) + radius;
+
+				outsidePlanes = dist - radius > magnitude * PLANE_EPSILON_RELATIVE + PLANE_EPSILON_ABSOLUTE;
+			}
+		}
+
+		for (s32 e=cell.First; e>=0; e=grid->getEntry(e).Next)
+		{
+			const CSceneNodeGrid::SEntry& entry = grid->getEntry(e);
+			const u32 culling = entry.Node->getAutomaticCulling() &
+				(EAC_BOX | EAC_FRUSTUM_BOX | EAC_FRUSTUM_SPHERE);
+			if (!culling)
+				continue;
+
+			Nodes.push_back(SNode());
+			SNode& n = Nodes.getLast();
+			n.Node = entry.Node;
+			n.Transformation = entry.Transformation;
+			n.Box = entry.Box;
+			n.WorldBox = entry.WorldBox;
+			n.Culling = culling;
+			n.CellCulled = ((culling & EAC_BOX) && outsideBox) ||
+				((culling & EAC_FRUSTUM_BOX) && outsidePlanes && isWellBehaved(entry.Transformation));
+		}
+	}
+}
+
+
+static inline u32 hashNode(const ISceneNode* node)
+{
+	return (u32)(((size_t)node >> 4) * 2654435761u);
+}
+
+
+void CSceneCuller::insert(u32 index)
+{
+	const u32 mask = Slots.size() - 1;
+	u32 slot = hashNode(Nodes[index].Node) & mask;
+	while (Slots[slot])
+	{
+		// a node is only visited once, but be safe if the tree was modified by a user
+		if (Nodes[Slots[slot]-1].Node == Nodes[index].Node)
+		{
+			Results[Slots[slot]-1] = ECR_UNKNOWN;
+			return;
+		}
+		slot = (slot + 1) & mask;
+	}
+	Slots[slot] = index + 1;
+}
+
+
+s32 CSceneCuller::find(const ISceneNode* node) const
+{
+	if (Slots.empty())
+		return -1;
+
+	const u32 mask = Slots.size() - 1;
+	u32 slot = hashNode(node) & mask;
+	while (Slots[slot])
+	{
+		if (Nodes[Slots[slot]-1].Node == node)
+			return (s32)Slots[slot]-1;
+		slot = (slot + 1) & mask;
+	}
+	return -1;
+}
+
+
+bool CSceneCuller::getResult(const ISceneNode* node, const ICameraSceneNode* camera, bool& culled) const
+{
+	if (camera != Camera)
+		return false;
+
+	const s32 index = find(node);
+	if (index < 0 || Results[index] > ECR_CULLED)
+		return false;
+
+	// OnRegisterSceneNode of a parent might have changed the node
+	const SNode& n = Nodes[index];
+	if (n.Culling != (node->getAutomaticCulling() & (EAC_BOX | EAC_FRUSTUM_BOX | EAC_FRUSTUM_SPHERE)) ||
+		n.Box != node->getBoundingBox() ||
+		n.Transformation != node->getAbsoluteTransformation())
+		return false;
+
+	culled = Results[index] == ECR_CULLED;
+	return true;
+}
+
+
+void CSceneCuller::run(u32 index, u32 thread)
+{
+	const u32 begin = index * PART_SIZE;
+	const u32 end = core::min_(begin + PART_SIZE, Nodes.size());
+
+	transformBoxes(begin, end);
+	testPlanes(begin, end);
+}
+
+
+//! transforms the boxes to world space and does the box and sphere tests
+void CSceneCuller::transformBoxes(u32 begin, u32 end)
+{
+	const core::aabbox3d<f32>& frustumBox = Frustum.getBoundingBox();
+	const f32 camrad = Frustum.getBoundingRadius();
+	const core::vector3df camcenter = Frustum.getBoundingCenter();
+
+	for (u32 i=begin; i<end; ++i)
+	{
+		const SNode& n = Nodes[i];
+		if (Results[i] != ECR_VISIBLE)
+			continue;
+
+		// same calculations as CSceneManager::isCulled
+		core::aabbox3d<f32> tbox = n.WorldBox;
+		if (!HasWorldBoxes)
+		{
+			tbox = n.Box;
+			n.Transformation.transformBoxEx(tbox);
+		}
+
+		const core::vector3df center = tbox.getCenter();
+		const core::vector3df extent = tbox.getExtent() * 0.5f;
+		CenterX[i] = center.X;
+		CenterY[i] = center.Y;
+		CenterZ[i] = center.Z;
+		ExtentX[i] = extent.X;
+		ExtentY[i] = extent.Y;
+		ExtentZ[i] = extent.Z;
+
+		bool result = false;
+
+		if (n.Culling & EAC_BOX)
+			result = !tbox.intersectsWithBox(frustumBox);
+
+		if (!result && (n.Culling & EAC_FRUSTUM_SPHERE))
+		{
+			const f32 rad = tbox.getRadius();
+			const f32 dist = (center - camcenter).getLengthSQ();
+			const f32 maxdist = (rad + camrad) * (rad + camrad);
+
+			result = dist > maxdist;
+		}
+
+		if (result)
+			Results[i] = ECR_CULLED;
+		else if (!(n.Culling & EAC_FRUSTUM_BOX))
+			Results[i] = ECR_VISIBLE;
+		else if (isWellBehaved(n.Transformation))
+			Results[i] = ECR_TEST_PLANES;
+		else
+			Results[i] = ECR_UNKNOWN;
+	}
+}
+
+
+//! Tests the world space boxes against the frustum planes.
+/** A box is culled if it is completely in front of one plane. It is visible if its center
+is behind all planes, then one corner of the node's transformed box is behind each plane
+as well, which is what isCulled tests. Everything in between is left to isCulled. */
+void CSceneCuller::testPlanes(u32 begin, u32 end)
+{
+	u32 i = begin;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+		const __m128 epsilonRel = _mm_set1_ps(PLANE_EPSILON_RELATIVE);
+		const __m128 epsilonAbs = _mm_set1_ps(PLANE_EPSILON_ABSOLUTE);
+
+		// the arrays are padded, so the last group may reach beyond end
+		for (; i < end; i += 4)
+		{
+			if (Results[i] != ECR_TEST_PLANES && Results[i+1] != ECR_TEST_PLANES &&
+				Results[i+2] != ECR_TEST_PLANES && Results[i+3] != ECR_TEST_PLANES)
+				continue;
+
+			const __m128 cx = _mm_loadu_ps(&CenterX[i]);
+			const __m128 cy = _mm_loadu_ps(&CenterY[i]);
+			const __m128 cz = _mm_loadu_ps(&CenterZ[i]);
+			const __m128 ex = _mm_loadu_ps(&ExtentX[i]);
+			const __m128 ey = _mm_loadu_ps(&ExtentY[i]);
+			const __m128 ez = _mm_loadu_ps(&ExtentZ[i]);
+
+			__m128 outside = _mm_setzero_ps();
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+			for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+			{
+				const core::plane3df& plane = Frustum.planes[p];
+				const __m128 tx = _mm_mul_ps(_mm_set1_ps(plane.Normal.X), cx);
+				const __m128 ty = _mm_mul_ps(_mm_set1_ps(plane.Normal.Y), cy);
+				const __m128 tz = _mm_mul_ps(_mm_set1_ps(plane.Normal.Z), cz);
+				const __m128 d = _mm_set1_ps(plane.D);
+
+				// distance of the center and projected radius of the box
+				const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(tx, ty), tz), d);
+				const __m128 radius = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_set1_ps(core::abs_(plane.Normal.X)), ex),
+					_mm_mul_ps(_mm_set1_ps(core::abs_(plane.Normal.Y)), ey)),
+					_mm_mul_ps(_mm_set1_ps(core::abs_(plane.Normal.Z)), ez));
+
+				const __m128 magnitude = _mm_add_ps(_mm_add_ps(
+					_mm_add_ps(_mm_and_ps(tx, absMask), _mm_and_ps(ty, absMask)),
+					_mm_add_ps(_mm_and_ps(tz, absMask), _mm_and_ps(d, absMask))), radius);
+				const __m128 margin = _mm_add_ps(_mm_mul_ps(magnitude, epsilonRel), epsilonAbs);
+
+				outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(dist, radius), margin));
+				inside = _mm_and_ps(inside, _mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), margin)));
+			}
+
+			const int culled = _mm_movemask_ps(outside);
+			const int visible = _mm_movemask_ps(inside);
+
+			for (u32 k=0; k<4; ++k)
+			{
+				if (Results[i+k] != ECR_TEST_PLANES)
+					continue;
+
+				if (culled & (1<<k))
+					Results[i+k] = ECR_CULLED;
+				else if (visible & (1<<k))
+					Results[i+k] = ECR_VISIBLE;
+				else
+					Results[i+k] = ECR_UNKNOWN;
+			}
+		}
+	}
+#endif
+
+	for (; i < end; ++i)
+	{
+		if (Results[i] != ECR_TEST_PLANES)
+			continue;
+
+		bool outside = false;
+		bool inside = true;
+
+		for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			const core::plane3df& plane = Frustum.planes[p];
+			const f32 tx = plane.Normal.X * CenterX[i];
+			const f32 ty = plane.Normal.Y * CenterY[i];
+			const f32 tz = plane.Normal.Z * CenterZ[i];
+
+			const f32 dist = tx + ty + tz + plane.D;
+			const f32 radius = core::abs_(plane.Normal.X) * ExtentX[i] +
+				core::abs_(plane.Normal.Y) * ExtentY[i] +
+				core::abs_(plane.Normal.Z) * ExtentZ[i];
+
+			const f32 magnitude = core::abs_(tx) + core::abs_(ty) + core::abs_(tz) +
+				core::abs_(plane.D) + radius;
+			const f32 margin = magnitude * PLANE_EPSILON_RELATIVE + PLANE_EPSILON_ABSOLUTE;
+
+			outside = outside || (dist - radius > margin);
+			inside = inside && (dist < -margin);
+		}
+
+		if (outside)
+			Results[i] = ECR_CULLED;
+		else if (inside)
+			Results[i] = ECR_VISIBLE;
+		else
+			Results[i] = ECR_UNKNOWN;
+	}
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
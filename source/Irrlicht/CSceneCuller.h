@@ -0,0 +1,107 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_CULLER_H_INCLUDED__
+#define __C_SCENE_CULLER_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "SViewFrustum.h"
+#include "CThreadPool.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ICameraSceneNode;
+	class CSceneNodeGrid;
+
+	//! Culls all nodes of a scene at once before they are registered for rendering.
+	/** The world space bounding boxes of all visible nodes are collected into flat arrays
+	and tested against the view frustum in groups of four, split into parts for the shared
+	CThreadPool. CSceneManager::isCulled then only has to look up the result. The tests give
+	the same results as CSceneManager::isCulled. Nodes with a box too close to a frustum plane
+	for the world space test are reported as unknown and tested the old way. */
+	class CSceneCuller : public IThreadJob
+	{
+	public:
+
+		//! Constructor
+		CSceneCuller();
+
+		//! Collects the visible nodes below root and tests them against the camera's view frustum.
+		/** Results of a previous call are discarded.
+		\param grid If not 0, the nodes are taken from the grid instead, which must have been
+		updated for root after the nodes were animated. */
+		void cull(ISceneNode* root, const ICameraSceneNode* camera, const CSceneNodeGrid* grid=0);
+
+		//! Discards all results.
+		void clear();
+
+		//! Returns the result for a node.
+		/** \param culled Is set to true if the node is outside of the view frustum.
+		\return False if the node wasn't tested by the last cull() call, the test wasn't
+		conclusive or the node's bounding box, transformation or culling type changed since.
+	When the scene manager keeps a CSceneNodeGrid, the nodes and their world space boxes are
+	taken from it and the nodes of cells outside of the frustum are culled without testing
+	them one by one. */
+		bool getResult(const ISceneNode* node, const ICameraSceneNode* camera, bool& culled) const;
+
+		//! Tests one part of the collected nodes, called by CThreadPool.
+		virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_;
+
+	private:
+
+		enum E_CULL_RESULT
+		{
+			ECR_VISIBLE = 0,
+			ECR_CULLED,
+			ECR_UNKNOWN,
+			//! waits for the plane test
+			ECR_TEST_PLANES
+		};
+
+		//! a node as it was collected
+		struct SNode
+		{
+			const ISceneNode* Node;
+			core::matrix4 Transformation;
+			core::aabbox3d<f32> Box;
+			//! box transformed to world space, only set for nodes from a grid
+			core::aabbox3d<f32> WorldBox;
+			u32 Culling;
+			//! the cell of the node in the grid is outside of the frustum
+			bool CellCulled;
+		};
+
+		void collect(ISceneNode* node);
+		void collect(const CSceneNodeGrid* grid);
+		void insert(u32 index);
+		s32 find(const ISceneNode* node) const;
+
+		void transformBoxes(u32 begin, u32 end);
+		void testPlanes(u32 begin, u32 end);
+
+		core::array<SNode> Nodes;
+
+		//! world space bounding boxes as center and half extent, padded to a multiple of 4
+		core::array<f32> CenterX, CenterY, CenterZ;
+		core::array<f32> ExtentX, ExtentY, ExtentZ;
+
+		//! one E_CULL_RESULT per node
+		core::array<u8> Results;
+
+		//! open addressing hash from node to index+1, 0 is an empty slot
+		core::array<u32> Slots;
+
+		const ICameraSceneNode* Camera;
+		SViewFrustum Frustum;
+		bool HasWorldBoxes;
+		bool UseSSE2;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
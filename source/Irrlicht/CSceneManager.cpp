@@ -18,6 +18,11 @@
 #include "EProfileIDs.h"
 #include "IProfiler.h"
 #include "IInstancedMeshSceneNode.h"
+#include "CSceneCuller.h"
+#include "CSceneNodeGrid.h"
+#include "CAnimationStage.h"
+#include "CAssetLoader.h"
+#include "CMeshTextureLoader.h"
 
 #include "os.h"
 
@@ -150,6 +155,7 @@
 #include "CDummyTransformationSceneNode.h"
 #include "CWaterSurfaceSceneNode.h"
 #include "CTerrainSceneNode.h"
+#include "CPagedTerrainSceneNode.h"
 #include "CEmptySceneNode.h"
 #include "CTextSceneNode.h"
 #include "CQuake3ShaderSceneNode.h"
@@ -160,6 +166,7 @@
 #include "CSceneCollisionManager.h"
 #include "CTriangleSelector.h"
 #include "COctreeTriangleSelector.h"
+#include "CBVHTriangleSelector.h"
 #include "CTriangleBBSelector.h"
 #include "CMetaTriangleSelector.h"
 #include "CTerrainTriangleSelector.h"
@@ -187,9 +194,10 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 		gui::ICursorControl* cursorControl, IMeshCache* cache,
 		gui::IGUIEnvironment* gui)
 : ISceneNode(0, 0), Driver(driver), FileSystem(fs), GUIEnvironment(gui),
-	CursorControl(cursorControl), CollisionManager(0),
+	CursorControl(cursorControl), CollisionManager(0), RenderQueue(driver),
 	ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
-	MeshCache(cache), CurrentRenderPass(ESNRP_NONE), LightManager(0),
+	MeshCache(cache), CurrentRenderPass(ESNRP_NONE), LightManager(0), Culler(0),
+	NodeGrid(0), AnimationStage(0), MeshRequests(0),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
 {
 	#ifdef _DEBUG
@@ -218,6 +226,8 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	else
 		MeshCache->grab();
 
+	MeshRequests = new io::CAssetLoader();
+
 	// set scene parameters
 	Parameters = new io::CAttributes();
 	Parameters->setAttribute(DEBUG_NORMAL_LENGTH, 1.f);
@@ -328,6 +338,8 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 			getProfiler().add(EPID_SM_RENDER_TRANSPARENT, L"transp.nodes", L"Irrlicht scene");
 			getProfiler().add(EPID_SM_RENDER_EFFECT, L"effectnodes", L"Irrlicht scene");
 			getProfiler().add(EPID_SM_REGISTER, L"reg.render.node", L"Irrlicht scene");
+			getProfiler().add(EPID_SM_CULL, L"cull", L"Irrlicht scene");
+			getProfiler().add(EPID_SM_SKIN, L"skin", L"Irrlicht scene");
 		}
  	)
 }
@@ -336,6 +348,9 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 //! destructor
 CSceneManager::~CSceneManager()
 {
+	delete MeshRequests;
+	setSpatialIndexEnabled(false);
+
 	clearDeletionList();
 
 	//! force to remove hardwareTextures from the driver
@@ -354,6 +369,9 @@ CSceneManager::~CSceneManager()
 	if (GeometryCreator)
 		GeometryCreator->drop();
 
+	delete Culler;
+	delete AnimationStage;
+
 	if (GUIEnvironment)
 		GUIEnvironment->drop();
 
@@ -408,31 +426,9 @@ IAnimatedMesh* CSceneManager::getMesh(const io::path& filename)
 		return 0;
 	}
 
-	// iterate the list in reverse order so user-added loaders can override the built-in ones
-	s32 count = MeshLoaderList.size();
-	for (s32 i=count-1; i>=0; --i)
-	{
-		if (MeshLoaderList[i]->isALoadableFileExtension(filename))
-		{
-			// reset file to avoid side effects of previous calls to createMesh
-			file->seek(0);
-			msh = MeshLoaderList[i]->createMesh(file);
-			if (msh)
-			{
-				MeshCache->addMesh(filename, msh);
-				msh->drop();
-				break;
-			}
-		}
-	}
-
+	msh = loadMesh(file, filename);
 	file->drop();
 
-	if (!msh)
-		os::Printer::log("Could not load mesh, file format seems to be unsupported", filename, ELL_ERROR);
-	else
-		os::Printer::log("Loaded mesh", filename, ELL_INFORMATION);
-
 	return msh;
 }
 
@@ -443,11 +439,19 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 	if (!file)
 		return 0;
 
-	io::path name = file->getFileName();
 	IAnimatedMesh* msh = MeshCache->getMeshByName(file->getFileName());
 	if (msh)
 		return msh;
 
+	return loadMesh(file, file->getFileName());
+}
+
+
+//! loads a mesh with the mesh loaders and adds it to the mesh cache under the given name
+IAnimatedMesh* CSceneManager::loadMesh(io::IReadFile* file, const io::path& name)
+{
+	IAnimatedMesh* msh = 0;
+
 	// iterate the list in reverse order so user-added loaders can override the built-in ones
 	s32 count = MeshLoaderList.size();
 	for (s32 i=count-1; i>=0; --i)
@@ -456,10 +460,17 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 		{
 			// reset file to avoid side effects of previous calls to createMesh
 			file->seek(0);
-			msh = MeshLoaderList[i]->createMesh(file);
+			if (MeshLoaderList[i]->isWorkerThreadSafe())
+			{
+				// a mesh request might use the loader at the same time
+				CMutexLock lock(MeshLoaderMutex);
+				msh = MeshLoaderList[i]->createMesh(file);
+			}
+			else
+				msh = MeshLoaderList[i]->createMesh(file);
 			if (msh)
 			{
-				MeshCache->addMesh(file->getFileName(), msh);
+				MeshCache->addMesh(name, msh);
 				msh->drop();
 				break;
 			}
@@ -467,14 +478,156 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 	}
 
 	if (!msh)
-		os::Printer::log("Could not load mesh, file format seems to be unsupported", file->getFileName(), ELL_ERROR);
+		os::Printer::log("Could not load mesh, file format seems to be unsupported", name, ELL_ERROR);
 	else
-		os::Printer::log("Loaded mesh", file->getFileName(), ELL_INFORMATION);
+		os::Printer::log("Loaded mesh", name, ELL_INFORMATION);
 
 	return msh;
 }
 
 
+//! creates a mesh on a worker thread with the loaders which allow it
+IAnimatedMesh* CSceneManager::createMeshOnWorker(io::IReadFile* file, const io::path& name,
+	IMeshTextureLoader* textureLoader, bool& supported)
+{
+	CMutexLock lock(MeshLoaderMutex);
+
+	supported = false;
+
+	// same order as loadMesh
+	s32 count = MeshLoaderList.size();
+	for (s32 i=count-1; i>=0; --i)
+	{
+		IMeshLoader* loader = MeshLoaderList[i];
+		if (!loader->isALoadableFileExtension(name))
+			continue;
+
+		// loadMesh would try this one, which only works on the main thread
+		if (!loader->isWorkerThreadSafe())
+		{
+			supported = false;
+			return 0;
+		}
+		supported = true;
+
+		IMeshTextureLoader* original = loader->getMeshTextureLoader();
+		if (original)
+		{
+			original->grab();
+			textureLoader->setTexturePath(original->getTexturePath());
+			loader->setMeshTextureLoader(textureLoader);
+		}
+
+		file->seek(0);
+		IAnimatedMesh* msh = loader->createMesh(file);
+
+		if (original)
+		{
+			loader->setMeshTextureLoader(original);
+			original->drop();
+		}
+
+		if (msh)
+			return msh;
+	}
+
+	return 0;
+}
+
+
+namespace
+{
+	//! Creates the mesh on a worker thread if its loader allows it, otherwise on the main thread.
+	/** The textures of meshes created on a worker thread are requested from the
+	video driver afterwards, the mesh is ready once they are loaded. */
+	class CMeshRequest : public io::CAssetRequest
+	{
+	public:
+
+		CMeshRequest(CSceneManager* smgr, const io::path& name, io::IReadFile* file)
+			: io::CAssetRequest(name, file), SceneManager(smgr), Created(0), Supported(false)
+		{
+			TextureLoader = new CDeferredMeshTextureLoader(smgr->getFileSystem(), smgr->getVideoDriver());
+		}
+
+		virtual ~CMeshRequest()
+		{
+			// before the placeholder textures
+			if (Created)
+				Created->drop();
+			TextureLoader->drop();
+		}
+
+		virtual void load() _IRR_OVERRIDE_
+		{
+			Created = SceneManager->createMeshOnWorker(File, Name, TextureLoader, Supported);
+		}
+
+		virtual bool finish() _IRR_OVERRIDE_
+		{
+			// the mesh might have been loaded by getMesh in the meantime
+			IAnimatedMesh* mesh = SceneManager->getMeshCache()->getMeshByName(Name);
+			if (!mesh && !Supported)
+				mesh = SceneManager->loadMesh(File, Name);
+			else if (!mesh && Created)
+			{
+				if (!TextureLoader->requestTextures())
+					return false;
+
+				TextureLoader->replaceTextures(Created);
+				SceneManager->getMeshCache()->addMesh(Name, Created);
+				os::Printer::log("Loaded mesh", Name, ELL_INFORMATION);
+				mesh = Created;
+			}
+			else if (!mesh)
+				os::Printer::log("Could not load mesh, file format seems to be unsupported", Name, ELL_ERROR);
+
+			setMesh(mesh);
+			return true;
+		}
+
+	private:
+
+		CSceneManager* SceneManager;
+		CDeferredMeshTextureLoader* TextureLoader;
+		IAnimatedMesh* Created;
+		bool Supported;
+	};
+} // end anonymous namespace
+
+
+//! loads a mesh in the background
+io::IAssetRequest* CSceneManager::requestMesh(const io::path& filename)
+{
+	IAnimatedMesh* msh = MeshCache->getMeshByName(filename);
+	io::IReadFile* file = msh ? 0 : FileSystem->createAndOpenFile(filename);
+
+	io::CAssetRequest* request = new CMeshRequest(this, filename, file);
+
+	if (msh)
+		request->setMesh(msh);
+	else if (file)
+		MeshRequests->add(request);
+	else
+	{
+		os::Printer::log("Could not load mesh, because file could not be opened: ", filename, ELL_ERROR);
+		request->setFailed();
+	}
+
+	if (file)
+		file->drop();
+
+	return request;
+}
+
+
+//! Set the time drawAll() may spend creating requested meshes
+void CSceneManager::setMeshLoadBudget(u32 milliseconds)
+{
+	MeshRequests->setBudget(milliseconds);
+}
+
+
 //! returns the video driver
 video::IVideoDriver* CSceneManager::getVideoDriver()
 {
@@ -934,6 +1087,39 @@ ITerrainSceneNode* CSceneManager::addTerrainSceneNode(
 }
 
 
+//! Adds a paged terrain scene node to the scene graph.
+IPagedTerrainSceneNode* CSceneManager::addPagedTerrainSceneNode(
+	const SPagedTerrainParameters& parameters,
+	ISceneNode* parent, s32 id,
+	const core::vector3df& position,
+	const core::vector3df& rotation,
+	const core::vector3df& scale)
+{
+	const bool validFormat = parameters.FloatValues ? parameters.BitsPerSample == 32 :
+		(parameters.BitsPerSample == 8 || parameters.BitsPerSample == 16 || parameters.BitsPerSample == 32);
+
+	io::path tileName;
+	if (!CPagedTerrainSceneNode::getTileName(tileName, parameters.TileNames, 0, 0) ||
+		!parameters.TileCountX || !parameters.TileCountZ ||
+		!parameters.PatchSize || (parameters.PatchSize & (parameters.PatchSize - 1)) ||
+		parameters.TileSize < 2 || (parameters.TileSize - 1) % parameters.PatchSize ||
+		!validFormat || parameters.Scale.X <= 0.f || parameters.Scale.Z <= 0.f)
+	{
+		os::Printer::log("Could not add paged terrain, because of invalid parameters.", parameters.TileNames, ELL_ERROR);
+		return 0;
+	}
+
+	if (!parent)
+		parent = this;
+
+	CPagedTerrainSceneNode* node = new CPagedTerrainSceneNode(parameters, parent, this,
+		FileSystem, id, position, rotation, scale);
+
+	node->drop();
+	return node;
+}
+
+
 //! Adds an empty scene node.
 ISceneNode* CSceneManager::addEmptySceneNode(ISceneNode* parent, s32 id)
 {
@@ -1195,6 +1381,13 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 		result = (Driver->getOcclusionQueryResult(const_cast<ISceneNode*>(node))==0);
 	}
 
+	// already tested by the culling stage of drawAll
+	if (!result && Culler && Culler->getResult(node, cam, result))
+	{
+		_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
+		return result;
+	}
+
 	// can be seen by a bounding box ?
 	if (!result && (node->getAutomaticCulling() & scene::EAC_BOX))
 	{
@@ -1325,6 +1518,37 @@ bool CSceneManager::isCulled(core::aabbox3d<f32> tbox, scene::E_CULLING_TYPE typ
 }
 
 
+//! Enables or disables a spatial index over the scene nodes.
+void CSceneManager::setSpatialIndexEnabled(bool enable, f32 cellSize)
+{
+	delete NodeGrid;
+	NodeGrid = 0;
+
+	if (enable)
+	{
+		NodeGrid = new CSceneNodeGrid(cellSize);
+		NodeGrid->update(this);
+	}
+
+	static_cast<CSceneCollisionManager*>(CollisionManager)->setNodeGrid(NodeGrid);
+}
+
+
+//! Returns if a spatial index over the scene nodes is kept.
+bool CSceneManager::isSpatialIndexEnabled() const
+{
+	return NodeGrid != 0;
+}
+
+
+//! Brings the spatial index up to date with the current absolute transformations of the nodes.
+void CSceneManager::updateSpatialIndex()
+{
+	if (NodeGrid)
+		NodeGrid->update(this);
+}
+
+
 //! registers a node for rendering it at a specific time.
 u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
 {
@@ -1367,23 +1591,11 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 		taken = 1;
 		break;
 	case ESNRP_SOLID:
-		if (!isCulled(node))
-		{
-			SolidNodeList.push_back(node);
-			taken = 1;
-		}
-		break;
 	case ESNRP_TRANSPARENT:
-		if (!isCulled(node))
-		{
-			TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
-			taken = 1;
-		}
-		break;
 	case ESNRP_TRANSPARENT_EFFECT:
 		if (!isCulled(node))
 		{
-			TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			RenderQueue.add(node, pass, camWorldPos);
 			taken = 1;
 		}
 		break;
@@ -1400,8 +1612,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 				if ((rnd && rnd->isTransparent()) || node->getMaterial(i).isTransparent())
 				{
 					// register as transparent node
-					TransparentNodeEntry e(node, camWorldPos);
-					TransparentNodeList.push_back(e);
+					RenderQueue.add(node, ESNRP_TRANSPARENT, camWorldPos);
 					taken = 1;
 					break;
 				}
@@ -1410,7 +1621,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 			// not transparent, register as solid
 			if (!taken)
 			{
-				SolidNodeList.push_back(node);
+				RenderQueue.add(node, ESNRP_SOLID, camWorldPos);
 				taken = 1;
 			}
 		}
@@ -1472,6 +1683,9 @@ void CSceneManager::drawAll()
 	// TODO: This should not use an attribute here but a real parameter when necessary (too slow!)
 	Driver->setAllowZWriteOnTransparent(Parameters->getAttributeAsBool(ALLOW_ZWRITE_ON_TRANSPARENT));
 
+	// create the requested meshes which were read in the background
+	MeshRequests->update();
+
 	// do animations and other stuff.
 	IRR_PROFILE(getProfiler().start(EPID_SM_ANIMATE));
 	OnAnimate(os::Timer::getTime());
@@ -1490,9 +1704,32 @@ void CSceneManager::drawAll()
 	}
 	IRR_PROFILE(getProfiler().stop(EPID_SM_RENDER_CAMERAS));
 
+	// skin the animated meshes of all nodes in view at once, culling needs their bounding boxes
+	IRR_PROFILE(getProfiler().start(EPID_SM_SKIN));
+	if (!AnimationStage)
+		AnimationStage = new CAnimationStage();
+	AnimationStage->update(this);
+	IRR_PROFILE(getProfiler().stop(EPID_SM_SKIN));
+
+	// test all nodes against the view frustum at once, isCulled looks up the results
+	IRR_PROFILE(getProfiler().start(EPID_SM_CULL));
+	if (!Culler)
+		Culler = new CSceneCuller();
+	if (NodeGrid)
+	{
+		// animation and skinning change bounding boxes without invalidating the nodes
+		invalidate();
+		NodeGrid->update(this);
+	}
+	Culler->cull(this, ActiveCamera, NodeGrid);
+	IRR_PROFILE(getProfiler().stop(EPID_SM_CULL));
+
 	// let all nodes register themselves
 	OnRegisterSceneNode();
 
+	// results are only valid until the nodes are changed again
+	Culler->clear();
+
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
 
@@ -1595,14 +1832,18 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_SOLID;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		SolidNodeList.sort(); // sort by textures
+		// sort the nodes of all passes by material state and distance
+		RenderQueue.sort();
+
+		u32 begin, end;
+		RenderQueue.getPassRange(CurrentRenderPass, begin, end);
 
 		if (LightManager)
 		{
 			LightManager->OnRenderPassPreRender(CurrentRenderPass);
-			for (i=0; i<SolidNodeList.size(); ++i)
+			for (i=begin; i<end; ++i)
 			{
-				ISceneNode* node = SolidNodeList[i].Node;
+				ISceneNode* node = RenderQueue.getNode(i);
 				LightManager->OnNodePreRender(node);
 				node->render();
 				LightManager->OnNodePostRender(node);
@@ -1610,14 +1851,13 @@ void CSceneManager::drawAll()
 		}
 		else
 		{
-			for (i=0; i<SolidNodeList.size(); ++i)
-				SolidNodeList[i].Node->render();
+			for (i=begin; i<end; ++i)
+				RenderQueue.getNode(i)->render();
 		}
 
 #ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters->setAttribute("drawn_solid", (s32) SolidNodeList.size() );
+		Parameters->setAttribute("drawn_solid", (s32) (end-begin) );
 #endif
-		SolidNodeList.set_used(0);
 
 		if (LightManager)
 			LightManager->OnRenderPassPostRender(CurrentRenderPass);
@@ -1662,14 +1902,17 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_TRANSPARENT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		TransparentNodeList.sort(); // sort by distance from camera
+		// sorted back to front
+		u32 begin, end;
+		RenderQueue.getPassRange(CurrentRenderPass, begin, end);
+
 		if (LightManager)
 		{
 			LightManager->OnRenderPassPreRender(CurrentRenderPass);
 
-			for (i=0; i<TransparentNodeList.size(); ++i)
+			for (i=begin; i<end; ++i)
 			{
-				ISceneNode* node = TransparentNodeList[i].Node;
+				ISceneNode* node = RenderQueue.getNode(i);
 				LightManager->OnNodePreRender(node);
 				node->render();
 				LightManager->OnNodePostRender(node);
@@ -1677,14 +1920,13 @@ void CSceneManager::drawAll()
 		}
 		else
 		{
-			for (i=0; i<TransparentNodeList.size(); ++i)
-				TransparentNodeList[i].Node->render();
+			for (i=begin; i<end; ++i)
+				RenderQueue.getNode(i)->render();
 		}
 
 #ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters->setAttribute ( "drawn_transparent", (s32) TransparentNodeList.size() );
+		Parameters->setAttribute ( "drawn_transparent", (s32) (end-begin) );
 #endif
-		TransparentNodeList.set_used(0);
 
 		if (LightManager)
 			LightManager->OnRenderPassPostRender(CurrentRenderPass);
@@ -1696,15 +1938,17 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_TRANSPARENT_EFFECT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		TransparentEffectNodeList.sort(); // sort by distance from camera
+		// sorted back to front
+		u32 begin, end;
+		RenderQueue.getPassRange(CurrentRenderPass, begin, end);
 
 		if (LightManager)
 		{
 			LightManager->OnRenderPassPreRender(CurrentRenderPass);
 
-			for (i=0; i<TransparentEffectNodeList.size(); ++i)
+			for (i=begin; i<end; ++i)
 			{
-				ISceneNode* node = TransparentEffectNodeList[i].Node;
+				ISceneNode* node = RenderQueue.getNode(i);
 				LightManager->OnNodePreRender(node);
 				node->render();
 				LightManager->OnNodePostRender(node);
@@ -1712,13 +1956,13 @@ void CSceneManager::drawAll()
 		}
 		else
 		{
-			for (i=0; i<TransparentEffectNodeList.size(); ++i)
-				TransparentEffectNodeList[i].Node->render();
+			for (i=begin; i<end; ++i)
+				RenderQueue.getNode(i)->render();
 		}
 #ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters->setAttribute("drawn_transparent_effect", (s32) TransparentEffectNodeList.size());
+		Parameters->setAttribute("drawn_transparent_effect", (s32) (end-begin));
 #endif
-		TransparentEffectNodeList.set_used(0);
+		RenderQueue.clear();
 	}
 
 	if (LightManager)
@@ -1848,6 +2092,9 @@ void CSceneManager::addExternalMeshLoader(IMeshLoader* externalLoader)
 		return;
 
 	externalLoader->grab();
+
+	// mesh requests go through the list on worker threads
+	CMutexLock lock(MeshLoaderMutex);
 	MeshLoaderList.push_back(externalLoader);
 }
 
@@ -1953,6 +2200,26 @@ ITriangleSelector* CSceneManager::createOctreeTriangleSelector(IMesh* mesh,
 }
 
 
+//! Creates a ITriangleSelector with a bounding volume hierarchy, based on a mesh.
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IMesh* mesh, ISceneNode* node)
+{
+	if (!mesh)
+		return 0;
+
+	return new CBVHTriangleSelector(mesh, node);
+}
+
+
+//! Creates a ITriangleSelector with a bounding volume hierarchy, refitted for the frames of an animated mesh scene node.
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IAnimatedMeshSceneNode* node)
+{
+	if (!node || !node->getMesh())
+		return 0;
+
+	return new CBVHTriangleSelector(node);
+}
+
+
 //! Creates a meta triangle selector.
 IMetaTriangleSelector* CSceneManager::createMetaTriangleSelector()
 {
@@ -13,6 +13,8 @@
 #include "IMeshLoader.h"
 #include "CAttributes.h"
 #include "ILightManager.h"
+#include "CRenderQueue.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -20,12 +22,16 @@ namespace io
 {
 	class IXMLWriter;
 	class IFileSystem;
+	class CAssetLoader;
 }
 namespace scene
 {
 	class IMeshCache;
 	class IGeometryCreator;
 	class IInstancedMeshSceneNode;
+	class CSceneCuller;
+	class CSceneNodeGrid;
+	class CAnimationStage;
 
 	/*!
 		The Scene Manager manages scene nodes, mesh recources, cameras and all the other stuff.
@@ -48,6 +54,21 @@ namespace scene
 		//! gets an animateable mesh. loads it if needed. returned pointer must not be dropped.
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+		//! loads a mesh in the background
+		virtual io::IAssetRequest* requestMesh(const io::path& filename) _IRR_OVERRIDE_;
+
+		//! Set the time drawAll() may spend creating requested meshes
+		virtual void setMeshLoadBudget(u32 milliseconds) _IRR_OVERRIDE_;
+
+		//! loads a mesh with the mesh loaders and adds it to the mesh cache under the given name
+		IAnimatedMesh* loadMesh(io::IReadFile* file, const io::path& name);
+
+		//! creates a mesh on a worker thread with the loaders which allow it, without adding it to the mesh cache
+		/** \param textureLoader Used by the loaders instead of their own texture loaders.
+		\param supported Set to false if loadMesh has to load the file on the main thread. */
+		IAnimatedMesh* createMeshOnWorker(io::IReadFile* file, const io::path& name,
+			IMeshTextureLoader* textureLoader, bool& supported);
+
 		//! Returns an interface to the mesh cache which is shared beween all existing scene managers.
 		virtual IMeshCache* getMeshCache() _IRR_OVERRIDE_;
 
@@ -263,6 +284,14 @@ namespace scene
 			s32 maxLOD=4, E_TERRAIN_PATCH_SIZE patchSize=ETPS_17,s32 smoothFactor=0,
 			bool addAlsoIfHeightmapEmpty=false) _IRR_OVERRIDE_;
 
+		//! Adds a paged terrain scene node to the scene graph.
+		virtual IPagedTerrainSceneNode* addPagedTerrainSceneNode(
+			const SPagedTerrainParameters& parameters,
+			ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0.0f,0.0f,0.0f),
+			const core::vector3df& rotation = core::vector3df(0.0f,0.0f,0.0f),
+			const core::vector3df& scale = core::vector3df(1.0f,1.0f,1.0f)) _IRR_OVERRIDE_;
+
 		//! Adds a dummy transformation scene node to the scene graph.
 		virtual IDummyTransformationSceneNode* addDummyTransformationSceneNode(
 			ISceneNode* parent=0, s32 id=-1) _IRR_OVERRIDE_;
@@ -352,6 +381,13 @@ namespace scene
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMesh* mesh,
 			ISceneNode* node, s32 minimalPolysPerNode) _IRR_OVERRIDE_;
 
+		//! Creates a ITriangleSelector with a bounding volume hierarchy, based on a mesh.
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node) _IRR_OVERRIDE_;
+
+		//! Creates a ITriangleSelector with a bounding volume hierarchy, refitted for the frames of an animated mesh scene node.
+		virtual ITriangleSelector* createBVHTriangleSelector(IAnimatedMeshSceneNode* node) _IRR_OVERRIDE_;
+
 		//! Creates a simple dynamic ITriangleSelector, based on a axis aligned bounding box.
 		virtual ITriangleSelector* createTriangleSelectorFromBoundingBox(
 			ISceneNode* node) _IRR_OVERRIDE_;
@@ -521,6 +557,15 @@ namespace scene
 		//! returns if this is culled
 		virtual bool isCulled(core::aabbox3d<f32> tbox, scene::E_CULLING_TYPE type, const core::matrix4& absoluteTransformation) const;
 
+		//! Enables or disables a spatial index over the scene nodes.
+		virtual void setSpatialIndexEnabled(bool enable, f32 cellSize=100.f) _IRR_OVERRIDE_;
+
+		//! Returns if a spatial index over the scene nodes is kept.
+		virtual bool isSpatialIndexEnabled() const _IRR_OVERRIDE_;
+
+		//! Brings the spatial index up to date with the current absolute transformations of the nodes.
+		virtual void updateSpatialIndex() _IRR_OVERRIDE_;
+
 	protected:
 
 		//! Adds a scene node for rendering using a octree to the scene graph. This a good method for rendering
@@ -537,44 +582,6 @@ namespace scene
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
 
-		struct DefaultNodeEntry
-		{
-			DefaultNodeEntry(ISceneNode* n) :
-				Node(n), TextureValue(0)
-			{
-				if (n->getMaterialCount())
-					TextureValue = (n->getMaterial(0).getTexture(0));
-			}
-
-			bool operator < (const DefaultNodeEntry& other) const
-			{
-				return (TextureValue < other.TextureValue);
-			}
-
-			ISceneNode* Node;
-			private:
-			void* TextureValue;
-		};
-
-		//! sort on distance (center) to camera
-		struct TransparentNodeEntry
-		{
-			TransparentNodeEntry(ISceneNode* n, const core::vector3df& camera)
-				: Node(n)
-			{
-				Distance = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
-			}
-
-			bool operator < (const TransparentNodeEntry& other) const
-			{
-				return Distance > other.Distance;
-			}
-
-			ISceneNode* Node;
-			private:
-				f64 Distance;
-		};
-
 		//! sort on distance (sphere) to camera
 		struct DistanceNodeEntry
 		{
@@ -621,9 +628,7 @@ namespace scene
 		core::array<ISceneNode*> LightList;
 		core::array<ISceneNode*> ShadowNodeList;
 		core::array<ISceneNode*> SkyBoxList;
-		core::array<DefaultNodeEntry> SolidNodeList;
-		core::array<TransparentNodeEntry> TransparentNodeList;
-		core::array<TransparentNodeEntry> TransparentEffectNodeList;
+		CRenderQueue RenderQueue;
 
 		core::array<IMeshLoader*> MeshLoaderList;
 		core::array<ISceneLoader*> SceneLoaderList;
@@ -651,6 +656,21 @@ namespace scene
 		//! over the scene lighting and rendering.
 		ILightManager* LightManager;
 
+		//! culls all nodes before they are registered for rendering
+		CSceneCuller* Culler;
+
+		//! optional spatial index over the visible nodes
+		CSceneNodeGrid* NodeGrid;
+
+		//! skins the animated mesh scene nodes after they were animated
+		CAnimationStage* AnimationStage;
+
+		//! reads the files of requested meshes in the background
+		io::CAssetLoader* MeshRequests;
+
+		//! guards the mesh loader list and the loaders which also run on worker threads
+		CMutex MeshLoaderMutex;
+
 		//! constants for reading and writing XML.
 		//! Not made static due to portability problems.
 		const core::stringw IRR_XML_FORMAT_SCENE;
@@ -0,0 +1,460 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeGrid.h"
+
+namespace irr
+{
+namespace scene
+{
+
+// cells reach this fraction of their size further than needed, for rounding errors of the boxes
+static const f32 CELL_SLACK = 0.01f;
+
+// cell coordinates must stay small enough to calculate the bounds precisely
+static const f32 MAX_COORDINATE = 100000.f;
+
+
+static inline u32 hashNode(const ISceneNode* node)
+{
+	return (u32)(((size_t)node >> 4) * 2654435761u);
+}
+
+
+static inline u32 hashCell(u32 level, s32 x, s32 y, s32 z)
+{
+	return ((u32)x * 73856093u) ^ ((u32)y * 19349663u) ^ ((u32)z * 83492791u) ^ (level * 2654435761u);
+}
+
+
+//! Constructor
+CSceneNodeGrid::CSceneNodeGrid(f32 cellSize)
+: CellSize(cellSize > 0.f ? cellSize : 1.f), EmptyCells(0), Stamp(0),
+	SyncedRoot(0), SyncedChangedID(0)
+{
+}
+
+
+//! Destructor
+CSceneNodeGrid::~CSceneNodeGrid()
+{
+	clear();
+}
+
+
+void CSceneNodeGrid::clear()
+{
+	for (u32 i=0; i<Entries.size(); ++i)
+		Entries[i].Node->drop();
+
+	Entries.clear();
+	Cells.clear();
+	for (u32 i=0; i<=LEVEL_COUNT; ++i)
+		LevelCells[i].clear();
+	CellSlots.clear();
+	NodeSlots.clear();
+	EmptyCells = 0;
+
+	for (u32 i=0; i<HiddenNodes.size(); ++i)
+		HiddenNodes[i]->drop();
+	HiddenNodes.clear();
+
+	SyncedRoot = 0;
+}
+
+
+void CSceneNodeGrid::update(ISceneNode* root)
+{
+	// nothing below root was added, removed, moved or hidden since the last walk
+	if (root && root == SyncedRoot && root->getChangedID() == SyncedChangedID)
+		return;
+
+	SyncedRoot = root;
+	SyncedChangedID = root ? root->getChangedID() : 0;
+
+	++Stamp;
+	NewHiddenNodes.set_used(0);
+	if (root)
+		collect(root);
+	sweep();
+
+	// grab the new hidden nodes first, so the ones which stay hidden don't get deleted
+	for (u32 i=0; i<NewHiddenNodes.size(); ++i)
+		NewHiddenNodes[i]->grab();
+	for (u32 i=0; i<HiddenNodes.size(); ++i)
+		HiddenNodes[i]->drop();
+	HiddenNodes.swap(NewHiddenNodes);
+	NewHiddenNodes.set_used(0);
+
+	// cells are only removed all at once, when most of them are empty
+	if (EmptyCells > 64 && EmptyCells * 2 > Cells.size())
+		rebuildCells();
+}
+
+
+//! visits the nodes ISceneNode::OnRegisterSceneNode would visit
+void CSceneNodeGrid::collect(ISceneNode* node)
+{
+	const ISceneNodeList& children = node->getChildren();
+	ISceneNodeList::ConstIterator it = children.begin();
+	for (; it != children.end(); ++it)
+	{
+		ISceneNode* child = *it;
+		if (!child->isVisible())
+		{
+			NewHiddenNodes.push_back(child);
+			continue;
+		}
+
+		touch(child);
+		collect(child);
+	}
+}
+
+
+//! adds a node or moves it if it changed
+void CSceneNodeGrid::touch(ISceneNode* node)
+{
+	const s32 index = findNode(node);
+	if (index >= 0)
+	{
+		SEntry& entry = Entries[index];
+		entry.Stamp = Stamp;
+
+		if (entry.Box == node->getBoundingBox() &&
+			!(entry.Transformation != node->getAbsoluteTransformation()))
+			return;
+
+		entry.Transformation = node->getAbsoluteTransformation();
+		entry.Box = node->getBoundingBox();
+		entry.WorldBox = entry.Box;
+		entry.Transformation.transformBoxEx(entry.WorldBox);
+
+		const u32 cell = getCellForBox(entry.WorldBox);
+		if (cell != entry.Cell)
+		{
+			unlink(index);
+			link(index, cell);
+		}
+		return;
+	}
+
+	node->grab();
+
+	SEntry entry;
+	entry.Node = node;
+	entry.Transformation = node->getAbsoluteTransformation();
+	entry.Box = node->getBoundingBox();
+	entry.WorldBox = entry.Box;
+	entry.Transformation.transformBoxEx(entry.WorldBox);
+	entry.Stamp = Stamp;
+	Entries.push_back(entry);
+
+	const u32 added = Entries.size() - 1;
+	link(added, getCellForBox(Entries[added].WorldBox));
+	insertNode(added);
+}
+
+
+//! removes the nodes which weren't visited by the last update
+void CSceneNodeGrid::sweep()
+{
+	bool removed = false;
+
+	u32 i = 0;
+	while (i < Entries.size())
+	{
+		if (Entries[i].Stamp == Stamp)
+		{
+			++i;
+			continue;
+		}
+
+		unlink(i);
+		Entries[i].Node->drop();
+
+		// move the last entry into the gap and fix the links to it
+		const u32 last = Entries.size() - 1;
+		if (i != last)
+		{
+			Entries[i] = Entries[last];
+			const SEntry& moved = Entries[i];
+			if (moved.Previous >= 0)
+				Entries[moved.Previous].Next = i;
+			else
+				Cells[moved.Cell].First = i;
+			if (moved.Next >= 0)
+				Entries[moved.Next].Previous = i;
+		}
+		Entries.set_used(last);
+		removed = true;
+	}
+
+	if (removed)
+		rebuildNodeSlots();
+}
+
+
+u32 CSceneNodeGrid::getCellForBox(const core::aabbox3d<f32>& box)
+{
+	const core::vector3df extent = box.getExtent();
+	const f32 size = core::max_(extent.X, extent.Y, extent.Z);
+	const core::vector3df center = box.getCenter();
+
+	// the comparisons are false for NaN, which ends up in the cell for too big nodes
+	u32 level = 0;
+	f32 cellSize = CellSize;
+	s32 x = 0, y = 0, z = 0;
+	for (; level < LEVEL_COUNT; ++level, cellSize *= 2.f)
+	{
+		const core::vector3df position = center / cellSize;
+		if (size <= cellSize && core::abs_(position.X) < MAX_COORDINATE &&
+			core::abs_(position.Y) < MAX_COORDINATE && core::abs_(position.Z) < MAX_COORDINATE)
+		{
+			x = (s32)floorf(position.X);
+			y = (s32)floorf(position.Y);
+			z = (s32)floorf(position.Z);
+			break;
+		}
+	}
+
+	const s32 index = findCell(level, x, y, z);
+	if (index >= 0)
+		return (u32)index;
+
+	SCell cell;
+	cell.X = x;
+	cell.Y = y;
+	cell.Z = z;
+	cell.Level = level;
+	cell.First = -1;
+	cell.Count = 0;
+	if (level < LEVEL_COUNT)
+	{
+		const f32 loose = cellSize * (0.5f + CELL_SLACK);
+		cell.Bounds.MinEdge.set(x * cellSize - loose, y * cellSize - loose, z * cellSize - loose);
+		cell.Bounds.MaxEdge.set((x+1) * cellSize + loose, (y+1) * cellSize + loose, (z+1) * cellSize + loose);
+	}
+	else
+	{
+		cell.Bounds.MinEdge.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		cell.Bounds.MaxEdge.set(FLT_MAX, FLT_MAX, FLT_MAX);
+	}
+
+	Cells.push_back(cell);
+	const u32 added = Cells.size() - 1;
+	LevelCells[level].push_back(added);
+	++EmptyCells;
+
+	// hash with a load of at most one half
+	if (Cells.size() * 2 > CellSlots.size())
+	{
+		u32 slotCount = 16;
+		while (slotCount < Cells.size() * 4)
+			slotCount <<= 1;
+		CellSlots.set_used(slotCount);
+		memset(CellSlots.pointer(), 0, slotCount * sizeof(u32));
+		for (u32 i=0; i<Cells.size(); ++i)
+		{
+			const SCell& c = Cells[i];
+			u32 slot = hashCell(c.Level, c.X, c.Y, c.Z) & (slotCount - 1);
+			while (CellSlots[slot])
+				slot = (slot + 1) & (slotCount - 1);
+			CellSlots[slot] = i + 1;
+		}
+	}
+	else
+	{
+		const u32 mask = CellSlots.size() - 1;
+		u32 slot = hashCell(level, x, y, z) & mask;
+		while (CellSlots[slot])
+			slot = (slot + 1) & mask;
+		CellSlots[slot] = added + 1;
+	}
+
+	return added;
+}
+
+
+s32 CSceneNodeGrid::findCell(u32 level, s32 x, s32 y, s32 z) const
+{
+	if (CellSlots.empty())
+		return -1;
+
+	const u32 mask = CellSlots.size() - 1;
+	u32 slot = hashCell(level, x, y, z) & mask;
+	while (CellSlots[slot])
+	{
+		const SCell& cell = Cells[CellSlots[slot]-1];
+		if (cell.X == x && cell.Y == y && cell.Z == z && cell.Level == level)
+			return (s32)CellSlots[slot]-1;
+		slot = (slot + 1) & mask;
+	}
+	return -1;
+}
+
+
+void CSceneNodeGrid::getCells(const core::aabbox3d<f32>& box, core::array<u32>& outCells) const
+{
+	outCells.set_used(0);
+
+	f32 cellSize = CellSize;
+	for (u32 level=0; level<LEVEL_COUNT; ++level, cellSize *= 2.f)
+	{
+		const core::array<u32>& cells = LevelCells[level];
+		if (cells.empty())
+			continue;
+
+		// range of the cells which can reach the box
+		const f32 minX = floorf(box.MinEdge.X / cellSize - 0.5f - CELL_SLACK) - 1.f;
+		const f32 minY = floorf(box.MinEdge.Y / cellSize - 0.5f - CELL_SLACK) - 1.f;
+		const f32 minZ = floorf(box.MinEdge.Z / cellSize - 0.5f - CELL_SLACK) - 1.f;
+		const f32 maxX = floorf(box.MaxEdge.X / cellSize + 0.5f + CELL_SLACK);
+		const f32 maxY = floorf(box.MaxEdge.Y / cellSize + 0.5f + CELL_SLACK);
+		const f32 maxZ = floorf(box.MaxEdge.Z / cellSize + 0.5f + CELL_SLACK);
+		const f32 volume = (maxX - minX + 1.f) * (maxY - minY + 1.f) * (maxZ - minZ + 1.f);
+
+		// look up the cells of small boxes, test all cells of the level for big ones
+		if (volume <= (f32)cells.size() &&
+			core::abs_(minX) < MAX_COORDINATE * 2.f && core::abs_(maxX) < MAX_COORDINATE * 2.f &&
+			core::abs_(minY) < MAX_COORDINATE * 2.f && core::abs_(maxY) < MAX_COORDINATE * 2.f &&
+			core::abs_(minZ) < MAX_COORDINATE * 2.f && core::abs_(maxZ) < MAX_COORDINATE * 2.f)
+		{
+			for (s32 z=(s32)minZ; z<=(s32)maxZ; ++z)
+			{
+				for (s32 y=(s32)minY; y<=(s32)maxY; ++y)
+				{
+					for (s32 x=(s32)minX; x<=(s32)maxX; ++x)
+					{
+						const s32 index = findCell(level, x, y, z);
+						if (index >= 0 && Cells[index].Count && Cells[index].Bounds.intersectsWithBox(box))
+							outCells.push_back((u32)index);
+					}
+				}
+			}
+		}
+		else
+		{
+			for (u32 i=0; i<cells.size(); ++i)
+			{
+				const SCell& cell = Cells[cells[i]];
+				if (cell.Count && cell.Bounds.intersectsWithBox(box))
+					outCells.push_back(cells[i]);
+			}
+		}
+	}
+
+	// the nodes which are too big for the grid are part of every query
+	const core::array<u32>& cells = LevelCells[LEVEL_COUNT];
+	for (u32 i=0; i<cells.size(); ++i)
+	{
+		if (Cells[cells[i]].Count)
+			outCells.push_back(cells[i]);
+	}
+}
+
+
+void CSceneNodeGrid::link(u32 entry, u32 cell)
+{
+	SEntry& e = Entries[entry];
+	SCell& c = Cells[cell];
+
+	e.Cell = cell;
+	e.Previous = -1;
+	e.Next = c.First;
+	if (c.First >= 0)
+		Entries[c.First].Previous = (s32)entry;
+	c.First = (s32)entry;
+
+	if (!c.Count++)
+		--EmptyCells;
+}
+
+
+void CSceneNodeGrid::unlink(u32 entry)
+{
+	const SEntry& e = Entries[entry];
+	SCell& c = Cells[e.Cell];
+
+	if (e.Previous >= 0)
+		Entries[e.Previous].Next = e.Next;
+	else
+		c.First = e.Next;
+	if (e.Next >= 0)
+		Entries[e.Next].Previous = e.Previous;
+
+	if (!--c.Count)
+		++EmptyCells;
+}
+
+
+void CSceneNodeGrid::rebuildCells()
+{
+	Cells.set_used(0);
+	for (u32 i=0; i<=LEVEL_COUNT; ++i)
+		LevelCells[i].set_used(0);
+	CellSlots.set_used(0);
+	EmptyCells = 0;
+
+	for (u32 i=0; i<Entries.size(); ++i)
+		link(i, getCellForBox(Entries[i].WorldBox));
+}
+
+
+s32 CSceneNodeGrid::findNode(const ISceneNode* node) const
+{
+	if (NodeSlots.empty())
+		return -1;
+
+	const u32 mask = NodeSlots.size() - 1;
+	u32 slot = hashNode(node) & mask;
+	while (NodeSlots[slot])
+	{
+		if (Entries[NodeSlots[slot]-1].Node == node)
+			return (s32)NodeSlots[slot]-1;
+		slot = (slot + 1) & mask;
+	}
+	return -1;
+}
+
+
+void CSceneNodeGrid::insertNode(u32 entry)
+{
+	// hash with a load of at most one half
+	if (Entries.size() * 2 > NodeSlots.size())
+	{
+		rebuildNodeSlots();
+		return;
+	}
+
+	const u32 mask = NodeSlots.size() - 1;
+	u32 slot = hashNode(Entries[entry].Node) & mask;
+	while (NodeSlots[slot])
+		slot = (slot + 1) & mask;
+	NodeSlots[slot] = entry + 1;
+}
+
+
+void CSceneNodeGrid::rebuildNodeSlots()
+{
+	u32 slotCount = 16;
+	while (slotCount < Entries.size() * 4)
+		slotCount <<= 1;
+	NodeSlots.set_used(slotCount);
+	memset(NodeSlots.pointer(), 0, slotCount * sizeof(u32));
+
+	const u32 mask = slotCount - 1;
+	for (u32 i=0; i<Entries.size(); ++i)
+	{
+		u32 slot = hashNode(Entries[i].Node) & mask;
+		while (NodeSlots[slot])
+			slot = (slot + 1) & mask;
+		NodeSlots[slot] = i + 1;
+	}
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,143 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_GRID_H_INCLUDED__
+#define __C_SCENE_NODE_GRID_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Spatial index over the world space bounding boxes of the visible scene nodes.
+	/** A loose grid with a level for each power of two of the cell size, stored in a hash
+	table so only occupied cells cost memory. A node is put into the cell of its box center on
+	the level where the cells are at least as big as the box, so its box never reaches further
+	than half a cell out of the cell. Nodes which are too big or too far away for all levels
+	are kept in an extra cell which is part of every query.
+	update() walks the scene graph like CSceneCuller, but only recalculates the boxes of nodes
+	whose transformation or bounding box changed and only moves them if they left their cell.
+	It returns at once when the changed id of the root didn't move since the last walk.
+	The nodes are grabbed, so a removed node stays valid until the next update. The topmost
+	invisible nodes are remembered as well, for queries which look into invisible subtrees. */
+	class CSceneNodeGrid
+	{
+	public:
+
+		//! Number of levels, the cells of the highest level are 2^(LEVEL_COUNT-1) times the cell size
+		static const u32 LEVEL_COUNT = 20;
+
+		//! A node in the grid
+		struct SEntry
+		{
+			ISceneNode* Node;
+			//! transformation and bounding box when the node was last updated
+			core::matrix4 Transformation;
+			core::aabbox3d<f32> Box;
+			//! the box transformed like ISceneNode::getTransformedBoundingBox does it
+			core::aabbox3d<f32> WorldBox;
+			u32 Cell;
+			//! neighbours in the list of the cell, -1 for none
+			s32 Previous;
+			s32 Next;
+			u32 Stamp;
+		};
+
+		//! A cell of the grid
+		struct SCell
+		{
+			//! area which the boxes of the nodes in the cell can reach
+			core::aabbox3d<f32> Bounds;
+			s32 X, Y, Z;
+			u32 Level;
+			//! first entry in the cell, -1 for none
+			s32 First;
+			u32 Count;
+		};
+
+		//! Constructor
+		/** \param cellSize Size of the cells of the lowest level. */
+		CSceneNodeGrid(f32 cellSize);
+
+		//! Destructor, drops all nodes
+		~CSceneNodeGrid();
+
+		//! Brings the grid up to date with the visible nodes below root.
+		/** Does nothing when root is unchanged since the last update, see ISceneNode::getChangedID(). */
+		void update(ISceneNode* root);
+
+		//! Removes all nodes.
+		void clear();
+
+		//! Collects the occupied cells whose bounds intersect with a box.
+		void getCells(const core::aabbox3d<f32>& box, core::array<u32>& outCells) const;
+
+		//! Returns the number of cells, including empty ones.
+		u32 getCellCount() const { return Cells.size(); }
+
+		//! Returns a cell.
+		const SCell& getCell(u32 index) const { return Cells[index]; }
+
+		//! Returns an entry.
+		const SEntry& getEntry(u32 index) const { return Entries[index]; }
+
+		//! Returns the number of nodes in the grid.
+		u32 getEntryCount() const { return Entries.size(); }
+
+		//! Returns the size of the cells of the lowest level.
+		f32 getCellSize() const { return CellSize; }
+
+		//! Returns the number of invisible nodes with visible parents found by the last update.
+		u32 getHiddenNodeCount() const { return HiddenNodes.size(); }
+
+		//! Returns an invisible node with visible parents, its children are not in the grid.
+		ISceneNode* getHiddenNode(u32 index) const { return HiddenNodes[index]; }
+
+	private:
+
+		void collect(ISceneNode* node);
+		void touch(ISceneNode* node);
+		void sweep();
+
+		//! finds the cell for a world space box, creates it if needed
+		u32 getCellForBox(const core::aabbox3d<f32>& box);
+		s32 findCell(u32 level, s32 x, s32 y, s32 z) const;
+
+		void link(u32 entry, u32 cell);
+		void unlink(u32 entry);
+		void rebuildCells();
+
+		s32 findNode(const ISceneNode* node) const;
+		void insertNode(u32 entry);
+		void rebuildNodeSlots();
+
+		core::array<SEntry> Entries;
+		core::array<SCell> Cells;
+		//! indices of the cells of each level, the last one is the cell for too big nodes
+		core::array<u32> LevelCells[LEVEL_COUNT+1];
+
+		//! open addressing hashes to index+1, 0 is an empty slot
+		core::array<u32> CellSlots;
+		core::array<u32> NodeSlots;
+
+		//! grabbed like the nodes of the entries
+		core::array<ISceneNode*> HiddenNodes;
+		core::array<ISceneNode*> NewHiddenNodes;
+
+		f32 CellSize;
+		u32 EmptyCells;
+		u32 Stamp;
+
+		//! root and its changed id of the last walk over the scene graph
+		const ISceneNode* SyncedRoot;
+		u32 SyncedChangedID;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
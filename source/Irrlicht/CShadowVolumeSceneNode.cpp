@@ -16,13 +16,53 @@ namespace irr
 namespace scene
 {
 
+//! number of faces in each part the thread pool works on
+static const u32 SHADOW_PART_SIZE = 8192;
+
+//! marks an edge which belongs to only one face
+static const u32 NO_FACE = 0xFFFFFFFF;
+
+
+// the low bits of floats with few digits are all zero, mix in the high bits
+static inline u32 mixBits(u32 v)
+{
+	v ^= v >> 16;
+	v *= 0x7feb352du;
+	v ^= v >> 15;
+	v *= 0x846ca68bu;
+	v ^= v >> 16;
+	return v;
+}
+
+
+static inline u32 hashPosition(const core::vector3df& pos)
+{
+	return (mixBits(IR(pos.X)) * 73856093u) ^ (mixBits(IR(pos.Y)) * 19349663u) ^ (mixBits(IR(pos.Z)) * 83492791u);
+}
+
+
+static inline u32 hashEdge(u32 a, u32 b)
+{
+	return (a * 73856093u) ^ (b * 19349663u);
+}
+
+namespace
+{
+	//! an edge between two positions, with the first two faces using it
+	struct SShadowEdge
+	{
+		u32 A, B;
+		u32 Face0, Face1;
+	};
+}
+
 
 //! constructor
 CShadowVolumeSceneNode::CShadowVolumeSceneNode(const IMesh* shadowMesh, ISceneNode* parent,
 		ISceneManager* mgr, s32 id, bool zfailmethod, f32 infinity)
 : IShadowVolumeSceneNode(parent, mgr, id),
 	ShadowMesh(0), IndexCount(0), VertexCount(0), ShadowVolumesUsed(0),
-	Infinity(infinity), UseZFailMethod(zfailmethod)
+	Infinity(infinity), LightMoveThreshold(0.f), ShadowVolumesValid(0), UseZFailMethod(zfailmethod)
 {
 	#ifdef _DEBUG
 	setDebugName("CShadowVolumeSceneNode");
@@ -49,6 +89,15 @@ void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bo
 
 	if (ShadowVolumes.size() > ShadowVolumesUsed)
 	{
+		// keep the shadow volume while the mesh is the same and the light
+		// did not move too far
+		if (ShadowVolumesUsed < ShadowVolumesValid &&
+			ShadowLights[ShadowVolumesUsed].getDistanceFrom(light) <= LightMoveThreshold)
+		{
+			++ShadowVolumesUsed;
+			return;
+		}
+
 		// get the next unused buffer
 
 		svp = &ShadowVolumes[ShadowVolumesUsed];
@@ -63,36 +112,65 @@ void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bo
 
 		ShadowBBox.push_back(core::aabbox3d<f32>());
 		bb = &ShadowBBox.getLast();
+
+		ShadowLights.push_back(light);
 	}
-	svp->reallocate(IndexCount*5);
+	ShadowLights[ShadowVolumesUsed] = light;
 	++ShadowVolumesUsed;
+	ShadowVolumesValid = core::max_(ShadowVolumesValid, ShadowVolumesUsed);
 
-	// We use triangle lists
-	Edges.set_used(IndexCount*2);
-	u32 numEdges = 0;
+	Light = light;
+
+	// the faces are classified before the edges, as the edges depend on
+	// the adjacent faces in other parts
+	const u32 faceCount = IndexCount / 3;
+	const u32 parts = (faceCount + SHADOW_PART_SIZE - 1) / SHADOW_PART_SIZE;
 
-	numEdges=createEdgesAndCaps(light, svp, bb);
+	while (Parts.size() < parts)
+		Parts.push_back(SShadowPart());
 
-	// for all edges add the near->far quads
-	for (u32 i=0; i<numEdges; ++i)
+	if (parts > 1)
 	{
-		const core::vector3df &v1 = Vertices[Edges[2*i+0]];
-		const core::vector3df &v2 = Vertices[Edges[2*i+1]];
-		const core::vector3df v3(v1+(v1 - light).normalize()*Infinity);
-		const core::vector3df v4(v2+(v2 - light).normalize()*Infinity);
-
-		// Add a quad (two triangles) to the vertex list
-#ifdef _DEBUG
-		if (svp->size() >= svp->allocated_size()-5)
-			os::Printer::log("Allocation too small.", ELL_DEBUG);
-#endif
-		svp->push_back(v1);
-		svp->push_back(v2);
-		svp->push_back(v3);
+		CShadowJob caps(this, false);
+		CThreadPool::getSharedPool()->run(&caps, parts);
 
-		svp->push_back(v2);
-		svp->push_back(v4);
-		svp->push_back(v3);
+		CShadowJob edges(this, true);
+		CThreadPool::getSharedPool()->run(&edges, parts);
+	}
+	else if (parts)
+	{
+		createCaps(0);
+		createEdges(0);
+	}
+
+	if (faceCount >= 1)
+		bb->reset(Vertices[Indices[0]]);
+	else
+		bb->reset(0,0,0);
+
+	// first the caps of all faces, then the near->far quads of all edges
+	u32 size = 0;
+	for (u32 p=0; p<parts; ++p)
+		size += Parts[p].Caps.size() + Parts[p].Quads.size();
+	svp->reallocate(size);
+
+	for (u32 p=0; p<parts; ++p)
+	{
+		const SShadowPart& part = Parts[p];
+
+		for (u32 i=0; i<part.Caps.size(); ++i)
+			svp->push_back(part.Caps[i]);
+
+		if (part.HasBox)
+			bb->addInternalBox(part.Box);
+	}
+
+	for (u32 p=0; p<parts; ++p)
+	{
+		const SShadowPart& part = Parts[p];
+
+		for (u32 i=0; i<part.Quads.size(); ++i)
+			svp->push_back(part.Quads[i]);
 	}
 }
 
@@ -100,104 +178,106 @@ void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bo
 #define IRR_USE_ADJACENCY
 #define IRR_USE_REVERSE_EXTRUDED
 
-u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
-					SShadowVolume* svp, core::aabbox3d<f32>* bb)
+void CShadowVolumeSceneNode::createCaps(u32 p)
 {
-	u32 numEdges=0;
-	const u32 faceCount = IndexCount / 3;
+	SShadowPart& part = Parts[p];
+	part.Caps.set_used(0);
+	part.HasBox = false;
 
-	if(faceCount >= 1)
-		bb->reset(Vertices[Indices[0]]);
-	else
-		bb->reset(0,0,0);
+	const u32 first = p * SHADOW_PART_SIZE;
+	const u32 end = core::min_(first + SHADOW_PART_SIZE, IndexCount / 3);
 
 	// Check every face if it is front or back facing the light.
-	for (u32 i=0; i<faceCount; ++i)
+	for (u32 i=first; i<end; ++i)
 	{
 		const core::vector3df v0 = Vertices[Indices[3*i+0]];
 		const core::vector3df v1 = Vertices[Indices[3*i+1]];
 		const core::vector3df v2 = Vertices[Indices[3*i+2]];
 
 #ifdef IRR_USE_REVERSE_EXTRUDED
-		FaceData[i]=core::triangle3df(v0,v1,v2).isFrontFacing(light);
+		FaceData[i]=core::triangle3df(v0,v1,v2).isFrontFacing(Light);
 #else
-		FaceData[i]=core::triangle3df(v2,v1,v0).isFrontFacing(light);
+		FaceData[i]=core::triangle3df(v2,v1,v0).isFrontFacing(Light);
 #endif
 
 		if (UseZFailMethod && FaceData[i])
 		{
-#ifdef _DEBUG
-			if (svp->size() >= svp->allocated_size()-5)
-				os::Printer::log("Allocation too small.", ELL_DEBUG);
-#endif
 			// add front cap from light-facing faces
-			svp->push_back(v2);
-			svp->push_back(v1);
-			svp->push_back(v0);
+			part.Caps.push_back(v2);
+			part.Caps.push_back(v1);
+			part.Caps.push_back(v0);
 
 			// add back cap
-			const core::vector3df i0 = v0+(v0-light).normalize()*Infinity;
-			const core::vector3df i1 = v1+(v1-light).normalize()*Infinity;
-			const core::vector3df i2 = v2+(v2-light).normalize()*Infinity;
+			const core::vector3df i0 = v0+(v0-Light).normalize()*Infinity;
+			const core::vector3df i1 = v1+(v1-Light).normalize()*Infinity;
+			const core::vector3df i2 = v2+(v2-Light).normalize()*Infinity;
 
-			svp->push_back(i0);
-			svp->push_back(i1);
-			svp->push_back(i2);
+			part.Caps.push_back(i0);
+			part.Caps.push_back(i1);
+			part.Caps.push_back(i2);
 
-			bb->addInternalPoint(i0);
-			bb->addInternalPoint(i1);
-			bb->addInternalPoint(i2);
+			if (!part.HasBox)
+			{
+				part.Box.reset(i0);
+				part.HasBox = true;
+			}
+			else
+				part.Box.addInternalPoint(i0);
+			part.Box.addInternalPoint(i1);
+			part.Box.addInternalPoint(i2);
 		}
 	}
+}
+
+
+void CShadowVolumeSceneNode::createEdges(u32 p)
+{
+	SShadowPart& part = Parts[p];
+	part.Quads.set_used(0);
+
+	const u32 first = p * SHADOW_PART_SIZE;
+	const u32 end = core::min_(first + SHADOW_PART_SIZE, IndexCount / 3);
 
-	// Create edges
-	for (u32 i=0; i<faceCount; ++i)
+	for (u32 i=first; i<end; ++i)
 	{
 		// check all front facing faces
-		if (FaceData[i] == true)
-		{
-			const u16 wFace0 = Indices[3*i+0];
-			const u16 wFace1 = Indices[3*i+1];
-			const u16 wFace2 = Indices[3*i+2];
-
-			const u16 adj0 = Adjacency[3*i+0];
-			const u16 adj1 = Adjacency[3*i+1];
-			const u16 adj2 = Adjacency[3*i+2];
+		if (FaceData[i] == false)
+			continue;
 
+		for (u32 edge=0; edge<3; ++edge)
+		{
 			// add edges if face is adjacent to back-facing face
 			// or if no adjacent face was found
 #ifdef IRR_USE_ADJACENCY
-			if (adj0 == i || FaceData[adj0] == false)
+			const u32 adj = Adjacency[3*i+edge];
+			if (adj != i && FaceData[adj] == true)
+				continue;
 #endif
-			{
-				// add edge v0-v1
-				Edges[2*numEdges+0] = wFace0;
-				Edges[2*numEdges+1] = wFace1;
-				++numEdges;
-			}
 
-#ifdef IRR_USE_ADJACENCY
-			if (adj1 == i || FaceData[adj1] == false)
-#endif
-			{
-				// add edge v1-v2
-				Edges[2*numEdges+0] = wFace1;
-				Edges[2*numEdges+1] = wFace2;
-				++numEdges;
-			}
+			const core::vector3df &v1 = Vertices[Indices[3*i+edge]];
+			const core::vector3df &v2 = Vertices[Indices[3*i+(edge+1)%3]];
+			const core::vector3df v3(v1+(v1 - Light).normalize()*Infinity);
+			const core::vector3df v4(v2+(v2 - Light).normalize()*Infinity);
 
-#ifdef IRR_USE_ADJACENCY
-			if (adj2 == i || FaceData[adj2] == false)
-#endif
-			{
-				// add edge v2-v0
-				Edges[2*numEdges+0] = wFace2;
-				Edges[2*numEdges+1] = wFace0;
-				++numEdges;
-			}
+			// Add a quad (two triangles) to the vertex list
+			part.Quads.push_back(v1);
+			part.Quads.push_back(v2);
+			part.Quads.push_back(v3);
+
+			part.Quads.push_back(v2);
+			part.Quads.push_back(v4);
+			part.Quads.push_back(v3);
 		}
 	}
-	return numEdges;
+}
+
+
+void CShadowVolumeSceneNode::CShadowJob::run(u32 index, u32 thread)
+{
+	if (Edges)
+		Node->createEdges(index);
+	else
+		Node->createCaps(index);
 }
 
 
@@ -251,6 +331,9 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 
 	// allocate memory if necessary
 
+	bool indicesChanged = Indices.size() != totalIndices;
+	bool verticesChanged = Vertices.size() != totalVertices;
+
 	Vertices.set_used(totalVertices);
 	Indices.set_used(totalIndices);
 	FaceData.set_used(totalIndices / 3);
@@ -273,31 +356,48 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 			const u32* idxp = (const u32*)buf->getIndexBuffer()->getIndices();
 			const u32* idxpend = idxp + buf->getIndexBuffer()->getIndexCount();
 			for (; idxp!=idxpend; ++idxp)
-				Indices[IndexCount++] = *idxp + VertexCount;
+			{
+				const u32 index = *idxp + VertexCount;
+				indicesChanged |= Indices[IndexCount] != index;
+				Indices[IndexCount++] = index;
+			}
 		}
 		else // video::EIT_16BIT
 		{
 			const u16* idxp = (const u16*)buf->getIndexBuffer()->getIndices();
 			const u16* idxpend = idxp + buf->getIndexBuffer()->getIndexCount();
 			for (; idxp!=idxpend; ++idxp)
-				Indices[IndexCount++] = *idxp + VertexCount;
+			{
+				const u32 index = *idxp + VertexCount;
+				indicesChanged |= Indices[IndexCount] != index;
+				Indices[IndexCount++] = index;
+			}
 		}
 
 		const u32 vtxcnt = buf->getVertexBuffer()->getVertexCount();
 		for (u32 j=0; j<vtxcnt; ++j)
 		{
-			core::vector3df* position = (core::vector3df*)offset;
+			const core::vector3df* position = (const core::vector3df*)offset;
+			core::vector3df& vertex = Vertices[VertexCount++];
 
-			Vertices[VertexCount++] = *position;
+			if (vertex.X != position->X || vertex.Y != position->Y || vertex.Z != position->Z)
+			{
+				vertex = *position;
+				verticesChanged = true;
+			}
 
 			offset += buf->getVertexBuffer()->getVertexSize();
 		}
 	}
 
 	// recalculate adjacency if necessary
-	if (oldVertexCount != VertexCount || oldIndexCount != IndexCount)
+	if (oldVertexCount != VertexCount || oldIndexCount != IndexCount || indicesChanged)
 		calculateAdjacency();
 
+	// the shadow volumes of the old mesh can't be reused
+	if (oldVertexCount != VertexCount || oldIndexCount != IndexCount || indicesChanged || verticesChanged)
+		ShadowVolumesValid = 0;
+
 	core::matrix4 mat = Parent->getAbsoluteTransformation();
 	mat.makeInverse();
 	const core::vector3df parentpos = Parent->getAbsolutePosition();
@@ -317,6 +417,20 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 }
 
 
+//! Sets how far a light has to move before its shadow volume is rebuilt.
+void CShadowVolumeSceneNode::setLightMoveThreshold(f32 distance)
+{
+	LightMoveThreshold = distance;
+}
+
+
+//! Gets how far a light has to move before its shadow volume is rebuilt.
+f32 CShadowVolumeSceneNode::getLightMoveThreshold() const
+{
+	return LightMoveThreshold;
+}
+
+
 //! pre render method
 void CShadowVolumeSceneNode::OnRegisterSceneNode()
 {
@@ -393,48 +507,115 @@ const core::aabbox3d<f32>& CShadowVolumeSceneNode::getBoundingBox() const
 //! Generates adjacency information based on mesh indices.
 void CShadowVolumeSceneNode::calculateAdjacency()
 {
+	calculatePositionIds();
+
 	Adjacency.set_used(IndexCount);
 
-	// go through all faces and fetch their three neighbours
+	core::array<SShadowEdge> edges;
+	edges.reallocate(IndexCount);
+
+	u32 slotCount = 16;
+	while (slotCount < IndexCount * 2)
+		slotCount <<= 1;
+	const u32 mask = slotCount - 1;
+
+	// open addressing hash of the edges to their index plus one
+	core::array<u32> slots;
+	slots.set_used(slotCount);
+	memset(slots.pointer(), 0, slotCount * sizeof(u32));
+
+	// first store the edge of each face corner in the adjacency
 	for (u32 f=0; f<IndexCount; f+=3)
 	{
+		const u32 face = f/3;
+
 		for (u32 edge = 0; edge<3; ++edge)
 		{
-			const core::vector3df& v1 = Vertices[Indices[f+edge]];
-			const core::vector3df& v2 = Vertices[Indices[f+((edge+1)%3)]];
-
-			// now we search an_O_ther _F_ace with these two
-			// vertices, which is not the current face.
-			u32 of;
+			u32 a = PositionIds[Indices[f+edge]];
+			u32 b = PositionIds[Indices[f+((edge+1)%3)]];
+			if (a > b)
+				core::swap(a, b);
 
-			for (of=0; of<IndexCount; of+=3)
+			u32 slot = hashEdge(a, b) & mask;
+			while (slots[slot])
 			{
-				// only other faces
-				if (of != f)
-				{
-					bool cnt1 = false;
-					bool cnt2 = false;
-
-					for (s32 e=0; e<3; ++e)
-					{
-						if (v1.equals(Vertices[Indices[of+e]]))
-							cnt1=true;
-
-						if (v2.equals(Vertices[Indices[of+e]]))
-							cnt2=true;
-					}
-					// one match for each vertex, i.e. edge is the same
-					if (cnt1 && cnt2)
-						break;
-				}
+				const SShadowEdge& e = edges[slots[slot]-1];
+				if (e.A == a && e.B == b)
+					break;
+				slot = (slot + 1) & mask;
 			}
 
-			// no adjacent edges -> store face number, else store adjacent face
-			if (of >= IndexCount)
-				Adjacency[f + edge] = f/3;
+			if (!slots[slot])
+			{
+				SShadowEdge e;
+				e.A = a;
+				e.B = b;
+				e.Face0 = face;
+				e.Face1 = NO_FACE;
+				edges.push_back(e);
+				slots[slot] = edges.size();
+			}
 			else
-				Adjacency[f + edge] = of/3;
+			{
+				SShadowEdge& e = edges[slots[slot]-1];
+				if (e.Face1 == NO_FACE && e.Face0 != face)
+					e.Face1 = face;
+			}
+
+			Adjacency[f + edge] = slots[slot]-1;
+		}
+	}
+
+	// the adjacent face is the first other face with the same edge,
+	// without adjacent face store the face itself
+	for (u32 i=0; i<IndexCount; ++i)
+	{
+		const SShadowEdge& e = edges[Adjacency[i]];
+		const u32 face = i/3;
+
+		if (e.Face0 != face)
+			Adjacency[i] = e.Face0;
+		else if (e.Face1 != NO_FACE)
+			Adjacency[i] = e.Face1;
+		else
+			Adjacency[i] = face;
+	}
+}
+
+
+//! Assigns the same id to vertices at the same position.
+void CShadowVolumeSceneNode::calculatePositionIds()
+{
+	PositionIds.set_used(Vertices.size());
+
+	u32 slotCount = 16;
+	while (slotCount < Vertices.size() * 2)
+		slotCount <<= 1;
+	const u32 mask = slotCount - 1;
+
+	// open addressing hash of the positions to the first vertex there, plus one
+	core::array<u32> slots;
+	slots.set_used(slotCount);
+	memset(slots.pointer(), 0, slotCount * sizeof(u32));
+
+	for (u32 i=0; i<Vertices.size(); ++i)
+	{
+		// adding zero turns -0 into 0
+		const core::vector3df pos(Vertices[i].X + 0.f, Vertices[i].Y + 0.f, Vertices[i].Z + 0.f);
+
+		u32 slot = hashPosition(pos) & mask;
+		while (slots[slot])
+		{
+			const core::vector3df& other = Vertices[slots[slot]-1];
+			if (other.X == pos.X && other.Y == pos.Y && other.Z == pos.Z)
+				break;
+			slot = (slot + 1) & mask;
 		}
+
+		if (!slots[slot])
+			slots[slot] = i+1;
+
+		PositionIds[i] = slots[slot]-1;
 	}
 }
 
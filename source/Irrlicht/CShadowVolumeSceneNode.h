@@ -6,6 +6,7 @@
 #define __C_SHADOW_VOLUME_SCENE_NODE_H_INCLUDED__
 
 #include "IShadowVolumeSceneNode.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -33,6 +34,12 @@ namespace scene
 		/** Called each render cycle from Animated Mesh SceneNode render method. */
 		virtual void updateShadowVolumes() _IRR_OVERRIDE_;
 
+		//! Sets how far a light has to move before its shadow volume is rebuilt.
+		virtual void setLightMoveThreshold(f32 distance) _IRR_OVERRIDE_;
+
+		//! Gets how far a light has to move before its shadow volume is rebuilt.
+		virtual f32 getLightMoveThreshold() const _IRR_OVERRIDE_;
+
 		//! pre render method
 		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
 
@@ -49,12 +56,41 @@ namespace scene
 
 		typedef core::array<core::vector3df> SShadowVolume;
 
+		//! faces of a part of the mesh, called by CThreadPool
+		class CShadowJob : public IThreadJob
+		{
+		public:
+			CShadowJob(CShadowVolumeSceneNode* node, bool edges) : Node(node), Edges(edges) {}
+
+			virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_;
+
+			CShadowVolumeSceneNode* Node;
+			bool Edges;
+		};
+
+		//! caps and silhouette of a part of the faces
+		struct SShadowPart
+		{
+			SShadowVolume Caps;
+			SShadowVolume Quads;
+			core::aabbox3d<f32> Box;
+			bool HasBox;
+		};
+
 		void createShadowVolume(const core::vector3df& pos, bool isDirectional=false);
-		u32 createEdgesAndCaps(const core::vector3df& light, SShadowVolume* svp, core::aabbox3d<f32>* bb);
+
+		//! Finds the faces of a part which face the light and adds their caps.
+		void createCaps(u32 part);
+
+		//! Adds the quads of the silhouette edges of a part.
+		void createEdges(u32 part);
 
 		//! Generates adjacency information based on mesh indices.
 		void calculateAdjacency();
 
+		//! Assigns the same id to vertices at the same position.
+		void calculatePositionIds();
+
 		core::aabbox3d<f32> Box;
 
 		// a shadow volume for every light
@@ -63,13 +99,20 @@ namespace scene
 		// a back cap bounding box for every light
 		core::array<core::aabbox3d<f32> > ShadowBBox;
 
+		// the light position each shadow volume was built for
+		core::array<core::vector3df> ShadowLights;
+
 		core::array<core::vector3df> Vertices;
-		core::array<u16> Indices;
-		core::array<u16> Adjacency;
-		core::array<u16> Edges;
+		core::array<u32> Indices;
+		core::array<u32> Adjacency;
+		core::array<u32> PositionIds;
 		// tells if face is front facing
 		core::array<bool> FaceData;
 
+		// state of the shadow volume which is built, used by the jobs
+		core::array<SShadowPart> Parts;
+		core::vector3df Light;
+
 		const scene::IMesh* ShadowMesh;
 
 		u32 IndexCount;
@@ -77,6 +120,10 @@ namespace scene
 		u32 ShadowVolumesUsed;
 
 		f32 Infinity;
+		f32 LightMoveThreshold;
+
+		// number of shadow volumes built from the current vertices and indices
+		u32 ShadowVolumesValid;
 
 		bool UseZFailMethod;
 	};
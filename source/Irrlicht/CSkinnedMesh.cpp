@@ -10,6 +10,10 @@
 #include "IAnimatedMeshSceneNode.h"
 #include "os.h"
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
+
 namespace
 {
 	// Frames must always be increasing, so we remove objects where this isn't the case
@@ -96,7 +100,7 @@ CSkinnedMesh::CSkinnedMesh()
 	LastAnimatedFrame(-1), SkinnedLastFrame(false),
 	InterpolationMode(EIM_LINEAR),
 	HasAnimation(false), PreparedForSkinning(false),
-	AnimateNormals(true), HardwareSkinning(false)
+	AnimateNormals(true), HardwareSkinning(false), UseSSE2(os::Cpu::hasSSE2())
 {
 	#ifdef _DEBUG
 	setDebugName("CSkinnedMesh");
@@ -241,51 +245,8 @@ void CSkinnedMesh::buildAllLocalAnimatedMatrices()
 		{
 			joint->GlobalSkinningSpace=false;
 
-			// IRR_TEST_BROKEN_QUATERNION_USE: TODO - switched to getMatrix_transposed instead of getMatrix for downward compatibility.
-			//								   Not tested so far if this was correct or wrong before quaternion fix!
-			joint->Animatedrotation.getMatrix_transposed(joint->LocalAnimatedMatrix);
-
-			// --- joint->LocalAnimatedMatrix *= joint->Animatedrotation.getMatrix() ---
-			f32 *m1 = joint->LocalAnimatedMatrix.pointer();
-			core::vector3df &Pos = joint->Animatedposition;
-			m1[0] += Pos.X*m1[3];
-			m1[1] += Pos.Y*m1[3];
-			m1[2] += Pos.Z*m1[3];
-			m1[4] += Pos.X*m1[7];
-			m1[5] += Pos.Y*m1[7];
-			m1[6] += Pos.Z*m1[7];
-			m1[8] += Pos.X*m1[11];
-			m1[9] += Pos.Y*m1[11];
-			m1[10] += Pos.Z*m1[11];
-			m1[12] += Pos.X*m1[15];
-			m1[13] += Pos.Y*m1[15];
-			m1[14] += Pos.Z*m1[15];
-			// -----------------------------------
-
-			if (joint->ScaleKeys.size())
-			{
-				/*
-				core::matrix4 scaleMatrix;
-				scaleMatrix.setScale(joint->Animatedscale);
-				joint->LocalAnimatedMatrix *= scaleMatrix;
-				*/
-
-				// -------- joint->LocalAnimatedMatrix *= scaleMatrix -----------------
-				core::matrix4& mat = joint->LocalAnimatedMatrix;
-				mat[0] *= joint->Animatedscale.X;
-				mat[1] *= joint->Animatedscale.X;
-				mat[2] *= joint->Animatedscale.X;
-				mat[3] *= joint->Animatedscale.X;
-				mat[4] *= joint->Animatedscale.Y;
-				mat[5] *= joint->Animatedscale.Y;
-				mat[6] *= joint->Animatedscale.Y;
-				mat[7] *= joint->Animatedscale.Y;
-				mat[8] *= joint->Animatedscale.Z;
-				mat[9] *= joint->Animatedscale.Z;
-				mat[10] *= joint->Animatedscale.Z;
-				mat[11] *= joint->Animatedscale.Z;
-				// -----------------------------------
-			}
+			buildLocalAnimatedMatrix(joint, joint->Animatedposition, joint->Animatedscale,
+				joint->Animatedrotation, joint->LocalAnimatedMatrix);
 		}
 		else
 		{
@@ -296,6 +257,57 @@ void CSkinnedMesh::buildAllLocalAnimatedMatrices()
 }
 
 
+void CSkinnedMesh::buildLocalAnimatedMatrix(const SJoint* joint, const core::vector3df& position,
+		const core::vector3df& scale, const core::quaternion& rotation, core::matrix4& matrix)
+{
+	// IRR_TEST_BROKEN_QUATERNION_USE: TODO - switched to getMatrix_transposed instead of getMatrix for downward compatibility.
+	//								   Not tested so far if this was correct or wrong before quaternion fix!
+	rotation.getMatrix_transposed(matrix);
+
+	// --- joint->LocalAnimatedMatrix *= joint->Animatedrotation.getMatrix() ---
+	f32 *m1 = matrix.pointer();
+	const core::vector3df &Pos = position;
+	m1[0] += Pos.X*m1[3];
+	m1[1] += Pos.Y*m1[3];
+	m1[2] += Pos.Z*m1[3];
+	m1[4] += Pos.X*m1[7];
+	m1[5] += Pos.Y*m1[7];
+	m1[6] += Pos.Z*m1[7];
+	m1[8] += Pos.X*m1[11];
+	m1[9] += Pos.Y*m1[11];
+	m1[10] += Pos.Z*m1[11];
+	m1[12] += Pos.X*m1[15];
+	m1[13] += Pos.Y*m1[15];
+	m1[14] += Pos.Z*m1[15];
+	// -----------------------------------
+
+	if (joint->ScaleKeys.size())
+	{
+		/*
+		core::matrix4 scaleMatrix;
+		scaleMatrix.setScale(joint->Animatedscale);
+		joint->LocalAnimatedMatrix *= scaleMatrix;
+		*/
+
+		// -------- joint->LocalAnimatedMatrix *= scaleMatrix -----------------
+		core::matrix4& mat = matrix;
+		mat[0] *= scale.X;
+		mat[1] *= scale.X;
+		mat[2] *= scale.X;
+		mat[3] *= scale.X;
+		mat[4] *= scale.Y;
+		mat[5] *= scale.Y;
+		mat[6] *= scale.Y;
+		mat[7] *= scale.Y;
+		mat[8] *= scale.Z;
+		mat[9] *= scale.Z;
+		mat[10] *= scale.Z;
+		mat[11] *= scale.Z;
+		// -----------------------------------
+	}
+}
+
+
 void CSkinnedMesh::buildAllGlobalAnimatedMatrices(SJoint *joint, SJoint *parentJoint)
 {
 	if (!joint)
@@ -321,7 +333,7 @@ void CSkinnedMesh::buildAllGlobalAnimatedMatrices(SJoint *joint, SJoint *parentJ
 void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 				core::vector3df &position, s32 &positionHint,
 				core::vector3df &scale, s32 &scaleHint,
-				core::quaternion &rotation, s32 &rotationHint)
+				core::quaternion &rotation, s32 &rotationHint) const
 {
 	s32 foundPositionIndex = -1;
 	s32 foundScaleIndex = -1;
@@ -545,14 +557,7 @@ void CSkinnedMesh::skinMesh()
 			}
 		}
 
-		//clear skinning helper array
-		for (i=0; i<Vertices_Moved.size(); ++i)
-			for (u32 j=0; j<Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j]=false;
-
-		//skin starting with the root joints
-		for (i=0; i<RootJoints.size(); ++i)
-			skinJoint(RootJoints[i], 0);
+		skinBuffers();
 
 		for (i=0; i<SkinningBuffers->size(); ++i)
 			(*SkinningBuffers)[i]->setDirty(EBT_VERTEX);
@@ -561,74 +566,736 @@ void CSkinnedMesh::skinMesh()
 }
 
 
-void CSkinnedMesh::skinJoint(SJoint *joint, SJoint *parentJoint)
+// vertices skinned by one job of the thread pool
+static const u32 SKINNING_PART_SIZE = 4096;
+
+
+//! Compiles the weights into one table per buffer
+/** The tables hold the joints and weights of each vertex next to each other, so
+skinning runs over the vertices instead of the joints and doesn't have to look up
+the vertex layout for every weight. */
+void CSkinnedMesh::buildSkinningTables()
 {
-	if (joint->Weights.size())
-	{
-		//Find this joints pull on vertices...
-		core::matrix4 jointVertexPull(core::matrix4::EM4CONST_NOTHING);
-		jointVertexPull.setbyproduct(joint->GlobalAnimatedMatrix, joint->GlobalInversedMatrix);
+	SkinningTables.clear();
+	SkinningParts.clear();
+
+	const u32 jointCount = AllJoints.size();
 
-		core::vector3df thisVertexMove, thisNormalMove;
+	// the last matrix is used by the unused slots
+	core::matrix4 zero(core::matrix4::EM4CONST_NOTHING);
+	for (u32 k=0; k<16; ++k)
+		zero[k] = 0.f;
 
-		core::array<scene::IMeshBuffer*> &buffersUsed=*SkinningBuffers;
+	JointPulls.clear();
+	JointPulls.reallocate(jointCount + 1);
+	for (u32 j=0; j<=jointCount; ++j)
+		JointPulls.push_back(zero);
 
-		//Skin Vertices Positions and Normals...
-		for (u32 i=0; i<joint->Weights.size(); ++i)
+	core::array<IMeshBuffer*>& buffers = *SkinningBuffers;
+
+	BufferTables.set_used(buffers.size());
+	BufferJoints.set_used(buffers.size());
+	for (u32 b=0; b<buffers.size(); ++b)
+		BufferTables[b] = BufferJoints[b] = -1;
+
+	for (u32 j=0; j<jointCount; ++j)
+	{
+		const core::array<u32>& attached = AllJoints[j]->AttachedMeshes;
+		for (u32 m=0; m<attached.size(); ++m)
 		{
-			SWeight& weight = joint->Weights[i];
+			if (attached[m] < buffers.size())
+				BufferJoints[attached[m]] = j;
+		}
+	}
 
-			video::IVertexAttribute* attributeP = buffersUsed[weight.buffer_id]->getVertexDescriptor()->getAttributeBySemantic(video::EVAS_POSITION);
-			video::IVertexAttribute* attributeN = buffersUsed[weight.buffer_id]->getVertexDescriptor()->getAttributeBySemantic(video::EVAS_NORMAL);
+	// influences of each vertex
+	core::array< core::array<u32> > influences;
+	influences.reallocate(buffers.size());
+	for (u32 b=0; b<buffers.size(); ++b)
+	{
+		influences.push_back(core::array<u32>());
+		influences[b].set_used(buffers[b]->getVertexBuffer()->getVertexCount());
+		memset(influences[b].pointer(), 0, influences[b].size() * sizeof(u32));
+	}
 
-			if(!attributeP || !attributeN)
-				continue;
+	for (u32 j=0; j<jointCount; ++j)
+	{
+		const core::array<SWeight>& weights = AllJoints[j]->Weights;
+		for (u32 w=0; w<weights.size(); ++w)
+		{
+			if (weights[w].buffer_id < buffers.size() && weights[w].vertex_id < influences[weights[w].buffer_id].size())
+				++influences[weights[w].buffer_id][weights[w].vertex_id];
+		}
+	}
+
+	for (u32 b=0; b<buffers.size(); ++b)
+	{
+		video::IVertexDescriptor* descriptor = buffers[b]->getVertexDescriptor();
+		video::IVertexAttribute* attributeP = descriptor->getAttributeBySemantic(video::EVAS_POSITION);
+		video::IVertexAttribute* attributeN = descriptor->getAttributeBySemantic(video::EVAS_NORMAL);
+
+		if (!attributeP || !attributeN)
+			continue;
 
-			u8* Vertices = static_cast<u8*>(buffersUsed[weight.buffer_id]->getVertexBuffer()->getVertices());
+		BufferTables[b] = SkinningTables.size();
+		SkinningTables.push_back(SSkinningTable());
+		SSkinningTable& table = SkinningTables.getLast();
 
-			u8* positionOffset = Vertices + attributeP->getOffset();
-			u8* normalOffset = Vertices + attributeN->getOffset();
+		table.Buffer = b;
+		table.Descriptor = descriptor;
+		table.VertexCount = buffers[b]->getVertexBuffer()->getVertexCount();
+		table.Stride = buffers[b]->getVertexBuffer()->getVertexSize();
+		table.PositionOffset = attributeP->getOffset();
+		table.NormalOffset = attributeN->getOffset();
 
-			// Pull this vertex...
-			jointVertexPull.transformVect(thisVertexMove, weight.StaticPos);
+		// assign the vertices to their slots, influences then holds the slot index
+		core::array<u32>& slot = influences[b];
+		u32 extraWeights = 0;
 
-			if (AnimateNormals)
-				jointVertexPull.rotateVect(thisNormalMove, weight.StaticNormal);
+		const u8* positions = static_cast<const u8*>(buffers[b]->getVertexBuffer()->getVertices()) + table.PositionOffset;
+		table.HasStaticBox = false;
 
-			if (! (*(weight.Moved)) )
+		for (u32 v=0; v<slot.size(); ++v)
+		{
+			const u32 count = slot[v];
+			if (count == 0)
+			{
+				const core::vector3df& position = *(const core::vector3df*)(positions + table.Stride * v);
+				if (table.HasStaticBox)
+					table.StaticBox.addInternalPoint(position);
+				else
+					table.StaticBox.reset(position);
+				table.HasStaticBox = true;
+				continue;
+			}
+
+			if (count <= 4)
+			{
+				slot[v] = table.Vertex.size();
+				table.Vertex.push_back(v);
+			}
+			else
+			{
+				slot[v] = 0x80000000 | table.ExtraVertex.size();
+				table.ExtraVertex.push_back(v);
+				table.ExtraBegin.push_back(extraWeights);
+				extraWeights += count;
+			}
+		}
+		table.ExtraBegin.push_back(extraWeights);
+
+		const u32 vertexCount = table.Vertex.size();
+		for (u32 k=0; k<4; ++k)
+		{
+			table.Joint[k].set_used(vertexCount);
+			table.Weight[k].set_used(vertexCount);
+			for (u32 v=0; v<vertexCount; ++v)
+			{
+				table.Joint[k][v] = jointCount;
+				table.Weight[k][v] = 0.f;
+			}
+		}
+		table.StaticPos.set_used(vertexCount * 4);
+		table.StaticNormal.set_used(vertexCount * 4);
+
+		table.ExtraJoint.set_used(extraWeights);
+		table.ExtraWeight.set_used(extraWeights);
+		table.ExtraStaticPos.set_used(table.ExtraVertex.size() * 4);
+		table.ExtraStaticNormal.set_used(table.ExtraVertex.size() * 4);
+
+		// weights filled per vertex so far
+		core::array<u8> filled;
+		filled.set_used(vertexCount);
+		memset(filled.pointer(), 0, vertexCount);
+		core::array<u32> extraFilled;
+		extraFilled.set_used(table.ExtraVertex.size());
+		if (extraFilled.size())
+			memset(extraFilled.pointer(), 0, extraFilled.size() * sizeof(u32));
+
+		for (u32 j=0; j<jointCount; ++j)
+		{
+			const core::array<SWeight>& weights = AllJoints[j]->Weights;
+			bool boxed = false;
+			for (u32 w=0; w<weights.size(); ++w)
 			{
-				*(weight.Moved) = true;
+				const SWeight& weight = weights[w];
+				if (weight.buffer_id != b || weight.vertex_id >= slot.size())
+					continue;
 
-				core::vector3df* position = (core::vector3df*)(positionOffset + buffersUsed[weight.buffer_id]->getVertexBuffer()->getVertexSize() * weight.vertex_id);
-				core::vector3df* normal = (core::vector3df*)(normalOffset + buffersUsed[weight.buffer_id]->getVertexBuffer()->getVertexSize() * weight.vertex_id);
+				if (boxed)
+					table.JointBox.getLast().addInternalPoint(weight.StaticPos);
+				else
+				{
+					table.BoxJoint.push_back(j);
+					table.JointBox.push_back(core::aabbox3df(weight.StaticPos));
+					boxed = true;
+				}
 
-				*position = thisVertexMove * weight.strength;
+				const u32 index = slot[weight.vertex_id];
+				f32* pos;
+				f32* normal;
 
-				if (AnimateNormals)
-					*normal = thisNormalMove * weight.strength;
+				if (index & 0x80000000)
+				{
+					const u32 e = index & 0x7FFFFFFF;
+					const u32 n = table.ExtraBegin[e] + extraFilled[e]++;
+					table.ExtraJoint[n] = j;
+					table.ExtraWeight[n] = weight.strength;
+					pos = &table.ExtraStaticPos[e*4];
+					normal = &table.ExtraStaticNormal[e*4];
+				}
+				else
+				{
+					const u32 k = filled[index]++;
+					table.Joint[k][index] = j;
+					table.Weight[k][index] = weight.strength;
+					pos = &table.StaticPos[index*4];
+					normal = &table.StaticNormal[index*4];
+				}
 
-				//*(weight._Pos) = thisVertexMove * weight.strength;
+				pos[0] = weight.StaticPos.X;
+				pos[1] = weight.StaticPos.Y;
+				pos[2] = weight.StaticPos.Z;
+				pos[3] = 1.f;
+				normal[0] = weight.StaticNormal.X;
+				normal[1] = weight.StaticNormal.Y;
+				normal[2] = weight.StaticNormal.Z;
+				normal[3] = 0.f;
+			}
+		}
+
+		// split into parts for the thread pool
+		const u32 t = SkinningTables.size() - 1;
+		for (u32 begin=0; begin<vertexCount; begin+=SKINNING_PART_SIZE)
+		{
+			SSkinningPart part;
+			part.Table = t;
+			part.Begin = begin;
+			part.End = core::min_(begin + SKINNING_PART_SIZE, vertexCount);
+			part.Extra = false;
+			SkinningParts.push_back(part);
+		}
+
+		if (table.ExtraVertex.size())
+		{
+			SSkinningPart part;
+			part.Table = t;
+			part.Begin = 0;
+			part.End = table.ExtraVertex.size();
+			part.Extra = true;
+			SkinningParts.push_back(part);
+		}
+	}
+}
+
+
+void CSkinnedMesh::checkSkinningTables()
+{
+	const core::array<IMeshBuffer*>& buffers = *SkinningBuffers;
+
+	// the offsets are only valid for the vertex layout they were resolved for
+	bool valid = JointPulls.size() == AllJoints.size() + 1;
+	for (u32 i=0; valid && i<SkinningTables.size(); ++i)
+	{
+		const SSkinningTable& table = SkinningTables[i];
+		const IMeshBuffer* buffer = table.Buffer < buffers.size() ? buffers[table.Buffer] : 0;
+
+		valid = buffer && buffer->getVertexDescriptor() == table.Descriptor &&
+			buffer->getVertexBuffer()->getVertexCount() == table.VertexCount &&
+			buffer->getVertexBuffer()->getVertexSize() == table.Stride;
+	}
+
+	if (!valid)
+		buildSkinningTables();
+}
+
+
+void CSkinnedMesh::skinBuffers()
+{
+	core::array<IMeshBuffer*>& buffers = *SkinningBuffers;
+
+	checkSkinningTables();
+
+	for (u32 j=0; j<AllJoints.size(); ++j)
+	{
+		if (AllJoints[j]->Weights.size())
+			JointPulls[j].setbyproduct(AllJoints[j]->GlobalAnimatedMatrix, AllJoints[j]->GlobalInversedMatrix);
+	}
+
+	CSkinningJob job(this, JointPulls.const_pointer(), buffers);
+	CThreadPool::getSharedPool()->run(&job, SkinningParts.size());
+
+	for (u32 i=0; i<SkinningTables.size(); ++i)
+		buffers[SkinningTables[i].Buffer]->boundingBoxNeedsRecalculated();
+}
+
+
+//! Linear blend skinning of a range of vertices
+/** The joint matrices of a vertex are blended first, then its static position
+and normal are transformed once. */
+void CSkinnedMesh::skinPart(u32 index, const core::matrix4* pulls, core::array<IMeshBuffer*>& buffers) const
+{
+	const SSkinningPart& part = SkinningParts[index];
+	const SSkinningTable& table = SkinningTables[part.Table];
+
+	u8* vertices = static_cast<u8*>(buffers[table.Buffer]->getVertexBuffer()->getVertices());
+	u8* positions = vertices + table.PositionOffset;
+	u8* normals = vertices + table.NormalOffset;
+	const u32 stride = table.Stride;
+	const bool animateNormals = AnimateNormals;
+
+	if (part.Extra)
+	{
+		for (u32 i=part.Begin; i<part.End; ++i)
+		{
+			f32 c[16];
+			for (u32 e=0; e<16; ++e)
+				c[e] = 0.f;
+
+			for (u32 n=table.ExtraBegin[i]; n<table.ExtraBegin[i+1]; ++n)
+			{
+				const f32* m = pulls[table.ExtraJoint[n]].pointer();
+				const f32 w = table.ExtraWeight[n];
+				for (u32 e=0; e<16; ++e)
+					c[e] += w * m[e];
+			}
+
+			const f32* p = &table.ExtraStaticPos[i*4];
+			f32* position = (f32*)(positions + stride * table.ExtraVertex[i]);
+			for (u32 e=0; e<3; ++e)
+				position[e] = p[0]*c[e] + p[1]*c[4+e] + p[2]*c[8+e] + c[12+e];
+
+			if (animateNormals)
+			{
+				const f32* nrm = &table.ExtraStaticNormal[i*4];
+				f32* normal = (f32*)(normals + stride * table.ExtraVertex[i]);
+				for (u32 e=0; e<3; ++e)
+					normal[e] = nrm[0]*c[e] + nrm[1]*c[4+e] + nrm[2]*c[8+e];
+			}
+		}
+		return;
+	}
+
+	const u32* joint0 = table.Joint[0].const_pointer();
+	const u32* joint1 = table.Joint[1].const_pointer();
+	const u32* joint2 = table.Joint[2].const_pointer();
+	const u32* joint3 = table.Joint[3].const_pointer();
+	const f32* weight0 = table.Weight[0].const_pointer();
+	const f32* weight1 = table.Weight[1].const_pointer();
+	const f32* weight2 = table.Weight[2].const_pointer();
+	const f32* weight3 = table.Weight[3].const_pointer();
+	const f32* staticPos = table.StaticPos.const_pointer();
+	const f32* staticNormal = table.StaticNormal.const_pointer();
+	const u32* vertex = table.Vertex.const_pointer();
+
+	// unused slots point to the zero matrix, most vertices only follow one joint
+	const u32 unused = AllJoints.size();
+
+	u32 i = part.Begin;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		// the columns of the matrices are blended, the products and sums
+		// are done in the same order as in the C++ code below, but both
+		// only match skinning each weight on its own within an epsilon
+		for (; i<part.End; ++i)
+		{
+			const f32* m0 = pulls[joint0[i]].pointer();
+			const f32* m1 = pulls[joint1[i]].pointer();
+			const f32* m2 = pulls[joint2[i]].pointer();
+			const f32* m3 = pulls[joint3[i]].pointer();
+			const __m128 w0 = _mm_set1_ps(weight0[i]);
+			const __m128 w1 = _mm_set1_ps(weight1[i]);
+			const __m128 w2 = _mm_set1_ps(weight2[i]);
+			const __m128 w3 = _mm_set1_ps(weight3[i]);
+
+			__m128 c[4];
+			if (joint1[i] == unused)
+			{
+				for (u32 k=0; k<4; ++k)
+					c[k] = _mm_mul_ps(w0, _mm_loadu_ps(m0 + k*4));
 			}
 			else
 			{
-				core::vector3df* position = (core::vector3df*)(positionOffset + buffersUsed[weight.buffer_id]->getVertexBuffer()->getVertexSize() * weight.vertex_id);
-				core::vector3df* normal = (core::vector3df*)(normalOffset + buffersUsed[weight.buffer_id]->getVertexBuffer()->getVertexSize() * weight.vertex_id);
+				for (u32 k=0; k<4; ++k)
+				{
+					__m128 b = _mm_mul_ps(w0, _mm_loadu_ps(m0 + k*4));
+					b = _mm_add_ps(b, _mm_mul_ps(w1, _mm_loadu_ps(m1 + k*4)));
+					b = _mm_add_ps(b, _mm_mul_ps(w2, _mm_loadu_ps(m2 + k*4)));
+					c[k] = _mm_add_ps(b, _mm_mul_ps(w3, _mm_loadu_ps(m3 + k*4)));
+				}
+			}
+
+			const f32* p = staticPos + i*4;
+			__m128 r = _mm_mul_ps(_mm_set1_ps(p[0]), c[0]);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p[1]), c[1]));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p[2]), c[2]));
+			r = _mm_add_ps(r, c[3]);
+
+			f32 out[4];
+			_mm_storeu_ps(out, r);
+			f32* position = (f32*)(positions + stride * vertex[i]);
+			position[0] = out[0];
+			position[1] = out[1];
+			position[2] = out[2];
+
+			if (animateNormals)
+			{
+				const f32* n = staticNormal + i*4;
+				r = _mm_mul_ps(_mm_set1_ps(n[0]), c[0]);
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(n[1]), c[1]));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(n[2]), c[2]));
+
+				_mm_storeu_ps(out, r);
+				f32* normal = (f32*)(normals + stride * vertex[i]);
+				normal[0] = out[0];
+				normal[1] = out[1];
+				normal[2] = out[2];
+			}
+		}
+	}
+#endif
+
+	for (; i<part.End; ++i)
+	{
+		const f32* m0 = pulls[joint0[i]].pointer();
+		const f32* m1 = pulls[joint1[i]].pointer();
+		const f32* m2 = pulls[joint2[i]].pointer();
+		const f32* m3 = pulls[joint3[i]].pointer();
+		const f32 w0 = weight0[i];
+		const f32 w1 = weight1[i];
+		const f32 w2 = weight2[i];
+		const f32 w3 = weight3[i];
+
+		f32 c[16];
+		if (joint1[i] == unused)
+		{
+			for (u32 e=0; e<16; ++e)
+				c[e] = w0*m0[e];
+		}
+		else
+		{
+			for (u32 e=0; e<16; ++e)
+				c[e] = w0*m0[e] + w1*m1[e] + w2*m2[e] + w3*m3[e];
+		}
+
+		const f32* p = staticPos + i*4;
+		f32* position = (f32*)(positions + stride * vertex[i]);
+		for (u32 e=0; e<3; ++e)
+			position[e] = p[0]*c[e] + p[1]*c[4+e] + p[2]*c[8+e] + c[12+e];
+
+		if (animateNormals)
+		{
+			const f32* n = staticNormal + i*4;
+			f32* normal = (f32*)(normals + stride * vertex[i]);
+			for (u32 e=0; e<3; ++e)
+				normal[e] = n[0]*c[e] + n[1]*c[4+e] + n[2]*c[8+e];
+		}
+	}
+}
+
+
+CSkinnedMesh::SAnimationState::SAnimationState()
+: Mesh(0), Frame(-1.f), JointFrame(-1.f)
+{
+}
+
+
+CSkinnedMesh::SAnimationState::~SAnimationState()
+{
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! copies the vertices of a buffer, the vertex size has to be the one of a standard vertex type
+static IVertexBuffer* createVertexBufferCopy(IVertexBuffer* source)
+{
+	IVertexBuffer* copy = 0;
+
+	switch (source->getVertexSize())
+	{
+	case sizeof(video::S3DVertex):
+		copy = new CVertexBuffer<video::S3DVertex>();
+		break;
+	case sizeof(video::S3DVertex2TCoords):
+		copy = new CVertexBuffer<video::S3DVertex2TCoords>();
+		break;
+	case sizeof(video::S3DVertexTangents):
+		copy = new CVertexBuffer<video::S3DVertexTangents>();
+		break;
+	default:
+		return 0;
+	}
+
+	copy->set_used(source->getVertexCount());
+	if (source->getVertexCount())
+		memcpy(copy->getVertices(), source->getVertices(), source->getVertexCount() * source->getVertexSize());
+	copy->setHardwareMappingHint(source->getHardwareMappingHint());
+
+	return copy;
+}
+
+
+bool CSkinnedMesh::prepareAnimationState(SAnimationState& state)
+{
+	if (!HasAnimation || HardwareSkinning)
+		return false;
+
+	const core::array<IMeshBuffer*>& buffers = *SkinningBuffers;
+	checkSkinningTables();
+
+	// copy the buffers again if the mesh changed
+	bool valid = state.Mesh && state.Mesh->getMeshBufferCount() == buffers.size();
+	for (u32 i=0; valid && i<buffers.size(); ++i)
+	{
+		const IMeshBuffer* source = buffers[i];
+		const IMeshBuffer* copy = state.Mesh->getMeshBuffer(i);
+
+		valid = copy->getVertexDescriptor() == source->getVertexDescriptor() &&
+			copy->getIndexBuffer() == source->getIndexBuffer() &&
+			copy->getVertexBuffer()->getVertexCount() == source->getVertexBuffer()->getVertexCount() &&
+			copy->getVertexBuffer()->getVertexSize() == source->getVertexBuffer()->getVertexSize();
+	}
+
+	if (!valid)
+	{
+		if (state.Mesh)
+			state.Mesh->drop();
+		state.Mesh = new SMesh();
+
+		for (u32 i=0; i<buffers.size(); ++i)
+		{
+			IMeshBuffer* source = buffers[i];
+			IVertexBuffer* vertices = createVertexBufferCopy(source->getVertexBuffer());
+			if (!vertices)
+			{
+				state.Mesh->drop();
+				state.Mesh = 0;
+				return false;
+			}
 
-				*position += thisVertexMove * weight.strength;
+			// the type only selects the vertex buffer which is replaced at once
+			CMeshBuffer<video::S3DVertex>* copy = new CMeshBuffer<video::S3DVertex>(source->getVertexDescriptor());
+			copy->setVertexBuffer(vertices, 0);
+			vertices->drop();
+			for (u32 j=1; j<source->getVertexBufferCount(); ++j)
+				copy->addVertexBuffer(source->getVertexBuffer(j));
+			copy->setIndexBuffer(source->getIndexBuffer());
+			copy->getMaterial() = source->getMaterial();
+			copy->getTransformation() = source->getTransformation();
+			copy->getBoundingBox() = source->getBoundingBox();
+
+			state.Mesh->addMeshBuffer(copy);
+			copy->drop();
+		}
+		state.Mesh->BoundingBox = BoundingBox;
+		state.Frame = -1.f;
+		state.JointFrame = -1.f;
+	}
 
-				if (AnimateNormals)
-					*normal += thisNormalMove * weight.strength;
+	const u32 jointCount = AllJoints.size();
+	if (state.Parent.size() != jointCount)
+	{
+		state.Order.clear();
+		state.Parent.set_used(jointCount);
+		for (u32 j=0; j<jointCount; ++j)
+			state.Parent[j] = -1;
 
-				//*(weight._Pos) += thisVertexMove * weight.strength;
+		// breadth first from the roots, so parents come first
+		for (u32 j=0; j<RootJoints.size(); ++j)
+		{
+			const s32 root = AllJoints.linear_search(RootJoints[j]);
+			if (root >= 0)
+				state.Order.push_back(root);
+		}
+		for (u32 k=0; k<state.Order.size(); ++k)
+		{
+			const SJoint* joint = AllJoints[state.Order[k]];
+			for (u32 c=0; c<joint->Children.size(); ++c)
+			{
+				const s32 child = AllJoints.linear_search(joint->Children[c]);
+				if (child >= 0)
+				{
+					state.Parent[child] = state.Order[k];
+					state.Order.push_back(child);
+				}
 			}
+		}
 
-			buffersUsed[weight.buffer_id]->boundingBoxNeedsRecalculated();
+		// unanimated channels keep the pose the joints were loaded with
+		state.Position.set_used(jointCount);
+		state.Scale.set_used(jointCount);
+		state.Rotation.set_used(jointCount);
+		state.Hints.set_used(jointCount * 3);
+		for (u32 j=0; j<jointCount; ++j)
+		{
+			state.Position[j] = AllJoints[j]->Animatedposition;
+			state.Scale[j] = AllJoints[j]->Animatedscale;
+			state.Rotation[j] = AllJoints[j]->Animatedrotation;
+			state.Hints[j*3] = state.Hints[j*3+1] = state.Hints[j*3+2] = -1;
 		}
+
+		core::matrix4 zero(core::matrix4::EM4CONST_NOTHING);
+		for (u32 k=0; k<16; ++k)
+			zero[k] = 0.f;
+
+		// joints which can't be reached from the roots aren't animated
+		state.Global.set_used(jointCount);
+		for (u32 j=0; j<jointCount; ++j)
+			state.Global[j] = AllJoints[j]->GlobalAnimatedMatrix;
+
+		state.Pulls.set_used(jointCount + 1);
+		for (u32 j=0; j<=jointCount; ++j)
+			state.Pulls[j] = zero;
+
+		state.Frame = -1.f;
+		state.JointFrame = -1.f;
 	}
 
-	//Skin all children
-	for (u32 j=0; j<joint->Children.size(); ++j)
-		skinJoint(joint->Children[j], joint);
+	return true;
+}
+
+
+//! Does what animateMesh and skinMesh do for the mesh
+void CSkinnedMesh::animateState(SAnimationState& state, f32 frame, bool useThreads) const
+{
+	if (state.Frame == frame || !state.Mesh)
+		return;
+
+	state.Frame = frame;
+	animateStateJoints(state, frame);
+
+	//rigid animation
+	for (u32 k=0; k<state.Order.size(); ++k)
+	{
+		const u32 j = state.Order[k];
+		const SJoint* joint = AllJoints[j];
+		for (u32 m=0; m<joint->AttachedMeshes.size(); ++m)
+			state.Mesh->getMeshBuffer(joint->AttachedMeshes[m])->getTransformation() = state.Global[j];
+	}
+
+	CSkinningJob job(this, state.Pulls.const_pointer(), state.Mesh->MeshBuffers);
+	if (useThreads)
+		CThreadPool::getSharedPool()->run(&job, SkinningParts.size());
+	else
+	{
+		for (u32 i=0; i<SkinningParts.size(); ++i)
+			job.run(i, 0);
+	}
+
+	state.Mesh->BoundingBox.reset(0,0,0);
+	for (u32 i=0; i<state.Mesh->getMeshBufferCount(); ++i)
+	{
+		IMeshBuffer* buffer = state.Mesh->getMeshBuffer(i);
+		buffer->setDirty(EBT_VERTEX);
+		buffer->recalculateBoundingBox();
+
+		core::aabbox3df bb = buffer->getBoundingBox();
+		buffer->getTransformation().transformBoxEx(bb);
+		state.Mesh->BoundingBox.addInternalBox(bb);
+	}
+}
+
+
+//! Returns a box around the mesh animateState would skin
+void CSkinnedMesh::getStateBoundingBox(SAnimationState& state, f32 frame, core::aabbox3df& box) const
+{
+	if (!state.Mesh)
+	{
+		box = BoundingBox;
+		return;
+	}
+
+	animateStateJoints(state, frame);
+
+	// like the box of animateState
+	box.reset(0,0,0);
+	for (u32 i=0; i<state.Mesh->getMeshBufferCount(); ++i)
+	{
+		IMeshBuffer* buffer = state.Mesh->getMeshBuffer(i);
+		const s32 t = i < BufferTables.size() ? BufferTables[i] : -1;
+
+		core::aabbox3df bb;
+		if (t < 0)
+			bb = buffer->getBoundingBox();
+		else
+		{
+			const SSkinningTable& table = SkinningTables[t];
+			bool empty = !table.HasStaticBox;
+			if (!empty)
+				bb = table.StaticBox;
+
+			// the weights of a vertex add up to one, so the skinned vertex stays
+			// within the transformed boxes of the vertices of its joints
+			for (u32 k=0; k<table.JointBox.size(); ++k)
+			{
+				core::aabbox3df jointBox = table.JointBox[k];
+				state.Pulls[table.BoxJoint[k]].transformBoxEx(jointBox);
+				if (empty)
+					bb = jointBox;
+				else
+					bb.addInternalBox(jointBox);
+				empty = false;
+			}
+
+			if (empty)
+				continue;
+		}
+
+		const s32 joint = i < BufferJoints.size() ? BufferJoints[i] : -1;
+		if (joint >= 0)
+			state.Global[joint].transformBoxEx(bb);
+		else
+			buffer->getTransformation().transformBoxEx(bb);
+		box.addInternalBox(bb);
+	}
+}
+
+
+void CSkinnedMesh::animateStateJoints(SAnimationState& state, f32 frame) const
+{
+	if (state.JointFrame == frame)
+		return;
+
+	state.JointFrame = frame;
+
+	for (u32 k=0; k<state.Order.size(); ++k)
+	{
+		const u32 j = state.Order[k];
+		SJoint* joint = AllJoints[j];
+		const s32 parent = state.Parent[j];
+
+		bool globalSkinningSpace = joint->GlobalSkinningSpace;
+		core::matrix4 local(core::matrix4::EM4CONST_NOTHING);
+
+		if (joint->UseAnimationFrom &&
+			(joint->UseAnimationFrom->PositionKeys.size() ||
+			 joint->UseAnimationFrom->ScaleKeys.size() ||
+			 joint->UseAnimationFrom->RotationKeys.size() ))
+		{
+			getFrameData(frame, joint,
+					state.Position[j], state.Hints[j*3],
+					state.Scale[j], state.Hints[j*3+1],
+					state.Rotation[j], state.Hints[j*3+2]);
+
+			globalSkinningSpace = false;
+			buildLocalAnimatedMatrix(joint, state.Position[j], state.Scale[j], state.Rotation[j], local);
+		}
+		else
+		{
+			local = joint->LocalMatrix;
+		}
+
+		if (parent < 0 || globalSkinningSpace)
+			state.Global[j] = local;
+		else
+			state.Global[j] = state.Global[parent] * local;
+
+		if (joint->Weights.size())
+			state.Pulls[j].setbyproduct(state.Global[j], joint->GlobalInversedMatrix);
+	}
 }
 
 
@@ -996,6 +1663,8 @@ void CSkinnedMesh::checkForAnimation()
 
 		// normalize weights
 		normalizeWeights();
+
+		buildSkinningTables();
 	}
 	SkinnedLastFrame=false;
 }
@@ -9,10 +9,12 @@
 
 #include "ISkinnedMesh.h"
 #include "CMeshBuffer.h"
+#include "SMesh.h"
 #include "S3DVertex.h"
 #include "irrString.h"
 #include "matrix4.h"
 #include "quaternion.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -157,6 +159,61 @@ namespace scene
 				IAnimatedMeshSceneNode* node,
 				ISceneManager* smgr);
 
+		//! Joint state and skinned copy of the mesh for one scene node
+		/** Scene nodes sharing the mesh animate and skin their own state, the mesh itself
+		isn't changed, so the states of several nodes can be updated at the same time. */
+		struct SAnimationState
+		{
+			SAnimationState();
+			~SAnimationState();
+
+			//! copies of the mesh buffers, sharing the indices with the mesh
+			SMesh* Mesh;
+
+			//! joints in an order where parents come before their children
+			core::array<u32> Order;
+			//! parent of each joint, -1 for root joints
+			core::array<s32> Parent;
+
+			core::array<core::vector3df> Position;
+			core::array<core::vector3df> Scale;
+			core::array<core::quaternion> Rotation;
+			//! position, scale and rotation key hints of each joint
+			core::array<s32> Hints;
+
+			core::array<core::matrix4> Global;
+			//! transformation from the static pose of each joint, followed by a zero matrix
+			core::array<core::matrix4> Pulls;
+
+			//! frame the state was animated for
+			f32 Frame;
+			//! frame Global and Pulls were calculated for
+			f32 JointFrame;
+
+		private:
+			// not copyable
+			SAnimationState(const SAnimationState&);
+			SAnimationState& operator=(const SAnimationState&);
+		};
+
+		//! Sets up a state for animateState, has to be called on the main thread
+		/** Creates the copies of the mesh buffers if the buffers of the mesh changed.
+		\return False if the mesh can't be skinned into a state, which is the case
+		for hardware skinning and vertex sizes of no standard vertex type. */
+		bool prepareAnimationState(SAnimationState& state);
+
+		//! Animates the joints of a state and skins its copy of the mesh
+		/** Only reads the mesh, so it can be called on any thread at the same time for
+		different states. \param useThreads Splits the skinning over the shared thread
+		pool, must be false if called from a job of the pool. */
+		void animateState(SAnimationState& state, f32 frame, bool useThreads) const;
+
+		//! Animates the joints of a state and returns a box around the mesh animateState would skin
+		/** Only transforms a box around the vertices of each joint, which is much cheaper
+		than skinning, but the box can be bigger than the one of the skinned mesh. The
+		skinned mesh of the state isn't changed. */
+		void getStateBoundingBox(SAnimationState& state, f32 frame, core::aabbox3df& box) const;
+
 private:
 		void checkForAnimation();
 
@@ -166,14 +223,104 @@ private:
 
 		void buildAllGlobalAnimatedMatrices(SJoint *Joint=0, SJoint *ParentJoint=0);
 
+		//! calculates the Global and Pulls matrices of a state
+		void animateStateJoints(SAnimationState& state, f32 frame) const;
+
 		void getFrameData(f32 frame, SJoint *Node,
 				core::vector3df &position, s32 &positionHint,
 				core::vector3df &scale, s32 &scaleHint,
-				core::quaternion &rotation, s32 &rotationHint);
+				core::quaternion &rotation, s32 &rotationHint) const;
+
+		//! builds the local matrix of an animated joint
+		static void buildLocalAnimatedMatrix(const SJoint* joint, const core::vector3df& position,
+				const core::vector3df& scale, const core::quaternion& rotation, core::matrix4& matrix);
 
 		void calculateGlobalMatrices(SJoint *Joint,SJoint *ParentJoint);
 
-		void skinJoint(SJoint *Joint, SJoint *ParentJoint);
+		//! compiles the weights of all joints into SkinningTables
+		void buildSkinningTables();
+
+		//! rebuilds the skinning tables if the layout of the buffers changed
+		void checkSkinningTables();
+
+		//! skins all buffers with the current joint matrices
+		void skinBuffers();
+
+		//! skins one part of a skinning table into buffers with the same layout as the mesh
+		void skinPart(u32 part, const core::matrix4* pulls, core::array<IMeshBuffer*>& buffers) const;
+
+		//! software skinning data of one mesh buffer
+		/** Each vertex with up to 4 influences has a fixed slot of 4 joints and weights,
+		unused slots use the zero matrix behind the joint matrices. Vertices with more
+		influences are listed separately and skinned without SIMD. The joint matrices
+		are blended before the vertex is transformed, which rounds differently than
+		transforming the vertex by each joint, so the results only match skinning
+		each weight on its own within a small epsilon. */
+		struct SSkinningTable
+		{
+			u32 Buffer;
+
+			//! layout the offsets were resolved for
+			const video::IVertexDescriptor* Descriptor;
+			u32 VertexCount;
+			u32 Stride;
+			u32 PositionOffset;
+			u32 NormalOffset;
+
+			core::array<u32> Vertex;
+			core::array<u32> Joint[4];
+			core::array<f32> Weight[4];
+
+			//! static position and normal, 4 floats per vertex
+			core::array<f32> StaticPos;
+			core::array<f32> StaticNormal;
+
+			//! vertices with more than 4 influences, ExtraBegin has one more entry than ExtraVertex
+			core::array<u32> ExtraVertex;
+			core::array<u32> ExtraBegin;
+			core::array<u32> ExtraJoint;
+			core::array<f32> ExtraWeight;
+			core::array<f32> ExtraStaticPos;
+			core::array<f32> ExtraStaticNormal;
+
+			//! box around the static positions of the vertices of each joint in BoxJoint
+			core::array<u32> BoxJoint;
+			core::array<core::aabbox3df> JointBox;
+			//! box around the vertices without influences, which aren't skinned
+			core::aabbox3df StaticBox;
+			bool HasStaticBox;
+		};
+
+		//! a range of vertices of a table skinned by one job of the thread pool
+		struct SSkinningPart
+		{
+			u32 Table;
+			u32 Begin;
+			u32 End;
+
+			//! range of the vertices with more than 4 influences
+			bool Extra;
+		};
+
+		//! skins the parts on the shared thread pool
+		class CSkinningJob : public IThreadJob
+		{
+		public:
+			CSkinningJob(const CSkinnedMesh* mesh, const core::matrix4* pulls, core::array<IMeshBuffer*>& buffers)
+				: Mesh(mesh), Pulls(pulls), Buffers(buffers) {}
+
+			virtual void run(u32 index, u32 thread) _IRR_OVERRIDE_
+			{
+				Mesh->skinPart(index, Pulls, Buffers);
+			}
+
+			const CSkinnedMesh* Mesh;
+			const core::matrix4* Pulls;
+			core::array<IMeshBuffer*>& Buffers;
+
+		private:
+			CSkinningJob& operator=(const CSkinningJob&);
+		};
 
 		core::array<IMeshBuffer*> *SkinningBuffers; //Meshbuffer to skin, default is to skin localBuffers
 
@@ -184,6 +331,16 @@ private:
 
 		core::array< core::array<bool> > Vertices_Moved;
 
+		core::array<SSkinningTable> SkinningTables;
+		core::array<SSkinningPart> SkinningParts;
+
+		//! skinning table and the joint a buffer is attached to of each skinned buffer, -1 for none
+		core::array<s32> BufferTables;
+		core::array<s32> BufferJoints;
+
+		//! transformation from the static pose of each joint for the current frame, followed by a zero matrix
+		core::array<core::matrix4> JointPulls;
+
 		core::aabbox3d<f32> BoundingBox;
 
 		f32 AnimationFrames;
@@ -198,6 +355,7 @@ private:
 		bool PreparedForSkinning;
 		bool AnimateNormals;
 		bool HardwareSkinning;
+		bool UseSSE2;
 	};
 
 } // end namespace scene
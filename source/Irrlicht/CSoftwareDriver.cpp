@@ -23,7 +23,7 @@ namespace video
 CSoftwareDriver::CSoftwareDriver(const core::dimension2d<u32>& windowSize, bool fullscreen, io::IFileSystem* io, video::IImagePresenter* presenter)
 : CNullDriver(io, windowSize), BackBuffer(0), Presenter(presenter), WindowId(0),
 	SceneSourceRect(0), RenderTargetTexture(0), RenderTargetSurface(0),
-	CurrentTriangleRenderer(0), ZBuffer(0), Texture(0)
+	CurrentTriangleRenderer(0), ZBuffer(0), Texture(0), RangeIndexBuffer(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CSoftwareDriver");
@@ -93,6 +93,9 @@ CSoftwareDriver::~CSoftwareDriver()
 	if (Texture)
 		Texture->drop();
 
+	if (RangeIndexBuffer)
+		RangeIndexBuffer->drop();
+
 	if (RenderTargetTexture)
 		RenderTargetTexture->drop();
 
@@ -487,6 +490,42 @@ void CSoftwareDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws a range of the indices of a mesh buffer
+void CSoftwareDriver::drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount)
+{
+	if (!mb || !mb->isVertexBufferCompatible())
+		return;
+
+	scene::IIndexBuffer* indexBuffer = mb->getIndexBuffer();
+	if (!getPrimitiveCount(mb->getPrimitiveType(), indexCount) || firstIndex + indexCount > indexBuffer->getIndexCount())
+		return;
+
+	if (firstIndex == 0 && indexCount == indexBuffer->getIndexCount())
+	{
+		drawMeshBuffer(mb);
+		return;
+	}
+
+	// this driver reads the indices through the index buffer only, so it
+	// draws a copy of the range in place of the index buffer
+	if (!RangeIndexBuffer)
+		RangeIndexBuffer = new scene::CIndexBuffer(indexBuffer->getType());
+
+	const u32 indexSize = indexBuffer->getIndexSize();
+	RangeIndexBuffer->setType(indexBuffer->getType());
+	RangeIndexBuffer->set_used(indexCount);
+	memcpy(RangeIndexBuffer->getIndices(), static_cast<u8*>(indexBuffer->getIndices()) + firstIndex * indexSize,
+		indexCount * indexSize);
+
+	scene::IMeshBuffer* buffer = const_cast<scene::IMeshBuffer*>(mb);
+	indexBuffer->grab();
+	buffer->setIndexBuffer(RangeIndexBuffer);
+	drawMeshBuffer(buffer);
+	buffer->setIndexBuffer(indexBuffer);
+	indexBuffer->drop();
+}
+
+
 template<class VERTEXTYPE>
 void CSoftwareDriver::drawClippedIndexedTriangleListT(const VERTEXTYPE* vertices,
 	s32 vertexCount, const u16* indexList, s32 triangleCount)
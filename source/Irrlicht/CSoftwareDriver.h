@@ -57,6 +57,9 @@ namespace video
 
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
 
+		//! Draws a range of the indices of a mesh buffer, by drawing a copy of them
+		virtual void drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount) _IRR_OVERRIDE_;
+
 		//! Draws a 3d line.
 		virtual void draw3DLine(const core::vector3df& start,
 			const core::vector3df& end, SColor color = SColor(255,255,255,255)) _IRR_OVERRIDE_;
@@ -75,6 +78,9 @@ namespace video
 			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 			const core::rect<s32>* clip = 0) _IRR_OVERRIDE_;
 
+		//! 2d images and rectangles are always drawn immediately
+		virtual bool is2DBatchingEnabled() const _IRR_OVERRIDE_ { return false; }
+
 		//! Draws a 2d line.
 		virtual void draw2DLine(const core::position2d<s32>& start,
 								const core::position2d<s32>& end,
@@ -159,6 +165,9 @@ namespace video
 
 		video::ITexture* Texture;
 
+		//! indices drawn instead of the ones of a mesh buffer by drawMeshBufferRange
+		scene::IIndexBuffer* RangeIndexBuffer;
+
 		SMaterial Material;
 	};
 
@@ -336,6 +336,7 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 : CNullDriver(io, params.WindowSize), BackBuffer(0), Presenter(presenter),
 	WindowId(0), SceneSourceRect(0),
 	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShader(0),
+	 CurrentShaderType(ETR_INVALID), TileBinner(0),
 	 DepthBuffer(0), StencilBuffer ( 0 ),
 	 CurrentOut ( 12 * 2, 128 ), Temp ( 12 * 2, 128 )
 {
@@ -368,39 +369,12 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 	createVertexDescriptors();
 
 	// create triangle renderers
+	createShaders ( BurningShader );
 
-	irr::memset32 ( BurningShader, 0, sizeof ( BurningShader ) );
-	//BurningShader[ETR_FLAT] = createTRFlat2(DepthBuffer);
-	//BurningShader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
-	BurningShader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
-	BurningShader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
-	BurningShader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
-	//BurningShader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
-	BurningShader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
-
-	BurningShader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
-
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
-
-	BurningShader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
-	BurningShader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
-	BurningShader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
-
-	BurningShader[ETR_REFERENCE] = createTriangleRendererReference ( this );
-
+	// rasterize on all threads of the engine
+	CThreadPool* pool = CThreadPool::getSharedPool();
+	if ( params.DriverMultithreaded && pool->getThreadCount() > 1 )
+		TileBinner = new CBurningTileBinner ( this, pool );
 
 	// add the same renderer for all solid types
 	CSoftware2MaterialRenderer_SOLID* smr = new CSoftware2MaterialRenderer_SOLID( this);
@@ -448,9 +422,48 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 }
 
 
+//! creates a complete set of triangle renderers
+void CBurningVideoDriver::createShaders ( IBurningShader* shader[ETR2_COUNT] )
+{
+	irr::memset32 ( shader, 0, ETR2_COUNT * sizeof ( IBurningShader* ) );
+	//shader[ETR_FLAT] = createTRFlat2(DepthBuffer);
+	//shader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
+	shader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
+	shader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
+	shader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
+	//shader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
+	//shader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
+	//shader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
+	shader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
+	shader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
+	shader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
+
+	shader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
+	shader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
+	shader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
+
+	shader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
+	shader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
+
+	shader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
+	shader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
+	shader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
+
+	shader[ETR_REFERENCE] = createTriangleRendererReference ( this );
+}
+
+
 //! destructor
 CBurningVideoDriver::~CBurningVideoDriver()
 {
+	delete TileBinner;
+
 	// delete Backbuffer
 	if (BackBuffer)
 		BackBuffer->drop();
@@ -587,24 +600,23 @@ void CBurningVideoDriver::setCurrentShader()
 
 	// switchToTriangleRenderer
 	CurrentShader = BurningShader[shader];
+	CurrentShaderType = shader;
 	if ( CurrentShader )
 	{
-		CurrentShader->setZCompareFunc ( Material.org.ZBuffer );
 		CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
-		CurrentShader->setMaterial ( Material );
-
-		switch ( shader )
-		{
-			case ETR_TEXTURE_GOURAUD_ALPHA:
-			case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
-			case ETR_TEXTURE_BLEND:
-				CurrentShader->setParam ( 0, Material.org.MaterialTypeParam );
-				break;
-			default:
-			break;
-		}
+		CBurningTileBinner::applyState ( CurrentShader, shader, Material );
 	}
 
+	if ( TileBinner )
+		TileBinner->setState ( shader, &Material );
+}
+
+
+//! rasterizes all triangles collected by the tile binner
+void CBurningVideoDriver::flushTileBinner ()
+{
+	if ( TileBinner )
+		TileBinner->flush ();
 }
 
 
@@ -690,6 +702,8 @@ bool CBurningVideoDriver::beginScene(bool backBuffer, bool zBuffer,
 		SColor color, const SExposedVideoData& videoData,
 		core::rect<s32>* sourceRect)
 {
+	flushTileBinner ();
+
 	CNullDriver::beginScene(backBuffer, zBuffer, color, videoData, sourceRect);
 	WindowId = videoData.D3D9.HWnd;
 	SceneSourceRect = sourceRect;
@@ -708,6 +722,8 @@ bool CBurningVideoDriver::beginScene(bool backBuffer, bool zBuffer,
 //! presents the rendered scene on the screen, returns false if failed
 bool CBurningVideoDriver::endScene()
 {
+	flushTileBinner ();
+
 	CNullDriver::endScene();
 
 	return Presenter->present(BackBuffer, WindowId, SceneSourceRect);
@@ -724,6 +740,8 @@ bool CBurningVideoDriver::setRenderTarget(video::ITexture* texture, bool clearBa
 		return false;
 	}
 
+	flushTileBinner ();
+
 	if (RenderTargetTexture)
 		RenderTargetTexture->drop();
 
@@ -755,6 +773,9 @@ bool CBurningVideoDriver::setRenderTarget(video::ITexture* texture, bool clearBa
 //! sets a render target
 void CBurningVideoDriver::setRenderTarget(video::CImage* image)
 {
+	if ( TileBinner )
+		TileBinner->setRenderTarget ( image );
+
 	if (RenderTargetSurface)
 		RenderTargetSurface->drop();
 
@@ -1729,7 +1750,27 @@ void CBurningVideoDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	if (!mb || !mb->isVertexBufferCompatible())
 		return;
 
-	if (!checkPrimitiveCount(mb->getPrimitiveCount()))
+	renderMeshBuffer(mb, 0, mb->getPrimitiveCount());
+}
+
+
+//! Draws a range of the indices of a mesh buffer
+void CBurningVideoDriver::drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount)
+{
+	if (!mb || !mb->isVertexBufferCompatible())
+		return;
+
+	const u32 primitiveCount = getPrimitiveCount(mb->getPrimitiveType(), indexCount);
+	if (!primitiveCount || firstIndex + indexCount > mb->getIndexBuffer()->getIndexCount())
+		return;
+
+	renderMeshBuffer(mb, firstIndex, primitiveCount);
+}
+
+
+void CBurningVideoDriver::renderMeshBuffer(const scene::IMeshBuffer* mb, u32 firstIndex, u32 primitiveCount)
+{
+	if (!checkPrimitiveCount(primitiveCount))
 		return;
 
 	if (mb->getVertexBufferCount() > 1)
@@ -1742,7 +1783,6 @@ void CBurningVideoDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 	E_VERTEX_TYPE vertexType = EVT_STANDARD;
 
 	scene::IIndexBuffer* indexBuffer = mb->getIndexBuffer();
-	const u32 primitiveCount = mb->getPrimitiveCount();
 	const scene::E_PRIMITIVE_TYPE primitiveType = mb->getPrimitiveType();
 
 	// Supported are only built-in Irrlicht vertex formats.
@@ -1761,7 +1801,10 @@ void CBurningVideoDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 		return;
 	}
 
-	drawVertexPrimitiveList(vertexBuffer->getVertices(), vertexBuffer->getVertexCount(), indexBuffer->getIndices(), primitiveCount, vertexType, primitiveType, indexBuffer->getType());
+	// the range starts at an offset into the indices
+	const u8* indices = static_cast<const u8*>(indexBuffer->getIndices()) + firstIndex * indexBuffer->getIndexSize();
+
+	drawVertexPrimitiveList(vertexBuffer->getVertices(), vertexBuffer->getVertexCount(), indices, primitiveCount, vertexType, primitiveType, indexBuffer->getType());
 }
 
 
@@ -1787,7 +1830,17 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 
 	if ( 0 == CurrentShader )
 		return;
-		
+
+	// collect triangles for the tile binner if the shader can work on bands
+	CBurningTileBinner* binner = 0;
+	if ( TileBinner )
+	{
+		if ( CurrentShaderType != ETR_INVALID && CurrentShader->supportsScanlineBand () )
+			binner = TileBinner;
+		else
+			TileBinner->flush ();
+	}
+
 	PrimitivesDrawn += primitiveCount;
 
 	VertexCache_reset ( vertices, vertexCount, indexList, primitiveCount, vType, pType, iType );
@@ -1837,7 +1890,10 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 			}
 
 			// rasterize
-			CurrentShader->drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
+			if ( binner )
+				binner->addTriangle ( CurrentShader, face[0] + 1, face[1] + 1, face[2] + 1 );
+			else
+				CurrentShader->drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
 			continue;
 		}
 
@@ -1916,7 +1972,12 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 		for ( g = 0; g <= vOut - 6; g += 2 )
 		{
 			// rasterize
-			CurrentShader->drawTriangle ( CurrentOut.data + 0 + 1,
+			if ( binner )
+				binner->addTriangle ( CurrentShader, CurrentOut.data + 0 + 1,
+							CurrentOut.data + g + 3,
+							CurrentOut.data + g + 5);
+			else
+				CurrentShader->drawTriangle ( CurrentOut.data + 0 + 1,
 							CurrentOut.data + g + 3,
 							CurrentOut.data + g + 5);
 		}
@@ -2230,6 +2291,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 					 const core::rect<s32>* clipRect, SColor color,
 					 bool useAlphaChannelOfTexture)
 {
+	flushTileBinner ();
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -2268,6 +2331,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
 		const video::SColor* const colors, bool useAlphaChannelOfTexture)
 {
+	flushTileBinner ();
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -2290,6 +2355,7 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
 					SColor color)
 {
+	flushTileBinner ();
 	drawLine(BackBuffer, start, end, color );
 }
 
@@ -2297,6 +2363,7 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 //! Draws a pixel
 void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 {
+	flushTileBinner ();
 	BackBuffer->setPixel(x, y, color, true);
 }
 
@@ -2305,6 +2372,8 @@ void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 void CBurningVideoDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos,
 									 const core::rect<s32>* clip)
 {
+	flushTileBinner ();
+
 	if (clip)
 	{
 		core::rect<s32> p(pos);
@@ -2377,6 +2446,7 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 	const core::rect<s32>* clip)
 {
 #ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+	flushTileBinner ();
 
 	core::rect<s32> pos = position;
 
@@ -2488,6 +2558,8 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 	const core::vector3df& end, SColor color)
 {
+	flushTileBinner ();
+
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[0].Pos.x, start );
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[2].Pos.x, end );
 
@@ -2591,6 +2663,8 @@ ITexture* CBurningVideoDriver::addRenderTargetTexture(const core::dimension2d<u3
 //! Clears the DepthBuffer.
 void CBurningVideoDriver::clearZBuffer()
 {
+	flushTileBinner ();
+
 	if (DepthBuffer)
 		DepthBuffer->clear();
 }
@@ -2602,6 +2676,8 @@ IImage* CBurningVideoDriver::createScreenShot(video::ECOLOR_FORMAT format, video
 	if (target != video::ERT_FRAME_BUFFER)
 		return 0;
 
+	flushTileBinner ();
+
 	if (BackBuffer)
 	{
 		IImage* tmp = createImage(BackBuffer->getColorFormat(), BackBuffer->getDimension());
@@ -2642,7 +2718,9 @@ void CBurningVideoDriver::drawStencilShadowVolume(const core::array<core::vector
 	const u32 count = triangles.size();
 	IBurningShader *shader = BurningShader [ ETR_STENCIL_SHADOW ];
 
+	// the shader state changes between the passes, draw directly
 	CurrentShader = shader;
+	CurrentShaderType = ETR_INVALID;
 	shader->setRenderTarget(RenderTargetSurface, ViewPort);
 
 	Material.org.MaterialType = video::EMT_SOLID;
@@ -2702,6 +2780,9 @@ void CBurningVideoDriver::drawStencilShadow(bool clearStencilBuffer, video::SCol
 {
 	if (!StencilBuffer)
 		return;
+
+	flushTileBinner ();
+
 	// draw a shadow rectangle covering the entire screen using stencil buffer
 	const u32 h = RenderTargetSurface->getDimension().Height;
 	const u32 w = RenderTargetSurface->getDimension().Width;
@@ -7,6 +7,7 @@
 
 #include "SoftwareDriver2_compile_config.h"
 #include "IBurningShader.h"
+#include "CBurningTileBinner.h"
 #include "CNullDriver.h"
 #include "CImage.h"
 #include "os.h"
@@ -81,6 +82,9 @@ namespace video
 
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb);
 
+		//! Draws a range of the indices of a mesh buffer
+		virtual void drawMeshBufferRange(const scene::IMeshBuffer* mb, u32 firstIndex, u32 indexCount);
+
 		//! draws a vertex primitive list
 		virtual void drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
 				const void* indexList, u32 primitiveCount,
@@ -109,6 +113,9 @@ namespace video
 			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 			const core::rect<s32>* clip = 0) _IRR_OVERRIDE_;
 
+		//! 2d images and rectangles are always drawn immediately
+		virtual bool is2DBatchingEnabled() const _IRR_OVERRIDE_ { return false; }
+
 		//! Draws a 2d line.
 		virtual void draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
@@ -168,11 +175,17 @@ namespace video
 		IDepthBuffer * getDepthBuffer () { return DepthBuffer; }
 		IStencilBuffer * getStencilBuffer () { return StencilBuffer; }
 
+		//! creates a complete set of triangle renderers, indexed by EBurningFFShader
+		void createShaders ( IBurningShader* shader[ETR2_COUNT] );
+
 	protected:
 
 		//! sets a render target
 		void setRenderTarget(video::CImage* image);
 
+		//! draws the primitives of a mesh buffer starting at an index
+		void renderMeshBuffer(const scene::IMeshBuffer* mb, u32 firstIndex, u32 primitiveCount);
+
 		//! sets the current Texture
 		//bool setTexture(u32 stage, video::ITexture* texture);
 
@@ -195,6 +208,13 @@ namespace video
 
 		IBurningShader* CurrentShader;
 		IBurningShader* BurningShader[ETR2_COUNT];
+		EBurningFFShader CurrentShaderType;
+
+		//! tile binned rasterizer, only used with SIrrlichtCreationParameters::DriverMultithreaded
+		CBurningTileBinner* TileBinner;
+
+		//! rasterizes all triangles collected by the tile binner
+		void flushTileBinner ();
 
 		IDepthBuffer* DepthBuffer;
 		IStencilBuffer* StencilBuffer;
@@ -76,6 +76,28 @@ namespace irr
 namespace video
 {
 
+// interpolators stepped by skipToBand
+static const u32 ScanInterpolators = 0
+#ifdef IPOL_Z
+	| SCAN_IPOL_Z
+#endif
+#ifdef IPOL_W
+	| SCAN_IPOL_W
+#endif
+#ifdef IPOL_C0
+	| SCAN_IPOL_C0
+#endif
+#ifdef IPOL_T0
+	| SCAN_IPOL_T0
+#endif
+#ifdef IPOL_T1
+	| SCAN_IPOL_T1
+#endif
+#ifdef IPOL_L0
+	| SCAN_IPOL_L0
+#endif
+	;
+
 class CTRGouraudAlpha2 : public IBurningShader
 {
 public:
@@ -367,6 +389,8 @@ void CTRGouraudAlpha2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,cons
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -402,6 +426,9 @@ void CTRGouraudAlpha2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,cons
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -526,6 +553,8 @@ void CTRGouraudAlpha2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,cons
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 
@@ -562,6 +591,9 @@ void CTRGouraudAlpha2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,cons
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
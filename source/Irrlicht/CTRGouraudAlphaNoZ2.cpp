@@ -76,6 +76,28 @@ namespace irr
 namespace video
 {
 
+// interpolators stepped by skipToBand
+static const u32 ScanInterpolators = 0
+#ifdef IPOL_Z
+	| SCAN_IPOL_Z
+#endif
+#ifdef IPOL_W
+	| SCAN_IPOL_W
+#endif
+#ifdef IPOL_C0
+	| SCAN_IPOL_C0
+#endif
+#ifdef IPOL_T0
+	| SCAN_IPOL_T0
+#endif
+#ifdef IPOL_T1
+	| SCAN_IPOL_T1
+#endif
+#ifdef IPOL_L0
+	| SCAN_IPOL_L0
+#endif
+	;
+
 class CTRGouraudAlphaNoZ2 : public IBurningShader
 {
 public:
@@ -365,6 +387,8 @@ void CTRGouraudAlphaNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,c
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -400,6 +424,9 @@ void CTRGouraudAlphaNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,c
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -524,6 +551,8 @@ void CTRGouraudAlphaNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,c
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 
@@ -560,6 +589,9 @@ void CTRGouraudAlphaNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,c
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
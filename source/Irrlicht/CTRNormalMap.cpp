@@ -78,6 +78,28 @@ namespace irr
 namespace video
 {
 
+// interpolators stepped by skipToBand
+static const u32 ScanInterpolators = 0
+#ifdef IPOL_Z
+	| SCAN_IPOL_Z
+#endif
+#ifdef IPOL_W
+	| SCAN_IPOL_W
+#endif
+#ifdef IPOL_C0
+	| SCAN_IPOL_C0
+#endif
+#ifdef IPOL_T0
+	| SCAN_IPOL_T0
+#endif
+#ifdef IPOL_T1
+	| SCAN_IPOL_T1
+#endif
+#ifdef IPOL_L0
+	| SCAN_IPOL_L0
+#endif
+	;
+
 
 class CTRNormalMap : public IBurningShader
 {
@@ -479,6 +501,8 @@ void CTRNormalMap::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -524,6 +548,9 @@ void CTRNormalMap::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -686,6 +713,8 @@ void CTRNormalMap::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 
@@ -732,6 +761,9 @@ void CTRNormalMap::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
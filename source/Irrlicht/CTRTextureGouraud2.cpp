@@ -24,6 +24,8 @@
 #undef IPOL_T0
 #undef IPOL_T1
 
+#undef SPAN_SIMD
+
 // define render case
 #define SUBTEXEL
 #define INVERSE_W
@@ -68,6 +70,12 @@
 
 #endif
 
+// vectorized span filler for this render case
+#if defined ( SOFTWARE_DRIVER_2_SIMD ) && defined ( INVERSE_W ) && defined ( CMP_W ) && defined ( WRITE_W ) && \
+	defined ( IPOL_C0 ) && !defined ( IPOL_T1 )
+	#define SPAN_SIMD
+#endif
+
 
 namespace irr
 {
@@ -75,6 +83,28 @@ namespace irr
 namespace video
 {
 
+// interpolators stepped by skipToBand
+static const u32 ScanInterpolators = 0
+#ifdef IPOL_Z
+	| SCAN_IPOL_Z
+#endif
+#ifdef IPOL_W
+	| SCAN_IPOL_W
+#endif
+#ifdef IPOL_C0
+	| SCAN_IPOL_C0
+#endif
+#ifdef IPOL_T0
+	| SCAN_IPOL_T0
+#endif
+#ifdef IPOL_T1
+	| SCAN_IPOL_T1
+#endif
+#ifdef IPOL_L0
+	| SCAN_IPOL_L0
+#endif
+	;
+
 class CTRTextureGouraud2 : public IBurningShader
 {
 public:
@@ -207,7 +237,15 @@ void CTRTextureGouraud2::scanline_bilinear ()
 	u32 dIndex = ( line.y & 3 ) << 2;
 #endif
 
-	for ( s32 i = 0; i <= dx; ++i )
+	s32 i = 0;
+
+#ifdef SPAN_SIMD
+	if ( SpanFill->TextureGouraud )
+		i = SpanFill->TextureGouraud ( dst, z, i, dx, line.w[0], slopeW, line.t[0][0], slopeT[0],
+										line.c[0][0], slopeC, &IT[0] );
+#endif
+
+	for ( ; i <= dx; ++i )
 	{
 #ifdef CMP_Z
 		if ( line.z[0] < z[i] )
@@ -384,6 +422,8 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -419,6 +459,9 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -543,6 +586,8 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 
@@ -579,6 +624,9 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -24,6 +24,8 @@
 #undef IPOL_T0
 #undef IPOL_T1
 
+#undef SPAN_SIMD
+
 // define render case
 #define SUBTEXEL
 #define INVERSE_W
@@ -68,12 +70,39 @@
 
 #endif
 
+// vectorized span filler for this render case
+#if defined ( SOFTWARE_DRIVER_2_SIMD ) && defined ( IPOL_W )
+	#define SPAN_SIMD
+#endif
+
 namespace irr
 {
 
 namespace video
 {
 
+// interpolators stepped by skipToBand
+static const u32 ScanInterpolators = 0
+#ifdef IPOL_Z
+	| SCAN_IPOL_Z
+#endif
+#ifdef IPOL_W
+	| SCAN_IPOL_W
+#endif
+#ifdef IPOL_C0
+	| SCAN_IPOL_C0
+#endif
+#ifdef IPOL_T0
+	| SCAN_IPOL_T0
+#endif
+#ifdef IPOL_T1
+	| SCAN_IPOL_T1
+#endif
+#ifdef IPOL_L0
+	| SCAN_IPOL_L0
+#endif
+	;
+
 class CTRTextureLightMap2_M4 : public IBurningShader
 {
 public:
@@ -198,6 +227,12 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 #endif
 
 
+#ifdef SPAN_SIMD
+	if ( SpanFill->LightMap )
+		i = SpanFill->LightMap ( dst, z, i, dx, line.w[0], line.w[1], line.t[0][0], line.t[0][1],
+								line.t[1][0], line.t[1][1], IT, 2, true );
+#endif
+
 	for ( ;i <= dx; i++ )
 	{
 #ifdef IPOL_W
@@ -330,6 +365,12 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
 	tFixPoint r1, g1, b1;
 
 
+#ifdef SPAN_SIMD
+	if ( SpanFill->LightMap )
+		i = SpanFill->LightMap ( dst, z, i, dx, line.w[0], line.w[1], line.t[0][0], line.t[0][1],
+								line.t[1][0], line.t[1][1], IT, 2, false );
+#endif
+
 	for ( ;i <= dx; i++ )
 	{
 #ifdef IPOL_W
@@ -483,6 +524,8 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -518,6 +561,9 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -643,6 +689,8 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 
@@ -679,6 +727,9 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -857,6 +908,8 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 		subPixel = ( (f32) yStart ) - a->Pos.y;
@@ -892,6 +945,9 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -1017,6 +1073,8 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		if ( yEnd >= BandEnd )
+			yEnd = BandEnd - 1;
 
 #ifdef SUBTEXEL
 
@@ -1053,6 +1111,9 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 
 #endif
 
+		// start at the band, the scanlines above are drawn by other threads
+		yStart = skipToBand ( scan, yStart, ScanInterpolators );
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -83,6 +83,9 @@ public:
 	virtual void drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c );
 	virtual void drawLine ( const s4DVertex *a,const s4DVertex *b);
 
+	// lines are not drawn by scanline
+	virtual bool supportsScanlineBand () const { return false; }
+
 
 
 private:
@@ -39,6 +39,7 @@ namespace scene
 	TerrainData(patchSize, maxLOD, position, rotation, scale), RenderBuffer(0),
 	VerticesToRender(0), IndicesToRender(0), DynamicSelectorUpdate(false),
 	OverrideDistanceThreshold(false), UseDefaultRotationPivot(true), ForceRecalculation(true),
+	Geomorphing(false),
 	CameraMovementDelta(10.0f), CameraRotationDelta(1.0f),CameraFOVDelta(0.1f),
 	TCoordScale1(1.0f), TCoordScale2(1.0f), SmoothFactor(0), FileSystem(fs)
 	{
@@ -603,6 +604,9 @@ namespace scene
 		calculatePatchData();
 
 		RenderBuffer->setDirty(EBT_VERTEX);
+
+		if (Geomorphing)
+			storeMorphSource();
 	}
 
 
@@ -666,6 +670,11 @@ namespace scene
 		OldCameraFOV = CameraFOV;
 
 		preRenderLODCalculations();
+
+		// before the indices, which update the triangle selector
+		if (Geomorphing)
+			preRenderMorphCalculations();
+
 		preRenderIndicesCalculations();
 	}
 
@@ -707,58 +716,62 @@ namespace scene
 	}
 
 
+	//! Rebuilds the indices of the visible patches whose level of detail or
+	//! whose neighbours' level of detail changed. Each patch has a slot of the
+	//! render buffer which fits its indices at the highest detail, the indices
+	//! of all other patches stay where they are.
 	void CTerrainSceneNode::preRenderIndicesCalculations()
 	{
 		scene::IIndexBuffer* indexBuffer = RenderBuffer->getIndexBuffer();
+		const u32 slotSize = TerrainData.CalcPatchSize * TerrainData.CalcPatchSize * 6;
+		const s32 count = TerrainData.PatchCount * TerrainData.PatchCount;
+
+		if (indexBuffer->getIndexCount() != count * slotSize)
+		{
+			indexBuffer->set_used(count * slotSize);
+			for (s32 i = 0; i < count; ++i)
+				TerrainData.Patches[i].BuiltLOD = -1;
+		}
+
 		IndicesToRender = 0;
-		indexBuffer->set_used(0);
+		u32 firstChanged = indexBuffer->getIndexCount();
+		u32 endChanged = 0;
 
 		s32 index = 0;
-		// Then generate the indices for all patches that are visible.
 		for (s32 i = 0; i < TerrainData.PatchCount; ++i)
 		{
 			for (s32 j = 0; j < TerrainData.PatchCount; ++j)
 			{
-				if (TerrainData.Patches[index].CurrentLOD >= 0)
+				SPatch& patch = TerrainData.Patches[index];
+
+				if (patch.CurrentLOD >= 0)
 				{
-					s32 x = 0;
-					s32 z = 0;
+					const s32 stitchLOD[4] = {
+						getStitchLOD(patch.Top, patch.CurrentLOD),
+						getStitchLOD(patch.Bottom, patch.CurrentLOD),
+						getStitchLOD(patch.Left, patch.CurrentLOD),
+						getStitchLOD(patch.Right, patch.CurrentLOD) };
+
+					if (patch.BuiltLOD != patch.CurrentLOD ||
+						memcmp(stitchLOD, patch.BuiltStitchLOD, sizeof(stitchLOD)) != 0)
+					{
+						buildPatchIndices(j, i, index);
 
-					// calculate the step we take this patch, based on the patches current LOD
-					const s32 step = 1 << TerrainData.Patches[index].CurrentLOD;
+						patch.BuiltLOD = patch.CurrentLOD;
+						memcpy(patch.BuiltStitchLOD, stitchLOD, sizeof(stitchLOD));
 
-					// Loop through patch and generate indices
-					while (z < TerrainData.CalcPatchSize)
-					{
-						const s32 index11 = getIndex(j, i, index, x, z);
-						const s32 index21 = getIndex(j, i, index, x + step, z);
-						const s32 index12 = getIndex(j, i, index, x, z + step);
-						const s32 index22 = getIndex(j, i, index, x + step, z + step);
-
-						indexBuffer->addIndex(index12);
-						indexBuffer->addIndex(index11);
-						indexBuffer->addIndex(index22);
-						indexBuffer->addIndex(index22);
-						indexBuffer->addIndex(index11);
-						indexBuffer->addIndex(index21);
-						IndicesToRender+=6;
-
-						// increment index position horizontally
-						x += step;
-
-						// we've hit an edge
-						if (x >= TerrainData.CalcPatchSize)
-						{
-							x = 0;
-							z += step;
-						}
+						firstChanged = core::min_(firstChanged, index * slotSize);
+						endChanged = index * slotSize + patch.IndexCount;
 					}
+
+					IndicesToRender += patch.IndexCount;
 				}
 				++index;
 			}
 		}
 
-		RenderBuffer->setDirty(EBT_INDEX);
+		if (firstChanged < endChanged)
+			indexBuffer->setDirty(firstChanged, endChanged - firstChanged);
 
 		if (DynamicSelectorUpdate && TriangleSelector)
 		{
@@ -768,6 +781,199 @@ namespace scene
 	}
 
 
+	//! writes the indices of a patch into its slot of the render buffer
+	void CTerrainSceneNode::buildPatchIndices(s32 patchX, s32 patchZ, s32 index)
+	{
+		scene::IIndexBuffer* indexBuffer = RenderBuffer->getIndexBuffer();
+		SPatch& patch = TerrainData.Patches[index];
+
+		// calculate the step we take this patch, based on the patches current LOD
+		const s32 step = 1 << patch.CurrentLOD;
+
+		u32 rv = index * TerrainData.CalcPatchSize * TerrainData.CalcPatchSize * 6;
+		const u32 first = rv;
+
+		// Loop through patch and generate indices
+		for (s32 z = 0; z < TerrainData.CalcPatchSize; z += step)
+		{
+			for (s32 x = 0; x < TerrainData.CalcPatchSize; x += step)
+			{
+				const u32 index11 = getIndex(patchX, patchZ, index, x, z);
+				const u32 index21 = getIndex(patchX, patchZ, index, x + step, z);
+				const u32 index12 = getIndex(patchX, patchZ, index, x, z + step);
+				const u32 index22 = getIndex(patchX, patchZ, index, x + step, z + step);
+
+				indexBuffer->setIndex(rv++, index12);
+				indexBuffer->setIndex(rv++, index11);
+				indexBuffer->setIndex(rv++, index22);
+				indexBuffer->setIndex(rv++, index22);
+				indexBuffer->setIndex(rv++, index11);
+				indexBuffer->setIndex(rv++, index21);
+			}
+		}
+
+		patch.IndexCount = rv - first;
+	}
+
+
+	//! level of detail a neighbour forces the border of a patch to, or -1
+	s32 CTerrainSceneNode::getStitchLOD(const SPatch* neighbour, s32 LOD) const
+	{
+		return (neighbour && neighbour->CurrentLOD > LOD) ? neighbour->CurrentLOD : -1;
+	}
+
+
+	//! Moves the vertices which the next lower level of detail drops towards the
+	//! lower detail surface, in the second half of the distance range of a level.
+	void CTerrainSceneNode::preRenderMorphCalculations()
+	{
+		const core::vector3df cameraPosition = SceneManager->getActiveCamera()->getAbsolutePosition();
+		scene::IVertexBuffer* vertexBuffer = RenderBuffer->getVertexBuffer();
+
+		if (MorphSource.size() != vertexBuffer->getVertexCount())
+			return;
+
+		u32 firstChanged = vertexBuffer->getVertexCount();
+		u32 endChanged = 0;
+
+		s32 index = 0;
+		for (s32 i = 0; i < TerrainData.PatchCount; ++i)
+		{
+			for (s32 j = 0; j < TerrainData.PatchCount; ++j)
+			{
+				SPatch& patch = TerrainData.Patches[index++];
+				const s32 lod = patch.CurrentLOD;
+				if (lod < 0)
+					continue;
+
+				f32 morph = 0.f;
+				if (lod < TerrainData.MaxLOD - 1 && (2 << lod) <= TerrainData.CalcPatchSize)
+				{
+					const f32 distance = sqrtf(cameraPosition.getDistanceFromSQ(patch.Center));
+					const f32 start = lod > 0 ? (f32)sqrt(TerrainData.LODDistanceThreshold[lod]) : 0.f;
+					const f32 end = (f32)sqrt(TerrainData.LODDistanceThreshold[lod + 1]);
+					const f32 half = (start + end) * 0.5f;
+
+					if (end > half)
+						morph = core::clamp((distance - half) / (end - half), 0.f, 1.f);
+					else
+						morph = distance >= end ? 1.f : 0.f;
+				}
+
+				if (lod == patch.MorphLOD && fabsf(morph - patch.Morph) < 0.01f)
+					continue;
+
+				morphPatch(j, i, lod, morph);
+				patch.MorphLOD = lod;
+				patch.Morph = morph;
+
+				const u32 first = (i * TerrainData.CalcPatchSize) * TerrainData.Size + j * TerrainData.CalcPatchSize;
+				firstChanged = core::min_(firstChanged, first);
+				endChanged = core::max_(endChanged, first + TerrainData.CalcPatchSize * TerrainData.Size + TerrainData.CalcPatchSize + 1);
+			}
+		}
+
+		if (firstChanged < endChanged)
+			vertexBuffer->setDirty(firstChanged, endChanged - firstChanged);
+	}
+
+
+	//! moves the vertices of a patch towards the next lower level of detail
+	void CTerrainSceneNode::morphPatch(s32 patchX, s32 patchZ, s32 LOD, f32 morph)
+	{
+		video::IVertexAttribute* attribute = RenderBuffer->getVertexDescriptor()->getAttributeBySemantic(video::EVAS_POSITION);
+
+		if (!attribute)
+			return;
+
+		u8* offset = static_cast<u8*>(RenderBuffer->getVertexBuffer()->getVertices()) + attribute->getOffset();
+		const u32 vertexSize = RenderBuffer->getVertexBuffer()->getVertexSize();
+
+		const s32 step = 1 << LOD;
+		const s32 coarseStep = step << 1;
+		const s32 size = TerrainData.Size;
+		const s32 first = patchZ * TerrainData.CalcPatchSize * size + patchX * TerrainData.CalcPatchSize;
+
+		for (s32 z = 0; z <= TerrainData.CalcPatchSize; z += step)
+		{
+			for (s32 x = 0; x <= TerrainData.CalcPatchSize; x += step)
+			{
+				const s32 v = first + z * size + x;
+				core::vector3df position = MorphSource[v];
+
+				// the lower detail interpolates along the edges and the diagonals of its quads
+				const s32 dx = (x % coarseStep) ? step : 0;
+				const s32 dz = (z % coarseStep) ? step : 0;
+				if ((dx || dz) && morph > 0.f)
+				{
+					const core::vector3df target = (MorphSource[v - dz * size - dx] + MorphSource[v + dz * size + dx]) * 0.5f;
+					position = position.getInterpolated(target, 1.f - morph);
+				}
+
+				*(core::vector3df*)(offset + vertexSize * v) = position;
+			}
+		}
+	}
+
+
+	//! copies the unmorphed vertex positions of the render buffer
+	void CTerrainSceneNode::storeMorphSource()
+	{
+		video::IVertexAttribute* attribute = RenderBuffer->getVertexDescriptor()->getAttributeBySemantic(video::EVAS_POSITION);
+
+		if (!attribute)
+			return;
+
+		const u8* offset = static_cast<const u8*>(RenderBuffer->getVertexBuffer()->getVertices()) + attribute->getOffset();
+		const u32 vertexSize = RenderBuffer->getVertexBuffer()->getVertexSize();
+		const u32 vertexCount = RenderBuffer->getVertexBuffer()->getVertexCount();
+
+		MorphSource.set_used(vertexCount);
+		for (u32 i = 0; i < vertexCount; ++i)
+			MorphSource[i] = *(const core::vector3df*)(offset + vertexSize * i);
+
+		const s32 count = TerrainData.PatchCount * TerrainData.PatchCount;
+		for (s32 i = 0; i < count; ++i)
+			TerrainData.Patches[i].MorphLOD = -1;
+	}
+
+
+	//! Enables or disables geomorphing.
+	void CTerrainSceneNode::setGeomorphing(bool enable)
+	{
+		if (Geomorphing == enable)
+			return;
+
+		Geomorphing = enable;
+
+		if (enable)
+		{
+			storeMorphSource();
+		}
+		else
+		{
+			// restore the unmorphed positions
+			video::IVertexAttribute* attribute = RenderBuffer->getVertexDescriptor()->getAttributeBySemantic(video::EVAS_POSITION);
+			const u32 vertexCount = RenderBuffer->getVertexBuffer()->getVertexCount();
+
+			if (attribute && MorphSource.size() == vertexCount)
+			{
+				u8* offset = static_cast<u8*>(RenderBuffer->getVertexBuffer()->getVertices()) + attribute->getOffset();
+				const u32 vertexSize = RenderBuffer->getVertexBuffer()->getVertexSize();
+
+				for (u32 i = 0; i < vertexCount; ++i)
+					*(core::vector3df*)(offset + vertexSize * i) = MorphSource[i];
+
+				RenderBuffer->setDirty(EBT_VERTEX);
+			}
+
+			MorphSource.clear();
+		}
+
+		ForceRecalculation = true;
+	}
+
+
 	//! Render the scene node
 	void CTerrainSceneNode::render()
 	{
@@ -782,12 +988,33 @@ namespace scene
 		driver->setTransform (video::ETS_WORLD, core::IdentityMatrix);
 		driver->setMaterial(Mesh->getMeshBuffer(0)->getMaterial());
 
-		RenderBuffer->getIndexBuffer()->set_used(IndicesToRender);
+		// draw the slots of the visible patches, neighbouring slots at once
+		const u32 slotSize = TerrainData.CalcPatchSize * TerrainData.CalcPatchSize * 6;
+		const s32 patchCount = TerrainData.PatchCount * TerrainData.PatchCount;
+		u32 first = 0;
+		u32 indexCount = 0;
 
-		// For use with geomorphing
-		driver->drawMeshBuffer(RenderBuffer);
+		for (s32 i = 0; i < patchCount; ++i)
+		{
+			const SPatch& patch = TerrainData.Patches[i];
+			if (patch.CurrentLOD < 0 || !patch.IndexCount)
+				continue;
+
+			if (indexCount && first + indexCount == i * slotSize)
+			{
+				indexCount += patch.IndexCount;
+				continue;
+			}
+
+			if (indexCount)
+				driver->drawMeshBufferRange(RenderBuffer, first, indexCount);
+
+			first = i * slotSize;
+			indexCount = patch.IndexCount;
+		}
 
-		RenderBuffer->getIndexBuffer()->set_used(RenderBuffer->getIndexBuffer()->allocated_size());
+		if (indexCount)
+			driver->drawMeshBufferRange(RenderBuffer, first, indexCount);
 
 		// for debug purposes only:
 		if (DebugDataVisible)
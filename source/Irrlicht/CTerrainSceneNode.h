@@ -199,6 +199,12 @@ namespace scene
 		//! work best with your new terrain size.
 		virtual bool overrideLODDistance( s32 LOD, f64 newDistance ) _IRR_OVERRIDE_;
 
+		//! Enables or disables geomorphing.
+		virtual void setGeomorphing(bool enable) _IRR_OVERRIDE_;
+
+		//! Check if geomorphing is enabled.
+		virtual bool isGeomorphing() const _IRR_OVERRIDE_ { return Geomorphing; }
+
 		//! Scales the two textures
 		virtual void scaleTexture(f32 scale = 1.0f, f32 scale2 = 0.0f) _IRR_OVERRIDE_;
 
@@ -223,8 +229,11 @@ namespace scene
 		struct SPatch
 		{
 			SPatch()
-			: Top(0), Bottom(0), Right(0), Left(0), CurrentLOD(-1)
+			: Top(0), Bottom(0), Right(0), Left(0), CurrentLOD(-1),
+			BuiltLOD(-1), IndexCount(0), MorphLOD(-1), Morph(0.f)
 			{
+				for (u32 i=0; i<4; ++i)
+					BuiltStitchLOD[i] = -1;
 			}
 
 			SPatch* Top;
@@ -232,6 +241,15 @@ namespace scene
 			SPatch* Right;
 			SPatch* Left;
 			s32 CurrentLOD;
+			//! level of detail of the indices in the slot of the patch
+			s32 BuiltLOD;
+			//! levels of detail of the neighbours the indices are stitched to
+			s32 BuiltStitchLOD[4];
+			//! number of indices in the slot of the patch
+			u32 IndexCount;
+			//! level of detail and factor the vertices of the patch were moved with
+			s32 MorphLOD;
+			f32 Morph;
 			core::aabbox3df BoundingBox;
 			core::vector3df Center;
 		};
@@ -263,6 +281,19 @@ namespace scene
 		void preRenderCalculationsIfNeeded();
 		void preRenderLODCalculations();
 		void preRenderIndicesCalculations();
+		void preRenderMorphCalculations();
+
+		//! writes the indices of a patch into its slot of the render buffer
+		void buildPatchIndices(s32 patchX, s32 patchZ, s32 index);
+
+		//! level of detail a neighbour forces the border of a patch to, or -1
+		s32 getStitchLOD(const SPatch* neighbour, s32 LOD) const;
+
+		//! moves the vertices of a patch towards the next lower level of detail
+		void morphPatch(s32 patchX, s32 patchZ, s32 LOD, f32 morph);
+
+		//! copies the unmorphed vertex positions of the render buffer
+		void storeMorphSource();
 
 		//! get indices when generating index data for patches at varying levels of detail.
 		u32 getIndex(const s32 PatchX, const s32 PatchZ, const s32 PatchIndex, u32 vX, u32 vZ) const;
@@ -303,6 +334,10 @@ namespace scene
 		bool OverrideDistanceThreshold;
 		bool UseDefaultRotationPivot;
 		bool ForceRecalculation;
+		bool Geomorphing;
+
+		//! unmorphed positions of the render buffer, used with geomorphing
+		core::array<core::vector3df> MorphSource;
 
 		core::vector3df	OldCameraPosition;
 		core::vector3df	OldCameraRotation;
@@ -0,0 +1,503 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CThreadPool.h"
+#include "irrMath.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
+
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+	#ifdef _IRR_XBOX_PLATFORM_
+		#include <xtl.h>
+	#else
+		#define WIN32_LEAN_AND_MEAN
+		#include <windows.h>
+	#endif
+	// condition variables need Windows Vista
+	#if !defined(_WIN32_WINNT) || (_WIN32_WINNT < 0x0600)
+		#undef _IRR_COMPILE_WITH_THREADS_
+	#endif
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
+namespace irr
+{
+
+namespace
+{
+	CThreadPool* SharedPool = 0;
+
+	// pool without worker threads while no device installed one
+	struct SSerialPool
+	{
+		SSerialPool() : Pool(0) {}
+		~SSerialPool()
+		{
+			if (Pool)
+				Pool->drop();
+		}
+
+		CThreadPool* Pool;
+	} SerialPool;
+}
+
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+
+// ----------------------------------------------------------------
+// Windows implementation
+// ----------------------------------------------------------------
+
+CMutex::CMutex()
+{
+	Handle = new CRITICAL_SECTION;
+	InitializeCriticalSection((CRITICAL_SECTION*)Handle);
+}
+
+CMutex::~CMutex()
+{
+	DeleteCriticalSection((CRITICAL_SECTION*)Handle);
+	delete (CRITICAL_SECTION*)Handle;
+}
+
+void CMutex::lock()
+{
+	EnterCriticalSection((CRITICAL_SECTION*)Handle);
+}
+
+void CMutex::unlock()
+{
+	LeaveCriticalSection((CRITICAL_SECTION*)Handle);
+}
+
+static void* createCondition()
+{
+	CONDITION_VARIABLE* c = new CONDITION_VARIABLE;
+	InitializeConditionVariable(c);
+	return c;
+}
+
+static void destroyCondition(void* c)
+{
+	delete (CONDITION_VARIABLE*)c;
+}
+
+static void waitCondition(void* c, void* mutex)
+{
+	SleepConditionVariableCS((CONDITION_VARIABLE*)c, (CRITICAL_SECTION*)mutex, INFINITE);
+}
+
+static void broadcastCondition(void* c)
+{
+	WakeAllConditionVariable((CONDITION_VARIABLE*)c);
+}
+
+struct SThreadStart
+{
+	void* (*Entry)(void*);
+	void* Data;
+};
+
+static DWORD WINAPI threadEntry(LPVOID data)
+{
+	SThreadStart start = *(SThreadStart*)data;
+	delete (SThreadStart*)data;
+	start.Entry(start.Data);
+	return 0;
+}
+
+static void* startThread(void* (*entry)(void*), void* data)
+{
+	SThreadStart* start = new SThreadStart;
+	start->Entry = entry;
+	start->Data = data;
+	HANDLE handle = CreateThread(0, 0, threadEntry, start, 0, 0);
+	if (!handle)
+		delete start;
+	return handle;
+}
+
+static void joinThread(void* handle)
+{
+	WaitForSingleObject((HANDLE)handle, INFINITE);
+	CloseHandle((HANDLE)handle);
+}
+
+u32 CThreadPool::getProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return core::max_((u32)info.dwNumberOfProcessors, 1u);
+}
+
+u64 CThreadPool::getCurrentThreadId()
+{
+	return GetCurrentThreadId();
+}
+
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+
+// ----------------------------------------------------------------
+// pthread implementation
+// ----------------------------------------------------------------
+
+CMutex::CMutex()
+{
+	Handle = new pthread_mutex_t;
+	pthread_mutex_init((pthread_mutex_t*)Handle, 0);
+}
+
+CMutex::~CMutex()
+{
+	pthread_mutex_destroy((pthread_mutex_t*)Handle);
+	delete (pthread_mutex_t*)Handle;
+}
+
+void CMutex::lock()
+{
+	pthread_mutex_lock((pthread_mutex_t*)Handle);
+}
+
+void CMutex::unlock()
+{
+	pthread_mutex_unlock((pthread_mutex_t*)Handle);
+}
+
+static void* createCondition()
+{
+	pthread_cond_t* c = new pthread_cond_t;
+	pthread_cond_init(c, 0);
+	return c;
+}
+
+static void destroyCondition(void* c)
+{
+	pthread_cond_destroy((pthread_cond_t*)c);
+	delete (pthread_cond_t*)c;
+}
+
+static void waitCondition(void* c, void* mutex)
+{
+	pthread_cond_wait((pthread_cond_t*)c, (pthread_mutex_t*)mutex);
+}
+
+static void broadcastCondition(void* c)
+{
+	pthread_cond_broadcast((pthread_cond_t*)c);
+}
+
+static void* startThread(void* (*entry)(void*), void* data)
+{
+	pthread_t* t = new pthread_t;
+	if (pthread_create(t, 0, entry, data))
+	{
+		delete t;
+		return 0;
+	}
+	return t;
+}
+
+static void joinThread(void* handle)
+{
+	pthread_join(*(pthread_t*)handle, 0);
+	delete (pthread_t*)handle;
+}
+
+u32 CThreadPool::getProcessorCount()
+{
+#if defined(_SC_NPROCESSORS_ONLN)
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 1 ? (u32)count : 1;
+#else
+	return 1;
+#endif
+}
+
+u64 CThreadPool::getCurrentThreadId()
+{
+	return (u64)(size_t)pthread_self();
+}
+
+#else
+
+// ----------------------------------------------------------------
+// no threads, everything runs on the calling thread
+// ----------------------------------------------------------------
+
+CMutex::CMutex() : Handle(0) {}
+CMutex::~CMutex() {}
+void CMutex::lock() {}
+void CMutex::unlock() {}
+
+u32 CThreadPool::getProcessorCount()
+{
+	return 1;
+}
+
+u64 CThreadPool::getCurrentThreadId()
+{
+	return 0;
+}
+
+#endif
+
+
+//! Constructor
+CThreadPool::CThreadPool(u32 threadCount)
+: WorkAvailable(0), BatchDone(0), ThreadCount(1), Quit(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CThreadPool");
+	#endif
+
+	IRR_PROFILE(
+		static bool initProfile = false;
+		if (!initProfile )
+		{
+			initProfile = true;
+			getProfiler().add(EPID_TP_JOB, L"job", L"Irrlicht threads");
+		}
+	)
+
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	if (!threadCount)
+		threadCount = getProcessorCount();
+
+	if (threadCount > 1)
+	{
+		WorkAvailable = createCondition();
+		BatchDone = createCondition();
+
+		// the calling thread is thread 0, don't move the workers once they run
+		Workers.set_used(threadCount-1);
+		for (u32 i=0; i<Workers.size(); ++i)
+		{
+			Workers[i].Pool = this;
+			Workers[i].Thread = i+1;
+			Workers[i].Handle = startThread(workerEntry, &Workers[i]);
+			if (!Workers[i].Handle)
+				break;
+			++ThreadCount;
+		}
+		Workers.set_used(ThreadCount-1);
+	}
+#endif
+}
+
+
+//! Destructor
+CThreadPool::~CThreadPool()
+{
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	if (WorkAvailable)
+	{
+		Mutex.lock();
+		Quit = true;
+		broadcastCondition(WorkAvailable);
+		Mutex.unlock();
+
+		for (u32 i=0; i<Workers.size(); ++i)
+			joinThread(Workers[i].Handle);
+
+		// queued work nobody waited for
+		for (u32 i=0; i<AsyncBatches.size(); ++i)
+			delete AsyncBatches[i];
+
+		destroyCondition(WorkAvailable);
+		destroyCondition(BatchDone);
+	}
+#endif
+}
+
+
+//! Takes the next part of a batch and executes it.
+/** Called and returns with Mutex locked. Returns false if all parts were taken already. */
+bool CThreadPool::executeNext(SBatch* batch, u32 thread)
+{
+	if (batch->Next == batch->Count)
+		return false;
+
+	const u32 index = batch->Next++;
+	if (batch->Next == batch->Count)
+		Batches.erase(Batches.linear_search(batch));
+	Mutex.unlock();
+
+	// start/stop are for the main thread only, the timeline shows the parts on all threads
+	IRR_PROFILE(getProfiler().addTimelineEvent(EPID_TP_JOB, EPET_BEGIN);)
+	batch->Job->run(index, thread);
+	IRR_PROFILE(getProfiler().addTimelineEvent(EPID_TP_JOB, EPET_END);)
+
+	Mutex.lock();
+	if (++batch->Done == batch->Count)
+	{
+		// nobody waits in run() for queued batches
+		if (batch->Async)
+		{
+			AsyncBatches.erase(AsyncBatches.linear_search(batch));
+			delete batch;
+		}
+#ifdef _IRR_COMPILE_WITH_THREADS_
+		broadcastCondition(BatchDone);
+#endif
+	}
+	return true;
+}
+
+
+//! Executes job->run for all parts and returns when they are done.
+void CThreadPool::run(IThreadJob* job, u32 count)
+{
+	if (!job || !count)
+		return;
+
+	CMutexLock caller(CallerMutex);
+
+	if (ThreadCount == 1 || count == 1)
+	{
+		for (u32 i=0; i<count; ++i)
+			job->run(i, 0);
+		return;
+	}
+
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	SBatch batch;
+	batch.Job = job;
+	batch.Count = count;
+	batch.Next = 0;
+	batch.Done = 0;
+	batch.Async = false;
+
+	Mutex.lock();
+	Batches.push_back(&batch);
+	broadcastCondition(WorkAvailable);
+
+	// help out until all parts are taken
+	while (executeNext(&batch, 0))
+	{
+	}
+
+	// wait for the parts still running on the workers
+	while (batch.Done != batch.Count)
+		waitCondition(BatchDone, Mutex.Handle);
+	Mutex.unlock();
+#endif
+}
+
+
+//! Queues all parts of a job without waiting for them.
+void CThreadPool::enqueue(IThreadJob* job, u32 count)
+{
+	if (!job || !count)
+		return;
+
+	if (ThreadCount == 1)
+	{
+		CMutexLock caller(CallerMutex);
+		for (u32 i=0; i<count; ++i)
+			job->run(i, 0);
+		return;
+	}
+
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	SBatch* batch = new SBatch;
+	batch->Job = job;
+	batch->Count = count;
+	batch->Next = 0;
+	batch->Done = 0;
+	batch->Async = true;
+
+	Mutex.lock();
+	Batches.push_back(batch);
+	AsyncBatches.push_back(batch);
+	broadcastCondition(WorkAvailable);
+	Mutex.unlock();
+#endif
+}
+
+
+//! Waits for the queued parts of a job.
+void CThreadPool::finish(IThreadJob* job)
+{
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	if (ThreadCount == 1)
+		return;
+
+	CMutexLock caller(CallerMutex);
+	Mutex.lock();
+	for (;;)
+	{
+		SBatch* batch = 0;
+		for (u32 i=0; i<AsyncBatches.size() && !batch; ++i)
+		{
+			if (AsyncBatches[i]->Job == job)
+				batch = AsyncBatches[i];
+		}
+
+		if (!batch)
+			break;
+
+		// take over parts nobody started, otherwise wait for the workers
+		if (!executeNext(batch, 0))
+			waitCondition(BatchDone, Mutex.Handle);
+	}
+	Mutex.unlock();
+#endif
+}
+
+
+void CThreadPool::workerLoop(u32 thread)
+{
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	Mutex.lock();
+	while (!Quit)
+	{
+		if (Batches.empty())
+		{
+			waitCondition(WorkAvailable, Mutex.Handle);
+			continue;
+		}
+
+		// somebody waits in run() for the first batch which isn't queued
+		SBatch* batch = Batches[0];
+		for (u32 i=1; i<Batches.size() && batch->Async; ++i)
+			batch = Batches[i];
+
+		executeNext(batch, thread);
+	}
+	Mutex.unlock();
+#endif
+}
+
+
+void* CThreadPool::workerEntry(void* data)
+{
+	SWorker* w = (SWorker*)data;
+	w->Pool->workerLoop(w->Thread);
+	return 0;
+}
+
+
+CThreadPool* CThreadPool::getSharedPool()
+{
+	if (SharedPool)
+		return SharedPool;
+
+	if (!SerialPool.Pool)
+		SerialPool.Pool = new CThreadPool(1);
+	return SerialPool.Pool;
+}
+
+
+void CThreadPool::setSharedPool(CThreadPool* pool)
+{
+	if (pool)
+		pool->grab();
+	if (SharedPool)
+		SharedPool->drop();
+	SharedPool = pool;
+}
+
+
+} // end namespace irr
@@ -0,0 +1,151 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_THREAD_POOL_H_INCLUDED__
+#define __C_THREAD_POOL_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IReferenceCounted.h"
+#include "irrArray.h"
+
+namespace irr
+{
+
+	//! A piece of work which can be split into independent parts and run by CThreadPool.
+	class IThreadJob
+	{
+	public:
+		virtual ~IThreadJob() {}
+
+		//! Executes one part of the job.
+		/** \param index Index of the part, in the range [0,count) passed to CThreadPool::run.
+		\param thread Index of the executing thread, in the range [0,CThreadPool::getThreadCount()).
+		No two parts are executed on the same thread index at the same time, so it can be
+		used to select per thread scratch data. The thread calling CThreadPool::run or
+		CThreadPool::finish is 0. */
+		virtual void run(u32 index, u32 thread) = 0;
+	};
+
+
+	//! A simple non recursive mutex.
+	class CMutex
+	{
+	public:
+		CMutex();
+		~CMutex();
+
+		void lock();
+		void unlock();
+
+	private:
+		friend class CThreadPool;
+
+		// not copyable
+		CMutex(const CMutex&);
+		CMutex& operator=(const CMutex&);
+
+		void* Handle;
+	};
+
+
+	//! Locks a mutex for the lifetime of this object.
+	class CMutexLock
+	{
+	public:
+		CMutexLock(CMutex& mutex) : Mutex(mutex) { Mutex.lock(); }
+		~CMutexLock() { Mutex.unlock(); }
+
+	private:
+		CMutexLock& operator=(const CMutexLock&);
+
+		CMutex& Mutex;
+	};
+
+
+	//! A fixed set of worker threads which executes IThreadJobs.
+	/** The engine uses one shared pool, which is created by the device from
+	SIrrlichtCreationParameters::WorkerThreads. Without _IRR_COMPILE_WITH_THREADS_
+	or with a thread count of 1 all work is done on the calling thread. */
+	class CThreadPool : public virtual IReferenceCounted
+	{
+	public:
+
+		//! Constructor
+		/** \param threadCount Number of threads including the calling thread. 0 selects
+		one thread per CPU core. */
+		CThreadPool(u32 threadCount=0);
+
+		//! Destructor, waits for the worker threads to finish.
+		virtual ~CThreadPool();
+
+		//! Returns the number of threads which can work on a job at the same time.
+		/** This includes the thread calling run(). */
+		u32 getThreadCount() const { return ThreadCount; }
+
+		//! Executes job->run(i, thread) for every i in [0,count) and returns when all parts are done.
+		/** The calling thread works on the job as well. Calls from several threads are
+		executed one after another. Must not be called from within a job. */
+		void run(IThreadJob* job, u32 count);
+
+		//! Queues job->run(i, thread) for every i in [0,count) and returns right away.
+		/** The parts are executed by the worker threads, work started by run() is
+		preferred. Without worker threads the job is executed before enqueue returns.
+		The job has to stay alive until all parts are done, see finish(). */
+		void enqueue(IThreadJob* job, u32 count);
+
+		//! Returns when all parts of the job which were queued with enqueue() are done.
+		/** Parts which weren't started yet are executed on the calling thread. Must not
+		be called from within a job. */
+		void finish(IThreadJob* job);
+
+		//! Returns the number of CPU cores, at least 1.
+		static u32 getProcessorCount();
+
+		//! Returns a number which identifies the calling thread among the running threads.
+		static u64 getCurrentThreadId();
+
+		//! Returns the pool used by the engine.
+		/** If no device installed a pool this is a pool without worker threads. */
+		static CThreadPool* getSharedPool();
+
+		//! Sets the pool used by the engine, called by the device.
+		static void setSharedPool(CThreadPool* pool);
+
+	private:
+
+		struct SBatch
+		{
+			IThreadJob* Job;
+			u32 Count;
+			u32 Next;
+			u32 Done;
+			bool Async;
+		};
+
+		bool executeNext(SBatch* batch, u32 thread);
+		void workerLoop(u32 thread);
+		static void* workerEntry(void* data);
+
+		struct SWorker
+		{
+			CThreadPool* Pool;
+			u32 Thread;
+			void* Handle;
+		};
+
+		core::array<SBatch*> Batches;
+		core::array<SBatch*> AsyncBatches;
+		core::array<SWorker> Workers;
+		CMutex Mutex;
+		// held by the thread working as thread 0
+		CMutex CallerMutex;
+		void* WorkAvailable;
+		void* BatchDone;
+		u32 ThreadCount;
+		bool Quit;
+	};
+
+} // end namespace irr
+
+#endif
@@ -19,6 +19,10 @@ CTriangleBBSelector::CTriangleBBSelector(ISceneNode* node)
 	#endif
 
 	Triangles.set_used(12); // a box has 12 triangles.
+
+	// invalid box, so the triangles are built on the first query
+	BoundingBox.MinEdge.set(1.f, 1.f, 1.f);
+	BoundingBox.MaxEdge.set(-1.f, -1.f, -1.f);
 }
 
 
@@ -31,8 +35,16 @@ void CTriangleBBSelector::getTriangles(core::triangle3df* triangles,
 	if (!SceneNode)
 		return;
 
-	// construct triangles
+	// construct triangles only when the box changed, so queries from
+	// several threads just read them as long as the node isn't modified
 	const core::aabbox3d<f32>& box = SceneNode->getBoundingBox();
+	if (box == BoundingBox)
+	{
+		CTriangleSelector::getTriangles(triangles, arraySize, outTriangleCount,	transform);
+		return;
+	}
+	BoundingBox = box;
+
 	core::vector3df edges[8];
 	box.getEdges(edges);
 
@@ -32,6 +32,14 @@ namespace video
 		ID = id;
 	}
 
+	void CVertexDescriptor::lockReferenceCount(bool lock) const
+	{
+		if (lock)
+			ReferenceMutex.lock();
+		else
+			ReferenceMutex.unlock();
+	}
+
 	IVertexAttribute* CVertexDescriptor::addAttribute(const core::stringc& name, u32 elementCount, E_VERTEX_ATTRIBUTE_SEMANTIC semantic, E_VERTEX_ATTRIBUTE_TYPE type, u32 bufferID)
 	{
 		for (u32 i = 0; i < Attribute.size(); ++i)
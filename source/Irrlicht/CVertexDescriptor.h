@@ -6,6 +6,7 @@
 #define __C_VERTEX_DESCRIPTOR_H_INCLUDED__
 
 #include "IVertexDescriptor.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -31,7 +32,11 @@ namespace video
 		virtual void clearAttribute() _IRR_OVERRIDE_;
 
 	protected:
+		virtual void lockReferenceCount(bool lock) const _IRR_OVERRIDE_;
+
 		core::array<CVertexAttribute> Attribute;
+
+		mutable CMutex ReferenceMutex;
 	};
 
 }
@@ -26,10 +26,20 @@ namespace irr
 		EPID_SM_RENDER_TRANSPARENT,
 		EPID_SM_RENDER_EFFECT,
 		EPID_SM_REGISTER,
+		EPID_SM_CULL,
+		EPID_SM_SKIN,
 
 		//! octrees
 		EPID_OC_RENDER,
-		EPID_OC_CALCPOLYS
+		EPID_OC_CALCPOLYS,
+
+		//! video driver counters
+		EPID_VD_DRAW_CALLS,
+		EPID_VD_STATE_CHANGES,
+		EPID_VD_UPLOADED_BYTES,
+
+		//! parts of jobs run by the worker threads
+		EPID_TP_JOB
     };
 #endif
 } // end namespace irr
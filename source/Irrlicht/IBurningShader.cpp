@@ -35,6 +35,9 @@ namespace video
 
 		Driver = driver;
 		RenderTarget = 0;
+		BandStart = 0;
+		BandEnd = 0x7FFFFFFF;
+		SpanFill = &getBurningSpanFill();
 		ColorMask = COLOR_BRIGHT_WHITE;
 		DepthBuffer = (CDepthBuffer*) driver->getDepthBuffer ();
 		if ( DepthBuffer )
@@ -113,6 +116,80 @@ namespace video
 		}
 	}
 
+	s32 IBurningShader::skipToBand ( sScanConvertData& scan, s32 y, u32 interpolators ) const
+	{
+		if ( y >= BandStart )
+			return y;
+
+		const s32 lines = BandStart - y;
+		s32 i;
+		u32 u;
+
+		for ( i = 0; i != lines; ++i )
+		{
+			scan.x[0] += scan.slopeX[0];
+			scan.x[1] += scan.slopeX[1];
+		}
+
+#if defined ( SOFTWARE_DRIVER_2_USE_WBUFFER ) || defined ( SOFTWARE_DRIVER_2_PERSPECTIVE_CORRECT )
+		if ( interpolators & SCAN_IPOL_W )
+		{
+			for ( i = 0; i != lines; ++i )
+			{
+				scan.w[0] += scan.slopeW[0];
+				scan.w[1] += scan.slopeW[1];
+			}
+		}
+#else
+		if ( interpolators & SCAN_IPOL_Z )
+		{
+			for ( i = 0; i != lines; ++i )
+			{
+				scan.z[0] += scan.slopeZ[0];
+				scan.z[1] += scan.slopeZ[1];
+			}
+		}
+#endif
+
+		for ( u = 0; u != MATERIAL_MAX_COLORS; ++u )
+		{
+			if ( 0 == ( interpolators & ( SCAN_IPOL_C0 << u ) ) )
+				continue;
+
+			for ( i = 0; i != lines; ++i )
+			{
+				scan.c[u][0] += scan.slopeC[u][0];
+				scan.c[u][1] += scan.slopeC[u][1];
+			}
+		}
+
+		for ( u = 0; u != BURNING_MATERIAL_MAX_TEXTURES; ++u )
+		{
+			if ( 0 == ( interpolators & ( SCAN_IPOL_T0 << u ) ) )
+				continue;
+
+			for ( i = 0; i != lines; ++i )
+			{
+				scan.t[u][0] += scan.slopeT[u][0];
+				scan.t[u][1] += scan.slopeT[u][1];
+			}
+		}
+
+		for ( u = 0; u != BURNING_MATERIAL_MAX_TANGENT; ++u )
+		{
+			if ( 0 == ( interpolators & ( SCAN_IPOL_L0 << u ) ) )
+				continue;
+
+			for ( i = 0; i != lines; ++i )
+			{
+				scan.l[u][0] += scan.slopeL[u][0];
+				scan.l[u][1] += scan.slopeL[u][1];
+			}
+		}
+
+		return BandStart;
+	}
+
 
 } // end namespace video
 } // end namespace irr
@@ -17,6 +17,7 @@
 #include "SLight.h"
 #include "SMaterial.h"
 #include "os.h"
+#include "CBurningSpanFill.h"
 
 
 namespace irr
@@ -144,6 +145,29 @@ namespace video
 
 		virtual void setMaterial ( const SBurningShaderMaterial &material ) {};
 
+		//! restricts rasterization to the scanlines [start,end)
+		/** Used by the tile binned rasterizer to let several shaders work on
+		disjoint horizontal bands of the same render target. */
+		void setScanlineBand ( s32 start, s32 end )
+		{
+			BandStart = start;
+			BandEnd = end;
+		}
+
+		//! returns false if the shader doesn't respect setScanlineBand
+		virtual bool supportsScanlineBand () const { return true; }
+
+		//! returns the texture state set by setTextureParam
+		const sInternalTexture& getTextureParam ( u32 stage ) const { return IT[stage]; }
+
+		//! sets texture state previously returned by getTextureParam
+		/** The texture is not grabbed, the caller has to keep it alive while drawing. */
+		void setTextureParamUnsafe ( u32 stage, const sInternalTexture& texture )
+		{
+			IT[stage] = texture;
+			IT[stage].Texture = 0;
+		}
+
 	protected:
 
 		CBurningVideoDriver *Driver;
@@ -155,6 +179,20 @@ namespace video
 
 		sInternalTexture IT[ BURNING_MATERIAL_MAX_TEXTURES ];
 
+		//! steps the edges of scan from scanline y down to BandStart
+		/** Adds the slopes once per skipped scanline like the scanline loop does,
+		so the band starts with exactly the values a single threaded draw has.
+		\param interpolators Or'ed eScanInterpolator bits of the members to step.
+		\return The first scanline to draw. */
+		s32 skipToBand ( sScanConvertData& scan, s32 y, u32 interpolators ) const;
+
+		// scanline band, [BandStart,BandEnd)
+		s32 BandStart;
+		s32 BandEnd;
+
+		// vectorized span fillers, entries are 0 if not supported
+		const sBurningSpanFill* SpanFill;
+
 		static const tFixPointu dithermask[ 4 * 4];
 	};
 
@@ -22,6 +22,8 @@
 #define OCTREE_BOX_BASED true
 //! bypass full invisible/visible test
 #define OCTREE_PARENTTEST
+//! sort the indices by node and draw ranges of the static buffers instead of copying visible indices
+#define OCTREE_USE_INDEX_RANGES true
 
 namespace irr
 {
@@ -46,12 +48,20 @@ public:
 		s32 MaxSize;
 	};
 
+	//! part of an index buffer sorted by sortIndices
+	struct SIndexRange
+	{
+		u32 First;
+		u32 Count;
+	};
+
 
 	//! Constructor
 	Octree(const core::array<scene::IMeshBuffer*>& meshes, const core::array<s32>& meshesMatID, s32 minimalPolysPerNode=128) :
-		IndexData(0), IndexDataCount(meshes.size()), NodeCount(0)
+		IndexData(0), IndexRanges(0), IndexDataCount(meshes.size()), NodeCount(0)
 	{
 		IndexData = new SIndexData[IndexDataCount];
+		IndexRanges = new core::array<SIndexRange>[IndexDataCount];
 
 		// construct array of all indices
 
@@ -108,11 +118,65 @@ public:
 		Root->getPolys(frustum, IndexData, 0);
 	}
 
+	//! sorts the index buffers of the meshes by node
+	/** The indices of a node are followed by the ones of its children, so
+	each subtree is one range of the index buffers. This has to be called
+	with the meshes the tree was created from before calculateRanges can be
+	used. Returns false and leaves the buffers alone if the tree does not
+	hold all indices of a buffer. */
+	bool sortIndices(const core::array<scene::IMeshBuffer*>& meshes)
+	{
+		if (meshes.size() != IndexDataCount)
+			return false;
+
+		for (u32 i=0; i!=IndexDataCount; ++i)
+		{
+			if (Root->getIndexCount(i) != meshes[i]->getIndexBuffer()->getIndexCount())
+				return false;
+		}
+
+		for (u32 i=0; i!=IndexDataCount; ++i)
+		{
+			scene::IIndexBuffer* indexBuffer = meshes[i]->getIndexBuffer();
+			indexBuffer->set_used(0);
+			Root->sortIndices(IndexDataCount, i, indexBuffer);
+			meshes[i]->setDirty(scene::EBT_INDEX);
+		}
+
+		return true;
+	}
+
+	//! collects the index ranges of all polygons partially or fully
+	//! enclosed by this bounding box, needs sorted indices.
+	void calculateRanges(const core::aabbox3d<f32>& box)
+	{
+		for (u32 i=0; i!=IndexDataCount; ++i)
+			IndexRanges[i].set_used(0);
+
+		Root->getRanges(box, IndexRanges, 0);
+	}
+
+	//! collects the index ranges of all polygons partially or fully
+	//! enclosed by a view frustum, needs sorted indices.
+	void calculateRanges(const scene::SViewFrustum& frustum)
+	{
+		for (u32 i=0; i!=IndexDataCount; ++i)
+			IndexRanges[i].set_used(0);
+
+		Root->getRanges(frustum, IndexRanges, 0);
+	}
+
 	const SIndexData* getIndexData() const
 	{
 		return IndexData;
 	}
 
+	//! returns the ranges found by calculateRanges, one array per mesh buffer
+	const core::array<SIndexRange>* getIndexRanges() const
+	{
+		return IndexRanges;
+	}
+
 	u32 getIndexDataCount() const
 	{
 		return IndexDataCount;
@@ -137,6 +201,7 @@ public:
 			delete IndexData[i].IndexBuffer;
 
 		delete [] IndexData;
+		delete [] IndexRanges;
 		delete Root;
 	}
 
@@ -447,6 +512,122 @@ private:
 					Children[i]->getPolys(frustum, idxdata,parentTest);
 		}
 
+		// counts the indices of a mesh buffer in this node and its children
+		u32 getIndexCount(u32 buffer) const
+		{
+			u32 count = 0;
+			if (IndexData && buffer < IndexData->size())
+				count = (*IndexData)[buffer].IndexBuffer.getIndexCount();
+
+			for (u32 i=0; i!=8; ++i)
+				if (Children[i])
+					count += Children[i]->getIndexCount(buffer);
+
+			return count;
+		}
+
+		// appends the indices of a mesh buffer in this node and then the
+		// ones of its children, remembering where they went
+		void sortIndices(u32 bufferCount, u32 buffer, scene::IIndexBuffer* sorted)
+		{
+			if (Ranges.size() != bufferCount)
+				Ranges.set_used(bufferCount);
+
+			SNodeRange& range = Ranges[buffer];
+			range.First = sorted->getIndexCount();
+
+			if (IndexData && buffer < IndexData->size())
+			{
+				const scene::CIndexBuffer& own = (*IndexData)[buffer].IndexBuffer;
+				for (u32 i=0; i!=own.getIndexCount(); ++i)
+					sorted->addIndex(own.getIndex(i));
+			}
+
+			range.OwnEnd = sorted->getIndexCount();
+
+			for (u32 i=0; i!=8; ++i)
+				if (Children[i])
+					Children[i]->sortIndices(bufferCount, buffer, sorted);
+
+			range.End = sorted->getIndexCount();
+		}
+
+		// collects the index ranges of polygons partially or full enclosed
+		// by this bounding box.
+		void getRanges(const core::aabbox3d<f32>& box, core::array<SIndexRange>* ranges, u32 parentTest) const
+		{
+#if defined (OCTREE_PARENTTEST )
+			// if not full inside
+			if ( parentTest != 2 )
+			{
+				// partially inside ?
+				if (!Box.intersectsWithBox(box))
+					return;
+
+				// fully inside ?
+				parentTest = Box.isFullInside(box)?2:1;
+			}
+
+			// the whole subtree is a single range
+			if ( parentTest == 2 )
+			{
+				addRanges(ranges, true);
+				return;
+			}
+#else
+			if (!Box.intersectsWithBox(box))
+				return;
+#endif
+
+			addRanges(ranges, false);
+
+			for (u32 i=0; i!=8; ++i)
+				if (Children[i])
+					Children[i]->getRanges(box, ranges, parentTest);
+		}
+
+		// collects the index ranges of polygons partially or full enclosed
+		// by the view frustum.
+		void getRanges(const scene::SViewFrustum& frustum, core::array<SIndexRange>* ranges, u32 parentTest) const
+		{
+			u32 i; // new ISO for scoping problem in some compilers
+
+			// if parent is fully inside, no further check for the children is needed
+#if defined (OCTREE_PARENTTEST )
+			if ( parentTest != 2 )
+#endif
+			{
+#if defined (OCTREE_PARENTTEST )
+				parentTest = 2;
+#endif
+				for (i=0; i!=scene::SViewFrustum::VF_PLANE_COUNT; ++i)
+				{
+					core::EIntersectionRelation3D r = Box.classifyPlaneRelation(frustum.planes[i]);
+					if ( r == core::ISREL3D_FRONT )
+						return;
+#if defined (OCTREE_PARENTTEST )
+					if ( r == core::ISREL3D_CLIPPED )
+						parentTest = 1;	// must still check children
+#endif
+				}
+			}
+
+#if defined (OCTREE_PARENTTEST )
+			// the whole subtree is a single range
+			if ( parentTest == 2 )
+			{
+				addRanges(ranges, true);
+				return;
+			}
+#endif
+
+			addRanges(ranges, false);
+
+			for (i=0; i!=8; ++i)
+				if (Children[i])
+					Children[i]->getRanges(frustum, ranges, parentTest);
+		}
+
 		//! for debug purposes only, collects the bounding boxes of the node
 		void getBoundingBoxes(const core::aabbox3d<f32>& box,
 			core::array< const core::aabbox3d<f32>* >&outBoxes) const
@@ -463,14 +644,50 @@ private:
 
 	private:
 
+		// where the indices of this node and its subtree are after sortIndices
+		struct SNodeRange
+		{
+			u32 First;
+			u32 OwnEnd;
+			u32 End;
+		};
+
+		// appends the own or the subtree range of each buffer, joining it
+		// with the last range when they touch
+		void addRanges(core::array<SIndexRange>* ranges, bool subtree) const
+		{
+			for (u32 i=0; i!=Ranges.size(); ++i)
+			{
+				const u32 first = Ranges[i].First;
+				const u32 end = subtree ? Ranges[i].End : Ranges[i].OwnEnd;
+				if (end == first)
+					continue;
+
+				core::array<SIndexRange>& bufferRanges = ranges[i];
+				if (!bufferRanges.empty() && bufferRanges.getLast().First + bufferRanges.getLast().Count == first)
+				{
+					bufferRanges.getLast().Count += end - first;
+				}
+				else
+				{
+					SIndexRange range;
+					range.First = first;
+					range.Count = end - first;
+					bufferRanges.push_back(range);
+				}
+			}
+		}
+
 		core::aabbox3df Box;
 		core::array<SIndexChunk>* IndexData;
+		core::array<SNodeRange> Ranges;
 		OctreeNode* Children[8];
 		u32 Depth;
 	};
 
 	OctreeNode* Root;
 	SIndexData* IndexData;
+	core::array<SIndexRange>* IndexRanges;
 	u32 IndexDataCount;
 	u32 NodeCount;
 };
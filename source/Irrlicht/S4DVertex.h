@@ -605,6 +605,17 @@ struct sScanConvertData
 	sVec3 slopeL[BURNING_MATERIAL_MAX_TEXTURES][2];	// tanget slope along edges
 };
 
+// interpolated members of sScanConvertData, one bit per color, texture and tangent unit
+enum eScanInterpolator
+{
+	SCAN_IPOL_Z = 0x1,
+	SCAN_IPOL_W = 0x2,
+	SCAN_IPOL_C0 = 0x4,
+	SCAN_IPOL_T0 = SCAN_IPOL_C0 << MATERIAL_MAX_COLORS,
+	SCAN_IPOL_T1 = SCAN_IPOL_T0 << 1,
+	SCAN_IPOL_L0 = SCAN_IPOL_T0 << BURNING_MATERIAL_MAX_TEXTURES
+};
+
 // passed to scan Line
 struct sScanLineData
 {
@@ -93,6 +93,14 @@
 
 #define SOFTWARE_DRIVER_2_MIPMAPPING_SCALE (8/SOFTWARE_DRIVER_2_MIPMAPPING_MAX)
 
+// vectorized span fillers, see CBurningSpanFill.h
+#if defined ( _IRR_COMPILE_WITH_SSE2_ ) && defined ( SOFTWARE_DRIVER_2_32BIT ) && \
+	defined ( SOFTWARE_DRIVER_2_BILINEAR ) && defined ( SOFTWARE_DRIVER_2_PERSPECTIVE_CORRECT ) && \
+	defined ( SOFTWARE_DRIVER_2_USE_WBUFFER ) && !defined ( BURNINGVIDEO_RENDERER_FAST ) && \
+	!defined ( __BIG_ENDIAN__ )
+	#define SOFTWARE_DRIVER_2_SIMD
+#endif
+
 #ifndef REALINLINE
 	#ifdef _MSC_VER
 		#define REALINLINE __forceinline
@@ -6,6 +6,7 @@
 #include "irrString.h"
 #include "IrrCompileConfig.h"
 #include "irrMath.h"
+#include "CThreadPool.h"
 
 #if defined(_IRR_COMPILE_WITH_SDL_DEVICE_)
 	#include <SDL/SDL_endian.h>
@@ -17,6 +18,7 @@
 	#define bswap_32(X) _byteswap_ulong(X)
 #if (_MSC_VER >= 1400)
 	#define localtime _localtime_s
+	#include <intrin.h>
 #endif
 #elif defined(_IRR_OSX_PLATFORM_)
 	#include <libkern/OSByteOrder.h>
@@ -169,31 +171,141 @@ namespace os
 {
 	// The platform independent implementation of the printer
 	ILogger* Printer::Logger = 0;
+	u64 Printer::LoggerThread = 0;
+
+	namespace
+	{
+		//! a message logged by another thread than the one of the logger
+		struct SPendingMessage
+		{
+			core::stringc Text;
+			core::stringw WideText;
+			core::stringc Hint;
+			io::path PathHint;
+			ELOG_LEVEL Level;
+			// which of the log functions was called
+			enum { TEXT, WIDE_TEXT, TEXT_HINT, TEXT_PATH_HINT } Type;
+		};
+
+		core::array<SPendingMessage> PendingMessages;
+		CMutex PendingMutex;
+
+		bool isOtherThread()
+		{
+			return Printer::LoggerThread && CThreadPool::getCurrentThreadId() != Printer::LoggerThread;
+		}
+
+		void keepMessage(const SPendingMessage& pending)
+		{
+			CMutexLock lock(PendingMutex);
+			PendingMessages.push_back(pending);
+		}
+	}
 
 	void Printer::log(const c8* message, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (!Logger)
+			return;
+
+		if (isOtherThread())
+		{
+			SPendingMessage pending;
+			pending.Text = message;
+			pending.Level = ll;
+			pending.Type = SPendingMessage::TEXT;
+			keepMessage(pending);
+		}
+		else
 			Logger->log(message, ll);
 	}
 
 	void Printer::log(const wchar_t* message, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (!Logger)
+			return;
+
+		if (isOtherThread())
+		{
+			SPendingMessage pending;
+			pending.WideText = message;
+			pending.Level = ll;
+			pending.Type = SPendingMessage::WIDE_TEXT;
+			keepMessage(pending);
+		}
+		else
 			Logger->log(message, ll);
 	}
 
 	void Printer::log(const c8* message, const c8* hint, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (!Logger)
+			return;
+
+		if (isOtherThread())
+		{
+			SPendingMessage pending;
+			pending.Text = message;
+			pending.Hint = hint;
+			pending.Level = ll;
+			pending.Type = SPendingMessage::TEXT_HINT;
+			keepMessage(pending);
+		}
+		else
 			Logger->log(message, hint, ll);
 	}
 
 	void Printer::log(const c8* message, const io::path& hint, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (!Logger)
+			return;
+
+		if (isOtherThread())
+		{
+			SPendingMessage pending;
+			pending.Text = message;
+			pending.PathHint = hint;
+			pending.Level = ll;
+			pending.Type = SPendingMessage::TEXT_PATH_HINT;
+			keepMessage(pending);
+		}
+		else
 			Logger->log(message, hint.c_str(), ll);
 	}
 
+	void Printer::flush()
+	{
+		if (isOtherThread())
+			return;
+
+		core::array<SPendingMessage> messages;
+		PendingMutex.lock();
+		messages.swap(PendingMessages);
+		PendingMutex.unlock();
+
+		if (!Logger)
+			return;
+
+		for (u32 i=0; i<messages.size(); ++i)
+		{
+			const SPendingMessage& pending = messages[i];
+			switch (pending.Type)
+			{
+			case SPendingMessage::TEXT:
+				Logger->log(pending.Text.c_str(), pending.Level);
+				break;
+			case SPendingMessage::WIDE_TEXT:
+				Logger->log(pending.WideText.c_str(), pending.Level);
+				break;
+			case SPendingMessage::TEXT_HINT:
+				Logger->log(pending.Text.c_str(), pending.Hint.c_str(), pending.Level);
+				break;
+			case SPendingMessage::TEXT_PATH_HINT:
+				Logger->log(pending.Text.c_str(), pending.PathHint.c_str(), pending.Level);
+				break;
+			}
+		}
+	}
+
 	// our Randomizer is not really os specific, so we
 	// code one for all, which should work on every platform the same,
 	// which is desireable.
@@ -341,6 +453,24 @@ namespace os
 		StartRealTime = StaticTime;
 	}
 
+	// ------------------------------------------------------
+	// processor features
+
+	bool Cpu::hasSSE2()
+	{
+#if defined(_IRR_COMPILE_WITH_SSE2_) && defined(_MSC_VER) && defined(_M_IX86)
+		// 32bit code can run on processors without SSE2
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+#elif defined(_IRR_COMPILE_WITH_SSE2_)
+		// the compiler generates SSE2 code anyway
+		return true;
+#else
+		return false;
+#endif
+	}
+
 } // end namespace os
 } // end namespace irr
 
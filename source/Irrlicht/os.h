@@ -39,7 +39,17 @@ namespace os
 		static void log(const wchar_t* message, ELOG_LEVEL ll = ELL_INFORMATION);
 		static void log(const c8* message, const c8* hint, ELOG_LEVEL ll = ELL_INFORMATION);
 		static void log(const c8* message, const io::path& hint, ELOG_LEVEL ll = ELL_INFORMATION);
+
+		//! passes the messages logged by other threads to the logger
+		/** Messages of other threads than LoggerThread are kept until this is
+		called on LoggerThread, so the logger and the event receiver are only
+		called on the thread of the device. */
+		static void flush();
+
 		static ILogger* Logger;
+
+		//! the thread which may call the logger
+		static u64 LoggerThread;
 	};
 
 
@@ -123,6 +133,16 @@ namespace os
 		static u32 StaticTime;
 	};
 
+
+	class Cpu
+	{
+	public:
+
+		//! returns true if SSE2 code paths can be used
+		/** Always false without _IRR_COMPILE_WITH_SSE2_ */
+		static bool hasSSE2();
+	};
+
 } // end namespace os
 } // end namespace irr
 
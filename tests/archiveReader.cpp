@@ -95,6 +95,22 @@ bool testArchive(IFileSystem* fs, const io::path& archiveName)
 	const char* basenames[] = {"test.txt", "myfile.txt", "myfile.txt"};
 	const char* content[] = {"Hello world!", "1est\n", "2est"};
 
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+	// the entries of a packed archive point into the mapping of the archive
+	long archiveSize = 0;
+	if (fs->getFileArchive(fs->getFileArchiveCount()-1)->getType() != EFAT_FOLDER)
+	{
+		IReadFile* archiveFile = fs->createAndOpenFile(archiveName);
+		if (archiveFile)
+		{
+			archiveSize = archiveFile->getSize();
+			archiveFile->drop();
+		}
+	}
+	const c8* dataBegin = 0;
+	const c8* dataEnd = 0;
+#endif
+
 	for (u32 i=0; i<3; ++i)
 	{
 		if (!fs->existFile(names[i]))
@@ -132,9 +148,53 @@ bool testArchive(IFileSystem* fs, const io::path& archiveName)
 			readFile->drop();
 			return false;
 		}
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+		// all these files are stored uncompressed and can be read in place
+		const c8* data = (const c8*)readFile->getData();
+		if (!data || strncmp(data, content[i], strlen(content[i])))
+		{
+			logTestString("Data of %s is not in memory\n", names[i]);
+			while (fs->getFileArchiveCount())
+				fs->removeFileArchive(fs->getFileArchiveCount()-1);
+			readFile->drop();
+			return false;
+		}
+
+		if (archiveSize)
+		{
+			// opened again, the entry is not copied
+			IReadFile* again = fs->createAndOpenFile(names[i]);
+			const bool shared = again && again->getData() == data;
+			if (again)
+				again->drop();
+			if (!shared)
+			{
+				logTestString("Data of %s is copied\n", names[i]);
+				while (fs->getFileArchiveCount())
+					fs->removeFileArchive(fs->getFileArchiveCount()-1);
+				readFile->drop();
+				return false;
+			}
+
+			if (!dataBegin || data < dataBegin)
+				dataBegin = data;
+			if (data + readFile->getSize() > dataEnd)
+				dataEnd = data + readFile->getSize();
+		}
+#endif
 		readFile->drop();
 	}
 
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+	if (archiveSize && dataEnd - dataBegin > archiveSize)
+	{
+		logTestString("Data of the entries is not inside of %s\n", archiveName.c_str());
+		while (fs->getFileArchiveCount())
+			fs->removeFileArchive(fs->getFileArchiveCount()-1);
+		return false;
+	}
+#endif
+
 	if (!fs->removeFileArchive(fs->getFileArchiveCount()-1))
 	{
 		logTestString("Couldn't remove archive.\n");
@@ -0,0 +1,213 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+
+namespace
+{
+
+const c8* const CorruptName = "assetRequestCorrupt.jpg";
+
+// counts the log messages which arrive while the main thread doesn't update the engine
+class CLogReceiver : public IEventReceiver
+{
+public:
+	CLogReceiver() : Idle(false), Logged(0), LoggedIdle(0) {}
+
+	virtual bool OnEvent(const SEvent& event)
+	{
+		if (event.EventType == EET_LOG_TEXT_EVENT)
+		{
+			++Logged;
+			if (Idle)
+				++LoggedIdle;
+		}
+		return false;
+	}
+
+	bool Idle;
+	u32 Logged;
+	u32 LoggedIdle;
+};
+
+bool testRequests(u32 workerThreads)
+{
+	CLogReceiver receiver;
+
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = dimension2d<u32>(160, 120);
+	params.WorkerThreads = workerThreads;
+	params.EventReceiver = &receiver;
+
+	IrrlichtDevice * device = createDeviceEx(params);
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	const io::path textureNames[] = { "../media/001shot.jpg", "../media/002shot.jpg",
+		"../media/fire.bmp", "../media/faerie2.bmp" };
+	const u32 textureCount = sizeof(textureNames) / sizeof(textureNames[0]);
+
+	io::IAssetRequest* textures[textureCount];
+	for (u32 i = 0; i < textureCount; ++i)
+		textures[i] = driver->requestTexture(textureNames[i]);
+
+	io::IAssetRequest* mesh = smgr->requestMesh("../media/faerie.md2");
+
+	// parsed on a worker thread, its textures are requested afterwards
+	io::IAssetRequest* texturedMesh = smgr->requestMesh("../media/dwarf.x");
+
+	// the jpeg loader logs an error on a worker thread
+	io::IWriteFile* corruptFile = device->getFileSystem()->createAndWriteFile(CorruptName);
+	assert_log(corruptFile);
+	if (corruptFile)
+	{
+		corruptFile->write("not a jpeg file", 15);
+		corruptFile->drop();
+	}
+	receiver.Idle = true;
+	io::IAssetRequest* corrupt = driver->requestTexture(CorruptName);
+
+	// long enough for the workers to decode the file
+	device->sleep(200);
+	receiver.Idle = false;
+
+	bool result = true;
+
+	// files which can't be opened fail right away
+	io::IAssetRequest* missing = driver->requestTexture("../media/missing.png");
+	result &= (missing->getState() == io::EARS_FAILED && !missing->getTexture());
+	missing->drop();
+	missing = smgr->requestMesh("../media/missing.md2");
+	result &= (missing->getState() == io::EARS_FAILED && !missing->getMesh());
+	missing->drop();
+
+	// at least one request is finished per frame
+	for (u32 frame = 0; frame < textureCount + 1000; ++frame)
+	{
+		bool finished = mesh->isFinished() && texturedMesh->isFinished();
+		for (u32 i = 0; i < textureCount; ++i)
+			finished &= textures[i]->isFinished();
+		if (finished)
+			break;
+
+		device->run();
+		driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		smgr->drawAll();
+		driver->endScene();
+		device->sleep(1);
+	}
+
+	// passed on to the receiver on the main thread only
+	for (u32 frame = 0; frame < 1000 && !corrupt->isFinished(); ++frame)
+	{
+		driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		driver->endScene();
+		device->sleep(1);
+	}
+	if (corrupt->getState() != io::EARS_FAILED || receiver.LoggedIdle || !receiver.Logged)
+	{
+		logTestString("Logged %u of %u messages while the main thread was idle\n", receiver.LoggedIdle, receiver.Logged);
+		result = false;
+	}
+	corrupt->drop();
+	remove(CorruptName);
+
+	for (u32 i = 0; i < textureCount; ++i)
+	{
+		if (textures[i]->getState() != io::EARS_READY || !textures[i]->getTexture())
+		{
+			logTestString("Texture %s wasn't loaded\n", textureNames[i].c_str());
+			result = false;
+			continue;
+		}
+
+		// the texture is in the cache under the same name as with getTexture
+		const u32 count = driver->getTextureCount();
+		if (driver->getTexture(textureNames[i]) != textures[i]->getTexture() || count != driver->getTextureCount())
+		{
+			logTestString("Texture %s isn't in the cache\n", textureNames[i].c_str());
+			result = false;
+		}
+	}
+
+	if (mesh->getState() != io::EARS_READY || mesh->getMesh() != smgr->getMesh("../media/faerie.md2"))
+	{
+		logTestString("Mesh wasn't loaded\n");
+		result = false;
+	}
+
+	if (texturedMesh->getState() != io::EARS_READY || texturedMesh->getMesh() != smgr->getMesh("../media/dwarf.x"))
+	{
+		logTestString("Textured mesh wasn't loaded\n");
+		result = false;
+	}
+	else
+	{
+		// the materials use the cached textures, not the placeholders of the worker thread
+		u32 textured = 0;
+		scene::IAnimatedMesh* dwarf = texturedMesh->getMesh();
+		for (u32 i = 0; i < dwarf->getMeshBufferCount(); ++i)
+		{
+			video::ITexture* texture = dwarf->getMeshBuffer(i)->getMaterial().getTexture(0);
+			if (!texture)
+				continue;
+
+			++textured;
+			if (driver->findTexture(texture->getName().getPath()) != texture)
+			{
+				logTestString("Texture %s of the mesh isn't in the cache\n", texture->getName().getPath().c_str());
+				result = false;
+			}
+		}
+		if (!textured)
+		{
+			logTestString("Textured mesh has no textures\n");
+			result = false;
+		}
+	}
+
+	// cached assets are ready right away
+	io::IAssetRequest* cached = driver->requestTexture(textureNames[0]);
+	result &= (cached->getTexture() == textures[0]->getTexture());
+	cached->drop();
+	cached = smgr->requestMesh("../media/faerie.md2");
+	result &= (cached->getMesh() == mesh->getMesh());
+	cached->drop();
+
+	for (u32 i = 0; i < textureCount; ++i)
+		textures[i]->drop();
+	mesh->drop();
+	texturedMesh->drop();
+
+	// requests still loading when the device goes away just fail
+	io::IAssetRequest* pending = driver->requestTexture("../media/003shot.jpg");
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= (pending->getState() == io::EARS_FAILED);
+	pending->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that textures and meshes requested in the background end up in the
+caches, with and without worker threads, and that the messages logged while
+loading reach the event receiver on the main thread. */
+bool assetRequests(void)
+{
+	bool result = testRequests(4);
+	result &= testRequests(1);
+	return result;
+}
@@ -7,6 +7,159 @@ using namespace irr;
 using namespace scene;
 using namespace video;
 
+//! Renders a scene with several materials and returns a screenshot of it
+static video::IImage* renderTestScene(bool multithreaded)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	params.DriverMultithreaded = multithreaded;
+	params.WorkerThreads = multithreaded ? 4 : 1;
+
+	IrrlichtDevice *device = createDeviceEx(params);
+	if (!device)
+		return 0;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	ITexture* texture = driver->getTexture("../media/sydney.bmp");
+
+	IAnimatedMeshSceneNode* sydney = smgr->addAnimatedMeshSceneNode(smgr->getMesh("../media/sydney.md2"));
+	if (sydney)
+	{
+		sydney->setPosition(core::vector3df(0.f, 0.f, 40.f));
+		sydney->setMaterialFlag(video::EMF_LIGHTING, false);
+		sydney->setMaterialTexture(0, texture);
+		sydney->setAnimationSpeed(0.f);
+	}
+
+	// clipped by the near plane
+	ISceneNode* cube = smgr->addCubeSceneNode(30.f, 0, -1, core::vector3df(-12.f, 5.f, 8.f),
+		core::vector3df(30.f, 45.f, 0.f));
+	cube->setMaterialFlag(video::EMF_LIGHTING, false);
+	cube->setMaterialTexture(0, texture);
+
+	ISceneNode* sphere = smgr->addSphereSceneNode(12.f, 32, 0, -1, core::vector3df(15.f, -5.f, 30.f));
+	sphere->setMaterialFlag(video::EMF_LIGHTING, false);
+	sphere->setMaterialTexture(0, texture);
+	sphere->setMaterialType(video::EMT_TRANSPARENT_ADD_COLOR);
+
+	ISceneNode* plane = smgr->addCubeSceneNode(10.f, 0, -1, core::vector3df(0.f, -20.f, 30.f),
+		core::vector3df(0.f, 0.f, 0.f), core::vector3df(10.f, 0.1f, 10.f));
+	plane->setMaterialFlag(video::EMF_LIGHTING, false);
+
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 5.f, -10.f), core::vector3df(0.f, 0.f, 30.f));
+
+	video::IImage* screenshot = 0;
+	device->run();
+	if (driver->beginScene(true, true, video::SColor(255, 80, 80, 80)))
+	{
+		smgr->drawAll();
+		driver->draw2DRectangle(video::SColor(128, 255, 0, 0), core::recti(10, 10, 50, 50));
+		screenshot = driver->createScreenShot();
+		driver->endScene();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return screenshot;
+}
+
+
+/** The tile binned rasterizer has to render the same pixels as the single threaded one */
+static bool multithreadedRasterizer()
+{
+	video::IImage* single = renderTestScene(false);
+	video::IImage* binned = renderTestScene(true);
+
+	bool result = single && binned &&
+		single->getDimension() == binned->getDimension() &&
+		single->getImageDataSizeInBytes() == binned->getImageDataSizeInBytes() &&
+		0 == memcmp(single->lock(), binned->lock(), single->getImageDataSizeInBytes());
+
+	if (!result)
+		logTestString("Multithreaded rasterizer differs from the single threaded one.\n");
+
+	if (single)
+		single->drop();
+	if (binned)
+		binned->drop();
+
+	return result;
+}
+
+
+/** The vectorized span fillers have to write the same pixels as the scalar
+loops. The reference image was rendered with NO_IRR_COMPILE_WITH_SSE2_. */
+static bool spanFillers()
+{
+	IrrlichtDevice *device = createDevice(video::EDT_BURNINGSVIDEO, core::dimension2du(160, 120), 32);
+	if (!device)
+		return false;
+
+	IVideoDriver* driver = device->getVideoDriver();
+
+	// one material per cell, all are drawn with perspective correct texture coordinates
+	const E_MATERIAL_TYPE types[] = { EMT_SOLID, EMT_SOLID, EMT_LIGHTMAP,
+		EMT_LIGHTMAP_M2, EMT_LIGHTMAP_M4, EMT_LIGHTMAP_M4 };
+
+	SMaterial material;
+	material.Lighting = false;
+	material.setTexture(0, driver->getTexture("../media/wall.bmp"));
+	material.setTexture(1, driver->getTexture("../media/lightFalloff.png"));
+
+	core::matrix4 projection;
+	projection.buildProjectionMatrixPerspectiveFovLH(core::HALF_PI, 4.f / 3.f, 1.f, 100.f);
+
+	bool result = false;
+	device->run();
+	if (driver->beginScene(true, true, video::SColor(255, 80, 80, 80)))
+	{
+		driver->setTransform(ETS_PROJECTION, projection);
+		driver->setTransform(ETS_VIEW, core::IdentityMatrix);
+		driver->setTransform(ETS_WORLD, core::IdentityMatrix);
+
+		for (u32 i = 0; i < 6; ++i)
+		{
+			material.MaterialType = types[i];
+			// every second cell without filtering
+			material.TextureLayer[0].BilinearFilter = i % 2 == 0;
+			material.TextureLayer[1].BilinearFilter = i % 2 == 0;
+			driver->setMaterial(material);
+
+			// tilted away from the camera, odd widths leave pixels for the scalar loop
+			const f32 x = -25.f + (i % 3) * 17.f;
+			const f32 y = i < 3 ? 18.f : -1.f;
+			CMeshBuffer<S3DVertex2TCoords>* buffer = new CMeshBuffer<S3DVertex2TCoords>(driver->getVertexDescriptor(1));
+			S3DVertex2TCoords v[4];
+			v[0] = S3DVertex2TCoords(x, y, 30.f, SColor(255, 255, 255, 255), 0.f, 0.f, 0.f, 0.f);
+			v[1] = S3DVertex2TCoords(x + 15.3f, y, 30.f, SColor(255, 255, 128, 0), 3.f, 0.f, 1.f, 0.f);
+			v[2] = S3DVertex2TCoords(x + 15.3f, y - 16.f, 15.f, SColor(255, 0, 255, 128), 3.f, 2.f, 1.f, 1.f);
+			v[3] = S3DVertex2TCoords(x, y - 16.f, 15.f, SColor(255, 128, 0, 255), 0.f, 2.f, 0.f, 1.f);
+			const u16 indices[] = { 0, 1, 2, 0, 2, 3 };
+			for (u32 j = 0; j < 4; ++j)
+				buffer->getVertexBuffer()->addVertex(&v[j]);
+			for (u32 j = 0; j < 6; ++j)
+				buffer->getIndexBuffer()->addIndex(indices[j]);
+			driver->drawMeshBuffer(buffer);
+			buffer->drop();
+		}
+
+		driver->endScene();
+		result = takeScreenshotAndCompareAgainstReference(driver, "-spanFillers.png", 100.f);
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+
 /** Tests the Burning Video driver */
 bool burningsVideo(void)
 {
@@ -36,5 +189,8 @@ bool burningsVideo(void)
 	device->run();
     device->drop();
 
+	result &= multithreadedRasterizer();
+	result &= spanFillers();
+
     return result;
 }
@@ -0,0 +1,265 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 12345;
+
+f32 random(f32 range)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return ((Seed >> 8) & 0xffff) / 65535.f * 2.f * range - range;
+}
+
+// triangles of all sizes and orientations lying around in a cube
+IMesh* createTriangleSoup(ISceneManager* smgr, u32 triangleCount)
+{
+	CMeshBuffer<video::S3DVertex>* buffer = new CMeshBuffer<video::S3DVertex>(smgr->getVideoDriver()->getVertexDescriptor(0));
+
+	for (u32 i = 0; i < triangleCount; ++i)
+	{
+		const vector3df center(random(50.f), random(50.f), random(50.f));
+		const f32 size = i % 10 ? 2.f : 10.f;
+		for (u32 j = 0; j < 3; ++j)
+		{
+			const video::S3DVertex vertex(center + vector3df(random(size), random(size), random(size)),
+				vector3df(0, 1, 0), video::SColor(255, 255, 255, 255), vector2df(0, 0));
+			buffer->getVertexBuffer()->addVertex(&vertex);
+			buffer->getIndexBuffer()->addIndex(i * 3 + j);
+		}
+	}
+	buffer->recalculateBoundingBox();
+
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(buffer);
+	mesh->recalculateBoundingBox();
+	buffer->drop();
+
+	return mesh;
+}
+
+bool compareRays(ISceneCollisionManager* collisionManager, ITriangleSelector* expectedSelector,
+	ITriangleSelector* selector, u32 rayCount, const c8* name, bool checkNodes)
+{
+	bool result = true;
+	u32 hits = 0;
+
+	for (u32 i = 0; i < rayCount; ++i)
+	{
+		line3df ray(random(80.f), random(80.f), random(80.f), random(80.f), random(80.f), random(80.f));
+		// some lines parallel to the axes
+		if (i % 7 == 0)
+			ray.end.set(ray.start.X, ray.start.Y, ray.end.Z);
+
+		vector3df expectedPoint, point;
+		triangle3df expectedTriangle, triangle;
+		ISceneNode* expectedNode = 0;
+		ISceneNode* node = 0;
+
+		const bool expectedHit = collisionManager->getCollisionPoint(ray, expectedSelector, expectedPoint, expectedTriangle, expectedNode);
+		const bool hit = collisionManager->getCollisionPoint(ray, selector, point, triangle, node);
+
+		if (hit != expectedHit)
+		{
+			// only lines touching an edge may be treated differently
+			if (!expectedHit || expectedPoint.getDistanceFrom(ray.start) > 0.001f)
+			{
+				logTestString("%s: ray %u hit %d, expected %d\n", name, i, hit, expectedHit);
+				result = false;
+			}
+			continue;
+		}
+
+		if (!hit)
+			continue;
+		++hits;
+
+		const f32 distance = point.getDistanceFrom(ray.start);
+		const f32 expectedDistance = expectedPoint.getDistanceFrom(ray.start);
+		if (!equals(distance, expectedDistance, 0.01f) || !node || (checkNodes && node != expectedNode)
+			|| fabs(triangle.getPlane().getDistanceTo(point)) > 0.01f)
+		{
+			logTestString("%s: ray %u hit at distance %f, expected %f\n", name, i, distance, expectedDistance);
+			result = false;
+		}
+	}
+
+	if (hits < rayCount / 10)
+	{
+		logTestString("%s: only %u of %u rays hit something\n", name, hits, rayCount);
+		result = false;
+	}
+
+	return result;
+}
+
+// lines through the bounding box of an animated node, for each of some frames
+bool compareAnimatedRays(ISceneCollisionManager* collisionManager, IAnimatedMeshSceneNode* node,
+	ITriangleSelector* expectedSelector, ITriangleSelector* selector)
+{
+	const f32 frames[] = { 0.f, 10.f, 11.f, 40.f, 90.f, 3.f };
+	bool result = true;
+
+	for (u32 f = 0; f < sizeof(frames) / sizeof(frames[0]); ++f)
+	{
+		node->setCurrentFrame(frames[f]);
+		const aabbox3df box = node->getTransformedBoundingBox();
+		const vector3df center = box.getCenter();
+		const vector3df extent = box.getExtent();
+		u32 hits = 0;
+
+		for (u32 i = 0; i < 300; ++i)
+		{
+			const vector3df offset(random(100.f), random(100.f), random(100.f));
+			const vector3df target(center.X + random(extent.X * 0.5f), center.Y + random(extent.Y * 0.5f), center.Z + random(extent.Z * 0.5f));
+			const line3df ray(target + offset, target - offset);
+
+			vector3df expectedPoint, point;
+			triangle3df expectedTriangle, triangle;
+			ISceneNode* expectedNode = 0;
+			ISceneNode* hitNode = 0;
+
+			const bool expectedHit = collisionManager->getCollisionPoint(ray, expectedSelector, expectedPoint, expectedTriangle, expectedNode);
+			const bool hit = collisionManager->getCollisionPoint(ray, selector, point, triangle, hitNode);
+			if (hit != expectedHit || (hit && (!equals(point.getDistanceFrom(ray.start), expectedPoint.getDistanceFrom(ray.start), 0.01f) || hitNode != expectedNode)))
+			{
+				logTestString("Animated: frame %f ray %u hit %d, expected %d\n", frames[f], i, hit, expectedHit);
+				result = false;
+			}
+			if (hit)
+				++hits;
+		}
+
+		if (hits < 30)
+		{
+			logTestString("Animated: frame %f only %u rays hit something\n", frames[f], hits);
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+bool compareBoxes(ITriangleSelector* expectedSelector, ITriangleSelector* selector, u32 boxCount)
+{
+	array<triangle3df> triangles;
+	triangles.set_used(selector->getTriangleCount());
+	bool result = true;
+
+	for (u32 i = 0; i < boxCount; ++i)
+	{
+		aabbox3df box(vector3df(random(60.f), random(60.f), random(60.f)));
+		box.addInternalPoint(random(60.f), random(60.f), random(60.f));
+
+		s32 expectedCount = 0;
+		s32 count = 0;
+		expectedSelector->getTriangles(triangles.pointer(), triangles.size(), expectedCount, box);
+		selector->getTriangles(triangles.pointer(), triangles.size(), count, box);
+
+		if (count != expectedCount)
+		{
+			logTestString("Box %u has %d triangles, expected %d\n", i, count, expectedCount);
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that the BVH triangle selector finds the same nearest triangles for lines
+as the plain triangle selector, also for transformed nodes, in meta selectors and
+refitted for the frames of animated nodes. */
+bool bvhTriangleSelector(void)
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	ISceneCollisionManager* collisionManager = smgr->getSceneCollisionManager();
+
+	IMesh* soup = createTriangleSoup(smgr, 3000);
+	IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(20.f, 32, 32);
+
+	IMeshSceneNode* soupNode = smgr->addMeshSceneNode(soup);
+	IMeshSceneNode* sphereNode = smgr->addMeshSceneNode(sphere, 0, -1,
+		vector3df(10.f, -5.f, 3.f), vector3df(20.f, 45.f, 0.f), vector3df(1.f, 0.5f, 2.f));
+	soupNode->updateAbsolutePosition();
+	sphereNode->updateAbsolutePosition();
+
+	ITriangleSelector* soupPlain = smgr->createTriangleSelector(soup, soupNode);
+	ITriangleSelector* soupBVH = smgr->createBVHTriangleSelector(soup, soupNode);
+	ITriangleSelector* spherePlain = smgr->createTriangleSelector(sphere, sphereNode);
+	ITriangleSelector* sphereBVH = smgr->createBVHTriangleSelector(sphere, sphereNode);
+
+	bool result = soupBVH->hasIntersectionWithLine() && !soupPlain->hasIntersectionWithLine();
+	result &= (soupBVH->getTriangleCount() == soupPlain->getTriangleCount());
+
+	result &= compareRays(collisionManager, soupPlain, soupBVH, 2000, "Soup", true);
+	result &= compareRays(collisionManager, spherePlain, sphereBVH, 2000, "Sphere", true);
+	result &= compareBoxes(soupPlain, soupBVH, 200);
+	result &= compareBoxes(spherePlain, sphereBVH, 200);
+
+	// the meta selector doesn't know the nodes of the triangles returned for lines
+	IMetaTriangleSelector* metaPlain = smgr->createMetaTriangleSelector();
+	metaPlain->addTriangleSelector(soupPlain);
+	metaPlain->addTriangleSelector(spherePlain);
+
+	// with only BVH selectors the meta selector walks them itself
+	IMetaTriangleSelector* metaBVH = smgr->createMetaTriangleSelector();
+	metaBVH->addTriangleSelector(soupBVH);
+	metaBVH->addTriangleSelector(sphereBVH);
+	result &= metaBVH->hasIntersectionWithLine();
+	result &= compareRays(collisionManager, metaPlain, metaBVH, 1000, "Meta", false);
+
+	// mixed collections are split up by the collision manager
+	IMetaTriangleSelector* metaMixed = smgr->createMetaTriangleSelector();
+	metaMixed->addTriangleSelector(soupBVH);
+	metaMixed->addTriangleSelector(spherePlain);
+	result &= !metaMixed->hasIntersectionWithLine();
+	result &= compareRays(collisionManager, metaPlain, metaMixed, 1000, "Mixed", false);
+
+	// the hierarchy of an animated node is refitted for each frame
+	IAnimatedMeshSceneNode* animatedNode = smgr->addAnimatedMeshSceneNode(smgr->getMesh("../media/sydney.md2"),
+		0, -1, vector3df(-10.f, 0.f, 5.f), vector3df(0.f, 60.f, 0.f));
+	assert_log(animatedNode);
+	if (animatedNode)
+	{
+		animatedNode->setAnimationSpeed(0.f);
+		animatedNode->updateAbsolutePosition();
+		ITriangleSelector* animatedPlain = smgr->createTriangleSelector(animatedNode);
+		ITriangleSelector* animatedBVH = smgr->createBVHTriangleSelector(animatedNode);
+		result &= animatedBVH->hasIntersectionWithLine();
+		result &= compareAnimatedRays(collisionManager, animatedNode, animatedPlain, animatedBVH);
+		animatedPlain->drop();
+		animatedBVH->drop();
+	}
+	else
+		result = false;
+
+	metaPlain->drop();
+	metaBVH->drop();
+	metaMixed->drop();
+	soupPlain->drop();
+	soupBVH->drop();
+	spherePlain->drop();
+	sphereBVH->drop();
+	soup->drop();
+	sphere->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
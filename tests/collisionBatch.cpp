@@ -0,0 +1,168 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 4321;
+
+f32 random(f32 range)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return ((Seed >> 8) & 0xffff) / 65535.f * 2.f * range - range;
+}
+
+bool compareRays(ISceneCollisionManager* collisionManager, ITriangleSelector* selector, const c8* name)
+{
+	const u32 rayCount = 1000;
+	array<line3df> rays;
+	array<SCollisionHit> hits;
+	hits.set_used(rayCount);
+	for (u32 i = 0; i < rayCount; ++i)
+		rays.push_back(line3df(random(60.f), random(60.f), random(60.f), random(60.f), random(60.f), random(60.f)));
+
+	collisionManager->getCollisionPoints(rays.const_pointer(), rayCount, selector, hits.pointer());
+
+	bool result = true;
+	u32 hitCount = 0;
+	for (u32 i = 0; i < rayCount; ++i)
+	{
+		vector3df point;
+		triangle3df triangle;
+		ISceneNode* node = 0;
+		const bool hit = collisionManager->getCollisionPoint(rays[i], selector, point, triangle, node);
+
+		if (hit != hits[i].Hit || (hit && (!point.equals(hits[i].Point) || node != hits[i].Node)))
+		{
+			logTestString("%s: ray %u differs in batch\n", name, i);
+			result = false;
+		}
+		if (hit)
+			++hitCount;
+	}
+
+	if (hitCount < rayCount / 10)
+	{
+		logTestString("%s: only %u of %u rays hit something\n", name, hitCount, rayCount);
+		result = false;
+	}
+
+	return result;
+}
+
+bool compareEllipsoids(ISceneCollisionManager* collisionManager, ITriangleSelector* selector, const c8* name)
+{
+	const u32 ellipsoidCount = 500;
+	array<SCollisionEllipsoid> ellipsoids;
+	ellipsoids.set_used(ellipsoidCount);
+	for (u32 i = 0; i < ellipsoidCount; ++i)
+	{
+		SCollisionEllipsoid& ellipsoid = ellipsoids[i];
+		ellipsoid.Position.set(random(40.f), random(40.f), random(40.f));
+		ellipsoid.Radius.set(1.f, 2.f, 1.f);
+		ellipsoid.DirectionAndSpeed.set(random(20.f), random(20.f), random(20.f));
+		ellipsoid.Gravity.set(0.f, -1.f, 0.f);
+	}
+
+	collisionManager->getCollisionResultPositions(ellipsoids.pointer(), ellipsoidCount, selector);
+
+	bool result = true;
+	u32 hitCount = 0;
+	for (u32 i = 0; i < ellipsoidCount; ++i)
+	{
+		const SCollisionEllipsoid& ellipsoid = ellipsoids[i];
+		triangle3df triangle;
+		vector3df hitPosition;
+		bool falling = false;
+		ISceneNode* node = 0;
+		const vector3df position = collisionManager->getCollisionResultPosition(selector,
+			ellipsoid.Position, ellipsoid.Radius, ellipsoid.DirectionAndSpeed,
+			triangle, hitPosition, falling, node, ellipsoid.SlidingSpeed, ellipsoid.Gravity);
+
+		if (!position.equals(ellipsoid.ResultPosition) || falling != ellipsoid.Falling || node != ellipsoid.Node)
+		{
+			logTestString("%s: ellipsoid %u differs in batch\n", name, i);
+			result = false;
+		}
+		if (node)
+			++hitCount;
+	}
+
+	if (hitCount == 0)
+	{
+		logTestString("%s: no ellipsoid collided\n", name);
+		result = false;
+	}
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that batched line and ellipsoid queries, which run on several threads,
+give the same results as the single queries. */
+bool collisionBatch(void)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = dimension2d<u32>(160, 120);
+	params.WorkerThreads = 4;
+	IrrlichtDevice * device = createDeviceEx(params);
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	ISceneCollisionManager* collisionManager = smgr->getSceneCollisionManager();
+
+	IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(30.f, 32, 32);
+	IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(vector3df(20.f, 20.f, 20.f));
+
+	IMeshSceneNode* sphereNode = smgr->addMeshSceneNode(sphere, 0, -1,
+		vector3df(5.f, 0.f, -3.f), vector3df(10.f, 30.f, 0.f), vector3df(1.f, 0.5f, 1.5f));
+	IMeshSceneNode* cubeNode = smgr->addMeshSceneNode(cube, 0, -1, vector3df(-20.f, 10.f, 20.f));
+	sphereNode->updateAbsolutePosition();
+	cubeNode->updateAbsolutePosition();
+
+	ITriangleSelector* spherePlain = smgr->createTriangleSelector(sphere, sphereNode);
+	ITriangleSelector* sphereBVH = smgr->createBVHTriangleSelector(sphere, sphereNode);
+	ITriangleSelector* sphereOctree = smgr->createOctreeTriangleSelector(sphere, sphereNode);
+	ITriangleSelector* cubeBox = smgr->createTriangleSelectorFromBoundingBox(cubeNode);
+
+	IMetaTriangleSelector* meta = smgr->createMetaTriangleSelector();
+	meta->addTriangleSelector(sphereBVH);
+	meta->addTriangleSelector(cubeBox);
+
+	bool result = true;
+	result &= compareRays(collisionManager, spherePlain, "Plain");
+	result &= compareRays(collisionManager, sphereBVH, "BVH");
+	result &= compareRays(collisionManager, sphereOctree, "Octree");
+	result &= compareRays(collisionManager, meta, "Meta");
+	result &= compareEllipsoids(collisionManager, spherePlain, "Plain");
+	result &= compareEllipsoids(collisionManager, sphereOctree, "Octree");
+	result &= compareEllipsoids(collisionManager, meta, "Meta");
+
+	// empty batches don't touch anything
+	collisionManager->getCollisionPoints(0, 0, meta, 0);
+	collisionManager->getCollisionResultPositions(0, 0, meta);
+
+	meta->drop();
+	spherePlain->drop();
+	sphereBVH->drop();
+	sphereOctree->drop();
+	cubeBox->drop();
+	sphere->drop();
+	cube->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
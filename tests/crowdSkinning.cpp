@@ -0,0 +1,275 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// a triangle following a chain of three turning joints
+ISkinnedMesh* createMesh(ISceneManager* smgr)
+{
+	ISkinnedMesh* mesh = smgr->createSkinnedMesh();
+
+	CMeshBuffer<video::S3DVertex>* buffer = new CMeshBuffer<video::S3DVertex>(smgr->getVideoDriver()->getVertexDescriptor(0));
+
+	const video::S3DVertex vertices[] = {
+		video::S3DVertex(1, 2, 3, 0, 1, 0, video::SColor(255, 255, 255, 255), 0, 0),
+		video::S3DVertex(-4, 0, 2, 1, 0, 0, video::SColor(255, 255, 255, 255), 1, 0),
+		video::S3DVertex(2, -3, -1, 0, 0, 1, video::SColor(255, 255, 255, 255), 0, 1) };
+
+	for (u32 i = 0; i < 3; ++i)
+		buffer->getVertexBuffer()->addVertex(&vertices[i]);
+
+	buffer->getIndexBuffer()->addIndex(0);
+	buffer->getIndexBuffer()->addIndex(1);
+	buffer->getIndexBuffer()->addIndex(2);
+	buffer->recalculateBoundingBox();
+
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+
+	ISkinnedMesh::SJoint* parent = 0;
+	for (u32 j = 0; j < 3; ++j)
+	{
+		ISkinnedMesh::SJoint* joint = mesh->addJoint(parent);
+		joint->LocalMatrix.setTranslation(vector3df(0.f, 1.f + j, 0.f));
+
+		ISkinnedMesh::SPositionKey* position = mesh->addPositionKey(joint);
+		position->frame = 0.f;
+		position->position = joint->LocalMatrix.getTranslation();
+		position = mesh->addPositionKey(joint);
+		position->frame = 10.f;
+		position->position = joint->LocalMatrix.getTranslation() + vector3df(1.f, 0.f, j * 0.5f);
+
+		ISkinnedMesh::SRotationKey* rotation = mesh->addRotationKey(joint);
+		rotation->frame = 0.f;
+		rotation->rotation.set(0.f, 0.f, 0.f);
+		rotation = mesh->addRotationKey(joint);
+		rotation->frame = 10.f;
+		rotation->rotation.set(0.3f, 0.2f * j, 0.1f);
+
+		ISkinnedMesh::SWeight* weight = mesh->addWeight(joint);
+		weight->buffer_id = 0;
+		weight->vertex_id = j;
+		weight->strength = 1.f;
+
+		parent = joint;
+	}
+
+	mesh->finalize();
+
+	return mesh;
+}
+
+// a triangle carried by one joint from the origin of the node 200 units forward
+ISkinnedMesh* createWalkingMesh(ISceneManager* smgr)
+{
+	ISkinnedMesh* mesh = smgr->createSkinnedMesh();
+
+	CMeshBuffer<video::S3DVertex>* buffer = new CMeshBuffer<video::S3DVertex>(smgr->getVideoDriver()->getVertexDescriptor(0));
+
+	const video::S3DVertex vertices[] = {
+		video::S3DVertex(-5, 0, 0, 0, 0, -1, video::SColor(255, 255, 255, 255), 0, 0),
+		video::S3DVertex(5, 0, 0, 0, 0, -1, video::SColor(255, 255, 255, 255), 1, 0),
+		video::S3DVertex(0, 5, 0, 0, 0, -1, video::SColor(255, 255, 255, 255), 0, 1) };
+
+	for (u32 i = 0; i < 3; ++i)
+		buffer->getVertexBuffer()->addVertex(&vertices[i]);
+
+	buffer->getIndexBuffer()->addIndex(0);
+	buffer->getIndexBuffer()->addIndex(1);
+	buffer->getIndexBuffer()->addIndex(2);
+	buffer->recalculateBoundingBox();
+
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+
+	ISkinnedMesh::SJoint* joint = mesh->addJoint();
+
+	ISkinnedMesh::SPositionKey* position = mesh->addPositionKey(joint);
+	position->frame = 0.f;
+	position->position.set(0.f, 0.f, 0.f);
+	position = mesh->addPositionKey(joint);
+	position->frame = 10.f;
+	position->position.set(0.f, 0.f, 200.f);
+
+	for (u32 i = 0; i < 3; ++i)
+	{
+		ISkinnedMesh::SWeight* weight = mesh->addWeight(joint);
+		weight->buffer_id = 0;
+		weight->vertex_id = i;
+		weight->strength = 1.f;
+	}
+
+	mesh->finalize();
+
+	return mesh;
+}
+
+// checks that the box of a node contains the mesh animated to the frame of the node
+bool containsMesh(IAnimatedMeshSceneNode* node, ISkinnedMesh* mesh)
+{
+	mesh->animateMesh(node->getFrameNr(), 1.f);
+	mesh->skinMesh();
+
+	aabbox3df box = node->getBoundingBox();
+	box.MinEdge -= vector3df(0.001f);
+	box.MaxEdge += vector3df(0.001f);
+	return mesh->getBoundingBox().isFullInside(box);
+}
+
+} // end anonymous namespace
+
+/** Tests that animated mesh scene nodes sharing a skinned mesh, which are skinned
+at the same time by the scene manager, get the same result as animating the mesh
+for each node on its own, that the shared mesh isn't changed by them, and that
+nodes out of view aren't skinned. */
+bool crowdSkinning(void)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = dimension2d<u32>(160, 120);
+	params.WorkerThreads = 4;
+
+	IrrlichtDevice * device = createDeviceEx(params);
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager * smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, vector3df(0, 0, -50), vector3df(0, 0, 0));
+
+	ISkinnedMesh* mesh = createMesh(smgr);
+
+	const u32 nodeCount = 16;
+	IAnimatedMeshSceneNode* nodes[nodeCount];
+	for (u32 i = 0; i < nodeCount; ++i)
+	{
+		nodes[i] = smgr->addAnimatedMeshSceneNode(mesh, 0, -1, vector3df(i * 10.f, 0, 0));
+		nodes[i]->setAnimationSpeed(0.f);
+		nodes[i]->setCurrentFrame(i * 10.f / nodeCount);
+	}
+
+	// behind the camera
+	IAnimatedMeshSceneNode* hidden = smgr->addAnimatedMeshSceneNode(mesh, 0, -1, vector3df(0, 0, -200));
+	hidden->setAnimationSpeed(0.f);
+	hidden->setCurrentFrame(5.f);
+
+	// the shared mesh keeps the pose it was given
+	mesh->animateMesh(10.f, 1.f);
+	mesh->skinMesh();
+	const vector3df sharedPosition = ((const video::S3DVertex*)mesh->getMeshBuffer(0)->getVertexBuffer()->getVertex(2))->Pos;
+
+	device->run();
+	smgr->drawAll();
+
+	bool result = true;
+
+	const vector3df position = ((const video::S3DVertex*)mesh->getMeshBuffer(0)->getVertexBuffer()->getVertex(2))->Pos;
+	if (position != sharedPosition)
+	{
+		logTestString("Shared mesh changed by the scene nodes\n");
+		result = false;
+	}
+
+	for (u32 i = 0; i < nodeCount; ++i)
+	{
+		mesh->animateMesh(nodes[i]->getFrameNr(), 1.f);
+		mesh->skinMesh();
+
+		const aabbox3df& expected = mesh->getBoundingBox();
+		const aabbox3df& box = nodes[i]->getBoundingBox();
+
+		if (!box.MinEdge.equals(expected.MinEdge, 0.0001f) || !box.MaxEdge.equals(expected.MaxEdge, 0.0001f))
+		{
+			logTestString("Node %u at frame %f has box (%f %f %f) (%f %f %f), expected (%f %f %f) (%f %f %f)\n",
+				i, nodes[i]->getFrameNr(),
+				box.MinEdge.X, box.MinEdge.Y, box.MinEdge.Z, box.MaxEdge.X, box.MaxEdge.Y, box.MaxEdge.Z,
+				expected.MinEdge.X, expected.MinEdge.Y, expected.MinEdge.Z,
+				expected.MaxEdge.X, expected.MaxEdge.Y, expected.MaxEdge.Z);
+			result = false;
+		}
+	}
+
+	if (!hidden->needsSkinningUpdate())
+	{
+		logTestString("Node behind the camera was skinned\n");
+		result = false;
+	}
+
+	// skinned once it is in view
+	hidden->setPosition(vector3df(0, 0, 0));
+	hidden->updateAbsolutePosition();
+	smgr->drawAll();
+
+	if (hidden->needsSkinningUpdate())
+	{
+		logTestString("Node in view wasn't skinned\n");
+		result = false;
+	}
+
+	// culled with a box around its joints, not the one of the last skinned frame
+	ISkinnedMesh* walkingMesh = createWalkingMesh(smgr);
+	IAnimatedMeshSceneNode* walker = smgr->addAnimatedMeshSceneNode(walkingMesh, 0, -1, vector3df(0, 0, -200));
+	walker->setAnimationSpeed(0.f);
+	walker->setCurrentFrame(10.f);
+	smgr->drawAll();
+	walker->setCurrentFrame(0.f);
+	smgr->drawAll();
+
+	if (!walker->needsSkinningUpdate())
+	{
+		logTestString("Node walking behind the camera was skinned\n");
+		result = false;
+	}
+
+	if (!containsMesh(walker, walkingMesh))
+	{
+		logTestString("Box of the node behind the camera doesn't contain its mesh\n");
+		result = false;
+	}
+
+	// the box moves along before the node is skinned again
+	walker->setCurrentFrame(10.f);
+	smgr->drawAll();
+
+	if (walker->needsSkinningUpdate())
+	{
+		logTestString("Node walking into view wasn't skinned\n");
+		result = false;
+	}
+
+	if (!containsMesh(walker, walkingMesh))
+	{
+		logTestString("Node walking into view has a wrong box\n");
+		result = false;
+	}
+
+	walkingMesh->drop();
+
+	// reading the joints moves the node back to skinning the shared mesh
+	nodes[0]->setJointMode(EJUOR_READ);
+	nodes[0]->setCurrentFrame(7.5f);
+	smgr->drawAll();
+
+	mesh->animateMesh(7.5f, 1.f);
+	mesh->skinMesh();
+	if (nodes[0]->getBoundingBox() != mesh->getBoundingBox())
+	{
+		logTestString("Node reading the joints has a wrong box\n");
+		result = false;
+	}
+
+	mesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
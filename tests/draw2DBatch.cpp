@@ -0,0 +1,199 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+
+namespace
+{
+
+// draws images of two textures and rectangles, returns the primitives of the frame
+u32 drawFrame(video::IVideoDriver* driver, video::ITexture* first, video::ITexture* second)
+{
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+
+	// 100 images, the transparent ones are in the same batch
+	for (u32 i = 0; i < 100; ++i)
+		driver->draw2DImage(first, position2di(i, 10), recti(0, 0, 16, 16), 0,
+			video::SColor(i % 2 ? 255 : 128, 255, 255, 255), i % 2 == 0);
+
+	// clipped completely by the clip rectangle and the screen
+	const recti clip(0, 0, 50, 50);
+	driver->draw2DImage(first, position2di(60, 10), recti(0, 0, 16, 16), &clip);
+	driver->draw2DImage(first, position2di(-20, 10), recti(0, 0, 16, 16));
+	driver->draw2DRectangle(video::SColor(255, 255, 0, 0), recti(200, 200, 220, 220));
+
+	// partly clipped
+	driver->draw2DImage(first, position2di(40, 40), recti(0, 0, 16, 16), &clip);
+	driver->draw2DImage(first, position2di(150, 110), recti(0, 0, 16, 16));
+
+	// changing textures, the rectangles are outside of the clip rectangle
+	for (u32 i = 0; i < 4; ++i)
+	{
+		driver->draw2DImage(i % 2 ? first : second, position2di(0, 60), recti(0, 0, 16, 16));
+		driver->draw2DRectangle(video::SColor(255, 255, 0, 0), recti(10, 60, 20, 70), &clip);
+	}
+	driver->flush2DBatch();
+	driver->draw2DRectangle(recti(10, 80, 20, 90), video::SColor(255, 255, 0, 0), video::SColor(255, 0, 255, 0),
+		video::SColor(255, 0, 0, 255), video::SColor(128, 255, 255, 255));
+	driver->draw2DImage(second, position2di(0, 60), recti(0, 0, 16, 16));
+
+	driver->endScene();
+
+	return driver->getPrimitiveCountDrawn();
+}
+
+// draws images of one texture and then one of another texture, returns the batches of the frame
+u32 drawBatches(video::IVideoDriver* driver, video::ITexture* first, video::ITexture* second, u32 count)
+{
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+
+	for (u32 i = 0; i < count; ++i)
+		driver->draw2DImage(first, position2di(i, 10), recti(0, 0, 16, 16));
+	driver->draw2DImage(second, position2di(0, 60), recti(0, 0, 16, 16));
+
+	driver->endScene();
+
+	return driver->get2DBatchCount();
+}
+
+// draws images, rectangles and a line which is drawn immediately, returns a screenshot
+video::IImage* drawScreenshot(video::IVideoDriver* driver)
+{
+	video::ITexture* fireball = driver->getTexture("../media/fireball.bmp");
+	video::ITexture* alpha = driver->getTexture("media/RedbrushAlpha-0.25.png");
+	const recti clip(10, 10, 150, 110);
+
+	driver->beginScene(true, true, video::SColor(255, 100, 101, 140));
+
+	for (u32 i = 0; i < 40; ++i)
+		driver->draw2DImage(fireball, position2di((i * 17) % 150, (i * 23) % 110),
+			recti(0, 0, 32, 32), &clip, video::SColor(i % 3 ? 255 : 128, 255, 255, 255));
+	driver->draw2DRectangle(video::SColor(128, 255, 0, 0), recti(20, 20, 80, 60));
+	driver->draw2DImage(alpha, position2di(40, 30), recti(0, 0, 64, 64), 0, video::SColor(255, 255, 255, 255), true);
+	driver->draw2DLine(position2di(0, 0), position2di(159, 119), video::SColor(255, 0, 255, 0));
+	driver->draw2DImage(fireball, position2di(100, 80), recti(0, 0, 32, 32));
+	driver->draw2DRectangle(recti(120, 0, 160, 40), video::SColor(255, 255, 0, 0), video::SColor(255, 0, 255, 0),
+		video::SColor(255, 0, 0, 255), video::SColor(128, 255, 255, 255), &clip);
+
+	driver->endScene();
+
+	return driver->createScreenShot();
+}
+
+// drivers which batch draw the same pixels with and without batching
+bool batchedLikeImmediate(video::E_DRIVER_TYPE driverType)
+{
+	IrrlichtDevice * device = createDevice(driverType, dimension2d<u32>(160, 120), 32);
+	if (!device)
+		return true; // No error if device does not exist
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	if (!driver->is2DBatchingEnabled())
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return true;
+	}
+
+	stabilizeScreenBackground(driver);
+
+	logTestString("Testing driver %ls\n", driver->getName());
+
+	video::IImage* batched = drawScreenshot(driver);
+	driver->enable2DBatching(false);
+	video::IImage* immediate = drawScreenshot(driver);
+
+	bool result = batched && immediate;
+	for (u32 y = 0; result && y < batched->getDimension().Height; ++y)
+		for (u32 x = 0; x < batched->getDimension().Width; ++x)
+			result &= batched->getPixel(x, y) == immediate->getPixel(x, y);
+
+	if (!result)
+		logTestString("%ls drew batched images unlike immediate ones\n", driver->getName());
+
+	if (batched)
+		batched->drop();
+	if (immediate)
+		immediate->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that 2d images and rectangles which are collected into batches are
+clipped and drawn like the ones which are drawn immediately, and that images
+of one texture are drawn with one call. */
+bool draw2DBatch(void)
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	video::ITexture* first = driver->addTexture(dimension2d<u32>(32, 32), "first");
+	video::ITexture* second = driver->addTexture(dimension2d<u32>(32, 32), "second");
+
+	bool result = driver->is2DBatchingEnabled();
+
+	// images of the same texture are drawn with one call, the next texture starts a new batch
+	u32 batches = drawBatches(driver, first, second, 50);
+	if (batches != 2)
+	{
+		logTestString("Drew %u instead of 2 batches\n", batches);
+		result = false;
+	}
+
+	// two triangles per quad
+	const u32 expected = (100 + 2 + 4 + 2) * 2;
+
+	u32 drawn = drawFrame(driver, first, second);
+	if (drawn != expected)
+	{
+		logTestString("Drew %u instead of %u primitives with batching\n", drawn, expected);
+		result = false;
+	}
+
+	// quads of a removed texture are drawn before
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->draw2DImage(second, position2di(0, 10), recti(0, 0, 16, 16));
+	driver->removeTexture(second);
+	driver->endScene();
+	result &= driver->getPrimitiveCountDrawn() == 2;
+
+	second = driver->addTexture(dimension2d<u32>(32, 32), "second");
+
+	driver->enable2DBatching(false);
+	result &= !driver->is2DBatchingEnabled();
+
+	drawn = drawFrame(driver, first, second);
+	if (drawn != expected)
+	{
+		logTestString("Drew %u instead of %u primitives without batching\n", drawn, expected);
+		result = false;
+	}
+
+	batches = drawBatches(driver, first, second, 50);
+	if (batches != 51)
+	{
+		logTestString("Drew %u instead of 51 batches without batching\n", batches);
+		result = false;
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	TestWithAllDrivers(batchedLikeImmediate);
+
+	return result;
+}
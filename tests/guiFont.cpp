@@ -0,0 +1,181 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace gui;
+
+namespace
+{
+
+// measures texts with characters in and outside of the lookup table
+bool testLayout()
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	IGUIFont* font = device->getGUIEnvironment()->getBuiltInFont();
+	assert_log(font && font->getType() == EGFT_BITMAP);
+	if (!font || font->getType() != EGFT_BITMAP)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	bool result = true;
+
+	const dimension2d<u32> a = font->getDimension(L"a");
+	const dimension2d<u32> ab = font->getDimension(L"ab");
+	const dimension2d<u32> cd = font->getDimension(L"cde");
+	result &= a.Width > 0 && ab.Width > a.Width;
+
+	// the widest line counts, the lines are stacked
+	const dimension2d<u32> lines = font->getDimension(L"ab\ncde\r\na");
+	result &= lines.Width == max_(ab.Width, cd.Width);
+	result &= lines.Height == ab.Height * 3;
+
+	// characters the font doesn't know are drawn as space
+	result &= font->getDimension(L"\x4e2d").Width == font->getDimension(L" ").Width;
+
+	result &= font->getCharacterFromPos(L"ab", a.Width) == 0;
+	result &= font->getCharacterFromPos(L"ab", a.Width + 1) == 1;
+	result &= font->getCharacterFromPos(L"ab", ab.Width + 1) == -1;
+
+	// kerning moves all characters
+	font->setKerningWidth(3);
+	result &= font->getDimension(L"ab").Width == ab.Width + 6;
+	font->setKerningWidth(0);
+	result &= font->getDimension(L"ab").Width == ab.Width;
+
+	if (!result)
+		logTestString("Unexpected text dimensions\n");
+
+	// more texts than are cached and a text which is too long to be cached
+	stringw longText;
+	for (u32 i = 0; i < 2000; ++i)
+		longText.append((wchar_t)(L'a' + i % 26));
+
+	const rect<s32> clip(10, 10, 150, 110);
+	for (u32 frame = 0; frame < 3; ++frame)
+	{
+		driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		for (u32 i = 0; i < 100; ++i)
+		{
+			stringw text(L"Text ");
+			text += i;
+			font->draw(text, rect<s32>(0, (i % 10) * 12, 160, (i % 10) * 12 + 12), video::SColor(255, 255, 255, 255),
+				i % 2 == 0, i % 3 == 0, i % 5 == 0 ? &clip : 0);
+		}
+		font->draw(longText, rect<s32>(0, 0, 160, 120), video::SColor(255, 255, 255, 255), true, true, &clip);
+		font->draw(L"", rect<s32>(0, 0, 160, 120), video::SColor(255, 255, 255, 255));
+		driver->endScene();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+// centered, clipped and multi-line texts, moved by offset
+void drawTexts(video::IVideoDriver* driver, IGUIFont* font, const position2d<s32>& offset)
+{
+	const video::SColor white(255, 255, 255, 255);
+	const rect<s32> clip(60, 70, 140, 95);
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	font->draw(L"Left", rect<s32>(5, 5, 155, 20) + offset, white);
+	font->draw(L"Centered", rect<s32>(5, 20, 155, 35) + offset, white, true);
+	font->draw(L"Middle", rect<s32>(5, 35, 60, 65) + offset, white, false, true);
+	font->draw(L"Two\nlines", rect<s32>(60, 35, 155, 65) + offset, white, true, true);
+	font->draw(L"Clipped text\r\nover three\rlines", rect<s32>(5, 65, 155, 100) + offset, white, true, true, &clip);
+	font->draw(L"Outside", rect<s32>(5, 100, 155, 115) + offset, white, false, false, &clip);
+	driver->endScene();
+}
+
+// texts drawn with their cached glyph runs look the same as freshly laid out texts
+bool testCachedRuns(video::E_DRIVER_TYPE driverType)
+{
+	IrrlichtDevice * device = createDevice(driverType, dimension2d<u32>(160, 120), 32);
+	if (!device)
+		return true; // No error if device does not exist
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	stabilizeScreenBackground(driver);
+
+	logTestString("Testing driver %ls\n", driver->getName());
+
+	IGUIFont* font = device->getGUIEnvironment()->getBuiltInFont();
+
+	core::stringc cachedName = "results/";
+	cachedName += shortDriverName(driver);
+	cachedName += "-guiFont-cached.png";
+	core::stringc freshName = "results/";
+	freshName += shortDriverName(driver);
+	freshName += "-guiFont-fresh.png";
+
+	bool result = true;
+
+	// the runs are laid out at other positions than where they are drawn from the cache
+	drawTexts(driver, font, position2d<s32>(7, 3));
+	drawTexts(driver, font, position2d<s32>(0, 0));
+	video::IImage* screenshot = driver->createScreenShot();
+	if (screenshot)
+	{
+		driver->writeImageToFile(screenshot, cachedName.c_str());
+		screenshot->drop();
+	}
+
+	// setting the kerning drops the cached runs
+	font->setKerningWidth(0);
+	drawTexts(driver, font, position2d<s32>(0, 0));
+	screenshot = driver->createScreenShot();
+	if (screenshot)
+	{
+		// something was drawn at all
+		bool drawn = false;
+		const dimension2d<u32> size = screenshot->getDimension();
+		for (u32 y = 0; y < size.Height && !drawn; ++y)
+			for (u32 x = 0; x < size.Width && !drawn; ++x)
+				drawn = screenshot->getPixel(x, y).getLuminance() > 128.f;
+		if (!drawn)
+		{
+			logTestString("No text was drawn\n");
+			result = false;
+		}
+
+		driver->writeImageToFile(screenshot, freshName.c_str());
+		screenshot->drop();
+	}
+
+	result &= fuzzyCompareImages(driver, cachedName.c_str(), freshName.c_str()) > 99.9f;
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests the measurement of texts with the built-in bitmap font, for
+characters in and outside of its lookup table, that texts can be drawn
+again after their cached layout was replaced and that cached layouts are
+drawn like fresh ones. */
+bool guiFont(void)
+{
+	bool result = testLayout();
+
+	TestWithAllDrivers(testCachedRuns);
+
+	return result;
+}
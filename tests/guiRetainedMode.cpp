@@ -0,0 +1,282 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace gui;
+
+namespace
+{
+
+// counts how often it was drawn
+class CCountingElement : public IGUIElement
+{
+public:
+	CCountingElement(IGUIEnvironment* environment, IGUIElement* parent, const rect<s32>& rectangle)
+		: IGUIElement(EGUIET_ELEMENT, environment, parent, -1, rectangle), Draws(0)
+	{
+	}
+
+	virtual void draw()
+	{
+		if (!IsVisible)
+			return;
+
+		++Draws;
+		IGUIElement::draw();
+	}
+
+	u32 Draws;
+};
+
+bool drawFrames(IrrlichtDevice* device, u32 frames)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+
+	for (u32 i = 0; i < frames; ++i)
+	{
+		if (!driver->beginScene(true, true, video::SColor(255, 100, 101, 140)))
+			return false;
+		device->getGUIEnvironment()->drawAll();
+		driver->endScene();
+	}
+
+	return true;
+}
+
+// checks when elements are marked as changed
+bool testChangedIDs()
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IGUIEnvironment* env = device->getGUIEnvironment();
+	IGUIElement* root = env->getRootGUIElement();
+
+	IGUIWindow* window = env->addWindow(rect<s32>(10, 10, 150, 110), false, L"Window");
+	IGUIButton* button = env->addButton(rect<s32>(10, 30, 60, 50), window, -1, L"Button");
+
+	bool result = true;
+
+	u32 rootID = root->getChangedID();
+	u32 windowID = window->getChangedID();
+	u32 buttonID = button->getChangedID();
+
+	// changing a child also changes its parents, but not the root
+	button->setText(L"Changed");
+	result &= button->getChangedID() != buttonID;
+	result &= window->getChangedID() != windowID;
+	result &= root->getChangedID() == rootID;
+
+	windowID = window->getChangedID();
+	buttonID = button->getChangedID();
+
+	button->setRelativePosition(rect<s32>(20, 30, 70, 50));
+	result &= button->getChangedID() != buttonID;
+	result &= window->getChangedID() != windowID;
+
+	// adding and removing children changes the parent, top level elements are
+	// drawn on their own and don't change the root
+	windowID = window->getChangedID();
+	IGUIStaticText* text = env->addStaticText(L"Text", rect<s32>(0, 0, 50, 20), false, true, window);
+	result &= window->getChangedID() != windowID;
+
+	windowID = window->getChangedID();
+	text->remove();
+	result &= window->getChangedID() != windowID;
+
+	env->addStaticText(L"Text", rect<s32>(0, 0, 50, 20));
+	result &= root->getChangedID() == rootID;
+
+	// a new skin changes everything
+	rootID = root->getChangedID();
+	IGUISkin* skin = env->createSkin(EGST_WINDOWS_CLASSIC);
+	env->setSkin(skin);
+	skin->drop();
+	result &= root->getChangedID() != rootID;
+
+	// the skin counts its own changes
+	u32 skinID = skin->getChangedID();
+	skin->setSize(EGDS_WINDOW_BUTTON_WIDTH, 30);
+	result &= skin->getChangedID() != skinID;
+
+	skinID = skin->getChangedID();
+	skin->setFont(env->getBuiltInFont(), EGDF_BUTTON);
+	result &= skin->getChangedID() != skinID;
+
+	skinID = skin->getChangedID();
+	skin->setDefaultText(EGDT_MSG_BOX_OK, L"Fine");
+	result &= skin->getChangedID() != skinID;
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+// drivers without render target textures draw all elements in each frame
+bool testWithoutRenderTargets()
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IGUIEnvironment* env = device->getGUIEnvironment();
+
+	bool result = !env->getRetainedMode();
+	env->setRetainedMode(true);
+	result &= env->getRetainedMode();
+
+	CCountingElement* element = new CCountingElement(env, env->getRootGUIElement(), rect<s32>(10, 10, 100, 100));
+	element->drop();
+
+	result &= drawFrames(device, 3);
+	result &= element->Draws == 3;
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+// elements are only drawn again when they changed
+bool testRetained(video::E_DRIVER_TYPE driverType)
+{
+	IrrlichtDevice * device = createDevice(driverType, dimension2d<u32>(160, 120), 32);
+	if (!device)
+		return true; // No error if device does not exist
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	if (!driver->queryFeature(video::EVDF_RENDER_TO_TARGET) ||
+		!driver->queryFeature(video::EVDF_BLEND_SEPARATE))
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return true;
+	}
+
+	stabilizeScreenBackground(driver);
+
+	logTestString("Testing driver %ls\n", driver->getName());
+
+	IGUIEnvironment* env = device->getGUIEnvironment();
+	env->setRetainedMode(true);
+
+	CCountingElement* first = new CCountingElement(env, env->getRootGUIElement(), rect<s32>(10, 10, 70, 60));
+	first->drop();
+	CCountingElement* second = new CCountingElement(env, env->getRootGUIElement(), rect<s32>(80, 10, 150, 60));
+	second->drop();
+	CCountingElement* child = new CCountingElement(env, second, rect<s32>(5, 5, 30, 30));
+	child->drop();
+
+	bool result = drawFrames(device, 3);
+	result &= first->Draws == 1 && second->Draws == 1 && child->Draws == 1;
+
+	// only the changed element and its parents are drawn again
+	child->setText(L"Changed");
+	result &= drawFrames(device, 2);
+	result &= first->Draws == 1 && second->Draws == 2 && child->Draws == 2;
+
+	// moving an element needs a new texture of the same size
+	first->move(position2di(0, 40));
+	result &= drawFrames(device, 1);
+	result &= first->Draws == 2 && second->Draws == 2;
+
+	// changing the skin draws everything again, setting the same color does not
+	IGUISkin* skin = env->getSkin();
+	skin->setColor(EGDC_3D_FACE, video::SColor(255, 200, 0, 0));
+	result &= drawFrames(device, 2);
+	result &= first->Draws == 3 && second->Draws == 3 && child->Draws == 3;
+
+	skin->setColor(EGDC_3D_FACE, video::SColor(255, 200, 0, 0));
+	result &= drawFrames(device, 1);
+	result &= first->Draws == 3 && second->Draws == 3 && child->Draws == 3;
+
+	// without retained mode everything is drawn in each frame
+	env->setRetainedMode(false);
+	result &= drawFrames(device, 2);
+	result &= first->Draws == 5 && second->Draws == 5 && child->Draws == 5;
+
+	if (!result)
+		logTestString("Elements were drawn %u, %u and %u times\n", first->Draws, second->Draws, child->Draws);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+// cached elements look the same as elements drawn directly, the default skin is translucent
+bool testRetainedScreenshot(video::E_DRIVER_TYPE driverType)
+{
+	IrrlichtDevice * device = createDevice(driverType, dimension2d<u32>(160, 120), 32);
+	if (!device)
+		return true; // No error if device does not exist
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	stabilizeScreenBackground(driver);
+
+	logTestString("Testing driver %ls\n", driver->getName());
+
+	IGUIEnvironment* env = device->getGUIEnvironment();
+	IGUIWindow* window = env->addWindow(rect<s32>(10, 10, 150, 110), false, L"Window");
+	env->addButton(rect<s32>(10, 30, 90, 50), window, -1, L"Button");
+	env->addStaticText(L"Text", rect<s32>(10, 60, 90, 80), true, false, window);
+
+	core::stringc immediateName = "results/";
+	immediateName += shortDriverName(driver);
+	immediateName += "-guiRetainedMode-immediate.png";
+	core::stringc retainedName = "results/";
+	retainedName += shortDriverName(driver);
+	retainedName += "-guiRetainedMode-retained.png";
+
+	bool result = drawFrames(device, 1);
+	video::IImage* screenshot = driver->createScreenShot();
+	if (screenshot)
+	{
+		driver->writeImageToFile(screenshot, immediateName.c_str());
+		screenshot->drop();
+	}
+
+	// the first frame fills the texture, the second one only draws it
+	env->setRetainedMode(true);
+	result &= drawFrames(device, 2);
+	screenshot = driver->createScreenShot();
+	if (screenshot)
+	{
+		driver->writeImageToFile(screenshot, retainedName.c_str());
+		screenshot->drop();
+	}
+
+	result &= fuzzyCompareImages(driver, immediateName.c_str(), retainedName.c_str()) > 99.5f;
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that GUI elements report their changes and that the retained mode of
+the GUI environment only draws changed top level elements again. */
+bool guiRetainedMode(void)
+{
+	bool result = testChangedIDs();
+	result &= testWithoutRenderTargets();
+
+	TestWithAllDrivers(testRetained);
+	TestWithAllDrivers(testRetainedScreenshot);
+
+	return result;
+}
@@ -0,0 +1,180 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// counts the instances inside the camera's view frustum and below a distance
+void countInstances(IInstancedMeshSceneNode* node, ICameraSceneNode* camera,
+	f32 lodDistance, u32& nearCount, u32& farCount)
+{
+	const SViewFrustum* frustum = camera->getViewFrustum();
+	const aabbox3df meshBox = node->getMesh()->getMeshBuffer(0)->getBoundingBox();
+
+	nearCount = 0;
+	farCount = 0;
+
+	for (u32 i = 0; i < node->getInstanceCount(); ++i)
+	{
+		aabbox3df box = meshBox;
+		node->getInstance(i)->getAbsoluteTransformation().transformBoxEx(box);
+
+		vector3df edges[8];
+		box.getEdges(edges);
+
+		bool culled = false;
+		for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT && !culled; ++p)
+		{
+			culled = true;
+			for (u32 j = 0; j < 8; ++j)
+			{
+				if (frustum->planes[p].classifyPointRelation(edges[j]) != ISREL3D_FRONT)
+				{
+					culled = false;
+					break;
+				}
+			}
+		}
+
+		if (culled)
+			continue;
+
+		if (box.getCenter().getDistanceFrom(camera->getAbsolutePosition()) < lodDistance)
+			++nearCount;
+		else
+			++farCount;
+	}
+}
+
+// a triangle spanning a box of the given size
+IMesh* createMesh(video::IVideoDriver* driver, f32 size)
+{
+	CMeshBuffer<video::S3DVertex>* buffer = new CMeshBuffer<video::S3DVertex>(driver->getVertexDescriptor(0));
+
+	const video::S3DVertex vertices[] = {
+		video::S3DVertex(-size, -size, -size, 0, 0, -1, video::SColor(255, 255, 255, 255), 0, 0),
+		video::S3DVertex(size, -size, size, 0, 0, -1, video::SColor(255, 255, 255, 255), 1, 0),
+		video::S3DVertex(0, size, 0, 0, 0, -1, video::SColor(255, 255, 255, 255), 0, 1) };
+
+	for (u32 i = 0; i < 3; ++i)
+		buffer->getVertexBuffer()->addVertex(&vertices[i]);
+	buffer->getIndexBuffer()->addIndex(0);
+	buffer->getIndexBuffer()->addIndex(1);
+	buffer->getIndexBuffer()->addIndex(2);
+	buffer->recalculateBoundingBox();
+
+	SMesh* mesh = new SMesh();
+	mesh->addMeshBuffer(buffer);
+	mesh->recalculateBoundingBox();
+	buffer->drop();
+
+	return mesh;
+}
+
+// checks that the instance buffer holds exactly the matrices of the visible instances
+bool checkInstanceBuffer(IMesh* mesh, u32 count)
+{
+	IVertexBuffer* instanceBuffer = mesh->getMeshBuffer(0)->getVertexBuffer(1);
+	if (instanceBuffer->getVertexCount() != count)
+	{
+		logTestString("%u instances in buffer, expected %u\n", instanceBuffer->getVertexCount(), count);
+		return false;
+	}
+
+	return true;
+}
+
+} // end anonymous namespace
+
+/** Tests that the instanced mesh scene node writes its visible instances
+contiguously and splits them by level of detail. */
+bool instancedMeshSceneNode(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager * smgr = device->getSceneManager();
+	ICameraSceneNode* camera = smgr->addCameraSceneNode(0, vector3df(0, 0, 0), vector3df(0, 0, 100));
+
+	IMesh* mesh = createMesh(device->getVideoDriver(), 1.f);
+	IMesh* lodMesh = createMesh(device->getVideoDriver(), 0.5f);
+
+	IInstancedMeshSceneNode* node = smgr->addInstancedMeshSceneNode(mesh);
+
+	u32 seed = 4321;
+	for (u32 i = 0; i < 10000; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		const f32 r0 = ((seed >> 8) & 0xffff) / 65535.f;
+		seed = seed * 1103515245 + 12345;
+		const f32 r1 = ((seed >> 8) & 0xffff) / 65535.f;
+		seed = seed * 1103515245 + 12345;
+		const f32 r2 = ((seed >> 8) & 0xffff) / 65535.f;
+
+		node->addInstance(vector3df(r0 * 1000.f - 500.f, r1 * 100.f - 50.f, r2 * 1000.f - 500.f),
+			vector3df(0.f, r1 * 360.f, 0.f), vector3df(0.5f + r2, 0.5f + r0, 0.5f + r1));
+	}
+
+	bool result = true;
+
+	device->run();
+	smgr->drawAll();
+
+	u32 nearCount = 0;
+	u32 farCount = 0;
+	countInstances(node, camera, FLT_MAX, nearCount, farCount);
+
+	if (node->getVisibleInstanceCount() != nearCount || nearCount == 0 || nearCount == node->getInstanceCount())
+	{
+		logTestString("%u visible instances, expected %u\n", node->getVisibleInstanceCount(), nearCount);
+		result = false;
+	}
+	result &= checkInstanceBuffer(mesh, nearCount);
+
+	// the far instances move to the second level
+	result &= node->addLODMesh(lodMesh, 200.f);
+	result &= (node->getLODMeshCount() == 1);
+
+	smgr->drawAll();
+	countInstances(node, camera, 200.f, nearCount, farCount);
+
+	if (node->getVisibleInstanceCount() != nearCount + farCount || farCount == 0)
+	{
+		logTestString("%u visible instances, expected %u near and %u far\n",
+			node->getVisibleInstanceCount(), nearCount, farCount);
+		result = false;
+	}
+	result &= checkInstanceBuffer(mesh, nearCount);
+	result &= checkInstanceBuffer(lodMesh, farCount);
+
+	// turning the camera changes which instances are visible
+	camera->setTarget(vector3df(100, 0, 0));
+	smgr->drawAll();
+	countInstances(node, camera, 200.f, nearCount, farCount);
+	result &= checkInstanceBuffer(mesh, nearCount);
+	result &= checkInstanceBuffer(lodMesh, farCount);
+
+	// without culling all instances are written
+	node->removeLODMeshes();
+	node->setAutomaticCulling(EAC_OFF);
+	smgr->drawAll();
+	result &= (node->getVisibleInstanceCount() == node->getInstanceCount());
+	result &= checkInstanceBuffer(mesh, node->getInstanceCount());
+
+	mesh->drop();
+	lodMesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
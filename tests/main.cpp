@@ -82,6 +82,8 @@ int main(int argumentCount, char * arguments[])
 	TEST(removeCustomAnimator);
 	TEST(sceneCollisionManager);
 	TEST(sceneNodeAnimator);
+	TEST(sceneNodeCulling);
+	TEST(instancedMeshSceneNode);
 	TEST(meshLoaders);
 	TEST(testTimer);
 	TEST(testCoreutil);
@@ -98,6 +100,22 @@ int main(int argumentCount, char * arguments[])
 	TEST(md2Animation);
 	TEST(meshTransform);
 	TEST(skinnedMesh);
+	TEST(softwareSkinning);
+	TEST(crowdSkinning);
+	TEST(assetRequests);
+	TEST(profilerTimeline);
+	TEST(bvhTriangleSelector);
+	TEST(collisionBatch);
+	TEST(spatialIndex);
+	TEST(octreeSceneNode);
+	TEST(pagedTerrain);
+	TEST(particleSystem);
+	TEST(meshWelding);
+	TEST(shadowVolume);
+	TEST(guiRetainedMode);
+	TEST(guiFont);
+	TEST(draw2DBatch);
+	TEST(renderQueue);
 	TEST(testGeometryCreator);
 	TEST(writeImageToFile);
 	TEST(ioScene);
@@ -117,12 +117,91 @@ bool testNormals()
 	return result;
 }
 
+// Tests that nodes showing the same frame share one interpolated mesh.
+bool testMorphCache()
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	if (!device)
+		return false;
+
+	scene::ISceneManager * smgr = device->getSceneManager();
+	scene::IAnimatedMesh* mesh = smgr->getMesh("./media/sydney.md2");
+
+	bool result = (mesh != 0);
+	if (mesh)
+	{
+		// the same frame is interpolated only once
+		scene::IMesh* frame = mesh->getMesh(41);
+		const u32 changed = frame->getMeshBuffer(0)->getVertexBuffer()->getChangedID();
+		result &= mesh->getMesh(41) == frame;
+		result &= frame->getMeshBuffer(0)->getVertexBuffer()->getChangedID() == changed;
+		result &= mesh->getMesh(42) != frame;
+
+		// a frame between two keyframes lies between them
+		scene::IMesh* first = mesh->getMesh(40);
+		first->grab();
+		scene::IMesh* second = mesh->getMesh(44);
+		second->grab();
+		scene::IMesh* half = mesh->getMesh(42);
+
+		const video::S3DVertex* a = static_cast<const video::S3DVertex*>(first->getMeshBuffer(0)->getVertexBuffer()->getVertices());
+		const video::S3DVertex* b = static_cast<const video::S3DVertex*>(second->getMeshBuffer(0)->getVertexBuffer()->getVertices());
+		const video::S3DVertex* c = static_cast<const video::S3DVertex*>(half->getMeshBuffer(0)->getVertexBuffer()->getVertices());
+		const u32 count = half->getMeshBuffer(0)->getVertexBuffer()->getVertexCount();
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			if (!c[i].Pos.equals((a[i].Pos + b[i].Pos) * 0.5f, 0.001f) ||
+				!c[i].Normal.equals((a[i].Normal + b[i].Normal) * 0.5f, 0.001f) ||
+				c[i].TCoords != a[i].TCoords)
+			{
+				logTestString("md2 vertex %u not interpolated.\n", i);
+				result = false;
+				break;
+			}
+		}
+
+		// grabbed frames are not reused for other frames
+		const video::S3DVertex vertex = a[0];
+		for (s32 i = 0; i < 400; i += 3)
+			mesh->getMesh(i);
+		result &= a[0] == vertex;
+		result &= mesh->getMesh(40) != first;
+
+		first->drop();
+		second->drop();
+
+		// the mesh itself shows the frame returned last, as the shadow volumes use it
+		for (s32 i = 0; i < 400; i += 37)
+		{
+			scene::IMesh* current = mesh->getMesh(i);
+			const scene::IMeshBuffer* buffer = mesh->getMeshBuffer(0);
+			if (buffer->getVertexBuffer()->getVertexCount() != current->getMeshBuffer(0)->getVertexBuffer()->getVertexCount() ||
+				memcmp(buffer->getVertexBuffer()->getVertices(), current->getMeshBuffer(0)->getVertexBuffer()->getVertices(),
+					buffer->getVertexBuffer()->getVertexCount() * sizeof(video::S3DVertex)) ||
+				mesh->getBoundingBox() != current->getBoundingBox())
+			{
+				logTestString("md2 mesh does not show frame %d.\n", i);
+				result = false;
+				break;
+			}
+		}
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
 }
 
 // test md2 features
 bool md2Animation(void)
 {
-	bool result = testLastFrame();
+	bool result = testMorphCache();
+	result &= testLastFrame();
 	result &= testNormals();
 	return result;
 }
@@ -0,0 +1,130 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// welds by comparing each vertex against all vertices before it
+void weldReference(const array<video::S3DVertex>& vertices, f32 tolerance, bool checkTCoords, array<u32>& redirects, u32& count)
+{
+	redirects.set_used(vertices.size());
+	count = 0;
+
+	for (u32 i = 0; i < vertices.size(); ++i)
+	{
+		const video::S3DVertex& a = vertices[i];
+		u32 j = 0;
+		for (; j < i; ++j)
+		{
+			const video::S3DVertex& b = vertices[j];
+			if (equals(a.Pos.X, b.Pos.X, tolerance) && equals(a.Pos.Y, b.Pos.Y, tolerance) && equals(a.Pos.Z, b.Pos.Z, tolerance) &&
+				equals(a.Normal.X, b.Normal.X, tolerance) && equals(a.Normal.Y, b.Normal.Y, tolerance) && equals(a.Normal.Z, b.Normal.Z, tolerance) &&
+				a.Color == b.Color &&
+				(!checkTCoords || (equals(a.TCoords.X, b.TCoords.X, tolerance) && equals(a.TCoords.Y, b.TCoords.Y, tolerance))))
+				break;
+		}
+
+		if (j < i)
+			redirects[i] = redirects[j];
+		else
+			redirects[i] = count++;
+	}
+}
+
+bool weldAndCompare(IMeshManipulator* manipulator, video::IVertexDescriptor* descriptor,
+	const array<video::S3DVertex>& vertices, f32 tolerance, bool checkTCoords)
+{
+	CMeshBuffer<video::S3DVertex>* src = new CMeshBuffer<video::S3DVertex>(descriptor, video::EIT_32BIT);
+	CMeshBuffer<video::S3DVertex>* dst = new CMeshBuffer<video::S3DVertex>(descriptor, video::EIT_32BIT);
+
+	for (u32 i = 0; i < vertices.size(); ++i)
+	{
+		src->getVertexBuffer()->addVertex(&vertices[i]);
+		src->getIndexBuffer()->addIndex(i);
+	}
+
+	bool result = manipulator->createWelded(src, dst, tolerance, true, true, checkTCoords, true);
+
+	array<u32> redirects;
+	u32 count = 0;
+	weldReference(vertices, tolerance, checkTCoords, redirects, count);
+
+	if (dst->getVertexBuffer()->getVertexCount() != count)
+	{
+		logTestString("Welded to %u instead of %u vertices\n", dst->getVertexBuffer()->getVertexCount(), count);
+		result = false;
+	}
+
+	for (u32 i = 0; result && i < vertices.size(); ++i)
+	{
+		if (dst->getIndexBuffer()->getIndex(i) != redirects[i])
+		{
+			logTestString("Vertex %u redirected to %u instead of %u\n", i, dst->getIndexBuffer()->getIndex(i), redirects[i]);
+			result = false;
+		}
+	}
+
+	src->drop();
+	dst->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that createWelded finds the same vertices as comparing each vertex
+with all vertices before it. */
+bool meshWelding(void)
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IMeshManipulator* manipulator = device->getSceneManager()->getMeshManipulator();
+	video::IVertexDescriptor* descriptor = device->getVideoDriver()->getVertexDescriptor(0);
+
+	bool result = true;
+
+	// a grid of 10 by 10 quads with separate corners welds to 11 by 11 vertices
+	array<video::S3DVertex> vertices;
+	for (u32 q = 0; q < 100; ++q)
+	{
+		for (u32 c = 0; c < 4; ++c)
+		{
+			const f32 x = (f32)(q % 10 + (c & 1));
+			const f32 z = (f32)(q / 10 + (c >> 1));
+			vertices.push_back(video::S3DVertex(x * 3.f, 0.f, z * 3.f, 0.f, 1.f, 0.f, video::SColor(255, 255, 255, 255), x * 0.1f, z * 0.1f));
+		}
+	}
+	result &= weldAndCompare(manipulator, descriptor, vertices, ROUNDING_ERROR_f32, true);
+
+	// jittered points around a few positions, some are within the tolerance of
+	// each other but in different cells, some are chains closer than the tolerance
+	vertices.clear();
+	u32 seed = 1234;
+	for (u32 i = 0; i < 5000; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		const f32 jitter = (f32)((seed >> 16) % 1000) * 0.00003f - 0.015f;
+		const f32 base = (f32)((seed >> 8) % 20) * 0.05f - 200.f;
+		const video::SColor color((seed >> 4) % 2 ? 255 : 128, 255, 255, 255);
+		vertices.push_back(video::S3DVertex(base + jitter, -base, base * 2.f - jitter, 0.f, 0.f, 1.f,
+			color, (f32)(i % 3), 0.f));
+	}
+	result &= weldAndCompare(manipulator, descriptor, vertices, 0.01f, true);
+	result &= weldAndCompare(manipulator, descriptor, vertices, 0.01f, false);
+	result &= weldAndCompare(manipulator, descriptor, vertices, 0.f, false);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,178 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// drawing ranges counts their primitives and doesn't change the buffer
+bool drawRanges(video::IVideoDriver* driver, ISceneManager* smgr)
+{
+	IMesh* cube = smgr->getGeometryCreator()->createCubeMesh();
+	IMeshBuffer* buffer = cube->getMeshBuffer(0);
+	IIndexBuffer* indexBuffer = buffer->getIndexBuffer();
+	const u32 indexCount = indexBuffer->getIndexCount();
+
+	array<u32> indices;
+	for (u32 i = 0; i < indexCount; ++i)
+		indices.push_back(indexBuffer->getIndex(i));
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->drawMeshBufferRange(buffer, 6, 12);
+	driver->drawMeshBufferRange(buffer, 0, indexCount);
+	// outside of the buffer, nothing is drawn
+	driver->drawMeshBufferRange(buffer, indexCount - 6, 12);
+	driver->endScene();
+
+	bool result = driver->getPrimitiveCountDrawn() == 4 + indexCount / 3;
+	if (!result)
+		logTestString("Drew %u primitives instead of %u\n", driver->getPrimitiveCountDrawn(), 4 + indexCount / 3);
+
+	result &= buffer->getIndexBuffer() == indexBuffer && indexBuffer->getIndexCount() == indexCount;
+	for (u32 i = 0; result && i < indexCount; ++i)
+		result &= indexBuffer->getIndex(i) == indices[i];
+
+	cube->drop();
+
+	return result;
+}
+
+// draws a range of the indices, returns the screenshot
+video::IImage* drawRange(video::IVideoDriver* driver, IMeshBuffer* buffer, u32 firstIndex, u32 indexCount)
+{
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->drawMeshBufferRange(buffer, firstIndex, indexCount);
+	driver->endScene();
+
+	return driver->createScreenShot();
+}
+
+// the drivers draw a range of the indices like a buffer which only holds these indices
+bool rangesLikeCopies(video::E_DRIVER_TYPE driverType)
+{
+	IrrlichtDevice * device = createDevice(driverType, dimension2d<u32>(64, 64));
+	if (!device)
+		return true; // No error if device does not exist
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(5.f, 16, 16);
+	IMeshBuffer* buffer = sphere->getMeshBuffer(0);
+	IIndexBuffer* indexBuffer = buffer->getIndexBuffer();
+	const u32 firstIndex = (indexBuffer->getIndexCount() / 6) * 3;
+	const u32 indexCount = (indexBuffer->getIndexCount() / 6) * 2;
+
+	video::SMaterial material;
+	material.Lighting = false;
+	driver->setMaterial(material);
+	driver->setTransform(video::ETS_PROJECTION, matrix4().buildProjectionMatrixPerspectiveFovLH(PI / 2.f, 1.f, 1.f, 100.f));
+	driver->setTransform(video::ETS_VIEW, matrix4().buildCameraLookAtMatrixLH(vector3df(0.f, 0.f, -10.f),
+		vector3df(0.f, 0.f, 0.f), vector3df(0.f, 1.f, 0.f)));
+	driver->setTransform(video::ETS_WORLD, matrix4());
+
+	video::IImage* range = drawRange(driver, buffer, firstIndex, indexCount);
+
+	// the same triangles in a buffer of their own
+	IIndexBuffer* copy = new CIndexBuffer(indexBuffer->getType());
+	for (u32 i = 0; i < indexCount; ++i)
+		copy->addIndex(indexBuffer->getIndex(firstIndex + i));
+
+	indexBuffer->grab();
+	buffer->setIndexBuffer(copy);
+	video::IImage* expected = drawRange(driver, buffer, 0, indexCount);
+	buffer->setIndexBuffer(indexBuffer);
+	indexBuffer->drop();
+	copy->drop();
+
+	bool result = range && expected;
+	for (u32 y = 0; result && y < range->getDimension().Height; ++y)
+		for (u32 x = 0; x < range->getDimension().Width; ++x)
+			result &= range->getPixel(x, y) == expected->getPixel(x, y);
+
+	if (!result)
+		logTestString("%ls drew a range unlike its copy\n", driver->getName());
+
+	if (range)
+		range->drop();
+	if (expected)
+		expected->drop();
+	sphere->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+u32 drawView(video::IVideoDriver* driver, ISceneManager* smgr, const vector3df& position, const vector3df& target)
+{
+	smgr->getActiveCamera()->setPosition(position);
+	smgr->getActiveCamera()->setTarget(target);
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+
+	return driver->getPrimitiveCountDrawn();
+}
+
+} // end anonymous namespace
+
+/** Tests that the octree scene node draws all, some or none of the triangles of a
+mesh depending on the view, while it only draws ranges of its sorted index buffers. */
+bool octreeSceneNode(void)
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	bool result = drawRanges(driver, smgr);
+	TestWithAllDrivers(rangesLikeCopies);
+
+	IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(100.f, 64, 64);
+	const u32 indexCount = sphere->getMeshBuffer(0)->getIndexBuffer()->getIndexCount();
+	const u32 firstIndex = sphere->getMeshBuffer(0)->getIndexBuffer()->getIndex(0);
+	const u32 total = sphere->getMeshBuffer(0)->getPrimitiveCount();
+
+	IMeshSceneNode* node = smgr->addOctreeSceneNode<video::S3DVertex>(sphere, 0, -1, 64);
+	assert_log(node);
+	smgr->addCameraSceneNode();
+
+	// everything in view
+	const u32 all = drawView(driver, smgr, vector3df(0.f, 0.f, -1000.f), vector3df(0.f, 0.f, 0.f));
+	// close to the surface with a short view, only a part is in view
+	smgr->getActiveCamera()->setFarValue(50.f);
+	const u32 part = drawView(driver, smgr, vector3df(0.f, 0.f, -110.f), vector3df(0.f, 0.f, 0.f));
+	smgr->getActiveCamera()->setFarValue(3000.f);
+	// looking away from the sphere
+	const u32 none = drawView(driver, smgr, vector3df(0.f, 0.f, -500.f), vector3df(0.f, 0.f, -1000.f));
+
+	if (all != total || part == 0 || part >= total || none != 0)
+	{
+		logTestString("Octree drew %u, %u and %u of %u primitives\n", all, part, none, total);
+		result = false;
+	}
+
+	// the indices of the mesh itself stay as they are
+	result &= sphere->getMeshBuffer(0)->getIndexBuffer()->getIndexCount() == indexCount;
+	result &= sphere->getMeshBuffer(0)->getIndexBuffer()->getIndex(0) == firstIndex;
+
+	sphere->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,217 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+#include <stdio.h>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+const u32 TileCount = 4;
+const u32 TileSize = 33;
+
+stringc getTileName(u32 x, u32 z)
+{
+	c8 name[64];
+	snprintf(name, sizeof(name), "pagedTerrain_%u_%u.raw", x, z);
+	return name;
+}
+
+// heights rising along x and twice as fast along z, the last tile is missing
+bool writeTiles(io::IFileSystem* fs)
+{
+	array<u16> heights;
+	heights.set_used(TileSize * TileSize);
+
+	for (u32 tx = 0; tx < TileCount; ++tx)
+	{
+		for (u32 tz = 0; tz < TileCount; ++tz)
+		{
+			if (tx == TileCount - 1 && tz == TileCount - 1)
+				continue;
+
+			for (u32 x = 0; x < TileSize; ++x)
+				for (u32 z = 0; z < TileSize; ++z)
+					heights[x * TileSize + z] = (u16)(((tx * (TileSize - 1) + x) + 2 * (tz * (TileSize - 1) + z)) * 128);
+
+			io::IWriteFile* file = fs->createAndWriteFile(getTileName(tx, tz).c_str());
+			if (!file)
+				return false;
+			file->write(heights.const_pointer(), heights.size() * sizeof(u16));
+			file->drop();
+		}
+	}
+
+	return true;
+}
+
+void removeTiles()
+{
+	for (u32 tx = 0; tx < TileCount; ++tx)
+		for (u32 tz = 0; tz < TileCount; ++tz)
+			remove(getTileName(tx, tz).c_str());
+}
+
+u32 drawFrames(video::IVideoDriver* driver, ISceneManager* smgr, IPagedTerrainSceneNode* terrain)
+{
+	for (u32 i = 0; i < 1000; ++i)
+	{
+		driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		smgr->drawAll();
+		driver->endScene();
+
+		if (!terrain->getPendingTileCount())
+			break;
+	}
+
+	// one more frame for tiles which were requested by the last one
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+
+	return driver->getPrimitiveCountDrawn();
+}
+
+bool checkTiles(IPagedTerrainSceneNode* terrain, const c8* expected, const c8* name)
+{
+	bool result = true;
+
+	for (u32 i = 0; i < TileCount * TileCount; ++i)
+	{
+		if (terrain->isTileLoaded(i % TileCount, i / TileCount) != (expected[i] == 'x'))
+		{
+			logTestString("%s: tile %u/%u is %sloaded\n", name, i % TileCount, i / TileCount,
+				terrain->isTileLoaded(i % TileCount, i / TileCount) ? "" : "not ");
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that the paged terrain loads the tiles around the camera, stays within
+its memory budget, and draws and samples the heights of the loaded tiles. */
+bool pagedTerrain(void)
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	bool result = writeTiles(device->getFileSystem());
+
+	SPagedTerrainParameters parameters;
+	parameters.TileNames = "pagedTerrain_%d_%d.raw";
+	parameters.TileCountX = TileCount;
+	parameters.TileCountZ = TileCount;
+	parameters.TileSize = TileSize + 1;
+	parameters.BitsPerSample = 16;
+	parameters.SignedData = false;
+	parameters.Scale.set(10.f, 1.f, 10.f);
+	parameters.PatchSize = 8;
+	parameters.MaxLOD = 3;
+	parameters.LODDistance = 50.f;
+	parameters.LoadDistance = 400.f;
+
+	// tiles which can't be split into patches
+	result &= smgr->addPagedTerrainSceneNode(parameters) == 0;
+
+	// names which are not made of the two tile indices
+	parameters.TileSize = TileSize;
+	parameters.TileNames = "pagedTerrain_%s_%d.raw";
+	result &= smgr->addPagedTerrainSceneNode(parameters) == 0;
+	parameters.TileNames = "pagedTerrain_%d.raw";
+	result &= smgr->addPagedTerrainSceneNode(parameters) == 0;
+	parameters.TileNames = "pagedTerrain_%d_%d_%d.raw";
+	result &= smgr->addPagedTerrainSceneNode(parameters) == 0;
+
+	parameters.TileNames = "pagedTerrain_%u_%d.raw";
+	IPagedTerrainSceneNode* terrain = smgr->addPagedTerrainSceneNode(parameters);
+	assert_log(terrain);
+	if (!terrain)
+	{
+		removeTiles();
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	// the tiles within 400 units are loaded in the background
+	ICameraSceneNode* camera = smgr->addCameraSceneNode(0, vector3df(100.f, 2000.f, 100.f), vector3df(100.f, 0.f, 100.1f));
+	camera->setFarValue(5000.f);
+	const u32 far = drawFrames(driver, smgr, terrain);
+	result &= checkTiles(terrain, "xx..xx..........", "Start");
+
+	// seen from far above all patches use the lowest detail,
+	// 8 triangles and 32 skirt triangles for each of the 16 patches of the 4 tiles
+	if (far != 4 * 16 * 40)
+	{
+		logTestString("Drew %u primitives from far away\n", far);
+		result = false;
+	}
+
+	// close to the ground, the patches near the camera have more detail
+	camera->setPosition(vector3df(100.f, 20.f, 100.f));
+	camera->setTarget(vector3df(400.f, 0.f, 400.f));
+	const u32 near = drawFrames(driver, smgr, terrain);
+	if (near == 0 || near == far)
+	{
+		logTestString("Drew %u primitives close to the ground\n", near);
+		result = false;
+	}
+
+	// heights are interpolated within the loaded tiles only
+	const f32 points[][2] = { { 105.f, 207.f }, { 0.f, 0.f }, { 319.f, 555.5f }, { 639.f, 12.f } };
+	for (u32 i = 0; i < sizeof(points) / sizeof(points[0]); ++i)
+	{
+		const f32 height = terrain->getHeight(points[i][0], points[i][1]);
+		if (!equals(height, 0.05f * points[i][0] + 0.1f * points[i][1], 0.01f))
+		{
+			logTestString("Height at %f/%f is %f\n", points[i][0], points[i][1], height);
+			result = false;
+		}
+	}
+	result &= terrain->getHeight(700.f, 700.f) == -FLT_MAX;
+	result &= terrain->getHeight(-1.f, 10.f) == -FLT_MAX;
+
+	// only two tiles fit into the budget, the farther ones are removed
+	const u32 tileMemory = terrain->getMemoryUsage() / terrain->getLoadedTileCount();
+	terrain->setMemoryBudget(2 * tileMemory);
+	camera->setPosition(vector3df(1200.f, 20.f, 1200.f));
+	camera->setTarget(vector3df(900.f, 0.f, 900.f));
+	drawFrames(driver, smgr, terrain);
+	result &= checkTiles(terrain, "...........x..x.", "Budget");
+	result &= terrain->getMemoryUsage() <= 2 * tileMemory;
+	result &= terrain->getPendingTileCount() == 0;
+
+	// loading right away, the missing tile is a hole
+	terrain->setMemoryBudget(100 * tileMemory);
+	terrain->loadTiles(vector3df(640.f, 0.f, 640.f));
+	result &= checkTiles(terrain, ".xx.xxxxxxxx.xx.", "Loaded");
+	result &= terrain->getPendingTileCount() == 0;
+
+	// removing the node while tiles are loaded in the background
+	terrain->setLoadDistance(5000.f);
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+	terrain->remove();
+
+	removeTiles();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,239 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// not a multiple of 4, so the SIMD code and the remaining particles are both used
+const u32 ParticleCount = 103;
+
+void createParticles(array<SParticle>& particles, SParticlePool& pool)
+{
+	particles.clear();
+	pool.clear();
+
+	for (u32 i = 0; i < ParticleCount; ++i)
+	{
+		SParticle p;
+		p.pos.set((f32)(i % 7) * 3.f - 10.f, (f32)(i % 5) * 2.f, (f32)(i % 11) - 5.f);
+		// one particle sits right at the point of the attraction affector
+		if (i == 42)
+			p.pos.set(1.f, 2.f, 3.f);
+		p.vector.set(0.01f * (i % 3), 0.02f, -0.01f * (i % 4));
+		p.startVector = p.vector;
+		p.startTime = 1000 + i * 10;
+		p.endTime = p.startTime + 1000 + i * 7;
+		p.startColor.set(255 - i, i * 2, 100, i);
+		p.color = p.startColor;
+		p.startSize.set(1.f + i * 0.1f, 2.f);
+		p.size = p.startSize;
+
+		particles.push_back(p);
+		pool.push_back(p);
+	}
+}
+
+bool compare(const array<SParticle>& particles, const SParticlePool& pool, const c8* name)
+{
+	if (pool.size() != particles.size())
+	{
+		logTestString("%s: %u instead of %u particles\n", name, pool.size(), particles.size());
+		return false;
+	}
+
+	for (u32 i = 0; i < particles.size(); ++i)
+	{
+		const SParticle p = pool.get(i);
+		const SParticle& q = particles[i];
+		const video::SColor& c = p.color;
+		const video::SColor& d = q.color;
+
+		if (!p.pos.equals(q.pos, 0.001f) || !p.vector.equals(q.vector, 0.0001f) ||
+			!equals(p.size.Width, q.size.Width, 0.001f) || !equals(p.size.Height, q.size.Height, 0.001f) ||
+			abs_((s32)c.getAlpha() - (s32)d.getAlpha()) > 1 || abs_((s32)c.getRed() - (s32)d.getRed()) > 1 ||
+			abs_((s32)c.getGreen() - (s32)d.getGreen()) > 1 || abs_((s32)c.getBlue() - (s32)d.getBlue()) > 1)
+		{
+			logTestString("%s: particle %u differs, pos %f %f %f instead of %f %f %f, color %08x instead of %08x\n",
+				name, i, p.pos.X, p.pos.Y, p.pos.Z, q.pos.X, q.pos.Y, q.pos.Z, c.color, d.color);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// affects the particles with two instances of an affector, one as array of particles and one in ranges
+bool affectBoth(IParticleAffector* single, IParticleAffector* ranged, const c8* name)
+{
+	array<SParticle> particles;
+	SParticlePool pool;
+	createParticles(particles, pool);
+
+	bool result = true;
+	const u32 times[] = { 1500, 1800, 2600 };
+
+	for (u32 t = 0; t < 3; ++t)
+	{
+		single->affect(times[t], particles.pointer(), particles.size());
+
+		result &= ranged->prepareAffect(times[t]);
+		// the ranges don't have to be aligned
+		ranged->affectRange(times[t], pool, 0, 37);
+		ranged->affectRange(times[t], pool, 37, ParticleCount - 37);
+
+		result &= compare(particles, pool, name);
+	}
+
+	single->drop();
+	ranged->drop();
+
+	return result;
+}
+
+// an affector without a range implementation, it stops all particles
+class CStopAffector : public IParticleAffector
+{
+public:
+	CStopAffector() : Calls(0) {}
+
+	virtual void affect(u32 now, SParticle* particlearray, u32 count)
+	{
+		++Calls;
+		for (u32 i = 0; i < count; ++i)
+			particlearray[i].vector.set(0.f, 0.f, 0.f);
+	}
+
+	virtual E_PARTICLE_AFFECTOR_TYPE getType() const { return EPAT_NONE; }
+
+	u32 Calls;
+};
+
+} // end anonymous namespace
+
+/** Tests that the affectors give the same results for particles in arrays of
+SParticle and in ranges of a SParticlePool, that particle systems can grow
+beyond 16 bit indices and can be drawn as instanced billboards. */
+bool particleSystem(void)
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	IParticleSystemSceneNode* node = smgr->addParticleSystemSceneNode(false);
+	bool result = true;
+
+	result &= affectBoth(node->createGravityAffector(vector3df(0.f, -0.05f, 0.01f), 800),
+		node->createGravityAffector(vector3df(0.f, -0.05f, 0.01f), 800), "Gravity");
+	result &= affectBoth(node->createFadeOutParticleAffector(video::SColor(0, 10, 200, 30), 900),
+		node->createFadeOutParticleAffector(video::SColor(0, 10, 200, 30), 900), "FadeOut");
+	result &= affectBoth(node->createScaleParticleAffector(dimension2df(3.f, -1.f)),
+		node->createScaleParticleAffector(dimension2df(3.f, -1.f)), "Scale");
+	result &= affectBoth(node->createRotationAffector(vector3df(30.f, 45.f, -60.f), vector3df(1.f, 2.f, 3.f)),
+		node->createRotationAffector(vector3df(30.f, 45.f, -60.f), vector3df(1.f, 2.f, 3.f)), "Rotation");
+	result &= affectBoth(node->createAttractionAffector(vector3df(1.f, 2.f, 3.f), 5.f, true, true, false, true),
+		node->createAttractionAffector(vector3df(1.f, 2.f, 3.f), 5.f, true, true, false, true), "Attraction");
+	result &= affectBoth(node->createAttractionAffector(vector3df(1.f, 2.f, 3.f), 5.f, false),
+		node->createAttractionAffector(vector3df(1.f, 2.f, 3.f), 5.f, false), "Repulsion");
+
+	// a large system, emitting 100000 particles per 100ms
+	IParticleEmitter* emitter = node->createBoxEmitter(aabbox3df(-10.f, -10.f, -10.f, 10.f, 10.f, 10.f),
+		vector3df(0.f, 0.01f, 0.f), 1000000, 1000000, video::SColor(255, 255, 255, 255), video::SColor(255, 255, 255, 255),
+		1000, 1000);
+	node->setEmitter(emitter);
+	emitter->drop();
+	IParticleAffector* gravity = node->createGravityAffector();
+	node->addAffector(gravity);
+	gravity->drop();
+	CStopAffector* stop = new CStopAffector();
+	node->addAffector(stop);
+	stop->drop();
+
+	result &= node->getMaxParticleCount() == 16250;
+	node->setMaxParticleCount(150000);
+
+	smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, -100.f), vector3df(0.f, 0.f, 0.f));
+
+	node->doParticleSystem(1000);
+	node->doParticleSystem(1100);
+	node->doParticleSystem(1200);
+	node->doParticleSystem(1300);
+
+	// the third frame reached the maximum, the affector without ranges ran for each frame
+	result &= node->getParticleCount() == 150000;
+	result &= stop->Calls == 3;
+
+	// all particles were stopped before they were moved
+	const aabbox3df& box = node->getBoundingBox();
+	if (box.MinEdge.Y < -12.6f || box.MaxEdge.Y > 12.6f)
+	{
+		logTestString("Box of the particles is %f to %f\n", box.MinEdge.Y, box.MaxEdge.Y);
+		result = false;
+	}
+
+	// the particles of the first frame reached their end time and are removed,
+	// no new ones fit in before
+	node->doParticleSystem(2150);
+	result &= node->getParticleCount() == 50000;
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	node->render();
+	driver->endScene();
+
+	// 200000 vertices, drawn with 32 bit indices
+	if (driver->getPrimitiveCountDrawn() != 100000)
+	{
+		logTestString("Drew %u primitives\n", driver->getPrimitiveCountDrawn());
+		result = false;
+	}
+
+	// drivers without instancing draw the usual billboards
+	node->setInstancedBillboards(true);
+	result &= node->getInstancedBillboards();
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	node->render();
+	driver->endScene();
+
+	if (driver->getPrimitiveCountDrawn() != 100000)
+	{
+		logTestString("Drew %u primitives with instanced billboards\n", driver->getPrimitiveCountDrawn());
+		result = false;
+	}
+
+	video::IVertexDescriptor* descriptor = driver->getVertexDescriptor("ParticleInstance");
+	result &= descriptor && descriptor->getVertexSize(1) == sizeof(SParticleInstance);
+	result &= descriptor && descriptor->getInstanceDataStepRate(1) == video::EIDSR_PER_INSTANCE;
+
+	node->setInstancedBillboards(false);
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	node->render();
+	driver->endScene();
+	result &= driver->getPrimitiveCountDrawn() == 100000;
+
+	node->clearParticles();
+	result &= node->getParticleCount() == 0;
+
+	// nothing is drawn without particles
+	node->setInstancedBillboards(true);
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	node->render();
+	driver->endScene();
+	result &= driver->getPrimitiveCountDrawn() == 0;
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,122 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+
+namespace
+{
+
+enum
+{
+	ID_OUTER = 1001,
+	ID_INNER,
+	ID_COUNTER
+};
+
+} // end anonymous namespace
+
+/** Tests that the timeline of the profiler records nested scopes, counters and
+frames, keeps only the latest events and can be exported. */
+bool profilerTimeline(void)
+{
+	IProfiler& profiler = getProfiler();
+	profiler.add(ID_OUTER, L"outer", L"timeline test");
+	profiler.add(ID_INNER, L"inner \"quoted\"", L"timeline test");
+	profiler.add(ID_COUNTER, L"counter", L"timeline test");
+
+	bool result = true;
+
+	// nothing is recorded without a timeline
+	profiler.setTimelineSize(0);
+	profiler.start(ID_OUTER);
+	profiler.stop(ID_OUTER);
+	profiler.count(ID_COUNTER, 5);
+	profiler.markFrame();
+	result &= (profiler.getTimelineEventCount() == 0);
+	result &= (profiler.getTimelineEvent(0).Id == -1);
+
+	profiler.setTimelineSize(64);
+	result &= profiler.isTimelineEnabled();
+
+	const u32 firstFrame = profiler.getFrameNumber();
+	profiler.start(ID_OUTER);
+	profiler.start(ID_INNER);
+	profiler.count(ID_COUNTER, 3);
+	profiler.count(ID_COUNTER);
+	profiler.stop(ID_INNER);
+	profiler.stop(ID_OUTER);
+	profiler.stop(ID_OUTER);	// additional stop calls are not recorded
+	profiler.markFrame();
+
+	const E_PROFILE_EVENT_TYPE expectedTypes[] = { EPET_BEGIN, EPET_BEGIN, EPET_END, EPET_END, EPET_COUNTER, EPET_FRAME };
+	const s32 expectedIds[] = { ID_OUTER, ID_INNER, ID_INNER, ID_OUTER, ID_COUNTER, 0 };
+	const u32 expectedCount = sizeof(expectedTypes) / sizeof(expectedTypes[0]);
+
+	if (profiler.getTimelineEventCount() != expectedCount)
+	{
+		logTestString("Timeline has %u events, expected %u\n", profiler.getTimelineEventCount(), expectedCount);
+		result = false;
+	}
+	else
+	{
+		for (u32 i = 0; i < expectedCount; ++i)
+		{
+			const SProfileEvent event = profiler.getTimelineEvent(i);
+			if (event.Type != expectedTypes[i] || (event.Type != EPET_FRAME && event.Id != expectedIds[i])
+				|| event.Frame != firstFrame || event.Thread != 0)
+			{
+				logTestString("Timeline event %u is wrong\n", i);
+				result = false;
+			}
+			if (i > 0 && event.Time < profiler.getTimelineEvent(i - 1).Time)
+			{
+				logTestString("Timeline event %u is older than the one before\n", i);
+				result = false;
+			}
+		}
+
+		result &= (profiler.getTimelineEvent(4).Value == 4);
+		result &= (profiler.getTimelineEvent(5).Value == firstFrame);
+		result &= (profiler.getTimelineEvent(expectedCount).Id == -1);
+	}
+
+	stringc trace;
+	profiler.printTimeline(trace, EPTF_CHROME_TRACE);
+	if (trace.find("\"traceEvents\"") < 0 || trace.find("\"ph\":\"X\"") < 0
+		|| trace.find("\"name\":\"inner \\\"quoted\\\"\"") < 0 || trace.find("\"ph\":\"C\"") < 0)
+	{
+		logTestString("Wrong Chrome trace:\n%s\n", trace.c_str());
+		result = false;
+	}
+
+	stringc csv;
+	profiler.printTimeline(csv, EPTF_CSV);
+	if (csv.find("type,name,group,thread,frame,time_us,duration_us,value") != 0
+		|| csv.find("\"inner \"\"quoted\"\"\"") < 0 || csv.find("counter") < 0)
+	{
+		logTestString("Wrong CSV:\n%s\n", csv.c_str());
+		result = false;
+	}
+
+	// the ring buffer keeps the latest events
+	profiler.setTimelineSize(4);
+	for (u32 i = 0; i < 10; ++i)
+	{
+		profiler.start(ID_OUTER);
+		profiler.stop(ID_OUTER);
+	}
+	profiler.markFrame();
+	result &= (profiler.getTimelineEventCount() == 4);
+	result &= (profiler.getTimelineEvent(3).Type == EPET_FRAME);
+	result &= (profiler.getTimelineEvent(0).Type == EPET_BEGIN);
+	result &= (profiler.getTimelineEvent(4).Id == -1);
+
+	profiler.setTimelineSize(0);
+	result &= !profiler.isTimelineEnabled();
+	result &= (profiler.getTimelineEventCount() == 0);
+
+	return result;
+}
@@ -0,0 +1,153 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+array<ISceneNode*> Rendered;
+
+// registers for one pass and logs when it is rendered
+class CQueuedNode : public ISceneNode
+{
+public:
+	CQueuedNode(ISceneNode* parent, ISceneManager* smgr, const vector3df& position,
+			video::E_MATERIAL_TYPE type, video::ITexture* texture, E_SCENE_NODE_RENDER_PASS pass)
+		: ISceneNode(parent, smgr, -1, position), Pass(pass)
+	{
+		Material.MaterialType = type;
+		Material.setTexture(0, texture);
+		Box.reset(vector3df(0.f, 0.f, 0.f));
+		setAutomaticCulling(EAC_OFF);
+	}
+
+	virtual void OnRegisterSceneNode()
+	{
+		if (IsVisible)
+			SceneManager->registerNodeForRendering(this, Pass);
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+	virtual void render()
+	{
+		Rendered.push_back(this);
+	}
+
+	virtual const aabbox3d<f32>& getBoundingBox() const { return Box; }
+	virtual u32 getMaterialCount() const { return 1; }
+	virtual video::SMaterial& getMaterial(u32 i) { return Material; }
+
+	video::SMaterial Material;
+	aabbox3d<f32> Box;
+	E_SCENE_NODE_RENDER_PASS Pass;
+};
+
+f32 distance(ISceneNode* node)
+{
+	return node->getAbsolutePosition().getLength();
+}
+
+} // end anonymous namespace
+
+/** Tests that the render queue groups solid nodes by their material state and
+draws them front to back inside a group, and that transparent nodes are drawn
+back to front after them. */
+bool renderQueue(void)
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, 0.f), vector3df(0.f, 0.f, 100.f));
+
+	video::ITexture* textures[3];
+	textures[0] = driver->addTexture(dimension2d<u32>(4, 4), "first");
+	textures[1] = driver->addTexture(dimension2d<u32>(4, 4), "second");
+	textures[2] = driver->addTexture(dimension2d<u32>(4, 4), "third");
+
+	// 2 material types and 3 textures, added in an order which mixes them
+	const u32 solidCount = 48;
+	for (u32 i = 0; i < solidCount; ++i)
+	{
+		const u32 shuffled = (i * 29) % solidCount;
+		CQueuedNode* node = new CQueuedNode(smgr->getRootSceneNode(), smgr,
+			vector3df(0.f, 0.f, 10.f + shuffled * 3.f),
+			shuffled % 2 ? video::EMT_SOLID : video::EMT_SOLID_2_LAYER,
+			textures[shuffled % 3], ESNRP_SOLID);
+		node->drop();
+	}
+
+	const u32 transparentCount = 20;
+	for (u32 i = 0; i < transparentCount; ++i)
+	{
+		CQueuedNode* node = new CQueuedNode(smgr->getRootSceneNode(), smgr,
+			vector3df(0.f, 0.f, 10.f + ((i * 7) % transparentCount) * 5.f),
+			video::EMT_TRANSPARENT_ADD_COLOR, textures[i % 3], ESNRP_TRANSPARENT);
+		node->drop();
+	}
+
+	bool result = true;
+
+	for (u32 frame = 0; frame < 2; ++frame)
+	{
+		Rendered.clear();
+		driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		smgr->drawAll();
+		driver->endScene();
+
+		if (Rendered.size() != solidCount + transparentCount)
+		{
+			logTestString("Rendered %u instead of %u nodes\n", Rendered.size(), solidCount + transparentCount);
+			result = false;
+			break;
+		}
+
+		// one state change between each of the 6 groups, front to back inside a group
+		u32 stateChanges = 0;
+		for (u32 i = 1; i < solidCount; ++i)
+		{
+			CQueuedNode* a = static_cast<CQueuedNode*>(Rendered[i - 1]);
+			CQueuedNode* b = static_cast<CQueuedNode*>(Rendered[i]);
+			result &= a->Pass == ESNRP_SOLID && b->Pass == ESNRP_SOLID;
+
+			if (a->Material.MaterialType != b->Material.MaterialType ||
+				a->Material.getTexture(0) != b->Material.getTexture(0))
+				++stateChanges;
+			else
+				result &= distance(a) <= distance(b);
+		}
+
+		if (stateChanges != 5)
+		{
+			logTestString("%u state changes instead of 5\n", stateChanges);
+			result = false;
+		}
+
+		// the transparent nodes follow, back to front
+		for (u32 i = solidCount + 1; i < Rendered.size(); ++i)
+		{
+			result &= static_cast<CQueuedNode*>(Rendered[i])->Pass == ESNRP_TRANSPARENT;
+			result &= distance(Rendered[i - 1]) >= distance(Rendered[i]);
+		}
+	}
+
+	if (!result)
+		logTestString("Nodes were rendered in the wrong order\n");
+
+	Rendered.clear();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
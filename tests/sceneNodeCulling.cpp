@@ -0,0 +1,121 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+// remembers the result of isCulled while the scene manager draws the scene
+class CCullingProbe : public ISceneNode
+{
+public:
+	CCullingProbe(ISceneNode* parent, ISceneManager* mgr, const aabbox3df& box)
+		: ISceneNode(parent, mgr), Box(box), Culled(false)
+	{
+	}
+
+	virtual void OnRegisterSceneNode()
+	{
+		if (IsVisible)
+		{
+			Culled = SceneManager->isCulled(this);
+			ISceneNode::OnRegisterSceneNode();
+		}
+	}
+
+	virtual void render() {}
+
+	virtual const aabbox3df& getBoundingBox() const { return Box; }
+
+	aabbox3df Box;
+	bool Culled;
+};
+
+bool cullScene(u32 threads)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = dimension2d<u32>(160, 120);
+	params.WorkerThreads = threads;
+
+	IrrlichtDevice * device = irr::createDeviceEx(params);
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager * smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, vector3df(0, 0, 0), vector3df(0, 0, 100));
+
+	const E_CULLING_TYPE types[] = { EAC_BOX, EAC_FRUSTUM_BOX, EAC_FRUSTUM_SPHERE,
+		(E_CULLING_TYPE)(EAC_BOX | EAC_FRUSTUM_BOX), EAC_OFF };
+
+	// many nodes around the camera, some with children, with rotations and scales
+	array<CCullingProbe*> probes;
+	u32 seed = 1234;
+	for (u32 i = 0; i < 5000; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		const f32 r0 = ((seed >> 8) & 0xffff) / 65535.f;
+		seed = seed * 1103515245 + 12345;
+		const f32 r1 = ((seed >> 8) & 0xffff) / 65535.f;
+		seed = seed * 1103515245 + 12345;
+		const f32 r2 = ((seed >> 8) & 0xffff) / 65535.f;
+
+		ISceneNode* parent = (i % 7 == 3 && !probes.empty()) ? probes[(i * 13) % probes.size()] : 0;
+		const f32 size = 0.5f + r2 * 20.f;
+		CCullingProbe* probe = new CCullingProbe(parent ? parent : smgr->getRootSceneNode(),
+			smgr, aabbox3df(-size, -size * r0, -size, size, size, size * r1));
+		probe->setPosition(vector3df(r0 * 2000.f - 1000.f, r1 * 600.f - 300.f, r2 * 2000.f - 1000.f));
+		probe->setRotation(vector3df(r1 * 360.f, r2 * 360.f, r0 * 360.f));
+		probe->setScale(vector3df(0.5f + r0 * 2.f, 0.5f + r1, 0.5f + r2 * 3.f));
+		probe->setAutomaticCulling(types[i % 5]);
+		probes.push_back(probe);
+		probe->drop();
+	}
+
+	u32 culled = 0;
+	u32 mismatches = 0;
+
+	device->run();
+	device->getVideoDriver()->beginScene();
+	smgr->drawAll();
+	device->getVideoDriver()->endScene();
+
+	// outside of drawAll the nodes are tested one by one
+	for (u32 i = 0; i < probes.size(); ++i)
+	{
+		if (probes[i]->Culled)
+			++culled;
+		if (probes[i]->Culled != smgr->isCulled(probes[i]))
+			++mismatches;
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (mismatches || culled == 0 || culled == probes.size())
+	{
+		logTestString("%u threads: %u of %u nodes culled, %u differ from isCulled\n",
+			threads, culled, probes.size(), mismatches);
+		return false;
+	}
+
+	return true;
+}
+
+} // end anonymous namespace
+
+/** Tests that culling all nodes at once in drawAll gives the same results as isCulled. */
+bool sceneNodeCulling(void)
+{
+	bool result = cullScene(1);
+	result &= cullScene(4);
+	return result;
+}
+
@@ -0,0 +1,153 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+const u32 GridSize = 300;
+const u32 SeamColumn = 250;
+
+// adds the quads between two columns of the grid, the triangles face up
+CMeshBuffer<video::S3DVertex>* createGridPart(video::IVertexDescriptor* descriptor, u32 firstColumn, u32 lastColumn)
+{
+	const u32 columns = lastColumn - firstColumn + 1;
+	const u32 rows = GridSize + 1;
+
+	CMeshBuffer<video::S3DVertex>* buffer = new CMeshBuffer<video::S3DVertex>(descriptor,
+		columns * rows > 65536 ? video::EIT_32BIT : video::EIT_16BIT);
+
+	for (u32 x = 0; x < columns; ++x)
+	{
+		for (u32 z = 0; z < rows; ++z)
+		{
+			video::S3DVertex v((f32)(firstColumn + x), 0.f, (f32)z, 0.f, 1.f, 0.f, video::SColor(255, 255, 255, 255), 0.f, 0.f);
+			buffer->getVertexBuffer()->addVertex(&v);
+		}
+	}
+
+	for (u32 x = 0; x + 1 < columns; ++x)
+	{
+		for (u32 z = 0; z + 1 < rows; ++z)
+		{
+			const u32 a = x * rows + z;
+			const u32 b = a + 1;
+			const u32 c = a + rows;
+			const u32 d = c + 1;
+
+			buffer->getIndexBuffer()->addIndex(a);
+			buffer->getIndexBuffer()->addIndex(b);
+			buffer->getIndexBuffer()->addIndex(c);
+			buffer->getIndexBuffer()->addIndex(c);
+			buffer->getIndexBuffer()->addIndex(b);
+			buffer->getIndexBuffer()->addIndex(d);
+		}
+	}
+
+	buffer->recalculateBoundingBox();
+
+	return buffer;
+}
+
+u32 drawShadow(video::IVideoDriver* driver, IShadowVolumeSceneNode* shadow, const vector3df& light)
+{
+	driver->deleteAllDynamicLights();
+
+	video::SLight data;
+	data.Position = light;
+	data.Radius = 1000.f;
+	data.CastShadows = true;
+	driver->addDynamicLight(data);
+
+	shadow->updateShadowVolumes();
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	shadow->render();
+	driver->endScene();
+
+	// the software renderer draws the volume twice
+	return driver->getPrimitiveCountDrawn() / 2;
+}
+
+} // end anonymous namespace
+
+/** Tests the silhouette of a shadow volume on a grid which is larger than 16
+bit indices can address and which is split into two mesh buffers, and that
+shadow volumes are only rebuilt when the light or the mesh moved. */
+bool shadowVolume(void)
+{
+	// the null driver has no stencil buffer
+	IrrlichtDevice * device = createDevice(video::EDT_BURNINGSVIDEO, dimension2d<u32>(160, 120), 16, false, true);
+	if (!device)
+		return true; // No error if device does not exist
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	SMesh* mesh = new SMesh();
+	CMeshBuffer<video::S3DVertex>* left = createGridPart(driver->getVertexDescriptor(0), 0, SeamColumn);
+	CMeshBuffer<video::S3DVertex>* right = createGridPart(driver->getVertexDescriptor(0), SeamColumn, GridSize);
+	mesh->addMeshBuffer(left);
+	mesh->addMeshBuffer(right);
+	mesh->recalculateBoundingBox();
+
+	IMeshSceneNode* node = smgr->addMeshSceneNode(mesh);
+	IShadowVolumeSceneNode* shadow = node->addShadowVolumeSceneNode(0, -1, true, 1000.f);
+	assert_log(shadow);
+	if (!shadow)
+	{
+		left->drop();
+		right->drop();
+		mesh->drop();
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	bool result = true;
+
+	// seen from below, all faces face the light and get a front and back cap,
+	// the silhouette is the border of the grid, the seam between the
+	// mesh buffers is no silhouette
+	const u32 faces = GridSize * GridSize * 2;
+	const u32 expected = faces * 2 + GridSize * 4 * 2;
+
+	u32 drawn = drawShadow(driver, shadow, vector3df(150.f, -100.f, 150.f));
+	if (drawn != expected)
+	{
+		logTestString("Shadow volume has %u instead of %u triangles\n", drawn, expected);
+		result = false;
+	}
+
+	// seen from above, no face faces the light
+	result &= drawShadow(driver, shadow, vector3df(150.f, 100.f, 150.f)) == 0;
+
+	// the volume of the light above is kept while the light moves less than the threshold
+	shadow->setLightMoveThreshold(500.f);
+	result &= shadow->getLightMoveThreshold() == 500.f;
+	result &= drawShadow(driver, shadow, vector3df(150.f, -100.f, 150.f)) == 0;
+
+	shadow->setLightMoveThreshold(0.f);
+	result &= drawShadow(driver, shadow, vector3df(150.f, -100.f, 150.f)) == expected;
+
+	// a changed mesh always builds a new volume
+	shadow->setLightMoveThreshold(500.f);
+	static_cast<video::S3DVertex*>(left->getVertexBuffer()->getVertices())[1000].Pos.Y = 0.01f;
+	result &= drawShadow(driver, shadow, vector3df(150.f, 100.f, 150.f)) == 0;
+
+	left->drop();
+	right->drop();
+	mesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
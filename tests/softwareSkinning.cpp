@@ -0,0 +1,135 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+/** Skins vertices with one, three and six influences and compares them with
+skinning each weight on its own. The matrices are blended before transforming
+a vertex, so the results are only equal within a tolerance. */
+bool softwareSkinning(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager * smgr = device->getSceneManager();
+	ISkinnedMesh* mesh = smgr->createSkinnedMesh();
+
+	CMeshBuffer<video::S3DVertex>* buffer = new CMeshBuffer<video::S3DVertex>(device->getVideoDriver()->getVertexDescriptor(0));
+
+	const video::S3DVertex vertices[] = {
+		video::S3DVertex(1, 2, 3, 0, 1, 0, video::SColor(255, 255, 255, 255), 0, 0),
+		video::S3DVertex(-4, 0, 2, 1, 0, 0, video::SColor(255, 255, 255, 255), 1, 0),
+		video::S3DVertex(2, -3, -1, 0, 0, 1, video::SColor(255, 255, 255, 255), 0, 1) };
+
+	for (u32 i = 0; i < 3; ++i)
+		buffer->getVertexBuffer()->addVertex(&vertices[i]);
+
+	buffer->getIndexBuffer()->addIndex(0);
+	buffer->getIndexBuffer()->addIndex(1);
+	buffer->getIndexBuffer()->addIndex(2);
+	buffer->recalculateBoundingBox();
+
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+
+	// a chain of joints, each one moving and turning differently
+	ISkinnedMesh::SJoint* parent = 0;
+	for (u32 j = 0; j < 6; ++j)
+	{
+		ISkinnedMesh::SJoint* joint = mesh->addJoint(parent);
+		joint->LocalMatrix.setTranslation(vector3df(0.f, 1.f + j, 0.5f * j));
+
+		ISkinnedMesh::SPositionKey* position = mesh->addPositionKey(joint);
+		position->frame = 0.f;
+		position->position = joint->LocalMatrix.getTranslation();
+		position = mesh->addPositionKey(joint);
+		position->frame = 10.f;
+		position->position = joint->LocalMatrix.getTranslation() + vector3df(j * 0.3f, 0.f, 1.f);
+
+		ISkinnedMesh::SRotationKey* rotation = mesh->addRotationKey(joint);
+		rotation->frame = 0.f;
+		rotation->rotation.set(0.f, 0.f, 0.f);
+		rotation = mesh->addRotationKey(joint);
+		rotation->frame = 10.f;
+		rotation->rotation.set(0.1f * j, 0.2f, -0.05f * j);
+
+		parent = joint;
+	}
+
+	// vertex 0 follows one joint, vertex 1 three and vertex 2 all six
+	const u32 influences[] = { 1, 3, 6 };
+	for (u32 v = 0; v < 3; ++v)
+	{
+		for (u32 j = 0; j < influences[v]; ++j)
+		{
+			ISkinnedMesh::SWeight* weight = mesh->addWeight(mesh->getAllJoints()[(j * 2 + v) % 6]);
+			weight->buffer_id = 0;
+			weight->vertex_id = v;
+			weight->strength = 0.5f + j;
+		}
+	}
+
+	mesh->finalize();
+
+	// relative to the size of the skinned positions and normals
+	const f32 tolerance = 0.0001f;
+
+	bool result = true;
+
+	for (f32 frame = 0.f; frame <= 10.f; frame += 2.5f)
+	{
+		mesh->animateMesh(frame, 1.f);
+		mesh->skinMesh();
+
+		for (u32 v = 0; v < 3; ++v)
+		{
+			vector3df position(0.f, 0.f, 0.f);
+			vector3df normal(0.f, 0.f, 0.f);
+
+			for (u32 j = 0; j < mesh->getAllJoints().size(); ++j)
+			{
+				const ISkinnedMesh::SJoint* joint = mesh->getAllJoints()[j];
+				matrix4 pull;
+				pull.setbyproduct(joint->GlobalAnimatedMatrix, joint->GlobalInversedMatrix);
+
+				for (u32 w = 0; w < joint->Weights.size(); ++w)
+				{
+					if (joint->Weights[w].vertex_id != v)
+						continue;
+
+					vector3df p;
+					pull.transformVect(p, vertices[v].Pos);
+					position += p * joint->Weights[w].strength;
+
+					vector3df n;
+					pull.rotateVect(n, vertices[v].Normal);
+					normal += n * joint->Weights[w].strength;
+				}
+			}
+
+			const video::S3DVertex* skinned = (const video::S3DVertex*)mesh->getMeshBuffer(0)->getVertexBuffer()->getVertex(v);
+
+			const f32 scale = core::max_(1.f, position.getLength(), normal.getLength());
+			if (!skinned->Pos.equals(position, tolerance * scale) || !skinned->Normal.equals(normal, tolerance * scale))
+			{
+				logTestString("Vertex %u at frame %f is (%f %f %f), expected (%f %f %f)\n", v, frame,
+					skinned->Pos.X, skinned->Pos.Y, skinned->Pos.Z, position.X, position.Y, position.Z);
+				result = false;
+			}
+		}
+	}
+
+	mesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
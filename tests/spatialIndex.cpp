@@ -0,0 +1,269 @@
+// Copyright (C) 2008-2012 Colin MacDonald
+// No rights reserved: this software is in the public domain.
+
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+
+u32 Seed = 777;
+
+f32 random(f32 range)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return ((Seed >> 8) & 0xffff) / 65535.f * 2.f * range - range;
+}
+
+const u32 NodeCount = 1500;
+
+// the same random scene for each scene manager, the nodes are named by their index
+void createScene(ISceneManager* smgr, array<ISceneNode*>& nodes)
+{
+	Seed = 777;
+
+	for (u32 i = 0; i < NodeCount; ++i)
+	{
+		ISceneNode* parent = 0;
+		if (i % 5 != 0 && !nodes.empty())
+			parent = nodes[core::min_((u32)((random(0.5f) + 0.5f) * nodes.size()), nodes.size() - 1)];
+
+		IMeshSceneNode* node = smgr->addCubeSceneNode(1.f + fabsf(random(20.f)), parent, i % 7 + 1,
+			vector3df(random(1500.f), random(1500.f), random(1500.f)),
+			vector3df(random(180.f), random(180.f), random(180.f)));
+		node->setName(stringc(i).c_str());
+
+		if (i % 11 == 0)
+			node->setVisible(false);
+		if (i % 13 == 0)
+			node->setIsDebugObject(true);
+		if (i % 3 == 0)
+		{
+			ITriangleSelector* selector = smgr->createTriangleSelector(node->getMesh(), node);
+			node->setTriangleSelector(selector);
+			selector->drop();
+		}
+		node->setAutomaticCulling(i % 4 == 0 ? EAC_FRUSTUM_BOX : EAC_BOX);
+
+		nodes.push_back(node);
+	}
+
+	// a node too big for the cells
+	ISceneNode* ground = smgr->addCubeSceneNode(10000000.f, 0, 1, vector3df(0.f, -5100000.f, 0.f));
+	ground->setName(stringc(NodeCount).c_str());
+	nodes.push_back(ground);
+
+	smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, -3000.f), vector3df(0.f, 0.f, 0.f));
+	smgr->getRootSceneNode()->OnAnimate(0);
+}
+
+s32 getIndex(const ISceneNode* node)
+{
+	return node ? atoi(node->getName()) : -1;
+}
+
+bool comparePicking(ISceneManager* expected, ISceneManager* indexed, const c8* name)
+{
+	ISceneCollisionManager* expectedCollision = expected->getSceneCollisionManager();
+	ISceneCollisionManager* indexedCollision = indexed->getSceneCollisionManager();
+	bool result = true;
+	u32 hits = 0;
+
+	for (u32 i = 0; i < 300; ++i)
+	{
+		const line3df ray(random(2500.f), random(2500.f), random(2500.f), random(2500.f), random(2500.f), random(2500.f));
+		const s32 mask = i % 4 == 0 ? 2 : 0;
+		const bool noDebug = (i % 2) != 0;
+
+		const s32 expectedBB = getIndex(expectedCollision->getSceneNodeFromRayBB(ray, mask, noDebug));
+		const s32 indexedBB = getIndex(indexedCollision->getSceneNodeFromRayBB(ray, mask, noDebug));
+
+		vector3df expectedPoint, indexedPoint;
+		triangle3df expectedTriangle, indexedTriangle;
+		const s32 expectedSelector = getIndex(expectedCollision->getSceneNodeAndCollisionPointFromRay(ray,
+			expectedPoint, expectedTriangle, mask, 0, noDebug));
+		const s32 indexedSelector = getIndex(indexedCollision->getSceneNodeAndCollisionPointFromRay(ray,
+			indexedPoint, indexedTriangle, mask, 0, noDebug));
+
+		if (expectedBB != indexedBB || expectedSelector != indexedSelector ||
+			(expectedSelector >= 0 && !expectedPoint.equals(indexedPoint, 0.01f)))
+		{
+			logTestString("%s: ray %u picked %d/%d, expected %d/%d\n", name, i,
+				indexedBB, indexedSelector, expectedBB, expectedSelector);
+			result = false;
+		}
+		if (expectedBB >= 0 && expectedBB != (s32)NodeCount)
+			++hits;
+	}
+
+	if (hits < 30)
+	{
+		logTestString("%s: only %u rays hit a node\n", name, hits);
+		result = false;
+	}
+
+	return result;
+}
+
+bool compareSpheres(ISceneManager* expected, ISceneManager* indexed, const c8* name)
+{
+	bool result = true;
+
+	for (u32 i = 0; i < 100; ++i)
+	{
+		const vector3df center(random(2000.f), random(2000.f), random(2000.f));
+		const f32 radius = fabsf(random(400.f));
+
+		array<ISceneNode*> expectedNodes, indexedNodes;
+		expected->getSceneCollisionManager()->getSceneNodesFromSphereBB(center, radius, expectedNodes, i % 3 ? 0 : 4);
+		indexed->getSceneCollisionManager()->getSceneNodesFromSphereBB(center, radius, indexedNodes, i % 3 ? 0 : 4);
+
+		array<s32> expectedIndices, indexedIndices;
+		for (u32 j = 0; j < expectedNodes.size(); ++j)
+			expectedIndices.push_back(getIndex(expectedNodes[j]));
+		for (u32 j = 0; j < indexedNodes.size(); ++j)
+			indexedIndices.push_back(getIndex(indexedNodes[j]));
+		expectedIndices.sort();
+		indexedIndices.sort();
+
+		if (expectedIndices != indexedIndices)
+		{
+			logTestString("%s: sphere %u found %u nodes, expected %u\n", name, i, indexedIndices.size(), expectedIndices.size());
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+bool compareCulling(video::IVideoDriver* driver, ISceneManager* expected, ISceneManager* indexed)
+{
+	bool result = true;
+
+	for (u32 i = 0; i < 5; ++i)
+	{
+		const vector3df position(random(2000.f), random(2000.f), random(2000.f));
+		const vector3df target(random(500.f), random(500.f), random(500.f));
+		expected->getActiveCamera()->setPosition(position);
+		expected->getActiveCamera()->setTarget(target);
+		indexed->getActiveCamera()->setPosition(position);
+		indexed->getActiveCamera()->setTarget(target);
+
+		driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		expected->drawAll();
+		driver->endScene();
+		const u32 expectedCount = driver->getPrimitiveCountDrawn();
+
+		driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		indexed->drawAll();
+		driver->endScene();
+		const u32 indexedCount = driver->getPrimitiveCountDrawn();
+
+		if (indexedCount != expectedCount || expectedCount == 0)
+		{
+			logTestString("Culling: view %u drew %u primitives, expected %u\n", i, indexedCount, expectedCount);
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+} // end anonymous namespace
+
+/** Tests that picking, sphere queries and culling give the same results with the
+spatial index of the scene manager as without it, also after nodes were moved,
+hidden, removed and added without updating the index. */
+bool spatialIndex(void)
+{
+	IrrlichtDevice * device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* expected = device->getSceneManager()->createNewSceneManager();
+	ISceneManager* indexed = device->getSceneManager()->createNewSceneManager();
+
+	array<ISceneNode*> expectedNodes, indexedNodes;
+	createScene(expected, expectedNodes);
+	createScene(indexed, indexedNodes);
+
+	indexed->setSpatialIndexEnabled(true, 50.f);
+	bool result = indexed->isSpatialIndexEnabled() && !expected->isSpatialIndexEnabled();
+
+	result &= comparePicking(expected, indexed, "Initial");
+	result &= compareSpheres(expected, indexed, "Initial");
+
+	// change the scenes the same way
+	ISceneManager* managers[] = { expected, indexed };
+	array<ISceneNode*>* nodes[] = { &expectedNodes, &indexedNodes };
+	for (u32 m = 0; m < 2; ++m)
+	{
+		Seed = 4242;
+		array<ISceneNode*>& n = *nodes[m];
+		for (u32 i = 0; i < NodeCount; ++i)
+		{
+			if (i % 3 == 0)
+				n[i]->setPosition(vector3df(random(1500.f), random(1500.f), random(1500.f)));
+			if (i % 10 == 1)
+				n[i]->setScale(vector3df(4.f, 0.5f, 2.f));
+			if (i % 23 == 0)
+				n[i]->setVisible(!n[i]->isVisible());
+		}
+		// removes whole subtrees of nodes without parent, the nodes can't be used afterwards
+		for (u32 i = 5; i < NodeCount; i += 95)
+			n[i]->remove();
+
+		for (u32 i = 0; i < 20; ++i)
+		{
+			ISceneNode* node = managers[m]->addCubeSceneNode(10.f + fabsf(random(20.f)), 0, i % 7 + 1,
+				vector3df(random(1500.f), random(1500.f), random(1500.f)));
+			node->setName(stringc(NodeCount + 1 + i).c_str());
+		}
+
+		managers[m]->getRootSceneNode()->OnAnimate(0);
+	}
+
+	// the queries bring the index up to date themselves
+
+	result &= comparePicking(expected, indexed, "Changed");
+	result &= compareSpheres(expected, indexed, "Changed");
+	result &= compareCulling(device->getVideoDriver(), expected, indexed);
+
+	// animating an unchanged scene doesn't invalidate it, so the queries skip the update
+	const u32 changedID = indexed->getRootSceneNode()->getChangedID();
+	indexed->getRootSceneNode()->OnAnimate(0);
+	result &= comparePicking(expected, indexed, "Unchanged");
+	result &= changedID == indexed->getRootSceneNode()->getChangedID();
+
+	// nodes moved without animating the scene are found at their new position
+	for (u32 m = 0; m < 2; ++m)
+	{
+		Seed = 99;
+		for (u32 i = 0; i < 20; ++i)
+		{
+			ISceneNode* node = managers[m]->getSceneNodeFromName(stringc(NodeCount + 1 + i).c_str());
+			node->setPosition(vector3df(random(1500.f), random(1500.f), random(1500.f)));
+			node->updateAbsolutePosition();
+		}
+	}
+	result &= changedID != indexed->getRootSceneNode()->getChangedID();
+
+	result &= comparePicking(expected, indexed, "Moved");
+	result &= compareSpheres(expected, indexed, "Moved");
+
+	indexed->setSpatialIndexEnabled(false);
+	result &= !indexed->isSpatialIndexEnabled();
+
+	expected->drop();
+	indexed->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
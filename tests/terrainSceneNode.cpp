@@ -117,12 +117,146 @@ bool terrainGaps()
 	return result;
 }
 
+// the slots of the visible patches must contain the indices of their current level of detail
+bool checkPatchIndices(scene::ITerrainSceneNode* terrain, const char* name)
+{
+	scene::IIndexBuffer* indexBuffer = terrain->getRenderBuffer()->getIndexBuffer();
+	array<s32> lods;
+	const s32 patchCount = terrain->getCurrentLODOfPatches(lods);
+	const s32 patchesPerSide = (s32)sqrtf((f32)patchCount);
+	const u32 slotSize = indexBuffer->getIndexCount() / patchCount;
+
+	bool result = true;
+	u32 total = 0;
+	array<u32> indices;
+
+	for (s32 i = 0; i < patchCount; ++i)
+	{
+		const s32 count = terrain->getIndicesForPatch(indices, i / patchesPerSide, i % patchesPerSide, -1);
+		if (lods[i] < 0)
+		{
+			result &= count == -2;
+			continue;
+		}
+
+		total += count;
+		for (s32 j = 0; j < count; ++j)
+		{
+			if (indexBuffer->getIndex(i * slotSize + j) != indices[j])
+			{
+				logTestString("%s: index %d of patch %d is wrong\n", name, j, i);
+				result = false;
+				break;
+			}
+		}
+	}
+
+	if (total != terrain->getIndexCount())
+	{
+		logTestString("%s: %u indices to render instead of %u\n", name, terrain->getIndexCount(), total);
+		result = false;
+	}
+
+	return result;
+}
+
+u32 drawTerrain(video::IVideoDriver* driver, scene::ISceneManager* smgr, const vector3df& position, const vector3df& target)
+{
+	smgr->getActiveCamera()->setPosition(position);
+	smgr->getActiveCamera()->setTarget(target);
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+
+	return driver->getPrimitiveCountDrawn();
+}
+
+// only the patches which changed are rebuilt, and geomorphing moves vertices towards the lower detail
+bool terrainIncremental()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	scene::ITerrainSceneNode* terrain = smgr->addTerrainSceneNode("../media/terrain-heightmap.bmp",
+		0, -1, vector3df(0.f, 0.f, 0.f), vector3df(0.f, 0.f, 0.f), vector3df(40.f, 4.4f, 40.f));
+	assert_log(terrain);
+	if (!terrain)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	smgr->addCameraSceneNode()->setFarValue(20000.f);
+
+	const vector3df center(terrain->getBoundingBox().getCenter());
+	const vector3df corner(terrain->getBoundingBox().MinEdge);
+	bool result = true;
+
+	u32 drawn = drawTerrain(driver, smgr, vector3df(center.X, 3000.f, center.Z - 3000.f), center);
+	result &= checkPatchIndices(terrain, "Center");
+	result &= drawn && drawn == terrain->getIndexCount() / 3;
+
+	drawn = drawTerrain(driver, smgr, vector3df(corner.X, 500.f, corner.Z), center);
+	result &= checkPatchIndices(terrain, "Corner");
+	result &= drawn && drawn == terrain->getIndexCount() / 3;
+
+	drawn = drawTerrain(driver, smgr, vector3df(center.X, 3000.f, center.Z - 3000.f), center);
+	result &= checkPatchIndices(terrain, "Back");
+	result &= drawn && drawn == terrain->getIndexCount() / 3;
+
+	// geomorphing only moves the heights of the vertices, and only in the distance
+	scene::IVertexBuffer* vertexBuffer = terrain->getRenderBuffer()->getVertexBuffer();
+	const u32 vertexSize = vertexBuffer->getVertexSize();
+	array<vector3df> positions;
+	for (u32 i = 0; i < vertexBuffer->getVertexCount(); ++i)
+		positions.push_back(*(vector3df*)((u8*)vertexBuffer->getVertices() + i * vertexSize));
+
+	result &= !terrain->isGeomorphing();
+	terrain->setGeomorphing(true);
+	result &= terrain->isGeomorphing();
+	drawTerrain(driver, smgr, vector3df(corner.X, 500.f, corner.Z), center);
+	result &= checkPatchIndices(terrain, "Geomorphing");
+
+	u32 moved = 0;
+	for (u32 i = 0; i < positions.size(); ++i)
+	{
+		const vector3df& position = *(vector3df*)((u8*)vertexBuffer->getVertices() + i * vertexSize);
+		result &= position.X == positions[i].X && position.Z == positions[i].Z;
+		if (position.Y != positions[i].Y)
+			++moved;
+	}
+	if (moved == 0)
+	{
+		logTestString("Geomorphing didn't move any vertices\n");
+		result = false;
+	}
+
+	// switching it off restores the vertices
+	terrain->setGeomorphing(false);
+	for (u32 i = 0; result && i < positions.size(); ++i)
+		result &= *(vector3df*)((u8*)vertexBuffer->getVertices() + i * vertexSize) == positions[i];
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+	return result;
+}
+
 }
 
 bool terrainSceneNode()
 {
 	bool result = terrainRecalc();
 	result &= terrainGaps();
+	result &= terrainIncremental();
 	return result;
 }
 